@@ -121,6 +121,7 @@ EXTERN_MSC int GMT_mbswath(void *API, int mode, void *args);
 
 #define GMT_PROG_OPTIONS "->BJKOPRUVXY" GMT_OPT("S")
 
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -189,6 +190,7 @@ struct ping {
 	double lataft;
 	double lonfor;
 	double latfor;
+	double footdepth;
 	int *bathflag;
 	struct footprint *bathfoot;
 	int *ssflag;
@@ -203,6 +205,14 @@ struct swath {
 	struct ping data[MAXPINGS];
 };
 
+/* beam footprint in image pixels, ready to be rasterized */
+struct mbswath_box {
+	bool plot;
+	int ix[5];
+	int iy[5];
+	unsigned char color[3];
+};
+
 /* Control structure for mbswath */
 struct MBSWATH_CTRL {
 
@@ -226,6 +236,8 @@ struct MBSWATH_CTRL {
 	int nm;
 	int nm2;
 	unsigned char *bitimage;
+	struct mbswath_box *boxes;
+	int nboxes_alloc;
 	int format;
 	double beamwidth_xtrack;
 	double beamwidth_ltrack;
@@ -291,6 +303,10 @@ struct MBSWATH_CTRL {
 		bool active;
 		int lonflip;
 	} L;
+	struct mbswath_M { /* -M<nthreads> */
+		bool active;
+		int nthreads;
+	} M;
 	struct mbswath_N { /* -N<cptfile> */
 		bool active;
 		char *cptfile;
@@ -318,6 +334,20 @@ struct MBSWATH_CTRL {
 	} Z;
 };
 
+/* arguments passed to the ping block and image band worker threads */
+struct mbswath_work {
+	struct MBSWATH_CTRL *Ctrl;
+	struct GMT_CTRL *GMT;
+	struct GMT_PALETTE *CPT;
+	int start;
+	int end;
+	bool dobath;
+	bool doss;
+	double rfactor;
+	const int *box_offset;
+	int nboxes;
+};
+
 void *New_mbswath_Ctrl(struct GMT_CTRL *GMT) { /* Allocate and initialize a new control structure */
 	int verbose = 0;
 	double dummybounds[4];
@@ -376,6 +406,8 @@ void *New_mbswath_Ctrl(struct GMT_CTRL *GMT) { /* Allocate and initialize a new
 	Ctrl->ny = 0;
 	Ctrl->nm = 0;
 	Ctrl->bitimage = NULL;
+	Ctrl->boxes = NULL;
+	Ctrl->nboxes_alloc = 0;
 	Ctrl->format = 0;
 	Ctrl->beamwidth_xtrack = 0.0;
 	Ctrl->beamwidth_ltrack = 0.0;
@@ -418,7 +450,7 @@ int GMT_mbswath_usage(struct GMTAPI_CTRL *API, int level) {
 	GMT_Message(API, GMT_TIME_NONE, "\t[-C<cptfile>] [-D<mode>/<ampscale>/<ampmin>/<ampmax>] [-Ei|<dpi>]\n");
 	GMT_Message(API, GMT_TIME_NONE, "\t[-e<year>/<month>/<day>/<hour>/<minute>/<second>]\n");
 	GMT_Message(API, GMT_TIME_NONE, "\t[-F<format>] [-G<magnitude>/<azimuth | median>]\n");
-	GMT_Message(API, GMT_TIME_NONE, "\t[-I<inputfile>] [-L<lonflip>] [-N<cptfile>]\n");
+	GMT_Message(API, GMT_TIME_NONE, "\t[-I<inputfile>] [-L<lonflip>] [-M<nthreads>] [-N<cptfile>]\n");
 	GMT_Message(API, GMT_TIME_NONE, "\t[-S<speed>] [-T<timegap>] [-W] [-Z<mode>]\n");
 	GMT_Message(API, GMT_TIME_NONE, "\t[%s] [-T] [%s] [%s]\n", GMT_Rgeo_OPT, GMT_U_OPT, GMT_V_OPT);
 #if GMT_MAJOR_VERSION >= 6
@@ -444,6 +476,8 @@ int GMT_mbswath_usage(struct GMTAPI_CTRL *API, int level) {
 	GMT_Message(API, GMT_TIME_NONE, "\t   Give i to do the interpolation in PostScript at device resolution.\n");
 	gmt_rgb_syntax(API->GMT, 'G', "Set transparency color for images that otherwise would result in 1-bit images.\n\t  ");
 	GMT_Option(API, "K");
+	GMT_Message(API, GMT_TIME_NONE, "\t-M Set the number of threads used to compute and rasterize the beam footprints\n");
+	GMT_Message(API, GMT_TIME_NONE, "\t   [Default uses all available cores].\n");
 	GMT_Option(API, "O,P");
 	GMT_Message(API, GMT_TIME_NONE,
 	            "\t-p<pings> Sets the ping averaging of the input data [Default = 1, i.e. no ping average].\n");
@@ -588,6 +622,15 @@ int GMT_mbswath_parse(struct GMT_CTRL *GMT, struct MBSWATH_CTRL *Ctrl, struct GM
 				n_errors++;
 			}
 			break;
+		case 'M': /* -M<nthreads> */
+			n = sscanf(opt->arg, "%d", &(Ctrl->M.nthreads));
+			if (n == 1)
+				Ctrl->M.active = true;
+			else {
+				GMT_Report(API, GMT_MSG_NORMAL, "Syntax error -M option: \n");
+				n_errors++;
+			}
+			break;
 		case 'N': /* -N<cptfile> */
 			Ctrl->N.active = true;
 			if (Ctrl->N.cptfile)
@@ -655,128 +698,65 @@ int GMT_mbswath_parse(struct GMT_CTRL *GMT, struct MBSWATH_CTRL *Ctrl, struct GM
 }
 
 /*--------------------------------------------------------------------*/
-int mbswath_get_footprints(int verbose, struct MBSWATH_CTRL *Ctrl, int *error) {
-	struct swath *swath = Ctrl->swath_plot;
-	// struct mb_io_struct *mb_io_ptr = (struct mb_io_struct *)Ctrl->mbio_ptr;
-
-	if (verbose >= 2) {
-		fprintf(stderr, "\ndbg2  MBSWATH function <%s> called\n", __func__);
-		fprintf(stderr, "dbg2  Input arguments:\n");
-		fprintf(stderr, "dbg2       verbose:                  %d\n", verbose);
-		fprintf(stderr, "dbg2       Ctrl->A.mode:             %d\n", Ctrl->A.mode);
-		fprintf(stderr, "dbg2       Ctrl->A.factor:           %f\n", Ctrl->A.factor);
-		fprintf(stderr, "dbg2       Ctrl->A.depth:            %f\n", Ctrl->A.depth);
-		fprintf(stderr, "dbg2       Ctrl->footprint_factor:   %f\n", Ctrl->footprint_factor);
-		fprintf(stderr, "dbg2       Ctrl->swath_plot:         %p\n", Ctrl->swath_plot);
-		fprintf(stderr, "dbg2       Ctrl->mtodeglon:          %f\n", Ctrl->mtodeglon);
-		fprintf(stderr, "dbg2       Ctrl->mtodeglat:          %f\n", Ctrl->mtodeglat);
-		fprintf(stderr, "dbg2       pings:                    %d\n", swath->npings);
+/*--------------------------------------------------------------------*/
+/* Divide [start, end) among the threads and run the worker on each
+   block, running the last block in the calling thread. The work
+   structures must have been initialized by the caller except for the
+   block bounds. */
+static void mbswath_run(int nthreads, int start, int end, void *(*worker)(void *), struct mbswath_work *work) {
+	const int count = end - start;
+	nthreads = MIN(mb_nthreads(nthreads), MAX(count, 1));
+	pthread_t threads[MB_THREAD_MAX];
+	bool started[MB_THREAD_MAX];
+	for (int ithread = 0; ithread < nthreads; ithread++) {
+		work[ithread].start = start + (int)(((long)count * ithread) / nthreads);
+		work[ithread].end = start + (int)(((long)count * (ithread + 1)) / nthreads);
+		started[ithread] = false;
 	}
-
-	/* set mode of operation */
-	bool dobath;
-	bool doss;
-	if (Ctrl->Z.mode != MBSWATH_SS && Ctrl->Z.mode != MBSWATH_SS_FILTER) {
-		dobath = true;
-		doss = false;
+	for (int ithread = 0; ithread < nthreads - 1; ithread++) {
+		if (pthread_create(&threads[ithread], NULL, worker, &work[ithread]) == 0)
+			started[ithread] = true;
+		else
+			(*worker)(&work[ithread]);
 	}
-	else {
-		dobath = false;
-		doss = true;
+	(*worker)(&work[nthreads - 1]);
+	for (int ithread = 0; ithread < nthreads - 1; ithread++) {
+		if (started[ithread])
+			pthread_join(threads[ithread], NULL);
 	}
+}
+/*--------------------------------------------------------------------*/
+/* Get the beam footprints of the pings [start, end) in the swath buffer.
+   Each ping only writes its own flags, footprints and fore-aft offsets,
+   so blocks of pings are done concurrently. */
+static void *mbswath_footprints_worker(void *arg) {
+	struct mbswath_work *work = (struct mbswath_work *)arg;
+	struct MBSWATH_CTRL *Ctrl = work->Ctrl;
+	struct swath *swath = Ctrl->swath_plot;
+	const bool dobath = work->dobath;
+	const bool doss = work->doss;
+	const double rfactor = work->rfactor;
 
 	struct ping *pingcur;
-
-	/* set all footprint flags to zero */
-	for (int i = 0; i < swath->npings; i++) {
-		pingcur = &swath->data[i];
-		for (int j = 0; j < pingcur->beams_bath; j++)
-			pingcur->bathflag[j] = false;
-		for (int j = 0; j < pingcur->pixels_ss; j++)
-			pingcur->ssflag[j] = false;
-	}
-
-	double headingx;
-	double headingy;
-	double rfactor;
-
-	/* get fore-aft components of beam footprints */
-	if (swath->npings > 1 && Ctrl->A.mode == MBSWATH_FOOTPRINT_FAKE) {
-		for (int i = 0; i < swath->npings; i++) {
-			/* initialize */
-			pingcur = &swath->data[i];
-			pingcur->lonaft = 0.0;
-			pingcur->lataft = 0.0;
-			pingcur->lonfor = 0.0;
-			pingcur->latfor = 0.0;
-
-			/* get aft looking */
-			if (i > 0) {
-				headingx = sin(pingcur->heading * DTR);
-				headingy = cos(pingcur->heading * DTR);
-				const double dx = (swath->data[i - 1].navlon - pingcur->navlon) / Ctrl->mtodeglon;
-				const double dy = (swath->data[i - 1].navlat - pingcur->navlat) / Ctrl->mtodeglat;
-				const double r = sqrt(dx * dx + dy * dy);
-				pingcur->lonaft = Ctrl->footprint_factor * r * headingx * Ctrl->mtodeglon;
-				pingcur->lataft = Ctrl->footprint_factor * r * headingy * Ctrl->mtodeglat;
-			}
-
-			/* get forward looking */
-			if (i < swath->npings - 1) {
-				headingx = sin(pingcur->heading * DTR);
-				headingy = cos(pingcur->heading * DTR);
-				const double dx = (swath->data[i + 1].navlon - pingcur->navlon) / Ctrl->mtodeglon;
-				const double dy = (swath->data[i + 1].navlat - pingcur->navlat) / Ctrl->mtodeglat;
-				const double r = sqrt(dx * dx + dy * dy);
-				pingcur->lonfor = Ctrl->footprint_factor * r * headingx * Ctrl->mtodeglon;
-				pingcur->latfor = Ctrl->footprint_factor * r * headingy * Ctrl->mtodeglat;
-			}
-
-			/* take care of first ping */
-			if (i == 0) {
-				pingcur->lonaft = -pingcur->lonfor;
-				pingcur->lataft = -pingcur->latfor;
-			}
-
-			/* take care of last ping */
-			if (i == swath->npings - 1) {
-				pingcur->lonfor = -pingcur->lonaft;
-				pingcur->latfor = -pingcur->lataft;
-			}
-		}
-	}
-
-	/* take care of just one ping with nonzero center beam */
-	else if (swath->npings == 1 && Ctrl->A.mode == MBSWATH_FOOTPRINT_FAKE &&
-	         mb_beam_ok(swath->data[0].beamflag[pingcur->beams_bath / 2]) && Ctrl->A.depth <= 0.0) {
-		pingcur = &swath->data[0];
-		headingx = sin(pingcur->heading * DTR);
-		headingy = cos(pingcur->heading * DTR);
-		const double tt = pingcur->bath[pingcur->beams_bath / 2] / 750.0; /* in s */
-		const double r = tt * pingcur->speed * 0.55555556;                /* in m */
-		pingcur->lonaft = -Ctrl->footprint_factor * r * headingx * Ctrl->mtodeglon;
-		pingcur->lataft = -Ctrl->footprint_factor * r * headingy * Ctrl->mtodeglat;
-		pingcur->lonfor = Ctrl->footprint_factor * r * headingx * Ctrl->mtodeglon;
-		pingcur->latfor = Ctrl->footprint_factor * r * headingy * Ctrl->mtodeglat;
-	}
-
-	/* else get rfactor if using fore-aft beam width */
-	else if (Ctrl->A.mode == MBSWATH_FOOTPRINT_REAL) {
-		rfactor = 0.5 * sin(DTR * Ctrl->footprint_factor);
-	}
-
+	struct footprint *print;
+	double headingx = 0.0;
+	double headingy = 0.0;
 	double dlon1, dlon2;
 	double dlat1, dlat2;
 	double x, y;
 	double ddlonx, ddlaty;
-	static double dddepth = 0.0; // TODO(schwehr): Why static?
+	double dddepth;
 	bool setprint;
 
-	/* loop over the inner beams and get
-	    the obvious footprint boundaries */
-	struct footprint *print;
-	for (int i = 0; i < swath->npings; i++) {
+	for (int i = work->start; i < work->end; i++) {
 		pingcur = &swath->data[i];
+		dddepth = pingcur->footdepth;
+
+		/* set all footprint flags to zero */
+		for (int j = 0; j < pingcur->beams_bath; j++)
+			pingcur->bathflag[j] = false;
+		for (int j = 0; j < pingcur->pixels_ss; j++)
+			pingcur->ssflag[j] = false;
 
 		/* get heading if using fore-aft beam width */
 		if (Ctrl->A.mode == MBSWATH_FOOTPRINT_REAL) {
@@ -784,7 +764,7 @@ int mbswath_get_footprints(int verbose, struct MBSWATH_CTRL *Ctrl, int *error) {
 			headingy = cos(pingcur->heading * DTR);
 		}
 
-		/* do bathymetry */
+		/* get the obvious footprint boundaries of the inner beams */
 		if (dobath)
 			for (int j = 1; j < pingcur->beams_bath - 1; j++)
 				if (mb_beam_ok(pingcur->beamflag[j])) {
@@ -925,19 +905,8 @@ int mbswath_get_footprints(int verbose, struct MBSWATH_CTRL *Ctrl, int *error) {
 						print->y[3] = y + dlat1 + pingcur->latfor;
 					}
 				}
-	}
-
-	/* loop over the outer beams and get
-	    the obvious footprint boundaries */
-	for (int i = 0; i < swath->npings; i++) {
-		pingcur = &swath->data[i];
-
-		/* get heading if using fore-aft beam width */
-		if (Ctrl->A.mode == MBSWATH_FOOTPRINT_REAL) {
-			headingx = sin(pingcur->heading * DTR);
-			headingy = cos(pingcur->heading * DTR);
-		}
 
+		/* get the obvious footprint boundaries of the outer beams */
 		/* do bathymetry with more than 2 soundings */
 		if (dobath && pingcur->beams_bath > 2) {
 			int j = 0;
@@ -1130,7 +1099,135 @@ int mbswath_get_footprints(int verbose, struct MBSWATH_CTRL *Ctrl, int *error) {
 		}
 	}
 
+	return (NULL);
+}
+
+int mbswath_get_footprints(int verbose, struct MBSWATH_CTRL *Ctrl, int *error) {
+	struct swath *swath = Ctrl->swath_plot;
+	// struct mb_io_struct *mb_io_ptr = (struct mb_io_struct *)Ctrl->mbio_ptr;
+
+	if (verbose >= 2) {
+		fprintf(stderr, "\ndbg2  MBSWATH function <%s> called\n", __func__);
+		fprintf(stderr, "dbg2  Input arguments:\n");
+		fprintf(stderr, "dbg2       verbose:                  %d\n", verbose);
+		fprintf(stderr, "dbg2       Ctrl->A.mode:             %d\n", Ctrl->A.mode);
+		fprintf(stderr, "dbg2       Ctrl->A.factor:           %f\n", Ctrl->A.factor);
+		fprintf(stderr, "dbg2       Ctrl->A.depth:            %f\n", Ctrl->A.depth);
+		fprintf(stderr, "dbg2       Ctrl->footprint_factor:   %f\n", Ctrl->footprint_factor);
+		fprintf(stderr, "dbg2       Ctrl->swath_plot:         %p\n", Ctrl->swath_plot);
+		fprintf(stderr, "dbg2       Ctrl->mtodeglon:          %f\n", Ctrl->mtodeglon);
+		fprintf(stderr, "dbg2       Ctrl->mtodeglat:          %f\n", Ctrl->mtodeglat);
+		fprintf(stderr, "dbg2       pings:                    %d\n", swath->npings);
+	}
+
+	/* set mode of operation */
+	bool dobath;
+	bool doss;
+	if (Ctrl->Z.mode != MBSWATH_SS && Ctrl->Z.mode != MBSWATH_SS_FILTER) {
+		dobath = true;
+		doss = false;
+	}
+	else {
+		dobath = false;
+		doss = true;
+	}
+
+	struct ping *pingcur;
+	double headingx;
+	double headingy;
+	double rfactor = 0.0;
+
+	/* get fore-aft components of beam footprints */
+	if (swath->npings > 1 && Ctrl->A.mode == MBSWATH_FOOTPRINT_FAKE) {
+		for (int i = 0; i < swath->npings; i++) {
+			/* initialize */
+			pingcur = &swath->data[i];
+			pingcur->lonaft = 0.0;
+			pingcur->lataft = 0.0;
+			pingcur->lonfor = 0.0;
+			pingcur->latfor = 0.0;
+
+			/* get aft looking */
+			if (i > 0) {
+				headingx = sin(pingcur->heading * DTR);
+				headingy = cos(pingcur->heading * DTR);
+				const double dx = (swath->data[i - 1].navlon - pingcur->navlon) / Ctrl->mtodeglon;
+				const double dy = (swath->data[i - 1].navlat - pingcur->navlat) / Ctrl->mtodeglat;
+				const double r = sqrt(dx * dx + dy * dy);
+				pingcur->lonaft = Ctrl->footprint_factor * r * headingx * Ctrl->mtodeglon;
+				pingcur->lataft = Ctrl->footprint_factor * r * headingy * Ctrl->mtodeglat;
+			}
+
+			/* get forward looking */
+			if (i < swath->npings - 1) {
+				headingx = sin(pingcur->heading * DTR);
+				headingy = cos(pingcur->heading * DTR);
+				const double dx = (swath->data[i + 1].navlon - pingcur->navlon) / Ctrl->mtodeglon;
+				const double dy = (swath->data[i + 1].navlat - pingcur->navlat) / Ctrl->mtodeglat;
+				const double r = sqrt(dx * dx + dy * dy);
+				pingcur->lonfor = Ctrl->footprint_factor * r * headingx * Ctrl->mtodeglon;
+				pingcur->latfor = Ctrl->footprint_factor * r * headingy * Ctrl->mtodeglat;
+			}
+
+			/* take care of first ping */
+			if (i == 0) {
+				pingcur->lonaft = -pingcur->lonfor;
+				pingcur->lataft = -pingcur->latfor;
+			}
+
+			/* take care of last ping */
+			if (i == swath->npings - 1) {
+				pingcur->lonfor = -pingcur->lonaft;
+				pingcur->latfor = -pingcur->lataft;
+			}
+		}
+	}
+
+	/* take care of just one ping with nonzero center beam */
+	else if (swath->npings == 1 && Ctrl->A.mode == MBSWATH_FOOTPRINT_FAKE &&
+	         mb_beam_ok(swath->data[0].beamflag[swath->data[0].beams_bath / 2]) && Ctrl->A.depth <= 0.0) {
+		pingcur = &swath->data[0];
+		headingx = sin(pingcur->heading * DTR);
+		headingy = cos(pingcur->heading * DTR);
+		const double tt = pingcur->bath[pingcur->beams_bath / 2] / 750.0; /* in s */
+		const double r = tt * pingcur->speed * 0.55555556;                /* in m */
+		pingcur->lonaft = -Ctrl->footprint_factor * r * headingx * Ctrl->mtodeglon;
+		pingcur->lataft = -Ctrl->footprint_factor * r * headingy * Ctrl->mtodeglat;
+		pingcur->lonfor = Ctrl->footprint_factor * r * headingx * Ctrl->mtodeglon;
+		pingcur->latfor = Ctrl->footprint_factor * r * headingy * Ctrl->mtodeglat;
+	}
+
+	/* else get rfactor if using fore-aft beam width */
+	else if (Ctrl->A.mode == MBSWATH_FOOTPRINT_REAL) {
+		rfactor = 0.5 * sin(DTR * Ctrl->footprint_factor);
+	}
+
+	/* get the depth used for the fore-aft beam width of each ping, carrying
+	   the last depth found forward to pings without one (sidescan only) */
+	static double dddepth = 0.0;
+	for (int i = 0; i < swath->npings; i++) {
+		pingcur = &swath->data[i];
+		if (Ctrl->A.depth > 0.0)
+			dddepth = Ctrl->A.depth;
+		else if (pingcur->altitude > 0.0)
+			dddepth = pingcur->altitude;
+		else if (pingcur->beams_bath > 0 && mb_beam_ok(pingcur->beamflag[pingcur->beams_bath / 2]))
+			dddepth = pingcur->bath[pingcur->beams_bath / 2];
+		pingcur->footdepth = dddepth;
+	}
+
+	/* get the footprints of blocks of pings concurrently */
+	struct mbswath_work work[MB_THREAD_MAX];
+	for (int ithread = 0; ithread < MB_THREAD_MAX; ithread++) {
+		work[ithread].Ctrl = Ctrl;
+		work[ithread].dobath = dobath;
+		work[ithread].doss = doss;
+		work[ithread].rfactor = rfactor;
+	}
+	mbswath_run(Ctrl->M.nthreads, 0, swath->npings, mbswath_footprints_worker, work);
+
 	if (verbose >= 2) {
+		struct footprint *print;
 		fprintf(stderr, "\ndbg2  Beam footprints found in function <%s>\n", __func__);
 		fprintf(stderr, "dbg2       npings:         %d\n", swath->npings);
 		fprintf(stderr, "dbg2       error:          %d\n", *error);
@@ -1172,37 +1269,19 @@ int mbswath_get_footprints(int verbose, struct MBSWATH_CTRL *Ctrl, int *error) {
 }
 
 /*--------------------------------------------------------------------*/
-int mbswath_get_shading(int verbose, struct MBSWATH_CTRL *Ctrl, struct GMT_CTRL *GMT, struct GMT_PALETTE *CPT, int *error) {
+/* Get the shading of the pings [start, end) in the swath buffer. Each ping
+   only writes its own shading, reading the bathymetry of its neighbors,
+   so blocks of pings are done concurrently. */
+static void *mbswath_shading_worker(void *arg) {
+	struct mbswath_work *work = (struct mbswath_work *)arg;
+	struct MBSWATH_CTRL *Ctrl = work->Ctrl;
+	struct GMT_CTRL *GMT = work->GMT;
+	struct GMT_PALETTE *CPT = work->CPT;
 	struct swath *swath = Ctrl->swath_plot;
 
-	if (verbose >= 2) {
-		fprintf(stderr, "\ndbg2  MBSWATH function <%s> called\n", __func__);
-		fprintf(stderr, "dbg2  Input arguments:\n");
-		fprintf(stderr, "dbg2       verbose:            %d\n", verbose);
-		fprintf(stderr, "dbg2       Ctrl:               %p\n", Ctrl);
-		fprintf(stderr, "dbg2       Ctrl->Z.mode:       %d\n", Ctrl->Z.mode);
-		if (Ctrl->Z.mode == MBSWATH_BATH_RELIEF) {
-			fprintf(stderr, "dbg2       Ctrl->G.magnitude:  %f shaded relief magnitude\n", Ctrl->G.magnitude);
-			fprintf(stderr, "dbg2       Ctrl->G.azimuth:    %f shaded relief azimuth\n", Ctrl->G.azimuth);
-		}
-		else if (Ctrl->Z.mode == MBSWATH_BATH_AMP) {
-			fprintf(stderr, "dbg2       Ctrl->G.magnitude:  %f amplitude shading magnitude\n", Ctrl->G.magnitude);
-			fprintf(stderr, "dbg2       Ctrl->G.azimuth:    %f amplitude shading center\n", Ctrl->G.azimuth);
-			fprintf(stderr, "dbg2       Ctrl->N.active:     %d\n", Ctrl->N.active);
-			if (Ctrl->N.active)
-				fprintf(stderr, "dbg2       Ctrl->N.cptfile:    %s\n", Ctrl->N.cptfile);
-		}
-		fprintf(stderr, "dbg2       GMT:                %p\n", GMT);
-		fprintf(stderr, "dbg2       CPT:                %p\n", CPT);
-		fprintf(stderr, "dbg2       swath:              %p\n", swath);
-		fprintf(stderr, "dbg2       pings:              %d\n", swath->npings);
-		fprintf(stderr, "dbg2       Ctrl->mtodeglon:          %f\n", Ctrl->mtodeglon);
-		fprintf(stderr, "dbg2       Ctrl->mtodeglat:          %f\n", Ctrl->mtodeglat);
-	}
-
-	struct ping *ping0;
+	struct ping *ping0 = NULL;
 	struct ping *ping1;
-	struct ping *ping2;
+	struct ping *ping2 = NULL;
 	int drvcount;
 	double dx, dy, dd;
 	double dst2;
@@ -1218,7 +1297,7 @@ int mbswath_get_shading(int verbose, struct MBSWATH_CTRL *Ctrl, struct GMT_CTRL
 		cosy = cos(DTR * Ctrl->G.azimuth);
 
 		/* loop over the pings and beams */
-		for (int i = 0; i < swath->npings; i++) {
+		for (int i = work->start; i < work->end; i++) {
 			if (i > 0)
 				ping0 = &swath->data[i - 1];
 			ping1 = &swath->data[i];
@@ -1294,7 +1373,7 @@ int mbswath_get_shading(int verbose, struct MBSWATH_CTRL *Ctrl, struct GMT_CTRL
 	/* get shading from amplitude data using cpt file */
 	else if (Ctrl->Z.mode == MBSWATH_BATH_AMP && Ctrl->N.active) {
 		/* loop over the pings and beams */
-		for (int i = 0; i < swath->npings; i++) {
+		for (int i = work->start; i < work->end; i++) {
 			if (i > 0)
 				ping0 = &swath->data[i - 1];
 			ping1 = &swath->data[i];
@@ -1321,7 +1400,7 @@ int mbswath_get_shading(int verbose, struct MBSWATH_CTRL *Ctrl, struct GMT_CTRL
 		// double median = Ctrl->G.azimuth;
 
 		/* loop over the pings and beams */
-		for (int i = 0; i < swath->npings; i++) {
+		for (int i = work->start; i < work->end; i++) {
 			if (i > 0)
 				ping0 = &swath->data[i - 1];
 			ping1 = &swath->data[i];
@@ -1338,7 +1417,48 @@ int mbswath_get_shading(int verbose, struct MBSWATH_CTRL *Ctrl, struct GMT_CTRL
 		}
 	}
 
+	return (NULL);
+}
+/*--------------------------------------------------------------------*/
+int mbswath_get_shading(int verbose, struct MBSWATH_CTRL *Ctrl, struct GMT_CTRL *GMT, struct GMT_PALETTE *CPT, int *error) {
+	struct swath *swath = Ctrl->swath_plot;
+
 	if (verbose >= 2) {
+		fprintf(stderr, "\ndbg2  MBSWATH function <%s> called\n", __func__);
+		fprintf(stderr, "dbg2  Input arguments:\n");
+		fprintf(stderr, "dbg2       verbose:            %d\n", verbose);
+		fprintf(stderr, "dbg2       Ctrl:               %p\n", Ctrl);
+		fprintf(stderr, "dbg2       Ctrl->Z.mode:       %d\n", Ctrl->Z.mode);
+		if (Ctrl->Z.mode == MBSWATH_BATH_RELIEF) {
+			fprintf(stderr, "dbg2       Ctrl->G.magnitude:  %f shaded relief magnitude\n", Ctrl->G.magnitude);
+			fprintf(stderr, "dbg2       Ctrl->G.azimuth:    %f shaded relief azimuth\n", Ctrl->G.azimuth);
+		}
+		else if (Ctrl->Z.mode == MBSWATH_BATH_AMP) {
+			fprintf(stderr, "dbg2       Ctrl->G.magnitude:  %f amplitude shading magnitude\n", Ctrl->G.magnitude);
+			fprintf(stderr, "dbg2       Ctrl->G.azimuth:    %f amplitude shading center\n", Ctrl->G.azimuth);
+			fprintf(stderr, "dbg2       Ctrl->N.active:     %d\n", Ctrl->N.active);
+			if (Ctrl->N.active)
+				fprintf(stderr, "dbg2       Ctrl->N.cptfile:    %s\n", Ctrl->N.cptfile);
+		}
+		fprintf(stderr, "dbg2       GMT:                %p\n", GMT);
+		fprintf(stderr, "dbg2       CPT:                %p\n", CPT);
+		fprintf(stderr, "dbg2       swath:              %p\n", swath);
+		fprintf(stderr, "dbg2       pings:              %d\n", swath->npings);
+		fprintf(stderr, "dbg2       Ctrl->mtodeglon:          %f\n", Ctrl->mtodeglon);
+		fprintf(stderr, "dbg2       Ctrl->mtodeglat:          %f\n", Ctrl->mtodeglat);
+	}
+
+	/* get the shading of blocks of pings concurrently */
+	struct mbswath_work work[MB_THREAD_MAX];
+	for (int ithread = 0; ithread < MB_THREAD_MAX; ithread++) {
+		work[ithread].Ctrl = Ctrl;
+		work[ithread].GMT = GMT;
+		work[ithread].CPT = CPT;
+	}
+	mbswath_run(Ctrl->M.nthreads, 0, swath->npings, mbswath_shading_worker, work);
+
+	if (verbose >= 2) {
+		struct ping *ping1;
 		fprintf(stderr, "\ndbg2  Shading values in function <%s>\n", __func__);
 		fprintf(stderr, "dbg2       npings:         %d\n", swath->npings);
 		fprintf(stderr, "dbg2       error:          %d\n", *error);
@@ -1367,16 +1487,120 @@ int mbswath_get_shading(int verbose, struct MBSWATH_CTRL *Ctrl, struct GMT_CTRL
 }
 
 /*--------------------------------------------------------------------*/
-int mbswath_plot_box(int verbose, struct MBSWATH_CTRL *Ctrl, struct GMT_CTRL *GMT, struct PSL_CTRL *PSL, double *x, double *y,
-                     double *rgb, int *error) {
-	int status = MB_SUCCESS;
-	int ix[5], iy[5];
+/* Get the pixel corners and image color of a footprint box given in
+   plot coordinates. */
+static void mbswath_get_box(struct MBSWATH_CTRL *Ctrl, double *x, double *y, double *rgb, struct mbswath_box *box) {
+	for (int i = 0; i < 4; i++) {
+		box->ix[i] = (int)(Ctrl->nx * x[i] / Ctrl->x_inch);
+		box->iy[i] = (int)(Ctrl->ny * y[i] / Ctrl->y_inch);
+	}
+	box->ix[4] = box->ix[0];
+	box->iy[4] = box->iy[0];
+	if (Ctrl->image_type == MBSWATH_IMAGE_8) {
+		box->color[0] = (unsigned char)(255 * YIQ(rgb));
+		box->color[1] = box->color[0];
+		box->color[2] = box->color[0];
+	}
+	else {
+		box->color[0] = (unsigned char)(255 * rgb[0]);
+		box->color[1] = (unsigned char)(255 * rgb[1]);
+		box->color[2] = (unsigned char)(255 * rgb[2]);
+	}
+	box->plot = true;
+}
+/*--------------------------------------------------------------------*/
+/* Rasterize a footprint box into the image rows [iystart, iyend]. */
+static void mbswath_fill_box(struct MBSWATH_CTRL *Ctrl, const struct mbswath_box *box, int iystart, int iyend) {
 	int ixmin, ixmax, iymin, iymax;
 	int ixx, iyy;
 	int ixx1, ixx2;
 	double dx, dy;
 	int ncross, xcross[10];
 
+	/* get min max values of bounding corners in pixels */
+	ixmin = box->ix[0];
+	ixmax = box->ix[0];
+	iymin = box->iy[0];
+	iymax = box->iy[0];
+	for (int i = 1; i < 4; i++) {
+		if (box->ix[i] < ixmin)
+			ixmin = box->ix[i];
+		if (box->ix[i] > ixmax)
+			ixmax = box->ix[i];
+		if (box->iy[i] < iymin)
+			iymin = box->iy[i];
+		if (box->iy[i] > iymax)
+			iymax = box->iy[i];
+	}
+	if (ixmin < 0)
+		ixmin = 0;
+	if (ixmax > Ctrl->nx - 1)
+		ixmax = Ctrl->nx - 1;
+	if (iymin < MAX(iystart, 1))
+		iymin = MAX(iystart, 1);
+	if (iymax > MIN(iyend, Ctrl->ny - 1))
+		iymax = MIN(iyend, Ctrl->ny - 1);
+
+	/* loop over all y values */
+	for (iyy = iymin; iyy <= iymax; iyy++) {
+		/* find crossings */
+		ncross = 0;
+		for (int i = 0; i < 4; i++) {
+			if ((box->iy[i] <= iyy && box->iy[i + 1] >= iyy) || (box->iy[i] >= iyy && box->iy[i + 1] <= iyy)) {
+				if (box->iy[i] == box->iy[i + 1]) {
+					xcross[ncross] = box->ix[i];
+					ncross++;
+					xcross[ncross] = box->ix[i + 1];
+					ncross++;
+				}
+				else {
+					dy = box->iy[i + 1] - box->iy[i];
+					dx = box->ix[i + 1] - box->ix[i];
+					xcross[ncross] = (int)((iyy - box->iy[i]) * dx / dy + box->ix[i]);
+					ncross++;
+				}
+			}
+		}
+
+		/* plot lines between crossings */
+		for (int j = 0; j < ncross - 1; j++) {
+			if (xcross[j] < xcross[j + 1]) {
+				ixx1 = xcross[j];
+				ixx2 = xcross[j + 1];
+			}
+			else {
+				ixx1 = xcross[j + 1];
+				ixx2 = xcross[j];
+			}
+			if ((ixx1 < ixmin && ixx2 < ixmin) || (ixx1 > ixmax && ixx2 > ixmax))
+				ixx2 = ixx1 - 1; /* disable plotting */
+			else {
+				if (ixx1 < ixmin)
+					ixx1 = ixmin;
+				if (ixx2 > ixmax)
+					ixx2 = ixmax;
+			}
+			for (ixx = ixx1; ixx <= ixx2; ixx++) {
+				/*			fprintf(stderr,"plot %d %d\n",ixx,iyy);*/
+				if (Ctrl->image_type == MBSWATH_IMAGE_8) {
+					const int k = Ctrl->nx * (Ctrl->ny - iyy) + ixx;
+					Ctrl->bitimage[k] = box->color[0];
+				}
+				else {
+					const int k = 3 * (Ctrl->nx * (Ctrl->ny - iyy) + ixx);
+					Ctrl->bitimage[k] = box->color[0];
+					Ctrl->bitimage[k + 1] = box->color[1];
+					Ctrl->bitimage[k + 2] = box->color[2];
+				}
+			}
+		}
+	}
+}
+/*--------------------------------------------------------------------*/
+int mbswath_plot_box(int verbose, struct MBSWATH_CTRL *Ctrl, struct GMT_CTRL *GMT, struct PSL_CTRL *PSL, double *x, double *y,
+                     double *rgb, int *error) {
+	int status = MB_SUCCESS;
+
 	if (verbose >= 2) {
 		fprintf(stderr, "\ndbg2  MBSWATH function <%s> called\n", __func__);
 		fprintf(stderr, "dbg2  Input arguments:\n");
@@ -1404,96 +1628,9 @@ int mbswath_plot_box(int verbose, struct MBSWATH_CTRL *Ctrl, struct GMT_CTRL *GM
 
 	/* if image plot then rasterize the box */
 	else if (Ctrl->image_type == MBSWATH_IMAGE_8 || Ctrl->image_type == MBSWATH_IMAGE_24) {
-		/* get bounds of box in pixels */
-		for (int i = 0; i < 4; i++) {
-			ix[i] = (int)(Ctrl->nx * x[i] / Ctrl->x_inch);
-			iy[i] = (int)(Ctrl->ny * y[i] / Ctrl->y_inch);
-		}
-		ix[4] = ix[0];
-		iy[4] = iy[0];
-
-		/* get min max values of bounding corners in pixels */
-		ixmin = ix[0];
-		ixmax = ix[0];
-		iymin = iy[0];
-		iymax = iy[0];
-		for (int i = 1; i < 4; i++) {
-			if (ix[i] < ixmin)
-				ixmin = ix[i];
-			if (ix[i] > ixmax)
-				ixmax = ix[i];
-			if (iy[i] < iymin)
-				iymin = iy[i];
-			if (iy[i] > iymax)
-				iymax = iy[i];
-		}
-		if (ixmin < 0)
-			ixmin = 0;
-		if (ixmax > Ctrl->nx - 1)
-			ixmax = Ctrl->nx - 1;
-		if (iymin < 1)
-			iymin = 1;
-		if (iymax > Ctrl->ny - 1)
-			iymax = Ctrl->ny - 1;
-
-		/* loop over all y values */
-		for (iyy = iymin; iyy <= iymax; iyy++) {
-			/* find crossings */
-			ncross = 0;
-			for (int i = 0; i < 4; i++) {
-				if ((iy[i] <= iyy && iy[i + 1] >= iyy) || (iy[i] >= iyy && iy[i + 1] <= iyy)) {
-					if (iy[i] == iy[i + 1]) {
-						xcross[ncross] = ix[i];
-						ncross++;
-						xcross[ncross] = ix[i + 1];
-						ncross++;
-					}
-					else {
-						dy = iy[i + 1] - iy[i];
-						dx = ix[i + 1] - ix[i];
-						xcross[ncross] = (int)((iyy - iy[i]) * dx / dy + ix[i]);
-						ncross++;
-					}
-				}
-			}
-
-			/* plot lines between crossings */
-			for (int j = 0; j < ncross - 1; j++) {
-				if (xcross[j] < xcross[j + 1]) {
-					ixx1 = xcross[j];
-					ixx2 = xcross[j + 1];
-				}
-				else {
-					ixx1 = xcross[j + 1];
-					ixx2 = xcross[j];
-				}
-				if ((ixx1 < ixmin && ixx2 < ixmin) || (ixx1 > ixmax && ixx2 > ixmax))
-					ixx2 = ixx1 - 1; /* disable plotting */
-				else {
-					if (ixx1 < ixmin)
-						ixx1 = ixmin;
-					if (ixx2 > ixmax)
-						ixx2 = ixmax;
-				}
-				for (ixx = ixx1; ixx <= ixx2; ixx++) {
-					/*			fprintf(stderr,"plot %d %d\n",ixx,iyy);*/
-					if (Ctrl->image_type == MBSWATH_IMAGE_8) {
-						const int k = Ctrl->nx * (Ctrl->ny - iyy) + ixx;
-						Ctrl->bitimage[k] = (unsigned char)(255 * YIQ(rgb));
-						// fprintf(stderr,"k:%d rgb: %f %f %f   bitimage: %u\n",
-						// k,rgb[0],rgb[1],rgb[2],Ctrl->bitimage[k]);
-					}
-					else {
-						const int k = 3 * (Ctrl->nx * (Ctrl->ny - iyy) + ixx);
-						Ctrl->bitimage[k] = (unsigned char)(255 * rgb[0]);
-						Ctrl->bitimage[k + 1] = (unsigned char)(255 * rgb[1]);
-						Ctrl->bitimage[k + 2] = (unsigned char)(255 * rgb[2]);
-						// fprintf(stderr,"k:%d rgb: %f %f %f   bitimage: %u %u %u\n",
-						// k,rgb[0],rgb[1],rgb[2],Ctrl->bitimage[k],Ctrl->bitimage[k+1],Ctrl->bitimage[k+2]);
-					}
-				}
-			}
-		}
+		struct mbswath_box box;
+		mbswath_get_box(Ctrl, x, y, rgb, &box);
+		mbswath_fill_box(Ctrl, &box, 1, Ctrl->ny - 1);
 	}
 
 	/* assume success */
@@ -1511,6 +1648,81 @@ int mbswath_plot_box(int verbose, struct MBSWATH_CTRL *Ctrl, struct GMT_CTRL *GM
 	return (status);
 }
 /*--------------------------------------------------------------------*/
+/* Project the footprints of the pings [start, end) to image pixels and
+   get their colors, storing box_offset[i] + j for beam j of ping i. The
+   projection and color lookups only read the GMT and CPT structures. */
+static void *mbswath_boxes_worker(void *arg) {
+	struct mbswath_work *work = (struct mbswath_work *)arg;
+	struct MBSWATH_CTRL *Ctrl = work->Ctrl;
+	struct GMT_CTRL *GMT = work->GMT;
+	struct GMT_PALETTE *CPT = work->CPT;
+	struct swath *swath = Ctrl->swath_plot;
+	struct ping *pingcur;
+	struct footprint *print;
+	struct mbswath_box *box;
+	double xx[4], yy[4];
+	double rgb[4];
+
+	for (int i = work->start; i < work->end; i++) {
+		pingcur = &swath->data[i];
+		box = &Ctrl->boxes[work->box_offset[i]];
+		if (Ctrl->Z.mode == MBSWATH_BATH || Ctrl->Z.mode == MBSWATH_BATH_RELIEF || Ctrl->Z.mode == MBSWATH_BATH_AMP) {
+			for (int j = 0; j < pingcur->beams_bath; j++) {
+				box[j].plot = false;
+				if (pingcur->bathflag[j]) {
+					print = &pingcur->bathfoot[j];
+					for (int k = 0; k < 4; k++)
+						gmt_geo_to_xy(GMT, print->x[k], print->y[k], &xx[k], &yy[k]);
+					gmt_get_rgb_from_z(GMT, CPT, pingcur->bath[j], rgb);
+					if (Ctrl->Z.mode == MBSWATH_BATH_RELIEF || Ctrl->Z.mode == MBSWATH_BATH_AMP)
+						gmt_illuminate(GMT, pingcur->bathshade[j], rgb);
+					mbswath_get_box(Ctrl, xx, yy, rgb, &box[j]);
+				}
+			}
+		}
+		else if (Ctrl->Z.mode == MBSWATH_AMP) {
+			for (int j = 0; j < pingcur->beams_amp; j++) {
+				box[j].plot = false;
+				if (pingcur->bathflag[j]) {
+					print = &pingcur->bathfoot[j];
+					for (int k = 0; k < 4; k++)
+						gmt_geo_to_xy(GMT, print->x[k], print->y[k], &xx[k], &yy[k]);
+					gmt_get_rgb_from_z(GMT, CPT, pingcur->amp[j], rgb);
+					mbswath_get_box(Ctrl, xx, yy, rgb, &box[j]);
+				}
+			}
+		}
+		else if (Ctrl->Z.mode == MBSWATH_SS) {
+			for (int j = 0; j < pingcur->pixels_ss; j++) {
+				box[j].plot = false;
+				if (pingcur->ssflag[j]) {
+					print = &pingcur->ssfoot[j];
+					for (int k = 0; k < 4; k++)
+						gmt_geo_to_xy(GMT, print->x[k], print->y[k], &xx[k], &yy[k]);
+					gmt_get_rgb_from_z(GMT, CPT, pingcur->ss[j], rgb);
+					mbswath_get_box(Ctrl, xx, yy, rgb, &box[j]);
+				}
+			}
+		}
+	}
+
+	return (NULL);
+}
+/*--------------------------------------------------------------------*/
+/* Rasterize all of the boxes into the image rows [start, end). Boxes
+   are drawn in ping and beam order so that where footprints overlap the
+   image is the same as when they are drawn one at a time. */
+static void *mbswath_fill_worker(void *arg) {
+	struct mbswath_work *work = (struct mbswath_work *)arg;
+	struct MBSWATH_CTRL *Ctrl = work->Ctrl;
+
+	for (int n = 0; n < work->nboxes; n++)
+		if (Ctrl->boxes[n].plot)
+			mbswath_fill_box(Ctrl, &Ctrl->boxes[n], work->start, work->end - 1);
+
+	return (NULL);
+}
+/*--------------------------------------------------------------------*/
 int mbswath_plot_data_footprint(int verbose, struct MBSWATH_CTRL *Ctrl, struct GMT_CTRL *GMT, struct GMT_PALETTE *CPT,
                                 struct PSL_CTRL *PSL, int first, int nplot, int *error) {
 	int status = MB_SUCCESS;
@@ -1551,7 +1763,42 @@ int mbswath_plot_data_footprint(int verbose, struct MBSWATH_CTRL *Ctrl, struct G
 		fprintf(stderr, "dbg2       nplot:      %d\n", nplot);
 	}
 
-	if (Ctrl->Z.mode == MBSWATH_BATH || Ctrl->Z.mode == MBSWATH_BATH_RELIEF || Ctrl->Z.mode == MBSWATH_BATH_AMP) {
+	/* if image plot then project and color the footprints of blocks of
+	    pings concurrently, then rasterize them into bands of image rows
+	    concurrently */
+	if (Ctrl->image_type == MBSWATH_IMAGE_8 || Ctrl->image_type == MBSWATH_IMAGE_24) {
+		int box_offset[MAXPINGS + 1];
+		int nboxes = 0;
+		for (int i = first; i < first + nplot; i++) {
+			pingcur = &swath->data[i];
+			box_offset[i] = nboxes;
+			if (Ctrl->Z.mode == MBSWATH_BATH || Ctrl->Z.mode == MBSWATH_BATH_RELIEF || Ctrl->Z.mode == MBSWATH_BATH_AMP)
+				nboxes += pingcur->beams_bath;
+			else if (Ctrl->Z.mode == MBSWATH_AMP)
+				nboxes += pingcur->beams_amp;
+			else if (Ctrl->Z.mode == MBSWATH_SS)
+				nboxes += pingcur->pixels_ss;
+		}
+		if (nboxes > Ctrl->nboxes_alloc) {
+			Ctrl->boxes = gmt_M_memory(GMT, Ctrl->boxes, nboxes, struct mbswath_box);
+			Ctrl->nboxes_alloc = nboxes;
+		}
+
+		struct mbswath_work work[MB_THREAD_MAX];
+		for (int ithread = 0; ithread < MB_THREAD_MAX; ithread++) {
+			work[ithread].Ctrl = Ctrl;
+			work[ithread].GMT = GMT;
+			work[ithread].CPT = CPT;
+			work[ithread].box_offset = box_offset;
+			work[ithread].nboxes = nboxes;
+		}
+		if (nboxes > 0) {
+			mbswath_run(Ctrl->M.nthreads, first, first + nplot, mbswath_boxes_worker, work);
+			mbswath_run(Ctrl->M.nthreads, 1, Ctrl->ny, mbswath_fill_worker, work);
+		}
+	}
+
+	else if (Ctrl->Z.mode == MBSWATH_BATH || Ctrl->Z.mode == MBSWATH_BATH_RELIEF || Ctrl->Z.mode == MBSWATH_BATH_AMP) {
 		/* loop over all pings and beams and plot the good ones */
 		for (int i = first; i < first + nplot; i++) {
 			pingcur = &swath->data[i];
@@ -2070,6 +2317,10 @@ int GMT_mbswath(void *V_API, int mode, void *args) {
 		memset(Ctrl->bitimage, 255, 3 * Ctrl->nm);
 	}
 
+	/* get the number of threads used for the beam footprints */
+	Ctrl->M.nthreads = mb_nthreads(Ctrl->M.nthreads);
+	GMT_Report(API, GMT_MSG_VERBOSE, "Rendering beam footprints with %d threads\n", Ctrl->M.nthreads);
+
 	/* get format if required */
 	if (Ctrl->F.format == 0)
 		mb_get_format(verbose, Ctrl->I.inputfile, NULL, &Ctrl->F.format, &error);
@@ -2458,6 +2709,8 @@ int GMT_mbswath(void *V_API, int mode, void *args) {
 	/* Free bitimage arrays. gmt_M_free will not complain if they have not been used (NULL) */
 	if (Ctrl->bitimage)
 		gmt_M_free(GMT, Ctrl->bitimage);
+	if (Ctrl->boxes)
+		gmt_M_free(GMT, Ctrl->boxes);
 
 	if (!Ctrl->C.active && GMT_Destroy_Data(API, &CPTcolor) != GMT_OK) {
 		Return(API->error);
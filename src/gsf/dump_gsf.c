@@ -33,7 +33,7 @@
 #include "gsf.h"
 
 /* global external data required by this module */
-extern int gsfError;
+extern GSF_THREAD_LOCAL int gsfError;
 
 /* static global data for this module */
 static gsfRecords gsfRec;
@@ -114,6 +114,9 @@
  * clb 10-17-11   Handle all the error processing in gsfOpen() and gsfOpenBuffered() consistently
  * clb 11-09-aa   Added validity checks in gsfPutMBParams(); initialize param structure in gsfGetMBParams();
  *                added gsfInitializeMBParams(); validate handles in functions that use them
+ * mbs 2026-10-19 Made the library re-entrant for concurrent use of separate handles: each file table
+ *                entry owns its record stream buffer, gsfError is thread-local, and slot allocation in
+ *                gsfOpenBuffered()/gsfClose() is serialized by a table lock.
  *
  *
  * Classification : Unclassified
@@ -155,6 +158,12 @@
 #include <winsock.h>
 #endif
 
+#if defined(_MSC_VER)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
 /* GSF library interface description */
 #include "gsf.h"
 
@@ -204,12 +213,24 @@
 #define GSF_S_INT_MAX    (2147483647.0)
 
 /* Static Global data for this module */
-static unsigned char streamBuff[GSF_MAX_RECORD_SIZE];
 static int      numOpenFiles;
 static GSF_FILE_TABLE gsfFileTable[GSF_MAX_OPEN_FILES];
 
+/* The file table lock is only held while a slot is claimed or released,
+ * all other access goes through the slot owned by the caller's handle.
+ */
+#if defined(_MSC_VER)
+static SRWLOCK  gsfTableLock = SRWLOCK_INIT;
+#define GSF_TABLE_LOCK()   AcquireSRWLockExclusive(&gsfTableLock)
+#define GSF_TABLE_UNLOCK() ReleaseSRWLockExclusive(&gsfTableLock)
+#else
+static pthread_mutex_t gsfTableLock = PTHREAD_MUTEX_INITIALIZER;
+#define GSF_TABLE_LOCK()   pthread_mutex_lock(&gsfTableLock)
+#define GSF_TABLE_UNLOCK() pthread_mutex_unlock(&gsfTableLock)
+#endif
+
 /* Global external data defined in this module */
-int             gsfError;       /* used to report most recent error */
+GSF_THREAD_LOCAL int gsfError;  /* used to report most recent error of the calling thread */
 
 /* Static functions used, but not exported from this source file */
 static gsfuLong gsfChecksum(unsigned char *buff, unsigned int num_bytes);
@@ -429,17 +450,22 @@ gsfOpenBuffered(const char *filename, const int mode, int *handle, int buf_size)
             return (-1);
     }
 
-    /* Check the number of files currently opened. */
-    if (numOpenFiles >= GSF_MAX_OPEN_FILES)
+    /* Try to open this file */
+    if ((fp = fopen(filename, access_mode)) == (FILE *) NULL)
     {
-        gsfError = GSF_TOO_MANY_OPEN_FILES;
+        gsfError = GSF_FOPEN_ERROR;
         return (-1);
     }
 
-    /* Try to open this file */
-    if ((fp = fopen(filename, access_mode)) == (FILE *) NULL)
+    /* Check the number of files currently opened, and claim a file table
+     * slot while holding the table lock.
+     */
+    GSF_TABLE_LOCK();
+    if (numOpenFiles >= GSF_MAX_OPEN_FILES)
     {
-        gsfError = GSF_FOPEN_ERROR;
+        GSF_TABLE_UNLOCK();
+        gsfError = GSF_TOO_MANY_OPEN_FILES;
+        fclose(fp);
         return (-1);
     }
 
@@ -452,7 +478,6 @@ gsfOpenBuffered(const char *filename, const int mode, int *handle, int buf_size)
      * gsfOpen, so that the ping scale factors don't have to be reset except
      * when a new file is created.
      */
-    numOpenFiles++;
     length = strlen (filename);
     if (length >= sizeof(gsfFileTable[0].file_name))
     {
@@ -485,14 +510,31 @@ gsfOpenBuffered(const char *filename, const int mode, int *handle, int buf_size)
     /* if still no free table is found error out */
     if (fileTableIndex == GSF_MAX_OPEN_FILES)
     {
+        GSF_TABLE_UNLOCK();
         gsfError = GSF_TOO_MANY_OPEN_FILES;
         fclose(fp);
         return (-1);
     }
 
+    gsfFileTable[fileTableIndex].occupied = 1;
+    numOpenFiles++;
+    GSF_TABLE_UNLOCK();
+
+    /* Each open file has its own buffer for packing and unpacking records. */
+    gsfFileTable[fileTableIndex].stream_buff = (unsigned char *) malloc(GSF_MAX_RECORD_SIZE);
+    if (gsfFileTable[fileTableIndex].stream_buff == (unsigned char *) NULL)
+    {
+        GSF_TABLE_LOCK();
+        gsfFileTable[fileTableIndex].occupied = 0;
+        numOpenFiles--;
+        GSF_TABLE_UNLOCK();
+        gsfError = GSF_MEMORY_ALLOCATION_FAILED;
+        fclose(fp);
+        return (-1);
+    }
+
     gsfFileTable[fileTableIndex].fp = fp;
     gsfFileTable[fileTableIndex].buf_size = buf_size;
-    gsfFileTable[fileTableIndex].occupied = 1;
     *handle = fileTableIndex + 1;
 
     /* Set the desired buffer size. */
@@ -738,8 +780,6 @@ gsfClose(const int handle)
         ret = -1;
     }
 
-    numOpenFiles--;
-
     /* jsb 05/14/97 Clear the contents of the gsfFileTable fields. We don't
      * want to clear the filename, this allows a performance improvement for
      * programs which use append to log GSF files. (ie: data acquisition).
@@ -750,7 +790,6 @@ gsfClose(const int handle)
     gsfFileTable[handle-1].previous_record = 0;
     gsfFileTable[handle-1].buf_size = 0;
     gsfFileTable[handle-1].bufferedBytes = 0;
-    gsfFileTable[handle-1].occupied = 0;
     gsfFileTable[handle-1].update_flag = 0;
     gsfFileTable[handle-1].direct_access = 0;
     gsfFileTable[handle-1].read_write_flag = 0;
@@ -768,6 +807,15 @@ gsfClose(const int handle)
     /* Clear the necessary fields of the gsfRecords data structure */
     memset(&gsfFileTable[handle-1].rec.header, 0, sizeof(gsfHeader));
 
+    free(gsfFileTable[handle-1].stream_buff);
+    gsfFileTable[handle-1].stream_buff = (unsigned char *) NULL;
+
+    /* Release the file table slot last, so it is only reused once cleared. */
+    GSF_TABLE_LOCK();
+    gsfFileTable[handle-1].occupied = 0;
+    numOpenFiles--;
+    GSF_TABLE_UNLOCK();
+
     return (ret);
 }
 
@@ -1040,7 +1088,8 @@ gsfUnpackStream (int handle, int desiredRecord, gsfDataID *dataID, gsfRecords *r
     gsfuLong        did;
     gsfDataID       thisID;
     gsfuLong        temp;
-    unsigned char  *dptr = streamBuff;
+    unsigned char  *streamBuff;
+    unsigned char  *dptr;
     gsfuLong        ckSum;
 
     if ((handle < 1) || (handle > GSF_MAX_OPEN_FILES))
@@ -1048,6 +1097,8 @@ gsfUnpackStream (int handle, int desiredRecord, gsfDataID *dataID, gsfRecords *r
         gsfError = GSF_BAD_FILE_HANDLE;
         return (-1);
     }
+    streamBuff = gsfFileTable[handle - 1].stream_buff;
+    dptr = streamBuff;
 
     /* This loop will read one record at a time until the record type
      * desired by the caller is found.
@@ -1585,6 +1636,7 @@ gsfSeekRecord(int handle, gsfDataID *id)
 int
 gsfWrite(int handle, gsfDataID *id, gsfRecords *rptr)
 {
+    unsigned char  *streamBuff;
     unsigned char  *ucptr;
     gsfuLong        tmpBuff[3] =
     {0, 0, 0};
@@ -1605,6 +1657,7 @@ gsfWrite(int handle, gsfDataID *id, gsfRecords *rptr)
         gsfError = GSF_BAD_FILE_HANDLE;
         return (-1);
     }
+    streamBuff = gsfFileTable[handle - 1].stream_buff;
 
     /* See if we need to make room for the optional checksum */
     if (id->checksumFlag)
@@ -185,7 +185,7 @@ extern          "C"
 #define GSF_MAX_RECORD_SIZE    524288
 
 /* Define the maximum number of files which may be open at once */
-#define GSF_MAX_OPEN_FILES     4
+#define GSF_MAX_OPEN_FILES     16
 
 /* Define the GSF data file access flags */
 #define GSF_CREATE             1
@@ -210,6 +210,16 @@ typedef long long      gsfsLongLong;   /* a signed 64-bit integer */
 #define GSF_SHORT_SIZE 2
 #define GSF_LONG_SIZE  4
 
+/* gsfError reports the most recent error of the calling thread, so that
+ * separate handles may be used concurrently from separate threads.
+ */
+#if defined (_MSC_VER)
+  #define GSF_THREAD_LOCAL __declspec(thread)
+#else
+  #define GSF_THREAD_LOCAL __thread
+#endif
+extern GSF_THREAD_LOCAL int gsfError;
+
 /* Redefine gsfError for MinGW applications using gsf.dll, harmless for other compilers */
 #if defined (__MINGW32__) || defined (__MINGW64__)
   #if __GNUC__ < 3
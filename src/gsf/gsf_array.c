@@ -0,0 +1,707 @@
+/********************************************************************
+ *
+ * Module Name : GSF_ARRAY
+ *
+ * Description :
+ *  Bulk conversion kernels for swath bathymetry beam arrays, see
+ *  gsf_array.h. Each kernel has a portable version, which also handles
+ *  the elements left over by the SSE2 and AVX2 versions.
+ *
+ * Change Descriptions :
+ * who  when      what
+ * ---  ----      ----
+ * mbs  2026-10-19 Initial version.
+ *
+ * This library may be redistributed and/or modified under the terms of
+ * the GNU Lesser General Public License version 2.1, as published by the
+ * Free Software Foundation.
+ *
+ ********************************************************************/
+
+#include <string.h>
+
+#include "gsf.h"
+#include "gsf_array.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#define GSF_ARRAY_X86 1
+#include <immintrin.h>
+#define GSF_ARRAY_AVX2 __attribute__((target("avx2")))
+#endif
+
+/* Relaxed loads and stores of the level, which may be read by several
+ * threads. Without the GCC/Clang builtins (e.g. MSVC) a volatile aligned
+ * int is used; only the portable kernels are built there, so the
+ * detected level is always GSF_ARRAY_SIMD_NONE.
+ */
+#if defined(__GNUC__)
+#define GSF_ARRAY_LOAD(ptr) __atomic_load_n((ptr), __ATOMIC_RELAXED)
+#define GSF_ARRAY_STORE(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELAXED)
+#else
+#define GSF_ARRAY_LOAD(ptr) (*(ptr))
+#define GSF_ARRAY_STORE(ptr, value) (*(ptr) = (value))
+#endif
+
+/* Instruction set level in use, -1 until detected */
+static volatile int simdLevel = -1;
+static volatile int simdLevelMax = -1;
+
+/********************************************************************
+ * Portable kernels
+ ********************************************************************/
+
+static void
+DecodeU8(double *array, const unsigned char *sptr, int num_beams, double multiplier, double offset)
+{
+    for (int i = 0; i < num_beams; i++)
+    {
+        array[i] = ((double) sptr[i] / multiplier) - offset;
+    }
+}
+
+static void
+DecodeS8(double *array, const unsigned char *sptr, int num_beams, double multiplier, double offset)
+{
+    for (int i = 0; i < num_beams; i++)
+    {
+        array[i] = ((double) (signed char) sptr[i] / multiplier) - offset;
+    }
+}
+
+static void
+DecodeU16(double *array, const unsigned char *sptr, int num_beams, double multiplier, double offset)
+{
+    for (int i = 0; i < num_beams; i++)
+    {
+        const unsigned short temp = (unsigned short) ((sptr[2 * i] << 8) | sptr[2 * i + 1]);
+        array[i] = ((double) temp / multiplier) - offset;
+    }
+}
+
+static void
+DecodeS16(double *array, const unsigned char *sptr, int num_beams, double multiplier, double offset)
+{
+    for (int i = 0; i < num_beams; i++)
+    {
+        const gsfsShort temp = (gsfsShort) ((sptr[2 * i] << 8) | sptr[2 * i + 1]);
+        array[i] = ((double) temp / multiplier) - offset;
+    }
+}
+
+static void
+DecodeU32(double *array, const unsigned char *sptr, int num_beams, double multiplier, double offset)
+{
+    for (int i = 0; i < num_beams; i++)
+    {
+        const unsigned char *ptr = sptr + 4 * i;
+        const gsfuLong temp = ((gsfuLong) ptr[0] << 24) | ((gsfuLong) ptr[1] << 16) | ((gsfuLong) ptr[2] << 8) | ptr[3];
+        array[i] = ((double) temp / multiplier) - offset;
+    }
+}
+
+static void
+DecodeS32(double *array, const unsigned char *sptr, int num_beams, double multiplier, double offset)
+{
+    for (int i = 0; i < num_beams; i++)
+    {
+        const unsigned char *ptr = sptr + 4 * i;
+        const gsfsLong temp = (gsfsLong) (((gsfuLong) ptr[0] << 24) | ((gsfuLong) ptr[1] << 16) | ((gsfuLong) ptr[2] << 8) | ptr[3]);
+        array[i] = ((double) temp / multiplier) - offset;
+    }
+}
+
+/* Scale a value for encoding, rounding to the nearest whole integer */
+static double
+EncodeScale(double value, double multiplier, double offset)
+{
+    double          dtemp = (value + offset) * multiplier;
+
+    if (dtemp >= 0.0)
+    {
+        dtemp += 0.501;
+    }
+    else
+    {
+        dtemp -= 0.501;
+    }
+    return (dtemp);
+}
+
+static void
+EncodeU8(unsigned char *sptr, const double *array, int num_beams, double multiplier, double offset)
+{
+    for (int i = 0; i < num_beams; i++)
+    {
+        sptr[i] = (unsigned char) EncodeScale(array[i], multiplier, offset);
+    }
+}
+
+static void
+EncodeU16(unsigned char *sptr, const double *array, int num_beams, double multiplier, double offset)
+{
+    for (int i = 0; i < num_beams; i++)
+    {
+        const gsfuShort stemp = (gsfuShort) EncodeScale(array[i], multiplier, offset);
+        sptr[2 * i] = (unsigned char) (stemp >> 8);
+        sptr[2 * i + 1] = (unsigned char) stemp;
+    }
+}
+
+static void
+EncodeS16(unsigned char *sptr, const double *array, int num_beams, double multiplier, double offset)
+{
+    for (int i = 0; i < num_beams; i++)
+    {
+        const gsfuShort stemp = (gsfuShort) (gsfsShort) EncodeScale(array[i], multiplier, offset);
+        sptr[2 * i] = (unsigned char) (stemp >> 8);
+        sptr[2 * i + 1] = (unsigned char) stemp;
+    }
+}
+
+static void
+EncodeU32(unsigned char *sptr, const double *array, int num_beams, double multiplier, double offset)
+{
+    for (int i = 0; i < num_beams; i++)
+    {
+        const gsfuLong ltemp = (gsfuLong) EncodeScale(array[i], multiplier, offset);
+        sptr[4 * i] = (unsigned char) (ltemp >> 24);
+        sptr[4 * i + 1] = (unsigned char) (ltemp >> 16);
+        sptr[4 * i + 2] = (unsigned char) (ltemp >> 8);
+        sptr[4 * i + 3] = (unsigned char) ltemp;
+    }
+}
+
+static void
+EncodeS32(unsigned char *sptr, const double *array, int num_beams, double multiplier, double offset)
+{
+    for (int i = 0; i < num_beams; i++)
+    {
+        const gsfuLong ltemp = (gsfuLong) (gsfsLong) EncodeScale(array[i], multiplier, offset);
+        sptr[4 * i] = (unsigned char) (ltemp >> 24);
+        sptr[4 * i + 1] = (unsigned char) (ltemp >> 16);
+        sptr[4 * i + 2] = (unsigned char) (ltemp >> 8);
+        sptr[4 * i + 3] = (unsigned char) ltemp;
+    }
+}
+
+#ifdef GSF_ARRAY_X86
+
+/********************************************************************
+ * SSE2 kernels
+ ********************************************************************/
+
+/* Scale four int32 values to doubles and store them */
+static inline void
+StoreScaledSSE2(double *array, __m128i v, __m128d m, __m128d o)
+{
+    _mm_storeu_pd(array, _mm_sub_pd(_mm_div_pd(_mm_cvtepi32_pd(v), m), o));
+    _mm_storeu_pd(array + 2, _mm_sub_pd(_mm_div_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(v, 0xEE)), m), o));
+}
+
+/* Swap the bytes of each 16 bit value */
+static inline __m128i
+Swap16SSE2(__m128i x)
+{
+    return (_mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8)));
+}
+
+/* Swap the bytes of each 32 bit value */
+static inline __m128i
+Swap32SSE2(__m128i x)
+{
+    return (Swap16SSE2(_mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0xB1), 0xB1)));
+}
+
+static void
+DecodeU8SSE2(double *array, const unsigned char *sptr, int num_beams, double multiplier, double offset)
+{
+    const __m128d   m = _mm_set1_pd(multiplier);
+    const __m128d   o = _mm_set1_pd(offset);
+    const __m128i   zero = _mm_setzero_si128();
+    int             i = 0;
+
+    for (; i + 16 <= num_beams; i += 16)
+    {
+        const __m128i x = _mm_loadu_si128((const __m128i *) (sptr + i));
+        const __m128i lo = _mm_unpacklo_epi8(x, zero);
+        const __m128i hi = _mm_unpackhi_epi8(x, zero);
+        StoreScaledSSE2(array + i, _mm_unpacklo_epi16(lo, zero), m, o);
+        StoreScaledSSE2(array + i + 4, _mm_unpackhi_epi16(lo, zero), m, o);
+        StoreScaledSSE2(array + i + 8, _mm_unpacklo_epi16(hi, zero), m, o);
+        StoreScaledSSE2(array + i + 12, _mm_unpackhi_epi16(hi, zero), m, o);
+    }
+    DecodeU8(array + i, sptr + i, num_beams - i, multiplier, offset);
+}
+
+static void
+DecodeS8SSE2(double *array, const unsigned char *sptr, int num_beams, double multiplier, double offset)
+{
+    const __m128d   m = _mm_set1_pd(multiplier);
+    const __m128d   o = _mm_set1_pd(offset);
+    int             i = 0;
+
+    for (; i + 16 <= num_beams; i += 16)
+    {
+        const __m128i x = _mm_loadu_si128((const __m128i *) (sptr + i));
+        const __m128i lo = _mm_srai_epi16(_mm_unpacklo_epi8(x, x), 8);
+        const __m128i hi = _mm_srai_epi16(_mm_unpackhi_epi8(x, x), 8);
+        StoreScaledSSE2(array + i, _mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16), m, o);
+        StoreScaledSSE2(array + i + 4, _mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16), m, o);
+        StoreScaledSSE2(array + i + 8, _mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16), m, o);
+        StoreScaledSSE2(array + i + 12, _mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16), m, o);
+    }
+    DecodeS8(array + i, sptr + i, num_beams - i, multiplier, offset);
+}
+
+static void
+DecodeU16SSE2(double *array, const unsigned char *sptr, int num_beams, double multiplier, double offset)
+{
+    const __m128d   m = _mm_set1_pd(multiplier);
+    const __m128d   o = _mm_set1_pd(offset);
+    const __m128i   zero = _mm_setzero_si128();
+    int             i = 0;
+
+    for (; i + 8 <= num_beams; i += 8)
+    {
+        const __m128i x = Swap16SSE2(_mm_loadu_si128((const __m128i *) (sptr + 2 * i)));
+        StoreScaledSSE2(array + i, _mm_unpacklo_epi16(x, zero), m, o);
+        StoreScaledSSE2(array + i + 4, _mm_unpackhi_epi16(x, zero), m, o);
+    }
+    DecodeU16(array + i, sptr + 2 * i, num_beams - i, multiplier, offset);
+}
+
+static void
+DecodeS16SSE2(double *array, const unsigned char *sptr, int num_beams, double multiplier, double offset)
+{
+    const __m128d   m = _mm_set1_pd(multiplier);
+    const __m128d   o = _mm_set1_pd(offset);
+    int             i = 0;
+
+    for (; i + 8 <= num_beams; i += 8)
+    {
+        const __m128i x = Swap16SSE2(_mm_loadu_si128((const __m128i *) (sptr + 2 * i)));
+        StoreScaledSSE2(array + i, _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16), m, o);
+        StoreScaledSSE2(array + i + 4, _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16), m, o);
+    }
+    DecodeS16(array + i, sptr + 2 * i, num_beams - i, multiplier, offset);
+}
+
+static void
+DecodeU32SSE2(double *array, const unsigned char *sptr, int num_beams, double multiplier, double offset)
+{
+    const __m128d   m = _mm_set1_pd(multiplier);
+    const __m128d   o = _mm_set1_pd(offset);
+    const __m128d   zero = _mm_setzero_pd();
+    const __m128d   two32 = _mm_set1_pd(4294967296.0);
+    int             i = 0;
+
+    for (; i + 4 <= num_beams; i += 4)
+    {
+        const __m128i x = Swap32SSE2(_mm_loadu_si128((const __m128i *) (sptr + 4 * i)));
+        __m128d d0 = _mm_cvtepi32_pd(x);
+        __m128d d1 = _mm_cvtepi32_pd(_mm_shuffle_epi32(x, 0xEE));
+        d0 = _mm_add_pd(d0, _mm_and_pd(_mm_cmplt_pd(d0, zero), two32));
+        d1 = _mm_add_pd(d1, _mm_and_pd(_mm_cmplt_pd(d1, zero), two32));
+        _mm_storeu_pd(array + i, _mm_sub_pd(_mm_div_pd(d0, m), o));
+        _mm_storeu_pd(array + i + 2, _mm_sub_pd(_mm_div_pd(d1, m), o));
+    }
+    DecodeU32(array + i, sptr + 4 * i, num_beams - i, multiplier, offset);
+}
+
+static void
+DecodeS32SSE2(double *array, const unsigned char *sptr, int num_beams, double multiplier, double offset)
+{
+    const __m128d   m = _mm_set1_pd(multiplier);
+    const __m128d   o = _mm_set1_pd(offset);
+    int             i = 0;
+
+    for (; i + 4 <= num_beams; i += 4)
+    {
+        StoreScaledSSE2(array + i, Swap32SSE2(_mm_loadu_si128((const __m128i *) (sptr + 4 * i))), m, o);
+    }
+    DecodeS32(array + i, sptr + 4 * i, num_beams - i, multiplier, offset);
+}
+
+/* Scale, round and truncate four values to int32 */
+static inline __m128i
+EncodeScaleSSE2(const double *array, __m128d m, __m128d o)
+{
+    const __m128d   zero = _mm_setzero_pd();
+    const __m128d   pos = _mm_set1_pd(0.501);
+    const __m128d   neg = _mm_set1_pd(-0.501);
+    __m128d         d0 = _mm_mul_pd(_mm_add_pd(_mm_loadu_pd(array), o), m);
+    __m128d         d1 = _mm_mul_pd(_mm_add_pd(_mm_loadu_pd(array + 2), o), m);
+    const __m128d   ge0 = _mm_cmpge_pd(d0, zero);
+    const __m128d   ge1 = _mm_cmpge_pd(d1, zero);
+
+    d0 = _mm_add_pd(d0, _mm_or_pd(_mm_and_pd(ge0, pos), _mm_andnot_pd(ge0, neg)));
+    d1 = _mm_add_pd(d1, _mm_or_pd(_mm_and_pd(ge1, pos), _mm_andnot_pd(ge1, neg)));
+    return (_mm_unpacklo_epi64(_mm_cvttpd_epi32(d0), _mm_cvttpd_epi32(d1)));
+}
+
+/* Keep the low 16 bits of eight int32 values */
+static inline __m128i
+Low16SSE2(__m128i a, __m128i b)
+{
+    a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+    b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+    return (_mm_packs_epi32(a, b));
+}
+
+/* Encode the leading multiple of eight 16 bit values, returning the number done */
+static int
+Encode16SSE2(unsigned char *sptr, const double *array, int num_beams, double multiplier, double offset)
+{
+    const __m128d   m = _mm_set1_pd(multiplier);
+    const __m128d   o = _mm_set1_pd(offset);
+    int             i = 0;
+
+    for (; i + 8 <= num_beams; i += 8)
+    {
+        const __m128i a = EncodeScaleSSE2(array + i, m, o);
+        const __m128i b = EncodeScaleSSE2(array + i + 4, m, o);
+        _mm_storeu_si128((__m128i *) (sptr + 2 * i), Swap16SSE2(Low16SSE2(a, b)));
+    }
+    return (i);
+}
+
+static void
+EncodeS32SSE2(unsigned char *sptr, const double *array, int num_beams, double multiplier, double offset)
+{
+    const __m128d   m = _mm_set1_pd(multiplier);
+    const __m128d   o = _mm_set1_pd(offset);
+    int             i = 0;
+
+    for (; i + 4 <= num_beams; i += 4)
+    {
+        _mm_storeu_si128((__m128i *) (sptr + 4 * i), Swap32SSE2(EncodeScaleSSE2(array + i, m, o)));
+    }
+    EncodeS32(sptr + 4 * i, array + i, num_beams - i, multiplier, offset);
+}
+
+static void
+EncodeU16SSE2(unsigned char *sptr, const double *array, int num_beams, double multiplier, double offset)
+{
+    const int       i = Encode16SSE2(sptr, array, num_beams, multiplier, offset);
+
+    EncodeU16(sptr + 2 * i, array + i, num_beams - i, multiplier, offset);
+}
+
+static void
+EncodeS16SSE2(unsigned char *sptr, const double *array, int num_beams, double multiplier, double offset)
+{
+    const int       i = Encode16SSE2(sptr, array, num_beams, multiplier, offset);
+
+    EncodeS16(sptr + 2 * i, array + i, num_beams - i, multiplier, offset);
+}
+
+/********************************************************************
+ * AVX2 kernels
+ ********************************************************************/
+
+/* Scale eight int32 values to doubles and store them */
+static inline GSF_ARRAY_AVX2 void
+StoreScaledAVX2(double *array, __m256i v, __m256d m, __m256d o)
+{
+    _mm256_storeu_pd(array, _mm256_sub_pd(_mm256_div_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(v)), m), o));
+    _mm256_storeu_pd(array + 4, _mm256_sub_pd(_mm256_div_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(v, 1)), m), o));
+}
+
+static GSF_ARRAY_AVX2 void
+DecodeU8AVX2(double *array, const unsigned char *sptr, int num_beams, double multiplier, double offset)
+{
+    const __m256d   m = _mm256_set1_pd(multiplier);
+    const __m256d   o = _mm256_set1_pd(offset);
+    int             i = 0;
+
+    for (; i + 8 <= num_beams; i += 8)
+    {
+        StoreScaledAVX2(array + i, _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *) (sptr + i))), m, o);
+    }
+    DecodeU8(array + i, sptr + i, num_beams - i, multiplier, offset);
+}
+
+static GSF_ARRAY_AVX2 void
+DecodeS8AVX2(double *array, const unsigned char *sptr, int num_beams, double multiplier, double offset)
+{
+    const __m256d   m = _mm256_set1_pd(multiplier);
+    const __m256d   o = _mm256_set1_pd(offset);
+    int             i = 0;
+
+    for (; i + 8 <= num_beams; i += 8)
+    {
+        StoreScaledAVX2(array + i, _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i *) (sptr + i))), m, o);
+    }
+    DecodeS8(array + i, sptr + i, num_beams - i, multiplier, offset);
+}
+
+static GSF_ARRAY_AVX2 void
+DecodeU16AVX2(double *array, const unsigned char *sptr, int num_beams, double multiplier, double offset)
+{
+    const __m256d   m = _mm256_set1_pd(multiplier);
+    const __m256d   o = _mm256_set1_pd(offset);
+    const __m128i   swap = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    int             i = 0;
+
+    for (; i + 8 <= num_beams; i += 8)
+    {
+        const __m128i x = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (sptr + 2 * i)), swap);
+        StoreScaledAVX2(array + i, _mm256_cvtepu16_epi32(x), m, o);
+    }
+    DecodeU16(array + i, sptr + 2 * i, num_beams - i, multiplier, offset);
+}
+
+static GSF_ARRAY_AVX2 void
+DecodeS16AVX2(double *array, const unsigned char *sptr, int num_beams, double multiplier, double offset)
+{
+    const __m256d   m = _mm256_set1_pd(multiplier);
+    const __m256d   o = _mm256_set1_pd(offset);
+    const __m128i   swap = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    int             i = 0;
+
+    for (; i + 8 <= num_beams; i += 8)
+    {
+        const __m128i x = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (sptr + 2 * i)), swap);
+        StoreScaledAVX2(array + i, _mm256_cvtepi16_epi32(x), m, o);
+    }
+    DecodeS16(array + i, sptr + 2 * i, num_beams - i, multiplier, offset);
+}
+
+static GSF_ARRAY_AVX2 void
+DecodeU32AVX2(double *array, const unsigned char *sptr, int num_beams, double multiplier, double offset)
+{
+    const __m256d   m = _mm256_set1_pd(multiplier);
+    const __m256d   o = _mm256_set1_pd(offset);
+    const __m256d   zero = _mm256_setzero_pd();
+    const __m256d   two32 = _mm256_set1_pd(4294967296.0);
+    const __m256i   swap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    int             i = 0;
+
+    for (; i + 8 <= num_beams; i += 8)
+    {
+        const __m256i x = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *) (sptr + 4 * i)), swap);
+        __m256d d0 = _mm256_cvtepi32_pd(_mm256_castsi256_si128(x));
+        __m256d d1 = _mm256_cvtepi32_pd(_mm256_extracti128_si256(x, 1));
+        d0 = _mm256_add_pd(d0, _mm256_and_pd(_mm256_cmp_pd(d0, zero, _CMP_LT_OQ), two32));
+        d1 = _mm256_add_pd(d1, _mm256_and_pd(_mm256_cmp_pd(d1, zero, _CMP_LT_OQ), two32));
+        _mm256_storeu_pd(array + i, _mm256_sub_pd(_mm256_div_pd(d0, m), o));
+        _mm256_storeu_pd(array + i + 4, _mm256_sub_pd(_mm256_div_pd(d1, m), o));
+    }
+    DecodeU32(array + i, sptr + 4 * i, num_beams - i, multiplier, offset);
+}
+
+static GSF_ARRAY_AVX2 void
+DecodeS32AVX2(double *array, const unsigned char *sptr, int num_beams, double multiplier, double offset)
+{
+    const __m256d   m = _mm256_set1_pd(multiplier);
+    const __m256d   o = _mm256_set1_pd(offset);
+    const __m256i   swap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    int             i = 0;
+
+    for (; i + 8 <= num_beams; i += 8)
+    {
+        StoreScaledAVX2(array + i, _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *) (sptr + 4 * i)), swap), m, o);
+    }
+    DecodeS32(array + i, sptr + 4 * i, num_beams - i, multiplier, offset);
+}
+
+/* Scale, round and truncate four values to int32 */
+static inline GSF_ARRAY_AVX2 __m128i
+EncodeScaleAVX2(const double *array, __m256d m, __m256d o)
+{
+    const __m256d   d = _mm256_mul_pd(_mm256_add_pd(_mm256_loadu_pd(array), o), m);
+    const __m256d   ge = _mm256_cmp_pd(d, _mm256_setzero_pd(), _CMP_GE_OQ);
+    const __m256d   r = _mm256_blendv_pd(_mm256_set1_pd(-0.501), _mm256_set1_pd(0.501), ge);
+
+    return (_mm256_cvttpd_epi32(_mm256_add_pd(d, r)));
+}
+
+/* Encode the leading multiple of eight 16 bit values, returning the number done */
+static GSF_ARRAY_AVX2 int
+Encode16AVX2(unsigned char *sptr, const double *array, int num_beams, double multiplier, double offset)
+{
+    const __m256d   m = _mm256_set1_pd(multiplier);
+    const __m256d   o = _mm256_set1_pd(offset);
+    const __m128i   swap = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    int             i = 0;
+
+    for (; i + 8 <= num_beams; i += 8)
+    {
+        __m128i a = EncodeScaleAVX2(array + i, m, o);
+        __m128i b = EncodeScaleAVX2(array + i + 4, m, o);
+        a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+        b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+        _mm_storeu_si128((__m128i *) (sptr + 2 * i), _mm_shuffle_epi8(_mm_packs_epi32(a, b), swap));
+    }
+    return (i);
+}
+
+static GSF_ARRAY_AVX2 void
+EncodeS32AVX2(unsigned char *sptr, const double *array, int num_beams, double multiplier, double offset)
+{
+    const __m256d   m = _mm256_set1_pd(multiplier);
+    const __m256d   o = _mm256_set1_pd(offset);
+    const __m128i   swap = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    int             i = 0;
+
+    for (; i + 4 <= num_beams; i += 4)
+    {
+        _mm_storeu_si128((__m128i *) (sptr + 4 * i), _mm_shuffle_epi8(EncodeScaleAVX2(array + i, m, o), swap));
+    }
+    EncodeS32(sptr + 4 * i, array + i, num_beams - i, multiplier, offset);
+}
+
+static GSF_ARRAY_AVX2 void
+EncodeU16AVX2(unsigned char *sptr, const double *array, int num_beams, double multiplier, double offset)
+{
+    const int       i = Encode16AVX2(sptr, array, num_beams, multiplier, offset);
+
+    EncodeU16(sptr + 2 * i, array + i, num_beams - i, multiplier, offset);
+}
+
+static GSF_ARRAY_AVX2 void
+EncodeS16AVX2(unsigned char *sptr, const double *array, int num_beams, double multiplier, double offset)
+{
+    const int       i = Encode16AVX2(sptr, array, num_beams, multiplier, offset);
+
+    EncodeS16(sptr + 2 * i, array + i, num_beams - i, multiplier, offset);
+}
+
+#endif   /* GSF_ARRAY_X86 */
+
+/********************************************************************
+ * Run time selection
+ ********************************************************************/
+
+static int
+DetectSimdLevel(void)
+{
+    int             level = GSF_ARRAY_SIMD_NONE;
+
+#ifdef GSF_ARRAY_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        level = GSF_ARRAY_SIMD_AVX2;
+    }
+    else if (__builtin_cpu_supports("sse2"))
+    {
+        level = GSF_ARRAY_SIMD_SSE2;
+    }
+#endif
+
+    return (level);
+}
+
+int
+gsfArraySimdLevel(void)
+{
+    int             level = GSF_ARRAY_LOAD(&simdLevel);
+
+    if (level < 0)
+    {
+        level = DetectSimdLevel();
+        GSF_ARRAY_STORE(&simdLevelMax, level);
+        GSF_ARRAY_STORE(&simdLevel, level);
+    }
+    return (level);
+}
+
+int
+gsfArraySetSimdLevel(int level)
+{
+    gsfArraySimdLevel();
+    if (level > GSF_ARRAY_LOAD(&simdLevelMax))
+    {
+        level = GSF_ARRAY_LOAD(&simdLevelMax);
+    }
+    if (level < GSF_ARRAY_SIMD_NONE)
+    {
+        level = GSF_ARRAY_SIMD_NONE;
+    }
+    GSF_ARRAY_STORE(&simdLevel, level);
+    return (level);
+}
+
+#ifdef GSF_ARRAY_X86
+#define GSF_ARRAY_DISPATCH(name, ...) \
+    switch (gsfArraySimdLevel()) \
+    { \
+        case GSF_ARRAY_SIMD_AVX2: name##AVX2(__VA_ARGS__); break; \
+        case GSF_ARRAY_SIMD_SSE2: name##SSE2(__VA_ARGS__); break; \
+        default: name(__VA_ARGS__); break; \
+    }
+#else
+#define GSF_ARRAY_DISPATCH(name, ...) name(__VA_ARGS__)
+#endif
+
+void
+gsfArrayDecodeU8(double *array, const unsigned char *sptr, int num_beams, double multiplier, double offset)
+{
+    GSF_ARRAY_DISPATCH(DecodeU8, array, sptr, num_beams, multiplier, offset);
+}
+
+void
+gsfArrayDecodeS8(double *array, const unsigned char *sptr, int num_beams, double multiplier, double offset)
+{
+    GSF_ARRAY_DISPATCH(DecodeS8, array, sptr, num_beams, multiplier, offset);
+}
+
+void
+gsfArrayDecodeU16(double *array, const unsigned char *sptr, int num_beams, double multiplier, double offset)
+{
+    GSF_ARRAY_DISPATCH(DecodeU16, array, sptr, num_beams, multiplier, offset);
+}
+
+void
+gsfArrayDecodeS16(double *array, const unsigned char *sptr, int num_beams, double multiplier, double offset)
+{
+    GSF_ARRAY_DISPATCH(DecodeS16, array, sptr, num_beams, multiplier, offset);
+}
+
+void
+gsfArrayDecodeU32(double *array, const unsigned char *sptr, int num_beams, double multiplier, double offset)
+{
+    GSF_ARRAY_DISPATCH(DecodeU32, array, sptr, num_beams, multiplier, offset);
+}
+
+void
+gsfArrayDecodeS32(double *array, const unsigned char *sptr, int num_beams, double multiplier, double offset)
+{
+    GSF_ARRAY_DISPATCH(DecodeS32, array, sptr, num_beams, multiplier, offset);
+}
+
+/* The unsigned byte and four byte encodings convert beyond the int32 range
+ * or below zero, where the vector conversions differ from C, so they keep
+ * the portable versions. */
+void
+gsfArrayEncodeU8(unsigned char *sptr, const double *array, int num_beams, double multiplier, double offset)
+{
+    EncodeU8(sptr, array, num_beams, multiplier, offset);
+}
+
+void
+gsfArrayEncodeU32(unsigned char *sptr, const double *array, int num_beams, double multiplier, double offset)
+{
+    EncodeU32(sptr, array, num_beams, multiplier, offset);
+}
+
+void
+gsfArrayEncodeU16(unsigned char *sptr, const double *array, int num_beams, double multiplier, double offset)
+{
+    GSF_ARRAY_DISPATCH(EncodeU16, sptr, array, num_beams, multiplier, offset);
+}
+
+void
+gsfArrayEncodeS16(unsigned char *sptr, const double *array, int num_beams, double multiplier, double offset)
+{
+    GSF_ARRAY_DISPATCH(EncodeS16, sptr, array, num_beams, multiplier, offset);
+}
+
+void
+gsfArrayEncodeS32(unsigned char *sptr, const double *array, int num_beams, double multiplier, double offset)
+{
+    GSF_ARRAY_DISPATCH(EncodeS32, sptr, array, num_beams, multiplier, offset);
+}
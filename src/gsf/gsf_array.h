@@ -0,0 +1,70 @@
+/********************************************************************
+ *
+ * Module Name : GSF_ARRAY
+ *
+ * Description :
+ *  Bulk conversion of swath bathymetry beam arrays between the GSF
+ *  byte stream (big endian, scaled integers) and internal form
+ *  (doubles). The decode kernels compute
+ *     value = (double) stored / multiplier - offset
+ *  and the encode kernels compute
+ *     stored = (integer) ((value + offset) * multiplier +/- 0.501)
+ *  exactly as the per-beam loops in gsf_dec.c and gsf_enc.c did, so
+ *  results are identical for every kernel. On x86 processors SSE2 and
+ *  AVX2 versions are selected at run time, other processors use the
+ *  portable versions.
+ *
+ * Change Descriptions :
+ * who  when      what
+ * ---  ----      ----
+ * mbs  2026-10-19 Initial version.
+ *
+ * This library may be redistributed and/or modified under the terms of
+ * the GNU Lesser General Public License version 2.1, as published by the
+ * Free Software Foundation.
+ *
+ ********************************************************************/
+
+#ifndef _GSF_ARRAY_H_
+   #define _GSF_ARRAY_H_
+
+#ifdef __cplusplus
+extern          "C"
+{
+#endif
+
+/* Instruction set levels for the beam array kernels */
+#define GSF_ARRAY_SIMD_NONE    0
+#define GSF_ARRAY_SIMD_SSE2    1
+#define GSF_ARRAY_SIMD_AVX2    2
+
+/* Return the instruction set level in use, the best one supported by the
+ * processor unless limited by gsfArraySetSimdLevel.
+ */
+int             gsfArraySimdLevel(void);
+
+/* Limit the instruction set level used (for testing and benchmarking),
+ * returns the level now in use.
+ */
+int             gsfArraySetSimdLevel(int level);
+
+/* Decode num_beams big endian values at sptr into array */
+void            gsfArrayDecodeU8(double *array, const unsigned char *sptr, int num_beams, double multiplier, double offset);
+void            gsfArrayDecodeS8(double *array, const unsigned char *sptr, int num_beams, double multiplier, double offset);
+void            gsfArrayDecodeU16(double *array, const unsigned char *sptr, int num_beams, double multiplier, double offset);
+void            gsfArrayDecodeS16(double *array, const unsigned char *sptr, int num_beams, double multiplier, double offset);
+void            gsfArrayDecodeU32(double *array, const unsigned char *sptr, int num_beams, double multiplier, double offset);
+void            gsfArrayDecodeS32(double *array, const unsigned char *sptr, int num_beams, double multiplier, double offset);
+
+/* Encode num_beams values from array as rounded big endian values at sptr */
+void            gsfArrayEncodeU8(unsigned char *sptr, const double *array, int num_beams, double multiplier, double offset);
+void            gsfArrayEncodeU16(unsigned char *sptr, const double *array, int num_beams, double multiplier, double offset);
+void            gsfArrayEncodeS16(unsigned char *sptr, const double *array, int num_beams, double multiplier, double offset);
+void            gsfArrayEncodeU32(unsigned char *sptr, const double *array, int num_beams, double multiplier, double offset);
+void            gsfArrayEncodeS32(unsigned char *sptr, const double *array, int num_beams, double multiplier, double offset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif   /* _GSF_ARRAY_H_ */
@@ -86,6 +86,7 @@
  * clb          06-21-11  implemented DecodeEM12Specific() function
  * clb          09-20-11  added support for R2Sonic
  * jcd          02-17-12  fixed DecodeQualityFlagsArray to work with num_beams not evenly divisible by 4
+ * mbs          10-19-26  decode the scaled beam arrays with the bulk kernels in gsf_array.c
  *
  * Classification : Unclassified
  *
@@ -124,6 +125,7 @@
 /* GSF library interface description */
 #include "gsf.h"
 #include "gsf_dec.h"
+#include "gsf_array.h"
 
 /* Macro definitions for this file */
 #define RESON_MASK1 192
@@ -139,7 +141,7 @@ short    arraySize[GSF_MAX_OPEN_FILES][GSF_MAX_PING_ARRAY_SUBRECORDS];
 static short   *samplesArraySize[GSF_MAX_OPEN_FILES];
 
 /* Global external data defined in this module */
-extern int      gsfError;  /* Defined in gsf.c */
+extern GSF_THREAD_LOCAL int gsfError;  /* Defined in gsf.c */
 
 int DecodeCompressedUnsignedShortArray (unsigned short **array, const unsigned char *sptr, int num_beams, int compressed_size, int subrecordID, int handle);
 int DecodeCompressedArray (double **array, const unsigned char *sptr, int num_beams, int compressed_size, const gsfScaleFactors *sf, int subrecordID, int handle);
@@ -2126,10 +2128,7 @@ DecodeTwoByteArray(double **array, const unsigned char *sptr, int num_beams,
     const gsfScaleFactors *sf, int id, int handle)
 {
     double         *dptr;
-    const unsigned char  *ptr = sptr;
-    gsfuShort       stemp;
-    unsigned short  temp;
-    int             i;
+    const unsigned char *ptr = sptr;
 
     /* make sure we have a scale factor multiplier */
     if (sf->scaleTable[id - 1].multiplier < 1.0e-6)
@@ -2164,17 +2163,9 @@ DecodeTwoByteArray(double **array, const unsigned char *sptr, int num_beams,
 
     dptr = *array;
 
-    /* Loop for the number of beams, loading each value from the byte stream into internal form. */
-    for (i = 0; i < num_beams; i++)
-    {
-        memcpy(&stemp, ptr, 2);
-        temp = (unsigned short) ntohs(stemp);
-        *dptr = (((double) temp) /
-            sf->scaleTable[id - 1].multiplier) -
-            sf->scaleTable[id - 1].offset;
-        ptr += 2;
-        dptr++;
-    }
+    /* Convert the beams from the byte stream into internal form in one pass. */
+    gsfArrayDecodeU16(dptr, ptr, num_beams, sf->scaleTable[id - 1].multiplier, sf->scaleTable[id - 1].offset);
+    ptr += 2 * num_beams;
 
     return (ptr - sptr);
 }
@@ -2219,9 +2210,6 @@ DecodeSignedTwoByteArray(double **array, const unsigned char *sptr, int num_beam
 {
     double         *dptr;
     const unsigned char *ptr = sptr;
-    gsfuShort       stemp;
-    gsfsShort       signed_temp;
-    int             i;
 
     /* make sure we have a scale factor multiplier */
     if (sf->scaleTable[id - 1].multiplier < 1.0e-6)
@@ -2256,17 +2244,10 @@ DecodeSignedTwoByteArray(double **array, const unsigned char *sptr, int num_beam
 
     dptr = *array;
 
-    /* Loop for the number of beams, loading each value from the byte stream into internal form. */
-    for (i = 0; i < num_beams; i++)
-    {
-        memcpy(&stemp, ptr, 2);
-        signed_temp = (gsfsShort) ntohs(stemp);
-        *dptr = (((double) signed_temp) /
-            sf->scaleTable[id - 1].multiplier) -
-            sf->scaleTable[id - 1].offset;
-        ptr += 2;
-        dptr++;
-    }
+    /* Convert the beams from the byte stream into internal form in one pass. */
+    gsfArrayDecodeS16(dptr, ptr, num_beams, sf->scaleTable[id - 1].multiplier, sf->scaleTable[id - 1].offset);
+    ptr += 2 * num_beams;
+
     return (ptr - sptr);
 }
 
@@ -2309,10 +2290,7 @@ DecodeFourByteArray(double **array, const unsigned char *sptr, int num_beams,
     const gsfScaleFactors *sf, int id, int handle)
 {
     double         *dptr;
-    const unsigned char  *ptr = sptr;
-    gsfuLong        ltemp;
-    gsfuLong        temp;
-    int             i;
+    const unsigned char *ptr = sptr;
 
     /* make sure we have a scale factor multiplier */
     if (sf->scaleTable[id - 1].multiplier < 1.0e-6)
@@ -2347,19 +2325,9 @@ DecodeFourByteArray(double **array, const unsigned char *sptr, int num_beams,
 
     dptr = *array;
 
-    /* loop for the number of beams, loading each value from the byte stream
-    *  into internal form
-    */
-    for (i = 0; i < num_beams; i++)
-    {
-        memcpy(&ltemp, ptr, 4);
-        temp = (gsfuLong) ntohl(ltemp);
-        *dptr = (((double) temp) /
-            sf->scaleTable[id - 1].multiplier) -
-            sf->scaleTable[id - 1].offset;
-        ptr += 4;
-        dptr++;
-    }
+    /* Convert the beams from the byte stream into internal form in one pass. */
+    gsfArrayDecodeU32(dptr, ptr, num_beams, sf->scaleTable[id - 1].multiplier, sf->scaleTable[id - 1].offset);
+    ptr += 4 * num_beams;
 
     return (ptr - sptr);
 }
@@ -2405,9 +2373,6 @@ DecodeSignedFourByteArray(double **array, const unsigned char *sptr, int num_bea
 {
     double         *dptr;
     const unsigned char *ptr = sptr;
-    gsfuLong        ltemp;
-    gsfsLong        signed_temp;
-    int             i;
 
     /* make sure we have a scale factor multiplier */
     if (sf->scaleTable[id - 1].multiplier < 1.0e-6)
@@ -2442,19 +2407,10 @@ DecodeSignedFourByteArray(double **array, const unsigned char *sptr, int num_bea
 
     dptr = *array;
 
-    /* loop for the number of beams, loading each value from the byte stream
-    *  into internal form
-    */
-    for (i = 0; i < num_beams; i++)
-    {
-        memcpy(&ltemp, ptr, 4);
-        signed_temp = (gsfsLong) ntohl(ltemp);
-        *dptr = (((double) signed_temp) /
-            sf->scaleTable[id - 1].multiplier) -
-            sf->scaleTable[id - 1].offset;
-        ptr += 4;
-        dptr++;
-    }
+    /* Convert the beams from the byte stream into internal form in one pass. */
+    gsfArrayDecodeS32(dptr, ptr, num_beams, sf->scaleTable[id - 1].multiplier, sf->scaleTable[id - 1].offset);
+    ptr += 4 * num_beams;
+
     return (ptr - sptr);
 }
 
@@ -2497,9 +2453,7 @@ DecodeByteArray(double **array, const unsigned char *sptr, int num_beams,
     const gsfScaleFactors *sf, int id, int handle)
 {
     double         *dptr;
-    const unsigned char  *ptr = sptr;
-    unsigned char   ctemp;
-    int             i;
+    const unsigned char *ptr = sptr;
 
     /* make sure we have a scale factor multiplier */
     if (sf->scaleTable[id - 1].multiplier < 1.0e-6)
@@ -2534,16 +2488,10 @@ DecodeByteArray(double **array, const unsigned char *sptr, int num_beams,
 
     dptr = *array;
 
-    /* Loop for the number of beams, loading each value from the byte stream into internal form. */
-    for (i = 0; i < num_beams; i++)
-    {
-        ctemp = *ptr;
-        *dptr = (((double) ctemp) /
-            sf->scaleTable[id - 1].multiplier) -
-            sf->scaleTable[id - 1].offset;
-        ptr++;
-        dptr++;
-    }
+    /* Convert the beams from the byte stream into internal form in one pass. */
+    gsfArrayDecodeU8(dptr, ptr, num_beams, sf->scaleTable[id - 1].multiplier, sf->scaleTable[id - 1].offset);
+    ptr += num_beams;
+
     return (ptr - sptr);
 }
 
@@ -2678,8 +2626,6 @@ DecodeSignedByteArray(double **array, const unsigned char *sptr, int num_beams,
 {
     double         *dptr;
     const unsigned char *ptr = sptr;
-    signed char     ctemp;
-    int             i;
 
     /* make sure we have a scale factor multiplier */
     if (sf->scaleTable[id - 1].multiplier < 1.0e-6)
@@ -2714,16 +2660,10 @@ DecodeSignedByteArray(double **array, const unsigned char *sptr, int num_beams,
 
     dptr = *array;
 
-    /* Loop for the number of beams, loading each value from the byte stream into internal form. */
-    for (i = 0; i < num_beams; i++)
-    {
-        ctemp = *ptr;
-        *dptr = (((double) ctemp) /
-            sf->scaleTable[id - 1].multiplier) -
-            sf->scaleTable[id - 1].offset;
-        ptr++;
-        dptr++;
-    }
+    /* Convert the beams from the byte stream into internal form in one pass. */
+    gsfArrayDecodeS8(dptr, ptr, num_beams, sf->scaleTable[id - 1].multiplier, sf->scaleTable[id - 1].offset);
+    ptr += num_beams;
+
     return (ptr - sptr);
 }
 
@@ -92,6 +92,7 @@
  * clb          06-21-11  Added em12 to list of available sensors
  * clb          09-20-11  Added support for R2Sonic
  * jcd          02-17-12  fixed EncodeQualityFlagsArray to work with num_beams not evenly divisible by 4
+ * mbs          10-19-26  encode the scaled beam arrays with the bulk kernels in gsf_array.c
  *
  * Classification : Unclassified
  *
@@ -129,9 +130,10 @@
 /* GSF library interface description */
 #include "gsf.h"
 #include "gsf_enc.h"
+#include "gsf_array.h"
 
 /* Global external data defined in this module */
-extern int      gsfError;  /* Defined in gsf.c */
+extern GSF_THREAD_LOCAL int gsfError;  /* Defined in gsf.c */
 
 int EncodeCompressedUnsignedShortArray (unsigned char *sptr, const unsigned short *array, int num_beams, int subrecordID);
 int EncodeCompressedArray (unsigned char *sptr, const double *array, int num_beams, const gsfScaleFactors *sf, int subrecordID);
@@ -2137,9 +2139,6 @@ EncodeTwoByteArray(unsigned char *sptr, const double *array, int num_beams,
 {
     unsigned char  *ptr = sptr;
     gsfuLong        ltemp;
-    gsfuShort       stemp;
-    double          dtemp;
-    int             i;
 
 
     /* Make sure we have a multiplier for this array */
@@ -2164,24 +2163,10 @@ EncodeTwoByteArray(unsigned char *sptr, const double *array, int num_beams,
     memcpy(ptr, &ltemp, 4);
     ptr += 4;
 
-    for (i = 0; i < num_beams; i++)
-    {
-        dtemp = (array[i] + sf->scaleTable[id - 1].offset) * sf->scaleTable[id - 1].multiplier;
+    /* Convert the beams to the byte stream in one pass, rounding to the nearest whole integer */
+    gsfArrayEncodeU16(ptr, array, num_beams, sf->scaleTable[id - 1].multiplier, sf->scaleTable[id - 1].offset);
+    ptr += 2 * num_beams;
 
-        /* Make sure we round to the nearest whole integer */
-        if (dtemp >= 0.0)
-        {
-            dtemp += 0.501;
-        }
-        else
-        {
-            dtemp -= 0.501;
-        }
-        stemp = (gsfuShort) dtemp;
-        stemp = htons(stemp);
-        memcpy(ptr, &stemp, 2);
-        ptr += 2;
-    }
     return (ptr - sptr);
 }
 
@@ -2215,9 +2200,6 @@ EncodeSignedTwoByteArray(unsigned char *sptr, const double *array, int num_beams
 {
     unsigned char  *ptr = sptr;
     gsfuLong        ltemp;
-    gsfsShort       stemp;
-    double          dtemp;
-    int             i;
 
     /* Make sure we have a multiplier for this array */
     if (sf->scaleTable[id - 1].multiplier < 1.0e-6)
@@ -2241,25 +2223,10 @@ EncodeSignedTwoByteArray(unsigned char *sptr, const double *array, int num_beams
     memcpy(ptr, &ltemp, 4);
     ptr += 4;
 
-    for (i = 0; i < num_beams; i++)
-    {
-        dtemp = (array[i] + sf->scaleTable[id - 1].offset) *
-            sf->scaleTable[id - 1].multiplier;
+    /* Convert the beams to the byte stream in one pass, rounding to the nearest whole integer */
+    gsfArrayEncodeS16(ptr, array, num_beams, sf->scaleTable[id - 1].multiplier, sf->scaleTable[id - 1].offset);
+    ptr += 2 * num_beams;
 
-        /* Make sure we round to the nearest whole integer */
-        if (dtemp >= 0.0)
-        {
-            dtemp += 0.501;
-        }
-        else
-        {
-            dtemp -= 0.501;
-        }
-        stemp = (gsfsShort) dtemp;
-        stemp = htons(stemp);
-        memcpy(ptr, &stemp, 2);
-        ptr += 2;
-    }
     return (ptr - sptr);
 }
 
@@ -2293,8 +2260,6 @@ EncodeFourByteArray(unsigned char *sptr, const double *array, int num_beams,
 {
     unsigned char  *ptr = sptr;
     gsfuLong        ltemp;
-    double          dtemp;
-    int             i;
 
 
     /* Make sure we have a multiplier for this array */
@@ -2319,24 +2284,10 @@ EncodeFourByteArray(unsigned char *sptr, const double *array, int num_beams,
     memcpy(ptr, &ltemp, 4);
     ptr += 4;
 
-    for (i = 0; i < num_beams; i++)
-    {
-        dtemp = (array[i] + sf->scaleTable[id - 1].offset) * sf->scaleTable[id - 1].multiplier;
+    /* Convert the beams to the byte stream in one pass, rounding to the nearest whole integer */
+    gsfArrayEncodeU32(ptr, array, num_beams, sf->scaleTable[id - 1].multiplier, sf->scaleTable[id - 1].offset);
+    ptr += 4 * num_beams;
 
-        /* Make sure we round to the nearest whole integer */
-        if (dtemp >= 0.0)
-        {
-            dtemp += 0.501;
-        }
-        else
-        {
-            dtemp -= 0.501;
-        }
-        ltemp = (gsfuLong) dtemp;
-        ltemp = htonl(ltemp);
-        memcpy(ptr, &ltemp, 4);
-        ptr += 4;
-    }
     return (ptr - sptr);
 }
 
@@ -2370,9 +2321,6 @@ EncodeSignedFourByteArray(unsigned char *sptr, const double *array, int num_beam
 {
     unsigned char  *ptr = sptr;
     gsfuLong        ltemp;
-    gsfsLong        stemp;
-    double          dtemp;
-    int             i;
 
     /* Make sure we have a multiplier for this array */
     if (sf->scaleTable[id - 1].multiplier < 1.0e-6)
@@ -2396,25 +2344,10 @@ EncodeSignedFourByteArray(unsigned char *sptr, const double *array, int num_beam
     memcpy(ptr, &ltemp, 4);
     ptr += 4;
 
-    for (i = 0; i < num_beams; i++)
-    {
-        dtemp = (array[i] + sf->scaleTable[id - 1].offset) *
-            sf->scaleTable[id - 1].multiplier;
+    /* Convert the beams to the byte stream in one pass, rounding to the nearest whole integer */
+    gsfArrayEncodeS32(ptr, array, num_beams, sf->scaleTable[id - 1].multiplier, sf->scaleTable[id - 1].offset);
+    ptr += 4 * num_beams;
 
-        /* Make sure we round to the nearest whole integer */
-        if (dtemp >= 0.0)
-        {
-            dtemp += 0.501;
-        }
-        else
-        {
-            dtemp -= 0.501;
-        }
-        stemp = (gsfsLong) dtemp;
-        stemp = htonl(stemp);
-        memcpy(ptr, &stemp, 4);
-        ptr += 4;
-    }
     return (ptr - sptr);
 }
 
@@ -2447,10 +2380,7 @@ EncodeByteArray(unsigned char *sptr, const double *array, int num_beams,
     const gsfScaleFactors * sf, int id)
 {
     unsigned char  *ptr = sptr;
-    unsigned char   ctemp;
     gsfuLong        ltemp;
-    double          dtemp;
-    int             i;
 
 
     /* Make sure we have a multiplier for this array */
@@ -2475,25 +2405,10 @@ EncodeByteArray(unsigned char *sptr, const double *array, int num_beams,
     memcpy(ptr, &ltemp, 4);
     ptr += 4;
 
-    for (i = 0; i < num_beams; i++)
-    {
-        dtemp = (array[i] + sf->scaleTable[id - 1].offset) *
-            sf->scaleTable[id - 1].multiplier;
+    /* Convert the beams to the byte stream in one pass, rounding to the nearest whole integer */
+    gsfArrayEncodeU8(ptr, array, num_beams, sf->scaleTable[id - 1].multiplier, sf->scaleTable[id - 1].offset);
+    ptr += num_beams;
 
-        /* Make sure we round to the nearest whole integer */
-        if (dtemp >= 0.0)
-        {
-            dtemp += 0.501;
-        }
-        else
-        {
-            dtemp -= 0.501;
-        }
-
-        ctemp = (unsigned char) dtemp;
-        memcpy(ptr, &ctemp, 1);
-        ptr++;
-    }
     return (ptr - sptr);
 }
 
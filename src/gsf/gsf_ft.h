@@ -109,6 +109,7 @@ typedef struct t_gsfFileTable
     int             last_record_type;              /* Record type of the last record we successfully read (or wrote) */
     INDEX_DATA      index_data;                    /* Index information used for direct file access */
     gsfRecords      rec;                           /* Our copy of pointers to dynamic memory and scale factors */
+    unsigned char  *stream_buff;                   /* Record pack/unpack buffer, GSF_MAX_RECORD_SIZE bytes */
 }
 GSF_FILE_TABLE;
 
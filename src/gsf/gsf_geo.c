@@ -38,7 +38,7 @@
 #include "gsf.h"
 
 /* Global external data defined in this module */
-extern int      gsfError;                               /* defined in gsf.c */
+extern GSF_THREAD_LOCAL int gsfError;                               /* defined in gsf.c */
 
 #define SQR(x) ((x)*(x))
 #define Everest_1830        0
@@ -128,7 +128,7 @@ static void metric (double phi, int k, double *gx, double *gy)
 
 GSF_POSITION *gsfGetPositionDestination(GSF_POSITION gp, GSF_POSITION_OFFSETS offsets, double hdg, double dist_step)
 {
-    static GSF_POSITION     new_gp;
+    static GSF_THREAD_LOCAL GSF_POSITION new_gp;
     double                  gx, gy;
     double                  dp, dl;
     double                  dx, dy, dz;
@@ -186,7 +186,7 @@ GSF_POSITION *gsfGetPositionDestination(GSF_POSITION gp, GSF_POSITION_OFFSETS of
 
 GSF_POSITION_OFFSETS *gsfGetPositionOffsets(GSF_POSITION gp_from, GSF_POSITION gp_to, double hdg, double dist_step)
 {
-    static GSF_POSITION_OFFSETS   offsets;
+    static GSF_THREAD_LOCAL GSF_POSITION_OFFSETS offsets;
     double                  gx, gy;
     double                  dx, dy, dz;
     double                  dlat, dlon, doz;
@@ -128,7 +128,7 @@
 #include <sys/stat.h>
 
 /* Error flag defined in gsf.c */
-extern int      gsfError;
+extern GSF_THREAD_LOCAL int gsfError;
 
 /* Prototypes for local functions */
 static FILE *open_temp_file(int);
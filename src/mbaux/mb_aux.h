@@ -167,6 +167,10 @@ struct swath {
 };
 
 /* topography grid structure for mb_intersectgrid() */
+#define MB_TOPOGRID_PYRAMID_LEVELS_MAX 32
+#define MB_TOPOGRID_TILE_LEVEL_DEFAULT 8
+#define MB_TOPOGRID_TILE_CACHE_DEFAULT 256
+#define MB_TOPOGRID_TILED_NXY_MIN 67108864
 struct mb_topogrid_struct {
   mb_path file;
   int projection_mode;
@@ -184,6 +188,96 @@ struct mb_topogrid_struct {
   double dx;
   double dy;
   float *data;
+
+  /* min/max elevation pyramid used for ray casting, level k (1..nlevels)
+     cells each span 2^k by 2^k grid cells, stored in array index k-1 */
+  int pyramid_nlevels;
+  int pyramid_n_columns[MB_TOPOGRID_PYRAMID_LEVELS_MAX];
+  int pyramid_n_rows[MB_TOPOGRID_PYRAMID_LEVELS_MAX];
+  float *pyramid_min[MB_TOPOGRID_PYRAMID_LEVELS_MAX];
+  float *pyramid_max[MB_TOPOGRID_PYRAMID_LEVELS_MAX];
+
+  /* cache of grid tiles paged in on demand for grids too large to hold
+     in memory (data is NULL), each tile spans 2^level by 2^level grid cells
+     and carries its own pyramid */
+  void *tiles;
+};
+
+/* colortable, histogram and shading defines for mb_shade() */
+#define MB_SHADE_NUM_COLORS 11
+#define MB_SHADE_HISTOGRAM_DIM 1000
+#define MB_SHADE_COLORTABLE_NORMAL 0
+#define MB_SHADE_COLORTABLE_REVERSED 1
+#define MB_SHADE_COLORTABLE_HAXBY 0
+#define MB_SHADE_COLORTABLE_BRIGHT 1
+#define MB_SHADE_COLORTABLE_MUTED 2
+#define MB_SHADE_COLORTABLE_GRAY 3
+#define MB_SHADE_COLORTABLE_FLAT 4
+#define MB_SHADE_COLORTABLE_SEALEVEL1 5
+#define MB_SHADE_COLORTABLE_SEALEVEL2 6
+#define MB_SHADE_NONE 0
+#define MB_SHADE_ILLUMINATION 1
+#define MB_SHADE_SLOPE 2
+
+/* color and shading control structure for mb_shade() */
+struct mb_shade_struct {
+  /* number of threads, <= 0 means use all cores */
+  int nthreads;
+
+  /* coloring */
+  int colortable;
+  int colortable_mode;
+  bool color_slope;
+  bool use_histogram;
+  double min;
+  double max;
+  float nodata_red;
+  float nodata_green;
+  float nodata_blue;
+
+  /* shading */
+  int shade_mode;
+  double illuminate_magnitude;
+  double illuminate_elevation;
+  double illuminate_azimuth;
+  double slope_magnitude;
+  double scale;
+
+  /* derived by mb_shade_setup() and mb_shade_histogram() */
+  double illum_x;
+  double illum_y;
+  double illum_z;
+  double mag2;
+  const float *colortable_red;
+  const float *colortable_green;
+  const float *colortable_blue;
+  float histogram[3 * MB_SHADE_NUM_COLORS];
+};
+
+/* undefined value of nodes not interpolated by mb_mgsurface() */
+#define MB_MGSURFACE_NODATA 1.0e35f
+
+/* interpolation control structure for mb_mgsurface() */
+struct mb_mgsurface_struct {
+  /* number of threads, <= 0 means use all cores */
+  int nthreads;
+
+  /* zgrid tension (cay): 0 gives a Laplace solution and large
+     values approach a thin plate spline */
+  double tension;
+
+  /* only nodes within clip grid cells of data are interpolated */
+  int clip;
+
+  /* iterate until the largest change in a cycle is less than
+     convergence times the data range, <= 0 means use the defaults */
+  double convergence;
+  int cycles_max;
+
+  /* returned by mb_mgsurface() */
+  int nlevels;
+  int ncycles;
+  double dzmax;
 };
 
 #ifdef __cplusplus
@@ -225,6 +319,8 @@ int mb_zgrid(float *z, int *n_columns, int *n_rows, float *x1, float *y1, float
              bool *imnew, float *cay, int *nrng);
 int mb_zgrid2(float *z, int *n_columns, int *n_rows, float *x1, float *y1, float *dx, float *dy, float *xyz, int *n, float *zpij, int *knxt,
               bool *imnew, float *cay, int *nrng);
+int mb_mgsurface(int verbose, struct mb_mgsurface_struct *surface, int n_columns, int n_rows, double x1, double y1, double dx,
+                 double dy, int ndata, const float *xyz, float *z, int *error);
 
 /* mb_delaun function prototypes */
 int mb_delaun(int verbose, int npts, double *p1, double *p2, int *ed, int *ntri, int *iv1, int *iv2, int *iv3, int *ct1, int *ct2,
@@ -238,6 +334,10 @@ int mb_check_gmt_grd(int verbose, char *grdfile, int *grid_projection_mode, char
 int mb_read_gmt_grd(int verbose, char *grdfile, int *grid_projection_mode, char *grid_projection_id, float *nodatavalue, int *nxy,
                     int *n_columns, int *n_rows, double *min, double *max, double *xmin, double *xmax, double *ymin, double *ymax,
                     double *dx, double *dy, float **data, float **data_dzdx, float **data_dzdy, int *error);
+int mb_read_gmt_grd_window(int verbose, char *grdfile, double *wesn, int decimation, int *grid_projection_mode,
+                    char *grid_projection_id, float *nodatavalue, int *nxy, int *n_columns, int *n_rows, double *min,
+                    double *max, double *xmin, double *xmax, double *ymin, double *ymax, double *dx, double *dy, float **data,
+                    float **data_dzdx, float **data_dzdy, int *error);
 int mb_write_gmt_grd(int verbose, const char *grdfile, float *grid,
                       float nodatavalue, int n_columns, int n_rows,
                       double xmin, double xmax, double ymin, double ymax,
@@ -258,17 +358,47 @@ void lspeig(const double *a, const int *ia, const int *nia, int nnz, int nc, int
 
 /* mb_topogrid function prototypes */
 int mb_topogrid_init(int verbose, mb_path topogridfile, int *lonflip, void **topogrid_ptr, int *error);
+int mb_topogrid_init_window(int verbose, mb_path topogridfile, double bounds[4], int decimation, int *lonflip,
+                          void **topogrid_ptr, int *error);
+int mb_topogrid_init_tiled(int verbose, mb_path topogridfile, int tile_level, int cache_tiles, int *lonflip,
+                          void **topogrid_ptr, int *error);
 int mb_topogrid_deall(int verbose, void **topogrid_ptr, int *error);
 int mb_topogrid_bounds(int verbose, void *topogrid_ptr, double bounds[4], int *error);
 int mb_topogrid_topo(int verbose, void *topogrid_ptr, double navlon, double navlat, double *topo, int *error);
 int mb_topogrid_intersect(int verbose, void *topogrid_ptr, double navlon, double navlat, double altitude, double sensordepth,
                           double mtodeglon, double mtodeglat, double vx, double vy, double vz, double *lon, double *lat,
                           double *topo, double *range, int *error);
+int mb_topogrid_intersect_batch(int verbose, void *topogrid_ptr, double navlon, double navlat, double altitude,
+                          double sensordepth, double mtodeglon, double mtodeglat, int nrays, double *vx, double *vy,
+                          double *vz, double *lon, double *lat, double *topo, double *range, int *ray_status, int *error);
 int mb_topogrid_getangletable(int verbose, void *topogrid_ptr, int nangle, double angle_min, double angle_max, double navlon,
                               double navlat, double heading, double altitude, double sensordepth, double pitch,
                               double *table_angle, double *table_xtrack, double *table_ltrack, double *table_altitude,
                               double *table_range, int *error);
 
+/* mb_shade function prototypes */
+int mb_shade_setup(int verbose, struct mb_shade_struct *shade, int *error);
+int mb_shade_derivative(int verbose, const struct mb_shade_struct *shade, int n_columns, int n_rows, int column_start,
+                        int column_end, float nodatavalue, const float *data, const float *x, const float *y, double dx,
+                        double dy, float *dzdx, float *dzdy, int *error);
+int mb_shade_histogram(int verbose, int nthreads, int n_columns, int n_rows, float nodatavalue, const float *data,
+                       const float *dzdx, const float *dzdy, bool slope, double min, double max, float *histogram,
+                       int *error);
+int mb_shade_getcolor(double value, double min, double max, int colortablemode, float below_red, float below_green,
+                      float below_blue, float above_red, float above_green, float above_blue, const float *colortable_red,
+                      const float *colortable_green, const float *colortable_blue, float *red, float *green, float *blue);
+int mb_shade_getcolor_histogram(double value, double min, double max, int colortablemode, float below_red,
+                                float below_green, float below_blue, float above_red, float above_green, float above_blue,
+                                const float *colortable_red, const float *colortable_green, const float *colortable_blue,
+                                const float *histogram, float *red, float *green, float *blue);
+int mb_shade_colorvalue(const struct mb_shade_struct *shade, double value, float *r, float *g, float *b);
+void mb_shade_colorvalue_block(const struct mb_shade_struct *shade, int n, const double *value, float *r, float *g,
+                               float *b);
+int mb_shade_applyshade(double intensity, float *r, float *g, float *b);
+void mb_shade_applyshade_block(int n, const float *intensity, float *r, float *g, float *b);
+int mb_shade_grid(int verbose, const struct mb_shade_struct *shade, int n_columns, int n_rows, float nodatavalue,
+                  const float *data, const float *dzdx, const float *dzdy, float *r, float *g, float *b, int *error);
+
 /* lsqr.h */
 /*!
    \file
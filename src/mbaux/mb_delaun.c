@@ -23,15 +23,30 @@
  *--------------------------------------------------------------------*/
 /*
  * The function mb_delaun.c assigns triangles to a set of x,y points
- * based on the method of:
+ * such that the final network is a set of Delauney triangles with the
+ * property that no vertex lies inside the circumcircle of any triangle.
+ * This system is as close to equiangular as possible.
+ *
+ * The original version was a translation of a Fortran 77 subroutine
+ * obtained from Robert Parker at the Scripps Institution of Oceanography
+ * implementing the method of:
  *	Watson, Computers and Geosciences, V8, 97-101, 1982.
- * The final network is a set of Delauney triangles with the property
- * that no vertex lies inside the circumcircle of any triangle.  This
- * system is as close to equiangular as possible.
- * This code was translated from a Fortran 77 subroutine obtained from
- * Robert Parker at the Scripps Institution of Oceanography.  It is
- * unclear whether Bob wrote the subroutine based on the Watson article
- * or obtained the code from someone else.
+ * That code tested every existing triangle for each new point and so
+ * took time proportional to the square of the number of points. This
+ * version uses the same Bowyer-Watson insertion, but:
+ *   - the points are inserted in a biased randomized insertion order
+ *     (BRIO), in rounds of doubling size each sorted along a Hilbert
+ *     curve, so that consecutive points are close together,
+ *   - each point is located by walking from the last triangle created
+ *     across the triangle adjacencies,
+ *   - the triangles to be replaced are found by searching outwards from
+ *     the containing triangle through the adjacencies,
+ *   - the orientation and incircle tests use floating point filters
+ *     backed by exact arithmetic (after Shewchuk, Discrete and
+ *     Computational Geometry, V18, 305-363, 1997) so that nearly
+ *     collinear or cocircular points (such as regularly spaced soundings)
+ *     cannot corrupt the network.
+ * The expected cost is proportional to n log n.
  *
  * The input values are:
  *   verbose:		verbosity of debug output (MBIO convention)
@@ -43,6 +58,8 @@
  *			- interior points are flagged by zero values
  *			- triangles constructed using three edge points
  *			are removed
+ * The last three values of p1 and p2 are used for the vertices of an
+ * enclosing triangle. Points duplicating an earlier point are not used.
  *
  * The output values are:
  *   ntri:		number of output triangles
@@ -68,52 +85,246 @@
  *   cs3[2*npts+1]:	triangle connection array, value cs3[i] indicates which
  *			side of triangle ct3[i] connects to side 3 of triangle i
  *   error:		error value, MBIO convention
+ * The triangles are defined clockwise, side 1 joining the first and
+ * second vertices, side 2 the second and third, and side 3 the third
+ * and first.
  *
  * The work arrays are passed into mb_delaun rather than allocated and
  * deallocated within mb_delaun to increase the efficiency of programs
  * which use mb_delaun repeatedly. These work arrays are:
- *   v1[2*npts+1]:	the value v1[i] stores the x value of the
- *			circumcenter of triangle i
- *   v2[2*npts+1]:	the value v2[i] stores the y value of the
- *			circumcenter of triangle i
- *   v3[2*npts+1]:	the value v3[i] stores the square of the radius
- *			of the circumcircle of triangle i
- *   istack[2*npts+1]:	This is a stack onto which is pushed the the
- *			indexes of all the triangles that need to be
- *			replaced as a result of the addition of a new
- *			point. During the construction of the new 3-tuples
- *			the index of the 3-tuple to be replaced is
- *			popped from the stack. Since the addition of each
- *			new point adds 2 more triangles to the total,
- *			istack is popped 2 more times than it is pushed
- *			for each additional point. Hence istack is
- *			initialized prior to the main part of the routine
- *			so that it correctly returns the indexes of the
- *			new triangles.
- *    kv1[6*npts+1]:	For each new point, each existing triangle is
- *    kv2[6*npts+1]:	tested in turn and replaced if the new point
- *			lies within its circumcircle. Each side of the
- *			triangle is pushed onto the arrays kv1 and kv2 to
- *			potentially form a triangle with the new point.
- *			HOWEVER, if the side is already on the kv stack it
- *			is removed from the stack.  This means that if the
- *			side is common to two triangles that are to be
- *			replaced, i.e an interior side, then it is not
- *			used as the basis for forming the new triangles.
+ *   istack[2*npts+1]:	the triangles being replaced by a new point
+ *    kv1[6*npts+1]:	the sides of the region being replaced by a
+ *    kv2[6*npts+1]:	new point and the triangles outside those sides
+ * The circumcircle arrays v1, v2 and v3 used by the original algorithm
+ * are no longer needed and may be NULL.
  *
  * Author:	D. W. Caress
  * Date:	April, 1994
  */
 
+#include <float.h>
 #include <math.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "mb_aux.h"
 #include "mb_define.h"
 #include "mb_status.h"
 
+/* grid size used for the Hilbert curve sort */
+#define MB_DELAUN_HILBERT_ORDER 16
+
+/* number of BRIO insertion rounds beyond the first */
+#define MB_DELAUN_ROUNDS_MAX 24
+
+/* the enclosing triangle is this many times the data extent */
+#define MB_DELAUN_ENCLOSE 1000.0
+
+/* insertion order sort key */
+struct mb_delaun_key {
+	uint64_t key;
+	int index;
+};
+
+/*--------------------------------------------------------------------------*/
+/* Exact floating point expansion arithmetic after Shewchuk (1997), used
+   when the floating point filters cannot resolve the sign of a test. The
+   expansions hold nonoverlapping components in increasing magnitude so
+   that the sign of an expansion is the sign of its last component. */
+
+/* half a unit in the last place, and the filter error bounds */
+#define MB_DELAUN_EPSILON (DBL_EPSILON * 0.5)
+#define MB_DELAUN_CCWERRBOUND ((3.0 + 16.0 * MB_DELAUN_EPSILON) * MB_DELAUN_EPSILON)
+#define MB_DELAUN_ICCERRBOUND ((10.0 + 96.0 * MB_DELAUN_EPSILON) * MB_DELAUN_EPSILON)
+
+static inline void mb_delaun_two_sum(double a, double b, double *x, double *y) {
+	*x = a + b;
+	const double bvirt = *x - a;
+	const double avirt = *x - bvirt;
+	*y = (a - avirt) + (b - bvirt);
+}
+
+static inline void mb_delaun_fast_two_sum(double a, double b, double *x, double *y) {
+	*x = a + b;
+	*y = b - (*x - a);
+}
+
+static inline void mb_delaun_two_product(double a, double b, double *x, double *y) {
+	*x = a * b;
+	*y = fma(a, b, -*x);
+}
+
+/* h = e + b, returning the length of h */
+static int mb_delaun_grow_expansion(int elen, const double *e, double b, double *h) {
+	double q = b;
+	int hlen = 0;
+	for (int i = 0; i < elen; i++) {
+		double qnew, hh;
+		mb_delaun_two_sum(q, e[i], &qnew, &hh);
+		q = qnew;
+		if (hh != 0.0)
+			h[hlen++] = hh;
+	}
+	if (q != 0.0 || hlen == 0)
+		h[hlen++] = q;
+	return (hlen);
+}
+
+/* h = e + f, returning the length of h - h must not overlap e */
+static int mb_delaun_expansion_sum(int elen, const double *e, int flen, const double *f, double *h) {
+	memcpy(h, e, elen * sizeof(double));
+	int hlen = elen;
+	double temp[768];
+	for (int i = 0; i < flen; i++) {
+		hlen = mb_delaun_grow_expansion(hlen, h, f[i], temp);
+		memcpy(h, temp, hlen * sizeof(double));
+	}
+	return (hlen);
+}
+
+/* h = e * b, returning the length of h */
+static int mb_delaun_scale_expansion(int elen, const double *e, double b, double *h) {
+	double q, hh;
+	int hlen = 0;
+	mb_delaun_two_product(e[0], b, &q, &hh);
+	if (hh != 0.0)
+		h[hlen++] = hh;
+	for (int i = 1; i < elen; i++) {
+		double product1, product0, sum;
+		mb_delaun_two_product(e[i], b, &product1, &product0);
+		mb_delaun_two_sum(q, product0, &sum, &hh);
+		if (hh != 0.0)
+			h[hlen++] = hh;
+		mb_delaun_fast_two_sum(product1, sum, &q, &hh);
+		if (hh != 0.0)
+			h[hlen++] = hh;
+	}
+	if (q != 0.0 || hlen == 0)
+		h[hlen++] = q;
+	return (hlen);
+}
+
+/* exact orientation determinant of points a, b, c as an expansion
+   of up to 12 components */
+static int mb_delaun_orient_exact(const double *pa, const double *pb, const double *pc, double *det) {
+	double terms[6][2];
+	mb_delaun_two_product(pa[0], pb[1], &terms[0][1], &terms[0][0]);
+	mb_delaun_two_product(-pa[1], pb[0], &terms[1][1], &terms[1][0]);
+	mb_delaun_two_product(pb[0], pc[1], &terms[2][1], &terms[2][0]);
+	mb_delaun_two_product(-pb[1], pc[0], &terms[3][1], &terms[3][0]);
+	mb_delaun_two_product(pc[0], pa[1], &terms[4][1], &terms[4][0]);
+	mb_delaun_two_product(-pc[1], pa[0], &terms[5][1], &terms[5][0]);
+	int detlen = mb_delaun_expansion_sum(2, terms[0], 2, terms[1], det);
+	for (int i = 2; i < 6; i++) {
+		double temp[12];
+		memcpy(temp, det, detlen * sizeof(double));
+		detlen = mb_delaun_expansion_sum(detlen, temp, 2, terms[i], det);
+	}
+	return (detlen);
+}
+
+/* Returns a positive value if the points a, b, and c occur in
+   counterclockwise order, a negative value if they occur in clockwise
+   order, and zero if they are collinear. */
+static double mb_delaun_orient(const double *pa, const double *pb, const double *pc) {
+	const double detleft = (pa[0] - pc[0]) * (pb[1] - pc[1]);
+	const double detright = (pa[1] - pc[1]) * (pb[0] - pc[0]);
+	const double det = detleft - detright;
+	const double errbound = MB_DELAUN_CCWERRBOUND * (fabs(detleft) + fabs(detright));
+	if (det > errbound || -det > errbound)
+		return (det);
+
+	double exact[12];
+	const int len = mb_delaun_orient_exact(pa, pb, pc, exact);
+	return (exact[len - 1]);
+}
+
+/* Returns a positive value if the point d lies inside the circle passing
+   through a, b, and c, a negative value if it lies outside, and zero if
+   the four points are cocircular. The points a, b, and c must be in
+   counterclockwise order. */
+static double mb_delaun_incircle(const double *pa, const double *pb, const double *pc, const double *pd) {
+	const double adx = pa[0] - pd[0];
+	const double bdx = pb[0] - pd[0];
+	const double cdx = pc[0] - pd[0];
+	const double ady = pa[1] - pd[1];
+	const double bdy = pb[1] - pd[1];
+	const double cdy = pc[1] - pd[1];
+	const double bdxcdy = bdx * cdy;
+	const double cdxbdy = cdx * bdy;
+	const double alift = adx * adx + ady * ady;
+	const double cdxady = cdx * ady;
+	const double adxcdy = adx * cdy;
+	const double blift = bdx * bdx + bdy * bdy;
+	const double adxbdy = adx * bdy;
+	const double bdxady = bdx * ady;
+	const double clift = cdx * cdx + cdy * cdy;
+	const double det = alift * (bdxcdy - cdxbdy) + blift * (cdxady - adxcdy) + clift * (adxbdy - bdxady);
+	const double permanent = (fabs(bdxcdy) + fabs(cdxbdy)) * alift + (fabs(cdxady) + fabs(adxcdy)) * blift +
+	                         (fabs(adxbdy) + fabs(bdxady)) * clift;
+	const double errbound = MB_DELAUN_ICCERRBOUND * permanent;
+	if (det > errbound || -det > errbound)
+		return (det);
+
+	/* expand the lifted 4 by 4 determinant along the lifted column:
+	   det = |a|^2 O(b,c,d) - |b|^2 O(c,d,a) + |c|^2 O(d,a,b) - |d|^2 O(a,b,c) */
+	const double *points[4] = {pa, pb, pc, pd};
+	double exact[384];
+	int exactlen = 0;
+	for (int i = 0; i < 4; i++) {
+		const double *p = points[i];
+		double orient[12];
+		const int orientlen = mb_delaun_orient_exact(points[(i + 1) % 4], points[(i + 2) % 4], points[(i + 3) % 4], orient);
+		const double sign = (i % 2 == 0) ? 1.0 : -1.0;
+		double tx[24], ty[24], txx[48], tyy[48], lift[96], temp[384];
+		const int txlen = mb_delaun_scale_expansion(orientlen, orient, sign * p[0], tx);
+		const int txxlen = mb_delaun_scale_expansion(txlen, tx, p[0], txx);
+		const int tylen = mb_delaun_scale_expansion(orientlen, orient, sign * p[1], ty);
+		const int tyylen = mb_delaun_scale_expansion(tylen, ty, p[1], tyy);
+		const int liftlen = mb_delaun_expansion_sum(txxlen, txx, tyylen, tyy, lift);
+		if (exactlen == 0) {
+			memcpy(exact, lift, liftlen * sizeof(double));
+			exactlen = liftlen;
+		}
+		else {
+			memcpy(temp, exact, exactlen * sizeof(double));
+			exactlen = mb_delaun_expansion_sum(exactlen, temp, liftlen, lift, exact);
+		}
+	}
+	return (exact[exactlen - 1]);
+}
+/*--------------------------------------------------------------------------*/
+/* Position of a point along a Hilbert curve filling a 2^16 by 2^16 grid. */
+static uint64_t mb_delaun_hilbert(uint32_t x, uint32_t y) {
+	const uint32_t n = 1u << MB_DELAUN_HILBERT_ORDER;
+	uint64_t d = 0;
+	for (uint32_t s = n / 2; s > 0; s /= 2) {
+		const uint32_t rx = (x & s) > 0;
+		const uint32_t ry = (y & s) > 0;
+		d += (uint64_t)s * s * ((3 * rx) ^ ry);
+		if (ry == 0) {
+			if (rx == 1) {
+				x = n - 1 - x;
+				y = n - 1 - y;
+			}
+			const uint32_t t = x;
+			x = y;
+			y = t;
+		}
+	}
+	return (d);
+}
+/*--------------------------------------------------------------------------*/
+static int mb_delaun_key_compare(const void *a, const void *b) {
+	const struct mb_delaun_key *ka = (const struct mb_delaun_key *)a;
+	const struct mb_delaun_key *kb = (const struct mb_delaun_key *)b;
+	if (ka->key != kb->key)
+		return (ka->key < kb->key ? -1 : 1);
+	return (ka->index - kb->index);
+}
 /*--------------------------------------------------------------------------*/
 /* 	function mb_delaun creates a network of triangles connecting an
     input set of points, where the triangles are as close to equiangular
@@ -153,312 +364,240 @@ int mb_delaun(int verbose, int npts, double *p1, double *p2, int *ed, int *ntri,
 		}
 	}
 
-	int itemp[2][3];
-	itemp[0][0] = 1;
-	itemp[1][0] = 2;
-	itemp[0][1] = 1;
-	itemp[1][1] = 3;
-	itemp[0][2] = 2;
-	itemp[1][2] = 3;
+	int status = MB_SUCCESS;
+	*error = MB_ERROR_NO_ERROR;
+	*ntri = 0;
 
-	/* initialize the triangle stack */
-	int n1 = 2 * npts + 3;
-	for (int i = 0; i < n1; i++)
-		istack[i] = i;
+	/* the triangle vertices and adjacencies are built in place in the
+	   output arrays: vertices counterclockwise, with tn[e] the triangle
+	   across the side from vertex tv[e] to vertex tv[(e + 1) % 3], and
+	   cs1 used to mark the triangles being replaced by each new point */
+	int *tv[3] = {iv1, iv2, iv3};
+	int *tn[3] = {ct1, ct2, ct3};
+	int *mark = cs1;
 
 	/* determine the extremes of the data */
-	double xmin = p1[0];
-	double xmax = p1[0];
-	double ymin = p2[0];
-	double ymax = p2[0];
+	double xmin = 0.0;
+	double xmax = 0.0;
+	double ymin = 0.0;
+	double ymax = 0.0;
+	if (npts > 0) {
+		xmin = p1[0];
+		xmax = p1[0];
+		ymin = p2[0];
+		ymax = p2[0];
+	}
 	for (int i = 0; i < npts; i++) {
 		xmin = MIN(xmin, p1[i]);
 		xmax = MAX(xmax, p1[i]);
 		ymin = MIN(ymin, p2[i]);
 		ymax = MAX(ymax, p2[i]);
 	}
+	const double extent = MAX(xmax - xmin, ymax - ymin);
 
-	/* enclose the data region in an equilateral triangle
-	    - put circumcenter and radius-squared into the list */
-	double cx = xmax - xmin;
-	double cy = ymax - ymin;
-	const double crsq = 1.2 * (cx * cx + cy * cy);
-	cx = 0.5 * (xmin + xmax);
-	cy = 0.5 * (ymin + ymax);
-	v1[0] = cx;
-	v2[0] = cy;
-	v3[0] = crsq;
-
-	/* put vertex coordinates in the end of the p array */
-	const double rad = sqrt(v3[0]);
-	/* const int maxn = npts + 3; */
-	for (int i = 0; i < 3; i++) {
-		p1[npts + 2 - i] = v1[0] + rad * cos(2.0944 * (i + 1));
-		p2[npts + 2 - i] = v2[0] + rad * sin(2.0944 * (i + 1));
+	/* allocate the insertion order and the map from points to the new
+	   triangles based on them */
+	struct mb_delaun_key *order = NULL;
+	int *vertex_tri = NULL;
+	if (npts >= 3 && extent > 0.0) {
+		status = mb_mallocd(verbose, __FILE__, __LINE__, npts * sizeof(struct mb_delaun_key), (void **)&order, error);
+		if (status == MB_SUCCESS)
+			status = mb_mallocd(verbose, __FILE__, __LINE__, (npts + 3) * sizeof(int), (void **)&vertex_tri, error);
 	}
-	iv1[0] = npts + 2;
-	iv2[0] = npts + 1;
-	iv3[0] = npts;
 
-	/* scan through the data backwards */
-	int isp = 1;
-	int id = 1;
+	int nuse = 0;
+	int nduplicate = 0;
+	int nalloc = 0;
+	if (status == MB_SUCCESS && order != NULL) {
+		/* get the insertion order - each point is assigned to a round
+		   with probability one half for the last round, one quarter for
+		   the one before, and so on, using a hash of its index, and the
+		   rounds are each sorted along a Hilbert curve */
+		const double scale = ((1u << MB_DELAUN_HILBERT_ORDER) - 1) / extent;
+		for (int i = 0; i < npts; i++) {
+			uint64_t hash = (uint64_t)i + 0x9e3779b97f4a7c15ULL;
+			hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+			hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+			hash = hash ^ (hash >> 31);
+			int round = 0;
+			while (round < MB_DELAUN_ROUNDS_MAX && (hash & 1) == 0) {
+				round++;
+				hash >>= 1;
+			}
+			const uint32_t ix = (uint32_t)((p1[i] - xmin) * scale);
+			const uint32_t iy = (uint32_t)((p2[i] - ymin) * scale);
+			order[i].key = ((uint64_t)(MB_DELAUN_ROUNDS_MAX - round) << 32) | mb_delaun_hilbert(ix, iy);
+			order[i].index = i;
+		}
+		qsort(order, npts, sizeof(struct mb_delaun_key), mb_delaun_key_compare);
+
+		/* enclose the data region in a large equilateral triangle with
+		   counterclockwise vertices stored at the end of the p arrays */
+		const double cx = 0.5 * (xmin + xmax);
+		const double cy = 0.5 * (ymin + ymax);
+		const double rad = MB_DELAUN_ENCLOSE * extent;
+		for (int i = 0; i < 3; i++) {
+			p1[npts + i] = cx + rad * cos(M_PI * (0.5 + 2.0 * i / 3.0));
+			p2[npts + i] = cy + rad * sin(M_PI * (0.5 + 2.0 * i / 3.0));
+		}
+		tv[0][0] = npts;
+		tv[1][0] = npts + 1;
+		tv[2][0] = npts + 2;
+		tn[0][0] = -1;
+		tn[1][0] = -1;
+		tn[2][0] = -1;
+		mark[0] = -1;
+		nalloc = 1;
+		int last = 0;
 
-	int status = MB_SUCCESS;
+		/* insert the points */
+		for (int iorder = 0; iorder < npts; iorder++) {
+			const int nuc = order[iorder].index;
+			const double pnuc[2] = {p1[nuc], p2[nuc]};
 
-	for (int nuc = npts - 1; nuc > -1; nuc--) {
-		int km = 0;
-
-		/* loop through the established 3-tuples */
-		for (int jt = 0; jt < isp; jt++) {
-			const int i1 = iv3[jt];
-			/* calculate the distance of the
-			point from the jt circumcenter */
-			const double rsq = (p1[nuc] - p1[i1]) * (p1[nuc] + p1[i1] - 2 * v1[jt]) + (p2[nuc] - p2[i1]) * (p2[nuc] + p2[i1] - 2 * v2[jt]);
-
-			/* If the point lies within circumcircle of triangle
-			(3-tuple) jt then delete this triangle. Save the
-			edges provided that they are not part of another
-			triangle for which the point lies within the circumcircle
-			Thus "interior" edges are eliminated prior to
-			construction of the new triangles (3 tuples). */
-			if (rsq <= 0.0) {
-				/* triangle needs replacing => push the index on the stack */
-				id = id - 1;
-				istack[id] = jt;
-
-				/* add edges to kv but delete if already present */
-				for (int i = 0; i < 3; i++) {
-					/* cycle through the edges of the triangle */
-					const int l1 = itemp[0][i];
-					const int l2 = itemp[1][i];
-					int *ivs1 = NULL;
-					int *ivs2 = NULL;
-					if (l1 == 1)
-						ivs1 = iv1;
-					if (l1 == 2)
-						ivs1 = iv2;
-					if (l1 == 3)
-						ivs1 = iv3;
-					if (l2 == 1)
-						ivs2 = iv1;
-					if (l2 == 2)
-						ivs2 = iv2;
-					if (l2 == 3)
-						ivs2 = iv3;
-					bool addside = true;
-
-					/* Check if the side is already stored in kv. If it
-					    is then Side common to more than one of the
-					    current triangles. So remove it from list. */
-					int j = 0;
-					while ((j < km) && addside) {
-						if (ivs1[jt] == kv1[j] && ivs2[jt] == kv2[j]) {
-							addside = false;
-							km--;
-							for (int k = j; k < km; k++) {
-								kv1[k] = kv1[k + 1];
-								kv2[k] = kv2[k + 1];
-							}
-						}
-						j++;
+			/* walk from the last new triangle to the triangle containing the point */
+			int t = last;
+			bool found = false;
+			while (!found) {
+				found = true;
+				for (int e = 0; e < 3 && found; e++) {
+					const int a = tv[e][t];
+					const int b = tv[(e + 1) % 3][t];
+					const double pa[2] = {p1[a], p2[a]};
+					const double pb[2] = {p1[b], p2[b]};
+					if (mb_delaun_orient(pa, pb, pnuc) < 0.0) {
+						t = tn[e][t];
+						found = false;
 					}
+				}
+			}
+
+			/* skip points that duplicate an existing vertex */
+			bool duplicate = false;
+			for (int e = 0; e < 3; e++)
+				if (p1[tv[e][t]] == pnuc[0] && p2[tv[e][t]] == pnuc[1])
+					duplicate = true;
+			if (duplicate) {
+				nduplicate++;
+				continue;
+			}
 
-					/* side was not found in list so add it now */
-					if (addside) {
-						km++;
-						if (km > 6 * npts + 1) {
-							fprintf(stderr, "Error in mb_delaun - kv array too small at dimension %d\n", 6 * npts + 1);
-							*error = 99;
-							status = MB_FAILURE;
-							return (status);
+			/* find the triangles whose circumcircles contain the point by
+			   searching outwards from the containing triangle, saving the
+			   sides of the region they cover and the triangles beyond */
+			int ndelete = 0;
+			int nside = 0;
+			istack[ndelete++] = t;
+			mark[t] = nuc;
+			for (int idelete = 0; idelete < ndelete; idelete++) {
+				const int td = istack[idelete];
+				for (int e = 0; e < 3; e++) {
+					const int tt = tn[e][td];
+					if (tt >= 0 && mark[tt] == nuc)
+						continue;
+					if (tt >= 0) {
+						const double pa[2] = {p1[tv[0][tt]], p2[tv[0][tt]]};
+						const double pb[2] = {p1[tv[1][tt]], p2[tv[1][tt]]};
+						const double pc[2] = {p1[tv[2][tt]], p2[tv[2][tt]]};
+						if (mb_delaun_incircle(pa, pb, pc, pnuc) > 0.0) {
+							mark[tt] = nuc;
+							istack[ndelete++] = tt;
+							continue;
 						}
-						kv1[km - 1] = ivs1[jt];
-						kv2[km - 1] = ivs2[jt];
 					}
-				} /* end: for (i=0;i<3;i++) */
-			}     /* end: if (rsq < 0.0) */
-
-		} /* end: for (jt=0;jt<isp;jt++) */
-
-		/* form new 3-tuples */
-		for (int i = 0; i < km; i++) {
-			/* pop the triangle index from the stack */
-			int kt = istack[id];
-			id++;
-
-			/* calculate the circumcircle and radius squared */
-			const int i1 = kv1[i];
-			const int i2 = kv2[i];
-			const double denom = ((p1[i1] - p1[nuc]) * (p2[i2] - p2[nuc]) - (p2[i1] - p2[nuc]) * (p1[i2] - p1[nuc]));
-
-			/* check if the three points form a true triangle */
-			if (denom != 0.0) {
-				const double s =
-				    ((p1[i1] - p1[nuc]) * (p1[i1] - p1[i2]) + (p2[i1] - p2[nuc]) * (p2[i1] - p2[i2])) / denom;
-				v1[kt] = 0.5 * (p1[i2] + p1[nuc] + s * (p2[i2] - p2[nuc]));
-				v2[kt] = 0.5 * (p2[i2] + p2[nuc] - s * (p1[i2] - p1[nuc]));
+					kv1[2 * nside] = tv[e][td];
+					kv1[2 * nside + 1] = tv[(e + 1) % 3][td];
+					kv2[2 * nside] = tt;
+					nside++;
+				}
 			}
 
-			/* The three points are degenerate and lie on a line.
-			The "true" circumcenter is at infinity and the radius
-			is also infinite. All points on the plane lie within
-			the circumcircle. Thus simulate this by using
-			circumcenter and circumcircle of the enclosing
-			equilateral triangle */
-			else {
-				fprintf(stderr, "\nmb_delaun Warning: three linear points cannot be a triangle\n");
-				fprintf(stderr, "%d %f %f\n", i1, p1[i1], p2[i1]);
-				fprintf(stderr, "%d %f %f\n", i2, p1[i2], p2[i2]);
-				fprintf(stderr, "%d %f %f\n", nuc, p1[nuc], p2[nuc]);
-				v1[kt] = cx;
-				v2[kt] = cy;
-				v3[kt] = nuc;
-			}
-			iv1[kt] = kv1[i];
-			iv2[kt] = kv2[i];
-			iv3[kt] = nuc;
-		} /* end: for (i=0;i<km;i++) */
-
-		/* adding a point adds two more triangles to the total
-		  number of triangles */
-		isp = isp + 2;
-
-	} /* end: for (nuc=npts-1;nuc>-1;nuc--) */
-
-	/* set number of triangles */
-	*ntri = isp;
-
-	/* remove triangles using added points and triangles made
-	    up of three flagged edge points */
-	for (int i = *ntri - 1; i > -1; i--) {
-		if (iv1[i] >= npts || iv2[i] >= npts || iv3[i] >= npts) {
-			for (int j = i; j < isp - 1; j++) {
-				iv1[j] = iv1[j + 1];
-				iv2[j] = iv2[j + 1];
-				iv3[j] = iv3[j + 1];
+			/* form new triangles joining the point to each side, reusing
+			   the replaced triangles - there are always two more new
+			   triangles than replaced ones */
+			for (int iside = 0; iside < nside; iside++) {
+				const int tnew = (iside < ndelete) ? istack[iside] : nalloc++;
+				const int a = kv1[2 * iside];
+				const int b = kv1[2 * iside + 1];
+				const int tt = kv2[2 * iside];
+				tv[0][tnew] = a;
+				tv[1][tnew] = b;
+				tv[2][tnew] = nuc;
+				tn[0][tnew] = tt;
+				if (tt >= 0) {
+					for (int e = 0; e < 3; e++)
+						if (tv[e][tt] == b && tv[(e + 1) % 3][tt] == a)
+							tn[e][tt] = tnew;
+				}
+				vertex_tri[a] = tnew;
+				kv2[2 * iside + 1] = tnew;
 			}
-			isp--;
-		}
-		else if (ed[iv1[i]] != 0 && ed[iv2[i]] != 0 && ed[iv3[i]] != 0) {
-			for (int j = i; j < isp - 1; j++) {
-				iv1[j] = iv1[j + 1];
-				iv2[j] = iv2[j + 1];
-				iv3[j] = iv3[j + 1];
+			for (int iside = 0; iside < nside; iside++) {
+				const int tnew = kv2[2 * iside + 1];
+				const int tnext = vertex_tri[tv[1][tnew]];
+				tn[1][tnew] = tnext;
+				tn[2][tnext] = tnew;
+				mark[tnew] = -1;
 			}
-			isp--;
+			last = kv2[2 * nside - 1];
+			nuse++;
 		}
 	}
-	*ntri = isp;
 
-	/* make sure all triangles are defined clockwise */
-	for (int i = 0; i < *ntri; i++) {
-		const double xproduct =
-		    -(p1[iv2[i]] - p1[iv1[i]]) * (p2[iv3[i]] - p2[iv2[i]]) + (p1[iv3[i]] - p1[iv2[i]]) * (p2[iv2[i]] - p2[iv1[i]]);
-		if (xproduct < 0.0) {
-			int j = iv2[i];
-			iv2[i] = iv3[i];
-			iv3[i] = j;
+	/* remove triangles using the enclosing vertices and triangles made
+	    up of three flagged edge points, compacting the rest in place
+	    and using istack to map the old triangle indices to the new */
+	int nkeep = 0;
+	for (int i = 0; i < nalloc; i++) {
+		istack[i] = -1;
+		if (tv[0][i] >= npts || tv[1][i] >= npts || tv[2][i] >= npts)
+			continue;
+		if (ed[tv[0][i]] != 0 && ed[tv[1][i]] != 0 && ed[tv[2][i]] != 0)
+			continue;
+		istack[i] = nkeep;
+		for (int e = 0; e < 3; e++) {
+			tv[e][nkeep] = tv[e][i];
+			tn[e][nkeep] = tn[e][i];
 		}
+		nkeep++;
 	}
+	*ntri = nkeep;
 
-	/* now get connectivity */
+	/* define the triangles clockwise, which reverses the order of the
+	    sides, and get the connecting sides */
 	for (int i = 0; i < *ntri; i++) {
-		ct1[i] = -1;
-		ct2[i] = -1;
-		ct3[i] = -1;
-		cs1[i] = -1;
-		cs2[i] = -1;
-		cs3[i] = -1;
+		const int j = iv2[i];
+		iv2[i] = iv3[i];
+		iv3[i] = j;
+		const int k = (ct3[i] >= 0) ? istack[ct3[i]] : -1;
+		ct2[i] = (ct2[i] >= 0) ? istack[ct2[i]] : -1;
+		ct3[i] = (ct1[i] >= 0) ? istack[ct1[i]] : -1;
+		ct1[i] = k;
 	}
+	int *cs[3] = {cs1, cs2, cs3};
 	for (int i = 0; i < *ntri; i++) {
-		/* check side 1 of triangle i */
-		if (ct1[i] == -1) {
-			bool notfound = true;
-			for (int j = 0; notfound && j < *ntri; j++) {
-				if (notfound && iv1[i] == iv2[j] && iv2[i] == iv1[j]) {
-					ct1[i] = j;
-					cs1[i] = 0;
-					ct1[j] = i;
-					cs1[j] = 0;
-					notfound = false;
-				}
-				if (notfound && iv1[i] == iv3[j] && iv2[i] == iv2[j]) {
-					ct1[i] = j;
-					cs1[i] = 1;
-					ct2[j] = i;
-					cs2[j] = 0;
-					notfound = false;
-				}
-				if (notfound && iv1[i] == iv1[j] && iv2[i] == iv3[j]) {
-					ct1[i] = j;
-					cs1[i] = 2;
-					ct3[j] = i;
-					cs3[j] = 0;
-					notfound = false;
-				}
-			}
-		}
-		/* check side 2 of triangle i */
-		if (ct2[i] == -1) {
-			bool notfound = true;
-			for (int j = 0; notfound && j < *ntri; j++) {
-				if (notfound && iv2[i] == iv2[j] && iv3[i] == iv1[j]) {
-					ct2[i] = j;
-					cs2[i] = 0;
-					ct1[j] = i;
-					cs1[j] = 1;
-					notfound = false;
-				}
-				if (notfound && iv2[i] == iv3[j] && iv3[i] == iv2[j]) {
-					ct2[i] = j;
-					cs2[i] = 1;
-					ct2[j] = i;
-					cs2[j] = 1;
-					notfound = false;
-				}
-				if (notfound && iv2[i] == iv1[j] && iv3[i] == iv3[j]) {
-					ct2[i] = j;
-					cs2[i] = 2;
-					ct3[j] = i;
-					cs3[j] = 1;
-					notfound = false;
-				}
-			}
-		}
-		/* check side 3 of triangle i */
-		if (ct3[i] == -1) {
-			bool notfound = true;
-			for (int j = 0; notfound && j < *ntri; j++) {
-				if (notfound && iv3[i] == iv2[j] && iv1[i] == iv1[j]) {
-					ct3[i] = j;
-					cs3[i] = 0;
-					ct1[j] = i;
-					cs1[j] = 2;
-					notfound = false;
-				}
-				if (notfound && iv3[i] == iv3[j] && iv1[i] == iv2[j]) {
-					ct3[i] = j;
-					cs3[i] = 1;
-					ct2[j] = i;
-					cs2[j] = 2;
-					notfound = false;
-				}
-				if (notfound && iv3[i] == iv1[j] && iv1[i] == iv3[j]) {
-					ct3[i] = j;
-					cs3[i] = 2;
-					ct3[j] = i;
-					cs3[j] = 2;
-					notfound = false;
-				}
+		for (int s = 0; s < 3; s++) {
+			const int j = tn[s][i];
+			cs[s][i] = -1;
+			if (j >= 0) {
+				for (int sj = 0; sj < 3; sj++)
+					if (tn[sj][j] == i)
+						cs[s][i] = sj;
 			}
 		}
 	}
 
+	if (order != NULL)
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&order, error);
+	if (vertex_tri != NULL)
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&vertex_tri, error);
+
 	if (verbose >= 2) {
 		fprintf(stderr, "\ndbg2  MBIO function <%s> completed\n", __func__);
 		fprintf(stderr, "dbg2  Return values:\n");
 		fprintf(stderr, "dbg2       ntri:             %d\n", *ntri);
+		fprintf(stderr, "dbg2       npts used:        %d\n", nuse);
+		fprintf(stderr, "dbg2       npts duplicate:   %d\n", nduplicate);
 		if (verbose >= 5) {
 			fprintf(stderr, "dbg5       Output vertices:\n");
 			for (int i = 0; i < *ntri; i++)
@@ -29,12 +29,22 @@
  * This is used for laying out sidescan on the seafloor and for sidescan
  * mosaicing.
  *
+ * Intersections are found by casting the vector through a min/max elevation
+ * pyramid built over the grid: pyramid cells lying entirely below the vector
+ * are stepped over in one move, and in the grid cell where the vector meets
+ * the topography the crossing with the bilinear surface is solved exactly.
+ * If the pyramid is not available, or the sensor lies beneath the grid
+ * surface, the original search marching range steps along the vector is used.
+ *
  * Author:	D. W. Caress
  * Date:	October 20, 2012
  */
 
+#include <float.h>
 #include <math.h>
+#include <pthread.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
 
@@ -43,18 +53,447 @@
 #include "mb_status.h"
 
 /*--------------------------------------------------------------------*/
-int mb_topogrid_init(int verbose, mb_path topogridfile, int *lonflip, void **topogrid_ptr, int *error) {
-	if (verbose >= 2) {
-		fprintf(stderr, "\ndbg2  MBIO function <%s> called\n", __func__);
-		fprintf(stderr, "dbg2  Input arguments:\n");
-		fprintf(stderr, "dbg2       verbose:                   %d\n", verbose);
-		fprintf(stderr, "dbg2       topogridfile:              %s\n", topogridfile);
-		fprintf(stderr, "dbg2       lonflip:                   %d\n", *lonflip);
-		fprintf(stderr, "dbg2       topogrid:                  %p\n", *topogrid_ptr);
+/* Tile of a grid paged in on demand. Tile (ti, tj) holds the grid cells
+ * [ti * 2^level, (ti + 1) * 2^level) by [tj * 2^level, (tj + 1) * 2^level)
+ * and so the nodes on its far edges are shared with the next tiles. Each
+ * tile carries the min/max pyramid of its own cells, up to the single cell
+ * spanning the tile. */
+struct mb_topogrid_tile {
+	int ti;
+	int tj;
+	int n_columns;
+	int n_rows;
+	float *data;
+	int pyramid_nlevels;
+	int pyramid_n_columns[MB_TOPOGRID_PYRAMID_LEVELS_MAX];
+	int pyramid_n_rows[MB_TOPOGRID_PYRAMID_LEVELS_MAX];
+	float *pyramid_min[MB_TOPOGRID_PYRAMID_LEVELS_MAX];
+	float *pyramid_max[MB_TOPOGRID_PYRAMID_LEVELS_MAX];
+	int nusers;
+	unsigned long last_use;
+	bool loading;
+};
+
+/* Cache of the tiles in memory, least recently used tiles not in use are
+ * dropped to make room. The lock covers the cache, a tile's contents never
+ * change while it is resident. A tile being read holds its cache slot with
+ * loading set; the file is read without the lock and other calls wanting
+ * the tile wait on loaded. */
+struct mb_topogrid_tiles {
+	int verbose;
+	int level;
+	int ntile_columns;
+	int ntile_rows;
+	int cache_max;
+	int ncache;
+	struct mb_topogrid_tile **cache;
+	int *slot;
+	unsigned long clock;
+	int nload;
+	double file_xmin;
+	double file_ymin;
+	pthread_mutex_t mutex;
+	pthread_cond_t loaded;
+};
+
+/* The tile in use by one call, held until the call moves on to another
+ * tile or finishes */
+struct mb_topogrid_cursor {
+	struct mb_topogrid_tile *tile;
+};
+/*--------------------------------------------------------------------*/
+static void mb_topogrid_pyramid_free(int verbose, int *pyramid_nlevels, float **pyramid_min, float **pyramid_max, int *error) {
+	for (int k = 0; k < *pyramid_nlevels; k++) {
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&(pyramid_min[k]), error);
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&(pyramid_max[k]), error);
+	}
+	*pyramid_nlevels = 0;
+}
+/*--------------------------------------------------------------------*/
+/* Build the min/max elevation pyramid over the cells of a grid. The first
+ * level is taken from the grid nodes (each level 1 cell covers 2x2 grid
+ * cells, or 3x3 nodes), each following level halves the dimensions
+ * until a single cell covers the whole grid. Cells with no valid nodes
+ * have min > max and are never intersected. */
+static int mb_topogrid_pyramid_build(int verbose, const float *data, int grid_n_columns, int grid_n_rows, float nodatavalue,
+                          int *pyramid_nlevels, int *pyramid_n_columns, int *pyramid_n_rows, float **pyramid_min,
+                          float **pyramid_max, int *error) {
+	int status = MB_SUCCESS;
+
+	*pyramid_nlevels = 0;
+	int n_columns = grid_n_columns - 1;
+	int n_rows = grid_n_rows - 1;
+	if (n_columns < 1 || n_rows < 1)
+		return (status);
+
+	for (int k = 0; k < MB_TOPOGRID_PYRAMID_LEVELS_MAX && status == MB_SUCCESS; k++) {
+		const int nc = (n_columns + 1) / 2;
+		const int nr = (n_rows + 1) / 2;
+		pyramid_min[k] = NULL;
+		pyramid_max[k] = NULL;
+		status = mb_mallocd(verbose, __FILE__, __LINE__, nc * nr * sizeof(float), (void **)&pyramid_min[k], error);
+		if (status == MB_SUCCESS)
+			status = mb_mallocd(verbose, __FILE__, __LINE__, nc * nr * sizeof(float), (void **)&pyramid_max[k], error);
+		if (status != MB_SUCCESS) {
+			if (pyramid_min[k] != NULL)
+				mb_freed(verbose, __FILE__, __LINE__, (void **)&(pyramid_min[k]), error);
+			break;
+		}
+		pyramid_n_columns[k] = nc;
+		pyramid_n_rows[k] = nr;
+		*pyramid_nlevels = k + 1;
+		float *pmin = pyramid_min[k];
+		float *pmax = pyramid_max[k];
+
+		/* level 1 from the grid nodes */
+		if (k == 0) {
+			for (int i = 0; i < nc; i++) {
+				const int i1 = MIN(2 * i + 2, grid_n_columns - 1);
+				for (int j = 0; j < nr; j++) {
+					const int j1 = MIN(2 * j + 2, grid_n_rows - 1);
+					float zmin = FLT_MAX;
+					float zmax = -FLT_MAX;
+					for (int ii = 2 * i; ii <= i1; ii++)
+						for (int jj = 2 * j; jj <= j1; jj++) {
+							const float z = data[ii * grid_n_rows + jj];
+							if (z != nodatavalue) {
+								zmin = MIN(zmin, z);
+								zmax = MAX(zmax, z);
+							}
+						}
+					pmin[i * nr + j] = zmin;
+					pmax[i * nr + j] = zmax;
+				}
+			}
+		}
+
+		/* following levels from the previous level */
+		else {
+			const float *cmin = pyramid_min[k - 1];
+			const float *cmax = pyramid_max[k - 1];
+			for (int i = 0; i < nc; i++) {
+				const int i1 = MIN(2 * i + 1, n_columns - 1);
+				for (int j = 0; j < nr; j++) {
+					const int j1 = MIN(2 * j + 1, n_rows - 1);
+					float zmin = FLT_MAX;
+					float zmax = -FLT_MAX;
+					for (int ii = 2 * i; ii <= i1; ii++)
+						for (int jj = 2 * j; jj <= j1; jj++) {
+							zmin = MIN(zmin, cmin[ii * n_rows + jj]);
+							zmax = MAX(zmax, cmax[ii * n_rows + jj]);
+						}
+					pmin[i * nr + j] = zmin;
+					pmax[i * nr + j] = zmax;
+				}
+			}
+		}
+
+		if (nc == 1 && nr == 1)
+			break;
+		n_columns = nc;
+		n_rows = nr;
+	}
+
+	/* without the pyramid the intersections use the range marching search */
+	if (status != MB_SUCCESS || pyramid_n_columns[*pyramid_nlevels - 1] != 1 || pyramid_n_rows[*pyramid_nlevels - 1] != 1) {
+		mb_topogrid_pyramid_free(verbose, pyramid_nlevels, pyramid_min, pyramid_max, error);
+		*error = MB_ERROR_NO_ERROR;
+		status = MB_SUCCESS;
+	}
+
+	return (status);
+}
+/*--------------------------------------------------------------------*/
+static void mb_topogrid_tile_free(int verbose, struct mb_topogrid_tile **tile, int *error) {
+	mb_topogrid_pyramid_free(verbose, &(*tile)->pyramid_nlevels, (*tile)->pyramid_min, (*tile)->pyramid_max, error);
+	mb_freed(verbose, __FILE__, __LINE__, (void **)&((*tile)->data), error);
+	mb_freed(verbose, __FILE__, __LINE__, (void **)tile, error);
+}
+/*--------------------------------------------------------------------*/
+/* Read the nodes of a tile from the grid file and build its pyramid, a
+ * tile that cannot be read is left empty (all nodes undefined) so that the
+ * vectors pass through it. Called without the cache lock. */
+static int mb_topogrid_tile_load(struct mb_topogrid_struct *topogrid, struct mb_topogrid_tile *tile) {
+	const struct mb_topogrid_tiles *tiles = (const struct mb_topogrid_tiles *)topogrid->tiles;
+	const int verbose = tiles->verbose;
+	int error = MB_ERROR_NO_ERROR;
+
+	const int i0 = tile->ti << tiles->level;
+	const int j0 = tile->tj << tiles->level;
+	tile->n_columns = MIN(i0 + (1 << tiles->level), topogrid->n_columns - 1) - i0 + 1;
+	tile->n_rows = MIN(j0 + (1 << tiles->level), topogrid->n_rows - 1) - j0 + 1;
+
+	/* read the nodes from the file, in the file's longitude convention */
+	double wesn[4];
+	wesn[0] = tiles->file_xmin + i0 * topogrid->dx;
+	wesn[1] = tiles->file_xmin + (i0 + tile->n_columns - 1) * topogrid->dx;
+	wesn[2] = tiles->file_ymin + j0 * topogrid->dy;
+	wesn[3] = tiles->file_ymin + (j0 + tile->n_rows - 1) * topogrid->dy;
+	int projection_mode;
+	mb_path projection_id;
+	float nodatavalue;
+	int nxy, n_columns, n_rows;
+	double min, max, xmin, xmax, ymin, ymax, dx, dy;
+	int status = mb_read_gmt_grd_window(verbose >= 2 ? verbose : 0, topogrid->file, wesn, 1, &projection_mode, projection_id,
+	                                    &nodatavalue, &nxy, &n_columns, &n_rows, &min, &max, &xmin, &xmax, &ymin, &ymax, &dx, &dy,
+	                                    &tile->data, NULL, NULL, &error);
+	if (status == MB_SUCCESS && (n_columns != tile->n_columns || n_rows != tile->n_rows)) {
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&(tile->data), &error);
+		status = MB_FAILURE;
+	}
+	if (status == MB_SUCCESS) {
+		for (int k = 0; k < nxy; k++)
+			if (tile->data[k] == nodatavalue)
+				tile->data[k] = topogrid->nodatavalue;
+	}
+	else {
+		fprintf(stderr, "\nUnable to read tile %d %d of topography grid %s, treating it as empty\n", tile->ti, tile->tj,
+		        topogrid->file);
+		tile->data = NULL;
+		status = mb_mallocd(verbose, __FILE__, __LINE__, tile->n_columns * tile->n_rows * sizeof(float), (void **)&tile->data,
+		                    &error);
+		if (status != MB_SUCCESS)
+			return (status);
+		for (int k = 0; k < tile->n_columns * tile->n_rows; k++)
+			tile->data[k] = topogrid->nodatavalue;
+	}
+
+	/* build the tile pyramid, the top level spans the whole tile */
+	mb_topogrid_pyramid_build(verbose, tile->data, tile->n_columns, tile->n_rows, topogrid->nodatavalue,
+	                          &tile->pyramid_nlevels, tile->pyramid_n_columns, tile->pyramid_n_rows, tile->pyramid_min,
+	                          tile->pyramid_max, &error);
+	if (tile->pyramid_nlevels == 0) {
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&(tile->data), &error);
+		return (MB_FAILURE);
 	}
 
+	return (MB_SUCCESS);
+}
+/*--------------------------------------------------------------------*/
+/* Get tile (ti, tj) for a cursor, paging it in if needed. The tile stays
+ * in memory until the cursor is released or moved to another tile. */
+static const struct mb_topogrid_tile *mb_topogrid_tile_get(struct mb_topogrid_struct *topogrid,
+                          struct mb_topogrid_cursor *cursor, int ti, int tj) {
+	struct mb_topogrid_tiles *tiles = (struct mb_topogrid_tiles *)topogrid->tiles;
+	if (cursor->tile != NULL && cursor->tile->ti == ti && cursor->tile->tj == tj)
+		return (cursor->tile);
+
+	pthread_mutex_lock(&tiles->mutex);
+	if (cursor->tile != NULL)
+		cursor->tile->nusers--;
+	cursor->tile = NULL;
+
+	struct mb_topogrid_tile *tile = NULL;
+	const int index = ti * tiles->ntile_rows + tj;
+
+	/* wait for a tile being read by another call */
+	while (tiles->slot[index] >= 0 && tiles->cache[tiles->slot[index]]->loading)
+		pthread_cond_wait(&tiles->loaded, &tiles->mutex);
+
+	if (tiles->slot[index] >= 0) {
+		tile = tiles->cache[tiles->slot[index]];
+	}
+	else {
+		/* find a cache slot, dropping the least recently used tile not in
+		   use when the cache is full */
+		int error = MB_ERROR_NO_ERROR;
+		int islot = -1;
+		if (tiles->ncache < tiles->cache_max) {
+			islot = tiles->ncache;
+		}
+		else {
+			for (int n = 0; n < tiles->ncache; n++) {
+				if (tiles->cache[n]->nusers == 0 && (islot < 0 || tiles->cache[n]->last_use < tiles->cache[islot]->last_use))
+					islot = n;
+			}
+		}
+		if (islot < 0) {
+			/* every tile is in use, so grow the cache */
+			if (mb_reallocd(tiles->verbose, __FILE__, __LINE__, (tiles->cache_max + 1) * sizeof(struct mb_topogrid_tile *),
+			                (void **)&tiles->cache, &error) == MB_SUCCESS) {
+				tiles->cache_max++;
+				islot = tiles->ncache;
+			}
+		}
+
+		/* reserve the slot for the new tile */
+		if (islot >= 0 &&
+		    mb_mallocd(tiles->verbose, __FILE__, __LINE__, sizeof(struct mb_topogrid_tile), (void **)&tile, &error) == MB_SUCCESS) {
+			memset(tile, 0, sizeof(struct mb_topogrid_tile));
+			tile->ti = ti;
+			tile->tj = tj;
+			tile->loading = true;
+			tile->nusers = 1;
+			if (islot < tiles->ncache) {
+				struct mb_topogrid_tile *old = tiles->cache[islot];
+				tiles->slot[old->ti * tiles->ntile_rows + old->tj] = -1;
+				mb_topogrid_tile_free(tiles->verbose, &old, &error);
+			}
+			else {
+				tiles->ncache++;
+			}
+			tiles->cache[islot] = tile;
+			tiles->slot[index] = islot;
+
+			/* read the tile without the lock */
+			pthread_mutex_unlock(&tiles->mutex);
+			const int status = mb_topogrid_tile_load(topogrid, tile);
+			pthread_mutex_lock(&tiles->mutex);
+
+			tile->loading = false;
+			tile->nusers--;
+			if (status == MB_SUCCESS) {
+				tiles->nload++;
+			}
+			else {
+				/* give up the slot, moving the last cached tile into it */
+				islot = tiles->slot[index];
+				tiles->slot[index] = -1;
+				tiles->ncache--;
+				if (islot < tiles->ncache) {
+					struct mb_topogrid_tile *last = tiles->cache[tiles->ncache];
+					tiles->cache[islot] = last;
+					tiles->slot[last->ti * tiles->ntile_rows + last->tj] = islot;
+				}
+				mb_topogrid_tile_free(tiles->verbose, &tile, &error);
+			}
+			pthread_cond_broadcast(&tiles->loaded);
+		}
+	}
+	if (tile != NULL) {
+		tile->nusers++;
+		tile->last_use = ++tiles->clock;
+	}
+	cursor->tile = tile;
+	pthread_mutex_unlock(&tiles->mutex);
+
+	return (tile);
+}
+/*--------------------------------------------------------------------*/
+static void mb_topogrid_cursor_release(struct mb_topogrid_struct *topogrid, struct mb_topogrid_cursor *cursor) {
+	if (cursor->tile != NULL) {
+		struct mb_topogrid_tiles *tiles = (struct mb_topogrid_tiles *)topogrid->tiles;
+		pthread_mutex_lock(&tiles->mutex);
+		cursor->tile->nusers--;
+		pthread_mutex_unlock(&tiles->mutex);
+		cursor->tile = NULL;
+	}
+}
+/*--------------------------------------------------------------------*/
+/* Get the four nodes of grid cell (i, j), ordered (i, j), (i + 1, j),
+ * (i, j + 1), (i + 1, j + 1), returning false if they are not available */
+static bool mb_topogrid_cellnodes(struct mb_topogrid_struct *topogrid, struct mb_topogrid_cursor *cursor, int i, int j,
+                          double h[4]) {
+	const float *data = topogrid->data;
+	int n_rows = topogrid->n_rows;
+	if (topogrid->tiles != NULL) {
+		const int level = ((struct mb_topogrid_tiles *)topogrid->tiles)->level;
+		const struct mb_topogrid_tile *tile = mb_topogrid_tile_get(topogrid, cursor, i >> level, j >> level);
+		if (tile == NULL)
+			return (false);
+		data = tile->data;
+		n_rows = tile->n_rows;
+		i -= tile->ti << level;
+		j -= tile->tj << level;
+	}
+	const int k = i * n_rows + j;
+	h[0] = data[k];
+	h[1] = data[k + n_rows];
+	h[2] = data[k + 1];
+	h[3] = data[k + n_rows + 1];
+	return (true);
+}
+/*--------------------------------------------------------------------*/
+/* Get the elevation range of pyramid cell (i, j) at a level, returning
+ * min > max for cells with no valid nodes */
+static void mb_topogrid_cellrange(struct mb_topogrid_struct *topogrid, struct mb_topogrid_cursor *cursor, int level, int i,
+                          int j, float *zmin, float *zmax) {
+	if (topogrid->tiles == NULL) {
+		const int k = i * topogrid->pyramid_n_rows[level - 1] + j;
+		*zmin = topogrid->pyramid_min[level - 1][k];
+		*zmax = topogrid->pyramid_max[level - 1][k];
+		return;
+	}
+	const int shift = ((struct mb_topogrid_tiles *)topogrid->tiles)->level - level;
+	const struct mb_topogrid_tile *tile = mb_topogrid_tile_get(topogrid, cursor, i >> shift, j >> shift);
+	if (tile == NULL) {
+		*zmin = FLT_MAX;
+		*zmax = -FLT_MAX;
+		return;
+	}
+	const int klevel = MIN(level, tile->pyramid_nlevels) - 1;
+	const int k = (i - (tile->ti << shift)) * tile->pyramid_n_rows[klevel] + (j - (tile->tj << shift));
+	*zmin = tile->pyramid_min[klevel][k];
+	*zmax = tile->pyramid_max[klevel][k];
+}
+/*--------------------------------------------------------------------*/
+/* Get the average of the defined nodes of grid cell (i, j), returning the
+ * number of defined nodes */
+static int mb_topogrid_cellaverage(struct mb_topogrid_struct *topogrid, struct mb_topogrid_cursor *cursor, int i, int j,
+                          double *topo) {
+	int nfound = 0;
+	*topo = 0.0;
+	double h[4];
+	if (i >= 0 && i < topogrid->n_columns - 1 && j >= 0 && j < topogrid->n_rows - 1
+		&& mb_topogrid_cellnodes(topogrid, cursor, i, j, h)) {
+		for (int n = 0; n < 4; n++) {
+			if (h[n] != topogrid->nodatavalue) {
+				nfound++;
+				*topo += h[n];
+			}
+		}
+	}
+	if (nfound > 0)
+		*topo /= (double)nfound;
+	return (nfound);
+}
+/*--------------------------------------------------------------------*/
+/* Fit the topogrid bounds to the longitude convention lonflip, or set
+ * lonflip to suit the topogrid bounds */
+static void mb_topogrid_lonflip(struct mb_topogrid_struct *topogrid, int *lonflip) {
+	if (*lonflip == -1) {
+		if (topogrid->xmax > 180.0) {
+			topogrid->xmin -= 360.0;
+			topogrid->xmax -= 360.0;
+		}
+	}
+	else if (*lonflip == 0) {
+		if (topogrid->xmin > 180.0) {
+			topogrid->xmin -= 360.0;
+			topogrid->xmax -= 360.0;
+		}
+		else if (topogrid->xmax < -180.0) {
+			topogrid->xmin += 360.0;
+			topogrid->xmax += 360.0;
+		}
+	}
+	else if (*lonflip == 1) {
+		if (topogrid->xmin < -180.0) {
+			topogrid->xmin += 360.0;
+			topogrid->xmax += 360.0;
+		}
+	}
+	if (topogrid->xmax > 180.0) {
+		*lonflip = 1;
+	}
+	else if (topogrid->xmin < -180.0) {
+		*lonflip = -1;
+	}
+	else {
+		*lonflip = 0;
+	}
+}
+/*--------------------------------------------------------------------*/
+/* Set up a topogrid from the whole grid file, a window of it (bounds not
+ * NULL), or with tiles paged in on demand (tile_level > 0). With tile_level
+ * < 0 the grid is tiled if it is too large to hold in memory, using the
+ * same header read. */
+static int mb_topogrid_setup(int verbose, mb_path topogridfile, double *bounds, int decimation, int tile_level,
+                          int cache_tiles, int *lonflip, void **topogrid_ptr, int *error) {
 	/* allocate memory for topogrid structure */
 	int status = mb_mallocd(verbose, __FILE__, __LINE__, sizeof(struct mb_topogrid_struct), (void **)topogrid_ptr, error);
+	if (status != MB_SUCCESS)
+		return (status);
 
 	/* get pointer to topogrid structure */
 	struct mb_topogrid_struct *topogrid = (struct mb_topogrid_struct *)*topogrid_ptr;
@@ -62,57 +501,102 @@ int mb_topogrid_init(int verbose, mb_path topogridfile, int *lonflip, void **top
 	/* read in the data */
 	strcpy(topogrid->file, topogridfile);
 	topogrid->data = NULL;
-	status = mb_read_gmt_grd(verbose, topogrid->file, &topogrid->projection_mode, topogrid->projection_id, &topogrid->nodatavalue,
-	                         &topogrid->nxy, &topogrid->n_columns, &topogrid->n_rows, &topogrid->min, &topogrid->max, &topogrid->xmin,
-	                         &topogrid->xmax, &topogrid->ymin, &topogrid->ymax, &topogrid->dx, &topogrid->dy, &topogrid->data,
-	                         NULL, NULL, error);
+	topogrid->pyramid_nlevels = 0;
+	topogrid->tiles = NULL;
+	bool read_all = false;
+	if (tile_level != 0) {
+		status = mb_check_gmt_grd(verbose, topogrid->file, &topogrid->projection_mode, topogrid->projection_id,
+		                          &topogrid->nodatavalue, &topogrid->nxy, &topogrid->n_columns, &topogrid->n_rows,
+		                          &topogrid->min, &topogrid->max, &topogrid->xmin, &topogrid->xmax, &topogrid->ymin,
+		                          &topogrid->ymax, &topogrid->dx, &topogrid->dy, error);
+		if (status == MB_SUCCESS && tile_level < 0) {
+			if ((double)topogrid->n_columns * (double)topogrid->n_rows > MB_TOPOGRID_TILED_NXY_MIN) {
+				tile_level = MB_TOPOGRID_TILE_LEVEL_DEFAULT;
+				cache_tiles = MB_TOPOGRID_TILE_CACHE_DEFAULT;
+			}
+			else {
+				tile_level = 0;
+				read_all = true;
+			}
+		}
+	}
+	else if (bounds != NULL) {
+		status = mb_read_gmt_grd_window(verbose, topogrid->file, bounds, decimation, &topogrid->projection_mode,
+		                                topogrid->projection_id, &topogrid->nodatavalue, &topogrid->nxy, &topogrid->n_columns,
+		                                &topogrid->n_rows, &topogrid->min, &topogrid->max, &topogrid->xmin, &topogrid->xmax,
+		                                &topogrid->ymin, &topogrid->ymax, &topogrid->dx, &topogrid->dy, &topogrid->data, NULL,
+		                                NULL, error);
+	}
+	else {
+		read_all = true;
+	}
+	if (status == MB_SUCCESS && read_all) {
+		status = mb_read_gmt_grd(verbose, topogrid->file, &topogrid->projection_mode, topogrid->projection_id,
+		                         &topogrid->nodatavalue, &topogrid->nxy, &topogrid->n_columns, &topogrid->n_rows, &topogrid->min,
+		                         &topogrid->max, &topogrid->xmin, &topogrid->xmax, &topogrid->ymin, &topogrid->ymax,
+		                         &topogrid->dx, &topogrid->dy, &topogrid->data, NULL, NULL, error);
+	}
 
 	/* check for reasonable results */
-	if (topogrid->nxy <= 0 || topogrid->data == NULL) {
+	if (status == MB_SUCCESS && (topogrid->n_columns < 2 || topogrid->n_rows < 2 || (tile_level <= 0 && topogrid->data == NULL))) {
 		status = MB_FAILURE;
 		*error = MB_ERROR_OPEN_FAIL;
 	}
+	else if (status != MB_SUCCESS && *error == MB_ERROR_NO_ERROR) {
+		*error = MB_ERROR_OPEN_FAIL;
+	}
 
 	/* rationalize topogrid bounds and lonflip */
+	const double file_xmin = topogrid->xmin;
 	if (status == MB_SUCCESS) {
-		if (*lonflip == -1) {
-			if (topogrid->xmax > 180.0) {
-				topogrid->xmin -= 360.0;
-				topogrid->xmax -= 360.0;
-			}
-		}
-		else if (*lonflip == 0) {
-			if (topogrid->xmin > 180.0) {
-				topogrid->xmin -= 360.0;
-				topogrid->xmax -= 360.0;
-			}
-			else if (topogrid->xmax < -180.0) {
-				topogrid->xmin += 360.0;
-				topogrid->xmax += 360.0;
-			}
-		}
-		else if (*lonflip == 1) {
-			if (topogrid->xmin < -180.0) {
-				topogrid->xmin += 360.0;
-				topogrid->xmax += 360.0;
-			}
-		}
-		if (topogrid->xmax > 180.0) {
-			*lonflip = 1;
+		mb_topogrid_lonflip(topogrid, lonflip);
+	}
+
+	/* set up the tile cache */
+	if (status == MB_SUCCESS && tile_level > 0) {
+		struct mb_topogrid_tiles *tiles = NULL;
+		status = mb_mallocd(verbose, __FILE__, __LINE__, sizeof(struct mb_topogrid_tiles), (void **)&tiles, error);
+		if (status == MB_SUCCESS) {
+			memset(tiles, 0, sizeof(struct mb_topogrid_tiles));
+			tiles->verbose = verbose;
+			tiles->level = MIN(tile_level, MB_TOPOGRID_PYRAMID_LEVELS_MAX);
+			tiles->ntile_columns = ((topogrid->n_columns - 2) >> tiles->level) + 1;
+			tiles->ntile_rows = ((topogrid->n_rows - 2) >> tiles->level) + 1;
+			tiles->cache_max = MAX(cache_tiles, 1);
+			tiles->file_xmin = file_xmin;
+			tiles->file_ymin = topogrid->ymin;
+			pthread_mutex_init(&tiles->mutex, NULL);
+			pthread_cond_init(&tiles->loaded, NULL);
+			topogrid->tiles = tiles;
+			status = mb_mallocd(verbose, __FILE__, __LINE__, tiles->cache_max * sizeof(struct mb_topogrid_tile *),
+			                    (void **)&tiles->cache, error);
 		}
-		else if (topogrid->xmin < -180.0) {
-			*lonflip = -1;
+		if (status == MB_SUCCESS) {
+			status = mb_mallocd(verbose, __FILE__, __LINE__, (size_t)tiles->ntile_columns * tiles->ntile_rows * sizeof(int),
+			                    (void **)&tiles->slot, error);
 		}
-		else {
-			*lonflip = 0;
+		if (status == MB_SUCCESS) {
+			for (size_t n = 0; n < (size_t)tiles->ntile_columns * tiles->ntile_rows; n++)
+				tiles->slot[n] = -1;
 		}
 	}
 
-	if (verbose >= 2) {
-		fprintf(stderr, "\ndbg2  MB7K2SS function <%s> completed\n", __func__);
-		fprintf(stderr, "dbg2  Return values:\n");
-		fprintf(stderr, "dbg2       lonflip:                   %d\n", *lonflip);
-		fprintf(stderr, "dbg2       topogrid:                  %p\n", topogrid);
+	/* build the min/max pyramid used to cast vectors onto the grid */
+	else if (status == MB_SUCCESS) {
+		status = mb_topogrid_pyramid_build(verbose, topogrid->data, topogrid->n_columns, topogrid->n_rows,
+		                                   topogrid->nodatavalue, &topogrid->pyramid_nlevels, topogrid->pyramid_n_columns,
+		                                   topogrid->pyramid_n_rows, topogrid->pyramid_min, topogrid->pyramid_max, error);
+	}
+
+	return (status);
+}
+/*--------------------------------------------------------------------*/
+static void mb_topogrid_print(const struct mb_topogrid_struct *topogrid, int *lonflip, int *error, int status) {
+	fprintf(stderr, "\ndbg2  MBIO function <%s> completed\n", __func__);
+	fprintf(stderr, "dbg2  Return values:\n");
+	fprintf(stderr, "dbg2       lonflip:                   %d\n", *lonflip);
+	fprintf(stderr, "dbg2       topogrid:                  %p\n", topogrid);
+	if (topogrid != NULL) {
 		fprintf(stderr, "dbg2       topogrid->file:            %s\n", topogrid->file);
 		fprintf(stderr, "dbg2       topogrid->projection_mode: %d\n", topogrid->projection_mode);
 		fprintf(stderr, "dbg2       topogrid->projection_id:   %s\n", topogrid->projection_id);
@@ -129,9 +613,76 @@ int mb_topogrid_init(int verbose, mb_path topogridfile, int *lonflip, void **top
 		fprintf(stderr, "dbg2       topogrid->dx:              %f\n", topogrid->dx);
 		fprintf(stderr, "dbg2       topogrid->dy               %f\n", topogrid->dy);
 		fprintf(stderr, "dbg2       topogrid->data:            %p\n", topogrid->data);
-		fprintf(stderr, "dbg2       error:                     %d\n", *error);
-		fprintf(stderr, "dbg2  Return status:\n");
-		fprintf(stderr, "dbg2       status:                    %d\n", status);
+		fprintf(stderr, "dbg2       topogrid->tiles:           %p\n", topogrid->tiles);
+	}
+	fprintf(stderr, "dbg2       error:                     %d\n", *error);
+	fprintf(stderr, "dbg2  Return status:\n");
+	fprintf(stderr, "dbg2       status:                    %d\n", status);
+}
+/*--------------------------------------------------------------------*/
+int mb_topogrid_init(int verbose, mb_path topogridfile, int *lonflip, void **topogrid_ptr, int *error) {
+	if (verbose >= 2) {
+		fprintf(stderr, "\ndbg2  MBIO function <%s> called\n", __func__);
+		fprintf(stderr, "dbg2  Input arguments:\n");
+		fprintf(stderr, "dbg2       verbose:                   %d\n", verbose);
+		fprintf(stderr, "dbg2       topogridfile:              %s\n", topogridfile);
+		fprintf(stderr, "dbg2       lonflip:                   %d\n", *lonflip);
+		fprintf(stderr, "dbg2       topogrid:                  %p\n", *topogrid_ptr);
+	}
+
+	/* grids too large to hold in memory are paged in as tiles */
+	const int status = mb_topogrid_setup(verbose, topogridfile, NULL, 1, -1, 0, lonflip, topogrid_ptr, error);
+
+	if (verbose >= 2) {
+		mb_topogrid_print((struct mb_topogrid_struct *)*topogrid_ptr, lonflip, error, status);
+	}
+
+	return (status);
+}
+/*--------------------------------------------------------------------*/
+int mb_topogrid_init_window(int verbose, mb_path topogridfile, double bounds[4], int decimation, int *lonflip,
+                          void **topogrid_ptr, int *error) {
+	if (verbose >= 2) {
+		fprintf(stderr, "\ndbg2  MBIO function <%s> called\n", __func__);
+		fprintf(stderr, "dbg2  Input arguments:\n");
+		fprintf(stderr, "dbg2       verbose:                   %d\n", verbose);
+		fprintf(stderr, "dbg2       topogridfile:              %s\n", topogridfile);
+		fprintf(stderr, "dbg2       bounds:                    %f %f %f %f\n", bounds[0], bounds[1], bounds[2], bounds[3]);
+		fprintf(stderr, "dbg2       decimation:                %d\n", decimation);
+		fprintf(stderr, "dbg2       lonflip:                   %d\n", *lonflip);
+		fprintf(stderr, "dbg2       topogrid:                  %p\n", *topogrid_ptr);
+	}
+
+	const int status = mb_topogrid_setup(verbose, topogridfile, bounds, decimation, 0, 0, lonflip, topogrid_ptr, error);
+
+	if (verbose >= 2) {
+		mb_topogrid_print((struct mb_topogrid_struct *)*topogrid_ptr, lonflip, error, status);
+	}
+
+	return (status);
+}
+/*--------------------------------------------------------------------*/
+int mb_topogrid_init_tiled(int verbose, mb_path topogridfile, int tile_level, int cache_tiles, int *lonflip,
+                          void **topogrid_ptr, int *error) {
+	if (verbose >= 2) {
+		fprintf(stderr, "\ndbg2  MBIO function <%s> called\n", __func__);
+		fprintf(stderr, "dbg2  Input arguments:\n");
+		fprintf(stderr, "dbg2       verbose:                   %d\n", verbose);
+		fprintf(stderr, "dbg2       topogridfile:              %s\n", topogridfile);
+		fprintf(stderr, "dbg2       tile_level:                %d\n", tile_level);
+		fprintf(stderr, "dbg2       cache_tiles:               %d\n", cache_tiles);
+		fprintf(stderr, "dbg2       lonflip:                   %d\n", *lonflip);
+		fprintf(stderr, "dbg2       topogrid:                  %p\n", *topogrid_ptr);
+	}
+
+	if (tile_level <= 0)
+		tile_level = MB_TOPOGRID_TILE_LEVEL_DEFAULT;
+	if (cache_tiles <= 0)
+		cache_tiles = MB_TOPOGRID_TILE_CACHE_DEFAULT;
+	const int status = mb_topogrid_setup(verbose, topogridfile, NULL, 1, tile_level, cache_tiles, lonflip, topogrid_ptr, error);
+
+	if (verbose >= 2) {
+		mb_topogrid_print((struct mb_topogrid_struct *)*topogrid_ptr, lonflip, error, status);
 	}
 
 	return (status);
@@ -149,6 +700,19 @@ int mb_topogrid_deall(int verbose, void **topogrid_ptr, int *error) {
 	/* deallocate the topogrid structure */
 	struct mb_topogrid_struct *topogrid = (struct mb_topogrid_struct *)*topogrid_ptr;
 	int status = MB_SUCCESS;
+	mb_topogrid_pyramid_free(verbose, &topogrid->pyramid_nlevels, topogrid->pyramid_min, topogrid->pyramid_max, error);
+	if (topogrid->tiles != NULL) {
+		struct mb_topogrid_tiles *tiles = (struct mb_topogrid_tiles *)topogrid->tiles;
+		if (verbose > 0)
+			fprintf(stderr, "Topography grid %s: %d tiles of %d cells read\n", topogrid->file, tiles->nload, 1 << tiles->level);
+		for (int n = 0; n < tiles->ncache; n++)
+			mb_topogrid_tile_free(verbose, &tiles->cache[n], error);
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&(tiles->cache), error);
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&(tiles->slot), error);
+		pthread_mutex_destroy(&tiles->mutex);
+		pthread_cond_destroy(&tiles->loaded);
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&(topogrid->tiles), error);
+	}
 	if (topogrid->data != NULL)
 		status = mb_freed(verbose, __FILE__, __LINE__, (void **)&(topogrid->data), error);
 	status &= mb_freed(verbose, __FILE__, __LINE__, (void **)topogrid_ptr, error);
@@ -192,26 +756,14 @@ int mb_topogrid_topo(int verbose, void *topogrid_ptr, double navlon, double navl
 	}
 
 	/* get topography at specified location */
-	int nfound = 0;
-	*topo = 0.0;
+	struct mb_topogrid_cursor cursor = {NULL};
 	const int i = (int)((navlon - topogrid->xmin) / topogrid->dx);
 	const int j = (int)((navlat - topogrid->ymin) / topogrid->dy);
-	if (i >= 0 && i < topogrid->n_columns - 1 && j >= 0 && j < topogrid->n_rows - 1) {
-		for (int ii = i; ii <= i + 1; ii++)
-			for (int jj = j; jj <= j + 1; jj++) {
-				const int k = ii * topogrid->n_rows + jj;
-				if (topogrid->data[k] != topogrid->nodatavalue) {
-					nfound++;
-					*topo += topogrid->data[k];
-				}
-			}
-	}
+	const int nfound = mb_topogrid_cellaverage(topogrid, &cursor, i, j, topo);
+	mb_topogrid_cursor_release(topogrid, &cursor);
 
 	int status = MB_SUCCESS;
-	if (nfound > 0) {
-		*topo /= (double)nfound;
-	}
-	else {
+	if (nfound <= 0) {
 		status = MB_FAILURE;
 		*error = MB_ERROR_NOT_ENOUGH_DATA;
 	}
@@ -278,42 +830,11 @@ int mb_topogrid_bounds(int verbose, void *topogrid_ptr, double bounds[4], int *e
 	return (status);
 }
 /*--------------------------------------------------------------------*/
-int mb_topogrid_intersect(int verbose, void *topogrid_ptr, double navlon, double navlat, double altitude, double sensordepth,
-                          double mtodeglon, double mtodeglat, double vx, double vy, double vz, double *lon, double *lat,
-                          double *topo, double *range, int *error) {
-	struct mb_topogrid_struct *topogrid = (struct mb_topogrid_struct *)topogrid_ptr;
-
-	if (verbose >= 2) {
-		fprintf(stderr, "\ndbg2  MBIO function <%s> called\n", __func__);
-		fprintf(stderr, "dbg2  Input arguments:\n");
-		fprintf(stderr, "dbg2       verbose:                   %d\n", verbose);
-		fprintf(stderr, "dbg2       navlon:                    %f\n", navlon);
-		fprintf(stderr, "dbg2       navlat:                    %f\n", navlat);
-		fprintf(stderr, "dbg2       altitude:                  %f\n", altitude);
-		fprintf(stderr, "dbg2       sensordepth:               %f\n", sensordepth);
-		fprintf(stderr, "dbg2       mtodeglon:                 %f\n", mtodeglon);
-		fprintf(stderr, "dbg2       mtodeglat:                 %f\n", mtodeglat);
-		fprintf(stderr, "dbg2       vx:                        %f\n", vx);
-		fprintf(stderr, "dbg2       vy:                        %f\n", vy);
-		fprintf(stderr, "dbg2       vz:                        %f\n", vz);
-		fprintf(stderr, "dbg2       topogrid:                  %p\n", topogrid);
-		fprintf(stderr, "dbg2       topogrid->projection_mode: %d\n", topogrid->projection_mode);
-		fprintf(stderr, "dbg2       topogrid->projection_id:   %s\n", topogrid->projection_id);
-		fprintf(stderr, "dbg2       topogrid->nodatavalue:     %f\n", topogrid->nodatavalue);
-		fprintf(stderr, "dbg2       topogrid->nxy:             %d\n", topogrid->nxy);
-		fprintf(stderr, "dbg2       topogrid->n_columns:       %d\n", topogrid->n_columns);
-		fprintf(stderr, "dbg2       topogrid->n_rows:          %d\n", topogrid->n_rows);
-		fprintf(stderr, "dbg2       topogrid->min:             %f\n", topogrid->min);
-		fprintf(stderr, "dbg2       topogrid->max:             %f\n", topogrid->max);
-		fprintf(stderr, "dbg2       topogrid->xmin:            %f\n", topogrid->xmin);
-		fprintf(stderr, "dbg2       topogrid->xmax:            %f\n", topogrid->xmax);
-		fprintf(stderr, "dbg2       topogrid->ymin:            %f\n", topogrid->ymin);
-		fprintf(stderr, "dbg2       topogrid->ymax:            %f\n", topogrid->ymax);
-		fprintf(stderr, "dbg2       topogrid->dx:              %f\n", topogrid->dx);
-		fprintf(stderr, "dbg2       topogrid->dy               %f\n", topogrid->dy);
-		fprintf(stderr, "dbg2       topogrid->data:            %p\n", topogrid->data);
-	}
-
+/* Find the intersection by marching range steps along the vector, starting
+ * from the altitude (or the topography below the sensor) as first guess */
+static int mb_topogrid_intersect_march(struct mb_topogrid_struct *topogrid, struct mb_topogrid_cursor *cursor, double navlon, double navlat, double altitude,
+                          double sensordepth, double mtodeglon, double mtodeglat, double vx, double vy, double vz,
+                          double *lon, double *lat, double *topo, double *range, int *error) {
 	int status = MB_SUCCESS;
 
 	bool done = false;
@@ -328,22 +849,10 @@ int mb_topogrid_intersect(int verbose, void *topogrid_ptr, double navlon, double
 		rmax = 4 * altitude / vz;
 	} else {
 		// if altitude not specified use altitude at location
-		int nfound = 0;
 		double topog = 0.0;
 		const int i = (int)((navlon - topogrid->xmin) / topogrid->dx);
 		const int j = (int)((navlat - topogrid->ymin) / topogrid->dy);
-		if (i >= 0 && i < topogrid->n_columns - 1 && j >= 0 && j < topogrid->n_rows - 1) {
-			for (int ii = i; ii <= i + 1; ii++)
-				for (int jj = j; jj <= j + 1; jj++) {
-					const int k = ii * topogrid->n_rows + jj;
-					if (topogrid->data[k] != topogrid->nodatavalue) {
-						nfound++;
-						topog += topogrid->data[k];
-					}
-				}
-		}
-		if (nfound > 0) {
-			topog /= (double)nfound;
+		if (mb_topogrid_cellaverage(topogrid, cursor, i, j, &topog) > 0) {
 			altitude = -sensordepth - topog;
 			dr = altitude / 20;
 			r = altitude / vz - dr;
@@ -377,22 +886,12 @@ int mb_topogrid_intersect(int verbose, void *topogrid_ptr, double navlon, double
 		const int i = (int)((lontest - topogrid->xmin) / topogrid->dx);
 		const int j = (int)((lattest - topogrid->ymin) / topogrid->dy);
 		if (i >= 0 && i < topogrid->n_columns - 1 && j >= 0 && j < topogrid->n_rows - 1) {
-			for (int ii = i; ii <= i + 1; ii++)
-				for (int jj = j; jj <= j + 1; jj++) {
-					const int k = ii * topogrid->n_rows + jj;
-					if (topogrid->data[k] != topogrid->nodatavalue) {
-						nfound++;
-						topog += topogrid->data[k];
-					}
-				}
+			nfound = mb_topogrid_cellaverage(topogrid, cursor, i, j, &topog);
 		} else {
 			done = true;
 			status = MB_FAILURE;
 			*error = MB_ERROR_NOT_ENOUGH_DATA;
 		}
-		if (nfound > 0) {
-			topog /= (double)nfound;
-		}
 
 		/* compare topographies at projected position */
 		if (nfound > 0) {
@@ -431,6 +930,272 @@ int mb_topogrid_intersect(int verbose, void *topogrid_ptr, double navlon, double
 	*topo = -sensordepth - vz * r;
 	*range = r;
 
+	return (status);
+}
+/*--------------------------------------------------------------------*/
+/* Solve for the crossing of the line z = za + dz * t, (u, v) = (u0 + du * t,
+ * v0 + dv * t) with the surface over a grid cell with nodes h for t in
+ * [0, tlen]. Cells with all four nodes defined are bilinear, cells with some
+ * nodes undefined take the average of the defined nodes. */
+static bool mb_topogrid_cellcast(const double h[4], float nodatavalue, double za, double dz,
+                          double u0, double v0, double du, double dv, double tlen, double *t) {
+	int nfound = 0;
+	double hsum = 0.0;
+	double hmax = -DBL_MAX;
+	for (int n = 0; n < 4; n++) {
+		if (h[n] != nodatavalue) {
+			nfound++;
+			hsum += h[n];
+			hmax = MAX(hmax, h[n]);
+		}
+	}
+	if (nfound == 0 || MIN(za, za + dz * tlen) > hmax)
+		return (false);
+
+	/* surface h(u,v) = a + b * u + c * v + d * u * v */
+	double a, b, c, d;
+	if (nfound == 4) {
+		a = h[0];
+		b = h[1] - h[0];
+		c = h[2] - h[0];
+		d = h[0] - h[1] - h[2] + h[3];
+	}
+	else {
+		a = hsum / nfound;
+		b = c = d = 0.0;
+	}
+
+	/* f(t) = z(t) - h(t) = A * t * t + B * t + C, find the first root */
+	const double C = za - (a + b * u0 + c * v0 + d * u0 * v0);
+	const double B = dz - (b * du + c * dv + d * (u0 * dv + v0 * du));
+	const double A = -d * du * dv;
+	if (C <= 0.0) {
+		*t = 0.0;
+		return (true);
+	}
+	double troot = -1.0;
+	if (fabs(A) * tlen <= 1.0e-12 * (fabs(B) + fabs(C) / MAX(tlen, DBL_MIN))) {
+		if (B < 0.0)
+			troot = -C / B;
+	}
+	else {
+		const double disc = B * B - 4.0 * A * C;
+		if (disc >= 0.0) {
+			const double q = -0.5 * (B + copysign(sqrt(disc), B));
+			const double t1 = q / A;
+			const double t2 = q != 0.0 ? C / q : t1;
+			if (t1 >= 0.0 && t2 >= 0.0)
+				troot = MIN(t1, t2);
+			else if (t1 >= 0.0)
+				troot = t1;
+			else if (t2 >= 0.0)
+				troot = t2;
+		}
+	}
+	if (troot >= 0.0 && troot <= tlen) {
+		*t = troot;
+		return (true);
+	}
+
+	/* catch a crossing lost to roundoff at the end of the segment */
+	if ((A * tlen + B) * tlen + C <= 0.0) {
+		*t = tlen;
+		return (true);
+	}
+	return (false);
+}
+/*--------------------------------------------------------------------*/
+/* Cast the vector gx = gx0 + dgx * r, gy = gy0 + dgy * r, z = z0 + dz * r
+ * (gx, gy in fractional grid cells) through the min/max pyramid and return
+ * the range of the first intersection with the grid surface. Pyramid
+ * cells are visited in order along the vector (a DDA walk at each level),
+ * descending a level where the vector could meet the cell contents and
+ * climbing again after leaving a cell. */
+static bool mb_topogrid_raycast(struct mb_topogrid_struct *topogrid, struct mb_topogrid_cursor *cursor, double gx0,
+                          double gy0, double z0, double dgx, double dgy, double dz, double *range) {
+	const int n_columns = topogrid->n_columns - 1;
+	const int n_rows = topogrid->n_rows - 1;
+	int top;
+	double zmin, zmax;
+	if (topogrid->tiles != NULL) {
+		/* tiles are the top level, the grid range comes from the header */
+		top = ((struct mb_topogrid_tiles *)topogrid->tiles)->level;
+		zmin = topogrid->min;
+		zmax = topogrid->max;
+	}
+	else {
+		top = topogrid->pyramid_nlevels;
+		if (top <= 0)
+			return (false);
+		zmin = topogrid->pyramid_min[top - 1][0];
+		zmax = topogrid->pyramid_max[top - 1][0];
+	}
+	if (!(zmin <= zmax))
+		return (false);
+
+	/* clip the vector to the grid bounds and the elevation range */
+	double rin = 0.0;
+	double rout = DBL_MAX;
+	const double gbound[2] = {n_columns, n_rows};
+	const double g0[2] = {gx0, gy0};
+	const double dg[2] = {dgx, dgy};
+	for (int n = 0; n < 2; n++) {
+		if (dg[n] == 0.0) {
+			if (g0[n] < 0.0 || g0[n] > gbound[n])
+				return (false);
+		}
+		else {
+			const double r1 = (0.0 - g0[n]) / dg[n];
+			const double r2 = (gbound[n] - g0[n]) / dg[n];
+			rin = MAX(rin, MIN(r1, r2));
+			rout = MIN(rout, MAX(r1, r2));
+		}
+	}
+	if (dz < 0.0) {
+		rin = MAX(rin, (zmax - z0) / dz);
+		rout = MIN(rout, (zmin - z0) / dz);
+	}
+	else if (dz > 0.0) {
+		rout = MIN(rout, (zmax - z0) / dz);
+	}
+	if (rin > rout || rout >= DBL_MAX)
+		return (false);
+
+	/* nudge cell lookups toward the direction of travel so that points on
+	   a cell boundary fall in the cell being entered */
+	const double eps = 1.0e-9;
+	const double ex = dgx > 0.0 ? eps : (dgx < 0.0 ? -eps : 0.0);
+	const double ey = dgy > 0.0 ? eps : (dgy < 0.0 ? -eps : 0.0);
+
+	const double rdgx = dgx != 0.0 ? 1.0 / dgx : 0.0;
+	const double rdgy = dgy != 0.0 ? 1.0 / dgy : 0.0;
+	double r = rin;
+	int level = top;
+	const int nstep_max = 4 * (n_columns + n_rows + 2) * (top + 1);
+	for (int nstep = 0; nstep < nstep_max; nstep++) {
+		const int isize = 1 << level;
+		const double size = (double)isize;
+		const int nc = ((n_columns - 1) >> level) + 1;
+		const int nr = ((n_rows - 1) >> level) + 1;
+		const double gx = gx0 + dgx * r;
+		const double gy = gy0 + dgy * r;
+		const int i = MAX(0, MIN(nc - 1, (int)floor(gx + ex) / isize));
+		const int j = MAX(0, MIN(nr - 1, (int)floor(gy + ey) / isize));
+
+		/* range where the vector leaves this cell, and whether it also
+		   leaves the parent cell there */
+		double rexit = rout;
+		bool climb = false;
+		if (dgx != 0.0) {
+			const int bx = dgx > 0.0 ? i + 1 : i;
+			rexit = MIN(rexit, (bx * size - gx0) * rdgx);
+			climb = (bx % 2) == 0;
+		}
+		if (dgy != 0.0) {
+			const int by = dgy > 0.0 ? j + 1 : j;
+			const double rexity = (by * size - gy0) * rdgy;
+			if (rexity < rexit) {
+				rexit = rexity;
+				climb = (by % 2) == 0;
+			}
+			else if (rexity == rexit) {
+				climb = climb || (by % 2) == 0;
+			}
+		}
+		rexit = MAX(rexit, r);
+
+		bool advance = false;
+		if (level > 0) {
+			/* descend if the vector can meet the topography in this cell */
+			float cmin, cmax;
+			mb_topogrid_cellrange(topogrid, cursor, level, i, j, &cmin, &cmax);
+			if (MIN(z0 + dz * r, z0 + dz * rexit) <= cmax && cmin <= cmax) {
+				level--;
+			}
+			else {
+				advance = true;
+			}
+		}
+		else {
+			double h[4];
+			double t;
+			if (mb_topogrid_cellnodes(topogrid, cursor, i, j, h)
+				&& mb_topogrid_cellcast(h, topogrid->nodatavalue, z0 + dz * r, dz, gx - i, gy - j, dgx, dgy, rexit - r, &t)) {
+				*range = r + t;
+				return (true);
+			}
+			advance = true;
+		}
+
+		if (advance) {
+			if (rexit >= rout)
+				return (false);
+			r = rexit;
+			if (climb && level < top)
+				level++;
+		}
+	}
+
+	return (false);
+}
+/*--------------------------------------------------------------------*/
+int mb_topogrid_intersect(int verbose, void *topogrid_ptr, double navlon, double navlat, double altitude, double sensordepth,
+                          double mtodeglon, double mtodeglat, double vx, double vy, double vz, double *lon, double *lat,
+                          double *topo, double *range, int *error) {
+	struct mb_topogrid_struct *topogrid = (struct mb_topogrid_struct *)topogrid_ptr;
+
+	if (verbose >= 2) {
+		fprintf(stderr, "\ndbg2  MBIO function <%s> called\n", __func__);
+		fprintf(stderr, "dbg2  Input arguments:\n");
+		fprintf(stderr, "dbg2       verbose:                   %d\n", verbose);
+		fprintf(stderr, "dbg2       navlon:                    %f\n", navlon);
+		fprintf(stderr, "dbg2       navlat:                    %f\n", navlat);
+		fprintf(stderr, "dbg2       altitude:                  %f\n", altitude);
+		fprintf(stderr, "dbg2       sensordepth:               %f\n", sensordepth);
+		fprintf(stderr, "dbg2       mtodeglon:                 %f\n", mtodeglon);
+		fprintf(stderr, "dbg2       mtodeglat:                 %f\n", mtodeglat);
+		fprintf(stderr, "dbg2       vx:                        %f\n", vx);
+		fprintf(stderr, "dbg2       vy:                        %f\n", vy);
+		fprintf(stderr, "dbg2       vz:                        %f\n", vz);
+		fprintf(stderr, "dbg2       topogrid:                  %p\n", topogrid);
+		fprintf(stderr, "dbg2       topogrid->projection_mode: %d\n", topogrid->projection_mode);
+		fprintf(stderr, "dbg2       topogrid->projection_id:   %s\n", topogrid->projection_id);
+		fprintf(stderr, "dbg2       topogrid->nodatavalue:     %f\n", topogrid->nodatavalue);
+		fprintf(stderr, "dbg2       topogrid->nxy:             %d\n", topogrid->nxy);
+		fprintf(stderr, "dbg2       topogrid->n_columns:       %d\n", topogrid->n_columns);
+		fprintf(stderr, "dbg2       topogrid->n_rows:          %d\n", topogrid->n_rows);
+		fprintf(stderr, "dbg2       topogrid->min:             %f\n", topogrid->min);
+		fprintf(stderr, "dbg2       topogrid->max:             %f\n", topogrid->max);
+		fprintf(stderr, "dbg2       topogrid->xmin:            %f\n", topogrid->xmin);
+		fprintf(stderr, "dbg2       topogrid->xmax:            %f\n", topogrid->xmax);
+		fprintf(stderr, "dbg2       topogrid->ymin:            %f\n", topogrid->ymin);
+		fprintf(stderr, "dbg2       topogrid->ymax:            %f\n", topogrid->ymax);
+		fprintf(stderr, "dbg2       topogrid->dx:              %f\n", topogrid->dx);
+		fprintf(stderr, "dbg2       topogrid->dy               %f\n", topogrid->dy);
+		fprintf(stderr, "dbg2       topogrid->data:            %p\n", topogrid->data);
+	}
+
+	int status = MB_SUCCESS;
+
+	/* cast the vector through the grid pyramid, in grid cell coordinates */
+	struct mb_topogrid_cursor cursor = {NULL};
+	double r = 0.0;
+	if (mb_topogrid_raycast(topogrid, &cursor, (navlon - topogrid->xmin) / topogrid->dx, (navlat - topogrid->ymin) / topogrid->dy,
+	                        -sensordepth, mtodeglon * vx / topogrid->dx, mtodeglat * vy / topogrid->dy, -vz, &r)
+		&& r > 0.0) {
+		*lon = navlon + mtodeglon * vx * r;
+		*lat = navlat + mtodeglat * vy * r;
+		*topo = -sensordepth - vz * r;
+		*range = r;
+	}
+
+	/* otherwise search along the vector */
+	else {
+		status = mb_topogrid_intersect_march(topogrid, &cursor, navlon, navlat, altitude, sensordepth, mtodeglon, mtodeglat,
+		                                     vx, vy, vz, lon, lat, topo, range, error);
+	}
+	mb_topogrid_cursor_release(topogrid, &cursor);
+
 	if (verbose >= 2) {
 		fprintf(stderr, "\ndbg2  MB7K2SS function <%s> completed\n", __func__);
 		fprintf(stderr, "dbg2  Return values:\n");
@@ -446,6 +1211,73 @@ int mb_topogrid_intersect(int verbose, void *topogrid_ptr, double navlon, double
 	return (status);
 }
 /*--------------------------------------------------------------------*/
+int mb_topogrid_intersect_batch(int verbose, void *topogrid_ptr, double navlon, double navlat, double altitude,
+                          double sensordepth, double mtodeglon, double mtodeglat, int nrays, double *vx, double *vy,
+                          double *vz, double *lon, double *lat, double *topo, double *range, int *ray_status, int *error) {
+	struct mb_topogrid_struct *topogrid = (struct mb_topogrid_struct *)topogrid_ptr;
+
+	if (verbose >= 2) {
+		fprintf(stderr, "\ndbg2  MBIO function <%s> called\n", __func__);
+		fprintf(stderr, "dbg2  Input arguments:\n");
+		fprintf(stderr, "dbg2       verbose:                   %d\n", verbose);
+		fprintf(stderr, "dbg2       navlon:                    %f\n", navlon);
+		fprintf(stderr, "dbg2       navlat:                    %f\n", navlat);
+		fprintf(stderr, "dbg2       altitude:                  %f\n", altitude);
+		fprintf(stderr, "dbg2       sensordepth:               %f\n", sensordepth);
+		fprintf(stderr, "dbg2       mtodeglon:                 %f\n", mtodeglon);
+		fprintf(stderr, "dbg2       mtodeglat:                 %f\n", mtodeglat);
+		fprintf(stderr, "dbg2       nrays:                     %d\n", nrays);
+		for (int i = 0; i < nrays; i++)
+			fprintf(stderr, "dbg2         %d %f %f %f\n", i, vx[i], vy[i], vz[i]);
+		fprintf(stderr, "dbg2       topogrid:                  %p\n", topogrid);
+		fprintf(stderr, "dbg2       topogrid->pyramid_nlevels: %d\n", topogrid->pyramid_nlevels);
+	}
+
+	/* the vectors share an origin, so its grid position is computed once */
+	const double gx0 = (navlon - topogrid->xmin) / topogrid->dx;
+	const double gy0 = (navlat - topogrid->ymin) / topogrid->dy;
+	const double sx = mtodeglon / topogrid->dx;
+	const double sy = mtodeglat / topogrid->dy;
+	struct mb_topogrid_cursor cursor = {NULL};
+	int nfound = 0;
+	for (int i = 0; i < nrays; i++) {
+		double r = 0.0;
+		if (mb_topogrid_raycast(topogrid, &cursor, gx0, gy0, -sensordepth, sx * vx[i], sy * vy[i], -vz[i], &r) && r > 0.0) {
+			lon[i] = navlon + mtodeglon * vx[i] * r;
+			lat[i] = navlat + mtodeglat * vy[i] * r;
+			topo[i] = -sensordepth - vz[i] * r;
+			range[i] = r;
+			ray_status[i] = MB_SUCCESS;
+		}
+		else {
+			int ray_error = MB_ERROR_NO_ERROR;
+			ray_status[i] = mb_topogrid_intersect_march(topogrid, &cursor, navlon, navlat, altitude, sensordepth, mtodeglon, mtodeglat,
+			                                            vx[i], vy[i], vz[i], &lon[i], &lat[i], &topo[i], &range[i], &ray_error);
+		}
+		if (ray_status[i] == MB_SUCCESS)
+			nfound++;
+	}
+	mb_topogrid_cursor_release(topogrid, &cursor);
+
+	int status = MB_SUCCESS;
+	if (nfound < nrays) {
+		status = MB_FAILURE;
+		*error = MB_ERROR_NOT_ENOUGH_DATA;
+	}
+
+	if (verbose >= 2) {
+		fprintf(stderr, "\ndbg2  MBIO function <%s> completed\n", __func__);
+		fprintf(stderr, "dbg2  Return values:\n");
+		for (int i = 0; i < nrays; i++)
+			fprintf(stderr, "dbg2         %d %d %f %f %f %f\n", i, ray_status[i], lon[i], lat[i], topo[i], range[i]);
+		fprintf(stderr, "dbg2       error:           %d\n", *error);
+		fprintf(stderr, "dbg2  Return status:\n");
+		fprintf(stderr, "dbg2       status:          %d\n", status);
+	}
+
+	return (status);
+}
+/*--------------------------------------------------------------------*/
 int mb_topogrid_getangletable(int verbose, void *topogrid_ptr, int nangle, double angle_min, double angle_max, double navlon,
                               double navlat, double heading, double altitude, double sensordepth, double pitch,
                               double *table_angle, double *table_xtrack, double *table_ltrack, double *table_altitude,
@@ -485,7 +1317,28 @@ int mb_topogrid_getangletable(int verbose, void *topogrid_ptr, int nangle, doubl
 
 	int status = MB_SUCCESS;
 
-	/* loop over all of the angles */
+	/* work arrays for the vectors and their intersections */
+	double *work = NULL;
+	int *ray_status = NULL;
+	status = mb_mallocd(verbose, __FILE__, __LINE__, 9 * nangle * sizeof(double), (void **)&work, error);
+	if (status == MB_SUCCESS)
+		status = mb_mallocd(verbose, __FILE__, __LINE__, nangle * sizeof(int), (void **)&ray_status, error);
+	if (status != MB_SUCCESS) {
+		if (work != NULL)
+			mb_freed(verbose, __FILE__, __LINE__, (void **)&work, error);
+		return (status);
+	}
+	double *vx = &work[0];
+	double *vy = &work[nangle];
+	double *vz = &work[2 * nangle];
+	double *lon = &work[3 * nangle];
+	double *lat = &work[4 * nangle];
+	double *topo = &work[5 * nangle];
+	double *rr = &work[6 * nangle];
+	double *takeoff_theta = &work[7 * nangle];
+	double *takeoff_phi = &work[8 * nangle];
+
+	/* get the vectors for all of the angles */
 	double mtodeglon;
 	double mtodeglat;
 	mb_coor_scale(verbose, navlat, &mtodeglon, &mtodeglat);
@@ -496,35 +1349,31 @@ int mb_topogrid_getangletable(int verbose, void *topogrid_ptr, int nangle, doubl
 		/* get angles in takeoff coordinates */
 		table_angle[i] = angle_min + dangle * i;
 		const double beta = 90.0 - table_angle[i];
-		double theta;
-		double phi;
-		mb_rollpitch_to_takeoff(verbose, alpha, beta, &theta, &phi, error);
+		mb_rollpitch_to_takeoff(verbose, alpha, beta, &takeoff_theta[i], &takeoff_phi[i], error);
 
 		/* calculate unit vector relative to the vehicle */
-		const double vz = cos(DTR * theta);
-		double vx = sin(DTR * theta) * cos(DTR * phi);
-		double vy = sin(DTR * theta) * sin(DTR * phi);
+		vz[i] = cos(DTR * takeoff_theta[i]);
+		vx[i] = sin(DTR * takeoff_theta[i]) * cos(DTR * takeoff_phi[i]);
+		vy[i] = sin(DTR * takeoff_theta[i]) * sin(DTR * takeoff_phi[i]);
 
 		/* rotate unit vector by vehicle heading */
-		vx = vx * cos(DTR * heading) + vy * sin(DTR * heading);
-		vy = -vx * sin(DTR * heading) + vy * cos(DTR * heading);
+		vx[i] = vx[i] * cos(DTR * heading) + vy[i] * sin(DTR * heading);
+		vy[i] = -vx[i] * sin(DTR * heading) + vy[i] * cos(DTR * heading);
+	}
 
-		double lon;
-		double lat;
-		double topo;
-		double rr;
-		/* find the range where this vector intersects the grid */
-		status = mb_topogrid_intersect(verbose, topogrid_ptr, navlon, navlat, altitude, sensordepth, mtodeglon, mtodeglat, vx, vy,
-		                               vz, &lon, &lat, &topo, &rr, error);
+	/* find the ranges where the vectors intersect the grid */
+	status = mb_topogrid_intersect_batch(verbose, topogrid_ptr, navlon, navlat, altitude, sensordepth, mtodeglon, mtodeglat,
+	                                     nangle, vx, vy, vz, lon, lat, topo, rr, ray_status, error);
 
+	for (int i = 0; i < nangle; i++) {
 		/* get the position from successful intersection with the grid */
-		if (status == MB_SUCCESS) {
-			const double zz = rr * cos(DTR * theta);
-			const double xx = rr * sin(DTR * theta);
-			table_xtrack[i] = xx * cos(DTR * phi);
-			table_ltrack[i] = xx * sin(DTR * phi);
+		if (ray_status[i] == MB_SUCCESS) {
+			const double zz = rr[i] * cos(DTR * takeoff_theta[i]);
+			const double xx = rr[i] * sin(DTR * takeoff_theta[i]);
+			table_xtrack[i] = xx * cos(DTR * takeoff_phi[i]);
+			table_ltrack[i] = xx * sin(DTR * takeoff_phi[i]);
 			table_altitude[i] = zz;
-			table_range[i] = rr;
+			table_range[i] = rr[i];
 			nset++;
 		}
 
@@ -533,6 +1382,8 @@ int mb_topogrid_getangletable(int verbose, void *topogrid_ptr, int nangle, doubl
 			table_range[i] = 0.0;
 		}
 	}
+	mb_freed(verbose, __FILE__, __LINE__, (void **)&ray_status, error);
+	mb_freed(verbose, __FILE__, __LINE__, (void **)&work, error);
 
 	/* now deal with any unset table entries */
 	if (nset < nangle) {
@@ -0,0 +1,770 @@
+/*--------------------------------------------------------------------
+ *    The MB-system:	mb_mgsurface.c	10/19/2026
+ *
+ *    Copyright (c) 2026 by the MB-System Team
+ *
+ *    MB-System was created by Caress and Chayes in 1992 at the
+ *      Lamont-Doherty Earth Observatory
+ *      Columbia University
+ *      Palisades, NY 10964
+ *
+ *    See README.md file for copying and redistribution conditions.
+ *--------------------------------------------------------------------*/
+/*
+ * Multigrid solver for the zgrid tensioned spline interpolation of
+ * scattered data onto a regular grid.
+ *
+ * The interpolated surface minimizes the same energy as mb_zgrid():
+ * the sum of squared first differences between neighboring nodes plus
+ * tension (cay) times the sum of squared second differences along the
+ * grid rows and columns, subject to the nodes holding data keeping the
+ * average of the data values nearest to them. A tension of zero gives
+ * a Laplace solution and large tensions approach a thin plate spline.
+ * As with mb_zgrid(), only nodes within clip grid cells (counted along
+ * rows and columns) of a data node are interpolated; the others are
+ * set to MB_MGSURFACE_NODATA. The grid is stored as z[i + j * n_columns].
+ *
+ * Unlike mb_zgrid() and mb_surface(), the solution is computed at full
+ * resolution for any grid size rather than on a decimated grid, and all
+ * state is held in per-call allocations so that several interpolations
+ * may run concurrently. The linear system is solved by conjugate
+ * gradients preconditioned with a multigrid V-cycle: the residual is
+ * restricted by full weighting to a hierarchy of coarser grids, the
+ * correction equation is rediscretized and relaxed there, and the
+ * corrections are interpolated back bilinearly. Coarse nodes near data
+ * are held fixed so that the coarse grids only correct the smooth error
+ * in the gaps between data; the conjugate gradient iteration keeps the
+ * convergence rate from degrading where this approximation is poor.
+ * Relaxation is red-black Gauss-Seidel for the Laplace case and the
+ * equivalent five color ordering when the second difference terms couple
+ * nodes two cells apart, run forwards before and backwards after the
+ * coarse grid correction so that the preconditioner is symmetric. Nodes
+ * of one color do not depend on each other, so each color is relaxed by
+ * a set of POSIX threads working on bands of rows. Dot products are
+ * accumulated by row and summed in row order so that the result does not
+ * depend on the number of threads.
+ *
+ * Author:	MB-System Team
+ * Date:	October 19, 2026
+ */
+
+#include <limits.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mb_aux.h"
+#include "mb_define.h"
+#include "mb_status.h"
+
+/* solver parameters */
+#define MB_MGSURFACE_LEVEL_MAX 32
+#define MB_MGSURFACE_COARSEST 8
+#define MB_MGSURFACE_SMOOTH 2
+#define MB_MGSURFACE_CONVERGENCE 0.0001
+#define MB_MGSURFACE_CYCLES 100
+
+/* node flags */
+#define MB_MGSURFACE_DOMAIN 0x01 /* node is interpolated */
+#define MB_MGSURFACE_FIXED 0x02  /* node holds data (or is held fixed on a coarse grid) */
+#define MB_MGSURFACE_EDGE_X 0x04 /* first difference to node i+1 */
+#define MB_MGSURFACE_EDGE_Y 0x08 /* first difference to node j+1 */
+#define MB_MGSURFACE_SEG_X 0x10  /* second difference along the row centered here */
+#define MB_MGSURFACE_SEG_Y 0x20  /* second difference along the column centered here */
+#define MB_MGSURFACE_FREE(flag) (((flag) & (MB_MGSURFACE_DOMAIN | MB_MGSURFACE_FIXED)) == MB_MGSURFACE_DOMAIN)
+
+/* one grid of the multigrid hierarchy */
+struct mb_mgsurface_level {
+	int n_columns;
+	int n_rows;
+	double c1; /* first difference weight scaled for the grid spacing */
+	double c2; /* second difference weight scaled for the grid spacing */
+	float *z;  /* correction */
+	float *b;  /* right hand side */
+	float *r;  /* residual of the correction equation */
+	unsigned char *flag;
+};
+
+/* barrier built from a mutex and condition variable since
+   pthread_barrier_t is not available on all platforms */
+struct mb_mgsurface_barrier {
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	int nthreads;
+	int count;
+	unsigned int cycle;
+};
+
+/* solver state shared by the threads */
+struct mb_mgsurface_context {
+	int nthreads;
+	int nlevels;
+	int ncolors;
+	int cycles_max;
+	double dzcriteria;
+
+	/* multigrid hierarchy - on the finest grid b is the conjugate gradient
+	   residual and z the preconditioned residual */
+	struct mb_mgsurface_level level[MB_MGSURFACE_LEVEL_MAX];
+
+	/* conjugate gradient solution, search direction and operator applied
+	   to the search direction (also used as the finest multigrid residual) */
+	float *x;
+	float *p;
+	float *q;
+	double *rowsum;
+
+	struct mb_mgsurface_barrier barrier;
+	pthread_mutex_t start;
+	double dzmax[MB_THREAD_MAX];
+	int ncycles;
+	double dzmax_final;
+};
+
+/* arguments passed to the solver threads */
+struct mb_mgsurface_work_struct {
+	struct mb_mgsurface_context *context;
+	int ithread;
+};
+
+/*--------------------------------------------------------------------*/
+static void mb_mgsurface_barrier_wait(struct mb_mgsurface_barrier *barrier) {
+	if (barrier->nthreads <= 1)
+		return;
+	pthread_mutex_lock(&barrier->mutex);
+	const unsigned int cycle = barrier->cycle;
+	barrier->count++;
+	if (barrier->count == barrier->nthreads) {
+		barrier->count = 0;
+		barrier->cycle++;
+		pthread_cond_broadcast(&barrier->cond);
+	}
+	else {
+		while (cycle == barrier->cycle)
+			pthread_cond_wait(&barrier->cond, &barrier->mutex);
+	}
+	pthread_mutex_unlock(&barrier->mutex);
+}
+/*--------------------------------------------------------------------*/
+/* Evaluate the operator at node (i, j) of a level applied to the array z,
+   returning the operator value and its diagonal coefficient. The
+   operator is the gradient of the zgrid energy with respect to z[k]. */
+static inline double mb_mgsurface_operator(const struct mb_mgsurface_level *level, const float *z, int i, int j,
+                                           double *diag) {
+	const int n_columns = level->n_columns;
+	const int n_rows = level->n_rows;
+	const int k = i + j * n_columns;
+	const unsigned char *flag = level->flag;
+	const double zk = z[k];
+	double edge = 0.0;
+	double seg = 0.0;
+	int nedge = 0;
+	int nseg = 0;
+
+	/* first and second differences along the row */
+	if (i > 0 && (flag[k - 1] & MB_MGSURFACE_EDGE_X)) {
+		edge += zk - z[k - 1];
+		nedge++;
+	}
+	if (flag[k] & MB_MGSURFACE_EDGE_X) {
+		edge += zk - z[k + 1];
+		nedge++;
+	}
+	if (i > 0 && (flag[k - 1] & MB_MGSURFACE_SEG_X)) {
+		seg += z[k - 2] - 2.0 * z[k - 1] + zk;
+		nseg += 1;
+	}
+	if (flag[k] & MB_MGSURFACE_SEG_X) {
+		seg -= 2.0 * (z[k - 1] - 2.0 * zk + z[k + 1]);
+		nseg += 4;
+	}
+	if (i < n_columns - 1 && (flag[k + 1] & MB_MGSURFACE_SEG_X)) {
+		seg += zk - 2.0 * z[k + 1] + z[k + 2];
+		nseg += 1;
+	}
+
+	/* first and second differences along the column */
+	if (j > 0 && (flag[k - n_columns] & MB_MGSURFACE_EDGE_Y)) {
+		edge += zk - z[k - n_columns];
+		nedge++;
+	}
+	if (flag[k] & MB_MGSURFACE_EDGE_Y) {
+		edge += zk - z[k + n_columns];
+		nedge++;
+	}
+	if (j > 0 && (flag[k - n_columns] & MB_MGSURFACE_SEG_Y)) {
+		seg += z[k - 2 * n_columns] - 2.0 * z[k - n_columns] + zk;
+		nseg += 1;
+	}
+	if (flag[k] & MB_MGSURFACE_SEG_Y) {
+		seg -= 2.0 * (z[k - n_columns] - 2.0 * zk + z[k + n_columns]);
+		nseg += 4;
+	}
+	if (j < n_rows - 1 && (flag[k + n_columns] & MB_MGSURFACE_SEG_Y)) {
+		seg += zk - 2.0 * z[k + n_columns] + z[k + 2 * n_columns];
+		nseg += 1;
+	}
+
+	*diag = level->c1 * nedge + level->c2 * nseg;
+	return (level->c1 * edge + level->c2 * seg);
+}
+/*--------------------------------------------------------------------*/
+/* Set the difference flags of the domain nodes of a level. */
+static void mb_mgsurface_setflags(struct mb_mgsurface_level *level) {
+	const int n_columns = level->n_columns;
+	const int n_rows = level->n_rows;
+	unsigned char *flag = level->flag;
+	for (int j = 0; j < n_rows; j++) {
+		for (int i = 0; i < n_columns; i++) {
+			const size_t k = i + (size_t)j * n_columns;
+			if (!(flag[k] & MB_MGSURFACE_DOMAIN))
+				continue;
+			const bool west = i > 0 && (flag[k - 1] & MB_MGSURFACE_DOMAIN);
+			const bool east = i < n_columns - 1 && (flag[k + 1] & MB_MGSURFACE_DOMAIN);
+			const bool south = j > 0 && (flag[k - n_columns] & MB_MGSURFACE_DOMAIN);
+			const bool north = j < n_rows - 1 && (flag[k + n_columns] & MB_MGSURFACE_DOMAIN);
+			if (east)
+				flag[k] |= MB_MGSURFACE_EDGE_X;
+			if (north)
+				flag[k] |= MB_MGSURFACE_EDGE_Y;
+			if (west && east)
+				flag[k] |= MB_MGSURFACE_SEG_X;
+			if (south && north)
+				flag[k] |= MB_MGSURFACE_SEG_Y;
+		}
+	}
+}
+/*--------------------------------------------------------------------*/
+/* Get the band of rows of a grid handled by a thread. */
+static void mb_mgsurface_rows(const struct mb_mgsurface_context *context, int n_rows, int ithread, int *row_start,
+                              int *row_end) {
+	*row_start = (int)(((long)n_rows * ithread) / context->nthreads);
+	*row_end = (int)(((long)n_rows * (ithread + 1)) / context->nthreads);
+}
+/*--------------------------------------------------------------------*/
+/* Relax the nodes of one color in a band of rows of a level. */
+static void mb_mgsurface_relax(const struct mb_mgsurface_context *context, struct mb_mgsurface_level *level, int color,
+                               int row_start, int row_end) {
+	const int n_columns = level->n_columns;
+	const int ncolors = context->ncolors;
+	const unsigned char *flag = level->flag;
+	float *z = level->z;
+	const float *b = level->b;
+	for (int j = row_start; j < row_end; j++) {
+		/* red-black ordering has (i + j) % 2 == color, the five color
+		   ordering has (i + 3 j) % 5 == color */
+		const int istart = (ncolors == 2) ? (color + j) % 2 : (color + 2 * j) % 5;
+		for (int i = istart; i < n_columns; i += ncolors) {
+			const size_t k = i + (size_t)j * n_columns;
+			if (!MB_MGSURFACE_FREE(flag[k]))
+				continue;
+			double diag;
+			const double az = mb_mgsurface_operator(level, z, i, j, &diag);
+			if (diag > 0.0)
+				z[k] += (float)((b[k] - az) / diag);
+		}
+	}
+}
+/*--------------------------------------------------------------------*/
+/* Relax all colors of a level nsweeps times, in reverse color order if
+   reverse is set. */
+static void mb_mgsurface_smooth(struct mb_mgsurface_context *context, int ilevel, int ithread, int nsweeps, bool reverse) {
+	struct mb_mgsurface_level *level = &context->level[ilevel];
+	int row_start, row_end;
+	mb_mgsurface_rows(context, level->n_rows, ithread, &row_start, &row_end);
+	for (int isweep = 0; isweep < nsweeps; isweep++) {
+		for (int icolor = 0; icolor < context->ncolors; icolor++) {
+			const int color = reverse ? context->ncolors - 1 - icolor : icolor;
+			mb_mgsurface_relax(context, level, color, row_start, row_end);
+			mb_mgsurface_barrier_wait(&context->barrier);
+		}
+	}
+}
+/*--------------------------------------------------------------------*/
+/* Run one V-cycle for the correction equation of level ilevel, starting
+   from a zero correction. */
+static void mb_mgsurface_vcycle(struct mb_mgsurface_context *context, int ilevel, int ithread) {
+	struct mb_mgsurface_level *fine = &context->level[ilevel];
+
+	/* relax the coarsest grid to convergence with symmetric sweeps */
+	if (ilevel == context->nlevels - 1) {
+		const int nsweeps = fine->n_columns + fine->n_rows;
+		mb_mgsurface_smooth(context, ilevel, ithread, nsweeps, false);
+		mb_mgsurface_smooth(context, ilevel, ithread, nsweeps, true);
+		return;
+	}
+
+	/* presmoothing */
+	mb_mgsurface_smooth(context, ilevel, ithread, MB_MGSURFACE_SMOOTH, false);
+
+	/* residual */
+	int row_start, row_end;
+	mb_mgsurface_rows(context, fine->n_rows, ithread, &row_start, &row_end);
+	for (int j = row_start; j < row_end; j++) {
+		for (int i = 0; i < fine->n_columns; i++) {
+			const size_t k = i + (size_t)j * fine->n_columns;
+			fine->r[k] = 0.0;
+			if (MB_MGSURFACE_FREE(fine->flag[k])) {
+				double diag;
+				fine->r[k] = (float)(fine->b[k] - mb_mgsurface_operator(fine, fine->z, i, j, &diag));
+			}
+		}
+	}
+	mb_mgsurface_barrier_wait(&context->barrier);
+
+	/* full weighting restriction of the residual to the coarse grid */
+	struct mb_mgsurface_level *coarse = &context->level[ilevel + 1];
+	int crow_start, crow_end;
+	mb_mgsurface_rows(context, coarse->n_rows, ithread, &crow_start, &crow_end);
+	for (int jc = crow_start; jc < crow_end; jc++) {
+		for (int ic = 0; ic < coarse->n_columns; ic++) {
+			const size_t kc = ic + (size_t)jc * coarse->n_columns;
+			coarse->z[kc] = 0.0;
+			coarse->b[kc] = 0.0;
+			if (!MB_MGSURFACE_FREE(coarse->flag[kc]))
+				continue;
+			double sum = 0.0;
+			for (int j = MAX(2 * jc - 1, 0); j <= MIN(2 * jc + 1, fine->n_rows - 1); j++)
+				for (int i = MAX(2 * ic - 1, 0); i <= MIN(2 * ic + 1, fine->n_columns - 1); i++)
+					sum += (2 - abs(i - 2 * ic)) * (2 - abs(j - 2 * jc)) * fine->r[i + (size_t)j * fine->n_columns];
+			coarse->b[kc] = (float)(sum / 16.0);
+		}
+	}
+	mb_mgsurface_barrier_wait(&context->barrier);
+
+	/* coarse grid correction */
+	mb_mgsurface_vcycle(context, ilevel + 1, ithread);
+
+	/* bilinear prolongation of the correction */
+	const float *zc = coarse->z;
+	const int nc = coarse->n_columns;
+	for (int j = row_start; j < row_end; j++) {
+		const int jc = j / 2;
+		const int jc2 = (j % 2) ? jc + 1 : jc;
+		for (int i = 0; i < fine->n_columns; i++) {
+			const size_t k = i + (size_t)j * fine->n_columns;
+			if (!MB_MGSURFACE_FREE(fine->flag[k]))
+				continue;
+			const int ic = i / 2;
+			const int ic2 = (i % 2) ? ic + 1 : ic;
+			fine->z[k] += 0.25f * (zc[ic + (size_t)jc * nc] + zc[ic2 + (size_t)jc * nc] + zc[ic + (size_t)jc2 * nc] +
+			                       zc[ic2 + (size_t)jc2 * nc]);
+		}
+	}
+	mb_mgsurface_barrier_wait(&context->barrier);
+
+	/* postsmoothing */
+	mb_mgsurface_smooth(context, ilevel, ithread, MB_MGSURFACE_SMOOTH, true);
+}
+/*--------------------------------------------------------------------*/
+/* Sum the per row partial sums in row order, so that the result does
+   not depend on the number of threads. */
+static double mb_mgsurface_sum(struct mb_mgsurface_context *context) {
+	mb_mgsurface_barrier_wait(&context->barrier);
+	double sum = 0.0;
+	for (int j = 0; j < context->level[0].n_rows; j++)
+		sum += context->rowsum[j];
+	mb_mgsurface_barrier_wait(&context->barrier);
+	return (sum);
+}
+/*--------------------------------------------------------------------*/
+static void *mb_mgsurface_worker(void *arg) {
+	struct mb_mgsurface_work_struct *work = (struct mb_mgsurface_work_struct *)arg;
+	struct mb_mgsurface_context *context = work->context;
+	const int ithread = work->ithread;
+	struct mb_mgsurface_level *fine = &context->level[0];
+	const int n_columns = fine->n_columns;
+	float *x = context->x;
+	float *p = context->p;
+	float *q = context->q;
+	float *r = fine->b;
+	float *s = fine->z;
+
+	/* wait until all of the threads have been started */
+	pthread_mutex_lock(&context->start);
+	pthread_mutex_unlock(&context->start);
+	int row_start, row_end;
+	mb_mgsurface_rows(context, fine->n_rows, ithread, &row_start, &row_end);
+
+	/* initial residual of the starting solution */
+	for (int j = row_start; j < row_end; j++) {
+		for (int i = 0; i < n_columns; i++) {
+			const size_t k = i + (size_t)j * n_columns;
+			r[k] = 0.0;
+			s[k] = 0.0;
+			p[k] = 0.0;
+			if (MB_MGSURFACE_FREE(fine->flag[k])) {
+				double diag;
+				r[k] = (float)(-mb_mgsurface_operator(fine, x, i, j, &diag));
+			}
+		}
+	}
+	mb_mgsurface_barrier_wait(&context->barrier);
+
+	/* preconditioned conjugate gradient iterations, all threads see the
+	   same sums and maxima and so make the same decisions */
+	mb_mgsurface_vcycle(context, 0, ithread);
+	for (int j = row_start; j < row_end; j++) {
+		double sum = 0.0;
+		for (int i = 0; i < n_columns; i++) {
+			const size_t k = i + (size_t)j * n_columns;
+			p[k] = s[k];
+			sum += (double)r[k] * s[k];
+		}
+		context->rowsum[j] = sum;
+	}
+	double rho = mb_mgsurface_sum(context);
+	for (int icycle = 0; icycle < context->cycles_max && rho > 0.0; icycle++) {
+		/* apply the operator to the search direction */
+		for (int j = row_start; j < row_end; j++) {
+			double sum = 0.0;
+			for (int i = 0; i < n_columns; i++) {
+				const size_t k = i + (size_t)j * n_columns;
+				q[k] = 0.0;
+				if (MB_MGSURFACE_FREE(fine->flag[k])) {
+					double diag;
+					q[k] = (float)mb_mgsurface_operator(fine, p, i, j, &diag);
+					sum += (double)p[k] * q[k];
+				}
+			}
+			context->rowsum[j] = sum;
+		}
+		const double pq = mb_mgsurface_sum(context);
+		if (pq <= 0.0)
+			break;
+		const double alpha = rho / pq;
+
+		/* update the solution and residual */
+		double dzmax = 0.0;
+		for (int j = row_start; j < row_end; j++) {
+			for (int i = 0; i < n_columns; i++) {
+				const size_t k = i + (size_t)j * n_columns;
+				const double dz = alpha * p[k];
+				x[k] += (float)dz;
+				r[k] -= (float)(alpha * q[k]);
+				s[k] = 0.0;
+				dzmax = MAX(dzmax, fabs(dz));
+			}
+		}
+		context->dzmax[ithread] = dzmax;
+		mb_mgsurface_barrier_wait(&context->barrier);
+		dzmax = 0.0;
+		for (int jthread = 0; jthread < context->nthreads; jthread++)
+			dzmax = MAX(dzmax, context->dzmax[jthread]);
+		mb_mgsurface_barrier_wait(&context->barrier);
+		if (ithread == 0) {
+			context->ncycles = icycle + 1;
+			context->dzmax_final = dzmax;
+		}
+		if (dzmax <= context->dzcriteria)
+			break;
+
+		/* precondition the residual and update the search direction */
+		mb_mgsurface_vcycle(context, 0, ithread);
+		for (int j = row_start; j < row_end; j++) {
+			double sum = 0.0;
+			for (int i = 0; i < n_columns; i++) {
+				const size_t k = i + (size_t)j * n_columns;
+				sum += (double)r[k] * s[k];
+			}
+			context->rowsum[j] = sum;
+		}
+		const double rho_new = mb_mgsurface_sum(context);
+		const double beta = rho_new / rho;
+		rho = rho_new;
+		for (int j = row_start; j < row_end; j++) {
+			for (int i = 0; i < n_columns; i++) {
+				const size_t k = i + (size_t)j * n_columns;
+				p[k] = (float)(s[k] + beta * p[k]);
+			}
+		}
+		mb_mgsurface_barrier_wait(&context->barrier);
+	}
+
+	return (NULL);
+}
+/*--------------------------------------------------------------------*/
+int mb_mgsurface(int verbose, struct mb_mgsurface_struct *surface, int n_columns, int n_rows, double x1, double y1, double dx,
+                 double dy, int ndata, const float *xyz, float *z, int *error) {
+	if (verbose >= 2) {
+		fprintf(stderr, "\ndbg2  MBIO function <%s> called\n", __func__);
+		fprintf(stderr, "dbg2  Input arguments:\n");
+		fprintf(stderr, "dbg2       verbose:               %d\n", verbose);
+		fprintf(stderr, "dbg2       surface:               %p\n", surface);
+		fprintf(stderr, "dbg2       surface->nthreads:     %d\n", surface->nthreads);
+		fprintf(stderr, "dbg2       surface->tension:      %f\n", surface->tension);
+		fprintf(stderr, "dbg2       surface->clip:         %d\n", surface->clip);
+		fprintf(stderr, "dbg2       surface->convergence:  %f\n", surface->convergence);
+		fprintf(stderr, "dbg2       surface->cycles_max:   %d\n", surface->cycles_max);
+		fprintf(stderr, "dbg2       n_columns:             %d\n", n_columns);
+		fprintf(stderr, "dbg2       n_rows:                %d\n", n_rows);
+		fprintf(stderr, "dbg2       x1:                    %f\n", x1);
+		fprintf(stderr, "dbg2       y1:                    %f\n", y1);
+		fprintf(stderr, "dbg2       dx:                    %f\n", dx);
+		fprintf(stderr, "dbg2       dy:                    %f\n", dy);
+		fprintf(stderr, "dbg2       ndata:                 %d\n", ndata);
+		fprintf(stderr, "dbg2       xyz:                   %p\n", xyz);
+		fprintf(stderr, "dbg2       z:                     %p\n", z);
+	}
+
+	int status = MB_SUCCESS;
+	*error = MB_ERROR_NO_ERROR;
+	surface->nlevels = 0;
+	surface->ncycles = 0;
+	surface->dzmax = 0.0;
+
+	struct mb_mgsurface_context context;
+	memset(&context, 0, sizeof(struct mb_mgsurface_context));
+	const size_t nnodes = (size_t)n_columns * (size_t)n_rows;
+	int *dist = NULL;
+	float *zsum = NULL;
+
+	/* set up the finest grid, using the output array for the solution */
+	struct mb_mgsurface_level *level = &context.level[0];
+	level->n_columns = n_columns;
+	level->n_rows = n_rows;
+	context.x = z;
+	if (n_columns <= 0 || n_rows <= 0 || dx <= 0.0 || dy <= 0.0) {
+		status = MB_FAILURE;
+		*error = MB_ERROR_BAD_PARAMETER;
+	}
+	if (status == MB_SUCCESS)
+		status = mb_mallocd(verbose, __FILE__, __LINE__, nnodes * sizeof(unsigned char), (void **)&level->flag, error);
+	if (status == MB_SUCCESS)
+		status = mb_mallocd(verbose, __FILE__, __LINE__, nnodes * sizeof(int), (void **)&dist, error);
+	if (status == MB_SUCCESS)
+		status = mb_mallocd(verbose, __FILE__, __LINE__, nnodes * sizeof(float), (void **)&zsum, error);
+
+	/* average the data onto the nearest nodes */
+	double zmin = 0.0;
+	double zmax = 0.0;
+	size_t nfixed = 0;
+	size_t nfree = 0;
+	if (status == MB_SUCCESS) {
+		memset(level->flag, 0, nnodes * sizeof(unsigned char));
+		memset(dist, 0, nnodes * sizeof(int));
+		memset(zsum, 0, nnodes * sizeof(float));
+		for (int n = 0; n < ndata; n++) {
+			const int i = (int)floor((xyz[3 * n] - x1) / dx + 0.5);
+			const int j = (int)floor((xyz[3 * n + 1] - y1) / dy + 0.5);
+			if (i >= 0 && i < n_columns && j >= 0 && j < n_rows) {
+				const size_t k = i + (size_t)j * n_columns;
+				zsum[k] += xyz[3 * n + 2];
+				dist[k]++;
+			}
+		}
+		for (size_t k = 0; k < nnodes; k++) {
+			if (dist[k] > 0) {
+				z[k] = zsum[k] / dist[k];
+				if (nfixed == 0 || z[k] < zmin)
+					zmin = z[k];
+				if (nfixed == 0 || z[k] > zmax)
+					zmax = z[k];
+				nfixed++;
+				level->flag[k] = MB_MGSURFACE_DOMAIN | MB_MGSURFACE_FIXED;
+				dist[k] = 0;
+			}
+			else {
+				z[k] = MB_MGSURFACE_NODATA;
+				dist[k] = INT_MAX - 1;
+			}
+		}
+
+		/* get the distance from data counted along rows and columns with
+		   a two pass transform, starting each node from the value of the
+		   data node it is nearest to */
+		for (int j = 0; j < n_rows; j++) {
+			for (int i = 0; i < n_columns; i++) {
+				const size_t k = i + (size_t)j * n_columns;
+				if (i > 0 && dist[k - 1] + 1 < dist[k]) {
+					dist[k] = dist[k - 1] + 1;
+					z[k] = z[k - 1];
+				}
+				if (j > 0 && dist[k - n_columns] + 1 < dist[k]) {
+					dist[k] = dist[k - n_columns] + 1;
+					z[k] = z[k - n_columns];
+				}
+			}
+		}
+		for (int j = n_rows - 1; j >= 0; j--) {
+			for (int i = n_columns - 1; i >= 0; i--) {
+				const size_t k = i + (size_t)j * n_columns;
+				if (i < n_columns - 1 && dist[k + 1] + 1 < dist[k]) {
+					dist[k] = dist[k + 1] + 1;
+					z[k] = z[k + 1];
+				}
+				if (j < n_rows - 1 && dist[k + n_columns] + 1 < dist[k]) {
+					dist[k] = dist[k + n_columns] + 1;
+					z[k] = z[k + n_columns];
+				}
+			}
+		}
+
+		/* nodes within the clip distance are interpolated */
+		const int clip = MAX(surface->clip, 0);
+		for (size_t k = 0; k < nnodes; k++) {
+			if (dist[k] > 0 && dist[k] <= clip) {
+				level->flag[k] = MB_MGSURFACE_DOMAIN;
+				nfree++;
+			}
+			else if (dist[k] > 0) {
+				z[k] = MB_MGSURFACE_NODATA;
+			}
+		}
+		mb_mgsurface_setflags(level);
+	}
+	int tmp_error = MB_ERROR_NO_ERROR;
+	if (dist != NULL)
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&dist, &tmp_error);
+	if (zsum != NULL)
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&zsum, &tmp_error);
+
+	/* only solve if there are nodes to interpolate */
+	if (status == MB_SUCCESS && nfixed > 0 && nfree > 0) {
+		/* scale the zgrid weights so that they sum to one, the second
+		   difference weight approaching one for a thin plate spline */
+		const double tension = MAX(surface->tension, 0.0);
+		level->c1 = 1.0 / (1.0 + tension);
+		level->c2 = tension / (1.0 + tension);
+		context.ncolors = (tension > 0.0) ? 5 : 2;
+		context.nlevels = 1;
+
+		/* allocate the conjugate gradient arrays */
+		status = mb_mallocd(verbose, __FILE__, __LINE__, nnodes * sizeof(float), (void **)&level->z, error);
+		if (status == MB_SUCCESS)
+			status = mb_mallocd(verbose, __FILE__, __LINE__, nnodes * sizeof(float), (void **)&level->b, error);
+		if (status == MB_SUCCESS)
+			status = mb_mallocd(verbose, __FILE__, __LINE__, nnodes * sizeof(float), (void **)&context.p, error);
+		if (status == MB_SUCCESS)
+			status = mb_mallocd(verbose, __FILE__, __LINE__, nnodes * sizeof(float), (void **)&context.q, error);
+		if (status == MB_SUCCESS)
+			status = mb_mallocd(verbose, __FILE__, __LINE__, n_rows * sizeof(double), (void **)&context.rowsum, error);
+		level->r = context.q;
+
+		/* build the coarser grids - a coarse node is interpolated if any
+		   fine node within one cell of it is, and held fixed if any is */
+		while (status == MB_SUCCESS && context.nlevels < MB_MGSURFACE_LEVEL_MAX &&
+		       context.level[context.nlevels - 1].n_columns > MB_MGSURFACE_COARSEST &&
+		       context.level[context.nlevels - 1].n_rows > MB_MGSURFACE_COARSEST) {
+			struct mb_mgsurface_level *fine = &context.level[context.nlevels - 1];
+			struct mb_mgsurface_level *coarse = &context.level[context.nlevels];
+			coarse->n_columns = fine->n_columns / 2 + 1;
+			coarse->n_rows = fine->n_rows / 2 + 1;
+			coarse->c1 = fine->c1 / 4.0;
+			coarse->c2 = fine->c2 / 16.0;
+			const size_t ncoarse = (size_t)coarse->n_columns * (size_t)coarse->n_rows;
+			status = mb_mallocd(verbose, __FILE__, __LINE__, ncoarse * sizeof(float), (void **)&coarse->z, error);
+			if (status == MB_SUCCESS)
+				status = mb_mallocd(verbose, __FILE__, __LINE__, ncoarse * sizeof(float), (void **)&coarse->b, error);
+			if (status == MB_SUCCESS)
+				status = mb_mallocd(verbose, __FILE__, __LINE__, ncoarse * sizeof(float), (void **)&coarse->r, error);
+			if (status == MB_SUCCESS)
+				status = mb_mallocd(verbose, __FILE__, __LINE__, ncoarse * sizeof(unsigned char), (void **)&coarse->flag, error);
+			if (status != MB_SUCCESS)
+				break;
+			memset(coarse->z, 0, ncoarse * sizeof(float));
+			memset(coarse->b, 0, ncoarse * sizeof(float));
+			memset(coarse->r, 0, ncoarse * sizeof(float));
+			size_t ncoarsefree = 0;
+			for (int jc = 0; jc < coarse->n_rows; jc++) {
+				for (int ic = 0; ic < coarse->n_columns; ic++) {
+					unsigned char cflag = 0;
+					for (int j = MAX(2 * jc - 1, 0); j <= MIN(2 * jc + 1, fine->n_rows - 1); j++)
+						for (int i = MAX(2 * ic - 1, 0); i <= MIN(2 * ic + 1, fine->n_columns - 1); i++)
+							cflag |= fine->flag[i + (size_t)j * fine->n_columns] & (MB_MGSURFACE_DOMAIN | MB_MGSURFACE_FIXED);
+					coarse->flag[ic + (size_t)jc * coarse->n_columns] = cflag;
+					if (MB_MGSURFACE_FREE(cflag))
+						ncoarsefree++;
+				}
+			}
+			mb_mgsurface_setflags(coarse);
+
+			/* no point in going coarser once everything is held fixed */
+			if (ncoarsefree == 0) {
+				mb_freed(verbose, __FILE__, __LINE__, (void **)&coarse->z, &tmp_error);
+				mb_freed(verbose, __FILE__, __LINE__, (void **)&coarse->b, &tmp_error);
+				mb_freed(verbose, __FILE__, __LINE__, (void **)&coarse->r, &tmp_error);
+				mb_freed(verbose, __FILE__, __LINE__, (void **)&coarse->flag, &tmp_error);
+				break;
+			}
+			context.nlevels++;
+		}
+
+		/* the convergence criteria is relative to the data range */
+		const double convergence = (surface->convergence > 0.0) ? surface->convergence : MB_MGSURFACE_CONVERGENCE;
+		context.dzcriteria = convergence * MAX(zmax - zmin, 1.0e-6 * MAX(fabs(zmax), 1.0));
+		context.cycles_max = (surface->cycles_max > 0) ? surface->cycles_max : MB_MGSURFACE_CYCLES;
+
+		/* start the threads, the calling thread working as the last one,
+		   and run with however many could be started */
+		if (status == MB_SUCCESS) {
+			context.nthreads = MIN(mb_nthreads(surface->nthreads), MAX(n_rows / 4, 1));
+			pthread_mutex_init(&context.start, NULL);
+			pthread_mutex_init(&context.barrier.mutex, NULL);
+			pthread_cond_init(&context.barrier.cond, NULL);
+			pthread_t threads[MB_THREAD_MAX];
+			struct mb_mgsurface_work_struct work[MB_THREAD_MAX];
+			int nstarted = 0;
+			pthread_mutex_lock(&context.start);
+			for (int ithread = 0; ithread < context.nthreads - 1; ithread++) {
+				work[ithread].context = &context;
+				work[ithread].ithread = ithread;
+				if (pthread_create(&threads[ithread], NULL, mb_mgsurface_worker, &work[ithread]) != 0)
+					break;
+				nstarted++;
+			}
+			context.nthreads = nstarted + 1;
+			context.barrier.nthreads = context.nthreads;
+			pthread_mutex_unlock(&context.start);
+			work[nstarted].context = &context;
+			work[nstarted].ithread = nstarted;
+			mb_mgsurface_worker(&work[nstarted]);
+			for (int ithread = 0; ithread < nstarted; ithread++)
+				pthread_join(threads[ithread], NULL);
+			pthread_cond_destroy(&context.barrier.cond);
+			pthread_mutex_destroy(&context.barrier.mutex);
+			pthread_mutex_destroy(&context.start);
+
+			surface->nlevels = context.nlevels;
+			surface->ncycles = context.ncycles;
+			surface->dzmax = context.dzmax_final;
+		}
+	}
+
+	/* deallocate the work arrays, the solution being the output array */
+	level = &context.level[0];
+	level->r = NULL;
+	if (context.p != NULL)
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&context.p, &tmp_error);
+	if (context.q != NULL)
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&context.q, &tmp_error);
+	if (context.rowsum != NULL)
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&context.rowsum, &tmp_error);
+	for (int ilevel = 0; ilevel < MB_MGSURFACE_LEVEL_MAX; ilevel++) {
+		level = &context.level[ilevel];
+		if (level->z != NULL)
+			mb_freed(verbose, __FILE__, __LINE__, (void **)&level->z, &tmp_error);
+		if (level->b != NULL)
+			mb_freed(verbose, __FILE__, __LINE__, (void **)&level->b, &tmp_error);
+		if (level->r != NULL)
+			mb_freed(verbose, __FILE__, __LINE__, (void **)&level->r, &tmp_error);
+		if (level->flag != NULL)
+			mb_freed(verbose, __FILE__, __LINE__, (void **)&level->flag, &tmp_error);
+	}
+
+	if (verbose >= 2) {
+		fprintf(stderr, "\ndbg2  MBIO function <%s> completed\n", __func__);
+		fprintf(stderr, "dbg2  Return values:\n");
+		fprintf(stderr, "dbg2       surface->nlevels:      %d\n", surface->nlevels);
+		fprintf(stderr, "dbg2       surface->ncycles:      %d\n", surface->ncycles);
+		fprintf(stderr, "dbg2       surface->dzmax:        %f\n", surface->dzmax);
+		fprintf(stderr, "dbg2       error:                 %d\n", *error);
+		fprintf(stderr, "dbg2  Return status:\n");
+		fprintf(stderr, "dbg2       status:                %d\n", status);
+	}
+
+	return (status);
+}
+/*--------------------------------------------------------------------*/
@@ -29,6 +29,7 @@
  * Date:  September 3, 2007
  */
 
+#include <float.h>
 #include <math.h>
 #include <stdio.h>
 #include <string.h>
@@ -55,6 +56,9 @@ enum ModelType {
 };
 static const int GCS_WGS_84 = 4326;
 
+/* Windowed reads: maximum number of nodes read at once */
+#define MB_GRD_WINDOW_BAND_NODES 16777216
+
 /*--------------------------------------------------------------------------*/
 int mb_check_gmt_grd(int verbose, char *grdfile, int *grid_projection_mode, char *grid_projection_id, float *nodatavalue, int *nxy,
                     int *n_columns, int *n_rows, double *min, double *max, double *xmin, double *xmax, double *ymin, double *ymax,
@@ -280,6 +284,115 @@ int mb_check_gmt_grd(int verbose, char *grdfile, int *grid_projection_mode, char
   return (status);
 }
 /*--------------------------------------------------------------------------*/
+/* Get the projection of a grid from the grd file remark, geographic WGS84
+ * if no projection is named there */
+static void mb_grd_projection(const struct GMT_GRID_HEADER *header, int *grid_projection_mode, char *grid_projection_id,
+                              char *projectionname, int *epsgid, enum ModelType *modeltype) {
+  if (strncmp(&(header->remark[2]), "Projection: ", 12) == 0) {
+    int utmzone;
+    char NorS;
+    double lon_origin;
+    double lat_origin;
+    if (sscanf(&(header->remark[2]), "Projection: UTM%d%c", &utmzone, &NorS) == 2) {
+      if (NorS == 'S') {
+        *epsgid = 32700 + utmzone;
+      }
+      else {
+        *epsgid = 32600 + utmzone;
+      }
+      *modeltype = ModelTypeProjected;
+      sprintf(projectionname, "UTM%2.2d%c", utmzone, NorS);
+      *grid_projection_mode = MB_PROJECTION_PROJECTED;
+      sprintf(grid_projection_id, "EPSG:%d", *epsgid);
+    }
+    else if (sscanf(&(header->remark[2]), "Projection: LTM%lf/%lf", &lon_origin, &lat_origin) == 2) {
+      *modeltype = ModelTypeProjected;
+      sprintf(projectionname, "LTM%.9f/%.9f", lon_origin, lat_origin);
+      *grid_projection_mode = MB_PROJECTION_PROJECTED;
+      sprintf(grid_projection_id, "+proj=tmerc +lon_0=%.9f +lat_0=%.9f +ellps=WGS84", lon_origin, lat_origin);
+    }
+    else if (sscanf(&(header->remark[2]), "Projection: EPSG:%d", epsgid) == 1) {
+      sprintf(projectionname, "EPSG:%d", *epsgid);
+      *modeltype = ModelTypeProjected;
+      *grid_projection_mode = MB_PROJECTION_PROJECTED;
+      sprintf(grid_projection_id, "EPSG:%d", *epsgid);
+    }
+    else {
+      strcpy(projectionname, "Geographic WGS84");
+      *modeltype = ModelTypeGeographic;
+      *epsgid = GCS_WGS_84;
+      *grid_projection_mode = MB_PROJECTION_GEOGRAPHIC;
+      sprintf(grid_projection_id, "EPSG:%d", *epsgid);
+    }
+  }
+  else {
+    strcpy(projectionname, "Geographic WGS84");
+    *modeltype = ModelTypeGeographic;
+    *epsgid = GCS_WGS_84;
+    *grid_projection_mode = MB_PROJECTION_GEOGRAPHIC;
+    sprintf(grid_projection_id, "EPSG:%d", *epsgid);
+  }
+}
+/*--------------------------------------------------------------------------*/
+/* Calculate the x and y derivatives of a grid in internal order
+ * (k = i * n_rows + j) */
+static void mb_grd_derivatives(int verbose, int grid_projection_mode, int n_columns, int n_rows, double ymin, double ymax,
+                               double dx, double dy, const float *data, float *data_dzdx, float *data_dzdy) {
+  double ddx = dx;
+  double ddy = dy;
+  if (grid_projection_mode == MB_PROJECTION_GEOGRAPHIC) {
+    double mtodeglon;
+    double mtodeglat;
+    mb_coor_scale(verbose, 0.5 * (ymin + ymax), &mtodeglon, &mtodeglat);
+    ddx /= mtodeglon;
+    ddy /= mtodeglon;
+  }
+  for (int i = 0; i < n_columns; i++)
+    for (int j = 0; j < n_rows; j++) {
+      const int k = i * n_rows + j;
+      int ii = 0;
+
+      int kx0;
+      if (i > 0) {
+        kx0 = (i - 1) * n_rows + j;
+        ii++;
+      } else {
+        kx0 = k;
+      }
+
+      int kx2 = 0;
+      if (i < n_columns - 1) {
+        kx2 = (i + 1) * n_rows + j;
+        ii++;
+      } else {
+        kx2 = k;
+      }
+
+      int jj = 0;
+
+      int ky0;
+      if (j > 0) {
+        ky0 = i * n_rows + j + 1;
+        jj++;
+      } else {
+        ky0 = k;
+      }
+
+      int ky2;
+      if (j < n_rows - 1) {
+        ky2 = i * n_rows + j - 1;
+        jj++;
+      } else {
+        ky2 = k;
+      }
+
+      if (ii > 0)
+        data_dzdx[k] = (data[kx2] - data[kx0]) / (((double)ii) * ddx);
+      if (jj > 0)
+        data_dzdy[k] = (data[ky2] - data[ky0]) / (((double)jj) * ddy);
+    }
+}
+/*--------------------------------------------------------------------------*/
 int mb_read_gmt_grd(int verbose, char *grdfile, int *grid_projection_mode, char *grid_projection_id, float *nodatavalue, int *nxy,
                     int *n_columns, int *n_rows, double *min, double *max, double *xmin, double *xmax, double *ymin, double *ymax,
                     double *dx, double *dy, float **data, float **data_dzdx, float **data_dzdy, int *error) {
@@ -358,54 +471,7 @@ int mb_read_gmt_grd(int verbose, char *grdfile, int *grid_projection_mode, char
     if (status == MB_SUCCESS) {
       /* try to get projection from the grd file remark */
       header = G->header;
-      if (strncmp(&(header->remark[2]), "Projection: ", 12) == 0) {
-        int nscan;
-        int utmzone;
-        char NorS;
-        double lon_origin;
-        double lat_origin;
-        if ((nscan = sscanf(&(header->remark[2]), "Projection: UTM%d%c", &utmzone, &NorS)) == 2) {
-          if (NorS == 'N') {
-            epsgid = 32600 + utmzone;
-          }
-          else if (NorS == 'S') {
-            epsgid = 32700 + utmzone;
-          }
-          else {
-            epsgid = 32600 + utmzone;
-          }
-          modeltype = ModelTypeProjected;
-          sprintf(projectionname, "UTM%2.2d%c", utmzone, NorS);
-          *grid_projection_mode = MB_PROJECTION_PROJECTED;
-          sprintf(grid_projection_id, "EPSG:%d", epsgid);
-        }
-        else if ((nscan = sscanf(&(header->remark[2]), "Projection: LTM%lf/%lf", &lon_origin, &lat_origin)) == 2) {
-          modeltype = ModelTypeProjected;
-          sprintf(projectionname, "LTM%.9f/%.9f", lon_origin, lat_origin);
-          *grid_projection_mode = MB_PROJECTION_PROJECTED;
-      	  sprintf(grid_projection_id, "+proj=tmerc +lon_0=%.9f +lat_0=%.9f +ellps=WGS84", lon_origin, lat_origin);
-		}
-        else if ((nscan = sscanf(&(header->remark[2]), "Projection: EPSG:%d", &epsgid)) == 1) {
-          sprintf(projectionname, "EPSG:%d", epsgid);
-          modeltype = ModelTypeProjected;
-          *grid_projection_mode = MB_PROJECTION_PROJECTED;
-          sprintf(grid_projection_id, "EPSG:%d", epsgid);
-        }
-        else {
-          strcpy(projectionname, "Geographic WGS84");
-          modeltype = ModelTypeGeographic;
-          epsgid = GCS_WGS_84;
-          *grid_projection_mode = MB_PROJECTION_GEOGRAPHIC;
-          sprintf(grid_projection_id, "EPSG:%d", epsgid);
-        }
-      }
-      else {
-        strcpy(projectionname, "Geographic WGS84");
-        modeltype = ModelTypeGeographic;
-        epsgid = GCS_WGS_84;
-        *grid_projection_mode = MB_PROJECTION_GEOGRAPHIC;
-        sprintf(grid_projection_id, "EPSG:%d", epsgid);
-      }
+      mb_grd_projection(header, grid_projection_mode, grid_projection_id, projectionname, &epsgid, &modeltype);
 
       /* set up internal arrays */
       *nodatavalue = MIN(MB_DEFAULT_GRID_NODATA, header->z_min - 10 * (header->z_max - header->z_min));
@@ -452,59 +518,8 @@ int mb_read_gmt_grd(int verbose, char *grdfile, int *grid_projection_mode, char
 
     /* calculate derivatives */
     if (status == MB_SUCCESS && data_dzdx != NULL && data_dzdy != NULL) {
-      double ddx = *dx;
-      double ddy = *dy;
-      if (*grid_projection_mode == MB_PROJECTION_GEOGRAPHIC) {
-        double mtodeglon;
-        double mtodeglat;
-        mb_coor_scale(verbose, 0.5 * (*ymin + *ymax), &mtodeglon, &mtodeglat);
-        ddx /= mtodeglon;
-        ddy /= mtodeglon;
-      }
-      for (int i = 0; i < *n_columns; i++)
-        for (int j = 0; j < *n_rows; j++) {
-          const int k = i * (*n_rows) + j;
-          int ii = 0;
-
-          int kx0;
-          if (i > 0) {
-            kx0 = (i - 1) * (*n_rows) + j;
-            ii++;
-          } else {
-            kx0 = k;
-          }
-
-          int kx2 = 0;
-          if (i < *n_columns - 1) {
-            kx2 = (i + 1) * (*n_rows) + j;
-            ii++;
-          } else {
-            kx2 = k;
-          }
-
-          int jj = 0;
-
-          int ky0;
-          if (j > 0) {
-            ky0 = i * (*n_rows) + j + 1;
-            jj++;
-          } else {
-            ky0 = k;
-          }
-
-          int ky2;
-          if (j < *n_rows - 1) {
-            ky2 = i * (*n_rows) + j - 1;
-            jj++;
-          } else {
-            ky2 = k;
-          }
-
-          if (ii > 0)
-            (*data_dzdx)[k] = ((*data)[kx2] - (*data)[kx0]) / (((double)ii) * ddx);
-          if (jj > 0)
-            (*data_dzdy)[k] = ((*data)[ky2] - (*data)[ky0]) / (((double)jj) * ddy);
-        }
+      mb_grd_derivatives(verbose, *grid_projection_mode, *n_columns, *n_rows, *ymin, *ymax, *dx, *dy, *data, *data_dzdx,
+                         *data_dzdy);
     }
 
     /* Destroy GMT session */
@@ -601,6 +616,267 @@ int mb_read_gmt_grd(int verbose, char *grdfile, int *grid_projection_mode, char
 
   return (status);
 }
+/*--------------------------------------------------------------------------*/
+/*
+ * Read the part of a GMT grid inside the bounds wesn (the whole grid if wesn
+ * is NULL), keeping every decimation'th node in each direction. The window
+ * is read in bands of rows, so memory use follows the size of the returned
+ * grid rather than of the grid file. The returned grid is snapped to the
+ * file's nodes and uses the file's longitude convention; for geographic
+ * grids wesn may be given in either the -180/180 or the 0/360 convention.
+ */
+int mb_read_gmt_grd_window(int verbose, char *grdfile, double *wesn, int decimation, int *grid_projection_mode,
+                    char *grid_projection_id, float *nodatavalue, int *nxy, int *n_columns, int *n_rows, double *min,
+                    double *max, double *xmin, double *xmax, double *ymin, double *ymax, double *dx, double *dy, float **data,
+                    float **data_dzdx, float **data_dzdy, int *error) {
+  if (verbose >= 2) {
+    fprintf(stderr, "\ndbg2  MBBA function <%s> called\n", __func__);
+    fprintf(stderr, "dbg2  Input arguments:\n");
+    fprintf(stderr, "dbg2       verbose:         %d\n", verbose);
+    fprintf(stderr, "dbg2       grdfile:         %s\n", grdfile);
+    if (wesn != NULL)
+      fprintf(stderr, "dbg2       wesn:            %f %f %f %f\n", wesn[0], wesn[1], wesn[2], wesn[3]);
+    else
+      fprintf(stderr, "dbg2       wesn:            NULL\n");
+    fprintf(stderr, "dbg2       decimation:      %d\n", decimation);
+  }
+
+  int status = MB_SUCCESS;
+
+  /* check if the file exists and is readable */
+  struct stat file_status;
+  if (stat(grdfile, &file_status) == 0
+    && (file_status.st_mode & S_IFMT) != S_IFDIR
+    && file_status.st_size > 0) {
+    *error = MB_ERROR_NO_ERROR;
+    status = MB_SUCCESS;
+  }
+  else {
+    *error = MB_ERROR_OPEN_FAIL;
+    status = MB_FAILURE;
+  }
+  decimation = MAX(decimation, 1);
+
+  mb_path projectionname = "";
+  int epsgid;
+  enum ModelType modeltype;
+  int i0 = 0;
+  int i1 = 0;
+  int j0 = 0;
+  int j1 = 0;
+
+  /* if file exists proceed */
+  if (status == MB_SUCCESS) {
+
+    /* Initialize new GMT session without padding, returning on errors */
+    void *API  = GMT_Create_Session(__func__, 0U, 1U, NULL);
+    if (API == NULL) {
+      fprintf(stderr, "\nUnable to initialize a GMT session with GMT_Create_Session() in function %s\n", __func__);
+      fprintf(stderr, "Unable to read GMT grid file %s\n",grdfile);
+      fprintf(stderr, "Program terminated\n");
+      exit(EXIT_FAILURE);
+    }
+
+    /* read the grid header only */
+    struct GMT_GRID *G = GMT_Read_Data(API, GMT_IS_GRID, GMT_IS_FILE, GMT_IS_SURFACE, GMT_CONTAINER_ONLY, NULL, grdfile, NULL);
+    if (G == NULL) {
+      fprintf(stderr, "\nUnable to read GMT grid file %s with GMT_Read_Data() in function %s\n", grdfile, __func__);
+      fprintf(stderr, "Program terminated\n");
+      exit(EXIT_FAILURE);
+    }
+    const struct GMT_GRID_HEADER *header = G->header;
+    mb_grd_projection(header, grid_projection_mode, grid_projection_id, projectionname, &epsgid, &modeltype);
+    const unsigned int registration = header->registration;
+    *nodatavalue = MIN(MB_DEFAULT_GRID_NODATA, header->z_min - 10 * (header->z_max - header->z_min));
+
+    /* get the window in file node indices, j increasing to the north */
+    i1 = header->n_columns - 1;
+    j1 = header->n_rows - 1;
+    if (wesn != NULL) {
+      double west = wesn[0];
+      double east = wesn[1];
+      if (*grid_projection_mode == MB_PROJECTION_GEOGRAPHIC) {
+        if (east < header->wesn[0]) {
+          west += 360.0;
+          east += 360.0;
+        }
+        else if (west > header->wesn[1]) {
+          west -= 360.0;
+          east -= 360.0;
+        }
+      }
+      const double tolerance = 0.001;
+      i0 = MAX(i0, (int)ceil((west - header->wesn[0]) / header->inc[0] - tolerance));
+      i1 = MIN(i1, (int)floor((east - header->wesn[0]) / header->inc[0] + tolerance));
+      j0 = MAX(j0, (int)ceil((wesn[2] - header->wesn[2]) / header->inc[1] - tolerance));
+      j1 = MIN(j1, (int)floor((wesn[3] - header->wesn[2]) / header->inc[1] + tolerance));
+    }
+    if (i0 > i1 || j0 > j1) {
+      *error = MB_ERROR_NONE_IN_BOUNDS;
+      status = MB_FAILURE;
+    }
+
+    /* set up the output grid */
+    if (status == MB_SUCCESS) {
+      *n_columns = (i1 - i0) / decimation + 1;
+      *n_rows = (j1 - j0) / decimation + 1;
+      *nxy = *n_columns * *n_rows;
+      *dx = header->inc[0] * decimation;
+      *dy = header->inc[1] * decimation;
+      *xmin = header->wesn[0] + i0 * header->inc[0];
+      *xmax = *xmin + (*n_columns - 1 + registration) * *dx;
+      *ymin = header->wesn[2] + j0 * header->inc[1];
+      *ymax = *ymin + (*n_rows - 1 + registration) * *dy;
+      *min = header->z_min;
+      *max = header->z_max;
+
+      *data = NULL;
+      if (data_dzdx != NULL)
+        *data_dzdx = NULL;
+      if (data_dzdy != NULL)
+        *data_dzdy = NULL;
+      status = mb_mallocd(verbose, __FILE__, __LINE__, sizeof(float) * (*nxy), (void **)data, error);
+      if (status == MB_SUCCESS && data_dzdx != NULL) {
+        status = mb_mallocd(verbose, __FILE__, __LINE__, sizeof(float) * (*nxy), (void **)data_dzdx, error);
+      }
+      if (status == MB_SUCCESS && data_dzdy != NULL) {
+        status = mb_mallocd(verbose, __FILE__, __LINE__, sizeof(float) * (*nxy), (void **)data_dzdy, error);
+      }
+    }
+
+    /* read the window in bands of rows, each band holding the file rows
+       needed for as many output rows as fit in MB_GRD_WINDOW_BAND_NODES
+       (at least one), so that heavily decimated windows are not read
+       with one GMT_Read_Data() call per output row */
+    if (status == MB_SUCCESS) {
+      const int nwindow_columns = i1 - i0 + 1;
+      const int band_rows = MAX(1, MB_GRD_WINDOW_BAND_NODES / nwindow_columns);
+      const int band_out = MAX(1, (band_rows - 1) / decimation + 1);
+      double zmin = DBL_MAX;
+      double zmax = -DBL_MAX;
+      for (int jo = 0; jo < *n_rows && status == MB_SUCCESS; jo += band_out) {
+        const int jo_end = MIN(*n_rows, jo + band_out);
+        const int jb0 = j0 + jo * decimation;
+        const int jb1 = j0 + (jo_end - 1) * decimation;
+        double band_wesn[4];
+        band_wesn[0] = header->wesn[0] + i0 * header->inc[0];
+        band_wesn[1] = header->wesn[0] + (i1 + registration) * header->inc[0];
+        band_wesn[2] = header->wesn[2] + jb0 * header->inc[1];
+        band_wesn[3] = header->wesn[2] + (jb1 + registration) * header->inc[1];
+        struct GMT_GRID *B = GMT_Read_Data(API, GMT_IS_GRID, GMT_IS_FILE, GMT_IS_SURFACE, GMT_CONTAINER_AND_DATA, band_wesn,
+                                           grdfile, NULL);
+        if (B == NULL || (int)B->header->n_columns != nwindow_columns || (int)B->header->n_rows != jb1 - jb0 + 1) {
+          fprintf(stderr, "\nUnable to read rows %d to %d of GMT grid file %s with GMT_Read_Data() in function %s\n",
+                  jb0, jb1, grdfile, __func__);
+          *error = MB_ERROR_BAD_FORMAT;
+          status = MB_FAILURE;
+        }
+
+        /* copy the band, reordering to internal convention */
+        else {
+          const struct GMT_GRID_HEADER *bheader = B->header;
+          const int bn_rows = bheader->n_rows;
+          const int bmx = bheader->n_columns + bheader->pad[0] + bheader->pad[1];
+          for (int io = 0; io < *n_columns; io++) {
+            const int ii = io * decimation;
+            for (int j = jo; j < jo_end; j++) {
+              const int jj = (j - jo) * decimation;
+              const int k = io * *n_rows + j;
+              const int kk = (bn_rows + bheader->pad[2] - 1 - jj) * bmx + (ii + bheader->pad[0]);
+              if (MB_IS_FNAN(B->data[kk])) {
+                (*data)[k] = *nodatavalue;
+              }
+              else {
+                (*data)[k] = B->data[kk];
+                zmin = MIN(zmin, B->data[kk]);
+                zmax = MAX(zmax, B->data[kk]);
+              }
+            }
+          }
+        }
+        if (B != NULL)
+          GMT_Destroy_Data(API, &B);
+      }
+      if (zmin <= zmax) {
+        *min = zmin;
+        *max = zmax;
+      }
+    }
+
+    /* calculate derivatives */
+    if (status == MB_SUCCESS && data_dzdx != NULL && data_dzdy != NULL) {
+      mb_grd_derivatives(verbose, *grid_projection_mode, *n_columns, *n_rows, *ymin, *ymax, *dx, *dy, *data, *data_dzdx,
+                         *data_dzdy);
+    }
+
+    /* release the output arrays on failure */
+    if (status == MB_FAILURE && *error != MB_ERROR_NONE_IN_BOUNDS) {
+      int error2 = MB_ERROR_NO_ERROR;
+      mb_freed(verbose, __FILE__, __LINE__, (void **)data, &error2);
+      if (data_dzdx != NULL)
+        mb_freed(verbose, __FILE__, __LINE__, (void **)data_dzdx, &error2);
+      if (data_dzdy != NULL)
+        mb_freed(verbose, __FILE__, __LINE__, (void **)data_dzdy, &error2);
+    }
+
+    /* Destroy GMT session */
+    if (GMT_Destroy_Session(API) != 0) {
+      fprintf(stderr, "\nUnable to destroy a GMT session with GMT_Destroy_Session() in function %s\n", __func__);
+      fprintf(stderr, "Unable to read GMT grid file %s\n",grdfile);
+      fprintf(stderr, "Program terminated\n");
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  if (status == MB_SUCCESS && verbose > 0) {
+    fprintf(stderr, "\nGrid window read:\n");
+    fprintf(stderr, "  File nodes:     %d to %d, %d to %d\n", i0, i1, j0, j1);
+    fprintf(stderr, "  Decimation:     %d\n", decimation);
+    fprintf(stderr, "  Dimensions:     %d %d\n", *n_columns, *n_rows);
+    if (modeltype == ModelTypeProjected) {
+      fprintf(stderr, "  Projected Coordinate System Name: %s\n", projectionname);
+      fprintf(stderr, "  Projected Coordinate System ID:   %d\n", epsgid);
+      fprintf(stderr, "  Easting:    %f %f  %g\n", *xmin, *xmax, *dx);
+      fprintf(stderr, "  Northing:   %f %f  %g\n", *ymin, *ymax, *dy);
+    }
+    else {
+      fprintf(stderr, "  Geographic Coordinate System Name: %s\n", projectionname);
+      fprintf(stderr, "  Geographic Coordinate System ID:   %d\n", epsgid);
+      fprintf(stderr, "  Longitude:  %.9f %.9f  %.9f\n", *xmin, *xmax, *dx);
+      fprintf(stderr, "  Latitude:   %.9f %.9f  %.9f\n", *ymin, *ymax, *dy);
+    }
+    fprintf(stderr, "  Grid Projection Mode:     %d\n", *grid_projection_mode);
+    fprintf(stderr, "  Grid Projection ID:       %s\n", grid_projection_id);
+    fprintf(stderr, "  Data Extrema:             %f %f\n", *min, *max);
+  }
+
+  if (verbose >= 2) {
+    fprintf(stderr, "\ndbg2  MBBA function <%s> completed\n", __func__);
+    fprintf(stderr, "dbg2  Return values:\n");
+    if (status == MB_SUCCESS) {
+      fprintf(stderr, "dbg2       grid_projection_mode:     %d\n", *grid_projection_mode);
+      fprintf(stderr, "dbg2       grid_projection_id:       %s\n", grid_projection_id);
+      fprintf(stderr, "dbg2       nodatavalue:              %f\n", *nodatavalue);
+      fprintf(stderr, "dbg2       nxy:                      %d\n", *nxy);
+      fprintf(stderr, "dbg2       n_columns:                %d\n", *n_columns);
+      fprintf(stderr, "dbg2       n_rows:                   %d\n", *n_rows);
+      fprintf(stderr, "dbg2       min:                      %f\n", *min);
+      fprintf(stderr, "dbg2       max:                      %f\n", *max);
+      fprintf(stderr, "dbg2       xmin:                     %f\n", *xmin);
+      fprintf(stderr, "dbg2       xmax:                     %f\n", *xmax);
+      fprintf(stderr, "dbg2       ymin:                     %f\n", *ymin);
+      fprintf(stderr, "dbg2       ymax:                     %f\n", *ymax);
+      fprintf(stderr, "dbg2       dx:                       %f\n", *dx);
+      fprintf(stderr, "dbg2       dy:                       %f\n", *dy);
+      fprintf(stderr, "dbg2       data:                     %p\n", *data);
+    }
+    fprintf(stderr, "dbg2       error:           %d\n", *error);
+    fprintf(stderr, "dbg2  Return status:\n");
+    fprintf(stderr, "dbg2       status:          %d\n", status);
+  }
+
+  return (status);
+}
 /*--------------------------------------------------------------------*/
 /*
  * function write_cdfgrd writes output grid to a
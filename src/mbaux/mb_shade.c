@@ -0,0 +1,960 @@
+/*--------------------------------------------------------------------
+ *    The MB-system:	mb_shade.c	10/19/2026
+ *
+ *    Copyright (c) 2026 by the MB-System Team
+ *
+ *    MB-System was created by Caress and Chayes in 1992 at the
+ *      Lamont-Doherty Earth Observatory
+ *      Columbia University
+ *      Palisades, NY 10964
+ *
+ *    See README.md file for copying and redistribution conditions.
+ *--------------------------------------------------------------------*/
+/*
+ * Surface derivative, histogram equalization, color table and shading
+ * kernels for gridded topography. These were originally embedded in
+ * mbview_process.c and operated one grid cell at a time through the
+ * mbview instance structures. Here they operate on plain column-major
+ * float arrays (k = i * n_rows + j, as returned by mb_read_gmt_grd())
+ * so that the same code can be used by mbview and by headless programs
+ * such as mbgrdshade.
+ *
+ * The whole-grid functions divide the grid into blocks of columns that
+ * are processed concurrently by a set of POSIX threads. Within a block
+ * the per-cell loops are written over contiguous arrays without
+ * data-dependent branching in the inner loops so that the compiler can
+ * vectorize them.
+ *
+ * Author:	MB-System Team, adapting the mbview_process.c kernels
+ *		written by D. W. Caress
+ * Date:	October 19, 2026
+ */
+
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mb_aux.h"
+#include "mb_define.h"
+#include "mb_status.h"
+
+/* number of cells shaded at a time by the block kernels */
+#define MB_SHADE_BLOCK 1024
+
+/* fewest cells given to each thread - smaller grids or column blocks are
+   processed in the calling thread without starting any threads */
+#define MB_SHADE_THREAD_CELLS 65536
+
+/* library colortables - these match the mbview colortables */
+static const float mb_shade_haxby_red[MB_SHADE_NUM_COLORS] = {0.950, 1.000, 1.000, 1.000, 0.941, 0.804, 0.541, 0.416, 0.196, 0.157, 0.145};
+static const float mb_shade_haxby_green[MB_SHADE_NUM_COLORS] = {0.950, 0.729, 0.631, 0.741, 0.925, 1.000, 0.925, 0.922, 0.745, 0.498, 0.224};
+static const float mb_shade_haxby_blue[MB_SHADE_NUM_COLORS] = {0.950, 0.522, 0.267, 0.341, 0.475, 0.635, 0.682, 1.000, 1.000, 0.984, 0.686};
+static const float mb_shade_bright_red[MB_SHADE_NUM_COLORS] = {1.000, 1.000, 1.000, 1.000, 0.500, 0.000, 0.000, 0.000, 0.000, 0.500, 1.000};
+static const float mb_shade_bright_green[MB_SHADE_NUM_COLORS] = {0.000, 0.250, 0.500, 1.000, 1.000, 1.000, 1.000, 0.500, 0.000, 0.000, 0.000};
+static const float mb_shade_bright_blue[MB_SHADE_NUM_COLORS] = {0.000, 0.000, 0.000, 0.000, 0.000, 0.000, 1.000, 1.000, 1.000, 1.000, 1.000};
+static const float mb_shade_muted_red[MB_SHADE_NUM_COLORS] = {0.784, 0.761, 0.702, 0.553, 0.353, 0.000, 0.000, 0.000, 0.000, 0.353, 0.553};
+static const float mb_shade_muted_green[MB_SHADE_NUM_COLORS] = {0.000, 0.192, 0.353, 0.553, 0.702, 0.784, 0.553, 0.353, 0.000, 0.000, 0.000};
+static const float mb_shade_muted_blue[MB_SHADE_NUM_COLORS] = {0.000, 0.000, 0.000, 0.000, 0.000, 0.000, 0.553, 0.702, 0.784, 0.702, 0.553};
+static const float mb_shade_gray_red[MB_SHADE_NUM_COLORS] = {0.000, 0.100, 0.200, 0.300, 0.400, 0.500, 0.600, 0.700, 0.800, 0.900, 1.000};
+static const float mb_shade_gray_green[MB_SHADE_NUM_COLORS] = {0.000, 0.100, 0.200, 0.300, 0.400, 0.500, 0.600, 0.700, 0.800, 0.900, 1.000};
+static const float mb_shade_gray_blue[MB_SHADE_NUM_COLORS] = {0.000, 0.100, 0.200, 0.300, 0.400, 0.500, 0.600, 0.700, 0.800, 0.900, 1.000};
+static const float mb_shade_flat_red[MB_SHADE_NUM_COLORS] = {0.500, 0.500, 0.500, 0.500, 0.500, 0.500, 0.500, 0.500, 0.500, 0.500, 0.500};
+static const float mb_shade_flat_green[MB_SHADE_NUM_COLORS] = {0.500, 0.500, 0.500, 0.500, 0.500, 0.500, 0.500, 0.500, 0.500, 0.500, 0.500};
+static const float mb_shade_flat_blue[MB_SHADE_NUM_COLORS] = {0.500, 0.500, 0.500, 0.500, 0.500, 0.500, 0.500, 0.500, 0.500, 0.500, 0.500};
+static const float mb_shade_abovesealevel1_red[MB_SHADE_NUM_COLORS] = {0.980, 0.960, 0.941, 0.921, 0.902, 0.882,
+                                                                       0.862, 0.843, 0.823, 0.804, 0.784};
+static const float mb_shade_abovesealevel1_green[MB_SHADE_NUM_COLORS] = {0.980, 0.940, 0.901, 0.862, 0.823, 0.784,
+                                                                         0.744, 0.705, 0.666, 0.627, 0.588};
+static const float mb_shade_abovesealevel1_blue[MB_SHADE_NUM_COLORS] = {0.471, 0.440, 0.408, 0.376, 0.345, 0.314,
+                                                                        0.282, 0.250, 0.219, 0.188, 0.157};
+static const float mb_shade_abovesealevel2_red[MB_SHADE_NUM_COLORS] = {1.000, 0.824, 0.667, 0.569, 0.471, 0.471,
+                                                                       0.408, 0.263, 0.129, 0.000, 0.000};
+static const float mb_shade_abovesealevel2_green[MB_SHADE_NUM_COLORS] = {1.000, 0.784, 0.627, 0.569, 0.510, 0.392,
+                                                                         0.420, 0.482, 0.549, 0.627, 0.902};
+static const float mb_shade_abovesealevel2_blue[MB_SHADE_NUM_COLORS] = {0.392, 0.294, 0.196, 0.176, 0.157, 0.118,
+                                                                        0.094, 0.027, 0.000, 0.000, 0.000};
+
+/* arguments passed to the column block worker threads */
+struct mb_shade_work_struct {
+	const struct mb_shade_struct *shade;
+	int column_start;
+	int column_end;
+	int n_columns;
+	int n_rows;
+	float nodatavalue;
+	const float *data;
+	const float *x;
+	const float *y;
+	double dx;
+	double dy;
+	float *dzdx;
+	float *dzdy;
+	float *r;
+	float *g;
+	float *b;
+	bool slope;
+	double min;
+	double dhist;
+	int *binned_counts;
+	int nbinned;
+	int nbinnedneg;
+	int nbinnedpos;
+};
+
+/*--------------------------------------------------------------------*/
+/* Divide the columns [column_start, column_end) among the threads and
+   run the worker on each block, running the last block in the calling
+   thread. Each thread is given at least MB_SHADE_THREAD_CELLS cells so
+   that small grids and column blocks are processed without starting
+   threads. The work structures must have been initialized by the caller
+   except for the column bounds. */
+static void mb_shade_run(int nthreads, int column_start, int column_end, int n_rows, void *(*worker)(void *),
+                         struct mb_shade_work_struct *work) {
+	const int ncolumns = column_end - column_start;
+	const long ncells = (long)ncolumns * n_rows;
+	nthreads = MIN(mb_nthreads(nthreads), MAX(ncolumns, 1));
+	nthreads = (int)MIN((long)nthreads, MAX(ncells / MB_SHADE_THREAD_CELLS, 1));
+	pthread_t threads[MB_THREAD_MAX];
+	bool started[MB_THREAD_MAX];
+	for (int ithread = 0; ithread < nthreads; ithread++) {
+		work[ithread].column_start = column_start + (int)(((long)ncolumns * ithread) / nthreads);
+		work[ithread].column_end = column_start + (int)(((long)ncolumns * (ithread + 1)) / nthreads);
+		started[ithread] = false;
+	}
+	for (int ithread = 0; ithread < nthreads - 1; ithread++) {
+		if (pthread_create(&threads[ithread], NULL, worker, &work[ithread]) == 0)
+			started[ithread] = true;
+		else
+			(*worker)(&work[ithread]);
+	}
+	(*worker)(&work[nthreads - 1]);
+	for (int ithread = 0; ithread < nthreads - 1; ithread++) {
+		if (started[ithread])
+			pthread_join(threads[ithread], NULL);
+	}
+}
+/*--------------------------------------------------------------------*/
+int mb_shade_setup(int verbose, struct mb_shade_struct *shade, int *error) {
+	if (verbose >= 2) {
+		fprintf(stderr, "\ndbg2  MBIO function <%s> called\n", __func__);
+		fprintf(stderr, "dbg2  Input arguments:\n");
+		fprintf(stderr, "dbg2       verbose:                   %d\n", verbose);
+		fprintf(stderr, "dbg2       shade:                     %p\n", shade);
+		fprintf(stderr, "dbg2       shade->nthreads:           %d\n", shade->nthreads);
+		fprintf(stderr, "dbg2       shade->colortable:         %d\n", shade->colortable);
+		fprintf(stderr, "dbg2       shade->colortable_mode:    %d\n", shade->colortable_mode);
+		fprintf(stderr, "dbg2       shade->color_slope:        %d\n", shade->color_slope);
+		fprintf(stderr, "dbg2       shade->use_histogram:      %d\n", shade->use_histogram);
+		fprintf(stderr, "dbg2       shade->min:                %f\n", shade->min);
+		fprintf(stderr, "dbg2       shade->max:                %f\n", shade->max);
+		fprintf(stderr, "dbg2       shade->shade_mode:         %d\n", shade->shade_mode);
+		fprintf(stderr, "dbg2       shade->illuminate_magnitude: %f\n", shade->illuminate_magnitude);
+		fprintf(stderr, "dbg2       shade->illuminate_elevation: %f\n", shade->illuminate_elevation);
+		fprintf(stderr, "dbg2       shade->illuminate_azimuth:   %f\n", shade->illuminate_azimuth);
+		fprintf(stderr, "dbg2       shade->slope_magnitude:    %f\n", shade->slope_magnitude);
+		fprintf(stderr, "dbg2       shade->scale:              %f\n", shade->scale);
+	}
+
+	/* get illumination vector */
+	shade->illum_x = 0.0;
+	shade->illum_y = 0.0;
+	shade->illum_z = 0.0;
+	shade->mag2 = 0.0;
+	if (shade->shade_mode == MB_SHADE_ILLUMINATION) {
+		shade->illum_x = sin(DTR * shade->illuminate_azimuth) * cos(DTR * shade->illuminate_elevation);
+		shade->illum_y = cos(DTR * shade->illuminate_azimuth) * cos(DTR * shade->illuminate_elevation);
+		shade->illum_z = sin(DTR * shade->illuminate_elevation);
+		shade->mag2 = shade->illuminate_magnitude * shade->illuminate_magnitude;
+	}
+
+	/* get colortable */
+	if (shade->colortable == MB_SHADE_COLORTABLE_BRIGHT) {
+		shade->colortable_red = mb_shade_bright_red;
+		shade->colortable_green = mb_shade_bright_green;
+		shade->colortable_blue = mb_shade_bright_blue;
+	}
+	else if (shade->colortable == MB_SHADE_COLORTABLE_MUTED) {
+		shade->colortable_red = mb_shade_muted_red;
+		shade->colortable_green = mb_shade_muted_green;
+		shade->colortable_blue = mb_shade_muted_blue;
+	}
+	else if (shade->colortable == MB_SHADE_COLORTABLE_GRAY) {
+		shade->colortable_red = mb_shade_gray_red;
+		shade->colortable_green = mb_shade_gray_green;
+		shade->colortable_blue = mb_shade_gray_blue;
+	}
+	else if (shade->colortable == MB_SHADE_COLORTABLE_FLAT) {
+		shade->colortable_red = mb_shade_flat_red;
+		shade->colortable_green = mb_shade_flat_green;
+		shade->colortable_blue = mb_shade_flat_blue;
+	}
+	else {
+		shade->colortable_red = mb_shade_haxby_red;
+		shade->colortable_green = mb_shade_haxby_green;
+		shade->colortable_blue = mb_shade_haxby_blue;
+	}
+
+	const int status = MB_SUCCESS;
+	*error = MB_ERROR_NO_ERROR;
+
+	if (verbose >= 2) {
+		fprintf(stderr, "\ndbg2  MBIO function <%s> completed\n", __func__);
+		fprintf(stderr, "dbg2  Return values:\n");
+		fprintf(stderr, "dbg2       shade->illum_x:            %f\n", shade->illum_x);
+		fprintf(stderr, "dbg2       shade->illum_y:            %f\n", shade->illum_y);
+		fprintf(stderr, "dbg2       shade->illum_z:            %f\n", shade->illum_z);
+		fprintf(stderr, "dbg2       shade->mag2:               %f\n", shade->mag2);
+		fprintf(stderr, "dbg2       error:                     %d\n", *error);
+		fprintf(stderr, "dbg2  Return status:\n");
+		fprintf(stderr, "dbg2       status:                    %d\n", status);
+	}
+
+	return (status);
+}
+/*--------------------------------------------------------------------*/
+static void *mb_shade_derivative_worker(void *arg) {
+	struct mb_shade_work_struct *work = (struct mb_shade_work_struct *)arg;
+	const int n_columns = work->n_columns;
+	const int n_rows = work->n_rows;
+	const float nodata = work->nodatavalue;
+	const float *data = work->data;
+	const double scale = work->shade->scale;
+
+	for (int i = work->column_start; i < work->column_end; i++) {
+		for (int j = 0; j < n_rows; j++) {
+			const int k = i * n_rows + j;
+			int k1, k2;
+			bool derivative_ok;
+
+			/* x derivative - use centered difference where possible,
+			   otherwise a one sided difference */
+			derivative_ok = false;
+			k1 = (i > 0) ? k - n_rows : k;
+			k2 = (i < n_columns - 1) ? k + n_rows : k;
+			if (k1 != k2 && data[k1] != nodata && data[k2] != nodata)
+				derivative_ok = true;
+			else if (k1 != k && data[k1] != nodata && data[k] != nodata) {
+				derivative_ok = true;
+				k2 = k;
+			}
+			else if (k2 != k && data[k] != nodata && data[k2] != nodata) {
+				derivative_ok = true;
+				k1 = k;
+			}
+			work->dzdx[k] = 0.0;
+			if (derivative_ok) {
+				const double dx = (work->x != NULL) ? (work->x[k2] - work->x[k1]) : ((k2 - k1) / n_rows) * work->dx;
+				if (dx != 0.0)
+					work->dzdx[k] = scale * (data[k2] - data[k1]) / dx;
+			}
+
+			/* y derivative */
+			derivative_ok = false;
+			k1 = (j > 0) ? k - 1 : k;
+			k2 = (j < n_rows - 1) ? k + 1 : k;
+			if (k1 != k2 && data[k1] != nodata && data[k2] != nodata)
+				derivative_ok = true;
+			else if (k1 != k && data[k1] != nodata && data[k] != nodata) {
+				derivative_ok = true;
+				k2 = k;
+			}
+			else if (k2 != k && data[k] != nodata && data[k2] != nodata) {
+				derivative_ok = true;
+				k1 = k;
+			}
+			work->dzdy[k] = 0.0;
+			if (derivative_ok) {
+				const double dy = (work->y != NULL) ? (work->y[k2] - work->y[k1]) : (k2 - k1) * work->dy;
+				if (dy != 0.0)
+					work->dzdy[k] = scale * (data[k2] - data[k1]) / dy;
+			}
+		}
+	}
+
+	return (NULL);
+}
+/*--------------------------------------------------------------------*/
+int mb_shade_derivative(int verbose, const struct mb_shade_struct *shade, int n_columns, int n_rows, int column_start,
+                        int column_end, float nodatavalue, const float *data, const float *x, const float *y, double dx,
+                        double dy, float *dzdx, float *dzdy, int *error) {
+	if (verbose >= 2) {
+		fprintf(stderr, "\ndbg2  MBIO function <%s> called\n", __func__);
+		fprintf(stderr, "dbg2  Input arguments:\n");
+		fprintf(stderr, "dbg2       verbose:                   %d\n", verbose);
+		fprintf(stderr, "dbg2       shade:                     %p\n", shade);
+		fprintf(stderr, "dbg2       n_columns:                 %d\n", n_columns);
+		fprintf(stderr, "dbg2       n_rows:                    %d\n", n_rows);
+		fprintf(stderr, "dbg2       column_start:              %d\n", column_start);
+		fprintf(stderr, "dbg2       column_end:                %d\n", column_end);
+		fprintf(stderr, "dbg2       nodatavalue:               %f\n", nodatavalue);
+		fprintf(stderr, "dbg2       data:                      %p\n", data);
+		fprintf(stderr, "dbg2       x:                         %p\n", x);
+		fprintf(stderr, "dbg2       y:                         %p\n", y);
+		fprintf(stderr, "dbg2       dx:                        %f\n", dx);
+		fprintf(stderr, "dbg2       dy:                        %f\n", dy);
+		fprintf(stderr, "dbg2       dzdx:                      %p\n", dzdx);
+		fprintf(stderr, "dbg2       dzdy:                      %p\n", dzdy);
+	}
+
+	column_start = MAX(column_start, 0);
+	column_end = MIN(column_end, n_columns);
+	if (column_end > column_start && n_rows > 0) {
+		struct mb_shade_work_struct work[MB_THREAD_MAX];
+		memset(work, 0, sizeof(work));
+		for (int ithread = 0; ithread < MB_THREAD_MAX; ithread++) {
+			work[ithread].shade = shade;
+			work[ithread].n_columns = n_columns;
+			work[ithread].n_rows = n_rows;
+			work[ithread].nodatavalue = nodatavalue;
+			work[ithread].data = data;
+			work[ithread].x = x;
+			work[ithread].y = y;
+			work[ithread].dx = dx;
+			work[ithread].dy = dy;
+			work[ithread].dzdx = dzdx;
+			work[ithread].dzdy = dzdy;
+		}
+		mb_shade_run(shade->nthreads, column_start, column_end, n_rows, mb_shade_derivative_worker, work);
+	}
+
+	const int status = MB_SUCCESS;
+	*error = MB_ERROR_NO_ERROR;
+
+	if (verbose >= 2) {
+		fprintf(stderr, "\ndbg2  MBIO function <%s> completed\n", __func__);
+		fprintf(stderr, "dbg2  Return values:\n");
+		fprintf(stderr, "dbg2       error:                     %d\n", *error);
+		fprintf(stderr, "dbg2  Return status:\n");
+		fprintf(stderr, "dbg2       status:                    %d\n", status);
+	}
+
+	return (status);
+}
+/*--------------------------------------------------------------------*/
+static void *mb_shade_histogram_worker(void *arg) {
+	struct mb_shade_work_struct *work = (struct mb_shade_work_struct *)arg;
+	const int n_rows = work->n_rows;
+	const float nodata = work->nodatavalue;
+	const int bindimminusone = MB_SHADE_HISTOGRAM_DIM - 1;
+
+	memset(work->binned_counts, 0, MB_SHADE_HISTOGRAM_DIM * sizeof(int));
+	work->nbinned = 0;
+	work->nbinnedneg = 0;
+	work->nbinnedpos = 0;
+	const int kstart = work->column_start * n_rows;
+	const int kend = work->column_end * n_rows;
+	for (int k = kstart; k < kend; k++) {
+		if (work->data[k] != nodata) {
+			float value;
+			if (work->slope)
+				value = sqrt(work->dzdx[k] * work->dzdx[k] + work->dzdy[k] * work->dzdy[k]);
+			else
+				value = work->data[k];
+			const int jbin = (value - work->min) / work->dhist;
+			if (jbin >= 0 && jbin <= bindimminusone) {
+				work->binned_counts[jbin]++;
+				work->nbinned++;
+				if (!work->slope && value < 0.0)
+					work->nbinnedneg++;
+				else
+					work->nbinnedpos++;
+			}
+		}
+	}
+
+	return (NULL);
+}
+/*--------------------------------------------------------------------*/
+int mb_shade_histogram(int verbose, int nthreads, int n_columns, int n_rows, float nodatavalue, const float *data,
+                       const float *dzdx, const float *dzdy, bool slope, double min, double max, float *histogram,
+                       int *error) {
+	if (verbose >= 2) {
+		fprintf(stderr, "\ndbg2  MBIO function <%s> called\n", __func__);
+		fprintf(stderr, "dbg2  Input arguments:\n");
+		fprintf(stderr, "dbg2       verbose:                   %d\n", verbose);
+		fprintf(stderr, "dbg2       nthreads:                  %d\n", nthreads);
+		fprintf(stderr, "dbg2       n_columns:                 %d\n", n_columns);
+		fprintf(stderr, "dbg2       n_rows:                    %d\n", n_rows);
+		fprintf(stderr, "dbg2       nodatavalue:               %f\n", nodatavalue);
+		fprintf(stderr, "dbg2       data:                      %p\n", data);
+		fprintf(stderr, "dbg2       dzdx:                      %p\n", dzdx);
+		fprintf(stderr, "dbg2       dzdy:                      %p\n", dzdy);
+		fprintf(stderr, "dbg2       slope:                     %d\n", slope);
+		fprintf(stderr, "dbg2       min:                       %f\n", min);
+		fprintf(stderr, "dbg2       max:                       %f\n", max);
+		fprintf(stderr, "dbg2       histogram:                 %p\n", histogram);
+	}
+
+	const float dhist = (max - min) / (MB_SHADE_HISTOGRAM_DIM - 1);
+
+	/* initialize histograms */
+	for (int i = 0; i < 3 * MB_SHADE_NUM_COLORS; i++)
+		histogram[i] = 0.0;
+
+	/* bin the values in column blocks and then merge the per-thread bins */
+	int *thread_counts = NULL;
+	int status = mb_mallocd(verbose, __FILE__, __LINE__, MB_THREAD_MAX * MB_SHADE_HISTOGRAM_DIM * sizeof(int),
+	                        (void **)&thread_counts, error);
+	if (status != MB_SUCCESS)
+		return (status);
+	memset(thread_counts, 0, MB_THREAD_MAX * MB_SHADE_HISTOGRAM_DIM * sizeof(int));
+	struct mb_shade_work_struct work[MB_THREAD_MAX];
+	memset(work, 0, sizeof(work));
+	for (int ithread = 0; ithread < MB_THREAD_MAX; ithread++) {
+		work[ithread].binned_counts = &thread_counts[ithread * MB_SHADE_HISTOGRAM_DIM];
+		work[ithread].n_columns = n_columns;
+		work[ithread].n_rows = n_rows;
+		work[ithread].nodatavalue = nodatavalue;
+		work[ithread].data = data;
+		work[ithread].dzdx = (float *)dzdx;
+		work[ithread].dzdy = (float *)dzdy;
+		work[ithread].slope = slope;
+		work[ithread].min = min;
+		work[ithread].dhist = dhist;
+	}
+	if (dhist > 0.0)
+		mb_shade_run(nthreads, 0, n_columns, n_rows, mb_shade_histogram_worker, work);
+	int binned_counts[MB_SHADE_HISTOGRAM_DIM];
+	int nbinned = 0;
+	int nbinnedneg = 0;
+	int nbinnedpos = 0;
+	memset(binned_counts, 0, sizeof(binned_counts));
+	for (int ithread = 0; ithread < MB_THREAD_MAX; ithread++) {
+		for (int jbin = 0; jbin < MB_SHADE_HISTOGRAM_DIM; jbin++)
+			binned_counts[jbin] += work[ithread].binned_counts[jbin];
+		nbinned += work[ithread].nbinned;
+		nbinnedneg += work[ithread].nbinnedneg;
+		nbinnedpos += work[ithread].nbinnedpos;
+	}
+	mb_freed(verbose, __FILE__, __LINE__, (void **)&thread_counts, error);
+
+	/* construct histogram equalization for full data range */
+	histogram[0] = min;
+	histogram[MB_SHADE_NUM_COLORS - 1] = max;
+	int binnedsum = 0;
+	int khist = 1;
+	for (int jbin = 0; jbin < MB_SHADE_HISTOGRAM_DIM; jbin++) {
+		const int target = (khist * nbinned) / (MB_SHADE_NUM_COLORS - 1);
+		binnedsum += binned_counts[jbin];
+		if (binnedsum >= target && khist < MB_SHADE_NUM_COLORS - 1) {
+			histogram[khist] = min + jbin * dhist;
+			khist++;
+		}
+	}
+
+	/* the bin containing zero, clipped to the binned range */
+	int jbinzero = (dhist > 0.0) ? (int)(-min / dhist) : 0;
+	jbinzero = MAX(0, MIN(jbinzero, MB_SHADE_HISTOGRAM_DIM - 1));
+
+	/* construct histogram equalization for data < 0.0 */
+	if (nbinnedneg > MB_SHADE_NUM_COLORS) {
+		histogram[MB_SHADE_NUM_COLORS] = MIN(0.0, min);
+		histogram[2 * MB_SHADE_NUM_COLORS - 1] = MIN(0.0, max);
+		binnedsum = 0;
+		khist = 1;
+		for (int jbin = 0; jbin < jbinzero; jbin++) {
+			const int target = (khist * nbinnedneg) / (MB_SHADE_NUM_COLORS - 1);
+			binnedsum += binned_counts[jbin];
+			if (binnedsum >= target && khist < MB_SHADE_NUM_COLORS - 1) {
+				histogram[MB_SHADE_NUM_COLORS + khist] = min + jbin * dhist;
+				khist++;
+			}
+		}
+	}
+
+	/* construct histogram equalization for data >= 0.0 */
+	if (nbinnedpos > MB_SHADE_NUM_COLORS) {
+		histogram[2 * MB_SHADE_NUM_COLORS] = MAX(0.0, min);
+		histogram[3 * MB_SHADE_NUM_COLORS - 1] = MAX(0.0, max);
+		binnedsum = 0;
+		khist = 1;
+		for (int jbin = jbinzero; jbin < MB_SHADE_HISTOGRAM_DIM; jbin++) {
+			const int target = (khist * nbinnedpos) / (MB_SHADE_NUM_COLORS - 1);
+			binnedsum += binned_counts[jbin];
+			if (binnedsum >= target && khist < MB_SHADE_NUM_COLORS - 1) {
+				histogram[2 * MB_SHADE_NUM_COLORS + khist] = min + jbin * dhist;
+				khist++;
+			}
+		}
+	}
+
+	status = MB_SUCCESS;
+	*error = MB_ERROR_NO_ERROR;
+
+	if (verbose >= 2) {
+		fprintf(stderr, "\ndbg2  MBIO function <%s> completed\n", __func__);
+		fprintf(stderr, "dbg2  Return values:\n");
+		for (int i = 0; i < 3 * MB_SHADE_NUM_COLORS; i++)
+			fprintf(stderr, "dbg2       histogram[%d]:   %f\n", i, histogram[i]);
+		fprintf(stderr, "dbg2       error:                     %d\n", *error);
+		fprintf(stderr, "dbg2  Return status:\n");
+		fprintf(stderr, "dbg2       status:                    %d\n", status);
+	}
+
+	return (status);
+}
+/*--------------------------------------------------------------------*/
+int mb_shade_getcolor(double value, double min, double max, int colortablemode, float below_red, float below_green,
+                      float below_blue, float above_red, float above_green, float above_blue, const float *colortable_red,
+                      const float *colortable_green, const float *colortable_blue, float *red, float *green, float *blue) {
+	double factor;
+	if (max <= min)
+		factor = 0.5;
+	else if (colortablemode == MB_SHADE_COLORTABLE_NORMAL)
+		factor = (max - value) / (max - min);
+	else
+		factor = (value - min) / (max - min);
+	if (factor >= 1.0) {
+		*red = above_red;
+		*green = above_green;
+		*blue = above_blue;
+	}
+	else if (factor <= 0.0) {
+		*red = below_red;
+		*green = below_green;
+		*blue = below_blue;
+	}
+	else {
+		const int i = (int)(factor * (MB_SHADE_NUM_COLORS - 1));
+		const double ff = factor * (MB_SHADE_NUM_COLORS - 1) - i;
+		*red = colortable_red[i] + ff * (colortable_red[i + 1] - colortable_red[i]);
+		*green = colortable_green[i] + ff * (colortable_green[i + 1] - colortable_green[i]);
+		*blue = colortable_blue[i] + ff * (colortable_blue[i + 1] - colortable_blue[i]);
+	}
+
+	return (MB_SUCCESS);
+}
+/*--------------------------------------------------------------------*/
+int mb_shade_getcolor_histogram(double value, double min, double max, int colortablemode, float below_red,
+                                float below_green, float below_blue, float above_red, float above_green, float above_blue,
+                                const float *colortable_red, const float *colortable_green, const float *colortable_blue,
+                                const float *histogram, float *red, float *green, float *blue) {
+	double factor;
+	if (colortablemode == MB_SHADE_COLORTABLE_NORMAL)
+		factor = (max - value) / (max - min);
+	else
+		factor = (value - min) / (max - min);
+	if (factor <= 0.0) {
+		*red = below_red;
+		*green = below_green;
+		*blue = below_blue;
+	}
+	else if (factor >= 1.0) {
+		*red = above_red;
+		*green = above_green;
+		*blue = above_blue;
+	}
+	else {
+		/* find place in histogram */
+		int ii = 0;
+		bool found = false;
+		for (int i = 0; i < MB_SHADE_NUM_COLORS - 1 && !found; i++) {
+			if (value >= histogram[i] && value <= histogram[i + 1]) {
+				ii = i;
+				found = true;
+			}
+		}
+
+		/* get color */
+		double ff;
+		if (colortablemode == MB_SHADE_COLORTABLE_NORMAL) {
+			ff = (histogram[ii + 1] - value) / (histogram[ii + 1] - histogram[ii]);
+			ii = MB_SHADE_NUM_COLORS - 2 - ii;
+		}
+		else {
+			ff = (value - histogram[ii]) / (histogram[ii + 1] - histogram[ii]);
+		}
+		*red = colortable_red[ii] + ff * (colortable_red[ii + 1] - colortable_red[ii]);
+		*green = colortable_green[ii] + ff * (colortable_green[ii + 1] - colortable_green[ii]);
+		*blue = colortable_blue[ii] + ff * (colortable_blue[ii + 1] - colortable_blue[ii]);
+	}
+
+	return (MB_SUCCESS);
+}
+/*--------------------------------------------------------------------*/
+/* Colortable, range and histogram used for the values on one side of
+   sealevel. The sealevel colortables use a land colortable above zero
+   and haxby below, the other colortables use the same side for all
+   values. */
+struct mb_shade_colorside_struct {
+	double min;
+	double max;
+	float below[3];
+	float above[3];
+	const float *ct[3];
+	const float *histogram;
+};
+static void mb_shade_colorsides(const struct mb_shade_struct *shade, struct mb_shade_colorside_struct side[2]) {
+	const float *histogram = shade->use_histogram ? shade->histogram : NULL;
+	const int nminusone = MB_SHADE_NUM_COLORS - 1;
+
+	/* ordinary colortables - slope coloring goes from blue to red outside
+	   the colortable range */
+	if (shade->colortable < MB_SHADE_COLORTABLE_SEALEVEL1) {
+		side[0].min = shade->min;
+		side[0].max = shade->max;
+		side[0].ct[0] = shade->colortable_red;
+		side[0].ct[1] = shade->colortable_green;
+		side[0].ct[2] = shade->colortable_blue;
+		for (int c = 0; c < 3; c++) {
+			side[0].below[c] = shade->color_slope ? (c == 2 ? 1.0 : 0.0) : side[0].ct[c][0];
+			side[0].above[c] = shade->color_slope ? (c == 0 ? 1.0 : 0.0) : side[0].ct[c][nminusone];
+		}
+		side[0].histogram = histogram;
+		side[1] = side[0];
+		return;
+	}
+
+	/* sealevel colortables */
+	const float *land[3] = {mb_shade_abovesealevel1_red, mb_shade_abovesealevel1_green, mb_shade_abovesealevel1_blue};
+	if (shade->colortable == MB_SHADE_COLORTABLE_SEALEVEL2) {
+		land[0] = mb_shade_abovesealevel2_red;
+		land[1] = mb_shade_abovesealevel2_green;
+		land[2] = mb_shade_abovesealevel2_blue;
+	}
+	const float *haxby[3] = {mb_shade_haxby_red, mb_shade_haxby_green, mb_shade_haxby_blue};
+
+	/* values <= 0 */
+	const bool reversed = shade->colortable_mode == MB_SHADE_COLORTABLE_REVERSED;
+	side[0].min = shade->min;
+	side[0].max = reversed ? 0.0 : -shade->min / 11.0;
+	for (int c = 0; c < 3; c++)
+		side[0].ct[c] = reversed ? land[c] : haxby[c];
+	side[0].histogram = (histogram != NULL) ? &histogram[MB_SHADE_NUM_COLORS] : NULL;
+
+	/* values > 0 */
+	const bool normal = shade->colortable_mode == MB_SHADE_COLORTABLE_NORMAL;
+	side[1].min = normal ? 0.0 : -shade->max / 11.0;
+	side[1].max = shade->max;
+	for (int c = 0; c < 3; c++)
+		side[1].ct[c] = normal ? land[c] : haxby[c];
+	side[1].histogram = (histogram != NULL) ? &histogram[2 * MB_SHADE_NUM_COLORS] : NULL;
+
+	for (int iside = 0; iside < 2; iside++) {
+		for (int c = 0; c < 3; c++) {
+			side[iside].below[c] = side[iside].ct[c][0];
+			side[iside].above[c] = side[iside].ct[c][nminusone];
+		}
+	}
+}
+/*--------------------------------------------------------------------*/
+/* Array version of mb_shade_colorvalue(). The colortable side, range
+   and histogram interval are chosen for each value by selection rather
+   than by branching so that the loops can be vectorized, giving the
+   same colors as mb_shade_getcolor() and mb_shade_getcolor_histogram(). */
+void mb_shade_colorvalue_block(const struct mb_shade_struct *shade, int n, const double *restrict value, float *restrict r,
+                               float *restrict g, float *restrict b) {
+	struct mb_shade_colorside_struct side[2];
+	mb_shade_colorsides(shade, side);
+	const bool normal = shade->colortable_mode == MB_SHADE_COLORTABLE_NORMAL;
+	const int nminusone = MB_SHADE_NUM_COLORS - 1;
+
+	if (side[0].histogram == NULL) {
+		for (int l = 0; l < n; l++) {
+			const struct mb_shade_colorside_struct *cs = &side[value[l] > 0.0];
+			const double range = cs->max - cs->min;
+			double factor = normal ? (cs->max - value[l]) / range : (value[l] - cs->min) / range;
+			factor = (range > 0.0) ? factor : 0.5;
+			const double fi = MAX(0.0, MIN(factor, 1.0)) * nminusone;
+			const int i = MIN((int)fi, nminusone - 1);
+			const double ff = fi - i;
+			const float cr = cs->ct[0][i] + ff * (cs->ct[0][i + 1] - cs->ct[0][i]);
+			const float cg = cs->ct[1][i] + ff * (cs->ct[1][i + 1] - cs->ct[1][i]);
+			const float cb = cs->ct[2][i] + ff * (cs->ct[2][i + 1] - cs->ct[2][i]);
+			r[l] = (factor >= 1.0) ? cs->above[0] : ((factor <= 0.0) ? cs->below[0] : cr);
+			g[l] = (factor >= 1.0) ? cs->above[1] : ((factor <= 0.0) ? cs->below[1] : cg);
+			b[l] = (factor >= 1.0) ? cs->above[2] : ((factor <= 0.0) ? cs->below[2] : cb);
+		}
+	}
+	else {
+		for (int l = 0; l < n; l++) {
+			const struct mb_shade_colorside_struct *cs = &side[value[l] > 0.0];
+			const double v = value[l];
+			const double factor = normal ? (cs->max - v) / (cs->max - cs->min) : (v - cs->min) / (cs->max - cs->min);
+
+			/* first histogram interval containing the value */
+			const float *h = cs->histogram;
+			int ii = 0;
+			for (int i = nminusone - 1; i >= 0; i--)
+				ii = (v >= h[i] && v <= h[i + 1]) ? i : ii;
+
+			/* get color */
+			const double ff = normal ? (h[ii + 1] - v) / (h[ii + 1] - h[ii]) : (v - h[ii]) / (h[ii + 1] - h[ii]);
+			const int i = normal ? nminusone - 1 - ii : ii;
+			const float cr = cs->ct[0][i] + ff * (cs->ct[0][i + 1] - cs->ct[0][i]);
+			const float cg = cs->ct[1][i] + ff * (cs->ct[1][i + 1] - cs->ct[1][i]);
+			const float cb = cs->ct[2][i] + ff * (cs->ct[2][i + 1] - cs->ct[2][i]);
+			r[l] = (factor <= 0.0) ? cs->below[0] : ((factor >= 1.0) ? cs->above[0] : cr);
+			g[l] = (factor <= 0.0) ? cs->below[1] : ((factor >= 1.0) ? cs->above[1] : cg);
+			b[l] = (factor <= 0.0) ? cs->below[2] : ((factor >= 1.0) ? cs->above[2] : cb);
+		}
+	}
+}
+/*--------------------------------------------------------------------*/
+int mb_shade_colorvalue(const struct mb_shade_struct *shade, double value, float *r, float *g, float *b) {
+	mb_shade_colorvalue_block(shade, 1, &value, r, g, b);
+
+	return (MB_SUCCESS);
+}
+/*--------------------------------------------------------------------*/
+int mb_shade_applyshade(double intensity, float *r, float *g, float *b) {
+	/* note - this correction algorithm is taken from the GMT Technical
+	   Reference and Cookbook by Wessel and Smith - you can find it in
+	   Appendix I: Color Space - The final frontier */
+
+	/* change the initial rgb into hsv space */
+	const double vmax = MAX(MAX(*r, *g), *b);
+	const double vmin = MIN(MIN(*r, *g), *b);
+	const double dv = vmax - vmin;
+	double v = vmax;
+	double s = (vmax == 0.0) ? 0.0 : dv / vmax;
+	double h = 0.0;
+	if (s > 0.0) {
+		const double idv = 1.0 / dv;
+		const double rmod = (vmax - *r) * idv;
+		const double gmod = (vmax - *g) * idv;
+		const double bmod = (vmax - *b) * idv;
+		if (*r == vmax)
+			h = bmod - gmod;
+		else if (*g == vmax)
+			h = 2.0 + rmod - bmod;
+		else
+			h = 4.0 + gmod - rmod;
+		h *= 60.0;
+		if (h < 0.0)
+			h += 360.0;
+	}
+
+	/* apply the shade to the color */
+	if (intensity > 0) {
+		if (s != 0.0)
+			s = (1.0 - intensity) * s + intensity * 0.1;
+		v = (1.0 - intensity) * v + intensity;
+	}
+	else {
+		if (s != 0.0)
+			s = (1.0 + intensity) * s - intensity;
+		v = (1.0 + intensity) * v - intensity * 0.3;
+	}
+	v = MAX(0.0, MIN(v, 1.0));
+	s = MAX(0.0, MIN(s, 1.0));
+
+	/* change the corrected hsv values back into rgb */
+	if (s == 0.0) {
+		*r = v;
+		*g = v;
+		*b = v;
+	}
+	else {
+		while (h >= 360.0)
+			h -= 360.0;
+		h /= 60.0;
+		const double f = h - ((int)h);
+		const double p = v * (1.0 - s);
+		const double q = v * (1.0 - (s * f));
+		const double t = v * (1.0 - (s * (1.0 - f)));
+		switch (((int)h)) {
+		case 0:
+			*r = v;
+			*g = t;
+			*b = p;
+			break;
+		case 1:
+			*r = q;
+			*g = v;
+			*b = p;
+			break;
+		case 2:
+			*r = p;
+			*g = v;
+			*b = t;
+			break;
+		case 3:
+			*r = p;
+			*g = q;
+			*b = v;
+			break;
+		case 4:
+			*r = t;
+			*g = p;
+			*b = v;
+			break;
+		case 5:
+			*r = v;
+			*g = p;
+			*b = q;
+			break;
+		}
+	}
+
+	return (MB_SUCCESS);
+}
+/*--------------------------------------------------------------------*/
+/* Branch free version of mb_shade_applyshade() operating on arrays so
+   that the loop can be vectorized. The hsv to rgb conversion uses the
+   closed form c = v - v s max(0, min(k, 4 - k, 1)) with
+   k = (n + h / 60) mod 6 and n = 5, 3, 1 for red, green and blue,
+   which is equivalent to the sector switch in the scalar version. */
+void mb_shade_applyshade_block(int n, const float *restrict intensity, float *restrict r, float *restrict g,
+                               float *restrict b) {
+	for (int i = 0; i < n; i++) {
+		const float rr = r[i];
+		const float gg = g[i];
+		const float bb = b[i];
+		const float in = intensity[i];
+
+		/* rgb to hsv */
+		const float vmax = fmaxf(fmaxf(rr, gg), bb);
+		const float vmin = fminf(fminf(rr, gg), bb);
+		const float dv = vmax - vmin;
+		float v = vmax;
+		float s = (vmax > 0.0f) ? dv / vmax : 0.0f;
+		const float idv = (dv > 0.0f) ? 1.0f / dv : 0.0f;
+		const float rmod = (vmax - rr) * idv;
+		const float gmod = (vmax - gg) * idv;
+		const float bmod = (vmax - bb) * idv;
+		float h = (rr == vmax) ? (bmod - gmod) : ((gg == vmax) ? (2.0f + rmod - bmod) : (4.0f + gmod - rmod));
+		h = (h < 0.0f) ? h + 6.0f : h;
+
+		/* apply the shade */
+		const bool brighten = in > 0.0f;
+		const float sshaded = brighten ? (1.0f - in) * s + in * 0.1f : (1.0f + in) * s - in;
+		s = (s != 0.0f) ? sshaded : 0.0f;
+		v = brighten ? (1.0f - in) * v + in : (1.0f + in) * v - in * 0.3f;
+		v = fminf(fmaxf(v, 0.0f), 1.0f);
+		s = fminf(fmaxf(s, 0.0f), 1.0f);
+
+		/* hsv to rgb */
+		const float vs = v * s;
+		float kr = 5.0f + h;
+		float kg = 3.0f + h;
+		float kb = 1.0f + h;
+		kr = (kr >= 6.0f) ? kr - 6.0f : kr;
+		kg = (kg >= 6.0f) ? kg - 6.0f : kg;
+		kb = (kb >= 6.0f) ? kb - 6.0f : kb;
+		r[i] = v - vs * fmaxf(0.0f, fminf(fminf(kr, 4.0f - kr), 1.0f));
+		g[i] = v - vs * fmaxf(0.0f, fminf(fminf(kg, 4.0f - kg), 1.0f));
+		b[i] = v - vs * fmaxf(0.0f, fminf(fminf(kb, 4.0f - kb), 1.0f));
+	}
+}
+/*--------------------------------------------------------------------*/
+static void *mb_shade_grid_worker(void *arg) {
+	struct mb_shade_work_struct *work = (struct mb_shade_work_struct *)arg;
+	const struct mb_shade_struct *shade = work->shade;
+	const int n_rows = work->n_rows;
+	const float nodata = work->nodatavalue;
+	const float *data = work->data;
+	const float *dzdx = work->dzdx;
+	const float *dzdy = work->dzdy;
+	double value[MB_SHADE_BLOCK];
+	float intensity[MB_SHADE_BLOCK];
+
+	const int kstart = work->column_start * n_rows;
+	const int kend = work->column_end * n_rows;
+	for (int kblock = kstart; kblock < kend; kblock += MB_SHADE_BLOCK) {
+		const int nblock = MIN(MB_SHADE_BLOCK, kend - kblock);
+		float *r = &work->r[kblock];
+		float *g = &work->g[kblock];
+		float *b = &work->b[kblock];
+
+		/* get the colors */
+		if (shade->color_slope) {
+			for (int l = 0; l < nblock; l++) {
+				const int k = kblock + l;
+				value[l] = sqrt(dzdx[k] * dzdx[k] + dzdy[k] * dzdy[k]);
+			}
+		}
+		else {
+			for (int l = 0; l < nblock; l++)
+				value[l] = data[kblock + l];
+		}
+		mb_shade_colorvalue_block(shade, nblock, value, r, g, b);
+
+		/* get the shading intensities */
+		if (shade->shade_mode == MB_SHADE_ILLUMINATION) {
+			const float mag = shade->illuminate_magnitude;
+			const float mag2 = shade->mag2;
+			const float ix = shade->illum_x;
+			const float iy = shade->illum_y;
+			const float iz = shade->illum_z;
+			for (int l = 0; l < nblock; l++) {
+				const float ddx = dzdx[kblock + l];
+				const float ddy = dzdy[kblock + l];
+				const float dd = sqrtf(mag2 * ddx * ddx + mag2 * ddy * ddy + 1.0f);
+				intensity[l] = (mag * ix * ddx + mag * iy * ddy + iz) / dd - 0.5f;
+			}
+		}
+		else if (shade->shade_mode == MB_SHADE_SLOPE) {
+			const float mag = shade->slope_magnitude;
+			for (int l = 0; l < nblock; l++) {
+				const float ddx = dzdx[kblock + l];
+				const float ddy = dzdy[kblock + l];
+				intensity[l] = fmaxf(-mag * sqrtf(ddx * ddx + ddy * ddy), -1.0f);
+			}
+		}
+		if (shade->shade_mode == MB_SHADE_ILLUMINATION || shade->shade_mode == MB_SHADE_SLOPE)
+			mb_shade_applyshade_block(nblock, intensity, r, g, b);
+
+		/* reset the cells without data */
+		for (int l = 0; l < nblock; l++) {
+			if (data[kblock + l] == nodata) {
+				r[l] = shade->nodata_red;
+				g[l] = shade->nodata_green;
+				b[l] = shade->nodata_blue;
+			}
+		}
+	}
+
+	return (NULL);
+}
+/*--------------------------------------------------------------------*/
+int mb_shade_grid(int verbose, const struct mb_shade_struct *shade, int n_columns, int n_rows, float nodatavalue,
+                  const float *data, const float *dzdx, const float *dzdy, float *r, float *g, float *b, int *error) {
+	if (verbose >= 2) {
+		fprintf(stderr, "\ndbg2  MBIO function <%s> called\n", __func__);
+		fprintf(stderr, "dbg2  Input arguments:\n");
+		fprintf(stderr, "dbg2       verbose:                   %d\n", verbose);
+		fprintf(stderr, "dbg2       shade:                     %p\n", shade);
+		fprintf(stderr, "dbg2       n_columns:                 %d\n", n_columns);
+		fprintf(stderr, "dbg2       n_rows:                    %d\n", n_rows);
+		fprintf(stderr, "dbg2       nodatavalue:               %f\n", nodatavalue);
+		fprintf(stderr, "dbg2       data:                      %p\n", data);
+		fprintf(stderr, "dbg2       dzdx:                      %p\n", dzdx);
+		fprintf(stderr, "dbg2       dzdy:                      %p\n", dzdy);
+		fprintf(stderr, "dbg2       r:                         %p\n", r);
+		fprintf(stderr, "dbg2       g:                         %p\n", g);
+		fprintf(stderr, "dbg2       b:                         %p\n", b);
+	}
+
+	struct mb_shade_work_struct work[MB_THREAD_MAX];
+	memset(work, 0, sizeof(work));
+	for (int ithread = 0; ithread < MB_THREAD_MAX; ithread++) {
+		work[ithread].shade = shade;
+		work[ithread].n_columns = n_columns;
+		work[ithread].n_rows = n_rows;
+		work[ithread].nodatavalue = nodatavalue;
+		work[ithread].data = data;
+		work[ithread].dzdx = (float *)dzdx;
+		work[ithread].dzdy = (float *)dzdy;
+		work[ithread].r = r;
+		work[ithread].g = g;
+		work[ithread].b = b;
+	}
+	mb_shade_run(shade->nthreads, 0, n_columns, n_rows, mb_shade_grid_worker, work);
+
+	const int status = MB_SUCCESS;
+	*error = MB_ERROR_NO_ERROR;
+
+	if (verbose >= 2) {
+		fprintf(stderr, "\ndbg2  MBIO function <%s> completed\n", __func__);
+		fprintf(stderr, "dbg2  Return values:\n");
+		fprintf(stderr, "dbg2       error:                     %d\n", *error);
+		fprintf(stderr, "dbg2  Return status:\n");
+		fprintf(stderr, "dbg2       status:                    %d\n", status);
+	}
+
+	return (status);
+}
+/*--------------------------------------------------------------------*/
@@ -32,6 +32,7 @@
  *--------------------------------------------------------------------*/
 
 #include "geometry.h"
+#include "parallel.h"
 
 // standard library
 #include <cmath>
@@ -44,8 +45,12 @@
 namespace mbgrd2gltf
 {
 	Geometry::Geometry(const Bathymetry& bathymetry, const Options& options) :
-	_vertices(get_vertices(bathymetry, options.exaggeration())),
-	_triangles(get_triangles(_vertices))
+	Geometry(bathymetry, options.exaggeration(), options.thread_count())
+	{}
+
+	Geometry::Geometry(const Bathymetry& bathymetry, double vertical_exaggeration, unsigned thread_count) :
+	_vertices(get_vertices(bathymetry, vertical_exaggeration, thread_count)),
+	_triangles(get_triangles(_vertices, thread_count))
 	{}
 
 	double Geometry::to_radians(double degrees)
@@ -67,6 +72,25 @@ namespace mbgrd2gltf
 		return bathymetry.latitude_max() - bathymetry.latitude_spacing() * (double)y;
 	}
 
+	void Geometry::get_earth_centered_position(double longitude, double latitude, double altitude, double *position)
+	{
+		// Mimic https://github.com/GenericMappingTools/gmt/blob/be890649579be45e94269632786d08890a26dfea/src/gmt_map.c#L9094-L9108
+		// and   https://github.com/x3dom/x3dom/blob/3ace18318cd192e424546569932abfe3e1e2346a/src/nodes/Geospatial/GeoCoordinate.js#L380-L443
+		double F = 1.0 / WGS_84_INVERSE_FLATTENING;
+		double e_squared = F * ( 2.0 - F );
+
+		double sin_lon = sin(to_radians(longitude));
+		double cos_lon = cos(to_radians(longitude));
+		double sin_lat = sin(to_radians(latitude));
+		double cos_lat = cos(to_radians(latitude));
+
+		double N = WGS_84_SEMI_MAJOR_AXIS / sqrt (1.0 - e_squared * sin_lat * sin_lat);
+		double tmp = (N + altitude) * cos_lat;
+		position[0] = tmp * cos_lon;
+		position[1] = tmp * sin_lon;
+		position[2] = (N * (1 - e_squared) + altitude) * sin_lat;
+	}
+
 	Vertex Geometry::get_earth_centered_vertex(double longitude, double latitude, double altitude, uint32_t id)
 	{
 		// Test with:
@@ -94,21 +118,12 @@ namespace mbgrd2gltf
 
 		//std::cerr << "x, y, z: " << x << ' ' << y << ' ' << z << '\n';
 
-		// Mimic https://github.com/GenericMappingTools/gmt/blob/be890649579be45e94269632786d08890a26dfea/src/gmt_map.c#L9094-L9108
-		// and   https://github.com/x3dom/x3dom/blob/3ace18318cd192e424546569932abfe3e1e2346a/src/nodes/Geospatial/GeoCoordinate.js#L380-L443
-		double F = 1.0 / WGS_84_INVERSE_FLATTENING;
-		double e_squared = F * ( 2.0 - F );
-
-		double sin_lon = sin(to_radians(longitude));
-		double cos_lon = cos(to_radians(longitude));
-		double sin_lat = sin(to_radians(latitude));
-		double cos_lat = cos(to_radians(latitude));
+		double position[3];
 
-		double N = WGS_84_SEMI_MAJOR_AXIS / sqrt (1.0 - e_squared * sin_lat * sin_lat);
-		double tmp = (N + altitude) * cos_lat;
-		x = tmp * cos_lon;
-		y = tmp * sin_lon;
-		z = (N * (1 - e_squared) + altitude) * sin_lat;
+		get_earth_centered_position(longitude, latitude, altitude, position);
+		x = position[0];
+		y = position[1];
+		z = position[2];
 
 		//std::cerr << "WGS-84 x, y, z: " << x << ' ' << y << ' ' << z << '\n';
 		// [vagrant@localhost build]$ ./grd-to-gltf Monterey25.grd -e 10 -b
@@ -125,14 +140,36 @@ namespace mbgrd2gltf
 		return Vertex(x, y, z, id);
 	}
 
-	Matrix<Vertex> Geometry::get_vertices(const Bathymetry& bathymetry, double vertical_exaggeration)
+	// Vertex ids number the valid cells in row order. Rows are counted
+	// first so that each thread knows the first id of the rows it fills,
+	// giving the same ids as a single pass over the grid.
+	Matrix<Vertex> Geometry::get_vertices(const Bathymetry& bathymetry, double vertical_exaggeration, unsigned thread_count)
 	{
 		Matrix<Vertex> out(bathymetry.size_x(), bathymetry.size_y());
 		const auto& altitudes = bathymetry.altitudes();
-		uint32_t vertex_id = 1;
+		std::vector<uint32_t> first_ids(altitudes.size_y() + 1, 0);
+
+		parallel_for(altitudes.size_y(), thread_count, [&](size_t y)
+		{
+			uint32_t valid_count = 0;
+
+			for (size_t x = 0; x < altitudes.size_x(); ++x)
+				if (!std::isnan(altitudes.at(x, y)))
+					++valid_count;
+
+			first_ids[y + 1] = valid_count;
+		});
+
+		first_ids[0] = 1;
 
 		for (size_t y = 0; y < altitudes.size_y(); ++y)
+			first_ids[y + 1] += first_ids[y];
+
+		parallel_for(altitudes.size_y(), thread_count, [&](size_t y)
 		{
+			uint32_t vertex_id = first_ids[y];
+			double latitude = get_latitude(bathymetry, y);
+
 			for (size_t x = 0; x < altitudes.size_x(); ++x)
 			{
 				float altitude = altitudes.at(x, y);
@@ -140,69 +177,114 @@ namespace mbgrd2gltf
 				if (!std::isnan(altitude))
 				{
 					double longitude = get_longitude(bathymetry, x);
-					double latitude = get_latitude(bathymetry, y);
 					double adjusted_altitude = (double)altitude * vertical_exaggeration;
 					out.at(x, y) = get_earth_centered_vertex(longitude, latitude, adjusted_altitude, vertex_id++);
 				}
 			}
-		}
+		});
 
 		return out;
 	}
 
-	std::vector<Triangle> Geometry::get_triangles(const Matrix<Vertex>& vertices)
+	// Triangles of the cell with lower left corner (x, y), written to out
+	// unless it is null. Returns the number of triangles, 0 to 2.
+	size_t Geometry::get_cell_triangles(const Matrix<Vertex>& vertices, size_t x, size_t y, Triangle *out)
 	{
+		const auto& bottom_left = vertices.at(x, y);
+		const auto& bottom_right = vertices.at(x + 1, y);
+		const auto& top_left = vertices.at(x, y + 1);
+		const auto& top_right = vertices.at(x + 1, y + 1);
+		size_t count = 0;
+
+		if (bottom_left.is_valid() && top_right.is_valid())
+		{
+			if (top_left.is_valid())
+			{
+				if (out)
+					out[count] = Triangle {
+						bottom_left.index(),
+						top_left.index(),
+						top_right.index()
+					};
+
+				++count;
+			}
+
+			if (bottom_right.is_valid())
+			{
+				if (out)
+					out[count] = Triangle {
+						bottom_left.index(),
+						top_right.index(),
+						bottom_right.index()
+					};
+
+				++count;
+			}
+		}
+		else if (bottom_right.is_valid() && top_left.is_valid())
+		{
+			if (bottom_left.is_valid())
+			{
+				if (out)
+					out[count] = Triangle {
+						bottom_right.index(),
+						bottom_left.index(),
+						top_left.index()
+					};
+
+				++count;
+			}
+
+			if (top_right.is_valid())
+			{
+				if (out)
+					out[count] = Triangle {
+						bottom_right.index(),
+						top_left.index(),
+						top_right.index()
+					};
+
+				++count;
+			}
+		}
+
+		return count;
+	}
+
+	// Rows of cells are counted, then filled in parallel at their offsets,
+	// so the triangles are in the same order as a single pass.
+	std::vector<Triangle> Geometry::get_triangles(const Matrix<Vertex>& vertices, unsigned thread_count)
+	{
+		if (vertices.size_x() < 2 || vertices.size_y() < 2)
+			return std::vector<Triangle>();
+
 		size_t end_y = vertices.size_y() - 1;
 		size_t end_x = vertices.size_x() - 1;
-		size_t max_triangle_count = 2 * end_x * end_y;
+		std::vector<size_t> row_offsets(end_y + 1, 0);
 
-		std::vector<Triangle> out;
+		parallel_for(end_y, thread_count, [&](size_t y)
+		{
+			size_t count = 0;
+
+			for (size_t x = 0; x < end_x; ++x)
+				count += get_cell_triangles(vertices, x, y, nullptr);
+
+			row_offsets[y + 1] = count;
+		});
 
-		out.reserve(max_triangle_count);
-			
 		for (size_t y = 0; y < end_y; ++y)
+			row_offsets[y + 1] += row_offsets[y];
+
+		std::vector<Triangle> out(row_offsets[end_y]);
+
+		parallel_for(end_y, thread_count, [&](size_t y)
 		{
+			Triangle *row = out.data() + row_offsets[y];
+
 			for (size_t x = 0; x < end_x; ++x)
-			{
-				const auto& bottom_left = vertices.at(x, y);
-				const auto& bottom_right = vertices.at(x + 1, y);
-				const auto& top_left = vertices.at(x, y + 1);
-				const auto& top_right = vertices.at(x + 1, y + 1);
-				
-				if (bottom_left.is_valid() && top_right.is_valid())
-				{
-					if (top_left.is_valid())
-						out.emplace_back(Triangle {
-							bottom_left.index(),
-							top_left.index(),
-							top_right.index()
-						});
-					
-					if (bottom_right.is_valid())
-						out.emplace_back(Triangle {
-							bottom_left.index(),
-							top_right.index(),
-							bottom_right.index()
-						});
-				}
-				else if (bottom_right.is_valid() && top_left.is_valid())
-				{
-					if (bottom_left.is_valid())
-						out.emplace_back(Triangle {
-							bottom_right.index(),
-							bottom_left.index(),
-							top_left.index()
-						});
-					
-					if (top_right.is_valid())
-						out.emplace_back(Triangle {
-							bottom_right.index(),
-							top_left.index(),
-							top_right.index()
-						});
-				}
-			}
-		}
+				row += get_cell_triangles(vertices, x, y, row);
+		});
 
 		return out;
 	}
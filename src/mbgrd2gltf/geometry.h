@@ -54,15 +54,19 @@ namespace mbgrd2gltf
 	private: // methods
 
 		static double to_radians(double degrees);
-		static double get_longitude(const Bathymetry& bathymetry, size_t x);
-		static double get_latitude(const Bathymetry& bathymetry, size_t y);
 		static Vertex get_earth_centered_vertex(double longitude, double latitude, double altitude, uint32_t id);
-		static Matrix<Vertex> get_vertices(const Bathymetry& bathymetry, double vertical_exaggeration);
-		static std::vector<Triangle> get_triangles(const Matrix<Vertex>& vertices);
+		static Matrix<Vertex> get_vertices(const Bathymetry& bathymetry, double vertical_exaggeration, unsigned thread_count);
+		static size_t get_cell_triangles(const Matrix<Vertex>& vertices, size_t x, size_t y, Triangle *out);
+		static std::vector<Triangle> get_triangles(const Matrix<Vertex>& vertices, unsigned thread_count);
 
 	public: // methods
 
+		static double get_longitude(const Bathymetry& bathymetry, size_t x);
+		static double get_latitude(const Bathymetry& bathymetry, size_t y);
+		static void get_earth_centered_position(double longitude, double latitude, double altitude, double *position);
+
 		Geometry(const Bathymetry& bathymetry, const Options& options);
+		Geometry(const Bathymetry& bathymetry, double vertical_exaggeration, unsigned thread_count);
 
 		const Matrix<Vertex>& vertices() const { return _vertices; }
 		const std::vector<Triangle>& triangles() const { return _triangles; }
@@ -36,15 +36,108 @@
 #include "geometry.h"
 #include "model.h"
 #include "options.h"
+#include "tiles.h"
 
 // standard library
+#include <chrono>
+#include <cstdio>
 #include <iostream>
+#include <stdexcept>
 
 // external libraries
 #include <netcdf.h>
 
 using namespace mbgrd2gltf;
 
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool is_same_geometry(const Geometry& a, const Geometry& b)
+{
+	if (a.vertices().count() != b.vertices().count() || a.triangles().size() != b.triangles().size())
+		return false;
+
+	for (size_t i = 0; i < a.vertices().count(); ++i)
+	{
+		const Vertex& u = a.vertices()[i];
+		const Vertex& v = b.vertices()[i];
+
+		if (u.x() != v.x() || u.y() != v.y() || u.z() != v.z() || u.is_valid() != v.is_valid()
+			|| (u.is_valid() && u.index() != v.index()))
+			return false;
+	}
+
+	for (size_t i = 0; i < a.triangles().size(); ++i)
+	{
+		const Triangle& s = a.triangles()[i];
+		const Triangle& t = b.triangles()[i];
+
+		if (s.a() != t.a() || s.b() != t.b() || s.c() != t.c())
+			return false;
+	}
+
+	return true;
+}
+
+// Time building the geometry with one thread and with the threads
+// requested, then writing it with each encoding to a scratch file.
+static void run_benchmark(const Bathymetry& bathymetry, const Options& options)
+{
+	auto start = std::chrono::steady_clock::now();
+	Geometry serial(bathymetry, options.exaggeration(), 1);
+	double serial_time = seconds_since(start);
+
+	start = std::chrono::steady_clock::now();
+	Geometry parallel(bathymetry, options.exaggeration(), options.thread_count());
+	double parallel_time = seconds_since(start);
+
+	if (!is_same_geometry(serial, parallel))
+		throw std::runtime_error("benchmark geometry built with "
+			+ std::to_string(options.thread_count())
+			+ " threads differs from that built with 1 thread");
+
+	printf("geometry: %zu vertices, %zu triangles\n", parallel.vertices().count(), parallel.triangles().size());
+	printf("geometry with  1 thread:  %8.3f s\n", serial_time);
+	printf("geometry with %2u threads: %8.3f s (%.2fx)\n", options.thread_count(), parallel_time,
+		parallel_time > 0.0 ? serial_time / parallel_time : 0.0);
+
+	const struct
+	{
+		const char *name;
+		bool is_quantized;
+		bool is_meshopt_compressed;
+	}
+	encodings[] =
+	{
+		{ "float", false, false },
+		{ "quantized", true, false },
+		{ "meshopt", false, true },
+		{ "quantized+meshopt", true, true }
+	};
+
+	std::string filepath = options.output_filepath() + "_benchmark"
+		+ (options.is_binary_output() ? ".glb" : ".gltf");
+	size_t float_size = 0;
+
+	for (const auto& encoding : encodings)
+	{
+		start = std::chrono::steady_clock::now();
+		size_t size = model::write_gltf(parallel, filepath, options.is_binary_output(),
+			encoding.is_quantized, encoding.is_meshopt_compressed);
+		double write_time = seconds_since(start);
+
+		if (float_size == 0)
+			float_size = size;
+
+		printf("%-18s write %8.3f s  size %12zu bytes (%5.1f%%)\n", encoding.name, write_time, size,
+			100.0 * (double)size / (double)float_size);
+	}
+
+	remove(filepath.c_str());
+}
+
 int main(int argc, char *argv[])
 {
 	try
@@ -55,8 +148,24 @@ int main(int argc, char *argv[])
 			return 0;
 
 		Bathymetry bathymetry(options);
-		Geometry geometry(bathymetry, options);
-		model::write_gltf(geometry, options);
+
+		if (options.is_benchmark())
+			run_benchmark(bathymetry, options);
+
+		auto start = std::chrono::steady_clock::now();
+
+		if (options.is_tiled())
+		{
+			tiles::write_tiles(bathymetry, options);
+		}
+		else
+		{
+			Geometry geometry(bathymetry, options);
+			model::write_gltf(geometry, options);
+		}
+
+		if (options.is_benchmark())
+			printf("conversion with %u threads: %.3f s\n", options.thread_count(), seconds_since(start));
 	}
 	catch (const std::exception& e)
 	{
@@ -0,0 +1,238 @@
+/*--------------------------------------------------------------------
+ *    The MB-system:	meshopt.cpp	10/19/2026
+ *
+ *    Copyright (c) 2026 by the MB-System Team
+ *
+ *    MB-System was created by Caress and Chayes in 1992 at the
+ *      Lamont-Doherty Earth Observatory
+ *      Columbia University
+ *      Palisades, NY 10964
+ *
+ *    See README.md file for copying and redistribution conditions.
+ *--------------------------------------------------------------------*/
+/*
+ *    Part of the program MBgrd2gltf, which was created by a Capstone
+ *    Project team at the California State University Monterey Bay
+ *    (CSUMB). This file was added later by the MB-System Team.
+ *--------------------------------------------------------------------*/
+
+#include "meshopt.h"
+
+// standard library
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#define MESHOPT_VERTEX_HEADER 0xa0
+#define MESHOPT_SEQUENCE_HEADER 0xd1
+#define MESHOPT_BYTE_GROUP_SIZE 16
+#define MESHOPT_VERTEX_BLOCK_BYTES 8192
+#define MESHOPT_VERTEX_BLOCK_MAX_SIZE 256
+#define MESHOPT_TAIL_SIZE 32
+#define MESHOPT_SEQUENCE_RESET 30
+
+namespace mbgrd2gltf
+{
+	namespace meshopt
+	{
+		unsigned char zigzag8(unsigned char value)
+		{
+			return (unsigned char)(((value & 0x80) ? 0xff : 0x00) ^ (value << 1));
+		}
+
+		size_t get_vertex_block_size(size_t stride)
+		{
+			size_t size = (MESHOPT_VERTEX_BLOCK_BYTES / stride) & ~(size_t)(MESHOPT_BYTE_GROUP_SIZE - 1);
+
+			return size < MESHOPT_VERTEX_BLOCK_MAX_SIZE ? size : MESHOPT_VERTEX_BLOCK_MAX_SIZE;
+		}
+
+		// Size of a group of 16 deltas packed at bits per delta, deltas that
+		// do not fit are replaced by a sentinel and follow as whole bytes.
+		size_t measure_group(const unsigned char *group, int bits)
+		{
+			if (bits == 0)
+			{
+				for (size_t i = 0; i < MESHOPT_BYTE_GROUP_SIZE; ++i)
+					if (group[i] != 0)
+						return (size_t)-1;
+
+				return 0;
+			}
+
+			if (bits == 8)
+				return MESHOPT_BYTE_GROUP_SIZE;
+
+			unsigned char sentinel = (unsigned char)((1 << bits) - 1);
+			size_t size = MESHOPT_BYTE_GROUP_SIZE * bits / 8;
+
+			for (size_t i = 0; i < MESHOPT_BYTE_GROUP_SIZE; ++i)
+				size += group[i] >= sentinel;
+
+			return size;
+		}
+
+		void encode_group(std::vector<unsigned char>& out, const unsigned char *group, int bits)
+		{
+			if (bits == 0)
+				return;
+
+			if (bits == 8)
+			{
+				out.insert(out.end(), group, group + MESHOPT_BYTE_GROUP_SIZE);
+				return;
+			}
+
+			unsigned char sentinel = (unsigned char)((1 << bits) - 1);
+			size_t per_byte = 8 / bits;
+
+			for (size_t i = 0; i < MESHOPT_BYTE_GROUP_SIZE; i += per_byte)
+			{
+				unsigned char byte = 0;
+
+				for (size_t k = 0; k < per_byte; ++k)
+				{
+					unsigned char value = group[i + k] >= sentinel ? sentinel : group[i + k];
+					byte = (unsigned char)((byte << bits) | value);
+				}
+
+				out.push_back(byte);
+			}
+
+			for (size_t i = 0; i < MESHOPT_BYTE_GROUP_SIZE; ++i)
+				if (group[i] >= sentinel)
+					out.push_back(group[i]);
+		}
+
+		// Deltas of one byte lane of a block, in groups of 16 with a 2 bit
+		// header per group selecting 0, 2, 4 or 8 bits per delta.
+		void encode_bytes(std::vector<unsigned char>& out, const unsigned char *deltas, size_t size)
+		{
+			size_t group_count = size / MESHOPT_BYTE_GROUP_SIZE;
+			size_t header = out.size();
+
+			out.resize(header + (group_count + 3) / 4, 0);
+
+			for (size_t g = 0; g < group_count; ++g)
+			{
+				const unsigned char *group = deltas + g * MESHOPT_BYTE_GROUP_SIZE;
+				int best_bits = 8;
+				size_t best_size = measure_group(group, 8);
+
+				for (int bits : { 0, 2, 4 })
+				{
+					size_t group_size = measure_group(group, bits);
+
+					if (group_size < best_size)
+					{
+						best_bits = bits;
+						best_size = group_size;
+					}
+				}
+
+				int bits_log2 = best_bits == 0 ? 0 : best_bits == 2 ? 1 : best_bits == 4 ? 2 : 3;
+
+				out[header + g / 4] |= (unsigned char)(bits_log2 << ((g % 4) * 2));
+				encode_group(out, group, best_bits);
+			}
+		}
+
+		std::vector<unsigned char> encode_vertex_buffer(const unsigned char *vertices, size_t count, size_t stride)
+		{
+			if (stride == 0 || stride > 256 || stride % 4 != 0)
+				throw std::invalid_argument("meshopt vertex stride must be a multiple of 4 up to 256 but was "
+					+ std::to_string(stride));
+
+			std::vector<unsigned char> out;
+			std::vector<unsigned char> last(stride, 0);
+			std::vector<unsigned char> deltas(MESHOPT_VERTEX_BLOCK_MAX_SIZE);
+			size_t block_size = get_vertex_block_size(stride);
+
+			out.reserve(count * stride / 2 + MESHOPT_TAIL_SIZE + 1);
+			out.push_back(MESHOPT_VERTEX_HEADER);
+
+			if (count > 0)
+				memcpy(&last[0], vertices, stride);
+
+			for (size_t first = 0; first < count; first += block_size)
+			{
+				size_t block_count = count - first < block_size ? count - first : block_size;
+				size_t aligned_count = (block_count + MESHOPT_BYTE_GROUP_SIZE - 1) & ~(size_t)(MESHOPT_BYTE_GROUP_SIZE - 1);
+				const unsigned char *block = vertices + first * stride;
+
+				for (size_t k = 0; k < stride; ++k)
+				{
+					unsigned char previous = last[k];
+
+					for (size_t i = 0; i < block_count; ++i)
+					{
+						unsigned char value = block[i * stride + k];
+
+						deltas[i] = zigzag8((unsigned char)(value - previous));
+						previous = value;
+					}
+
+					for (size_t i = block_count; i < aligned_count; ++i)
+						deltas[i] = 0;
+
+					encode_bytes(out, &deltas[0], aligned_count);
+				}
+
+				memcpy(&last[0], block + (block_count - 1) * stride, stride);
+			}
+
+			// The stream ends with the first vertex, padded to 32 bytes.
+			if (stride < MESHOPT_TAIL_SIZE)
+				out.resize(out.size() + MESHOPT_TAIL_SIZE - stride, 0);
+
+			if (count > 0)
+				out.insert(out.end(), vertices, vertices + stride);
+			else
+				out.resize(out.size() + stride, 0);
+
+			return out;
+		}
+
+		void encode_vbyte(std::vector<unsigned char>& out, uint32_t value)
+		{
+			while (value >= 0x80)
+			{
+				out.push_back((unsigned char)((value & 0x7f) | 0x80));
+				value >>= 7;
+			}
+
+			out.push_back((unsigned char)value);
+		}
+
+		std::vector<unsigned char> encode_index_sequence(const uint32_t *indices, size_t count)
+		{
+			std::vector<unsigned char> out;
+			uint32_t last[2] = { 0, 0 };
+			unsigned current = 0;
+
+			out.reserve(count + 5);
+			out.push_back(MESHOPT_SEQUENCE_HEADER);
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				uint32_t index = indices[i];
+				int32_t distance = (int32_t)(index - last[current]);
+
+				// Switch baseline on a jump, so runs from two rows of the
+				// grid both keep small deltas.
+				if (distance >= MESHOPT_SEQUENCE_RESET || distance <= -MESHOPT_SEQUENCE_RESET)
+					current ^= 1;
+
+				uint32_t delta = index - last[current];
+				uint32_t value = (delta << 1) ^ (uint32_t)((int32_t)delta >> 31);
+
+				encode_vbyte(out, (value << 1) | current);
+				last[current] = index;
+			}
+
+			out.resize(out.size() + 4, 0);
+
+			return out;
+		}
+	}
+}
@@ -0,0 +1,43 @@
+/*--------------------------------------------------------------------
+ *    The MB-system:	meshopt.h	10/19/2026
+ *
+ *    Copyright (c) 2026 by the MB-System Team
+ *
+ *    MB-System was created by Caress and Chayes in 1992 at the
+ *      Lamont-Doherty Earth Observatory
+ *      Columbia University
+ *      Palisades, NY 10964
+ *
+ *    See README.md file for copying and redistribution conditions.
+ *--------------------------------------------------------------------*/
+/*
+ *    Part of the program MBgrd2gltf, which was created by a Capstone
+ *    Project team at the California State University Monterey Bay
+ *    (CSUMB). This file was added later by the MB-System Team.
+ *--------------------------------------------------------------------*/
+
+#ifndef MESHOPT_H
+#define MESHOPT_H
+
+// standard library
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mbgrd2gltf
+{
+	// Encoders for the bitstreams of the glTF EXT_meshopt_compression
+	// extension, written from the extension specification.
+	namespace meshopt
+	{
+		// "ATTRIBUTES" mode: byte-wise delta coding of count vertices of
+		// stride bytes each (stride a multiple of 4, at most 256).
+		std::vector<unsigned char> encode_vertex_buffer(const unsigned char *vertices, size_t count, size_t stride);
+
+		// "INDICES" mode: delta coding of an index sequence against two
+		// baselines, written as variable length integers.
+		std::vector<unsigned char> encode_index_sequence(const uint32_t *indices, size_t count);
+	}
+}
+
+#endif
@@ -32,6 +32,14 @@
  *--------------------------------------------------------------------*/
 
 #include "model.h"
+#include "meshopt.h"
+
+// standard library
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
 
 // external libraries
 #define TINYGLTF_IMPLEMENTATION
@@ -39,6 +47,11 @@
 #define TINYGLTF_NO_STB_IMAGE_WRITE
 #include "tinygltf/tiny_gltf.h"
 
+#define QUANTIZED_MAX 65535.0
+#define QUANTIZED_STRIDE 8
+#define FLOAT_STRIDE 12
+#define INDEX_STRIDE 4
+
 namespace mbgrd2gltf
 {
 	namespace model
@@ -83,53 +96,6 @@ namespace mbgrd2gltf
 			return out;
 		}
 
-		tinygltf::Buffer get_buffer(const std::vector<float>& vertex_buffer, const std::vector<uint32_t>& index_buffer)
-		{
-			tinygltf::Buffer out;
-			
-			size_t buffer_size = index_buffer.size() * 4 + vertex_buffer.size() * 4; 
-
-			out.data.resize(buffer_size);
-
-			auto& data = out.data;
-
-			uint32_t *indices_ptr = (uint32_t*)&data[0];
-
-			for (size_t i = 0; i < index_buffer.size(); ++i)
-				indices_ptr[i] = index_buffer[i];
-
-			float *vertices_ptr = (float*)&data[index_buffer.size() * 4];
-
-			for (size_t i = 0; i < vertex_buffer.size(); ++i)
-				vertices_ptr[i] = vertex_buffer[i];
-
-			return out;
-		}
-
-		tinygltf::BufferView get_vertex_buffer_view(const std::vector<float>& vertex_buffer, const std::vector<uint32_t>& index_buffer)
-		{
-			tinygltf::BufferView out;
-
-			out.buffer = 0;
-			out.byteOffset = index_buffer.size() * 4;
-			out.byteLength = vertex_buffer.size() * 4;
-			out.target = TINYGLTF_TARGET_ARRAY_BUFFER;
-
-			return out;
-		}
-
-		tinygltf::BufferView get_index_buffer_view(const std::vector<uint32_t>& index_buffer)
-		{
-			tinygltf::BufferView out;
-
-			out.buffer = 0;
-			out.byteOffset = 0;
-			out.byteLength = index_buffer.size() * 4;
-			out.target = TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER;
-
-			return out;
-		}
-
 		std::vector<double> get_vertex_mins(const std::vector<float>& vertex_buffer)
 		{
 			float x_min = vertex_buffer[0];
@@ -172,6 +138,110 @@ namespace mbgrd2gltf
 			return { x_max, y_max, z_max };
 		}
 
+		// Step between quantized values on each axis, so that the extent of
+		// the vertices maps onto 0 to 65535.
+		std::vector<double> get_quantization_scale(const std::vector<double>& mins, const std::vector<double>& maxes)
+		{
+			std::vector<double> out(3);
+
+			for (size_t k = 0; k < 3; ++k)
+			{
+				out[k] = (maxes[k] - mins[k]) / QUANTIZED_MAX;
+
+				if (out[k] <= 0.0)
+					out[k] = 1.0;
+			}
+
+			return out;
+		}
+
+		// Positions as unsigned 16 bit x, y, z and a padding value, keeping
+		// each vertex 4 byte aligned as glTF requires.
+		std::vector<unsigned char> get_quantized_vertex_data(const std::vector<float>& vertex_buffer,
+			const std::vector<double>& mins, const std::vector<double>& scale)
+		{
+			size_t vertex_count = vertex_buffer.size() / 3;
+			std::vector<unsigned char> out(vertex_count * QUANTIZED_STRIDE, 0);
+
+			for (size_t i = 0; i < vertex_count; ++i)
+			{
+				uint16_t quantized[4] = { 0, 0, 0, 0 };
+
+				for (size_t k = 0; k < 3; ++k)
+				{
+					double value = std::round(((double)vertex_buffer[i * 3 + k] - mins[k]) / scale[k]);
+
+					if (value < 0.0)
+						value = 0.0;
+					else if (value > QUANTIZED_MAX)
+						value = QUANTIZED_MAX;
+
+					quantized[k] = (uint16_t)value;
+				}
+
+				memcpy(&out[i * QUANTIZED_STRIDE], quantized, QUANTIZED_STRIDE);
+			}
+
+			return out;
+		}
+
+		std::vector<unsigned char> get_float_vertex_data(const std::vector<float>& vertex_buffer)
+		{
+			std::vector<unsigned char> out(vertex_buffer.size() * sizeof(float));
+
+			if (!out.empty())
+				memcpy(&out[0], vertex_buffer.data(), out.size());
+
+			return out;
+		}
+
+		tinygltf::Buffer get_buffer(const std::vector<unsigned char>& vertex_data, const std::vector<uint32_t>& index_buffer)
+		{
+			tinygltf::Buffer out;
+			
+			size_t buffer_size = index_buffer.size() * INDEX_STRIDE + vertex_data.size(); 
+
+			out.data.resize(buffer_size);
+
+			auto& data = out.data;
+
+			if (!index_buffer.empty())
+				memcpy(&data[0], index_buffer.data(), index_buffer.size() * INDEX_STRIDE);
+
+			if (!vertex_data.empty())
+				memcpy(&data[index_buffer.size() * INDEX_STRIDE], vertex_data.data(), vertex_data.size());
+
+			return out;
+		}
+
+		tinygltf::BufferView get_vertex_buffer_view(const std::vector<unsigned char>& vertex_data, const std::vector<uint32_t>& index_buffer,
+			int buffer, size_t stride)
+		{
+			tinygltf::BufferView out;
+
+			out.buffer = buffer;
+			out.byteOffset = index_buffer.size() * INDEX_STRIDE;
+			out.byteLength = vertex_data.size();
+			out.target = TINYGLTF_TARGET_ARRAY_BUFFER;
+
+			if (stride != FLOAT_STRIDE)
+				out.byteStride = stride;
+
+			return out;
+		}
+
+		tinygltf::BufferView get_index_buffer_view(const std::vector<uint32_t>& index_buffer, int buffer)
+		{
+			tinygltf::BufferView out;
+
+			out.buffer = buffer;
+			out.byteOffset = 0;
+			out.byteLength = index_buffer.size() * INDEX_STRIDE;
+			out.target = TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER;
+
+			return out;
+		}
+
 		tinygltf::Accessor get_vertex_accessor(const std::vector<float>& vertex_buffer)
 		{
 			tinygltf::Accessor out;
@@ -187,6 +257,41 @@ namespace mbgrd2gltf
 			return out;
 		}
 
+		tinygltf::Accessor get_quantized_vertex_accessor(const std::vector<unsigned char>& vertex_data)
+		{
+			tinygltf::Accessor out;
+			size_t vertex_count = vertex_data.size() / QUANTIZED_STRIDE;
+			std::vector<double> mins(3, QUANTIZED_MAX);
+			std::vector<double> maxes(3, 0.0);
+
+			for (size_t i = 0; i < vertex_count; ++i)
+			{
+				uint16_t quantized[4];
+
+				memcpy(quantized, &vertex_data[i * QUANTIZED_STRIDE], QUANTIZED_STRIDE);
+
+				for (size_t k = 0; k < 3; ++k)
+				{
+					if (quantized[k] < mins[k])
+						mins[k] = quantized[k];
+
+					if (quantized[k] > maxes[k])
+						maxes[k] = quantized[k];
+				}
+			}
+
+			out.bufferView = 1;
+			out.byteOffset = 0;
+			out.componentType = TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT;
+			out.normalized = false;
+			out.count = vertex_count;
+			out.type = TINYGLTF_TYPE_VEC3;
+			out.maxValues = maxes;
+			out.minValues = mins;
+
+			return out;
+		}
+
 		tinygltf::Accessor get_index_accessor(const std::vector<uint32_t> index_buffer, size_t vertex_count)
 		{
 			tinygltf::Accessor out;
@@ -214,11 +319,130 @@ namespace mbgrd2gltf
 			return out;
 		}
 
-		void write_gltf(const Geometry& geometry, const Options& options)
+		nlohmann::json get_meshopt_extension(size_t offset, const std::vector<unsigned char>& stream,
+			size_t stride, size_t count, const char *mode)
 		{
-			std::string output_filepath = options.output_filepath()
-				+ (options.is_binary_output() ? ".glb" : ".gltf");
+			nlohmann::json out;
+
+			out["buffer"] = 0;
+			out["byteOffset"] = offset;
+			out["byteLength"] = stream.size();
+			out["byteStride"] = stride;
+			out["count"] = count;
+			out["mode"] = mode;
+
+			return out;
+		}
+
+		void write_stream(std::ostream& stream, const void *data, size_t size)
+		{
+			stream.write((const char *)data, (std::streamsize)size);
+		}
+
+		// GLB container: header, JSON chunk padded with spaces and binary
+		// chunk padded with zeros, both to 4 bytes.
+		void write_glb(std::ostream& stream, const std::string& content, const std::vector<unsigned char>& bin)
+		{
+			const uint32_t content_padding = (4 - content.size() % 4) % 4;
+			const uint32_t bin_padding = (4 - bin.size() % 4) % 4;
+			const uint32_t content_length = (uint32_t)content.size() + content_padding;
+			const uint32_t bin_length = (uint32_t)bin.size() + bin_padding;
+			const uint32_t version = 2;
+			const uint32_t length = 12 + 8 + content_length + (bin.empty() ? 0 : 8 + bin_length);
+			const uint32_t json_format = 0x4E4F534A;
+			const uint32_t bin_format = 0x004E4942;
+			const char spaces[4] = { ' ', ' ', ' ', ' ' };
+			const char zeros[4] = { 0, 0, 0, 0 };
+
+			write_stream(stream, "glTF", 4);
+			write_stream(stream, &version, sizeof(version));
+			write_stream(stream, &length, sizeof(length));
+			write_stream(stream, &content_length, sizeof(content_length));
+			write_stream(stream, &json_format, sizeof(json_format));
+			write_stream(stream, content.data(), content.size());
+			write_stream(stream, spaces, content_padding);
+
+			if (!bin.empty())
+			{
+				write_stream(stream, &bin_length, sizeof(bin_length));
+				write_stream(stream, &bin_format, sizeof(bin_format));
+				write_stream(stream, bin.data(), bin.size());
+				write_stream(stream, zeros, bin_padding);
+			}
+		}
+
+		// tinygltf does not write buffer or buffer view extensions, nor a
+		// buffer without data, so the meshopt compressed model is written
+		// without buffers and they are added to its JSON here. Buffer 0
+		// holds the compressed streams, buffer 1 is the fallback that
+		// readers decode them into.
+		void write_meshopt_gltf(tinygltf::Model& model, const std::string& filepath, bool is_binary,
+			const std::vector<unsigned char>& vertex_data, size_t stride, const std::vector<uint32_t>& index_buffer)
+		{
+			std::vector<unsigned char> index_stream = meshopt::encode_index_sequence(index_buffer.data(), index_buffer.size());
+			std::vector<unsigned char> vertex_stream = meshopt::encode_vertex_buffer(vertex_data.data(),
+				vertex_data.size() / stride, stride);
+			size_t vertex_offset = (index_stream.size() + 3) & ~(size_t)3;
+			std::vector<unsigned char> bin(vertex_offset + vertex_stream.size(), 0);
+
+			memcpy(&bin[0], index_stream.data(), index_stream.size());
+			memcpy(&bin[vertex_offset], vertex_stream.data(), vertex_stream.size());
+
+			model.extensionsUsed.push_back("EXT_meshopt_compression");
+			model.extensionsRequired.push_back("EXT_meshopt_compression");
+
+			std::stringstream content;
+			tinygltf::TinyGLTF gltf;
+
+			gltf.WriteGltfSceneToStream(&model, content, false, false);
+
+			nlohmann::json document = nlohmann::json::parse(content.str());
+			nlohmann::json compressed_buffer;
+			nlohmann::json fallback_buffer;
 
+			compressed_buffer["byteLength"] = bin.size();
+
+			if (!is_binary)
+				compressed_buffer["uri"] = "data:application/octet-stream;base64,"
+					+ tinygltf::base64_encode(bin.data(), (unsigned)bin.size());
+
+			fallback_buffer["byteLength"] = index_buffer.size() * INDEX_STRIDE + vertex_data.size();
+			fallback_buffer["extensions"]["EXT_meshopt_compression"]["fallback"] = true;
+
+			document["buffers"] = nlohmann::json::array({ compressed_buffer, fallback_buffer });
+			document["bufferViews"][0]["extensions"]["EXT_meshopt_compression"] =
+				get_meshopt_extension(0, index_stream, INDEX_STRIDE, index_buffer.size(), "INDICES");
+			document["bufferViews"][1]["extensions"]["EXT_meshopt_compression"] =
+				get_meshopt_extension(vertex_offset, vertex_stream, stride, vertex_data.size() / stride, "ATTRIBUTES");
+
+			std::ofstream file(filepath, std::ios::binary);
+
+			if (!file)
+				throw std::runtime_error("failed to open output file: " + filepath);
+
+			if (is_binary)
+				write_glb(file, document.dump(), bin);
+			else
+				file << document.dump();
+
+			if (!file)
+				throw std::runtime_error("failed to write output file: " + filepath);
+		}
+
+		size_t get_file_size(const std::string& filepath)
+		{
+			std::ifstream file(filepath, std::ios::binary | std::ios::ate);
+
+			if (!file)
+				throw std::runtime_error("failed to open output file: " + filepath);
+
+			return (size_t)file.tellg();
+		}
+
+		size_t write_mesh(const std::vector<float>& vertex_buffer, const std::vector<uint32_t>& index_buffer,
+			const std::vector<double>& origin, const std::string& filepath, bool is_binary,
+			bool is_quantized, bool is_meshopt_compressed)
+		{
 			tinygltf::Mesh mesh;
 			mesh.primitives =
 			{
@@ -230,29 +454,63 @@ namespace mbgrd2gltf
 
 			tinygltf::Scene scene;
 			scene.nodes = { 0 };
-		
-			std::vector<float> vertex_buffer = get_vertex_buffer(geometry.vertices());
-			std::vector<uint32_t> index_buffer = get_index_buffer(geometry.triangles());
+
+			if (vertex_buffer.empty())
+				throw std::runtime_error("grid contains no valid values");
+
+			std::vector<unsigned char> vertex_data;
+			tinygltf::Accessor vertex_accessor;
+			size_t stride;
 
 			tinygltf::Model model;
+
+			if (is_quantized)
+			{
+				// The node transform takes the quantized positions back to
+				// earth centered coordinates.
+				std::vector<double> mins = get_vertex_mins(vertex_buffer);
+				std::vector<double> scale = get_quantization_scale(mins, get_vertex_maxes(vertex_buffer));
+
+				vertex_data = get_quantized_vertex_data(vertex_buffer, mins, scale);
+				vertex_accessor = get_quantized_vertex_accessor(vertex_data);
+				stride = QUANTIZED_STRIDE;
+				node.translation = mins;
+				node.scale = scale;
+
+				for (size_t k = 0; k < origin.size(); ++k)
+					node.translation[k] += origin[k];
+				model.extensionsUsed.push_back("KHR_mesh_quantization");
+				model.extensionsRequired.push_back("KHR_mesh_quantization");
+			}
+			else
+			{
+				vertex_data = get_float_vertex_data(vertex_buffer);
+				vertex_accessor = get_vertex_accessor(vertex_buffer);
+				stride = FLOAT_STRIDE;
+				node.translation = origin;
+			}
+
+			int buffer = is_meshopt_compressed ? 1 : 0;
+
 			model.scenes = { scene };
 			model.meshes = { mesh };
 			model.nodes = { node };
-			model.buffers =
-			{
-				get_buffer(vertex_buffer, index_buffer)
-			};
+			if (!is_meshopt_compressed)
+				model.buffers =
+				{
+					get_buffer(vertex_data, index_buffer)
+				};
 
 			model.bufferViews =
 			{
-				get_index_buffer_view(index_buffer),
-				get_vertex_buffer_view(vertex_buffer, index_buffer)
+				get_index_buffer_view(index_buffer, buffer),
+				get_vertex_buffer_view(vertex_data, index_buffer, buffer, stride)
 			};
 
 			model.accessors =
 			{
 				get_index_accessor(index_buffer, vertex_buffer.size() / 3),
-				get_vertex_accessor(vertex_buffer)
+				vertex_accessor
 			};
 
 			model.asset.version = "2.0";
@@ -261,10 +519,36 @@ namespace mbgrd2gltf
 			{
 				tinygltf::Material()
 			};
-			
-			tinygltf::TinyGLTF gltf;
 
-			gltf.WriteGltfSceneToFile(&model, output_filepath, false, true, true, options.is_binary_output());
+			if (is_meshopt_compressed)
+			{
+				write_meshopt_gltf(model, filepath, is_binary, vertex_data, stride, index_buffer);
+			}
+			else
+			{
+				tinygltf::TinyGLTF gltf;
+
+				if (!gltf.WriteGltfSceneToFile(&model, filepath, false, true, true, is_binary))
+					throw std::runtime_error("failed to write output file: " + filepath);
+			}
+
+			return get_file_size(filepath);
+		}
+
+		size_t write_gltf(const Geometry& geometry, const std::string& filepath, bool is_binary,
+			bool is_quantized, bool is_meshopt_compressed)
+		{
+			return write_mesh(get_vertex_buffer(geometry.vertices()), get_index_buffer(geometry.triangles()),
+				std::vector<double>(), filepath, is_binary, is_quantized, is_meshopt_compressed);
+		}
+
+		void write_gltf(const Geometry& geometry, const Options& options)
+		{
+			std::string output_filepath = options.output_filepath()
+				+ (options.is_binary_output() ? ".glb" : ".gltf");
+
+			write_gltf(geometry, output_filepath, options.is_binary_output(),
+				options.is_quantized(), options.is_meshopt_compressed());
 		}
 	}
 }
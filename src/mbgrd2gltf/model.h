@@ -38,11 +38,28 @@
 #include "geometry.h"
 #include "options.h"
 
+// standard library
+#include <cstdint>
+#include <string>
+#include <vector>
+
 namespace mbgrd2gltf
 {
 	namespace model
 	{
 		void write_gltf(const Geometry& geometry, const Options& options);
+
+		// Write the model to filepath with the given encoding, returning
+		// the size of the file written in bytes.
+		size_t write_gltf(const Geometry& geometry, const std::string& filepath, bool is_binary,
+			bool is_quantized, bool is_meshopt_compressed);
+
+		// Write a single mesh, vertex_buffer holding x, y, z positions
+		// relative to origin (empty for none) and index_buffer three
+		// vertex indices per triangle.
+		size_t write_mesh(const std::vector<float>& vertex_buffer, const std::vector<uint32_t>& index_buffer,
+			const std::vector<double>& origin, const std::string& filepath, bool is_binary,
+			bool is_quantized, bool is_meshopt_compressed);
 	}
 }
 
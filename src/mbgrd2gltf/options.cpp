@@ -37,6 +37,7 @@
 #include <stdexcept>
 #include <iostream>
 #include <stdio.h>
+#include <thread>
 
 #if defined(_WIN32) || defined(WIN32) || defined(WIN64)
 #define OS_IS_WINDOWS true
@@ -47,7 +48,10 @@
 const char * const usage_str =	  "usage: mbgrd2gltf <filepath> [-b | --binary] [(-o | --output) <output folder>]"\
 								"\n                              [(-e | --exaggeration) <vertical exaggeration>]"\
 								"\n                              [(-m | --max-size) <max size>]"\
-								"\n                              [(-c | --compression) <compression ratio>]";
+								"\n                              [(-c | --compression) <compression ratio>]"\
+								"\n                              [(-t | --threads) <threads>] [-q | --quantize]"\
+								"\n                              [-z | --meshopt] [--benchmark]"\
+								"\n                              [--tiles [--tile-error <tile error>]]";
 
 const char * const help_str =	"\nvariables:"\
 								"\n"\
@@ -67,7 +71,32 @@ const char * const help_str =	"\nvariables:"\
 								"\n    <compression ratio>       decimal number representing the the amount"\
 								"\n                              of compression to apply to the buffer data of the"\
 								"\n                              output as a ratio of uncompressed size to"\
-								"\n                              compressed size";
+								"\n                              compressed size"\
+								"\n"\
+								"\n    <threads>                 number of threads used to build the vertices and"\
+								"\n                              triangles (default: number of processors)"\
+								"\n"\
+								"\n    <tile error>              maximum vertical error in meters of the tiles one"\
+								"\n                              level above full resolution, doubling with each"\
+								"\n                              level above that (default: 1)"\
+								"\n"\
+								"\noptions:"\
+								"\n"\
+								"\n    -q | --quantize           store positions as 16 bit integers with the node"\
+								"\n                              transform restoring them (KHR_mesh_quantization),"\
+								"\n                              the precision is the model extent / 65535"\
+								"\n"\
+								"\n    -z | --meshopt            compress the index and vertex buffers"\
+								"\n                              (EXT_meshopt_compression)"\
+								"\n"\
+								"\n    --benchmark               time building the geometry with one and with all"\
+								"\n                              threads, then time writing and report the size of"\
+								"\n                              the output with each encoding before writing it"\
+								"\n"\
+								"\n    --tiles                   write a 3D Tiles tileset.json and a quadtree of"\
+								"\n                              glTF tiles with increasing levels of detail, each"\
+								"\n                              simplified to within its error, to the folder"\
+								"\n                              <output folder>/<input name>_tiles";
 
 const char * const try_help_str = "try 'mbgrd2gltf [-h | --help]' for more information";
 
@@ -96,7 +125,16 @@ namespace mbgrd2gltf
 		{ "-m", &Options::arg_max_size },
 		{ "--max-size", &Options::arg_max_size },
 		{ "-o", &Options::arg_output },
-		{ "--output", &Options::arg_output }
+		{ "--output", &Options::arg_output },
+		{ "-t", &Options::arg_threads },
+		{ "--threads", &Options::arg_threads },
+		{ "-q", &Options::arg_quantize },
+		{ "--quantize", &Options::arg_quantize },
+		{ "-z", &Options::arg_meshopt },
+		{ "--meshopt", &Options::arg_meshopt },
+		{ "--benchmark", &Options::arg_benchmark },
+		{ "--tiles", &Options::arg_tiles },
+		{ "--tile-error", &Options::arg_tile_error }
 	};
 
 	double parse_value(const char *token, const char *var_name)
@@ -156,6 +194,9 @@ namespace mbgrd2gltf
 		if (_is_max_size_set > 0)
 			throw std::invalid_argument("compression ratio may not be set when max size is set");
 
+		if (_is_tiled)
+			throw std::invalid_argument("compression ratio may not be set when writing tiles");
+
 		double value = get_value_double(args, size, i, "compression ratio");
 
 		if (value < 1.0)
@@ -174,6 +215,9 @@ namespace mbgrd2gltf
 		if (_is_compression_set)
 			throw std::invalid_argument("max size may not be set when compression ratio is set");
 
+		if (_is_tiled)
+			throw std::invalid_argument("max size may not be set when writing tiles");
+
 
 		double value = get_value_double(args, size, i, "max size");		
 		if (value < 0.0001)
@@ -200,6 +244,71 @@ namespace mbgrd2gltf
 		_is_exaggeration_set = true;
 	}
 
+	void Options::arg_threads(const char **args, unsigned size, unsigned& i)
+	{
+		if (_is_thread_count_set)
+			throw std::invalid_argument("threads may not be specified more than once");
+
+		double value = get_value_double(args, size, i, "threads");
+
+		if (value < 1.0 || value != (double)(unsigned)value)
+			throw std::invalid_argument("expected a whole number of threads >= 1 but got: "
+				+ std::to_string(value));
+
+		_thread_count = (unsigned)value;
+		_is_thread_count_set = true;
+	}
+
+	void Options::arg_quantize(const char **, unsigned, unsigned&)
+	{
+		if (_is_quantized)
+			throw std::invalid_argument("quantize may not be specified more than once");
+
+		_is_quantized = true;
+	}
+
+	void Options::arg_meshopt(const char **, unsigned, unsigned&)
+	{
+		if (_is_meshopt_compressed)
+			throw std::invalid_argument("meshopt may not be specified more than once");
+
+		_is_meshopt_compressed = true;
+	}
+
+	void Options::arg_benchmark(const char **, unsigned, unsigned&)
+	{
+		if (_is_benchmark)
+			throw std::invalid_argument("benchmark may not be specified more than once");
+
+		_is_benchmark = true;
+	}
+
+	void Options::arg_tiles(const char **, unsigned, unsigned&)
+	{
+		if (_is_tiled)
+			throw std::invalid_argument("tiles may not be specified more than once");
+
+		if (_is_compression_set || _is_max_size_set)
+			throw std::invalid_argument("tiles may not be written when compression ratio or max size is set");
+
+		_is_tiled = true;
+	}
+
+	void Options::arg_tile_error(const char **args, unsigned size, unsigned& i)
+	{
+		if (_is_tile_error_set)
+			throw std::invalid_argument("tile error may not be specified more than once");
+
+		double value = get_value_double(args, size, i, "tile error");
+
+		if (value <= 0.0)
+			throw std::invalid_argument("expected tile error > 0 but got: "
+				+ std::to_string(value));
+
+		_tile_error = value;
+		_is_tile_error_set = true;
+	}
+
 	PathInfo get_path_info(const char *filepath)
 	{
 		const char *start_of_filename = filepath;
@@ -257,6 +366,11 @@ namespace mbgrd2gltf
 			return;
 		}
 
+		unsigned processor_count = std::thread::hardware_concurrency();
+
+		if (processor_count > 0)
+			_thread_count = processor_count;
+
 		auto path_info = get_path_info(argv[1]);
 		_output_filepath = path_info.folder;
 		unsigned args_size = argc - 2;
@@ -280,6 +394,9 @@ namespace mbgrd2gltf
 			(this->*callback)(args, args_size, i);
 		}
 
+		if (_is_tile_error_set && !_is_tiled)
+			throw std::invalid_argument("tile error may only be set when writing tiles");
+
 		if (_output_filepath.empty())
 		{
 			_output_filepath = ".";
@@ -53,12 +53,20 @@ namespace mbgrd2gltf
 		double _compression_ratio = 1.0;
 		size_t _max_size = 0;
 		double _exaggeration = 1.0;
+		double _tile_error = 1.0;
+		unsigned _thread_count = 1;
 		bool _is_binary_output = false;
+		bool _is_quantized = false;
+		bool _is_meshopt_compressed = false;
+		bool _is_benchmark = false;
+		bool _is_tiled = false;
 		bool _is_help = false;
 		bool _is_compression_set = false;
 		bool _is_max_size_set = false;
 		bool _is_exaggeration_set = false;
 		bool _is_output_folder_set = false;
+		bool _is_thread_count_set = false;
+		bool _is_tile_error_set = false;
 
 		static const std::unordered_map<std::string, ArgCallback> arg_callbacks;
 
@@ -69,6 +77,12 @@ namespace mbgrd2gltf
 		void arg_compression(const char **args, unsigned size, unsigned& i);
 		void arg_max_size(const char **args, unsigned size, unsigned& i);
 		void arg_exaggeration(const char **args, unsigned size, unsigned& i);
+		void arg_threads(const char **args, unsigned size, unsigned& i);
+		void arg_quantize(const char **args, unsigned size, unsigned& i);
+		void arg_meshopt(const char **args, unsigned size, unsigned& i);
+		void arg_benchmark(const char **args, unsigned size, unsigned& i);
+		void arg_tiles(const char **args, unsigned size, unsigned& i);
+		void arg_tile_error(const char **args, unsigned size, unsigned& i);
 
 	public: // members
 
@@ -79,7 +93,13 @@ namespace mbgrd2gltf
 		double compression_ratio() const { return _compression_ratio; }
 		size_t max_size() const { return _max_size; }
 		double exaggeration() const { return _exaggeration; }
+		double tile_error() const { return _tile_error; }
+		unsigned thread_count() const { return _thread_count; }
 		bool is_binary_output() const { return _is_binary_output; }
+		bool is_quantized() const { return _is_quantized; }
+		bool is_meshopt_compressed() const { return _is_meshopt_compressed; }
+		bool is_benchmark() const { return _is_benchmark; }
+		bool is_tiled() const { return _is_tiled; }
 		bool is_help() const { return _is_help; }
 		bool is_compression_set() const { return _is_compression_set; }
 		bool is_max_size_set() const { return _is_max_size_set; }
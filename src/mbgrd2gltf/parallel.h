@@ -0,0 +1,88 @@
+/*--------------------------------------------------------------------
+ *    The MB-system:	parallel.h	10/19/2026
+ *
+ *    Copyright (c) 2026 by the MB-System Team
+ *
+ *    MB-System was created by Caress and Chayes in 1992 at the
+ *      Lamont-Doherty Earth Observatory
+ *      Columbia University
+ *      Palisades, NY 10964
+ *
+ *    See README.md file for copying and redistribution conditions.
+ *--------------------------------------------------------------------*/
+/*
+ *    Part of the program MBgrd2gltf, which was created by a Capstone
+ *    Project team at the California State University Monterey Bay
+ *    (CSUMB). This file was added later by the MB-System Team.
+ *--------------------------------------------------------------------*/
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+// standard library
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mbgrd2gltf
+{
+	// Call function(i) for every i in [0, count) using up to thread_count
+	// threads, each taking the next index from a shared counter. The first
+	// exception thrown by any call is rethrown in the calling thread.
+	template <typename Function>
+	void parallel_for(size_t count, unsigned thread_count, Function function)
+	{
+		if (thread_count > count)
+			thread_count = (unsigned)count;
+
+		if (thread_count <= 1)
+		{
+			for (size_t i = 0; i < count; ++i)
+				function(i);
+
+			return;
+		}
+
+		std::atomic<size_t> next(0);
+		std::exception_ptr error;
+		std::mutex error_mutex;
+
+		auto worker = [&]()
+		{
+			try
+			{
+				for (size_t i = next++; i < count; i = next++)
+					function(i);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(error_mutex);
+
+				if (!error)
+					error = std::current_exception();
+
+				next = count;
+			}
+		};
+
+		std::vector<std::thread> threads;
+
+		threads.reserve(thread_count - 1);
+
+		for (unsigned t = 1; t < thread_count; ++t)
+			threads.emplace_back(worker);
+
+		worker();
+
+		for (auto& thread : threads)
+			thread.join();
+
+		if (error)
+			std::rethrow_exception(error);
+	}
+}
+
+#endif
@@ -0,0 +1,435 @@
+/*--------------------------------------------------------------------
+ *    The MB-system:	tiles.cpp	10/19/2026
+ *
+ *    Copyright (c) 2026 by the MB-System Team
+ *
+ *    MB-System was created by Caress and Chayes in 1992 at the
+ *      Lamont-Doherty Earth Observatory
+ *      Columbia University
+ *      Palisades, NY 10964
+ *
+ *    See README.md file for copying and redistribution conditions.
+ *--------------------------------------------------------------------*/
+/*
+ *    Part of the program MBgrd2gltf, which was created by a Capstone
+ *    Project team at the California State University Monterey Bay
+ *    (CSUMB). This file was added later by the MB-System Team.
+ *--------------------------------------------------------------------*/
+
+#include "tiles.h"
+#include "geometry.h"
+#include "model.h"
+#include "parallel.h"
+
+// standard library
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+// external libraries
+#include "tinygltf/json.hpp"
+
+#if defined(_WIN32) || defined(WIN32) || defined(WIN64)
+#include <direct.h>
+#define make_directory(path) _mkdir(path)
+#else
+#include <sys/stat.h>
+#define make_directory(path) mkdir(path, 0755)
+#endif
+
+// Cells along each side of a full resolution tile
+#define TILE_CELLS 256
+
+namespace mbgrd2gltf
+{
+	namespace tiles
+	{
+		// Heights of the grid samples and, for the right-triangulated
+		// irregular network (RTIN) over them, the error at each sample of
+		// leaving out the triangles it splits. The network covers a square
+		// of size cells, a power of two, whose samples outside the grid or
+		// without data have infinite error so that triangles are only made
+		// from valid samples.
+		struct Heightfield
+		{
+			const float *altitudes;
+			double exaggeration;
+			int64_t size_x;
+			int64_t size_y;
+			int64_t size;
+			std::vector<float> errors;
+
+			bool is_inside(int64_t x, int64_t y) const
+			{
+				return x >= 0 && y >= 0 && x < size_x && y < size_y;
+			}
+
+			double height(int64_t x, int64_t y) const
+			{
+				return is_inside(x, y)
+					? (double)altitudes[x + y * size_x] * exaggeration
+					: std::numeric_limits<double>::quiet_NaN();
+			}
+
+			bool is_valid(int64_t x, int64_t y) const
+			{
+				return !std::isnan(height(x, y));
+			}
+
+			float error(int64_t x, int64_t y) const
+			{
+				return is_inside(x, y) ? errors[x + y * size_x] : std::numeric_limits<float>::infinity();
+			}
+		};
+
+		struct Tile
+		{
+			int64_t x0;
+			int64_t y0;
+			int64_t x1;
+			int64_t y1;
+			bool exists;
+			size_t triangle_count;
+			double height_min;
+			double height_max;
+		};
+
+		// Triangles are (a, b, c) with the hypotenuse from a to b, which
+		// splits at its midpoint m into (c, a, m) and (b, c, m). The error
+		// stored at m bounds the largest height difference between the
+		// samples inside the triangle and the plane through its corners:
+		// the difference at m plus the larger error of the children, whose
+		// planes differ from the parent's only by that at m. Triangles on
+		// both sides of a hypotenuse share the larger error, so they always
+		// split together and leave no cracks. The triangles of each depth
+		// are done after all those of the next depth, by calling this with
+		// each depth from the deepest up.
+		void compute_errors(Heightfield& heightfield, int depth, int target_depth,
+			int64_t ax, int64_t ay, int64_t bx, int64_t by, int64_t cx, int64_t cy)
+		{
+			if (std::abs(ax - cx) + std::abs(ay - cy) <= 1)
+				return;
+
+			if (std::min(std::min(ax, bx), cx) >= heightfield.size_x
+				|| std::min(std::min(ay, by), cy) >= heightfield.size_y)
+				return;
+
+			int64_t mx = (ax + bx) / 2;
+			int64_t my = (ay + by) / 2;
+
+			if (depth < target_depth)
+			{
+				compute_errors(heightfield, depth + 1, target_depth, cx, cy, ax, ay, mx, my);
+				compute_errors(heightfield, depth + 1, target_depth, bx, by, cx, cy, mx, my);
+				return;
+			}
+
+			if (!heightfield.is_inside(mx, my))
+				return;
+
+			double error = std::fabs((heightfield.height(ax, ay) + heightfield.height(bx, by)) / 2.0
+				- heightfield.height(mx, my));
+
+			if (std::isnan(error) || !heightfield.is_valid(cx, cy))
+				error = std::numeric_limits<double>::infinity();
+
+			// Children whose legs are single cells are exact.
+			if (!(std::abs(ax - cx) == 1 && std::abs(ay - cy) == 1))
+				error += std::max(heightfield.error((ax + cx) / 2, (ay + cy) / 2),
+					heightfield.error((bx + cx) / 2, (by + cy) / 2));
+
+			float& stored = heightfield.errors[mx + my * heightfield.size_x];
+
+			if (error > stored)
+				stored = (float)error;
+		}
+
+		// Add the corners of the triangles within the tile that meet
+		// max_error. Triangles larger than the tile always split, so each
+		// tile gets the part of the network it covers.
+		void get_tile_triangles(const Heightfield& heightfield, const Tile& tile, double max_error,
+			int64_t ax, int64_t ay, int64_t bx, int64_t by, int64_t cx, int64_t cy, std::vector<int64_t>& corners)
+		{
+			int64_t x_min = std::min(std::min(ax, bx), cx);
+			int64_t x_max = std::max(std::max(ax, bx), cx);
+			int64_t y_min = std::min(std::min(ay, by), cy);
+			int64_t y_max = std::max(std::max(ay, by), cy);
+
+			if (x_max <= tile.x0 || x_min >= tile.x1 || y_max <= tile.y0 || y_min >= tile.y1
+				|| x_min >= heightfield.size_x || y_min >= heightfield.size_y)
+				return;
+
+			bool is_smallest = std::abs(ax - cx) + std::abs(ay - cy) <= 1;
+			bool is_within_tile = x_min >= tile.x0 && x_max <= tile.x1 && y_min >= tile.y0 && y_max <= tile.y1;
+			bool is_valid = heightfield.is_valid(ax, ay) && heightfield.is_valid(bx, by) && heightfield.is_valid(cx, cy);
+			int64_t mx = (ax + bx) / 2;
+			int64_t my = (ay + by) / 2;
+
+			if (!is_smallest && (!is_within_tile || !is_valid || heightfield.error(mx, my) > max_error))
+			{
+				get_tile_triangles(heightfield, tile, max_error, cx, cy, ax, ay, mx, my, corners);
+				get_tile_triangles(heightfield, tile, max_error, bx, by, cx, cy, mx, my, corners);
+			}
+			else if (is_valid)
+			{
+				corners.push_back(ax + ay * heightfield.size_x);
+				corners.push_back(bx + by * heightfield.size_x);
+				corners.push_back(cx + cy * heightfield.size_x);
+			}
+		}
+
+		double get_level_error(const Options& options, int level, int level_count)
+		{
+			if (level == level_count - 1)
+				return 0.0;
+
+			return options.tile_error() * std::pow(2.0, (double)(level_count - 2 - level));
+		}
+
+		std::string get_tile_name(int level, size_t x, size_t y, const Options& options)
+		{
+			return std::to_string(level) + "_" + std::to_string(x) + "_" + std::to_string(y)
+				+ (options.is_binary_output() ? ".glb" : ".gltf");
+		}
+
+		void get_height_range(const Heightfield& heightfield, Tile& tile)
+		{
+			tile.height_min = std::numeric_limits<double>::infinity();
+			tile.height_max = -std::numeric_limits<double>::infinity();
+
+			for (int64_t y = tile.y0; y <= tile.y1 && y < heightfield.size_y; ++y)
+			{
+				for (int64_t x = tile.x0; x <= tile.x1 && x < heightfield.size_x; ++x)
+				{
+					double height = heightfield.height(x, y);
+
+					if (!std::isnan(height))
+					{
+						tile.height_min = std::min(tile.height_min, height);
+						tile.height_max = std::max(tile.height_max, height);
+					}
+				}
+			}
+		}
+
+		// Positions are earth centered, relative to the center of the tile
+		// for precision, and turned y up as glTF tiles are turned z up when
+		// a tileset is displayed.
+		void write_tile(const Bathymetry& bathymetry, const Heightfield& heightfield, Tile& tile,
+			double max_error, const std::string& filepath, const Options& options)
+		{
+			std::vector<int64_t> corners;
+			int64_t size = heightfield.size;
+
+			get_tile_triangles(heightfield, tile, max_error, 0, 0, size, size, size, 0, corners);
+			get_tile_triangles(heightfield, tile, max_error, size, size, 0, 0, 0, size, corners);
+
+			tile.triangle_count = corners.size() / 3;
+			tile.exists = !corners.empty();
+
+			if (!tile.exists)
+				return;
+
+			get_height_range(heightfield, tile);
+
+			int64_t x_end = std::min(tile.x1, heightfield.size_x - 1);
+			int64_t y_end = std::min(tile.y1, heightfield.size_y - 1);
+			double center[3];
+
+			Geometry::get_earth_centered_position(
+				(Geometry::get_longitude(bathymetry, tile.x0) + Geometry::get_longitude(bathymetry, x_end)) / 2.0,
+				(Geometry::get_latitude(bathymetry, tile.y0) + Geometry::get_latitude(bathymetry, y_end)) / 2.0,
+				(tile.height_min + tile.height_max) / 2.0, center);
+
+			std::unordered_map<int64_t, uint32_t> vertex_ids;
+			std::vector<float> vertex_buffer;
+			std::vector<uint32_t> index_buffer;
+
+			vertex_ids.reserve(corners.size() / 2);
+			index_buffer.reserve(corners.size());
+
+			for (int64_t corner : corners)
+			{
+				auto inserted = vertex_ids.emplace(corner, (uint32_t)(vertex_buffer.size() / 3));
+
+				if (inserted.second)
+				{
+					int64_t x = corner % heightfield.size_x;
+					int64_t y = corner / heightfield.size_x;
+					double position[3];
+
+					Geometry::get_earth_centered_position(Geometry::get_longitude(bathymetry, x),
+						Geometry::get_latitude(bathymetry, y), heightfield.height(x, y), position);
+
+					vertex_buffer.push_back((float)(position[0] - center[0]));
+					vertex_buffer.push_back((float)(position[2] - center[2]));
+					vertex_buffer.push_back((float)(center[1] - position[1]));
+				}
+
+				index_buffer.push_back(inserted.first->second);
+			}
+
+			model::write_mesh(vertex_buffer, index_buffer, { center[0], center[2], -center[1] }, filepath,
+				options.is_binary_output(), options.is_quantized(), options.is_meshopt_compressed());
+		}
+
+		double to_radians(double degrees)
+		{
+			if (degrees > 180.0)
+				degrees -= 360.0;
+
+			return degrees * M_PI / 180.0;
+		}
+
+		nlohmann::json get_tile_json(const Bathymetry& bathymetry, const std::vector<std::vector<Tile>>& levels,
+			const std::vector<size_t>& level_widths, int level, size_t x, size_t y, const Options& options)
+		{
+			const Tile& tile = levels[level][x + y * level_widths[level]];
+			int64_t x_end = std::min<int64_t>(tile.x1, bathymetry.size_x() - 1);
+			int64_t y_end = std::min<int64_t>(tile.y1, bathymetry.size_y() - 1);
+			nlohmann::json out;
+
+			out["boundingVolume"]["region"] =
+			{
+				to_radians(Geometry::get_longitude(bathymetry, tile.x0)),
+				to_radians(Geometry::get_latitude(bathymetry, y_end)),
+				to_radians(Geometry::get_longitude(bathymetry, x_end)),
+				to_radians(Geometry::get_latitude(bathymetry, tile.y0)),
+				tile.height_min,
+				tile.height_max
+			};
+			out["geometricError"] = get_level_error(options, level, (int)levels.size());
+			out["content"]["uri"] = get_tile_name(level, x, y, options);
+
+			nlohmann::json children = nlohmann::json::array();
+
+			if (level + 1 < (int)levels.size())
+			{
+				size_t width = level_widths[level + 1];
+				size_t height = levels[level + 1].size() / width;
+
+				for (size_t j = 2 * y; j < 2 * y + 2 && j < height; ++j)
+					for (size_t i = 2 * x; i < 2 * x + 2 && i < width; ++i)
+						if (levels[level + 1][i + j * width].exists)
+							children.push_back(get_tile_json(bathymetry, levels, level_widths, level + 1, i, j, options));
+			}
+
+			if (!children.empty())
+				out["children"] = children;
+
+			return out;
+		}
+
+		void write_tiles(const Bathymetry& bathymetry, const Options& options)
+		{
+			if (bathymetry.size_x() < 2 || bathymetry.size_y() < 2)
+				throw std::invalid_argument("grid must be at least 2 by 2 to write tiles");
+
+			Heightfield heightfield;
+
+			heightfield.altitudes = bathymetry.altitudes().data();
+			heightfield.exaggeration = options.exaggeration();
+			heightfield.size_x = bathymetry.size_x();
+			heightfield.size_y = bathymetry.size_y();
+			heightfield.size = TILE_CELLS;
+
+			int level_count = 1;
+
+			while (heightfield.size < heightfield.size_x - 1 || heightfield.size < heightfield.size_y - 1)
+			{
+				heightfield.size *= 2;
+				++level_count;
+			}
+
+			heightfield.errors.assign(heightfield.size_x * heightfield.size_y, 0.0f);
+
+			int64_t size = heightfield.size;
+
+			// Each halving of the triangle legs takes two levels of splits.
+			int max_depth = 0;
+
+			for (int64_t leg = size; leg > 1; leg /= 2)
+				max_depth += 2;
+
+			for (int depth = max_depth; depth >= 0; --depth)
+			{
+				compute_errors(heightfield, 0, depth, 0, 0, size, size, size, 0);
+				compute_errors(heightfield, 0, depth, size, size, 0, 0, 0, size);
+			}
+
+			std::string folder = options.output_filepath() + "_tiles";
+
+			if (make_directory(folder.c_str()) != 0 && errno != EEXIST)
+				throw std::runtime_error("failed to create tiles folder: " + folder);
+
+			std::vector<std::vector<Tile>> levels(level_count);
+			std::vector<size_t> level_widths(level_count);
+
+			for (int level = 0; level < level_count; ++level)
+			{
+				int64_t tile_size = size >> level;
+				size_t width = (size_t)((heightfield.size_x - 2) / tile_size + 1);
+				size_t height = (size_t)((heightfield.size_y - 2) / tile_size + 1);
+				double max_error = get_level_error(options, level, level_count);
+				auto& tiles = levels[level];
+
+				level_widths[level] = width;
+				tiles.resize(width * height);
+
+				parallel_for(tiles.size(), options.thread_count(), [&](size_t i)
+				{
+					Tile& tile = tiles[i];
+					size_t x = i % width;
+					size_t y = i / width;
+
+					tile.x0 = (int64_t)x * tile_size;
+					tile.y0 = (int64_t)y * tile_size;
+					tile.x1 = tile.x0 + tile_size;
+					tile.y1 = tile.y0 + tile_size;
+
+					write_tile(bathymetry, heightfield, tile, max_error,
+						folder + "/" + get_tile_name(level, x, y, options), options);
+				});
+
+				size_t tile_count = 0;
+				size_t triangle_count = 0;
+
+				for (const Tile& tile : tiles)
+				{
+					tile_count += tile.exists;
+					triangle_count += tile.triangle_count;
+				}
+
+				printf("level %d: %zu tiles, %zu triangles, max error %g m\n", level, tile_count,
+					triangle_count, max_error);
+			}
+
+			if (!levels[0][0].exists)
+				throw std::runtime_error("grid contains no valid values");
+
+			nlohmann::json tileset;
+
+			tileset["asset"]["version"] = "1.1";
+			tileset["asset"]["generator"] = "mbgrd2gltf";
+			tileset["geometricError"] = level_count > 1
+				? 2.0 * get_level_error(options, 0, level_count)
+				: options.tile_error();
+			tileset["root"] = get_tile_json(bathymetry, levels, level_widths, 0, 0, 0, options);
+			tileset["root"]["refine"] = "REPLACE";
+
+			std::ofstream file(folder + "/tileset.json");
+
+			file << tileset.dump(1, '\t') << std::endl;
+
+			if (!file)
+				throw std::runtime_error("failed to write tileset: " + folder + "/tileset.json");
+		}
+	}
+}
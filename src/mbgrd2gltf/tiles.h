@@ -0,0 +1,38 @@
+/*--------------------------------------------------------------------
+ *    The MB-system:	tiles.h	10/19/2026
+ *
+ *    Copyright (c) 2026 by the MB-System Team
+ *
+ *    MB-System was created by Caress and Chayes in 1992 at the
+ *      Lamont-Doherty Earth Observatory
+ *      Columbia University
+ *      Palisades, NY 10964
+ *
+ *    See README.md file for copying and redistribution conditions.
+ *--------------------------------------------------------------------*/
+/*
+ *    Part of the program MBgrd2gltf, which was created by a Capstone
+ *    Project team at the California State University Monterey Bay
+ *    (CSUMB). This file was added later by the MB-System Team.
+ *--------------------------------------------------------------------*/
+
+#ifndef TILES_H
+#define TILES_H
+
+// local includes
+#include "bathymetry.h"
+#include "options.h"
+
+namespace mbgrd2gltf
+{
+	namespace tiles
+	{
+		// Write the grid as a 3D Tiles tileset: a quadtree of glTF tiles,
+		// the leaves at full resolution and each level above simplified to
+		// twice the vertical error of the level below, with tileset.json
+		// indexing them.
+		void write_tiles(const Bathymetry& bathymetry, const Options& options);
+	}
+}
+
+#endif
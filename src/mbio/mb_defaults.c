@@ -604,3 +604,109 @@ int mb_fileiobuffer(int verbose, int *fileiobuffer) {
   return (status);
 }
 /*--------------------------------------------------------------------*/
+/* NetCDF output: -1 writes classic netCDF files, 0 to 9 write NetCDF-4
+ * (classic model) files with the per-ping variables chunked and deflated
+ * at that level (0 is chunked but not compressed) */
+int mb_netcdfdeflate(int verbose, int *netcdfdeflate) {
+  if (verbose >= 2) {
+    fprintf(stderr, "\ndbg2  MBIO function <%s> called\n", __func__);
+    fprintf(stderr, "dbg2  Input arguments:\n");
+    fprintf(stderr, "dbg2       verbose: %d\n", verbose);
+  }
+
+  /* set system default values */
+  *netcdfdeflate = -1;
+
+  /* set the filename */
+  const char *home_ptr = getenv(HOME);
+  if (home_ptr != NULL) {
+    char file[MB_PATH_MAXLINE];
+    strcpy(file, home_ptr);
+    strcat(file, "/.mbio_defaults");
+
+    /* open and read values from file if possible */
+    FILE *fp = fopen(file, "r");
+    if (fp != NULL) {
+      char string[MB_PATH_MAXLINE];
+      while (fgets(string, sizeof(string), fp) != NULL) {
+        if (strncmp(string, "netcdfdeflate:", 14) == 0)
+          sscanf(string, "netcdfdeflate:%d", netcdfdeflate);
+      }
+      fclose(fp);
+    }
+  }
+  *netcdfdeflate = MAX(-1, MIN(9, *netcdfdeflate));
+
+  /* successful no matter what happens */
+  const int status = MB_SUCCESS;
+
+  if (verbose >= 2) {
+    fprintf(stderr, "\ndbg2  MBIO function <%s> completed\n", __func__);
+    fprintf(stderr, "dbg2  Return values:\n");
+    fprintf(stderr, "dbg2       netcdfdeflate: %d\n", *netcdfdeflate);
+    fprintf(stderr, "dbg2  Return status:\n");
+    fprintf(stderr, "dbg2       status:        %d\n", status);
+  }
+
+  return (status);
+}
+/*--------------------------------------------------------------------*/
+/* Columnar ancillary files (navigation, sensor depth, attitude, etc.):
+ * when true, large files are cached after parsing in a binary file next
+ * to the source file (the source file name plus ".mbcache") and read
+ * from the cache while the source file is unchanged */
+int mb_navintcache(int verbose, bool *navintcache) {
+  if (verbose >= 2) {
+    fprintf(stderr, "\ndbg2  MBIO function <%s> called\n", __func__);
+    fprintf(stderr, "dbg2  Input arguments:\n");
+    fprintf(stderr, "dbg2       verbose: %d\n", verbose);
+  }
+
+  /* set system default values */
+  *navintcache = false;
+
+  /* set the filename */
+  const char *home_ptr = getenv(HOME);
+  if (home_ptr != NULL) {
+    char file[MB_PATH_MAXLINE];
+    strcpy(file, home_ptr);
+    strcat(file, "/.mbio_defaults");
+
+    /* open and read values from file if possible */
+    FILE *fp = fopen(file, "r");
+    if (fp != NULL) {
+      char string[MB_PATH_MAXLINE];
+      int navintcacheint = 0;
+      while (fgets(string, sizeof(string), fp) != NULL) {
+        if (strncmp(string, "navintcache:", 12) == 0 && sscanf(string, "navintcache:%d", &navintcacheint) == 1)
+          *navintcache = navintcacheint != 0;
+      }
+      fclose(fp);
+    }
+  }
+
+  /* successful no matter what happens */
+  const int status = MB_SUCCESS;
+
+  if (verbose >= 2) {
+    fprintf(stderr, "\ndbg2  MBIO function <%s> completed\n", __func__);
+    fprintf(stderr, "dbg2  Return values:\n");
+    fprintf(stderr, "dbg2       navintcache: %d\n", *navintcache);
+    fprintf(stderr, "dbg2  Return status:\n");
+    fprintf(stderr, "dbg2       status:      %d\n", status);
+  }
+
+  return (status);
+}
+/*--------------------------------------------------------------------*/
+/* Number of worker threads to use for a threaded computation: a
+ * non-positive request means use all available cores, and the result
+ * is limited to MB_THREAD_MAX */
+int mb_nthreads(int nthreads) {
+  if (nthreads <= 0) {
+    const long ncores = sysconf(_SC_NPROCESSORS_ONLN);
+    nthreads = ncores > 0 ? (int)ncores : 1;
+  }
+  return (MIN(nthreads, MB_THREAD_MAX));
+}
+/*--------------------------------------------------------------------*/
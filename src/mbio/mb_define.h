@@ -322,6 +322,9 @@ int mb_mbview_defaults(int verbose, int *primary_colortable, int *primary_colort
 int mb_fbtversion(int verbose, int *fbtversion);
 int mb_uselockfiles(int verbose, bool *uselockfiles);
 int mb_fileiobuffer(int verbose, int *fileiobuffer);
+int mb_netcdfdeflate(int verbose, int *netcdfdeflate);
+int mb_navintcache(int verbose, bool *navintcache);
+int mb_nthreads(int nthreads);
 int mb_format_register(int verbose, int *format, void *mbio_ptr, int *error);
 int mb_format_info(int verbose, int *format, int *system, int *beams_bath_max, int *beams_amp_max, int *pixels_ss_max,
                    char *format_name, char *system_name, char *format_description, int *numfile, int *filetype,
@@ -397,6 +400,9 @@ int mb_input_init(int verbose, char *socket_definition, int format, int pings,
                   int (*input_read)(int verbose, void *mbio_ptr, size_t *size, char *buffer, int *error),
                   int (*input_close)(int verbose, void *mbio_ptr, int *error),
                   int *error);
+int mb_input_lease_init(int verbose, void *mbio_ptr,
+                  int (*input_lease)(int verbose, void *mbio_ptr, char **frame, size_t *size, int *error),
+                  int *error);
 int mb_write_init(int verbose, char *file, int format, void **mbio_ptr, int *beams_bath, int *beams_amp, int *pixels_ss,
                   int *error);
 int mb_close(int verbose, void **mbio_ptr, int *error);
@@ -422,6 +428,7 @@ int mb_put_comment(int verbose, void *mbio_ptr, char *comment, int *error);
 int mb_fileio_open(int verbose, void *mbio_ptr, int *error);
 int mb_fileio_close(int verbose, void *mbio_ptr, int *error);
 int mb_fileio_get(int verbose, void *mbio_ptr, char *buffer, size_t *size, int *error);
+int mb_fileio_lease(int verbose, void *mbio_ptr, char **frame, size_t *size, int *error);
 int mb_fileio_put(int verbose, void *mbio_ptr, char *buffer, size_t *size, int *error);
 int mb_copyfile(int verbose, const char *src, const char *dst, int *error);
 int mb_catfiles(int verbose, const char *src1, const char *src2, const char *dst, int *error);
@@ -613,6 +620,7 @@ int mb_depint_add(int verbose, void *mbio_ptr, double time_d, double sensordepth
 int mb_depint_interp(int verbose, void *mbio_ptr, double time_d, double *sensordepth, int *error);
 int mb_altint_add(int verbose, void *mbio_ptr, double time_d, double altitude, int *error);
 int mb_altint_interp(int verbose, void *mbio_ptr, double time_d, double *altitude, int *error);
+int mb_navint_threads(int verbose, int nthreads, int *error);
 int mb_loadnavdata(int verbose, char *merge_nav_file, int merge_nav_format, int merge_nav_lonflip, int *merge_nav_num,
                    int *merge_nav_alloc, double **merge_nav_time_d, double **merge_nav_lon, double **merge_nav_lat,
                    double **merge_nav_speed, int *error);
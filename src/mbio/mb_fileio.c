@@ -31,6 +31,8 @@
  *   mb_fileio_open  - initialize i/o, called by mb_read_init() and mb_write_init()
  *   mb_fileio_close  - cleanup i/o, called by mb_close()
  *   mb_fileio_get  - get bytes from input
+ *   mb_fileio_lease  - get pointer to next complete frame from application
+ *                      defined (socket) input without copying
  *   mb_fileio_put  - put bytes to output
  *
  * Author:  D. W. Caress
@@ -193,6 +195,44 @@ int mb_fileio_get(int verbose, void *mbio_ptr, char *buffer, size_t *size, int *
   return (status);
 }
 /*--------------------------------------------------------------------*/
+int mb_fileio_lease(int verbose, void *mbio_ptr, char **frame, size_t *size, int *error) {
+  if (verbose >= 2) {
+    fprintf(stderr, "\ndbg2  MBIO function <%s> called\n", __func__);
+    fprintf(stderr, "dbg2  Input arguments:\n");
+    fprintf(stderr, "dbg2       verbose:    %d\n", verbose);
+    fprintf(stderr, "dbg2       mbio_ptr:   %p\n", (void *)mbio_ptr);
+    fprintf(stderr, "dbg2       frame:      %p\n", (void *)frame);
+  }
+
+  struct mb_io_struct *mb_io_ptr = (struct mb_io_struct *)mbio_ptr;
+
+  int status = MB_SUCCESS;
+
+  /* get a pointer to the next complete frame held by the input,
+     rather than copying it into a format buffer */
+  if (mb_io_ptr->mbsp != NULL && mb_io_ptr->mb_io_input_lease != NULL) {
+    status = mb_io_ptr->mb_io_input_lease(verbose, mbio_ptr, frame, size, error);
+  }
+  else {
+    status = MB_FAILURE;
+    *error = MB_ERROR_BAD_USAGE;
+    *frame = NULL;
+    *size = 0;
+  }
+
+  if (verbose >= 2) {
+    fprintf(stderr, "\ndbg2  MBIO function <%s> completed\n", __func__);
+    fprintf(stderr, "dbg2  Return values:\n");
+    fprintf(stderr, "dbg2       *frame:     %p\n", (void *)(*frame));
+    fprintf(stderr, "dbg2       *size:      %zu\n", *size);
+    fprintf(stderr, "dbg2       error:      %d\n", *error);
+    fprintf(stderr, "dbg2  Return status:\n");
+    fprintf(stderr, "dbg2       status:  %d\n", status);
+  }
+
+  return (status);
+}
+/*--------------------------------------------------------------------*/
 int mb_fileio_put(int verbose, void *mbio_ptr, char *buffer, size_t *size, int *error) {
   if (verbose >= 2) {
     fprintf(stderr, "\ndbg2  MBIO function <%s> called\n", __func__);
@@ -816,6 +816,11 @@ struct mb_io_struct {
   int (*mb_io_input_read)(int verbose, void *mbio_ptr, size_t *size, char *buffer, int *error);
   int (*mb_io_input_close)(int verbose, void *mbio_ptr, int *error);
 
+  /* optional function pointer returning the next complete input frame in
+     place (zero-copy); the frame remains valid until the next read or lease
+     call. Set through mb_input_lease_init(), NULL if not supported */
+  int (*mb_io_input_lease)(int verbose, void *mbio_ptr, char **frame, size_t *size, int *error);
+
 };
 
 /* MBIO buffer control structure */
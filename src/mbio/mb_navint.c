@@ -30,10 +30,14 @@
  */
 
 #include <math.h>
+#include <pthread.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "mb_define.h"
 #include "mb_io.h"
@@ -46,6 +50,19 @@
 //    #define MB_DEPINT_DEBUG 1
 //    #define MB_ALTINT_DEBUG 1
 
+/* columnar ancillary file parsing and caching */
+#define MB_NAVINT_COLUMNS_MAX 4
+#define MB_NAVINT_THREAD_LINES 100000
+#define MB_NAVINT_CACHE_MIN 10000
+#define MB_NAVINT_CACHE_SUFFIX ".mbcache"
+#define MB_NAVINT_CACHE_MAGIC "MBNVCCH2"
+#define MB_NAVINT_CACHE_BYTEORDER 0x01020304
+
+/* Gaussian time filter: windows wider than this many samples on uniformly
+   sampled data are filtered with a cascade of box filters */
+#define MB_TIME_FILTER_EXACT_MAX 32
+#define MB_TIME_FILTER_NBOX 3
+
 /*--------------------------------------------------------------------*/
 /* 	function mb_navint_add adds a nav fix to the internal
         list used for interpolation/extrapolation. */
@@ -1161,6 +1178,377 @@ int mb_altint_interp(int verbose, void *mbio_ptr, double time_d, double *altitud
 	return (status);
 }
 
+/*--------------------------------------------------------------------*/
+/*
+ * The "time_d value ..." ancillary formats are plain whitespace separated
+ * columns of numbers. These are read with a single fread(), split into
+ * lines in memory, and parsed with strtod() on several threads when the
+ * file is large. If enabled with the navintcache mbio default, the parsed
+ * columns of large files are cached in a binary file written alongside the
+ * source file (source file name plus MB_NAVINT_CACHE_SUFFIX) and reused as
+ * long as the source file inode, size and modification time (including
+ * nanoseconds) are unchanged.
+ */
+
+#if defined(__APPLE__)
+#define MB_NAVINT_MTIME_NSEC(file_stat) ((file_stat)->st_mtimespec.tv_nsec)
+#else
+#define MB_NAVINT_MTIME_NSEC(file_stat) ((file_stat)->st_mtim.tv_nsec)
+#endif
+
+struct mb_navint_cache_header_struct {
+	char magic[8];
+	int32_t byteorder;
+	int32_t ncolumns;
+	int32_t nrequired;
+	int32_t nrow;
+	int64_t inode;
+	int64_t size;
+	int64_t mtime;
+	int64_t mtime_nsec;
+};
+
+/* threads used to parse large files, 0 for one per processor */
+static int mb_navint_nthreads = 0;
+
+struct mb_navint_parse_struct {
+	char **lines;
+	int line_start;
+	int line_end;
+	int ncolumns;
+	int nrequired;
+	double **values;
+	char *ok;
+};
+
+/*--------------------------------------------------------------------*/
+/* parse up to ncolumns numbers from one line, equivalent to sscanf() with a
+   format of "%lf %lf ..." */
+static int mb_navint_parse_line(char *line, int ncolumns, double *values) {
+	int nget = 0;
+	while (nget < ncolumns) {
+		char *end = NULL;
+		values[nget] = strtod(line, &end);
+		if (end == line)
+			break;
+		line = end;
+		nget++;
+	}
+	return (nget);
+}
+
+/*--------------------------------------------------------------------*/
+static void *mb_navint_parse_lines(void *arg) {
+	struct mb_navint_parse_struct *parse = (struct mb_navint_parse_struct *)arg;
+	double values[MB_NAVINT_COLUMNS_MAX];
+
+	for (int i = parse->line_start; i < parse->line_end; i++) {
+		const int nget = mb_navint_parse_line(parse->lines[i], parse->ncolumns, values);
+		parse->ok[i] = (nget >= parse->nrequired);
+		for (int k = 0; k < parse->ncolumns; k++)
+			parse->values[k][i] = k < nget ? values[k] : 0.0;
+	}
+	return (NULL);
+}
+
+/*--------------------------------------------------------------------*/
+static void mb_navint_cache_file(const char *file, char *cache_file) {
+	snprintf(cache_file, MB_PATH_MAXLINE, "%s%s", file, MB_NAVINT_CACHE_SUFFIX);
+}
+
+/*--------------------------------------------------------------------*/
+static bool mb_navint_cache_read(int verbose, const char *file, const struct stat *file_stat, int ncolumns, int nrequired,
+                                 double ***columns, int *nrow, int *nalloc, int *error) {
+	char cache_file[MB_PATH_MAXLINE];
+	mb_navint_cache_file(file, cache_file);
+	FILE *cfp = fopen(cache_file, "rb");
+	if (cfp == NULL)
+		return (false);
+
+	struct mb_navint_cache_header_struct header;
+	bool valid = fread(&header, sizeof(header), 1, cfp) == 1 &&
+	             strncmp(header.magic, MB_NAVINT_CACHE_MAGIC, sizeof(header.magic)) == 0 &&
+	             header.byteorder == MB_NAVINT_CACHE_BYTEORDER && header.ncolumns == ncolumns &&
+	             header.nrequired == nrequired && header.inode == (int64_t)file_stat->st_ino &&
+	             header.size == (int64_t)file_stat->st_size && header.mtime == (int64_t)file_stat->st_mtime &&
+	             header.mtime_nsec == (int64_t)MB_NAVINT_MTIME_NSEC(file_stat) && header.nrow >= 0;
+
+	if (valid && *nalloc < header.nrow) {
+		const size_t size = header.nrow * sizeof(double);
+		int status = MB_SUCCESS;
+		for (int k = 0; k < ncolumns && status == MB_SUCCESS; k++)
+			status = mb_reallocd(verbose, __FILE__, __LINE__, size, (void **)columns[k], error);
+		if (status == MB_SUCCESS)
+			*nalloc = header.nrow;
+		else
+			valid = false;
+	}
+	for (int k = 0; k < ncolumns && valid; k++) {
+		if (fread(*columns[k], sizeof(double), header.nrow, cfp) != (size_t)header.nrow)
+			valid = false;
+	}
+	fclose(cfp);
+
+	if (valid)
+		*nrow = header.nrow;
+
+	if (verbose >= 4)
+		fprintf(stderr, "\ndbg4  Cache file %s %s in function <%s>\n", cache_file, valid ? "used" : "rejected", __func__);
+
+	return (valid);
+}
+
+/*--------------------------------------------------------------------*/
+static void mb_navint_cache_write(int verbose, const char *file, const struct stat *file_stat, int ncolumns, int nrequired,
+                                  double ***columns, int nrow) {
+	char cache_file[MB_PATH_MAXLINE];
+	char cache_tmp[MB_PATH_MAXLINE + 8];
+	mb_navint_cache_file(file, cache_file);
+	snprintf(cache_tmp, sizeof(cache_tmp), "%s.%d", cache_file, (int)getpid());
+
+	/* a cache that cannot be written (e.g. a read-only directory) is not an error */
+	FILE *cfp = fopen(cache_tmp, "wb");
+	if (cfp == NULL)
+		return;
+
+	struct mb_navint_cache_header_struct header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, MB_NAVINT_CACHE_MAGIC, sizeof(header.magic));
+	header.byteorder = MB_NAVINT_CACHE_BYTEORDER;
+	header.ncolumns = ncolumns;
+	header.nrequired = nrequired;
+	header.nrow = nrow;
+	header.inode = (int64_t)file_stat->st_ino;
+	header.size = (int64_t)file_stat->st_size;
+	header.mtime = (int64_t)file_stat->st_mtime;
+	header.mtime_nsec = (int64_t)MB_NAVINT_MTIME_NSEC(file_stat);
+	bool ok = fwrite(&header, sizeof(header), 1, cfp) == 1;
+	for (int k = 0; k < ncolumns && ok; k++)
+		ok = fwrite(*columns[k], sizeof(double), nrow, cfp) == (size_t)nrow;
+	if (fclose(cfp) != 0)
+		ok = false;
+
+	/* rename into place so that concurrent readers never see a partial cache */
+	if (ok && rename(cache_tmp, cache_file) == 0) {
+		if (verbose >= 4)
+			fprintf(stderr, "\ndbg4  Cache file %s written in function <%s>\n", cache_file, __func__);
+	}
+	else {
+		remove(cache_tmp);
+	}
+}
+
+/*--------------------------------------------------------------------*/
+/* 	function mb_navint_threads sets the number of threads used by
+    the mb_load*data() functions to parse large columnar files. With
+    nthreads <= 0 one thread per processor is used; at most
+    MB_THREAD_MAX threads are used in any case. */
+int mb_navint_threads(int verbose, int nthreads, int *error) {
+	if (verbose >= 2) {
+		fprintf(stderr, "\ndbg2  MBIO function <%s> called\n", __func__);
+		fprintf(stderr, "dbg2  Input arguments:\n");
+		fprintf(stderr, "dbg2       verbose:                          %d\n", verbose);
+		fprintf(stderr, "dbg2       nthreads:                         %d\n", nthreads);
+	}
+
+	mb_navint_nthreads = MIN(MAX(nthreads, 0), MB_THREAD_MAX);
+
+	const int status = MB_SUCCESS;
+	*error = MB_ERROR_NO_ERROR;
+
+	if (verbose >= 2) {
+		fprintf(stderr, "\ndbg2  MBIO function <%s> completed\n", __func__);
+		fprintf(stderr, "dbg2  Return value:\n");
+		fprintf(stderr, "dbg2       error:                            %d\n", *error);
+		fprintf(stderr, "dbg2  Return status:\n");
+		fprintf(stderr, "dbg2       status:                           %d\n", status);
+	}
+
+	return (status);
+}
+
+/*--------------------------------------------------------------------*/
+/* Read a file of whitespace separated numeric columns into the arrays
+   pointed to by columns, allocating them as necessary. Lines with fewer
+   than nrequired values are skipped, and missing optional values are set
+   to zero. Records are returned in file order, without any time checks. */
+static int mb_navint_read_columns(int verbose, const char *file, int ncolumns, int nrequired, double ***columns, int *nrow,
+                                  int *nalloc, int *error) {
+	char *buffer = NULL;
+	char **lines = NULL;
+	char *ok = NULL;
+
+	if (verbose >= 2) {
+		fprintf(stderr, "\ndbg2  MBIO function <%s> called\n", __func__);
+		fprintf(stderr, "dbg2  Input arguments:\n");
+		fprintf(stderr, "dbg2       verbose:                          %d\n", verbose);
+		fprintf(stderr, "dbg2       file:                             %s\n", file);
+		fprintf(stderr, "dbg2       ncolumns:                         %d\n", ncolumns);
+		fprintf(stderr, "dbg2       nrequired:                        %d\n", nrequired);
+		fprintf(stderr, "dbg2       nalloc:                           %d\n", *nalloc);
+	}
+
+	int status = MB_SUCCESS;
+	*error = MB_ERROR_NO_ERROR;
+	*nrow = 0;
+
+	/* read the whole file unless caching is enabled and a valid cache exists */
+	bool use_cache = false;
+	mb_navintcache(verbose, &use_cache);
+	struct stat file_stat;
+	FILE *tfp = NULL;
+	if (stat(file, &file_stat) != 0 || (tfp = fopen(file, "r")) == NULL) {
+		*error = MB_ERROR_OPEN_FAIL;
+		status = MB_FAILURE;
+	}
+	else if (use_cache && mb_navint_cache_read(verbose, file, &file_stat, ncolumns, nrequired, columns, nrow, nalloc, error)) {
+		fclose(tfp);
+		tfp = NULL;
+	}
+	else {
+		const size_t size = (size_t)file_stat.st_size;
+		status = mb_mallocd(verbose, __FILE__, __LINE__, size + 1, (void **)&buffer, error);
+		if (status == MB_SUCCESS && fread(buffer, 1, size, tfp) != size) {
+			*error = MB_ERROR_EOF;
+			status = MB_FAILURE;
+		}
+		fclose(tfp);
+		tfp = NULL;
+
+		/* split the buffer into null terminated lines */
+		int nline = 0;
+		if (status == MB_SUCCESS) {
+			buffer[size] = '\0';
+			for (char *c = buffer; c < buffer + size; nline++) {
+				char *eol = memchr(c, '\n', buffer + size - c);
+				c = eol != NULL ? eol + 1 : buffer + size;
+			}
+			status = mb_mallocd(verbose, __FILE__, __LINE__, (nline + 1) * sizeof(char *), (void **)&lines, error);
+		}
+		if (status == MB_SUCCESS)
+			status = mb_mallocd(verbose, __FILE__, __LINE__, nline + 1, (void **)&ok, error);
+		if (status == MB_SUCCESS) {
+			int iline = 0;
+			for (char *c = buffer; c < buffer + size; iline++) {
+				lines[iline] = c;
+				char *eol = memchr(c, '\n', buffer + size - c);
+				if (eol != NULL) {
+					*eol = '\0';
+					c = eol + 1;
+				}
+				else {
+					c = buffer + size;
+				}
+			}
+		}
+
+		/* allocate the output columns, one row per line */
+		if (status == MB_SUCCESS && *nalloc < nline) {
+			const size_t csize = nline * sizeof(double);
+			for (int k = 0; k < ncolumns && status == MB_SUCCESS; k++)
+				status = mb_reallocd(verbose, __FILE__, __LINE__, csize, (void **)columns[k], error);
+			if (status == MB_SUCCESS)
+				*nalloc = nline;
+		}
+
+		/* parse the lines in contiguous chunks, one per thread */
+		if (status == MB_SUCCESS) {
+			double *values[MB_NAVINT_COLUMNS_MAX];
+			for (int k = 0; k < ncolumns; k++)
+				values[k] = *columns[k];
+			int nthreads = 1;
+			if (nline >= MB_NAVINT_THREAD_LINES) {
+				const long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+				nthreads = mb_navint_nthreads > 0 ? mb_navint_nthreads : (int)ncpu;
+				nthreads = MIN(MAX(nthreads, 1), MB_THREAD_MAX);
+			}
+			struct mb_navint_parse_struct parse[MB_THREAD_MAX];
+			pthread_t threads[MB_THREAD_MAX];
+			bool started[MB_THREAD_MAX];
+			for (int ithread = 0; ithread < nthreads; ithread++) {
+				parse[ithread].lines = lines;
+				parse[ithread].line_start = (int)(((long)nline * ithread) / nthreads);
+				parse[ithread].line_end = (int)(((long)nline * (ithread + 1)) / nthreads);
+				parse[ithread].ncolumns = ncolumns;
+				parse[ithread].nrequired = nrequired;
+				parse[ithread].values = values;
+				parse[ithread].ok = ok;
+				started[ithread] =
+				    nthreads > 1 && pthread_create(&threads[ithread], NULL, mb_navint_parse_lines, &parse[ithread]) == 0;
+				if (!started[ithread])
+					mb_navint_parse_lines(&parse[ithread]);
+			}
+			for (int ithread = 0; ithread < nthreads; ithread++) {
+				if (started[ithread])
+					pthread_join(threads[ithread], NULL);
+			}
+
+			/* keep the lines that parsed, in file order */
+			int n = 0;
+			for (int i = 0; i < nline; i++) {
+				if (ok[i]) {
+					if (n < i) {
+						for (int k = 0; k < ncolumns; k++)
+							values[k][n] = values[k][i];
+					}
+					n++;
+				}
+				else if (verbose >= 5) {
+					fprintf(stderr, "\ndbg5  Error parsing line in file %s in function <%s>\n", file, __func__);
+					fprintf(stderr, "dbg5       line: %s\n", lines[i]);
+				}
+			}
+			*nrow = n;
+
+			if (use_cache && *nrow >= MB_NAVINT_CACHE_MIN)
+				mb_navint_cache_write(verbose, file, &file_stat, ncolumns, nrequired, columns, *nrow);
+		}
+
+		int tmp_error = MB_ERROR_NO_ERROR;
+		if (ok != NULL)
+			mb_freed(verbose, __FILE__, __LINE__, (void **)&ok, &tmp_error);
+		if (lines != NULL)
+			mb_freed(verbose, __FILE__, __LINE__, (void **)&lines, &tmp_error);
+		if (buffer != NULL)
+			mb_freed(verbose, __FILE__, __LINE__, (void **)&buffer, &tmp_error);
+	}
+
+	if (verbose >= 2) {
+		fprintf(stderr, "\ndbg2  MBIO function <%s> completed\n", __func__);
+		fprintf(stderr, "dbg2  Return value:\n");
+		fprintf(stderr, "dbg2       nrow:                             %d\n", *nrow);
+		fprintf(stderr, "dbg2       nalloc:                           %d\n", *nalloc);
+		fprintf(stderr, "dbg2       error:                            %d\n", *error);
+		fprintf(stderr, "dbg2  Return status:\n");
+		fprintf(stderr, "dbg2       status:                           %d\n", status);
+	}
+
+	return (status);
+}
+
+/*--------------------------------------------------------------------*/
+/* drop records whose time does not increase, as the line by line
+   loaders do, and return the number of records kept */
+static int mb_navint_check_time(int verbose, int ncolumns, double ***columns, int nrow) {
+	double *time_d = *columns[0];
+	int nrecord = 0;
+	for (int i = 0; i < nrow; i++) {
+		if (nrecord == 0 || time_d[i] > time_d[nrecord - 1]) {
+			if (nrecord < i) {
+				for (int k = 0; k < ncolumns; k++)
+					(*columns[k])[nrecord] = (*columns[k])[i];
+			}
+			nrecord++;
+		}
+		else if (verbose >= 5) {
+			fprintf(stderr, "\ndbg5  Time error in function <%s>\n", __func__);
+			fprintf(stderr, "dbg5       record[%d]: %f\n", nrecord - 1, time_d[nrecord - 1]);
+			fprintf(stderr, "dbg5       record[%d]: %f\n", i, time_d[i]);
+		}
+	}
+	return (nrecord);
+}
+
 /*--------------------------------------------------------------------*/
 
 int mb_loadnavdata(int verbose, char *merge_nav_file, int merge_nav_format, int merge_nav_lonflip, int *merge_nav_num,
@@ -1213,10 +1601,33 @@ int mb_loadnavdata(int verbose, char *merge_nav_file, int merge_nav_format, int
 
 	int status = MB_SUCCESS;
 
-	/* count the records */
+	/* the time_d lon lat [speed] format is read by the columnar reader,
+	   the other formats are counted and then read line by line */
 	*error = MB_ERROR_NO_ERROR;
 	nrecord = 0;
-	if ((tfp = fopen(merge_nav_file, "r")) != NULL) {
+	const bool columnar = merge_nav_format == MB_PR_NAV_FORMAT_TLLS;
+	if (columnar) {
+		double **columns[4] = {merge_nav_time_d, merge_nav_lon, merge_nav_lat, merge_nav_speed};
+		int nrow = 0;
+		status = mb_navint_read_columns(verbose, merge_nav_file, 4, 3, columns, &nrow, merge_nav_alloc, error);
+		if (status == MB_SUCCESS) {
+			*merge_nav_num = mb_navint_check_time(verbose, 4, columns, nrow);
+
+			/* make sure longitude is defined according to lonflip */
+			for (int i = 0; i < *merge_nav_num; i++) {
+				double *lon = &(*merge_nav_lon)[i];
+				if (merge_nav_lonflip == -1 && *lon > 0.0)
+					*lon -= 360.0;
+				else if (merge_nav_lonflip == 0 && *lon < -180.0)
+					*lon += 360.0;
+				else if (merge_nav_lonflip == 0 && *lon > 180.0)
+					*lon -= 360.0;
+				else if (merge_nav_lonflip == 1 && *lon < 0.0)
+					*lon += 360.0;
+			}
+		}
+	}
+	else if ((tfp = fopen(merge_nav_file, "r")) != NULL) {
 		/* loop over reading the records */
 		while ((result = fgets(buffer, nchar, tfp)) == buffer)
 			nrecord++;
@@ -1231,7 +1642,7 @@ int mb_loadnavdata(int verbose, char *merge_nav_file, int merge_nav_format, int
 	}
 
 	/* allocate memory if necessary */
-	if (status == MB_SUCCESS && *merge_nav_alloc < nrecord) {
+	if (status == MB_SUCCESS && !columnar && *merge_nav_alloc < nrecord) {
 		size = nrecord * sizeof(double);
 		status = mb_mallocd(verbose, __FILE__, __LINE__, size, (void **)merge_nav_time_d, error);
 		if (status == MB_SUCCESS)
@@ -1249,7 +1660,7 @@ int mb_loadnavdata(int verbose, char *merge_nav_file, int merge_nav_format, int
 	}
 
 	/* read the records */
-	if (status == MB_SUCCESS) {
+	if (status == MB_SUCCESS && !columnar) {
 		bool time_set;
 		bool nav_ok;
 		nrecord = 0;
@@ -1637,10 +2048,19 @@ int mb_loadsensordepthdata(int verbose, char *merge_sensordepth_file, int merge_
 
 	int status = MB_SUCCESS;
 
-	/* count the records */
+	/* the time_d sensordepth format is read by the columnar reader,
+	   the other formats are counted and then read line by line */
 	*error = MB_ERROR_NO_ERROR;
 	nrecord = 0;
-	if ((tfp = fopen(merge_sensordepth_file, "r")) != NULL) {
+	const bool columnar = merge_sensordepth_format == MB_PR_SENSORDEPTH_FORMAT_TD;
+	if (columnar) {
+		double **columns[2] = {merge_sensordepth_time_d, merge_sensordepth_sensordepth};
+		int nrow = 0;
+		status = mb_navint_read_columns(verbose, merge_sensordepth_file, 2, 2, columns, &nrow, merge_sensordepth_alloc, error);
+		if (status == MB_SUCCESS)
+			*merge_sensordepth_num = mb_navint_check_time(verbose, 2, columns, nrow);
+	}
+	else if ((tfp = fopen(merge_sensordepth_file, "r")) != NULL) {
 		/* loop over reading the records */
 		while ((result = fgets(buffer, nchar, tfp)) == buffer)
 			nrecord++;
@@ -1655,7 +2075,7 @@ int mb_loadsensordepthdata(int verbose, char *merge_sensordepth_file, int merge_
 	}
 
 	/* allocate memory if necessary */
-	if (status == MB_SUCCESS && *merge_sensordepth_alloc < nrecord) {
+	if (status == MB_SUCCESS && !columnar && *merge_sensordepth_alloc < nrecord) {
 		size = nrecord * sizeof(double);
 		status = mb_mallocd(verbose, __FILE__, __LINE__, size, (void **)merge_sensordepth_time_d, error);
 		if (status == MB_SUCCESS)
@@ -1667,7 +2087,7 @@ int mb_loadsensordepthdata(int verbose, char *merge_sensordepth_file, int merge_
 	}
 
 	/* read the records */
-	if (status == MB_SUCCESS) {
+	if (status == MB_SUCCESS && !columnar) {
 		bool sensordepth_ok;
 		nrecord = 0;
 		if ((tfp = fopen(merge_sensordepth_file, "r")) == NULL) {
@@ -1847,10 +2267,19 @@ int mb_loadaltitudedata(int verbose, char *merge_altitude_file, int merge_altitu
 
 	int status = MB_SUCCESS;
 
-	/* count the records */
+	/* the time_d altitude format is read by the columnar reader,
+	   the other formats are counted and then read line by line */
 	*error = MB_ERROR_NO_ERROR;
 	nrecord = 0;
-	if ((tfp = fopen(merge_altitude_file, "r")) != NULL) {
+	const bool columnar = merge_altitude_format == MB_PR_ALTITUDE_FORMAT_TA;
+	if (columnar) {
+		double **columns[2] = {merge_altitude_time_d, merge_altitude_altitude};
+		int nrow = 0;
+		status = mb_navint_read_columns(verbose, merge_altitude_file, 2, 2, columns, &nrow, merge_altitude_alloc, error);
+		if (status == MB_SUCCESS)
+			*merge_altitude_num = mb_navint_check_time(verbose, 2, columns, nrow);
+	}
+	else if ((tfp = fopen(merge_altitude_file, "r")) != NULL) {
 		/* loop over reading the records */
 		while ((result = fgets(buffer, nchar, tfp)) == buffer)
 			nrecord++;
@@ -1865,7 +2294,7 @@ int mb_loadaltitudedata(int verbose, char *merge_altitude_file, int merge_altitu
 	}
 
 	/* allocate memory if necessary */
-	if (status == MB_SUCCESS && *merge_altitude_alloc < nrecord) {
+	if (status == MB_SUCCESS && !columnar && *merge_altitude_alloc < nrecord) {
 		size = nrecord * sizeof(double);
 		status = mb_mallocd(verbose, __FILE__, __LINE__, size, (void **)merge_altitude_time_d, error);
 		if (status == MB_SUCCESS)
@@ -1877,7 +2306,7 @@ int mb_loadaltitudedata(int verbose, char *merge_altitude_file, int merge_altitu
 	}
 
 	/* read the records */
-	if (status == MB_SUCCESS) {
+	if (status == MB_SUCCESS && !columnar) {
 		bool altitude_ok;
 		nrecord = 0;
 		if ((tfp = fopen(merge_altitude_file, "r")) == NULL) {
@@ -2020,10 +2449,19 @@ int mb_loadheadingdata(int verbose, char *merge_heading_file, int merge_heading_
 
 	int status = MB_SUCCESS;
 
-	/* count the records */
+	/* the time_d heading format is read by the columnar reader,
+	   the other formats are counted and then read line by line */
 	*error = MB_ERROR_NO_ERROR;
 	nrecord = 0;
-	if ((tfp = fopen(merge_heading_file, "r")) != NULL) {
+	const bool columnar = merge_heading_format == MB_PR_HEADING_FORMAT_TH;
+	if (columnar) {
+		double **columns[2] = {merge_heading_time_d, merge_heading_heading};
+		int nrow = 0;
+		status = mb_navint_read_columns(verbose, merge_heading_file, 2, 2, columns, &nrow, merge_heading_alloc, error);
+		if (status == MB_SUCCESS)
+			*merge_heading_num = mb_navint_check_time(verbose, 2, columns, nrow);
+	}
+	else if ((tfp = fopen(merge_heading_file, "r")) != NULL) {
 		/* loop over reading the records */
 		while ((result = fgets(buffer, nchar, tfp)) == buffer)
 			nrecord++;
@@ -2038,7 +2476,7 @@ int mb_loadheadingdata(int verbose, char *merge_heading_file, int merge_heading_
 	}
 
 	/* allocate memory if necessary */
-	if (status == MB_SUCCESS && *merge_heading_alloc < nrecord) {
+	if (status == MB_SUCCESS && !columnar && *merge_heading_alloc < nrecord) {
 		size = nrecord * sizeof(double);
 		status = mb_mallocd(verbose, __FILE__, __LINE__, size, (void **)merge_heading_time_d, error);
 		if (status == MB_SUCCESS)
@@ -2050,7 +2488,7 @@ int mb_loadheadingdata(int verbose, char *merge_heading_file, int merge_heading_
 	}
 
 	/* read the records */
-	if (status == MB_SUCCESS) {
+	if (status == MB_SUCCESS && !columnar) {
 		bool heading_ok;
 		nrecord = 0;
 		if ((tfp = fopen(merge_heading_file, "r")) == NULL) {
@@ -2237,10 +2675,19 @@ int mb_loadattitudedata(int verbose, char *merge_attitude_file, int merge_attitu
 
 	int status = MB_SUCCESS;
 
-	/* count the records */
+	/* the time_d roll pitch heave format is read by the columnar reader,
+	   the other formats are counted and then read line by line */
 	*error = MB_ERROR_NO_ERROR;
 	nrecord = 0;
-	if ((tfp = fopen(merge_attitude_file, "r")) != NULL) {
+	const bool columnar = merge_attitude_format == MB_PR_ATTITUDE_FORMAT_TRPH;
+	if (columnar) {
+		double **columns[4] = {merge_attitude_time_d, merge_attitude_roll, merge_attitude_pitch, merge_attitude_heave};
+		int nrow = 0;
+		status = mb_navint_read_columns(verbose, merge_attitude_file, 4, 4, columns, &nrow, merge_attitude_alloc, error);
+		if (status == MB_SUCCESS)
+			*merge_attitude_num = mb_navint_check_time(verbose, 4, columns, nrow);
+	}
+	else if ((tfp = fopen(merge_attitude_file, "r")) != NULL) {
 		/* loop over reading the records */
 		while ((result = fgets(buffer, nchar, tfp)) == buffer)
 			nrecord++;
@@ -2255,7 +2702,7 @@ int mb_loadattitudedata(int verbose, char *merge_attitude_file, int merge_attitu
 	}
 
 	/* allocate memory if necessary */
-	if (status == MB_SUCCESS && *merge_attitude_alloc < nrecord) {
+	if (status == MB_SUCCESS && !columnar && *merge_attitude_alloc < nrecord) {
 		size = nrecord * sizeof(double);
 		status = mb_mallocd(verbose, __FILE__, __LINE__, size, (void **)merge_attitude_time_d, error);
 		if (status == MB_SUCCESS)
@@ -2273,7 +2720,7 @@ int mb_loadattitudedata(int verbose, char *merge_attitude_file, int merge_attitu
 	}
 
 	/* read the records */
-	if (status == MB_SUCCESS) {
+	if (status == MB_SUCCESS && !columnar) {
 		nrecord = 0;
 		if ((tfp = fopen(merge_attitude_file, "r")) == NULL) {
 			*error = MB_ERROR_OPEN_FAIL;
@@ -2460,10 +2907,19 @@ int mb_loadsoundspeeddata(int verbose, char *merge_soundspeed_file, int merge_so
 
 	int status = MB_SUCCESS;
 
-	/* count the records */
+	/* the time_d soundspeed format is read by the columnar reader,
+	   the other formats are counted and then read line by line */
 	*error = MB_ERROR_NO_ERROR;
 	nrecord = 0;
-	if ((tfp = fopen(merge_soundspeed_file, "r")) != NULL) {
+	const bool columnar = merge_soundspeed_format == MB_PR_SOUNDSPEED_FORMAT_TS;
+	if (columnar) {
+		double **columns[2] = {merge_soundspeed_time_d, merge_soundspeed_soundspeed};
+		int nrow = 0;
+		status = mb_navint_read_columns(verbose, merge_soundspeed_file, 2, 2, columns, &nrow, merge_soundspeed_alloc, error);
+		if (status == MB_SUCCESS)
+			*merge_soundspeed_num = mb_navint_check_time(verbose, 2, columns, nrow);
+	}
+	else if ((tfp = fopen(merge_soundspeed_file, "r")) != NULL) {
 		/* loop over reading the records */
 		while ((result = fgets(buffer, nchar, tfp)) == buffer)
 			nrecord++;
@@ -2478,7 +2934,7 @@ int mb_loadsoundspeeddata(int verbose, char *merge_soundspeed_file, int merge_so
 	}
 
 	/* allocate memory if necessary */
-	if (status == MB_SUCCESS && *merge_soundspeed_alloc < nrecord) {
+	if (status == MB_SUCCESS && !columnar && *merge_soundspeed_alloc < nrecord) {
 		size = nrecord * sizeof(double);
 		status = mb_mallocd(verbose, __FILE__, __LINE__, size, (void **)merge_soundspeed_time_d, error);
 		if (status == MB_SUCCESS)
@@ -2490,7 +2946,7 @@ int mb_loadsoundspeeddata(int verbose, char *merge_soundspeed_file, int merge_so
 	}
 
 	/* read the records */
-	if (status == MB_SUCCESS) {
+	if (status == MB_SUCCESS && !columnar) {
 		nrecord = 0;
 		if ((tfp = fopen(merge_soundspeed_file, "r")) == NULL) {
 			*error = MB_ERROR_OPEN_FAIL;
@@ -2634,10 +3090,19 @@ int mb_loadtimeshiftdata(int verbose, char *merge_timeshift_file, int merge_time
 
 	int status = MB_SUCCESS;
 
-	/* count the records */
+	/* the time_d timeshift format is read by the columnar reader,
+	   the other formats are counted and then read line by line */
 	*error = MB_ERROR_NO_ERROR;
 	nrecord = 0;
-	if ((tfp = fopen(merge_timeshift_file, "r")) != NULL) {
+	const bool columnar = merge_timeshift_format == MB_PR_TIMESHIFT_FORMAT_TT;
+	if (columnar) {
+		double **columns[2] = {merge_timeshift_time_d, merge_timeshift_timeshift};
+		int nrow = 0;
+		status = mb_navint_read_columns(verbose, merge_timeshift_file, 2, 2, columns, &nrow, merge_timeshift_alloc, error);
+		if (status == MB_SUCCESS)
+			*merge_timeshift_num = mb_navint_check_time(verbose, 2, columns, nrow);
+	}
+	else if ((tfp = fopen(merge_timeshift_file, "r")) != NULL) {
 		/* loop over reading the records */
 		while ((result = fgets(buffer, nchar, tfp)) == buffer)
 			nrecord++;
@@ -2652,7 +3117,7 @@ int mb_loadtimeshiftdata(int verbose, char *merge_timeshift_file, int merge_time
 	}
 
 	/* allocate memory if necessary */
-	if (status == MB_SUCCESS && *merge_timeshift_alloc < nrecord) {
+	if (status == MB_SUCCESS && !columnar && *merge_timeshift_alloc < nrecord) {
 		size = nrecord * sizeof(double);
 		status = mb_mallocd(verbose, __FILE__, __LINE__, size, (void **)merge_timeshift_time_d, error);
 		if (status == MB_SUCCESS)
@@ -2664,7 +3129,7 @@ int mb_loadtimeshiftdata(int verbose, char *merge_timeshift_file, int merge_time
 	}
 
 	/* read the records */
-	if (status == MB_SUCCESS) {
+	if (status == MB_SUCCESS && !columnar) {
 		nrecord = 0;
 		if ((tfp = fopen(merge_timeshift_file, "r")) == NULL) {
 			*error = MB_ERROR_OPEN_FAIL;
@@ -2824,11 +3289,64 @@ int mb_apply_time_latency(int verbose, int data_num, double *data_time_d, int ti
 }
 
 /*--------------------------------------------------------------------*/
+/* one pass of a box filter of half width radius over n samples, summing
+   only the samples inside the series; this works in place, and prefix
+   must have room for n + 1 values */
+static void mb_time_filter_box(int n, int radius, double *data, double *prefix) {
+	prefix[0] = 0.0;
+	for (int i = 0; i < n; i++)
+		prefix[i + 1] = prefix[i] + data[i];
+	const int i1 = MIN(radius, n);
+	const int i2 = MAX(n - radius, i1);
+	for (int i = 0; i < i1; i++)
+		data[i] = prefix[MIN(i + radius + 1, n)];
+	for (int i = i1; i < i2; i++)
+		data[i] = prefix[i + radius + 1] - prefix[i - radius];
+	for (int i = i2; i < n; i++)
+		data[i] = prefix[n] - prefix[MAX(i - radius, 0)];
+}
+
+/*--------------------------------------------------------------------*/
+/* direct summation of the Gaussian time filter over samples istart to
+   iend - 1 of a segment of n samples, using neighbours within four filter
+   lengths */
+static void mb_time_filter_direct(int n, const double *time_d, const double *value, double filter_length, int istart,
+                                  int iend, double *filtered) {
+	const double support = 4.0 * filter_length;
+	for (int i = istart; i < iend; i++) {
+		double sum = value[i];
+		double filterweight = 1.0;
+		for (int j = i - 1; j >= 0 && time_d[i] - time_d[j] <= support; j--) {
+			const double dtol = (time_d[j] - time_d[i]) / filter_length;
+			const double weight = exp(-dtol * dtol);
+			sum += weight * value[j];
+			filterweight += weight;
+		}
+		for (int j = i + 1; j < n && time_d[j] - time_d[i] <= support; j++) {
+			const double dtol = (time_d[j] - time_d[i]) / filter_length;
+			const double weight = exp(-dtol * dtol);
+			sum += weight * value[j];
+			filterweight += weight;
+		}
+		filtered[i] = sum / filterweight;
+	}
+}
 
+/*--------------------------------------------------------------------*/
+/* 	function mb_apply_time_filter applies a Gaussian time domain filter,
+        weighting samples by exp(-(dt / filter_length)^2), to the time series
+        provided. The series is broken into segments at gaps longer than the
+        filter support. Segments that are uniformly sampled and span more than
+        MB_TIME_FILTER_EXACT_MAX samples per filter support are filtered with
+        a cascade of MB_TIME_FILTER_NBOX box filters, which approximates the
+        Gaussian in time proportional to the number of samples regardless of
+        the filter length, except near the segment ends. Other segments are
+        filtered by direct summation. In both cases the weights are
+        renormalized at the segment ends. */
 int mb_apply_time_filter(int verbose, int data_num, double *data_time_d, double *data_value, double filter_length, int *error) {
 	double *data_value_filtered = NULL;
-	double dtime, dtol, filterweight, weight;
-	int nhalffilter;
+	double *norm = NULL;
+	double *prefix = NULL;
 
 	if (verbose >= 2) {
 		fprintf(stderr, "\ndbg2  MBIO function <%s> called\n", __func__);
@@ -2840,32 +3358,92 @@ int mb_apply_time_filter(int verbose, int data_num, double *data_time_d, double
 		fprintf(stderr, "dbg2       filter_length:                    %f\n", filter_length);
 	}
 
+	int status = MB_SUCCESS;
+	*error = MB_ERROR_NO_ERROR;
+
 	/* apply a Gaussian time domain filter to the time series provided */
-	const size_t size = data_num * sizeof(double);
-	int status = mb_mallocd(verbose, __FILE__, __LINE__, size, (void **)&data_value_filtered, error);
-	if (status == MB_SUCCESS) {
-		dtime = (data_time_d[data_num - 1] - data_time_d[0]) / data_num;
-		nhalffilter = (int)(4.0 * filter_length / dtime);
-		for (int i = 0; i < data_num; i++) {
-			data_value_filtered[i] = 0.0;
-			filterweight = 0.0;
-			const int j1 = MAX(i - nhalffilter, 0);
-			const int j2 = MIN(i + nhalffilter, data_num - 1);
-			for (int j = j1; j <= j2; j++) {
-				dtol = (data_time_d[j] - data_time_d[i]) / filter_length;
-				weight = exp(-dtol * dtol);
-				data_value_filtered[i] += weight * data_value[j];
-				filterweight += weight;
+	if (data_num > 1 && filter_length > 0.0) {
+		const size_t size = (data_num + 1) * sizeof(double);
+		status = mb_mallocd(verbose, __FILE__, __LINE__, size, (void **)&data_value_filtered, error);
+		if (status == MB_SUCCESS)
+			status = mb_mallocd(verbose, __FILE__, __LINE__, size, (void **)&norm, error);
+		if (status == MB_SUCCESS)
+			status = mb_mallocd(verbose, __FILE__, __LINE__, size, (void **)&prefix, error);
+	}
+	if (status == MB_SUCCESS && data_num > 1 && filter_length > 0.0) {
+		const double support = 4.0 * filter_length;
+		for (int i0 = 0; i0 < data_num;) {
+			/* find the next segment, breaking at gaps longer than the filter support */
+			int i1 = i0 + 1;
+			while (i1 < data_num && data_time_d[i1] - data_time_d[i1 - 1] <= support)
+				i1++;
+			const int n = i1 - i0;
+			const double *time_d = &data_time_d[i0];
+			const double *value = &data_value[i0];
+			double *filtered = &data_value_filtered[i0];
+
+			/* check if the segment is uniformly sampled and the filter wide
+			   enough to use the box filter cascade */
+			const double dtime = n > 1 ? (time_d[n - 1] - time_d[0]) / (n - 1) : 0.0;
+			bool use_box = dtime > 0.0 && support / dtime > MB_TIME_FILTER_EXACT_MAX;
+			for (int i = 1; i < n && use_box; i++) {
+				const double dt = time_d[i] - time_d[i - 1];
+				if (dt < 0.5 * dtime || dt > 1.5 * dtime)
+					use_box = false;
 			}
-			if (filterweight > 0.0)
-				data_value_filtered[i] /= filterweight;
-		}
-		for (int i = 0; i < data_num; i++) {
-			data_value[i] = data_value_filtered[i];
+
+			if (use_box) {
+				/* box widths for a Gaussian of standard deviation sigma samples,
+				   the Gaussian weight exp(-(dt / filter_length)^2) having
+				   sigma = filter_length / sqrt(2) */
+				const double sigma = filter_length / (sqrt(2.0) * dtime);
+				const double wideal = sqrt(12.0 * sigma * sigma / MB_TIME_FILTER_NBOX + 1.0);
+				int wl = (int)floor(wideal);
+				if (wl % 2 == 0)
+					wl--;
+				const int m = (int)floor((12.0 * sigma * sigma - MB_TIME_FILTER_NBOX * wl * wl - 4.0 * MB_TIME_FILTER_NBOX * wl -
+				                          3.0 * MB_TIME_FILTER_NBOX) / (-4.0 * wl - 4.0) + 0.5);
+
+				/* filter deviations from the first value to preserve precision in
+				   the running sums, and filter ones alongside to renormalize the
+				   weights at the segment ends */
+				for (int i = 0; i < n; i++) {
+					filtered[i] = value[i] - value[0];
+					norm[i] = 1.0;
+				}
+				int support_box = 0;
+				for (int ibox = 0; ibox < MB_TIME_FILTER_NBOX; ibox++) {
+					const int radius = ibox < m ? (wl - 1) / 2 : (wl + 1) / 2;
+					mb_time_filter_box(n, radius, filtered, prefix);
+					mb_time_filter_box(n, radius, norm, prefix);
+					support_box += radius;
+				}
+				for (int i = 0; i < n; i++)
+					filtered[i] = value[0] + filtered[i] / norm[i];
+
+				/* the truncated cascade is a poor approximation of the truncated
+				   Gaussian near the segment ends, so sum those samples directly */
+				const int iend = MIN(support_box, n);
+				mb_time_filter_direct(n, time_d, value, filter_length, 0, iend, filtered);
+				mb_time_filter_direct(n, time_d, value, filter_length, MAX(n - support_box, iend), n, filtered);
+			}
+			else {
+				mb_time_filter_direct(n, time_d, value, filter_length, 0, n, filtered);
+			}
+
+			i0 = i1;
 		}
-		status = mb_freed(verbose, __FILE__, __LINE__, (void **)&data_value_filtered, error);
+		memcpy(data_value, data_value_filtered, data_num * sizeof(double));
 	}
 
+	int tmp_error = MB_ERROR_NO_ERROR;
+	if (prefix != NULL)
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&prefix, &tmp_error);
+	if (norm != NULL)
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&norm, &tmp_error);
+	if (data_value_filtered != NULL)
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&data_value_filtered, &tmp_error);
+
 	if (verbose >= 2) {
 		fprintf(stderr, "\ndbg2  MBIO function <%s> completed\n", __func__);
 		fprintf(stderr, "dbg2  Return value:\n");
@@ -2879,3 +3457,4 @@ int mb_apply_time_filter(int verbose, int data_num, double *data_time_d, double
 }
 
 /*--------------------------------------------------------------------*/
+
@@ -1319,3 +1319,39 @@ int mb_input_init(int verbose, char *socket_definition, int format,
 	return (status);
 }
 /*--------------------------------------------------------------------*/
+int mb_input_lease_init(int verbose, void *mbio_ptr,
+                int (*input_lease)(int verbose, void *mbio_ptr, char **frame, size_t *size, int *error),
+                int *error) {
+	if (verbose >= 2) {
+		fprintf(stderr, "\ndbg2  MBIO function <%s> called\n", __func__);
+		fprintf(stderr, "dbg2  Input arguments:\n");
+		fprintf(stderr, "dbg2       verbose:            %d\n", verbose);
+		fprintf(stderr, "dbg2       mbio_ptr:           %p\n", mbio_ptr);
+		fprintf(stderr, "dbg2       input_lease():      %p\n", input_lease);
+	}
+
+	struct mb_io_struct *mb_io_ptr = (struct mb_io_struct *)mbio_ptr;
+
+	int status = MB_SUCCESS;
+	*error = MB_ERROR_NO_ERROR;
+
+	/* frame leasing only applies to application defined input */
+	if (mb_io_ptr != NULL && mb_io_ptr->filetype == MB_FILETYPE_INPUT) {
+		mb_io_ptr->mb_io_input_lease = input_lease;
+	}
+	else {
+		status = MB_FAILURE;
+		*error = MB_ERROR_BAD_USAGE;
+	}
+
+	if (verbose >= 2) {
+		fprintf(stderr, "\ndbg2  MBIO function <%s> completed\n", __func__);
+		fprintf(stderr, "dbg2  Return values:\n");
+		fprintf(stderr, "dbg2       error:      %d\n", *error);
+		fprintf(stderr, "dbg2  Return status:\n");
+		fprintf(stderr, "dbg2       status:  %d\n", status);
+	}
+
+	return (status);
+}
+/*--------------------------------------------------------------------*/
@@ -30,6 +30,8 @@
 
 #include <math.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -39,6 +41,218 @@
 #include "mb_status.h"
 #include "mb_swap.h"
 
+/* Layout of the trace header fields as read by mb_segy_read_trace(): byte
+    offset in the file, bytes per value (all stored big-endian), offset of the
+    member in mb_segytraceheader_struct, and number of consecutive values.
+    Note that the SIOSEIS deep water delay at bytes 106-109 overlaps lagb,
+    which is not read. */
+struct mb_segy_field_struct {
+	int offset;
+	int size;
+	size_t member;
+	int count;
+};
+#define MB_SEGY_TRACEFIELD(OFFSET, SIZE, MEMBER, COUNT) \
+	{OFFSET, SIZE, offsetof(struct mb_segytraceheader_struct, MEMBER), COUNT}
+static const struct mb_segy_field_struct mb_segy_tracefields[] = {
+	MB_SEGY_TRACEFIELD(0, 4, seq_num, 1),
+	MB_SEGY_TRACEFIELD(4, 4, seq_reel, 1),
+	MB_SEGY_TRACEFIELD(8, 4, shot_num, 1),
+	MB_SEGY_TRACEFIELD(12, 4, shot_tr, 1),
+	MB_SEGY_TRACEFIELD(16, 4, espn, 1),
+	MB_SEGY_TRACEFIELD(20, 4, rp_num, 1),
+	MB_SEGY_TRACEFIELD(24, 4, rp_tr, 1),
+	MB_SEGY_TRACEFIELD(28, 2, trc_id, 1),
+	MB_SEGY_TRACEFIELD(30, 2, num_vstk, 1),
+	MB_SEGY_TRACEFIELD(32, 2, cdp_fold, 1),
+	MB_SEGY_TRACEFIELD(34, 2, use, 1),
+	MB_SEGY_TRACEFIELD(36, 4, range, 1),
+	MB_SEGY_TRACEFIELD(40, 4, grp_elev, 1),
+	MB_SEGY_TRACEFIELD(44, 4, src_elev, 1),
+	MB_SEGY_TRACEFIELD(48, 4, src_depth, 1),
+	MB_SEGY_TRACEFIELD(52, 4, grp_datum, 1),
+	MB_SEGY_TRACEFIELD(56, 4, src_datum, 1),
+	MB_SEGY_TRACEFIELD(60, 4, src_wbd, 1),
+	MB_SEGY_TRACEFIELD(64, 4, grp_wbd, 1),
+	MB_SEGY_TRACEFIELD(68, 2, elev_scalar, 1),
+	MB_SEGY_TRACEFIELD(70, 2, coord_scalar, 1),
+	MB_SEGY_TRACEFIELD(72, 4, src_long, 1),
+	MB_SEGY_TRACEFIELD(76, 4, src_lat, 1),
+	MB_SEGY_TRACEFIELD(80, 4, grp_long, 1),
+	MB_SEGY_TRACEFIELD(84, 4, grp_lat, 1),
+	MB_SEGY_TRACEFIELD(88, 2, coord_units, 1),
+	MB_SEGY_TRACEFIELD(90, 2, wvel, 1),
+	MB_SEGY_TRACEFIELD(92, 2, sbvel, 1),
+	MB_SEGY_TRACEFIELD(94, 2, src_up_vel, 1),
+	MB_SEGY_TRACEFIELD(96, 2, grp_up_vel, 1),
+	MB_SEGY_TRACEFIELD(98, 2, src_static, 1),
+	MB_SEGY_TRACEFIELD(100, 2, grp_static, 1),
+	MB_SEGY_TRACEFIELD(102, 2, tot_static, 1),
+	MB_SEGY_TRACEFIELD(104, 2, laga, 1),
+	MB_SEGY_TRACEFIELD(106, 4, delay_mils, 1),
+	MB_SEGY_TRACEFIELD(110, 2, smute_mils, 1),
+	MB_SEGY_TRACEFIELD(112, 2, emute_mils, 1),
+	MB_SEGY_TRACEFIELD(114, 2, nsamps, 1),
+	MB_SEGY_TRACEFIELD(116, 2, si_micros, 1),
+	MB_SEGY_TRACEFIELD(118, 2, other_1, 19),
+	MB_SEGY_TRACEFIELD(156, 2, year, 1),
+	MB_SEGY_TRACEFIELD(158, 2, day_of_yr, 1),
+	MB_SEGY_TRACEFIELD(160, 2, hour, 1),
+	MB_SEGY_TRACEFIELD(162, 2, min, 1),
+	MB_SEGY_TRACEFIELD(164, 2, sec, 1),
+	MB_SEGY_TRACEFIELD(166, 2, mils, 1),
+	MB_SEGY_TRACEFIELD(168, 2, tr_weight, 1),
+	MB_SEGY_TRACEFIELD(170, 2, other_2, 5),
+	MB_SEGY_TRACEFIELD(180, 4, delay, 1),
+	MB_SEGY_TRACEFIELD(184, 4, smute_sec, 1),
+	MB_SEGY_TRACEFIELD(188, 4, emute_sec, 1),
+	MB_SEGY_TRACEFIELD(192, 4, si_secs, 1),
+	MB_SEGY_TRACEFIELD(196, 4, wbt_secs, 1),
+	MB_SEGY_TRACEFIELD(200, 4, end_of_rp, 1),
+	MB_SEGY_TRACEFIELD(204, 4, dummy1, 1),
+	MB_SEGY_TRACEFIELD(208, 4, dummy2, 1),
+	MB_SEGY_TRACEFIELD(212, 4, dummy3, 1),
+	MB_SEGY_TRACEFIELD(216, 4, sensordepthtime, 1),
+	MB_SEGY_TRACEFIELD(220, 4, soundspeed, 1),
+	MB_SEGY_TRACEFIELD(224, 4, distance, 1),
+	MB_SEGY_TRACEFIELD(228, 4, roll, 1),
+	MB_SEGY_TRACEFIELD(232, 4, pitch, 1),
+	MB_SEGY_TRACEFIELD(236, 4, heading, 1),
+};
+#define MB_SEGY_NUM_TRACEFIELDS (sizeof(mb_segy_tracefields) / sizeof(mb_segy_tracefields[0]))
+
+/*--------------------------------------------------------------------*/
+/* big- and little-endian loads written as shifts, which compilers turn
+    into byte swapping loads and vectorize in the sample loops below */
+static inline uint32_t mb_segy_get_be32(const unsigned char *buffer) {
+	return ((uint32_t)buffer[0] << 24) | ((uint32_t)buffer[1] << 16) | ((uint32_t)buffer[2] << 8) | (uint32_t)buffer[3];
+}
+static inline uint32_t mb_segy_get_le32(const unsigned char *buffer) {
+	return ((uint32_t)buffer[3] << 24) | ((uint32_t)buffer[2] << 16) | ((uint32_t)buffer[1] << 8) | (uint32_t)buffer[0];
+}
+static inline uint16_t mb_segy_get_be16(const unsigned char *buffer) {
+	return (uint16_t)(((uint16_t)buffer[0] << 8) | (uint16_t)buffer[1]);
+}
+
+/*--------------------------------------------------------------------*/
+static void mb_segy_decode_traceheader(const char *buffer, struct mb_segytraceheader_struct *traceheader) {
+	const unsigned char *ubuffer = (const unsigned char *)buffer;
+	char *header = (char *)traceheader;
+	for (size_t ifield = 0; ifield < MB_SEGY_NUM_TRACEFIELDS; ifield++) {
+		const struct mb_segy_field_struct *field = &mb_segy_tracefields[ifield];
+		for (int i = 0; i < field->count; i++) {
+			const unsigned char *value = &ubuffer[field->offset + i * field->size];
+			char *member = &header[field->member + i * field->size];
+			if (field->size == 4) {
+				const uint32_t v = mb_segy_get_be32(value);
+				memcpy(member, &v, 4);
+			}
+			else {
+				const uint16_t v = mb_segy_get_be16(value);
+				memcpy(member, &v, 2);
+			}
+		}
+	}
+}
+
+/*--------------------------------------------------------------------*/
+static size_t mb_segy_bytes_per_sample(int format) {
+	if (format == 3)
+		return 2;
+	else if (format == 8)
+		return 1;
+	else
+		return 4;
+}
+
+/*--------------------------------------------------------------------*/
+/* convert a trace of samples to float, one tight loop per sample format */
+static void mb_segy_decode_samples(int format, int nsamps, const char *buffer, float *trace) {
+	const unsigned char *ubuffer = (const unsigned char *)buffer;
+	if (format == 5 || format == 6) {
+		uint32_t *utrace = (uint32_t *)trace;
+		for (int i = 0; i < nsamps; i++)
+			utrace[i] = mb_segy_get_be32(&ubuffer[4 * i]);
+	}
+	else if (format == 11) {
+		uint32_t *utrace = (uint32_t *)trace;
+		for (int i = 0; i < nsamps; i++)
+			utrace[i] = mb_segy_get_le32(&ubuffer[4 * i]);
+	}
+	else if (format == 1) {
+		/* IBM single precision: sign bit, base 16 exponent biased by 64,
+		    and a 24 bit fraction - the scale 16^(exponent-64) * 2^-24 is
+		    built directly as the bits of a double, and the product is exact */
+		for (int i = 0; i < nsamps; i++) {
+			const uint32_t v = mb_segy_get_be32(&ubuffer[4 * i]);
+			const uint64_t scalebits = (uint64_t)(4 * ((v >> 24) & 0x7f) + 1023 - 256 - 24) << 52;
+			double scale;
+			memcpy(&scale, &scalebits, sizeof(double));
+			const double value = (double)(v & 0x00ffffff) * scale;
+			trace[i] = (float)((v >> 31) ? -value : value);
+		}
+	}
+	else if (format == 2) {
+		for (int i = 0; i < nsamps; i++)
+			trace[i] = (float)(int32_t)mb_segy_get_be32(&ubuffer[4 * i]);
+	}
+	else if (format == 3) {
+		for (int i = 0; i < nsamps; i++)
+			trace[i] = (float)(int16_t)mb_segy_get_be16(&ubuffer[2 * i]);
+	}
+	else if (format == 8) {
+		for (int i = 0; i < nsamps; i++)
+			trace[i] = (float)buffer[i];
+	}
+	else {
+		for (int i = 0; i < nsamps; i++)
+			trace[i] = 0.0;
+	}
+}
+
+/*--------------------------------------------------------------------*/
+/* returns a pointer to the next length bytes of the file, reading the file
+    in blocks of MB_SEGY_BLOCK_LENGTH bytes (or longer if needed) */
+static int mb_segy_read_block(int verbose, struct mb_segyio_struct *mb_segyio_ptr, size_t length, char **data, int *error) {
+	int status = MB_SUCCESS;
+
+	if (mb_segyio_ptr->blocksize - mb_segyio_ptr->blockpos < length) {
+		/* make sure the block can hold the requested bytes */
+		const size_t remain = mb_segyio_ptr->blocksize - mb_segyio_ptr->blockpos;
+		const size_t blockalloc = length > MB_SEGY_BLOCK_LENGTH ? length : MB_SEGY_BLOCK_LENGTH;
+		if (mb_segyio_ptr->blockalloc < blockalloc) {
+			status = mb_reallocd(verbose, __FILE__, __LINE__, blockalloc, (void **)&(mb_segyio_ptr->block), error);
+			if (status == MB_SUCCESS) {
+				mb_segyio_ptr->blockalloc = blockalloc;
+			}
+			else {
+				mb_segyio_ptr->blockalloc = 0;
+				mb_segyio_ptr->blocksize = 0;
+				mb_segyio_ptr->blockpos = 0;
+				return (status);
+			}
+		}
+
+		/* keep the unread bytes and fill the rest of the block from the file */
+		if (remain > 0)
+			memmove(mb_segyio_ptr->block, &mb_segyio_ptr->block[mb_segyio_ptr->blockpos], remain);
+		mb_segyio_ptr->blockpos = 0;
+		mb_segyio_ptr->blocksize =
+		    remain + fread(&mb_segyio_ptr->block[remain], 1, mb_segyio_ptr->blockalloc - remain, mb_segyio_ptr->fp);
+		if (mb_segyio_ptr->blocksize < length) {
+			status = MB_FAILURE;
+			*error = MB_ERROR_EOF;
+		}
+	}
+
+	if (status == MB_SUCCESS) {
+		*data = &mb_segyio_ptr->block[mb_segyio_ptr->blockpos];
+		mb_segyio_ptr->blockpos += length;
+	}
+
+	return (status);
+}
+
 
 /*--------------------------------------------------------------------*/
 /* 	function mb_segy_read_init opens an existing segy file for
@@ -463,6 +677,10 @@ int mb_segy_close(int verbose, void **mbsegyio_ptr, int *error) {
 		mb_freed(verbose, __FILE__, __LINE__, (void **)&(mb_segyio_ptr->buffer), error);
 	if (mb_segyio_ptr->tracealloc > 0)
 		mb_freed(verbose, __FILE__, __LINE__, (void **)&(mb_segyio_ptr->trace), error);
+	if (mb_segyio_ptr->blockalloc > 0)
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&(mb_segyio_ptr->block), error);
+	if (mb_segyio_ptr->index != NULL)
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&(mb_segyio_ptr->index), error);
 
 	/* close the segy file */
 	fclose(mb_segyio_ptr->fp);
@@ -509,196 +727,19 @@ int mb_segy_read_trace(int verbose, void *mbsegyio_ptr, struct mb_segytraceheade
 
 	int status = MB_SUCCESS;
 
-	/* make sure there is adequate memory in the buffer */
-	if (mb_segyio_ptr->bufferalloc < MB_SEGY_TRACEHEADER_LENGTH) {
-		/* allocate buffer memory */
-		status = mb_reallocd(verbose, __FILE__, __LINE__, MB_SEGY_TRACEHEADER_LENGTH, (void **)(void **)&(mb_segyio_ptr->buffer),
-		                     error);
-		if (status == MB_SUCCESS)
-			mb_segyio_ptr->bufferalloc = MB_SEGY_TRACEHEADER_LENGTH;
-		else
-			mb_segyio_ptr->bufferalloc = 0;
-	}
-
-	char *buffer;
-
-	/* read trace header */
-	if (status == MB_SUCCESS) {
-		buffer = (char *)mb_segyio_ptr->buffer;
-		if (fread(buffer, 1, MB_SEGY_TRACEHEADER_LENGTH, mb_segyio_ptr->fp) != MB_SEGY_TRACEHEADER_LENGTH) {
-			status = MB_FAILURE;
-			*error = MB_ERROR_EOF;
-		}
-	}
+	char *buffer = NULL;
 
-	int index = 0;
+	/* get trace header from the current block */
+	status = mb_segy_read_block(verbose, mb_segyio_ptr, MB_SEGY_TRACEHEADER_LENGTH, &buffer, error);
 
 	/* extract trace header data */
-	if (status == MB_SUCCESS) {
-		mb_get_binary_int(false, (void *)&(buffer[index]), &(traceheader->seq_num));
-		index += 4;
-		mb_get_binary_int(false, (void *)&(buffer[index]), &(traceheader->seq_reel));
-		index += 4;
-		mb_get_binary_int(false, (void *)&(buffer[index]), &(traceheader->shot_num));
-		index += 4;
-		mb_get_binary_int(false, (void *)&(buffer[index]), &(traceheader->shot_tr));
-		index += 4;
-		mb_get_binary_int(false, (void *)&(buffer[index]), &(traceheader->espn));
-		index += 4;
-		mb_get_binary_int(false, (void *)&(buffer[index]), &(traceheader->rp_num));
-		index += 4;
-		mb_get_binary_int(false, (void *)&(buffer[index]), &(traceheader->rp_tr));
-		index += 4;
-		mb_get_binary_short(false, (void *)&(buffer[index]), &(traceheader->trc_id));
-		index += 2;
-		mb_get_binary_short(false, (void *)&(buffer[index]), &(traceheader->num_vstk));
-		index += 2;
-		mb_get_binary_short(false, (void *)&(buffer[index]), &(traceheader->cdp_fold));
-		index += 2;
-		mb_get_binary_short(false, (void *)&(buffer[index]), &(traceheader->use));
-		index += 2;
-		mb_get_binary_int(false, (void *)&(buffer[index]), &(traceheader->range));
-		index += 4;
-		mb_get_binary_int(false, (void *)&(buffer[index]), &(traceheader->grp_elev));
-		index += 4;
-		mb_get_binary_int(false, (void *)&(buffer[index]), &(traceheader->src_elev));
-		index += 4;
-		mb_get_binary_int(false, (void *)&(buffer[index]), &(traceheader->src_depth));
-		index += 4;
-		mb_get_binary_int(false, (void *)&(buffer[index]), &(traceheader->grp_datum));
-		index += 4;
-		mb_get_binary_int(false, (void *)&(buffer[index]), &(traceheader->src_datum));
-		index += 4;
-		mb_get_binary_int(false, (void *)&(buffer[index]), &(traceheader->src_wbd));
-		index += 4;
-		mb_get_binary_int(false, (void *)&(buffer[index]), &(traceheader->grp_wbd));
-		index += 4;
-		mb_get_binary_short(false, (void *)&(buffer[index]), &(traceheader->elev_scalar));
-		index += 2;
-		mb_get_binary_short(false, (void *)&(buffer[index]), &(traceheader->coord_scalar));
-		index += 2;
-		mb_get_binary_int(false, (void *)&(buffer[index]), &(traceheader->src_long));
-		index += 4;
-		mb_get_binary_int(false, (void *)&(buffer[index]), &(traceheader->src_lat));
-		index += 4;
-		mb_get_binary_int(false, (void *)&(buffer[index]), &(traceheader->grp_long));
-		index += 4;
-		mb_get_binary_int(false, (void *)&(buffer[index]), &(traceheader->grp_lat));
-		index += 4;
-		mb_get_binary_short(false, (void *)&(buffer[index]), &(traceheader->coord_units));
-		index += 2;
-		mb_get_binary_short(false, (void *)&(buffer[index]), &(traceheader->wvel));
-		index += 2;
-		mb_get_binary_short(false, (void *)&(buffer[index]), &(traceheader->sbvel));
-		index += 2;
-		mb_get_binary_short(false, (void *)&(buffer[index]), &(traceheader->src_up_vel));
-		index += 2;
-		mb_get_binary_short(false, (void *)&(buffer[index]), &(traceheader->grp_up_vel));
-		index += 2;
-		mb_get_binary_short(false, (void *)&(buffer[index]), &(traceheader->src_static));
-		index += 2;
-		mb_get_binary_short(false, (void *)&(buffer[index]), &(traceheader->grp_static));
-		index += 2;
-		mb_get_binary_short(false, (void *)&(buffer[index]), &(traceheader->tot_static));
-		index += 2;
-		mb_get_binary_short(false, (void *)&(buffer[index]), &(traceheader->laga));
-		index += 2;
-		mb_get_binary_int(false, (void *)&(buffer[index]), &(traceheader->delay_mils));
-		index += 4;
-		mb_get_binary_short(false, (void *)&(buffer[index]), &(traceheader->smute_mils));
-		index += 2;
-		mb_get_binary_short(false, (void *)&(buffer[index]), &(traceheader->emute_mils));
-		index += 2;
-		mb_get_binary_short(false, (void *)&(buffer[index]), &(traceheader->nsamps));
-		index += 2;
-		mb_get_binary_short(false, (void *)&(buffer[index]), &(traceheader->si_micros));
-		index += 2;
-		for (int i = 0; i < 19; i++) {
-			mb_get_binary_short(false, (void *)&(buffer[index]), &(traceheader->other_1[i]));
-			index += 2;
-		}
-		mb_get_binary_short(false, (void *)&(buffer[index]), &(traceheader->year));
-		index += 2;
-		mb_get_binary_short(false, (void *)&(buffer[index]), &(traceheader->day_of_yr));
-		index += 2;
-		mb_get_binary_short(false, (void *)&(buffer[index]), &(traceheader->hour));
-		index += 2;
-		mb_get_binary_short(false, (void *)&(buffer[index]), &(traceheader->min));
-		index += 2;
-		mb_get_binary_short(false, (void *)&(buffer[index]), &(traceheader->sec));
-		index += 2;
-		mb_get_binary_short(false, (void *)&(buffer[index]), &(traceheader->mils));
-		index += 2;
-		mb_get_binary_short(false, (void *)&(buffer[index]), &(traceheader->tr_weight));
-		index += 2;
-		for (int i = 0; i < 5; i++) {
-			mb_get_binary_short(false, (void *)&(buffer[index]), &(traceheader->other_2[i]));
-			index += 2;
-		}
-		mb_get_binary_float(false, (void *)&(buffer[index]), &(traceheader->delay));
-		index += 4;
-		mb_get_binary_float(false, (void *)&(buffer[index]), &(traceheader->smute_sec));
-		index += 4;
-		mb_get_binary_float(false, (void *)&(buffer[index]), &(traceheader->emute_sec));
-		index += 4;
-		mb_get_binary_float(false, (void *)&(buffer[index]), &(traceheader->si_secs));
-		index += 4;
-		mb_get_binary_float(false, (void *)&(buffer[index]), &(traceheader->wbt_secs));
-		index += 4;
-		mb_get_binary_int(false, (void *)&(buffer[index]), &(traceheader->end_of_rp));
-		index += 4;
-		mb_get_binary_float(false, (void *)&(buffer[index]), &(traceheader->dummy1));
-		index += 4;
-		mb_get_binary_float(false, (void *)&(buffer[index]), &(traceheader->dummy2));
-		index += 4;
-		mb_get_binary_float(false, (void *)&(buffer[index]), &(traceheader->dummy3));
-		index += 4;
-		mb_get_binary_float(false, (void *)&(buffer[index]), &(traceheader->sensordepthtime));
-		index += 4;
-		mb_get_binary_float(false, (void *)&(buffer[index]), &(traceheader->soundspeed));
-		index += 4;
-		mb_get_binary_float(false, (void *)&(buffer[index]), &(traceheader->distance));
-		index += 4;
-		mb_get_binary_float(false, (void *)&(buffer[index]), &(traceheader->roll));
-		index += 4;
-		mb_get_binary_float(false, (void *)&(buffer[index]), &(traceheader->pitch));
-		index += 4;
-		mb_get_binary_float(false, (void *)&(buffer[index]), &(traceheader->heading));
-		index += 4;
-	}
+	if (status == MB_SUCCESS)
+		mb_segy_decode_traceheader(buffer, traceheader);
 
-	size_t bytes_per_sample;
+	const size_t bytes_per_sample = mb_segy_bytes_per_sample(fileheader->format);
 
 	/* make sure there is adequate memory */
 	if (status == MB_SUCCESS) {
-		/* get bytes per sample */
-		if (fileheader->format == 5 || fileheader->format == 6 || fileheader->format == 11 || fileheader->format == 2) {
-			bytes_per_sample = 4;
-		}
-		else if (fileheader->format == 1) {
-			bytes_per_sample = 4;
-		}
-		else if (fileheader->format == 3) {
-			bytes_per_sample = 2;
-		}
-		else if (fileheader->format == 8) {
-			bytes_per_sample = 1;
-		}
-		else {
-			bytes_per_sample = 4;
-		}
-
-		/* check buffer memory */
-		if (mb_segyio_ptr->bufferalloc < bytes_per_sample * traceheader->nsamps) {
-			/* allocate buffer memory */
-			status = mb_reallocd(verbose, __FILE__, __LINE__, bytes_per_sample * traceheader->nsamps,
-			                     (void **)&(mb_segyio_ptr->buffer), error);
-			if (status == MB_SUCCESS)
-				mb_segyio_ptr->bufferalloc = bytes_per_sample * traceheader->nsamps;
-			else
-				mb_segyio_ptr->bufferalloc = 0;
-		}
-
 		/* check trace memory */
 		if (mb_segyio_ptr->tracealloc < sizeof(float) * traceheader->nsamps) {
 			/* allocate trace memory */
@@ -711,48 +752,16 @@ int mb_segy_read_trace(int verbose, void *mbsegyio_ptr, struct mb_segytraceheade
 		}
 	}
 
-	/* read trace */
-	if (status == MB_SUCCESS) {
-		buffer = mb_segyio_ptr->buffer;
-		if (fread(buffer, 1, bytes_per_sample * traceheader->nsamps, mb_segyio_ptr->fp) !=
-		    bytes_per_sample * traceheader->nsamps) {
-			status = MB_FAILURE;
-			*error = MB_ERROR_EOF;
-		}
-	}
+	/* get trace samples from the current block */
+	if (status == MB_SUCCESS)
+		status = mb_segy_read_block(verbose, mb_segyio_ptr, bytes_per_sample * traceheader->nsamps, &buffer, error);
 
 	float *trace = NULL;
 
 	/* extract trace data */
 	if (status == MB_SUCCESS) {
 		trace = (float *)mb_segyio_ptr->trace;
-		index = 0;
-		for (int i = 0; i < traceheader->nsamps; i++) {
-			if (fileheader->format == 5 || fileheader->format == 6 || fileheader->format == 1) {
-				mb_get_binary_float(false, (void *)&(buffer[index]), &(trace[i]));
-				index += bytes_per_sample;
-			}
-			else if (fileheader->format == 11) {
-				mb_get_binary_float(true, (void *)&(buffer[index]), &(trace[i]));
-				index += bytes_per_sample;
-			}
-			else if (fileheader->format == 2) {
-				int intval = 0;
-				mb_get_binary_int(false, (void *)&(buffer[index]), &(intval));
-				trace[i] = (float)intval;
-				index += bytes_per_sample;
-			}
-			else if (fileheader->format == 3) {
-				short shortval = 0;
-				mb_get_binary_short(false, (void *)&(buffer[index]), &(shortval));
-				trace[i] = (float)shortval;
-				index += bytes_per_sample;
-			}
-			else if (fileheader->format == 8) {
-				trace[i] = (float)buffer[i];
-				index++;
-			}
-		}
+		mb_segy_decode_samples(fileheader->format, traceheader->nsamps, buffer, trace);
 	}
 
 	/* set return pointers */
@@ -847,6 +856,141 @@ int mb_segy_read_trace(int verbose, void *mbsegyio_ptr, struct mb_segytraceheade
 
 	return (status);
 }
+/*--------------------------------------------------------------------*/
+/* 	function mb_segy_read_index scans the trace headers of an open
+    segy file and returns an index holding the file offset, shot,
+    cdp and number of samples of each trace. The index is built once
+    and kept with the segyio structure, and the read position in the
+    file is left unchanged. */
+int mb_segy_read_index(int verbose, void *mbsegyio_ptr, int *nindex, struct mb_segyindex_struct **index, int *error) {
+	if (verbose >= 2) {
+		fprintf(stderr, "\ndbg2  MBIO function <%s> called\n", __func__);
+		fprintf(stderr, "dbg2  Input arguments:\n");
+		fprintf(stderr, "dbg2       verbose:          %d\n", verbose);
+		fprintf(stderr, "dbg2       mbsegyio_ptr:     %p\n", (void *)mbsegyio_ptr);
+	}
+
+	/* get segyio pointer */
+	struct mb_segyio_struct *mb_segyio_ptr = (struct mb_segyio_struct *)mbsegyio_ptr;
+	struct mb_segyfileheader_struct *fileheader = (struct mb_segyfileheader_struct *)&(mb_segyio_ptr->fileheader);
+
+	int status = MB_SUCCESS;
+	*error = MB_ERROR_NO_ERROR;
+
+	if (!mb_segyio_ptr->indexed) {
+		/* save the logical read position, which lags the file
+		    position by the unread part of the current block */
+		const off_t position = ftello(mb_segyio_ptr->fp) - (off_t)(mb_segyio_ptr->blocksize - mb_segyio_ptr->blockpos);
+		const size_t bytes_per_sample = mb_segy_bytes_per_sample(fileheader->format);
+
+		/* walk the trace headers from the end of the file headers */
+		char buffer[MB_SEGY_TRACEHEADER_LENGTH];
+		struct mb_segytraceheader_struct traceheader;
+		int nalloc = 0;
+		int ntrace = 0;
+		off_t offset = MB_SEGY_ASCIIHEADER_LENGTH + MB_SEGY_FILEHEADER_LENGTH;
+		while (status == MB_SUCCESS && fseeko(mb_segyio_ptr->fp, offset, SEEK_SET) == 0 &&
+		       fread(buffer, 1, MB_SEGY_TRACEHEADER_LENGTH, mb_segyio_ptr->fp) == MB_SEGY_TRACEHEADER_LENGTH) {
+			mb_segy_decode_traceheader(buffer, &traceheader);
+			if (ntrace >= nalloc) {
+				nalloc += 4096;
+				status = mb_reallocd(verbose, __FILE__, __LINE__, nalloc * sizeof(struct mb_segyindex_struct),
+				                     (void **)&(mb_segyio_ptr->index), error);
+			}
+			if (status == MB_SUCCESS) {
+				struct mb_segyindex_struct *entry = &mb_segyio_ptr->index[ntrace];
+				entry->offset = offset;
+				entry->shot_num = traceheader.shot_num;
+				entry->shot_tr = traceheader.shot_tr;
+				entry->rp_num = traceheader.rp_num;
+				entry->rp_tr = traceheader.rp_tr;
+				entry->nsamps = traceheader.nsamps;
+				ntrace++;
+				offset += MB_SEGY_TRACEHEADER_LENGTH + (off_t)(bytes_per_sample * traceheader.nsamps);
+			}
+		}
+
+		/* drop a last trace cut short by the end of the file */
+		if (status == MB_SUCCESS && ntrace > 0) {
+			struct mb_segyindex_struct *entry = &mb_segyio_ptr->index[ntrace - 1];
+			if (fseeko(mb_segyio_ptr->fp, 0, SEEK_END) == 0 &&
+			    ftello(mb_segyio_ptr->fp) < entry->offset + MB_SEGY_TRACEHEADER_LENGTH + (off_t)(bytes_per_sample * entry->nsamps))
+				ntrace--;
+		}
+		mb_segyio_ptr->nindex = ntrace;
+		mb_segyio_ptr->indexed = status == MB_SUCCESS;
+
+		/* restore the read position and discard the current block */
+		if (fseeko(mb_segyio_ptr->fp, position, SEEK_SET) != 0 && status == MB_SUCCESS) {
+			status = MB_FAILURE;
+			*error = MB_ERROR_EOF;
+		}
+		mb_segyio_ptr->blocksize = 0;
+		mb_segyio_ptr->blockpos = 0;
+	}
+
+	*nindex = mb_segyio_ptr->nindex;
+	*index = mb_segyio_ptr->index;
+
+	if (verbose >= 2) {
+		fprintf(stderr, "\ndbg2  MBIO function <%s> completed\n", __func__);
+		fprintf(stderr, "dbg2  Return value:\n");
+		fprintf(stderr, "dbg2       nindex:        %d\n", *nindex);
+		fprintf(stderr, "dbg2       index:         %p\n", (void *)*index);
+		fprintf(stderr, "dbg2       error:         %d\n", *error);
+		fprintf(stderr, "dbg2  Return status:\n");
+		fprintf(stderr, "dbg2       status:       %d\n", status);
+	}
+
+	return (status);
+}
+
+/*--------------------------------------------------------------------*/
+/* 	function mb_segy_seek_trace positions an open segy file so that
+    the next call to mb_segy_read_trace returns trace itrace (counting
+    from zero), building the trace index first if necessary. */
+int mb_segy_seek_trace(int verbose, void *mbsegyio_ptr, int itrace, int *error) {
+	if (verbose >= 2) {
+		fprintf(stderr, "\ndbg2  MBIO function <%s> called\n", __func__);
+		fprintf(stderr, "dbg2  Input arguments:\n");
+		fprintf(stderr, "dbg2       verbose:          %d\n", verbose);
+		fprintf(stderr, "dbg2       mbsegyio_ptr:     %p\n", (void *)mbsegyio_ptr);
+		fprintf(stderr, "dbg2       itrace:           %d\n", itrace);
+	}
+
+	/* get segyio pointer */
+	struct mb_segyio_struct *mb_segyio_ptr = (struct mb_segyio_struct *)mbsegyio_ptr;
+
+	int nindex = 0;
+	struct mb_segyindex_struct *index = NULL;
+	int status = mb_segy_read_index(verbose, mbsegyio_ptr, &nindex, &index, error);
+
+	if (status == MB_SUCCESS) {
+		if (itrace < 0 || itrace >= nindex) {
+			status = MB_FAILURE;
+			*error = MB_ERROR_EOF;
+		}
+		else if (fseeko(mb_segyio_ptr->fp, index[itrace].offset, SEEK_SET) != 0) {
+			status = MB_FAILURE;
+			*error = MB_ERROR_EOF;
+		}
+		else {
+			mb_segyio_ptr->blocksize = 0;
+			mb_segyio_ptr->blockpos = 0;
+		}
+	}
+
+	if (verbose >= 2) {
+		fprintf(stderr, "\ndbg2  MBIO function <%s> completed\n", __func__);
+		fprintf(stderr, "dbg2  Return value:\n");
+		fprintf(stderr, "dbg2       error:         %d\n", *error);
+		fprintf(stderr, "dbg2  Return status:\n");
+		fprintf(stderr, "dbg2       status:       %d\n", status);
+	}
+
+	return (status);
+}
+
 /*--------------------------------------------------------------------*/
 /* 	function mb_segy_write_trace writes a trace header and the trace
     data to an open segy file. The trace data array is passed
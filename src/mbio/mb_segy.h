@@ -42,11 +42,16 @@
 #ifndef MB_SEGY_H_
 #define MB_SEGY_H_
 
+#include <sys/types.h>
+
 /* Standard SEGY format sizes */
 #define MB_SEGY_ASCIIHEADER_LENGTH 3200
 #define MB_SEGY_FILEHEADER_LENGTH 400
 #define MB_SEGY_TRACEHEADER_LENGTH 240
 
+/* Size of the blocks in which segy files are read */
+#define MB_SEGY_BLOCK_LENGTH 1048576
+
 /* Flags used to specify desired data type in mb_extract_segy() calls */
 #define MB_SEGY_SAMPLEFORMAT_NONE 1
 #define MB_SEGY_SAMPLEFORMAT_TRACE 2
@@ -181,6 +186,14 @@ struct mb_segytraceheader_struct {
 	float pitch;              /* bytes 232-235, pitch in degrees (MB-System only) */
 	float heading;            /* bytes 236-239, heading in degrees (MB-System only) */
 };
+struct mb_segyindex_struct {
+	off_t offset;          /* file offset of the trace header */
+	int shot_num;
+	int shot_tr;
+	int rp_num;
+	int rp_tr;
+	unsigned short nsamps; /* same type as mb_segytraceheader_struct nsamps */
+};
 struct mb_segyio_struct {
 	FILE *fp;
 	char segyfile[MB_PATH_MAXLINE];
@@ -193,6 +206,13 @@ struct mb_segyio_struct {
 	struct mb_segytraceheader_struct traceheader;
 	size_t tracealloc;
 	float *trace;
+	size_t blockalloc;
+	size_t blocksize;      /* bytes of the file held in block */
+	size_t blockpos;       /* position of the next unread byte in block */
+	char *block;
+	int indexed;           /* index built, possibly with no traces */
+	int nindex;
+	struct mb_segyindex_struct *index;
 };
 
 #ifdef __cplusplus
@@ -208,6 +228,8 @@ int mb_segy_close(int verbose, void **mbsegyio_ptr, int *error);
 int mb_segy_read_trace(int verbose, void *mbsegyio_ptr, struct mb_segytraceheader_struct *traceheaderptr, float **traceptr,
                        int *error);
 int mb_segy_write_trace(int verbose, void *mbsegyio_ptr, struct mb_segytraceheader_struct *traceheader, float *trace, int *error);
+int mb_segy_read_index(int verbose, void *mbsegyio_ptr, int *nindex, struct mb_segyindex_struct **index, int *error);
+int mb_segy_seek_trace(int verbose, void *mbsegyio_ptr, int itrace, int *error);
 void hilbert(int n, double delta[], double kappa[]);
 void hilbert2(int n, double data[]);
 
@@ -32,6 +32,7 @@
 #include <math.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "mb_define.h"
@@ -387,7 +388,16 @@ int mb_write_init(int verbose, char *file, int format, void **mbio_ptr, int *bea
 #endif
 	/* else handle netcdf files to be opened with libnetcdf */
 	else if (mb_io_ptr->filetype == MB_FILETYPE_NETCDF) {
-		status = nc_create(mb_io_ptr->file, NC_CLOBBER, (int *)&(mb_io_ptr->ncid));
+		/* write NetCDF-4 (chunked, and compressed at the deflate level
+			given) if netcdfdeflate is set by mbdefaults, otherwise
+			classic netCDF */
+		int netcdfdeflate = -1;
+		mb_netcdfdeflate(verbose, &netcdfdeflate);
+		status = NC_ENOTBUILT;
+		if (netcdfdeflate >= 0)
+			status = nc_create(mb_io_ptr->file, NC_CLOBBER | NC_NETCDF4 | NC_CLASSIC_MODEL, (int *)&(mb_io_ptr->ncid));
+		if (status != 0)
+			status = nc_create(mb_io_ptr->file, NC_CLOBBER, (int *)&(mb_io_ptr->ncid));
 		if (status == 0) {
 			status = MB_SUCCESS;
 			*error = MB_ERROR_NO_ERROR;
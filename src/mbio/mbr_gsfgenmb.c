@@ -47,7 +47,7 @@
 #include "mbsys_gsf.h"
 
 /* GSF error value */
-extern int gsfError;
+extern GSF_THREAD_LOCAL int gsfError;
 
 /*--------------------------------------------------------------------*/
 int mbr_info_gsfgenmb(int verbose, int *system, int *beams_bath_max, int *beams_amp_max, int *pixels_ss_max, char *format_name,
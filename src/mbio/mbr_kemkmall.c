@@ -4668,6 +4668,37 @@ numOfDgms, dgmNum, header.numBytesDgm, dgm_index->index_org, dgm_index->ping_num
       }
     }
 
+    // else if reading from a socket that can lease frames, parse the next
+    // record in place from the input frame
+    else if (mb_io_ptr->mb_io_input_lease != NULL) {
+      char *frame = NULL;
+      read_len = 0;
+      buffer = (char *)*bufferptr;
+      status = mb_fileio_lease(verbose, mbio_ptr, &frame, &read_len, error);
+      if (status == MB_SUCCESS && frame != NULL) {
+        buffer = frame;
+        mb_io_ptr->file_pos += read_len;
+        status = mbr_kemkmall_rd_hdr(verbose, buffer, (void *)&header, (void *)&emdgm_type, error);
+        store->time_d = ((double)header.time_sec) + MBSYS_KMBES_NANO * header.time_nanosec;
+        mb_get_date(verbose, store->time_d, store->time_i);
+
+        // ignore partitioned datagrams not reassembled by the input
+        if (status == MB_SUCCESS && (emdgm_type == MRZ || emdgm_type == MWC)) {
+          unsigned short numOfDgms = -1;
+          mb_get_binary_short(true, &buffer[MBSYS_KMBES_HEADER_SIZE], &numOfDgms);
+          if (numOfDgms != 1) {
+            *error = MB_ERROR_UNINTELLIGIBLE;
+            status = MB_FAILURE;
+          }
+        }
+      }
+      else if (status == MB_SUCCESS) {
+        // input recovered from a socket error without returning a frame
+        *error = MB_ERROR_UNINTELLIGIBLE;
+        status = MB_FAILURE;
+      }
+    }
+
     // else if reading from a socket, read the entire next record at once
     else {
       // ensure buffer is large enough for the largest possible number of
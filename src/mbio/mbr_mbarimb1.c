@@ -271,20 +271,42 @@ int mbr_rt_mbarimb1(int verbose, void *mbio_ptr, void *store_ptr, int *error) {
   bufferalloc = (size_t *)&mb_io_ptr->structure_size;
   buffer = *bufferptr;
 
-  /* read next header from file, skipping bytes to find sync if necessary */
-  size_t read_len = MBF_MBARIMB1_HEADERSIZE;
-  int skip = 0;
-  status = mb_fileio_get(verbose, mbio_ptr, (void *)buffer, &read_len, error);
-  mb_io_ptr->file_bytes += read_len;
-  while (status == MB_SUCCESS && strncmp(buffer, "MB1", 4) != 0) {
-    for (int i=0;i<MBF_MBARIMB1_HEADERSIZE-1;i++) {
-      buffer[i] = buffer[i+1];
+  /* if the input can lease complete frames then parse the record in place */
+  size_t read_len = 0;
+  size_t frame_len = 0;
+  bool leased = false;
+  if (mb_io_ptr->mbsp != NULL && mb_io_ptr->mb_io_input_lease != NULL) {
+    char *frame = NULL;
+    status = mb_fileio_lease(verbose, mbio_ptr, &frame, &frame_len, error);
+    if (status == MB_SUCCESS) {
+      if (frame != NULL && frame_len >= (size_t)MBF_MBARIMB1_HEADERSIZE && strncmp(frame, "MB1", 4) == 0) {
+        buffer = frame;
+        leased = true;
+        mb_io_ptr->file_bytes += frame_len;
+      }
+      else {
+        status = MB_FAILURE;
+        *error = MB_ERROR_UNINTELLIGIBLE;
+      }
+    }
+  }
+
+  /* else read next header from file, skipping bytes to find sync if necessary */
+  else {
+    read_len = MBF_MBARIMB1_HEADERSIZE;
+    int skip = 0;
+    status = mb_fileio_get(verbose, mbio_ptr, (void *)buffer, &read_len, error);
+    mb_io_ptr->file_bytes += read_len;
+    while (status == MB_SUCCESS && strncmp(buffer, "MB1", 4) != 0) {
+      for (int i=0;i<MBF_MBARIMB1_HEADERSIZE-1;i++) {
+        buffer[i] = buffer[i+1];
+      }
+      read_len = 1;
+      status = mb_fileio_get(verbose, mbio_ptr, (void *)&buffer[MBF_MBARIMB1_HEADERSIZE-1], &read_len, error);
+      skip++;
     }
-    read_len = 1;
-    status = mb_fileio_get(verbose, mbio_ptr, (void *)&buffer[MBF_MBARIMB1_HEADERSIZE-1], &read_len, error);
-    skip++;
+    mb_io_ptr->file_bytes += skip;
   }
-  mb_io_ptr->file_bytes += skip;
 
   /* parse the header */
   double time_d = 0.0;;
@@ -334,8 +356,20 @@ int mbr_rt_mbarimb1(int verbose, void *mbio_ptr, void *store_ptr, int *error) {
 
   }
 
+  // beams follow the header in a leased frame
+  if (status == MB_SUCCESS && leased) {
+    read_len = MBF_MBARIMB1_BEAMSIZE * beams_bath;
+    if (frame_len < MBF_MBARIMB1_HEADERSIZE + read_len) {
+      status = MB_FAILURE;
+      *error = MB_ERROR_UNINTELLIGIBLE;
+    }
+    else {
+      buffer = &buffer[MBF_MBARIMB1_HEADERSIZE];
+    }
+  }
+
   // make sure buffer is large enough to read the record
-  if (status == MB_SUCCESS) {
+  else if (status == MB_SUCCESS) {
     read_len = MBF_MBARIMB1_BEAMSIZE * beams_bath + 1;
     if (*bufferalloc < read_len) {
       *bufferalloc = read_len;
@@ -382,7 +416,7 @@ int mbr_rt_mbarimb1(int verbose, void *mbio_ptr, void *store_ptr, int *error) {
   }
 
   // read the rest of the record
-  if (status == MB_SUCCESS) {
+  if (status == MB_SUCCESS && !leased) {
     status = mb_fileio_get(verbose, mbio_ptr, (void *)buffer, &read_len, error);
     mb_io_ptr->file_bytes += read_len;
   }
@@ -50,6 +50,320 @@
 
 // #define MBNETCDF_DEBUG 1
 
+/*--------------------------------------------------------------------*/
+/* Per-ping variables are read and written through a staging cache that
+ * holds a block of records of each variable, so that each variable costs
+ * one netCDF call per block rather than one per ping. The cache lives in
+ * mb_io_ptr->saveptr1, indexed by variable id. */
+struct mbr_mbnetcdf_block {
+  bool init;                    /* variable has been set up */
+  bool record;                  /* variable runs along the record dimension */
+  nc_type memtype;              /* NC_CHAR, NC_SHORT or NC_INT as requested */
+  size_t typesize;
+  int ndims;
+  size_t dimlen[NC_MAX_VAR_DIMS];
+  size_t recsize;               /* values per record */
+  size_t nrec_max;              /* records per block */
+  size_t start;                 /* first record held */
+  size_t nrec;                  /* records held */
+  void *buf;
+};
+
+struct mbr_mbnetcdf_blocks {
+  bool write;
+  int nvars;
+  struct mbr_mbnetcdf_block *var;
+};
+
+/*--------------------------------------------------------------------*/
+static int mbr_mbnetcdf_get_vara_type(int ncid, int varid, nc_type memtype, const size_t *start, const size_t *count,
+                                      void *value) {
+  switch (memtype) {
+  case NC_CHAR:
+    return (nc_get_vara_text(ncid, varid, start, count, (char *)value));
+  case NC_SHORT:
+    return (nc_get_vara_short(ncid, varid, start, count, (short *)value));
+  case NC_INT:
+    return (nc_get_vara_int(ncid, varid, start, count, (int *)value));
+  default:
+    return (NC_EBADTYPE);
+  }
+}
+/*--------------------------------------------------------------------*/
+static int mbr_mbnetcdf_put_vara_type(int ncid, int varid, nc_type memtype, const size_t *start, const size_t *count,
+                                      const void *value) {
+  switch (memtype) {
+  case NC_CHAR:
+    return (nc_put_vara_text(ncid, varid, start, count, (const char *)value));
+  case NC_SHORT:
+    return (nc_put_vara_short(ncid, varid, start, count, (const short *)value));
+  case NC_INT:
+    return (nc_put_vara_int(ncid, varid, start, count, (const int *)value));
+  default:
+    return (NC_EBADTYPE);
+  }
+}
+/*--------------------------------------------------------------------*/
+/* Get the cache entry for a variable, setting it up on first use. Returns
+ * NULL for variables that are not staged (not along the record dimension)
+ * or if the cache cannot be allocated. */
+static struct mbr_mbnetcdf_block *mbr_mbnetcdf_block_var(int verbose, struct mb_io_struct *mb_io_ptr, bool write,
+                                                         int varid, nc_type memtype) {
+  int error = MB_ERROR_NO_ERROR;
+  struct mbr_mbnetcdf_blocks *blocks = (struct mbr_mbnetcdf_blocks *)mb_io_ptr->saveptr1;
+  if (blocks == NULL) {
+    int nvars = 0;
+    if (nc_inq_nvars(mb_io_ptr->ncid, &nvars) != NC_NOERR || nvars <= 0)
+      return (NULL);
+    if (mb_mallocd(verbose, __FILE__, __LINE__, sizeof(struct mbr_mbnetcdf_blocks), (void **)&blocks, &error) != MB_SUCCESS)
+      return (NULL);
+    blocks->write = write;
+    blocks->nvars = nvars;
+    blocks->var = NULL;
+    if (mb_mallocd(verbose, __FILE__, __LINE__, nvars * sizeof(struct mbr_mbnetcdf_block), (void **)&blocks->var, &error) !=
+        MB_SUCCESS) {
+      mb_freed(verbose, __FILE__, __LINE__, (void **)&blocks, &error);
+      return (NULL);
+    }
+    memset(blocks->var, 0, nvars * sizeof(struct mbr_mbnetcdf_block));
+    mb_io_ptr->saveptr1 = blocks;
+  }
+  if (varid < 0 || varid >= blocks->nvars)
+    return (NULL);
+
+  struct mbr_mbnetcdf_block *block = &blocks->var[varid];
+  if (!block->init) {
+    block->init = true;
+    block->record = false;
+    int unlimdimid = -1;
+    int dimids[NC_MAX_VAR_DIMS];
+    if (nc_inq_unlimdim(mb_io_ptr->ncid, &unlimdimid) != NC_NOERR
+        || nc_inq_varndims(mb_io_ptr->ncid, varid, &block->ndims) != NC_NOERR
+        || block->ndims < 1
+        || nc_inq_vardimid(mb_io_ptr->ncid, varid, dimids) != NC_NOERR
+        || dimids[0] != unlimdimid)
+      return (NULL);
+    block->recsize = 1;
+    for (int i = 0; i < block->ndims; i++) {
+      if (nc_inq_dimlen(mb_io_ptr->ncid, dimids[i], &block->dimlen[i]) != NC_NOERR)
+        return (NULL);
+      if (i > 0)
+        block->recsize *= block->dimlen[i];
+    }
+    if (block->recsize == 0)
+      return (NULL);
+
+    /* records of CIB_BLOCK_DIM files hold several pings each */
+    const size_t pings = block->ndims > 2 ? MAX(block->dimlen[1], 1) : 1;
+    block->nrec_max = MAX(MBSYS_NETCDF_BLOCK_PINGS / pings, 1);
+    block->memtype = memtype;
+    block->typesize = memtype == NC_CHAR ? sizeof(char) : (memtype == NC_SHORT ? sizeof(short) : sizeof(int));
+    block->start = 0;
+    block->nrec = 0;
+    block->buf = NULL;
+    if (mb_mallocd(verbose, __FILE__, __LINE__, block->nrec_max * block->recsize * block->typesize, (void **)&block->buf,
+                   &error) != MB_SUCCESS)
+      return (NULL);
+    block->record = true;
+  }
+  if (!block->record || block->memtype != memtype)
+    return (NULL);
+
+  return (block);
+}
+/*--------------------------------------------------------------------*/
+/* Copy the hyperslab index/count of one record between a value array and
+ * a record held in the cache (to the cache if put is true). */
+static void mbr_mbnetcdf_block_copy(const struct mbr_mbnetcdf_block *block, const size_t *index, const size_t *count,
+                                    void *value, bool put) {
+  char *rec = (char *)block->buf + (index[0] - block->start) * block->recsize * block->typesize;
+  char *val = (char *)value;
+  if (block->ndims == 1) {
+    if (put)
+      memcpy(rec, val, block->typesize);
+    else
+      memcpy(val, rec, block->typesize);
+    return;
+  }
+
+  /* rows over the dimensions between the record and the last dimension */
+  const int last = block->ndims - 1;
+  const size_t rowsize = count[last] * block->typesize;
+  size_t nrows = 1;
+  for (int i = 1; i < last; i++)
+    nrows *= count[i];
+  for (size_t row = 0; row < nrows; row++) {
+    size_t offset = index[last];
+    size_t stride = block->dimlen[last];
+    size_t r = row;
+    for (int i = last - 1; i >= 1; i--) {
+      offset += (index[i] + r % count[i]) * stride;
+      r /= count[i];
+      stride *= block->dimlen[i];
+    }
+    if (put)
+      memcpy(rec + offset * block->typesize, val + row * rowsize, rowsize);
+    else
+      memcpy(val + row * rowsize, rec + offset * block->typesize, rowsize);
+  }
+}
+/*--------------------------------------------------------------------*/
+/* Read a hyperslab of one record of a per-ping variable, reading the next
+ * block of records into the cache when the record is not held. */
+static int mbr_mbnetcdf_block_get(int verbose, struct mb_io_struct *mb_io_ptr, nc_type memtype, int varid,
+                                  const size_t *index, const size_t *count, void *value) {
+  struct mbr_mbnetcdf_block *block = mbr_mbnetcdf_block_var(verbose, mb_io_ptr, false, varid, memtype);
+  if (block == NULL || count[0] != 1 || index[0] >= block->dimlen[0])
+    return (mbr_mbnetcdf_get_vara_type(mb_io_ptr->ncid, varid, memtype, index, count, value));
+  for (int i = 1; i < block->ndims; i++)
+    if (index[i] + count[i] > block->dimlen[i])
+      return (mbr_mbnetcdf_get_vara_type(mb_io_ptr->ncid, varid, memtype, index, count, value));
+
+  if (index[0] < block->start || index[0] >= block->start + block->nrec) {
+    size_t start[NC_MAX_VAR_DIMS];
+    size_t length[NC_MAX_VAR_DIMS];
+    start[0] = index[0];
+    length[0] = MIN(block->nrec_max, block->dimlen[0] - index[0]);
+    for (int i = 1; i < block->ndims; i++) {
+      start[i] = 0;
+      length[i] = block->dimlen[i];
+    }
+    block->start = index[0];
+    block->nrec = 0;
+    const int nc_status = mbr_mbnetcdf_get_vara_type(mb_io_ptr->ncid, varid, memtype, start, length, block->buf);
+    if (nc_status != NC_NOERR) {
+      if (verbose >= 2)
+        fprintf(stderr, "nc_get_vara block of %zu records at %zu error: %s\n", length[0], start[0], nc_strerror(nc_status));
+      return (mbr_mbnetcdf_get_vara_type(mb_io_ptr->ncid, varid, memtype, index, count, value));
+    }
+    block->nrec = length[0];
+  }
+
+  mbr_mbnetcdf_block_copy(block, index, count, value, false);
+  return (NC_NOERR);
+}
+/*--------------------------------------------------------------------*/
+/* Write the records held in the cache for one variable */
+static int mbr_mbnetcdf_block_write(int verbose, struct mb_io_struct *mb_io_ptr, int varid,
+                                    struct mbr_mbnetcdf_block *block) {
+  int nc_status = NC_NOERR;
+  if (block->nrec > 0) {
+    size_t start[NC_MAX_VAR_DIMS];
+    size_t length[NC_MAX_VAR_DIMS];
+    start[0] = block->start;
+    length[0] = block->nrec;
+    for (int i = 1; i < block->ndims; i++) {
+      start[i] = 0;
+      length[i] = block->dimlen[i];
+    }
+    nc_status = mbr_mbnetcdf_put_vara_type(mb_io_ptr->ncid, varid, block->memtype, start, length, block->buf);
+    if (verbose >= 2 && nc_status != NC_NOERR)
+      fprintf(stderr, "nc_put_vara block of %zu records at %zu error: %s\n", length[0], start[0], nc_strerror(nc_status));
+  }
+  block->start += block->nrec;
+  block->nrec = 0;
+  return (nc_status);
+}
+/*--------------------------------------------------------------------*/
+/* Write a hyperslab of one record of a per-ping variable into the cache,
+ * writing the cached block out when the record falls beyond it. Parts of
+ * records never written hold the netCDF default fill value. */
+static int mbr_mbnetcdf_block_put(int verbose, struct mb_io_struct *mb_io_ptr, nc_type memtype, int varid,
+                                  const size_t *index, const size_t *count, const void *value) {
+  struct mbr_mbnetcdf_block *block = mbr_mbnetcdf_block_var(verbose, mb_io_ptr, true, varid, memtype);
+  if (block == NULL || count[0] != 1)
+    return (mbr_mbnetcdf_put_vara_type(mb_io_ptr->ncid, varid, memtype, index, count, value));
+  for (int i = 1; i < block->ndims; i++)
+    if (index[i] + count[i] > block->dimlen[i])
+      return (mbr_mbnetcdf_put_vara_type(mb_io_ptr->ncid, varid, memtype, index, count, value));
+
+  int nc_status = NC_NOERR;
+  if (block->nrec > 0 && (index[0] < block->start || index[0] >= block->start + block->nrec_max))
+    nc_status = mbr_mbnetcdf_block_write(verbose, mb_io_ptr, varid, block);
+  if (block->nrec == 0)
+    block->start = index[0];
+  while (block->start + block->nrec <= index[0]) {
+    char *rec = (char *)block->buf + block->nrec * block->recsize * block->typesize;
+    if (memtype == NC_SHORT) {
+      for (size_t i = 0; i < block->recsize; i++)
+        ((short *)rec)[i] = NC_FILL_SHORT;
+    }
+    else if (memtype == NC_INT) {
+      for (size_t i = 0; i < block->recsize; i++)
+        ((int *)rec)[i] = NC_FILL_INT;
+    }
+    else {
+      memset(rec, NC_FILL_CHAR, block->recsize);
+    }
+    block->nrec++;
+  }
+
+  mbr_mbnetcdf_block_copy(block, index, count, (void *)value, true);
+  return (nc_status);
+}
+/*--------------------------------------------------------------------*/
+/* Write out any records held for writing and release the cache */
+static int mbr_mbnetcdf_block_free(int verbose, struct mb_io_struct *mb_io_ptr, int *error) {
+  int status = MB_SUCCESS;
+  struct mbr_mbnetcdf_blocks *blocks = (struct mbr_mbnetcdf_blocks *)mb_io_ptr->saveptr1;
+  if (blocks == NULL)
+    return (status);
+
+  for (int varid = 0; varid < blocks->nvars; varid++) {
+    struct mbr_mbnetcdf_block *block = &blocks->var[varid];
+    if (block->record) {
+      if (blocks->write && mbr_mbnetcdf_block_write(verbose, mb_io_ptr, varid, block) != NC_NOERR) {
+        status = MB_FAILURE;
+        *error = MB_ERROR_WRITE_FAIL;
+      }
+      mb_freed(verbose, __FILE__, __LINE__, (void **)&block->buf, error);
+    }
+  }
+  int error2 = MB_ERROR_NO_ERROR;
+  mb_freed(verbose, __FILE__, __LINE__, (void **)&blocks->var, &error2);
+  mb_freed(verbose, __FILE__, __LINE__, (void **)&mb_io_ptr->saveptr1, &error2);
+
+  return (status);
+}
+/*--------------------------------------------------------------------*/
+/* Chunk the per-ping variables of a NetCDF-4 file in blocks of records,
+ * compressing them at the netcdfdeflate level set by mbdefaults. Called
+ * in define mode. */
+static void mbr_mbnetcdf_block_chunking(int verbose, struct mb_io_struct *mb_io_ptr) {
+  int format = 0;
+  int unlimdimid = -1;
+  int nvars = 0;
+  if (nc_inq_format(mb_io_ptr->ncid, &format) != NC_NOERR
+      || (format != NC_FORMAT_NETCDF4 && format != NC_FORMAT_NETCDF4_CLASSIC)
+      || nc_inq_unlimdim(mb_io_ptr->ncid, &unlimdimid) != NC_NOERR
+      || nc_inq_nvars(mb_io_ptr->ncid, &nvars) != NC_NOERR)
+    return;
+
+  int deflate = 0;
+  mb_netcdfdeflate(verbose, &deflate);
+
+  for (int varid = 0; varid < nvars; varid++) {
+    int ndims = 0;
+    int dimids[NC_MAX_VAR_DIMS];
+    size_t chunks[NC_MAX_VAR_DIMS];
+    if (nc_inq_varndims(mb_io_ptr->ncid, varid, &ndims) != NC_NOERR || ndims < 1
+        || nc_inq_vardimid(mb_io_ptr->ncid, varid, dimids) != NC_NOERR || dimids[0] != unlimdimid)
+      continue;
+    size_t pings = 1;
+    for (int i = 1; i < ndims; i++) {
+      nc_inq_dimlen(mb_io_ptr->ncid, dimids[i], &chunks[i]);
+      chunks[i] = MAX(chunks[i], 1);
+    }
+    if (ndims > 2)
+      pings = chunks[1];
+    chunks[0] = MAX(MBSYS_NETCDF_BLOCK_PINGS / pings, 1);
+    int nc_status = nc_def_var_chunking(mb_io_ptr->ncid, varid, NC_CHUNKED, chunks);
+    if (nc_status == NC_NOERR && deflate > 0)
+      nc_status = nc_def_var_deflate(mb_io_ptr->ncid, varid, 1, 1, deflate);
+    if (verbose >= 2 && nc_status != NC_NOERR)
+      fprintf(stderr, "nc_def_var_chunking %d error: %s\n", varid, nc_strerror(nc_status));
+  }
+}
 /*--------------------------------------------------------------------*/
 int mbr_info_mbnetcdf(int verbose, int *system, int *beams_bath_max, int *beams_amp_max, int *pixels_ss_max, char *format_name,
                       char *system_name, char *format_description, int *numfile, int *filetype, int *variable_beams,
@@ -218,6 +532,7 @@ int mbr_alm_mbnetcdf(int verbose, void *mbio_ptr, int *error) {
   *recread = 0;
   *lastrawtime = 0.0;
   *nrawtimerepeat = 0;
+  mb_io_ptr->saveptr1 = NULL;
 
   if (verbose >= 2) {
     fprintf(stderr, "\ndbg2  MBIO function <%s> completed\n", __func__);
@@ -241,8 +556,12 @@ int mbr_dem_mbnetcdf(int verbose, void *mbio_ptr, int *error) {
   /* get pointer to mbio descriptor */
   struct mb_io_struct *mb_io_ptr = (struct mb_io_struct *)mbio_ptr;
 
+  /* write out any staged records and release the staging cache */
+  int status = mbr_mbnetcdf_block_free(verbose, mb_io_ptr, error);
+
   /* deallocate memory for data descriptor */
-  const int status = mbsys_netcdf_deall(verbose, mbio_ptr, &mb_io_ptr->store_data, error);
+  int error2 = MB_ERROR_NO_ERROR;
+  status &= mbsys_netcdf_deall(verbose, mbio_ptr, &mb_io_ptr->store_data, &error2);
 
   if (verbose >= 2) {
     fprintf(stderr, "\ndbg2  MBIO function <%s> completed\n", __func__);
@@ -6360,258 +6679,258 @@ int mbr_rt_mbnetcdf(int verbose, void *mbio_ptr, void *store_ptr, int *error) {
 
     /* read the per-ping variables from next record */
     if (store->mbCycle_id >= 0) {
-      nc_status = nc_get_vara_int(mb_io_ptr->ncid, store->mbCycle_id, index, count, store->mbCycle);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_INT, store->mbCycle_id, index, count, store->mbCycle);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbCycle error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbDate_id >= 0) {
-      nc_status = nc_get_vara_int(mb_io_ptr->ncid, store->mbDate_id, index, count, store->mbDate);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_INT, store->mbDate_id, index, count, store->mbDate);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbDate error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbTime_id >= 0) {
-      nc_status = nc_get_vara_int(mb_io_ptr->ncid, store->mbTime_id, index, count, store->mbTime);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_INT, store->mbTime_id, index, count, store->mbTime);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbTime error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbOrdinate_id >= 0) {
-      nc_status = nc_get_vara_int(mb_io_ptr->ncid, store->mbOrdinate_id, index, count, store->mbOrdinate);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_INT, store->mbOrdinate_id, index, count, store->mbOrdinate);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbOrdinate error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbAbscissa_id >= 0) {
-      nc_status = nc_get_vara_int(mb_io_ptr->ncid, store->mbAbscissa_id, index, count, store->mbAbscissa);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_INT, store->mbAbscissa_id, index, count, store->mbAbscissa);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbAbscissa error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbFrequency_id >= 0) {
-      nc_status = nc_get_vara_text(mb_io_ptr->ncid, store->mbFrequency_id, index, count, store->mbFrequency);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_CHAR, store->mbFrequency_id, index, count, store->mbFrequency);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbFrequency error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbSonarFrequency_id >= 0) {
-      nc_status = nc_get_vara_int(mb_io_ptr->ncid, store->mbSonarFrequency_id, index, count, store->mbSonarFrequency);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_INT, store->mbSonarFrequency_id, index, count, store->mbSonarFrequency);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbSonarFrequency error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbSounderMode_id >= 0) {
-      nc_status = nc_get_vara_text(mb_io_ptr->ncid, store->mbSounderMode_id, index, count, store->mbSounderMode);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_CHAR, store->mbSounderMode_id, index, count, store->mbSounderMode);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbSounderMode error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbReferenceDepth_id >= 0) {
-      nc_status = nc_get_vara_int(mb_io_ptr->ncid, store->mbReferenceDepth_id, index, count, store->mbReferenceDepth);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_INT, store->mbReferenceDepth_id, index, count, store->mbReferenceDepth);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbReferenceDepth error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbDynamicDraught_id >= 0) {
-      nc_status = nc_get_vara_short(mb_io_ptr->ncid, store->mbDynamicDraught_id, index, count, store->mbDynamicDraught);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_SHORT, store->mbDynamicDraught_id, index, count, store->mbDynamicDraught);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbDynamicDraught error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbTide_id >= 0) {
-      nc_status = nc_get_vara_short(mb_io_ptr->ncid, store->mbTide_id, index, count, store->mbTide);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_SHORT, store->mbTide_id, index, count, store->mbTide);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbTide error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbSoundVelocity_id >= 0) {
-      nc_status = nc_get_vara_short(mb_io_ptr->ncid, store->mbSoundVelocity_id, index, count, store->mbSoundVelocity);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_SHORT, store->mbSoundVelocity_id, index, count, store->mbSoundVelocity);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbSoundVelocity error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbHeading_id >= 0) {
-      nc_status = nc_get_vara_short(mb_io_ptr->ncid, store->mbHeading_id, index, count, (short *)store->mbHeading);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_SHORT, store->mbHeading_id, index, count, (short *)store->mbHeading);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbHeading error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbRoll_id >= 0) {
-      nc_status = nc_get_vara_short(mb_io_ptr->ncid, store->mbRoll_id, index, count, store->mbRoll);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_SHORT, store->mbRoll_id, index, count, store->mbRoll);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbRoll error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbPitch_id >= 0) {
-      nc_status = nc_get_vara_short(mb_io_ptr->ncid, store->mbPitch_id, index, count, store->mbPitch);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_SHORT, store->mbPitch_id, index, count, store->mbPitch);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbPitch error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbTransmissionHeave_id >= 0) {
       nc_status =
-          nc_get_vara_short(mb_io_ptr->ncid, store->mbTransmissionHeave_id, index, count, store->mbTransmissionHeave);
+          mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_SHORT, store->mbTransmissionHeave_id, index, count, store->mbTransmissionHeave);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbTransmissionHeave error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbDistanceScale_id >= 0) {
-      nc_status = nc_get_vara_text(mb_io_ptr->ncid, store->mbDistanceScale_id, index, count, store->mbDistanceScale);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_CHAR, store->mbDistanceScale_id, index, count, store->mbDistanceScale);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbDistanceScale error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbRangeScale_id >= 0) {
-      nc_status = nc_get_vara_short(mb_io_ptr->ncid, store->mbRangeScale_id, index, count, store->mbRangeScale);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_SHORT, store->mbRangeScale_id, index, count, store->mbRangeScale);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbRangeScale error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbDepthScale_id >= 0) {
-      nc_status = nc_get_vara_text(mb_io_ptr->ncid, store->mbDepthScale_id, index, count, store->mbDepthScale);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_CHAR, store->mbDepthScale_id, index, count, store->mbDepthScale);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbDepthScale error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbVerticalDepth_id >= 0) {
-      nc_status = nc_get_vara_int(mb_io_ptr->ncid, store->mbVerticalDepth_id, index, count, store->mbVerticalDepth);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_INT, store->mbVerticalDepth_id, index, count, store->mbVerticalDepth);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbVerticalDepth error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbCQuality_id >= 0) {
-      nc_status = nc_get_vara_text(mb_io_ptr->ncid, store->mbCQuality_id, index, count, store->mbCQuality);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_CHAR, store->mbCQuality_id, index, count, store->mbCQuality);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbCQuality error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbCFlag_id >= 0) {
-      nc_status = nc_get_vara_text(mb_io_ptr->ncid, store->mbCFlag_id, index, count, store->mbCFlag);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_CHAR, store->mbCFlag_id, index, count, store->mbCFlag);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbCFlag error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbInterlacing_id >= 0) {
-      nc_status = nc_get_vara_text(mb_io_ptr->ncid, store->mbInterlacing_id, index, count, store->mbInterlacing);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_CHAR, store->mbInterlacing_id, index, count, store->mbInterlacing);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbInterlacing error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbSamplingRate_id >= 0) {
-      nc_status = nc_get_vara_short(mb_io_ptr->ncid, store->mbSamplingRate_id, index, count, store->mbSamplingRate);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_SHORT, store->mbSamplingRate_id, index, count, store->mbSamplingRate);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbSamplingRate error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbCompensationLayerMode_id >= 0) {
-      nc_status = nc_get_vara_text(mb_io_ptr->ncid, store->mbCompensationLayerMode_id, index, count,
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_CHAR, store->mbCompensationLayerMode_id, index, count,
                                    store->mbCompensationLayerMode);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbCompensationLayerMode error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbTransmitBeamwidth_id >= 0) {
       nc_status =
-          nc_get_vara_short(mb_io_ptr->ncid, store->mbTransmitBeamwidth_id, index, count, store->mbTransmitBeamwidth);
+          mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_SHORT, store->mbTransmitBeamwidth_id, index, count, store->mbTransmitBeamwidth);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbTransmitBeamwidth error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbReceiveBeamwidth_id >= 0) {
-      nc_status = nc_get_vara_text(mb_io_ptr->ncid, store->mbReceiveBeamwidth_id, index, count, store->mbReceiveBeamwidth);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_CHAR, store->mbReceiveBeamwidth_id, index, count, store->mbReceiveBeamwidth);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbReceiveBeamwidth error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbTransmitPulseLength_id >= 0) {
       nc_status =
-          nc_get_vara_short(mb_io_ptr->ncid, store->mbTransmitPulseLength_id, index, count, store->mbTransmitPulseLength);
+          mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_SHORT, store->mbTransmitPulseLength_id, index, count, store->mbTransmitPulseLength);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbTransmitPulseLength error: %s\n", nc_strerror(nc_status));
     }
 
     if (store->mbOperatorStationStatus_id >= 0) {
-      nc_status = nc_get_vara_text(mb_io_ptr->ncid, store->mbOperatorStationStatus_id, index, count, store->mbOperatorStationStatus);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_CHAR, store->mbOperatorStationStatus_id, index, count, store->mbOperatorStationStatus);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbOperatorStationStatus error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbProcessingUnitStatus_id >= 0) {
-      nc_status = nc_get_vara_text(mb_io_ptr->ncid, store->mbProcessingUnitStatus_id, index, count, store->mbProcessingUnitStatus);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_CHAR, store->mbProcessingUnitStatus_id, index, count, store->mbProcessingUnitStatus);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbProcessingUnitStatus error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbBSPStatus_id >= 0) {
-      nc_status = nc_get_vara_text(mb_io_ptr->ncid, store->mbBSPStatus_id, index, count, store->mbBSPStatus);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_CHAR, store->mbBSPStatus_id, index, count, store->mbBSPStatus);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbBSPStatus error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbSonarStatus_id >= 0) {
-      nc_status = nc_get_vara_text(mb_io_ptr->ncid, store->mbSonarStatus_id, index, count, store->mbSonarStatus);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_CHAR, store->mbSonarStatus_id, index, count, store->mbSonarStatus);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbSonarStatus error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbFilterIdentifier_id >= 0) {
-      nc_status = nc_get_vara_text(mb_io_ptr->ncid, store->mbFilterIdentifier_id, index, count, store->mbFilterIdentifier);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_CHAR, store->mbFilterIdentifier_id, index, count, store->mbFilterIdentifier);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbFilterIdentifier error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbParamMinimumDepth_id >= 0) {
       nc_status =
-          nc_get_vara_short(mb_io_ptr->ncid, store->mbParamMinimumDepth_id, index, count, store->mbParamMinimumDepth);
+          mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_SHORT, store->mbParamMinimumDepth_id, index, count, store->mbParamMinimumDepth);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbParamMinimumDepth error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbParamMaximumDepth_id >= 0) {
       nc_status =
-          nc_get_vara_short(mb_io_ptr->ncid, store->mbParamMaximumDepth_id, index, count, store->mbParamMaximumDepth);
+          mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_SHORT, store->mbParamMaximumDepth_id, index, count, store->mbParamMaximumDepth);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbParamMaximumDepth error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbAbsorptionCoefficient_id >= 0) {
       nc_status =
-          nc_get_vara_short(mb_io_ptr->ncid, store->mbAbsorptionCoefficient_id, index, count, store->mbAbsorptionCoefficient);
+          mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_SHORT, store->mbAbsorptionCoefficient_id, index, count, store->mbAbsorptionCoefficient);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbAbsorptionCoefficient error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbTransmitPowerReMax_id >= 0) {
-      nc_status = nc_get_vara_text(mb_io_ptr->ncid, store->mbTransmitPowerReMax_id, index, count, store->mbTransmitPowerReMax);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_CHAR, store->mbTransmitPowerReMax_id, index, count, store->mbTransmitPowerReMax);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbTransmitPowerReMax error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbReceiveBandwidth_id >= 0) {
-      nc_status = nc_get_vara_text(mb_io_ptr->ncid, store->mbReceiveBandwidth_id, index, count, store->mbReceiveBandwidth);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_CHAR, store->mbReceiveBandwidth_id, index, count, store->mbReceiveBandwidth);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbReceiveBandwidth error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbReceiverFixedGain_id >= 0) {
-      nc_status = nc_get_vara_text(mb_io_ptr->ncid, store->mbReceiverFixedGain_id, index, count, store->mbReceiverFixedGain);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_CHAR, store->mbReceiverFixedGain_id, index, count, store->mbReceiverFixedGain);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbReceiverFixedGain error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbTVGLawCrossoverAngle_id >= 0) {
-      nc_status = nc_get_vara_text(mb_io_ptr->ncid, store->mbTVGLawCrossoverAngle_id, index, count, store->mbTVGLawCrossoverAngle);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_CHAR, store->mbTVGLawCrossoverAngle_id, index, count, store->mbTVGLawCrossoverAngle);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbTVGLawCrossoverAngle error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbTransVelocitySource_id >= 0) {
-      nc_status = nc_get_vara_text(mb_io_ptr->ncid, store->mbTransVelocitySource_id, index, count, store->mbTransVelocitySource);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_CHAR, store->mbTransVelocitySource_id, index, count, store->mbTransVelocitySource);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbTransVelocitySource error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbMaxPortWidth_id >= 0) {
       nc_status =
-          nc_get_vara_short(mb_io_ptr->ncid, store->mbMaxPortWidth_id, index, count, store->mbMaxPortWidth);
+          mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_SHORT, store->mbMaxPortWidth_id, index, count, store->mbMaxPortWidth);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbMaxPortWidth error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbBeamSpacing_id >= 0) {
-      nc_status = nc_get_vara_text(mb_io_ptr->ncid, store->mbBeamSpacing_id, index, count, store->mbBeamSpacing);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_CHAR, store->mbBeamSpacing_id, index, count, store->mbBeamSpacing);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbBeamSpacing error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbMaxPortCoverage_id >= 0) {
-      nc_status = nc_get_vara_text(mb_io_ptr->ncid, store->mbMaxPortCoverage_id, index, count, store->mbMaxPortCoverage);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_CHAR, store->mbMaxPortCoverage_id, index, count, store->mbMaxPortCoverage);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbMaxPortCoverage error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbYawPitchStabMode_id >= 0) {
-      nc_status = nc_get_vara_text(mb_io_ptr->ncid, store->mbYawPitchStabMode_id, index, count, store->mbYawPitchStabMode);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_CHAR, store->mbYawPitchStabMode_id, index, count, store->mbYawPitchStabMode);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbYawPitchStabMode error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbMaxStarboardCoverage_id >= 0) {
-      nc_status = nc_get_vara_text(mb_io_ptr->ncid, store->mbMaxStarboardCoverage_id, index, count, store->mbMaxStarboardCoverage);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_CHAR, store->mbMaxStarboardCoverage_id, index, count, store->mbMaxStarboardCoverage);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbMaxStarboardCoverage error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbMaxStarboardWidth_id >= 0) {
       nc_status =
-          nc_get_vara_short(mb_io_ptr->ncid, store->mbMaxStarboardWidth_id, index, count, store->mbMaxStarboardWidth);
+          mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_SHORT, store->mbMaxStarboardWidth_id, index, count, store->mbMaxStarboardWidth);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbMaxStarboardWidth error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbDurotongSpeed_id >= 0) {
       nc_status =
-          nc_get_vara_short(mb_io_ptr->ncid, store->mbDurotongSpeed_id, index, count, store->mbDurotongSpeed);
+          mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_SHORT, store->mbDurotongSpeed_id, index, count, store->mbDurotongSpeed);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbDurotongSpeed error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbHiLoAbsorptionRatio_id >= 0) {
-      nc_status = nc_get_vara_text(mb_io_ptr->ncid, store->mbHiLoAbsorptionRatio_id, index, count, store->mbHiLoAbsorptionRatio);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_CHAR, store->mbHiLoAbsorptionRatio_id, index, count, store->mbHiLoAbsorptionRatio);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbHiLoAbsorptionRatio error: %s\n", nc_strerror(nc_status));
     }
@@ -6636,73 +6955,73 @@ int mbr_rt_mbnetcdf(int verbose, void *mbio_ptr, void *store_ptr, int *error) {
 
     /* read the per-beam variables from next record */
     if (store->mbAlongDistance_id >= 0) {
-      nc_status = nc_get_vara_short(mb_io_ptr->ncid, store->mbAlongDistance_id, index, count, store->mbAlongDistance);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_SHORT, store->mbAlongDistance_id, index, count, store->mbAlongDistance);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbAlongDistance error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbAcrossDistance_id >= 0) {
-      nc_status = nc_get_vara_short(mb_io_ptr->ncid, store->mbAcrossDistance_id, index, count, store->mbAcrossDistance);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_SHORT, store->mbAcrossDistance_id, index, count, store->mbAcrossDistance);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbAcrossDistance error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbDepth_id >= 0) {
-      nc_status = nc_get_vara_int(mb_io_ptr->ncid, store->mbDepth_id, index, count, store->mbDepth);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_INT, store->mbDepth_id, index, count, store->mbDepth);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbDepth error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbAcrossBeamAngle_id >= 0) {
-      nc_status = nc_get_vara_short(mb_io_ptr->ncid, store->mbAcrossBeamAngle_id, index, count, store->mbAcrossBeamAngle);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_SHORT, store->mbAcrossBeamAngle_id, index, count, store->mbAcrossBeamAngle);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbAcrossBeamAngle error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbAzimutBeamAngle_id >= 0) {
-      nc_status = nc_get_vara_short(mb_io_ptr->ncid, store->mbAzimutBeamAngle_id, index, count, store->mbAzimutBeamAngle);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_SHORT, store->mbAzimutBeamAngle_id, index, count, store->mbAzimutBeamAngle);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbAzimutBeamAngle error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbRange_id >= 0) {
-      nc_status = nc_get_vara_short(mb_io_ptr->ncid, store->mbRange_id, index, count, store->mbRange);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_SHORT, store->mbRange_id, index, count, store->mbRange);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbRange error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbSoundingBias_id >= 0) {
-      nc_status = nc_get_vara_short(mb_io_ptr->ncid, store->mbSoundingBias_id, index, count, store->mbSoundingBias);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_SHORT, store->mbSoundingBias_id, index, count, store->mbSoundingBias);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbSoundingBias error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbSQuality_id >= 0) {
-      nc_status = nc_get_vara_text(mb_io_ptr->ncid, store->mbSQuality_id, index, count, store->mbSQuality);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_CHAR, store->mbSQuality_id, index, count, store->mbSQuality);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbSQuality error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbReflectivity_id >= 0) {
-      nc_status = nc_get_vara_text(mb_io_ptr->ncid, store->mbReflectivity_id, index, count, store->mbReflectivity);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_CHAR, store->mbReflectivity_id, index, count, store->mbReflectivity);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbReflectivity error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbReceptionHeave_id >= 0) {
-      nc_status = nc_get_vara_text(mb_io_ptr->ncid, store->mbReceptionHeave_id, index, count, store->mbReceptionHeave);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_CHAR, store->mbReceptionHeave_id, index, count, store->mbReceptionHeave);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbReceptionHeave error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbAlongSlope_id >= 0) {
-      nc_status = nc_get_vara_short(mb_io_ptr->ncid, store->mbAlongSlope_id, index, count, store->mbAlongSlope);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_SHORT, store->mbAlongSlope_id, index, count, store->mbAlongSlope);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbAlongSlope error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbAcrossSlope_id >= 0) {
-      nc_status = nc_get_vara_short(mb_io_ptr->ncid, store->mbAcrossSlope_id, index, count, store->mbAcrossSlope);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_SHORT, store->mbAcrossSlope_id, index, count, store->mbAcrossSlope);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbAcrossSlope error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbSFlag_id >= 0) {
-      nc_status = nc_get_vara_text(mb_io_ptr->ncid, store->mbSFlag_id, index, count, store->mbSFlag);
+      nc_status = mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_CHAR, store->mbSFlag_id, index, count, store->mbSFlag);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbSFlag error: %s\n", nc_strerror(nc_status));
     }
     if (store->mbSLengthOfDetection_id >= 0) {
       nc_status =
-          nc_get_vara_text(mb_io_ptr->ncid, store->mbSLengthOfDetection_id, index, count, store->mbSLengthOfDetection);
+          mbr_mbnetcdf_block_get(verbose, mb_io_ptr, NC_CHAR, store->mbSLengthOfDetection_id, index, count, store->mbSLengthOfDetection);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_get_vara mbSLengthOfDetection error: %s\n", nc_strerror(nc_status));
     }
@@ -12150,6 +12469,9 @@ int mbr_wt_mbnetcdf(int verbose, void *mbio_ptr, void *store_ptr, int *error) {
           fprintf(stderr, "nc_put_att mbVelProfilTime_orientation error: %s\n", nc_strerror(nc_status));
       }
 
+    /* chunk the per ping variables if writing NetCDF-4 */
+    mbr_mbnetcdf_block_chunking(verbose, mb_io_ptr);
+
     /* end define mode */
     nc_status = nc_enddef(mb_io_ptr->ncid);
     if (verbose >= 2 && nc_status != NC_NOERR) {
@@ -12319,142 +12641,142 @@ int mbr_wt_mbnetcdf(int verbose, void *mbio_ptr, void *store_ptr, int *error) {
       count[2] = 0;
     }
     if (storelocal->mbCycle_id >= 0) {
-      nc_status = nc_put_vara_int(mb_io_ptr->ncid, storelocal->mbCycle_id, index, count, store->mbCycle);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_INT, storelocal->mbCycle_id, index, count, store->mbCycle);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbCycle error: %s\n", nc_strerror(nc_status));
     }
     if (storelocal->mbDate_id >= 0) {
-      nc_status = nc_put_vara_int(mb_io_ptr->ncid, storelocal->mbDate_id, index, count, store->mbDate);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_INT, storelocal->mbDate_id, index, count, store->mbDate);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbDate error: %s\n", nc_strerror(nc_status));
     }
     if (storelocal->mbTime_id >= 0) {
-      nc_status = nc_put_vara_int(mb_io_ptr->ncid, storelocal->mbTime_id, index, count, store->mbTime);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_INT, storelocal->mbTime_id, index, count, store->mbTime);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbTime error: %s\n", nc_strerror(nc_status));
     }
     if (storelocal->mbOrdinate_id >= 0) {
-      nc_status = nc_put_vara_int(mb_io_ptr->ncid, storelocal->mbOrdinate_id, index, count, store->mbOrdinate);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_INT, storelocal->mbOrdinate_id, index, count, store->mbOrdinate);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbOrdinate error: %s\n", nc_strerror(nc_status));
     }
     if (storelocal->mbAbscissa_id >= 0) {
-      nc_status = nc_put_vara_int(mb_io_ptr->ncid, storelocal->mbAbscissa_id, index, count, store->mbAbscissa);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_INT, storelocal->mbAbscissa_id, index, count, store->mbAbscissa);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbAbscissa error: %s\n", nc_strerror(nc_status));
     }
     if (storelocal->mbFrequency_id >= 0) {
-      nc_status = nc_put_vara_text(mb_io_ptr->ncid, storelocal->mbFrequency_id, index, count, store->mbFrequency);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_CHAR, storelocal->mbFrequency_id, index, count, store->mbFrequency);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbFrequency error: %s\n", nc_strerror(nc_status));
     }
     if (storelocal->mbSonarFrequency_id >= 0) {
-      nc_status = nc_put_vara_int(mb_io_ptr->ncid, storelocal->mbSonarFrequency_id, index, count, store->mbSonarFrequency);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_INT, storelocal->mbSonarFrequency_id, index, count, store->mbSonarFrequency);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbSonarFrequency error: %s\n", nc_strerror(nc_status));
     }
     if (storelocal->mbSounderMode_id >= 0) {
-      nc_status = nc_put_vara_text(mb_io_ptr->ncid, storelocal->mbSounderMode_id, index, count, store->mbSounderMode);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_CHAR, storelocal->mbSounderMode_id, index, count, store->mbSounderMode);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbSounderMode error: %s\n", nc_strerror(nc_status));
     }
     if (storelocal->mbReferenceDepth_id >= 0) {
-      nc_status = nc_put_vara_int(mb_io_ptr->ncid, storelocal->mbReferenceDepth_id, index, count, store->mbReferenceDepth);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_INT, storelocal->mbReferenceDepth_id, index, count, store->mbReferenceDepth);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbReferenceDepth error: %s\n", nc_strerror(nc_status));
     }
     if (storelocal->mbDynamicDraught_id >= 0) {
-      nc_status = nc_put_vara_short(mb_io_ptr->ncid, storelocal->mbDynamicDraught_id, index, count, store->mbDynamicDraught);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_SHORT, storelocal->mbDynamicDraught_id, index, count, store->mbDynamicDraught);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbDynamicDraught error: %s\n", nc_strerror(nc_status));
     }
     if (storelocal->mbTide_id >= 0) {
-      nc_status = nc_put_vara_short(mb_io_ptr->ncid, storelocal->mbTide_id, index, count, store->mbTide);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_SHORT, storelocal->mbTide_id, index, count, store->mbTide);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbTide error: %s\n", nc_strerror(nc_status));
     }
     if (storelocal->mbSoundVelocity_id >= 0) {
-      nc_status = nc_put_vara_short(mb_io_ptr->ncid, storelocal->mbSoundVelocity_id, index, count, store->mbSoundVelocity);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_SHORT, storelocal->mbSoundVelocity_id, index, count, store->mbSoundVelocity);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbSoundVelocity error: %s\n", nc_strerror(nc_status));
     }
     if (storelocal->mbHeading_id >= 0) {
-      nc_status = nc_put_vara_short(mb_io_ptr->ncid, storelocal->mbHeading_id, index, count, (short *)store->mbHeading);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_SHORT, storelocal->mbHeading_id, index, count, (short *)store->mbHeading);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbHeading error: %s\n", nc_strerror(nc_status));
     }
     if (storelocal->mbRoll_id >= 0) {
-      nc_status = nc_put_vara_short(mb_io_ptr->ncid, storelocal->mbRoll_id, index, count, store->mbRoll);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_SHORT, storelocal->mbRoll_id, index, count, store->mbRoll);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbRoll error: %s\n", nc_strerror(nc_status));
     }
     if (storelocal->mbPitch_id >= 0) {
-      nc_status = nc_put_vara_short(mb_io_ptr->ncid, storelocal->mbPitch_id, index, count, store->mbPitch);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_SHORT, storelocal->mbPitch_id, index, count, store->mbPitch);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbPitch error: %s\n", nc_strerror(nc_status));
     }
     if (storelocal->mbTransmissionHeave_id >= 0) {
-      nc_status = nc_put_vara_short(mb_io_ptr->ncid, storelocal->mbTransmissionHeave_id, index, count, store->mbTransmissionHeave);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_SHORT, storelocal->mbTransmissionHeave_id, index, count, store->mbTransmissionHeave);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbTransmissionHeave error: %s\n", nc_strerror(nc_status));
     }
     if (storelocal->mbDistanceScale_id >= 0) {
-      nc_status = nc_put_vara_text(mb_io_ptr->ncid, storelocal->mbDistanceScale_id, index, count, store->mbDistanceScale);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_CHAR, storelocal->mbDistanceScale_id, index, count, store->mbDistanceScale);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbDistanceScale error: %s\n", nc_strerror(nc_status));
     }
     if (storelocal->mbRangeScale_id >= 0) {
-      nc_status = nc_put_vara_short(mb_io_ptr->ncid, storelocal->mbRangeScale_id, index, count, store->mbRangeScale);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_SHORT, storelocal->mbRangeScale_id, index, count, store->mbRangeScale);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbRangeScale error: %s\n", nc_strerror(nc_status));
     }
     if (storelocal->mbDepthScale_id >= 0) {
-      nc_status = nc_put_vara_text(mb_io_ptr->ncid, storelocal->mbDepthScale_id, index, count, store->mbDepthScale);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_CHAR, storelocal->mbDepthScale_id, index, count, store->mbDepthScale);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbDepthScale error: %s\n", nc_strerror(nc_status));
     }
     if (storelocal->mbVerticalDepth_id >= 0) {
-      nc_status = nc_put_vara_int(mb_io_ptr->ncid, storelocal->mbVerticalDepth_id, index, count, store->mbVerticalDepth);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_INT, storelocal->mbVerticalDepth_id, index, count, store->mbVerticalDepth);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbVerticalDepth error: %s\n", nc_strerror(nc_status));
     }
     if (storelocal->mbCQuality_id >= 0) {
-      nc_status = nc_put_vara_text(mb_io_ptr->ncid, storelocal->mbCQuality_id, index, count, store->mbCQuality);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_CHAR, storelocal->mbCQuality_id, index, count, store->mbCQuality);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbCQuality error: %s\n", nc_strerror(nc_status));
     }
     if (storelocal->mbCFlag_id >= 0) {
-      nc_status = nc_put_vara_text(mb_io_ptr->ncid, storelocal->mbCFlag_id, index, count, store->mbCFlag);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_CHAR, storelocal->mbCFlag_id, index, count, store->mbCFlag);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbCFlag error: %s\n", nc_strerror(nc_status));
     }
     if (storelocal->mbInterlacing_id >= 0) {
-      nc_status = nc_put_vara_text(mb_io_ptr->ncid, storelocal->mbInterlacing_id, index, count, store->mbInterlacing);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_CHAR, storelocal->mbInterlacing_id, index, count, store->mbInterlacing);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbInterlacing error: %s\n", nc_strerror(nc_status));
     }
     if (storelocal->mbSamplingRate_id >= 0) {
-      nc_status = nc_put_vara_short(mb_io_ptr->ncid, storelocal->mbSamplingRate_id, index, count, store->mbSamplingRate);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_SHORT, storelocal->mbSamplingRate_id, index, count, store->mbSamplingRate);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbSamplingRate error: %s\n", nc_strerror(nc_status));
     }
     if (storelocal->mbCompensationLayerMode_id >= 0) {
-      nc_status = nc_put_vara_text(mb_io_ptr->ncid, storelocal->mbCompensationLayerMode_id, index, count, store->mbCompensationLayerMode);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_CHAR, storelocal->mbCompensationLayerMode_id, index, count, store->mbCompensationLayerMode);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbCompensationLayerMode error: %s\n", nc_strerror(nc_status));
     }
     if (storelocal->mbTransmitBeamwidth_id >= 0) {
-      nc_status = nc_put_vara_short(mb_io_ptr->ncid, storelocal->mbTransmitBeamwidth_id, index, count, store->mbTransmitBeamwidth);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_SHORT, storelocal->mbTransmitBeamwidth_id, index, count, store->mbTransmitBeamwidth);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbTransmitBeamwidth error: %s\n", nc_strerror(nc_status));
     }
     if (storelocal->mbReceiveBeamwidth_id >= 0) {
-      nc_status = nc_put_vara_text(mb_io_ptr->ncid, storelocal->mbReceiveBeamwidth_id, index, count, store->mbReceiveBeamwidth);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_CHAR, storelocal->mbReceiveBeamwidth_id, index, count, store->mbReceiveBeamwidth);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbReceiveBeamwidth error: %s\n", nc_strerror(nc_status));
     }
     if (storelocal->mbTransmitPulseLength_id >= 0) {
-      nc_status = nc_put_vara_short(mb_io_ptr->ncid, storelocal->mbTransmitPulseLength_id, index, count, store->mbTransmitPulseLength);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_SHORT, storelocal->mbTransmitPulseLength_id, index, count, store->mbTransmitPulseLength);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbTransmitPulseLength error: %s\n", nc_strerror(nc_status));
     }
@@ -12474,57 +12796,57 @@ int mbr_wt_mbnetcdf(int verbose, void *mbio_ptr, void *store_ptr, int *error) {
       count[1] = storelocal->mbBeamNbr;
       count[2] = 0;
     }
-    nc_status = nc_put_vara_short(mb_io_ptr->ncid, storelocal->mbAlongDistance_id, index, count, store->mbAlongDistance);
+    nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_SHORT, storelocal->mbAlongDistance_id, index, count, store->mbAlongDistance);
     if (verbose >= 2 && nc_status != NC_NOERR)
       fprintf(stderr, "nc_put_vara mbAlongDistance error: %s\n", nc_strerror(nc_status));
-    nc_status = nc_put_vara_short(mb_io_ptr->ncid, storelocal->mbAcrossDistance_id, index, count, store->mbAcrossDistance);
+    nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_SHORT, storelocal->mbAcrossDistance_id, index, count, store->mbAcrossDistance);
     if (verbose >= 2 && nc_status != NC_NOERR)
       fprintf(stderr, "nc_put_vara mbAcrossDistance error: %s\n", nc_strerror(nc_status));
-    nc_status = nc_put_vara_int(mb_io_ptr->ncid, storelocal->mbDepth_id, index, count, store->mbDepth);
+    nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_INT, storelocal->mbDepth_id, index, count, store->mbDepth);
     if (verbose >= 2 && nc_status != NC_NOERR)
       fprintf(stderr, "nc_put_vara mbDepth error: %s\n", nc_strerror(nc_status));
     if (extended) {
       nc_status =
-          nc_put_vara_short(mb_io_ptr->ncid, storelocal->mbAcrossBeamAngle_id, index, count, store->mbAcrossBeamAngle);
+          mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_SHORT, storelocal->mbAcrossBeamAngle_id, index, count, store->mbAcrossBeamAngle);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbAcrossBeamAngle error: %s\n", nc_strerror(nc_status));
       nc_status =
-          nc_put_vara_short(mb_io_ptr->ncid, storelocal->mbAzimutBeamAngle_id, index, count, store->mbAzimutBeamAngle);
+          mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_SHORT, storelocal->mbAzimutBeamAngle_id, index, count, store->mbAzimutBeamAngle);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbAzimutBeamAngle error: %s\n", nc_strerror(nc_status));
-      nc_status = nc_put_vara_short(mb_io_ptr->ncid, storelocal->mbRange_id, index, count, store->mbRange);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_SHORT, storelocal->mbRange_id, index, count, store->mbRange);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbRange error: %s\n", nc_strerror(nc_status));
-      nc_status = nc_put_vara_short(mb_io_ptr->ncid, storelocal->mbSoundingBias_id, index, count, store->mbSoundingBias);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_SHORT, storelocal->mbSoundingBias_id, index, count, store->mbSoundingBias);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbSoundingBias error: %s\n", nc_strerror(nc_status));
     }
-    nc_status = nc_put_vara_int(mb_io_ptr->ncid, storelocal->mbQuality_id, index, count, store->mbQuality);
+    nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_INT, storelocal->mbQuality_id, index, count, store->mbQuality);
     if (verbose >= 2 && nc_status != NC_NOERR)
       fprintf(stderr, "nc_put_vara mbQuality error: %s\n", nc_strerror(nc_status));
-    nc_status = nc_put_vara_text(mb_io_ptr->ncid, storelocal->mbSQuality_id, index, count, store->mbSQuality);
+    nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_CHAR, storelocal->mbSQuality_id, index, count, store->mbSQuality);
     if (verbose >= 2 && nc_status != NC_NOERR)
       fprintf(stderr, "nc_put_vara mbSQuality error: %s\n", nc_strerror(nc_status));
     if (extended) {
-      nc_status = nc_put_vara_text(mb_io_ptr->ncid, storelocal->mbReflectivity_id, index, count, store->mbReflectivity);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_CHAR, storelocal->mbReflectivity_id, index, count, store->mbReflectivity);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbReflectivity error: %s\n", nc_strerror(nc_status));
-      nc_status = nc_put_vara_text(mb_io_ptr->ncid, storelocal->mbReceptionHeave_id, index, count, store->mbReceptionHeave);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_CHAR, storelocal->mbReceptionHeave_id, index, count, store->mbReceptionHeave);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbReceptionHeave error: %s\n", nc_strerror(nc_status));
-      nc_status = nc_put_vara_short(mb_io_ptr->ncid, storelocal->mbAlongSlope_id, index, count, store->mbAlongSlope);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_SHORT, storelocal->mbAlongSlope_id, index, count, store->mbAlongSlope);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbAlongSlope error: %s\n", nc_strerror(nc_status));
-      nc_status = nc_put_vara_short(mb_io_ptr->ncid, storelocal->mbAcrossSlope_id, index, count, store->mbAcrossSlope);
+      nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_SHORT, storelocal->mbAcrossSlope_id, index, count, store->mbAcrossSlope);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbAcrossSlope error: %s\n", nc_strerror(nc_status));
     }
-    nc_status = nc_put_vara_text(mb_io_ptr->ncid, storelocal->mbSFlag_id, index, count, store->mbSFlag);
+    nc_status = mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_CHAR, storelocal->mbSFlag_id, index, count, store->mbSFlag);
     if (verbose >= 2 && nc_status != NC_NOERR)
       fprintf(stderr, "nc_put_vara mbSQuality error: %s\n", nc_strerror(nc_status));
     if (extended) {
       nc_status =
-          nc_put_vara_text(mb_io_ptr->ncid, storelocal->mbSLengthOfDetection_id, index, count, store->mbSLengthOfDetection);
+          mbr_mbnetcdf_block_put(verbose, mb_io_ptr, NC_CHAR, storelocal->mbSLengthOfDetection_id, index, count, store->mbSLengthOfDetection);
       if (verbose >= 2 && nc_status != NC_NOERR)
         fprintf(stderr, "nc_put_vara mbSLengthOfDetection error: %s\n", nc_strerror(nc_status));
     }
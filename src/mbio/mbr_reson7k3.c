@@ -9720,6 +9720,9 @@ int mbr_reson7k3_rd_data(int verbose, void *mbio_ptr, void *store_ptr, int *erro
   bool done = false;
   *error = MB_ERROR_NO_ERROR;
   while (!done) {
+    /* records are parsed from the format buffer unless an input frame is leased */
+    buffer = (char *)*bufferptr;
+
     /* if previously read record stored use it first */
     if (*save_flag) {
       *save_flag = false;
@@ -9734,6 +9737,20 @@ int mbr_reson7k3_rd_data(int verbose, void *mbio_ptr, void *store_ptr, int *erro
      *     MBSYS_RESON7K_BUFFER_STARTSIZE = 65536 bytes (64 kB)
      *   at stream initialization
      *   which should be large enough for any single 7k record */
+    else if (mb_io_ptr->mbsp != NULL && mb_io_ptr->mb_io_input_lease != NULL) {
+      /* parse the record in place from the input frame */
+      char *frame = NULL;
+      read_len = (size_t)MBSYS_RESON7K_BUFFER_STARTSIZE;
+      status = mb_fileio_lease(verbose, mbio_ptr, &frame, &read_len, error);
+      if (status == MB_SUCCESS && frame != NULL)
+        buffer = frame;
+      else if (status == MB_SUCCESS) {
+        /* input recovered from a socket error without returning a frame */
+        status = MB_FAILURE;
+        *error = MB_ERROR_UNINTELLIGIBLE;
+      }
+      mbr_reson7k3_chk_header(verbose, mbio_ptr, buffer, recordid, deviceid, enumerator, size);
+    }
     else if (mb_io_ptr->mbsp != NULL) {
       read_len = (size_t)MBSYS_RESON7K_BUFFER_STARTSIZE;
       status = mb_fileio_get(verbose, mbio_ptr, buffer, &read_len, error);
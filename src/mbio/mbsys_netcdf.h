@@ -48,6 +48,7 @@
 #define MBSYS_NETCDF_ATTRIBUTELEN 64
 #define MBSYS_NETCDF_NAMELEN 20
 #define MBSYS_NETCDF_VELPROFNBR 2
+#define MBSYS_NETCDF_BLOCK_PINGS 128 /* pings staged per netCDF read or write */
 
 /* sonar id numbers */
 #define MBSYS_NETCDF_SONAR_UNKNOWN 0
@@ -662,11 +662,12 @@ int64_t r7kr_read_nf(r7kr_reader_t *self, byte *dest, uint32_t len,
                 case R7KR_STATE_START:
 //                    MX_DMSG(R7KR_DEBUG, "R7KR_STATE_START\n"));
                     read_len       = R7K_NF_BYTES;
+                    // clear bytes read by a rejected attempt
+                    memset(dest,0,(size_t)(pbuf-dest));
                     pbuf           = dest;
                     header_pending = true;
                     frame_bytes    = 0;
                     action         = R7KR_ACTION_READ;
-                    memset(dest,0,len);
                     break;
 
                 case R7KR_STATE_READING:
@@ -847,8 +848,8 @@ int64_t r7kr_read_nf(r7kr_reader_t *self, byte *dest, uint32_t len,
                         // start of the buffer
                         memmove(dest, psync, pending_bytes);
 
-                        // clean up buffer
-                        memset((dest+pending_bytes), 0, (len-pending_bytes));
+                        // clean up buffer (stale bytes up to end of input)
+                        memset((dest+pending_bytes), 0, (size_t)(pbuf-dest)-pending_bytes);
 
                         // configure state to resume header read
                         pbuf           = dest+pending_bytes;
@@ -965,8 +966,10 @@ int64_t r7kr_read_drf(r7kr_reader_t *self, byte *dest, uint32_t len,
                 case R7KR_STATE_START:
 //                    MX_MMSG(R7KR_DEBUG, "R7KR_STATE_START\n");
                    read_len = R7K_DRF_BYTES;
+                    // clear bytes read by a rejected attempt
+                    // (not len: this may be the max frame size)
+                    memset(dest,0,(size_t)(pbuf-dest));
                     pbuf     = dest;
-                    memset(dest,0,len);
                     header_pending=true;
                     data_pending=true;
                     frame_bytes=0;
@@ -1241,8 +1244,8 @@ int64_t r7kr_read_drf(r7kr_reader_t *self, byte *dest, uint32_t len,
                                     // start of the buffer
                                     memmove(dest, psync, pending_bytes);
 
-									// clean up buffer
-                                    memset((dest+pending_bytes), 0, (len-pending_bytes));
+									// clean up buffer (stale bytes up to end of input)
+                                    memset((dest+pending_bytes), 0, (size_t)(pbuf-dest)-pending_bytes);
 
                                     // configure state to continue reading data
                                     pbuf           = dest+pending_bytes;
@@ -1268,8 +1271,8 @@ int64_t r7kr_read_drf(r7kr_reader_t *self, byte *dest, uint32_t len,
                                     memmove(dest, psync, pframe->size);
                                     pframe = (r7k_drf_t *)dest;
 
-                                    // clean up buffer
-                                    memset((dest+pframe->size), 0, (len-pframe->size));
+                                    // clean up buffer (stale bytes up to end of input)
+                                    memset((dest+pframe->size), 0, (size_t)(pbuf-dest)-pframe->size);
 
                                     // return the frame:
                                     frame_bytes = pframe->size;
@@ -1302,8 +1305,8 @@ int64_t r7kr_read_drf(r7kr_reader_t *self, byte *dest, uint32_t len,
                             // start of the buffer
                             memmove(dest, psync, pending_bytes);
 
-                            // clean up buffer
-                            memset((dest+pending_bytes), 0, (len-pending_bytes));
+                            // clean up buffer (stale bytes up to end of input)
+                            memset((dest+pending_bytes), 0, (size_t)(pbuf-dest)-pending_bytes);
 
                             // configure state to resume header read
                             pbuf           = dest+pending_bytes;
@@ -1546,8 +1549,10 @@ int64_t r7kr_read_frame(r7kr_reader_t *self, byte *dest,
                         action   = R7KR_ACTION_READ_NF;
                     }
 
+                    // clear bytes read by a rejected attempt
+                    // (not len: this is usually the max frame size)
+                    memset(dest,0,(size_t)(pbuf-dest));
                     pbuf     = dest;
-                    memset(dest,0,len);
                     frame_bytes=0;
                     break;
 
@@ -12,6 +12,40 @@
 #include <iostream>
 #include <iomanip>
 #include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+// Morton codes hold three bits per level in 64 bits, and points left out get this code
+#define OCTREE_MORTON_MAXDEPTH 21
+static const uint64_t Octree_NoCode = ~static_cast<uint64_t>(0);
+
+// Number of threads to use, all the processors if numThreads is zero
+static unsigned int Octree_NumThreads(const unsigned int numThreads) {
+	if(numThreads > 0) {
+		return numThreads;
+	}
+	return std::max(1U, std::thread::hardware_concurrency());
+}
+
+// Run job(0) to job(numJobs - 1) on up to numThreads threads
+template <class Job>
+static void Octree_ParallelFor(const unsigned int numThreads, const size_t numJobs, const Job& job) {
+	std::atomic<size_t> nextJob(0);
+	auto worker = [&]() {
+		for(size_t index = nextJob++; index < numJobs; index = nextJob++) {
+			job(index);
+		}
+	};
+	std::vector<std::thread> threads;
+	for(size_t index = 1; index < std::min(static_cast<size_t>(numThreads), numJobs); index++) {
+		threads.emplace_back(worker);
+	}
+	worker();
+	for(size_t index = 0; index < threads.size(); index++) {
+		threads[index].join();
+	}
+}
 
 /* Octree Class
 stores root of an octree and general properties for working with that Octree.
@@ -594,6 +628,42 @@ AddData(const Vector points[], const ValueType data[], unsigned int numDatas) {
 
 
 
+/*! Bulk adding:
+Gives the same tree as adding the points one at a time (the result of adding points does not
+depend on their order), but much faster for large numbers of points.  The points are converted
+to the Morton codes of their leaves and sorted into the subtrees below a split depth, then each
+subtree is built depth first from its sorted codes, on numThreads threads (or one per processor
+if numThreads is zero).  Trees deeper than OCTREE_MORTON_MAXDEPTH are built one point at a time.
+*/
+template <class ValueType>
+int
+Octree<ValueType>::
+AddPoints(const Vector points[], const unsigned int numPoints, const unsigned int numThreads) {
+	if(OctreeNodeType != OctreeType::BinaryOccupancy) {
+		return AddPoints(points, numPoints);
+	}
+	for(unsigned int index = 0; index < numPoints; index++) {
+		if(!ContainsPoint(points[index])) {
+			ExpandOctreeToIncludePoint(points[index]);
+		}
+	}
+	if(MaxDepth > OCTREE_MORTON_MAXDEPTH) {
+		return AddPoints(points, numPoints);
+	}
+	
+	const unsigned int threads = Octree_NumThreads(numThreads);
+	const size_t chunkSize = 65536;
+	std::vector<uint64_t> codes(numPoints);
+	Octree_ParallelFor(threads, (numPoints + chunkSize - 1) / chunkSize, [&](size_t chunk) {
+		const size_t end = std::min(static_cast<size_t>(numPoints), (chunk + 1) * chunkSize);
+		for(size_t index = chunk * chunkSize; index < end; index++) {
+			codes[index] = Octree_MortonCode(FindPathToPoint(points[index]));
+		}
+	});
+	AddLeaves(codes, static_cast<ValueType>(true), threads);
+	return numPoints;
+}
+
 template <class ValueType>
 void
 Octree<ValueType>::
@@ -630,6 +700,33 @@ FillSmallestResolutionLeafAtPointIfEmpty(const Vector& point, ValueType fillValu
 	}
 }
 
+/* Bulk form of FillSmallestResolutionLeafAtPointIfEmpty, built like the bulk AddPoints
+*/
+template <class ValueType>
+void
+Octree<ValueType>::
+FillSmallestResolutionLeavesAtPointsIfEmpty(const Vector points[], const unsigned int numPoints,
+											ValueType fillValue, const unsigned int numThreads) {
+	if(MaxDepth > OCTREE_MORTON_MAXDEPTH) {
+		for(unsigned int index = 0; index < numPoints; index++) {
+			FillSmallestResolutionLeafAtPointIfEmpty(points[index], fillValue);
+		}
+		return;
+	}
+	
+	const unsigned int threads = Octree_NumThreads(numThreads);
+	const size_t chunkSize = 65536;
+	std::vector<uint64_t> codes(numPoints);
+	Octree_ParallelFor(threads, (numPoints + chunkSize - 1) / chunkSize, [&](size_t chunk) {
+		const size_t end = std::min(static_cast<size_t>(numPoints), (chunk + 1) * chunkSize);
+		for(size_t index = chunk * chunkSize; index < end; index++) {
+			codes[index] = ContainsPoint(points[index]) ? Octree_MortonCode(FindPathToPoint(points[index]))
+				: Octree_NoCode;
+		}
+	});
+	AddLeaves(codes, fillValue, threads);
+}
+
 // Memory reduction
 template <class ValueType>
 void
@@ -663,6 +760,23 @@ Collapse(void) {
 	OctreeRoot->Collapse();
 }
 
+/* Collapse the subtrees below the split depth on numThreads threads, then the
+nodes above them.
+*/
+template <class ValueType>
+void
+Octree<ValueType>::
+Collapse(const unsigned int numThreads) {
+	const unsigned int threads = Octree_NumThreads(numThreads);
+	const int splitDepth = GetSplitDepth(threads);
+	std::vector<OctreeNode*> nodes;
+	GetNodesAtDepth(nodes, OctreeRoot, 0, splitDepth);
+	Octree_ParallelFor(threads, nodes.size(), [&](size_t index) {
+		nodes[index]->Collapse();
+	});
+	OctreeRoot->CollapseAboveDepth(0, splitDepth);
+}
+
 // Save, Load, and Print
 /* Save function:
 Writes directly to a binary file.
@@ -1324,6 +1438,103 @@ GetPathChildNumber(const Path& path, const int depth) const{
 		| ((path.z & (1 << (MaxDepth - depth - 1))) != 0);
 	return childNumber;
 }
+/* Bulk construction helpers:
+The split depth gives a few dozen subtrees per thread for a surface, which fills
+about a quarter of the children of each node.
+*/
+template <class ValueType>
+int
+Octree<ValueType>::
+GetSplitDepth(const unsigned int numThreads) const {
+	int splitDepth = 0;
+	while(splitDepth < MaxDepth && splitDepth < 6
+		  && (static_cast<size_t>(1) << (2 * splitDepth)) < 32 * static_cast<size_t>(numThreads)) {
+		splitDepth++;
+	}
+	return splitDepth;
+}
+
+/* Set the leaves with the given Morton codes (Octree_NoCode entries are skipped)
+to leafValue.  The codes are counting sorted by the subtree at the split depth
+which holds them, the nodes down to the split depth are found or made in turn,
+and then the subtrees are sorted and built in parallel.
+*/
+template <class ValueType>
+void
+Octree<ValueType>::
+AddLeaves(std::vector<uint64_t>& codes, const ValueType leafValue, const unsigned int numThreads) {
+	const int splitDepth = GetSplitDepth(numThreads);
+	const int shift = 3 * (MaxDepth - splitDepth);
+	const size_t numSubtrees = static_cast<size_t>(1) << (3 * splitDepth);
+	
+	std::vector<size_t> subtreeStart(numSubtrees + 1, 0);
+	for(size_t index = 0; index < codes.size(); index++) {
+		if(codes[index] != Octree_NoCode) {
+			subtreeStart[(codes[index] >> shift) + 1]++;
+		}
+	}
+	for(size_t subtree = 0; subtree < numSubtrees; subtree++) {
+		subtreeStart[subtree + 1] += subtreeStart[subtree];
+	}
+	std::vector<uint64_t> sortedCodes(subtreeStart[numSubtrees]);
+	{
+		std::vector<size_t> next(subtreeStart.begin(), subtreeStart.end() - 1);
+		for(size_t index = 0; index < codes.size(); index++) {
+			if(codes[index] != Octree_NoCode) {
+				sortedCodes[next[codes[index] >> shift]++] = codes[index];
+			}
+		}
+	}
+	std::vector<uint64_t>().swap(codes);
+	
+	std::vector<OctreeNode*> subtreeRoots(numSubtrees, NULL);
+	for(size_t subtree = 0; subtree < numSubtrees; subtree++) {
+		if(subtreeStart[subtree] == subtreeStart[subtree + 1]) {
+			continue;
+		}
+		OctreeNode* nodePointer = OctreeRoot;
+		for(int depth = 0; depth < splitDepth && nodePointer != NULL; depth++) {
+			if(nodePointer->children == NULL) {
+				if(nodePointer->value != EmptyValue) {
+					nodePointer = NULL;
+					break;
+				}
+				nodePointer->children = new OctreeNode*[8];
+				for(int index = 0; index < 8; index++) {
+					nodePointer->children[index] = new OctreeNode(EmptyValue);
+				}
+			}
+			nodePointer = nodePointer->children[(subtree >> (3 * (splitDepth - depth - 1))) & 7];
+		}
+		subtreeRoots[subtree] = nodePointer;
+	}
+	
+	Octree_ParallelFor(numThreads, numSubtrees, [&](size_t subtree) {
+		if(subtreeRoots[subtree] != NULL) {
+			uint64_t* begin = sortedCodes.data() + subtreeStart[subtree];
+			uint64_t* end = sortedCodes.data() + subtreeStart[subtree + 1];
+			std::sort(begin, end);
+			subtreeRoots[subtree]->AddLeaves(*this, begin, end - begin, leafValue, splitDepth);
+		}
+	});
+}
+
+template <class ValueType>
+void
+Octree<ValueType>::
+GetNodesAtDepth(std::vector<OctreeNode*>& nodes, OctreeNode* node, const int depth, const int targetDepth) const {
+	if(node->children == NULL) {
+		return;
+	}
+	if(depth == targetDepth) {
+		nodes.push_back(node);
+		return;
+	}
+	for(int index = 0; index < 8; index++) {
+		GetNodesAtDepth(nodes, node->children[index], depth + 1, targetDepth);
+	}
+}
+
 /* Expand Octree for adding points:
 Expands the bounds of the Octree towards the point.
 */
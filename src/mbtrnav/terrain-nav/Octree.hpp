@@ -5,6 +5,8 @@
 #include "OctreeSupport.hpp"
 
 #include <fstream>
+#include <stdint.h>
+#include <vector>
 
 /*! WHERE STUFF IS DOCUMENTED:
 
@@ -184,12 +186,17 @@ class Octree {
 		bool AddData(const Vector& point, const ValueType data);
 		int AddData(const Vector points[], const ValueType data[], const unsigned int numDatas);
 		
+		//bulk adding: same tree as one at a time, built in Morton order on numThreads threads
+		int AddPoints(const Vector points[], const unsigned int numPoints, const unsigned int numThreads);
 		
 		void FillSmallestResolutionLeafAtPointIfEmpty(const Vector& point, ValueType fillValue);
+		void FillSmallestResolutionLeavesAtPointsIfEmpty(const Vector points[], const unsigned int numPoints,
+														 ValueType fillValue, const unsigned int numThreads);
 		//reducing the memory requirements
 		void FillIfEmpty(const Vector& point, ValueType fillValue);
 		void FillIfEmpty(const Vector points[], unsigned int numPoints, ValueType fillValue);
 		void Collapse(void);
+		void Collapse(const unsigned int numThreads);
 		
 		//save and load
 		bool SaveToFile(const char* filename) const;
@@ -236,6 +243,11 @@ class Octree {
 		int GetPathChildNumber(const Path& path, const int depth) const;
 		void ExpandOctreeToIncludePoint(const Vector& Point);
 		
+		// bulk construction helpers
+		int GetSplitDepth(const unsigned int numThreads) const;
+		void AddLeaves(std::vector<uint64_t>& codes, const ValueType leafValue, const unsigned int numThreads);
+		void GetNodesAtDepth(std::vector<OctreeNode*>& nodes, OctreeNode* node, const int depth, const int targetDepth) const;
+		
 	private: // variables
 		Vector LowerBounds;
 		Vector UpperBounds;
@@ -263,8 +275,13 @@ class Octree {
 			
 			
 			
+			//add leaves from a sorted range of Morton codes (bulk construction)
+			void AddLeaves(const Octree<ValueType>& OT, const uint64_t* codes, const size_t numCodes,
+						   const ValueType leafValue, const int depth);
+			
 			//collapse
 			void Collapse(void);
+			void CollapseAboveDepth(const int depth, const int stopDepth);
 			
 			//save and load
 			bool SaveToFile(std::FILE* saveFile) const;
@@ -143,6 +143,46 @@ AddData(const Octree<ValueType>& OT, const Vector& point, const ValueType data,
 
 
 
+/*! AddLeaves
+Bulk form of AddPointBinaryOccupancy and FillSmallestResolutionLeafAtPointIfEmpty.  Sets
+the MaxDepth leaves given by a sorted range of Morton codes (see Octree_MortonCode) within
+this node to leafValue, splitting empty leaves on the way down.  Leaves which already hold
+a value are left alone, as adding or filling one at a time would, so the tree does not
+depend on the order of the codes.
+*/
+template <class ValueType>
+void
+Octree<ValueType>::OctreeNode::
+AddLeaves(const Octree<ValueType>& OT, const uint64_t* codes, const size_t numCodes,
+		  const ValueType leafValue, const int depth) {
+	if(children == NULL) {
+		if(value != OT.EmptyValue) {
+			return;
+		}
+		if(depth == OT.MaxDepth) {
+			value = leafValue;
+			return;
+		}
+		children = new OctreeNode*[8];
+		for(int index = 0; index < 8; index++) {
+			children[index] = new OctreeNode(OT.EmptyValue);
+		}
+	}
+	//the codes for each child are contiguous, in child number order
+	const int shift = 3 * (OT.MaxDepth - depth - 1);
+	const uint64_t* begin = codes;
+	const uint64_t* end = codes + numCodes;
+	while(begin != end) {
+		const int childNumber = static_cast<int>((*begin >> shift) & 7);
+		const uint64_t* childEnd = begin + 1;
+		while(childEnd != end && static_cast<int>((*childEnd >> shift) & 7) == childNumber) {
+			childEnd++;
+		}
+		children[childNumber]->AddLeaves(OT, begin, childEnd - begin, leafValue, depth + 1);
+		begin = childEnd;
+	}
+}
+
 /* Collapse function
 Collapsing a node compresses the tree.  It only collapses nodes where the whole volume 
 is uniform.
@@ -181,6 +221,34 @@ Collapse(void) {
 	}
 }
 
+/* Collapse nodes above stopDepth, for use once the subtrees at stopDepth
+have been collapsed (in parallel by Octree::Collapse(numThreads)).
+*/
+template <class ValueType>
+void
+Octree<ValueType>::OctreeNode::
+CollapseAboveDepth(const int depth, const int stopDepth) {
+	if(children != NULL && depth < stopDepth) {
+		children[0]->CollapseAboveDepth(depth + 1, stopDepth);
+		ValueType testValue = children[0]->value;
+		bool collapseThisNode = (children[0]->children == NULL);
+		for(int index = 1; index < 8; index++) {
+			children[index]->CollapseAboveDepth(depth + 1, stopDepth);
+			
+			collapseThisNode &= (children[index]->children == NULL);
+			collapseThisNode &= (testValue == children[index]->value);
+		}
+		if(collapseThisNode) {
+			value = testValue;
+			for(int index = 0; index < 8; index++) {
+				delete children[index];
+			}
+			delete[] children;
+			children = NULL;
+		}
+	}
+}
+
 // Save, Load, and Print functions
 /* Save
 For use by Octree SaveToFile.
@@ -126,6 +126,23 @@ int Octree_PickMaxRatio(double& Xratio, const double Yratio, const double Zratio
 	return 1;
 }
 
+// Morton code of a MaxDepth leaf: the child numbers along the path, three bits per
+// level with the root's first, so sorting codes groups the leaves of each subtree.
+// Each path element may have up to 21 bits.
+static uint64_t Octree_SpreadBits(uint64_t bits) {
+	bits &= 0x1fffff;
+	bits = (bits | bits << 32) & 0x1f00000000ffffULL;
+	bits = (bits | bits << 16) & 0x1f0000ff0000ffULL;
+	bits = (bits | bits << 8) & 0x100f00f00f00f00fULL;
+	bits = (bits | bits << 4) & 0x10c30c30c30c30c3ULL;
+	bits = (bits | bits << 2) & 0x1249249249249249ULL;
+	return bits;
+}
+
+uint64_t Octree_MortonCode(const Path& path) {
+	return (Octree_SpreadBits(path.x) << 2) | (Octree_SpreadBits(path.y) << 1) | Octree_SpreadBits(path.z);
+}
+
 // local functions:
 void OctreeNode_PrintTabs(int num) {
 	for(int ii = 0; ii < num; ii++) {
@@ -2,6 +2,7 @@
 #define OctreeSupport_H
 
 #include <ostream>
+#include <stdint.h>
 
 
 /*
@@ -75,6 +76,7 @@ Vector operator/ (Vector U, double divideBy);
 //for Octree.cpp
 int Octree_PickMaxRatio(double& Xratio, const double Yratio, const double Zratio);
 int Octree_PickMinPositiveRatio(const double Xratio, const double Yratio, const double Zratio);
+uint64_t Octree_MortonCode(const Path& path);
 //for OctreeNode.cpp
 void OctreeNode_PrintTabs(int num);
 unsigned int OctreeNode_CalculateWeights(double* weights, const Vector* const points, const unsigned int* const indices, 
@@ -60,11 +60,23 @@ GNU General Public License for more details
 /////////////////////////
 
 #include "mcbuf.h"
+#ifdef WITH_MCBUF_TEST
+#include <sched.h>
+#include "mtime.h"
+#include "mstats.h"
+#include "mmqueue.h"
+#endif
 
 /////////////////////////
 // Macros
 /////////////////////////
 
+#ifdef WITH_MCBUF_TEST
+/// @def MCB_BENCH_PRODUCERS_MAX
+/// @brief benchmark producer thread limit
+#define MCB_BENCH_PRODUCERS_MAX 16
+#endif
+
 // These macros should only be defined for 
 // application main files rather than general C files
 /*
@@ -355,6 +367,268 @@ int mcbuf_clear(mcbuffer_t *self)
 // End function mcbuf_clear
 
 
+/// @fn uint32_t s_ring_capacity(uint32_t capacity)
+/// @brief round ring capacity up to a power of 2.
+/// @param[in] capacity requested capacity
+/// @return ring capacity (>=2)
+static uint32_t s_ring_capacity(uint32_t capacity)
+{
+    uint32_t retval=2;
+    while (retval<capacity && retval<0x80000000) {
+        retval<<=1;
+    }
+    return retval;
+}
+// End function s_ring_capacity
+
+/// @fn void *s_ring_alloc(size_t size)
+/// @brief allocate cache line aligned ring memory (zeroed).
+/// @param[in] size size (bytes)
+/// @return pointer on success, NULL otherwise
+static void *s_ring_alloc(size_t size)
+{
+    void *retval=NULL;
+    if (posix_memalign(&retval, MCB_CACHE_LINE, size)==0) {
+        memset(retval,0,size);
+    }else{
+        retval=NULL;
+    }
+    return retval;
+}
+// End function s_ring_alloc
+
+/// @fn mcbuf_spsc_t *mcbuf_spsc_new(uint32_t capacity)
+/// @brief return new SPSC ring instance reference.
+/// caller should release using mcbuf_spsc_destroy();
+/// @param[in] capacity number of slots (rounded up to power of 2)
+/// @return instance reference on success, NULL otherwise
+mcbuf_spsc_t *mcbuf_spsc_new(uint32_t capacity)
+{
+    mcbuf_spsc_t *self = (mcbuf_spsc_t *)s_ring_alloc(sizeof(mcbuf_spsc_t));
+    if (NULL!=self) {
+        self->capacity = s_ring_capacity(capacity);
+        self->mask = self->capacity-1;
+        self->slot = (void **)s_ring_alloc(self->capacity*sizeof(void *));
+        if (NULL==self->slot) {
+            free(self);
+            self=NULL;
+        }
+    }
+    if (NULL==self) {
+        fprintf(stderr,"malloc failed\n");
+    }
+    return self;
+}
+// End function mcbuf_spsc_new
+
+/// @fn void mcbuf_spsc_destroy(mcbuf_spsc_t **pself)
+/// @brief release SPSC ring resources (items are not released).
+/// @param[in] pself pointer to instance reference
+/// @return none
+void mcbuf_spsc_destroy(mcbuf_spsc_t **pself)
+{
+    if (NULL != pself) {
+        mcbuf_spsc_t *self = *pself;
+        if (NULL != self) {
+            free(self->slot);
+            free(self);
+            *pself = NULL;
+        }
+    }
+}
+// End function mcbuf_spsc_destroy
+
+/// @fn int mcbuf_spsc_push(mcbuf_spsc_t *self, void *item)
+/// @brief add item to ring (producer thread only).
+/// @param[in] self ring reference
+/// @param[in] item item pointer
+/// @return MCB_OK on success, MCB_FULL if ring is full, -1 on invalid argument
+int mcbuf_spsc_push(mcbuf_spsc_t *self, void *item)
+{
+    int retval=-1;
+    if (NULL!=self) {
+        uint64_t tail = self->tail;
+        if ( (tail - self->head_cache) >= self->capacity) {
+            // refresh cached head; still full if consumer hasn't moved
+            self->head_cache = __atomic_load_n(&self->head, __ATOMIC_ACQUIRE);
+            if ( (tail - self->head_cache) >= self->capacity) {
+                return MCB_FULL;
+            }
+        }
+        self->slot[tail & self->mask] = item;
+        __atomic_store_n(&self->tail, tail+1, __ATOMIC_RELEASE);
+        retval=MCB_OK;
+    }
+    return retval;
+}
+// End function mcbuf_spsc_push
+
+/// @fn int mcbuf_spsc_pop(mcbuf_spsc_t *self, void **pitem)
+/// @brief remove item from ring (consumer thread only).
+/// @param[in] self ring reference
+/// @param[out] pitem item pointer
+/// @return MCB_OK on success, MCB_EMPTY if ring is empty, -1 on invalid argument
+int mcbuf_spsc_pop(mcbuf_spsc_t *self, void **pitem)
+{
+    int retval=-1;
+    if (NULL!=self && NULL!=pitem) {
+        uint64_t head = self->head;
+        if (head == self->tail_cache) {
+            // refresh cached tail; still empty if producer hasn't moved
+            self->tail_cache = __atomic_load_n(&self->tail, __ATOMIC_ACQUIRE);
+            if (head == self->tail_cache) {
+                return MCB_EMPTY;
+            }
+        }
+        *pitem = self->slot[head & self->mask];
+        __atomic_store_n(&self->head, head+1, __ATOMIC_RELEASE);
+        retval=MCB_OK;
+    }
+    return retval;
+}
+// End function mcbuf_spsc_pop
+
+/// @fn uint32_t mcbuf_spsc_available(mcbuf_spsc_t *self)
+/// @brief number of items in ring (approximate while in use).
+/// @param[in] self ring reference
+/// @return number of items available for reading.
+uint32_t mcbuf_spsc_available(mcbuf_spsc_t *self)
+{
+    uint32_t retval=0;
+    if (NULL!=self) {
+        uint64_t head = __atomic_load_n(&self->head, __ATOMIC_ACQUIRE);
+        uint64_t tail = __atomic_load_n(&self->tail, __ATOMIC_ACQUIRE);
+        retval = (uint32_t)(tail-head);
+    }
+    return retval;
+}
+// End function mcbuf_spsc_available
+
+/// @fn mcbuf_mpsc_t *mcbuf_mpsc_new(uint32_t capacity)
+/// @brief return new bounded MPSC ring instance reference.
+/// caller should release using mcbuf_mpsc_destroy();
+/// @param[in] capacity number of slots (rounded up to power of 2)
+/// @return instance reference on success, NULL otherwise
+mcbuf_mpsc_t *mcbuf_mpsc_new(uint32_t capacity)
+{
+    mcbuf_mpsc_t *self = (mcbuf_mpsc_t *)s_ring_alloc(sizeof(mcbuf_mpsc_t));
+    if (NULL!=self) {
+        self->capacity = s_ring_capacity(capacity);
+        self->mask = self->capacity-1;
+        self->slot = (mcbuf_mslot_t *)s_ring_alloc(self->capacity*sizeof(mcbuf_mslot_t));
+        if (NULL!=self->slot) {
+            uint32_t i=0;
+            for (i=0; i<self->capacity; i++) {
+                self->slot[i].seq = i;
+            }
+        }else{
+            free(self);
+            self=NULL;
+        }
+    }
+    if (NULL==self) {
+        fprintf(stderr,"malloc failed\n");
+    }
+    return self;
+}
+// End function mcbuf_mpsc_new
+
+/// @fn void mcbuf_mpsc_destroy(mcbuf_mpsc_t **pself)
+/// @brief release MPSC ring resources (items are not released).
+/// @param[in] pself pointer to instance reference
+/// @return none
+void mcbuf_mpsc_destroy(mcbuf_mpsc_t **pself)
+{
+    if (NULL != pself) {
+        mcbuf_mpsc_t *self = *pself;
+        if (NULL != self) {
+            free(self->slot);
+            free(self);
+            *pself = NULL;
+        }
+    }
+}
+// End function mcbuf_mpsc_destroy
+
+/// @fn int mcbuf_mpsc_push(mcbuf_mpsc_t *self, void *item)
+/// @brief add item to ring (any thread).
+/// @param[in] self ring reference
+/// @param[in] item item pointer
+/// @return MCB_OK on success, MCB_FULL if ring is full, -1 on invalid argument
+int mcbuf_mpsc_push(mcbuf_mpsc_t *self, void *item)
+{
+    int retval=-1;
+    if (NULL!=self) {
+        uint64_t pos = __atomic_load_n(&self->tail, __ATOMIC_RELAXED);
+        for (;;) {
+            mcbuf_mslot_t *slot = &self->slot[pos & self->mask];
+            uint64_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+            int64_t diff = (int64_t)seq - (int64_t)pos;
+            if (diff == 0) {
+                // slot is free; claim it
+                if (__atomic_compare_exchange_n(&self->tail, &pos, pos+1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                    slot->item = item;
+                    __atomic_store_n(&slot->seq, pos+1, __ATOMIC_RELEASE);
+                    retval=MCB_OK;
+                    break;
+                }
+                // CAS failure reloads pos
+            }else if (diff < 0) {
+                // slot not yet consumed
+                retval=MCB_FULL;
+                break;
+            }else{
+                // another producer claimed it
+                pos = __atomic_load_n(&self->tail, __ATOMIC_RELAXED);
+            }
+        }
+    }
+    return retval;
+}
+// End function mcbuf_mpsc_push
+
+/// @fn int mcbuf_mpsc_pop(mcbuf_mpsc_t *self, void **pitem)
+/// @brief remove item from ring (consumer thread only).
+/// @param[in] self ring reference
+/// @param[out] pitem item pointer
+/// @return MCB_OK on success, MCB_EMPTY if ring is empty, -1 on invalid argument
+int mcbuf_mpsc_pop(mcbuf_mpsc_t *self, void **pitem)
+{
+    int retval=-1;
+    if (NULL!=self && NULL!=pitem) {
+        uint64_t pos = self->head;
+        mcbuf_mslot_t *slot = &self->slot[pos & self->mask];
+        uint64_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        if ( (int64_t)seq - (int64_t)(pos+1) < 0) {
+            retval=MCB_EMPTY;
+        }else{
+            *pitem = slot->item;
+            // release slot for reuse on the next lap
+            __atomic_store_n(&slot->seq, pos+self->capacity, __ATOMIC_RELEASE);
+            __atomic_store_n(&self->head, pos+1, __ATOMIC_RELEASE);
+            retval=MCB_OK;
+        }
+    }
+    return retval;
+}
+// End function mcbuf_mpsc_pop
+
+/// @fn uint32_t mcbuf_mpsc_available(mcbuf_mpsc_t *self)
+/// @brief number of claimed slots (approximate while in use).
+/// @param[in] self ring reference
+/// @return number of items (including those being written).
+uint32_t mcbuf_mpsc_available(mcbuf_mpsc_t *self)
+{
+    uint32_t retval=0;
+    if (NULL!=self) {
+        uint64_t head = __atomic_load_n(&self->head, __ATOMIC_ACQUIRE);
+        uint64_t tail = __atomic_load_n(&self->tail, __ATOMIC_ACQUIRE);
+        retval = (tail>head ? (uint32_t)(tail-head) : 0);
+    }
+    return retval;
+}
+// End function mcbuf_mpsc_available
+
 //int mcbuf_oflush(mcbuffer_t *self);
 //int mcbuf_resize(mcbuffer_t *self, uint32_t len);
 
@@ -474,3 +748,280 @@ int mcbuf_test()
 
 
 
+
+
+#ifdef WITH_MCBUF_TEST
+/// @fn int mcbuf_ring_test()
+/// @brief SPSC/MPSC ring unit test(s).
+/// @return 0 on success, -1 otherwise
+int mcbuf_ring_test()
+{
+    int retval=0;
+    uintptr_t i=0;
+    void *item=NULL;
+    void *mitem=NULL;
+    int rs=0, rm=0;
+    mcbuf_spsc_t *sr = mcbuf_spsc_new(5);
+    mcbuf_mpsc_t *mr = mcbuf_mpsc_new(5);
+
+    // queue operations are made outside of assert() so that
+    // the test still runs (and reports failure) with NDEBUG
+#define MCB_RING_CHECK(cond) do{ assert(cond); if(!(cond)) retval=-1; }while(0)
+
+    // capacity rounds up to power of 2
+    MCB_RING_CHECK(sr->capacity==8);
+    MCB_RING_CHECK(mr->capacity==8);
+
+    // pop empty
+    rs = mcbuf_spsc_pop(sr,&item);
+    rm = mcbuf_mpsc_pop(mr,&mitem);
+    MCB_RING_CHECK(rs==MCB_EMPTY);
+    MCB_RING_CHECK(rm==MCB_EMPTY);
+
+    // fill, overflow, drain (several laps to exercise wrap)
+    int lap=0;
+    for (lap=0; lap<3; lap++) {
+        for (i=1; i<=8; i++) {
+            rs = mcbuf_spsc_push(sr,(void *)i);
+            rm = mcbuf_mpsc_push(mr,(void *)i);
+            MCB_RING_CHECK(rs==MCB_OK);
+            MCB_RING_CHECK(rm==MCB_OK);
+        }
+        rs = mcbuf_spsc_push(sr,(void *)i);
+        rm = mcbuf_mpsc_push(mr,(void *)i);
+        MCB_RING_CHECK(rs==MCB_FULL);
+        MCB_RING_CHECK(rm==MCB_FULL);
+        MCB_RING_CHECK(mcbuf_spsc_available(sr)==8);
+        MCB_RING_CHECK(mcbuf_mpsc_available(mr)==8);
+        for (i=1; i<=8; i++) {
+            rs = mcbuf_spsc_pop(sr,&item);
+            rm = mcbuf_mpsc_pop(mr,&mitem);
+            MCB_RING_CHECK(rs==MCB_OK && (uintptr_t)item==i);
+            MCB_RING_CHECK(rm==MCB_OK && (uintptr_t)mitem==i);
+        }
+        rs = mcbuf_spsc_pop(sr,&item);
+        rm = mcbuf_mpsc_pop(mr,&mitem);
+        MCB_RING_CHECK(rs==MCB_EMPTY);
+        MCB_RING_CHECK(rm==MCB_EMPTY);
+    }
+#undef MCB_RING_CHECK
+
+    mcbuf_spsc_destroy(&sr);
+    mcbuf_mpsc_destroy(&mr);
+    assert(sr==NULL && mr==NULL);
+    fprintf(stderr,"ring test %s\n",(retval==0?"OK":"FAILED"));
+    return retval;
+}
+// End function mcbuf_ring_test
+
+/// @typedef enum mcb_bench_mode_t mcb_bench_mode_t
+/// @brief benchmark queue implementations
+typedef enum {MCB_BENCH_MUTEX=0, MCB_BENCH_SPSC, MCB_BENCH_MPSC} mcb_bench_mode_t;
+
+/// @typedef struct mcb_bench_s mcb_bench_t
+/// @brief benchmark context shared by producer/consumer threads
+typedef struct mcb_bench_s{
+    mcb_bench_mode_t mode;
+    uint32_t nitems;
+    uint32_t nproducers;
+    double *t_push;
+    mstats_hist_t *hist;
+    mq_tqueue_t queue;
+    mthread_mutex_t *mutex;
+    mcbuf_spsc_t *spsc;
+    mcbuf_mpsc_t *mpsc;
+    uint64_t full_n;
+}mcb_bench_t;
+
+/// @typedef struct mcb_bench_arg_s mcb_bench_arg_t
+/// @brief producer thread argument
+typedef struct mcb_bench_arg_s{
+    mcb_bench_t *ctx;
+    uint32_t id;
+}mcb_bench_arg_t;
+
+/// @fn void *s_bench_producer(void *arg)
+/// @brief benchmark producer: item i is pushed by producer (i % nproducers)
+/// @param[in] arg mcb_bench_arg_t pointer
+/// @return NULL
+static void *s_bench_producer(void *arg)
+{
+    mcb_bench_arg_t *parg = (mcb_bench_arg_t *)arg;
+    mcb_bench_t *ctx = parg->ctx;
+    uint64_t full_n=0;
+    uint32_t i=0;
+
+    for (i=parg->id; i<ctx->nitems; i+=ctx->nproducers) {
+        // items are 1-based indices, so NULL is never queued
+        void *item = (void *)(uintptr_t)(i+1);
+        ctx->t_push[i] = mtime_dtime();
+        switch (ctx->mode) {
+            case MCB_BENCH_MUTEX:
+                mthread_mutex_lock(ctx->mutex);
+                mq_tnqadd(ctx->queue.head,item);
+                mthread_mutex_unlock(ctx->mutex);
+                break;
+            case MCB_BENCH_SPSC:
+                while (mcbuf_spsc_push(ctx->spsc,item)==MCB_FULL) {
+                    full_n++;
+                    sched_yield();
+                }
+                break;
+            case MCB_BENCH_MPSC:
+                while (mcbuf_mpsc_push(ctx->mpsc,item)==MCB_FULL) {
+                    full_n++;
+                    sched_yield();
+                }
+                break;
+        }
+    }
+    __atomic_fetch_add(&ctx->full_n, full_n, __ATOMIC_RELAXED);
+    return NULL;
+}
+// End function s_bench_producer
+
+/// @fn void s_bench_consume(mcb_bench_t *ctx)
+/// @brief benchmark consumer (runs in caller's thread)
+/// @param[in] ctx benchmark context
+/// @return none
+static void s_bench_consume(mcb_bench_t *ctx)
+{
+    uint32_t count=0;
+    while (count<ctx->nitems) {
+        void *item=NULL;
+        switch (ctx->mode) {
+            case MCB_BENCH_MUTEX:
+                mthread_mutex_lock(ctx->mutex);
+                if (!mq_tnqempty(ctx->queue.head)) {
+                    xtq_entry_t *tqe = mq_tnqfirst(ctx->queue.head);
+                    mq_tnqremove(ctx->queue.head,tqe);
+                    item = tqe->item;
+                    free(tqe);
+                }
+                mthread_mutex_unlock(ctx->mutex);
+                break;
+            case MCB_BENCH_SPSC:
+                mcbuf_spsc_pop(ctx->spsc,&item);
+                break;
+            case MCB_BENCH_MPSC:
+                mcbuf_mpsc_pop(ctx->mpsc,&item);
+                break;
+        }
+        if (NULL!=item) {
+            uint32_t i = (uint32_t)((uintptr_t)item-1);
+            mstats_hist_record(ctx->hist, mtime_dtime()-ctx->t_push[i]);
+            count++;
+        }else{
+            // queue empty; let producers run
+            sched_yield();
+        }
+    }
+}
+// End function s_bench_consume
+
+/// @fn void s_bench_run(const char *name, mcb_bench_mode_t mode, uint32_t nitems, uint32_t nproducers, uint32_t capacity)
+/// @brief run one benchmark case and report throughput and latency percentiles
+/// @param[in] name case name
+/// @param[in] mode queue implementation
+/// @param[in] nitems number of items
+/// @param[in] nproducers number of producer threads
+/// @param[in] capacity ring capacity (ring modes)
+/// @return none
+static void s_bench_run(const char *name, mcb_bench_mode_t mode, uint32_t nitems, uint32_t nproducers, uint32_t capacity)
+{
+    mcb_bench_t ctx;
+    mcb_bench_arg_t args[MCB_BENCH_PRODUCERS_MAX];
+    mthread_thread_t *threads[MCB_BENCH_PRODUCERS_MAX];
+    mstats_pctl_t pctl={0};
+    uint32_t i=0;
+
+    memset(&ctx,0,sizeof(ctx));
+    ctx.mode = mode;
+    ctx.nitems = nitems;
+    ctx.nproducers = nproducers;
+    ctx.t_push = (double *)malloc(nitems*sizeof(double));
+    ctx.hist = (mstats_hist_t *)malloc(sizeof(mstats_hist_t));
+    mstats_hist_reset(ctx.hist);
+    ctx.queue.free_fn = NULL;
+    mq_tnqinit(ctx.queue.head);
+    ctx.mutex = mthread_mutex_new();
+    ctx.spsc = (mode==MCB_BENCH_SPSC ? mcbuf_spsc_new(capacity) : NULL);
+    ctx.mpsc = (mode==MCB_BENCH_MPSC ? mcbuf_mpsc_new(capacity) : NULL);
+
+    double start = mtime_dtime();
+    for (i=0; i<nproducers; i++) {
+        args[i].ctx = &ctx;
+        args[i].id = i;
+        threads[i] = mthread_thread_new();
+        mthread_thread_start(threads[i], s_bench_producer, &args[i]);
+    }
+    s_bench_consume(&ctx);
+    for (i=0; i<nproducers; i++) {
+        mthread_thread_join(threads[i]);
+        mthread_thread_destroy(&threads[i]);
+    }
+    double elapsed = mtime_dtime()-start;
+
+    mstats_hist_pctl(ctx.hist,&pctl);
+    fprintf(stderr,"%-8s prod %2u items %9u  %8.3lf Mitem/s  lat us p50 %8.3g p90 %8.3g p99 %8.3g p999 %8.3g  full %"PRIu64"\n",
+            name, nproducers, nitems,
+            (elapsed>0.0 ? (double)nitems/elapsed/1.0e6 : 0.0),
+            pctl.p50*1.0e6, pctl.p90*1.0e6, pctl.p99*1.0e6, pctl.p999*1.0e6,
+            ctx.full_n);
+
+    mcbuf_spsc_destroy(&ctx.spsc);
+    mcbuf_mpsc_destroy(&ctx.mpsc);
+    mthread_mutex_destroy(&ctx.mutex);
+    free(ctx.hist);
+    free(ctx.t_push);
+}
+// End function s_bench_run
+
+/// @fn int mcbuf_bench(int argc, char **argv)
+/// @brief compare mutex/tail queue, SPSC ring and MPSC ring
+/// throughput and latency.
+/// usage: mcbuf-test [-n items] [-p producers] [-c capacity]
+/// @param[in] argc number of arguments
+/// @param[in] argv argument vector
+/// @return 0 on success, -1 otherwise
+int mcbuf_bench(int argc, char **argv)
+{
+    int retval=0;
+    uint32_t nitems=1000000;
+    uint32_t nproducers=4;
+    uint32_t capacity=1024;
+    int c=0;
+
+    while ((c=getopt(argc,argv,"n:p:c:"))!=-1) {
+        switch (c) {
+            case 'n':
+                sscanf(optarg,"%u",&nitems);
+                break;
+            case 'p':
+                sscanf(optarg,"%u",&nproducers);
+                break;
+            case 'c':
+                sscanf(optarg,"%u",&capacity);
+                break;
+            default:
+                fprintf(stderr,"usage: %s [-n items] [-p producers] [-c capacity]\n",argv[0]);
+                return -1;
+        }
+    }
+    if (nproducers<1) nproducers=1;
+    if (nproducers>MCB_BENCH_PRODUCERS_MAX) nproducers=MCB_BENCH_PRODUCERS_MAX;
+    if (nitems<1) nitems=1;
+
+    // single producer
+    s_bench_run("mutex", MCB_BENCH_MUTEX, nitems, 1, capacity);
+    s_bench_run("spsc",  MCB_BENCH_SPSC,  nitems, 1, capacity);
+    s_bench_run("mpsc",  MCB_BENCH_MPSC,  nitems, 1, capacity);
+    // multiple producers
+    if (nproducers>1) {
+        s_bench_run("mutex", MCB_BENCH_MUTEX, nitems, nproducers, capacity);
+        s_bench_run("mpsc",  MCB_BENCH_MPSC,  nitems, nproducers, capacity);
+    }
+    return retval;
+}
+// End function mcbuf_bench
+#endif //WITH_MCBUF_TEST
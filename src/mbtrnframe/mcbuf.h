@@ -100,6 +100,14 @@
 //#define MCBUF_B2O(c)        ( c->pread - c->data )
 //#define MCBUF_IS_WRAPPED(c) (c->pread > c->pwrite ? true : false)
 
+/// @def MCB_CACHE_LINE
+/// @brief cache line size (bytes) used to pad ring indices
+/// (avoids false sharing between producer and consumer)
+#define MCB_CACHE_LINE 64
+/// @def MCB_PAD(n)
+/// @brief pad size to fill a cache line after n bytes
+#define MCB_PAD(n) (MCB_CACHE_LINE-((n)%MCB_CACHE_LINE))
+
 /////////////////////////
 // Type Definitions
 /////////////////////////
@@ -144,6 +152,80 @@ typedef struct mcbuffer_s{
     byte *data;
 }mcbuffer_t;
 
+/// @typedef struct mcbuf_spsc_s mcbuf_spsc_t
+/// @brief single-producer/single-consumer lock-free ring of item pointers.
+/// Slots are preallocated; push/pop do not allocate or lock.
+/// Exactly one thread may push and one thread may pop concurrently.
+/// Producer and consumer indices occupy separate cache lines.
+typedef struct mcbuf_spsc_s{
+    /// @var mcbuf_spsc_s::tail
+    /// @brief write index (producer owned)
+    uint64_t tail;
+    /// @var mcbuf_spsc_s::head_cache
+    /// @brief producer copy of head (reduces cache line transfers)
+    uint64_t head_cache;
+    /// @var mcbuf_spsc_s::pad0
+    /// @brief cache line padding
+    byte pad0[MCB_PAD(2*sizeof(uint64_t))];
+    /// @var mcbuf_spsc_s::head
+    /// @brief read index (consumer owned)
+    uint64_t head;
+    /// @var mcbuf_spsc_s::tail_cache
+    /// @brief consumer copy of tail
+    uint64_t tail_cache;
+    /// @var mcbuf_spsc_s::pad1
+    /// @brief cache line padding
+    byte pad1[MCB_PAD(2*sizeof(uint64_t))];
+    /// @var mcbuf_spsc_s::capacity
+    /// @brief number of slots (power of 2)
+    uint32_t capacity;
+    /// @var mcbuf_spsc_s::mask
+    /// @brief index mask (capacity-1)
+    uint32_t mask;
+    /// @var mcbuf_spsc_s::slot
+    /// @brief item slots
+    void **slot;
+}mcbuf_spsc_t;
+
+/// @typedef struct mcbuf_mslot_s mcbuf_mslot_t
+/// @brief bounded MPSC ring slot
+typedef struct mcbuf_mslot_s{
+    /// @var mcbuf_mslot_s::seq
+    /// @brief slot sequence number
+    uint64_t seq;
+    /// @var mcbuf_mslot_s::item
+    /// @brief item pointer
+    void *item;
+}mcbuf_mslot_t;
+
+/// @typedef struct mcbuf_mpsc_s mcbuf_mpsc_t
+/// @brief bounded multi-producer/single-consumer lock-free ring of item pointers.
+/// Producers claim slots using compare-and-swap on the tail index;
+/// per-slot sequence numbers publish items to the consumer.
+typedef struct mcbuf_mpsc_s{
+    /// @var mcbuf_mpsc_s::tail
+    /// @brief write index (shared by producers)
+    uint64_t tail;
+    /// @var mcbuf_mpsc_s::pad0
+    /// @brief cache line padding
+    byte pad0[MCB_PAD(sizeof(uint64_t))];
+    /// @var mcbuf_mpsc_s::head
+    /// @brief read index (consumer owned)
+    uint64_t head;
+    /// @var mcbuf_mpsc_s::pad1
+    /// @brief cache line padding
+    byte pad1[MCB_PAD(sizeof(uint64_t))];
+    /// @var mcbuf_mpsc_s::capacity
+    /// @brief number of slots (power of 2)
+    uint32_t capacity;
+    /// @var mcbuf_mpsc_s::mask
+    /// @brief index mask (capacity-1)
+    uint32_t mask;
+    /// @var mcbuf_mpsc_s::slot
+    /// @brief item slots
+    mcbuf_mslot_t *slot;
+}mcbuf_mpsc_t;
+
 
 /////////////////////////
 // Exports
@@ -163,6 +245,20 @@ uint32_t mcbuf_available(mcbuffer_t *self);
 uint32_t mcbuf_space(mcbuffer_t *self);
 int mcbuf_clear(mcbuffer_t *self);
 
+// SPSC ring API
+mcbuf_spsc_t *mcbuf_spsc_new(uint32_t capacity);
+void mcbuf_spsc_destroy(mcbuf_spsc_t **pself);
+int mcbuf_spsc_push(mcbuf_spsc_t *self, void *item);
+int mcbuf_spsc_pop(mcbuf_spsc_t *self, void **pitem);
+uint32_t mcbuf_spsc_available(mcbuf_spsc_t *self);
+
+// bounded MPSC ring API
+mcbuf_mpsc_t *mcbuf_mpsc_new(uint32_t capacity);
+void mcbuf_mpsc_destroy(mcbuf_mpsc_t **pself);
+int mcbuf_mpsc_push(mcbuf_mpsc_t *self, void *item);
+int mcbuf_mpsc_pop(mcbuf_mpsc_t *self, void **pitem);
+uint32_t mcbuf_mpsc_available(mcbuf_mpsc_t *self);
+
 // mcbuf_set( from, to, value)
 // mcbuf_clearr( from, to, value)
 //int mcbuf_dup(mcbuffer_t *self, mcbuffer_t *dest);
@@ -170,6 +266,10 @@ int mcbuf_clear(mcbuffer_t *self);
 //int mcbuf_resize(mcbuffer_t *self, uint32_t len);
 //int mcbuf_oflush(mcbuffer_t *self);
 int mcbuf_test();
+#ifdef WITH_MCBUF_TEST
+int mcbuf_ring_test();
+int mcbuf_bench(int argc, char **argv);
+#endif //WITH_MCBUF_TEST
     
 #ifdef __cplusplus
 }
@@ -152,6 +152,9 @@ static mlog_id_t g_next_id=2;
 static mlog_list_entry_t *s_log_list=NULL;
 // TODO; initialize this somewhere
 static mthread_mutex_t *mlog_list_mutex = NULL;
+// serializes log file output (segment rotation, seg_len)
+// for logs shared by multiple threads
+static mthread_mutex_t s_mlog_file_mutex = {PTHREAD_MUTEX_INITIALIZER};
 
 
 /////////////////////////
@@ -1250,6 +1253,7 @@ int mlog_printf(mlog_id_t id, char *fmt, ...)
 //        fprintf(stderr,"dest[%x]&ML_SOUT[%x]\n",dest,(dest&ML_SOUT));
         
         if (dest&ML_FILE  && (flags&ML_DIS)==0 ) {
+            mthread_mutex_lock(&s_mlog_file_mutex);
                 va_list va1;
                 va_list va2;
             int wbytes=0;
@@ -1272,6 +1276,7 @@ int mlog_printf(mlog_id_t id, char *fmt, ...)
                 log->seg_len+=wbytes+1;
             }
             va_end(va2);
+            mthread_mutex_unlock(&s_mlog_file_mutex);
         }
                     // send to stderr, stdout
         if( (dest&ML_SERR) !=0 ){
@@ -1338,6 +1343,7 @@ int mlog_tprintf(mlog_id_t id, const char *fmt, ...)
 //        fprintf(stderr,"mask[%x]&TL_SOUT[%x]\n",strmask,(strmask&TL_SOUT));
         
         if (dest&ML_FILE  && (flags&ML_DIS)==0 ) {
+            mthread_mutex_lock(&s_mlog_file_mutex);
             va_list va1;
             va_list va2;
            int wbytes=0;
@@ -1361,6 +1367,7 @@ int mlog_tprintf(mlog_id_t id, const char *fmt, ...)
                 log->seg_len+=wbytes;
             }
             va_end(va2);
+            mthread_mutex_unlock(&s_mlog_file_mutex);
         }
 //        else{
 //            fprintf(stderr,"file output disabled d[%0X] f[%0X]\n",dest,flags);
@@ -1433,6 +1440,7 @@ int mlog_printf(mlog_id_t id, char *fmt, ...)
 //        fprintf(stderr,"dest[%x]&ML_SOUT[%x]\n",dest,(dest&ML_SOUT));
         
         if (dest&ML_FILE  && (flags&ML_DIS)==0 ) {
+            mthread_mutex_lock(&s_mlog_file_mutex);
             int wbytes=0;
             // print message to buffer
             va_copy(cargs,args);
@@ -1452,6 +1460,7 @@ int mlog_printf(mlog_id_t id, char *fmt, ...)
             }
             // va_end added per cppcheck - delete if issues
             va_end(cargs);
+            mthread_mutex_unlock(&s_mlog_file_mutex);
      }
 //        else{
 //            fprintf(stderr,"file output disabled d[%0X] f[%0X]\n",dest,flags);
@@ -1511,6 +1520,7 @@ int mlog_vprintf(mlog_id_t id, char *fmt, va_list args)
         //        fprintf(stderr,"dest[%x]&ML_SOUT[%x]\n",dest,(dest&ML_SOUT));
 
         if (dest&ML_FILE  && (flags&ML_DIS)==0 ) {
+            mthread_mutex_lock(&s_mlog_file_mutex);
             int wbytes=0;
             // print message to buffer
             va_copy(cargs,args);
@@ -1530,6 +1540,7 @@ int mlog_vprintf(mlog_id_t id, char *fmt, va_list args)
             }
             // va_end added per cppcheck - delete if issues
             va_end(cargs);
+            mthread_mutex_unlock(&s_mlog_file_mutex);
         }
         //        else{
         //            fprintf(stderr,"file output disabled d[%0X] f[%0X]\n",dest,flags);
@@ -1605,6 +1616,7 @@ int mlog_tprintf(mlog_id_t id, const char *fmt, ...)
 //        fprintf(stderr,"mask[%x]&TL_SOUT[%x]\n",strmask,(strmask&TL_SOUT));
         
         if (dest&ML_FILE  && (flags&ML_DIS)==0 ) {
+            mthread_mutex_lock(&s_mlog_file_mutex);
         	int wbytes=0;
             // print message to buffer
             va_copy(cargs,args);
@@ -1629,6 +1641,7 @@ int mlog_tprintf(mlog_id_t id, const char *fmt, ...)
             }
             // va_end added per cppcheck - delete if issues
             va_end(cargs);
+            mthread_mutex_unlock(&s_mlog_file_mutex);
         }
 //        else{
 //            fprintf(stderr,"file output disabled d[%0X] f[%0X]\n",dest,flags);
@@ -1707,6 +1720,7 @@ int mlog_vtprintf(mlog_id_t id, const char *fmt, va_list args)
         //        fprintf(stderr,"mask[%x]&TL_SOUT[%x]\n",strmask,(strmask&TL_SOUT));
 
         if (dest&ML_FILE  && (flags&ML_DIS)==0 ) {
+            mthread_mutex_lock(&s_mlog_file_mutex);
             int wbytes=0;
             // print message to buffer
             va_copy(cargs,args);
@@ -1731,6 +1745,7 @@ int mlog_vtprintf(mlog_id_t id, const char *fmt, va_list args)
             }
             // va_end added per cppcheck - delete if issues
             va_end(cargs);
+            mthread_mutex_unlock(&s_mlog_file_mutex);
         }
         //        else{
         //            fprintf(stderr,"file output disabled d[%0X] f[%0X]\n",dest,flags);
@@ -1807,6 +1822,7 @@ int mlog_xtprintf(mlog_id_t id, const char *channel, int level, const char *fmt,
         //        fprintf(stderr,"mask[%x]&TL_SOUT[%x]\n",strmask,(strmask&TL_SOUT));
 
         if (dest&ML_FILE  && (flags&ML_DIS)==0 ) {
+            mthread_mutex_lock(&s_mlog_file_mutex);
             int wbytes=0;
             // print message to buffer
             va_copy(cargs,args);
@@ -1831,6 +1847,7 @@ int mlog_xtprintf(mlog_id_t id, const char *channel, int level, const char *fmt,
             }
             // va_end added per cppcheck - delete if issues
             va_end(cargs);
+            mthread_mutex_unlock(&s_mlog_file_mutex);
         }
 
         // send to stderr, stdout
@@ -1906,6 +1923,7 @@ int mlog_vxtprintf(mlog_id_t id, const char *channel, int level, const char *fmt
         //        fprintf(stderr,"mask[%x]&TL_SOUT[%x]\n",strmask,(strmask&TL_SOUT));
 
         if (dest&ML_FILE  && (flags&ML_DIS)==0 ) {
+            mthread_mutex_lock(&s_mlog_file_mutex);
             int wbytes=0;
             // print message to buffer
             va_copy(cargs,args);
@@ -1930,6 +1948,7 @@ int mlog_vxtprintf(mlog_id_t id, const char *channel, int level, const char *fmt
             }
             // va_end added per cppcheck - delete if issues
             va_end(cargs);
+            mthread_mutex_unlock(&s_mlog_file_mutex);
         }
 
         // send to stderr, stdout
@@ -2308,6 +2327,7 @@ int mlog_write(mlog_id_t id, byte *data, uint32_t len)
         mlog_oset_t dest = log->cfg->dest;
         mlog_flags_t flags = log->cfg->flags;
         if (dest&ML_FILE  && (flags&ML_DIS)==0 ) {
+            mthread_mutex_lock(&s_mlog_file_mutex);
             
             if ( (log->cfg->lim_b > 0) && (log->seg_len+len) > log->cfg->lim_b) {
                 // if segment length is limited and write would overflow,
@@ -2349,6 +2369,7 @@ int mlog_write(mlog_id_t id, byte *data, uint32_t len)
             }
         }else{
             fprintf(stderr,"file output disabled d[%0X] f[%0X]\n",dest,flags);
+            mthread_mutex_unlock(&s_mlog_file_mutex);
         }
     }
     return retval;
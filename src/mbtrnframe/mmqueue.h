@@ -6,6 +6,9 @@
 /// Wrappers for queue and list functions in sys/queue.h.
 /// These are fast, but a little cumbersome to use.
 /// For most applications, use mlist and mcbuf
+/// The add macros malloc an entry per item; for bounded hand-off
+/// between threads, mcbuf_spsc_t and mcbuf_mpsc_t (mcbuf.h) use
+/// preallocated slots and no locks.
 
 /// Defines a naming convention used to
 /// eliminate some of the arguments needed by the queue.h macros:
@@ -122,6 +122,8 @@ mstats_t *mstats_new(uint32_t ev_counters, uint32_t st_counters, uint32_t met_ch
         self->events    = (uint32_t *)malloc(ev_counters*sizeof(double));
         self->status    = (uint32_t *)malloc(st_counters*sizeof(double));
         self->metrics    = (mstats_metric_t *)malloc(met_channels*sizeof(mstats_metric_t));
+        self->per_hist  = (mstats_hist_t *)malloc(met_channels*sizeof(mstats_hist_t));
+        self->agg_hist  = (mstats_hist_t *)malloc(met_channels*sizeof(mstats_hist_t));
         
         self->stat_period_start = 0.0;
         self->stat_period_sec   = 0.0;
@@ -131,6 +133,8 @@ mstats_t *mstats_new(uint32_t ev_counters, uint32_t st_counters, uint32_t met_ch
         memset(self->events,       0, ev_counters*sizeof(uint32_t));
         memset(self->status,       0, st_counters*sizeof(uint32_t));
         memset(self->metrics, 0, met_channels*sizeof(mstats_metric_t));
+        memset(self->per_hist,     0, met_channels*sizeof(mstats_hist_t));
+        memset(self->agg_hist,     0, met_channels*sizeof(mstats_hist_t));
     }
     return self;
 }
@@ -148,6 +152,8 @@ void mstats_destroy(mstats_t **pself)
         free(self->metrics);
         free(self->per_stats);
         free(self->agg_stats);
+        free(self->per_hist);
+        free(self->agg_hist);
         free(self);
         *pself=NULL;
     }
@@ -227,6 +233,39 @@ int mstats_log_counts(mlog_id_t log_id, uint32_t *counts, double timestamp, char
 }
 // End function mstats_log_counts
 
+/// @fn int mstats_log_pctl(mlog_id_t log_id, mstats_hist_t *hist, double timestamp, char *type_str, const char **labels, int channels)
+/// @brief log latency percentiles (p50, p90, p99, p99.9)
+/// @param[in] log_id log ID
+/// @param[in] hist pointer to channel histograms
+/// @param[in] timestamp time
+/// @param[in] type_str channel type string
+/// @param[in] labels pointer to channel labels
+/// @param[in] channels number of channels
+/// @return 0 on success, -1 otherwise
+int mstats_log_pctl(mlog_id_t log_id, mstats_hist_t *hist, double timestamp, char *type_str, const char **labels, int channels)
+{
+    int retval=-1;
+    if (NULL!=hist && NULL!=labels && channels>0) {
+        int i=0;
+        for (i=0; i<channels ; i++){
+            mstats_pctl_t pctl={0};
+            mstats_hist_pctl(&hist[i],&pctl);
+            mlog_tprintf(log_id,"%.3lf,%s,%s,%"PRIu64",%1.3g,%1.3g,%1.3g,%1.3g\n",
+                         timestamp,
+                         type_str,
+                         labels[i],
+                         pctl.n,
+                         pctl.p50,
+                         pctl.p90,
+                         pctl.p99,
+                         pctl.p999);
+        }
+        retval=0;
+    }
+    return retval;
+}
+// End function mstats_log_pctl
+
 /// @fn int mstats_log_stats(mstats_t *stats, double now, mlog_id_t log_id, mstats_flags flags)
 /// @brief log statistics
 /// @param[in] stats mstats_stats reference
@@ -250,10 +289,18 @@ int mstats_log_stats(mstats_t *stats, double now, mlog_id_t log_id, mstats_flags
         if (flags&MSF_PSTAT) {
             // log period stats
             mstats_log_timing( log_id, stats->per_stats, now, "p", stats->labels[MSLABEL_METRIC],  stats->metric_n);
+            if (flags&MSF_PCTL) {
+                // log period percentiles
+                mstats_log_pctl( log_id, stats->per_hist, now, "pq", stats->labels[MSLABEL_METRIC],  stats->metric_n);
+            }
         }
         if (flags&MSF_ASTAT) {
             // log aggregate statistics
             mstats_log_timing( log_id, stats->agg_stats, now, "a", stats->labels[MSLABEL_METRIC],  stats->metric_n);
+            if (flags&MSF_PCTL) {
+                // log aggregate percentiles
+                mstats_log_pctl( log_id, stats->agg_hist, now, "aq", stats->labels[MSLABEL_METRIC],  stats->metric_n);
+            }
         }
         retval=0;
     }
@@ -271,6 +318,10 @@ void mstats_reset_pstats(mstats_t *stats, uint32_t channels)
     if (NULL != stats && channels>0) {
         // reset periodic stats
         memset(stats->per_stats,0,(channels*sizeof(mstats_metstats_t)));
+        uint32_t i=0;
+        for (i=0; i<channels ; i++){
+            mstats_hist_reset(&stats->per_hist[i]);
+        }
     }
 }
 // End function mstats_reset_pstats
@@ -313,6 +364,12 @@ int mstats_update_stats(mstats_t *stats, uint32_t channels, mstats_flags flags)
                 stats->agg_stats[i].min =stats->metrics[i].value;
                 stats->agg_stats[i].max =stats->metrics[i].value;
             }
+
+            // update latency histograms
+            if (flags&MSF_PCTL) {
+                mstats_hist_record(&stats->per_hist[i], stats->metrics[i].value);
+                mstats_hist_record(&stats->agg_hist[i], stats->metrics[i].value);
+            }
         }
         
         // reset measurement values
@@ -327,6 +384,170 @@ int mstats_update_stats(mstats_t *stats, uint32_t channels, mstats_flags flags)
 }
 // End function mstats_update_stats
 
+/// @fn int s_hist_index(uint64_t v)
+/// @brief map value to log-linear bucket index.
+/// Values below MSTATS_HIST_SUB_COUNT map linearly; above that, each
+/// power-of-two range [2^k, 2^(k+1)) is split into MSTATS_HIST_SUB_HALF
+/// buckets using the MSTATS_HIST_SUB_BITS bits below the MSB.
+/// @param[in] v value (histogram units)
+/// @return bucket index
+static int s_hist_index(uint64_t v)
+{
+    if (v < MSTATS_HIST_SUB_COUNT) {
+        return (int)v;
+    }
+    int msb = 63 - __builtin_clzll(v);
+    if (msb > MSTATS_HIST_MSB_MAX) {
+        return MSTATS_HIST_BUCKETS-1;
+    }
+    int shift = msb - (MSTATS_HIST_SUB_BITS-1);
+    int sub = (int)(v >> shift) - MSTATS_HIST_SUB_HALF;
+    return (shift+1)*MSTATS_HIST_SUB_HALF + sub;
+}
+// End function s_hist_index
+
+/// @fn double s_hist_bucket_value(int idx)
+/// @brief return representative (midpoint) value of a bucket
+/// @param[in] idx bucket index
+/// @return bucket midpoint (histogram units)
+static double s_hist_bucket_value(int idx)
+{
+    if (idx < MSTATS_HIST_SUB_COUNT) {
+        return (double)idx;
+    }
+    int shift = idx/MSTATS_HIST_SUB_HALF - 1;
+    int sub = idx%MSTATS_HIST_SUB_HALF + MSTATS_HIST_SUB_HALF;
+    double lo = ldexp((double)sub, shift);
+    return lo + 0.5*ldexp(1.0, shift);
+}
+// End function s_hist_bucket_value
+
+/// @fn void mstats_hist_reset(mstats_hist_t *self)
+/// @brief clear histogram counts
+/// @param[in] self histogram reference
+/// @return none
+void mstats_hist_reset(mstats_hist_t *self)
+{
+    if (NULL!=self) {
+        int i=0;
+        for (i=0; i<MSTATS_HIST_BUCKETS; i++) {
+            __atomic_store_n(&self->bucket[i], 0, __ATOMIC_RELAXED);
+        }
+    }
+}
+// End function mstats_hist_reset
+
+/// @fn void mstats_hist_record(mstats_hist_t *self, double value)
+/// @brief record a value (metric units, e.g. seconds).
+/// Lock-free; may be called concurrently from multiple threads.
+/// Negative values are recorded as zero.
+/// @param[in] self histogram reference
+/// @param[in] value value to record
+/// @return none
+void mstats_hist_record(mstats_hist_t *self, double value)
+{
+    if (NULL!=self) {
+        double hv = value*MSTATS_HIST_UNITS;
+        uint64_t v = 0;
+        if (hv >= 18446744073709551615.0) {
+            v = UINT64_MAX;
+        } else if (hv > 0.0) {
+            v = (uint64_t)hv;
+        }
+        __atomic_fetch_add(&self->bucket[s_hist_index(v)], 1, __ATOMIC_RELAXED);
+    }
+}
+// End function mstats_hist_record
+
+/// @fn uint64_t mstats_hist_count(mstats_hist_t *self)
+/// @brief return number of recorded values
+/// @param[in] self histogram reference
+/// @return sample count
+uint64_t mstats_hist_count(mstats_hist_t *self)
+{
+    uint64_t retval=0;
+    if (NULL!=self) {
+        int i=0;
+        for (i=0; i<MSTATS_HIST_BUCKETS; i++) {
+            retval += __atomic_load_n(&self->bucket[i], __ATOMIC_RELAXED);
+        }
+    }
+    return retval;
+}
+// End function mstats_hist_count
+
+/// @fn double mstats_hist_value_at(mstats_hist_t *self, double pct)
+/// @brief return value at percentile
+/// @param[in] self histogram reference
+/// @param[in] pct percentile (0.0-100.0)
+/// @return value (metric units) at percentile, or 0.0 if histogram is empty
+double mstats_hist_value_at(mstats_hist_t *self, double pct)
+{
+    double retval=0.0;
+    uint64_t n = mstats_hist_count(self);
+    if (n>0) {
+        double p = (pct<0.0 ? 0.0 : (pct>100.0 ? 100.0 : pct));
+        uint64_t rank = (uint64_t)ceil(p/100.0*(double)n);
+        uint64_t cum = 0;
+        int i=0;
+        if (rank<1) rank=1;
+        for (i=0; i<MSTATS_HIST_BUCKETS-1; i++) {
+            cum += __atomic_load_n(&self->bucket[i], __ATOMIC_RELAXED);
+            if (cum >= rank) {
+                break;
+            }
+        }
+        retval = s_hist_bucket_value(i)/MSTATS_HIST_UNITS;
+    }
+    return retval;
+}
+// End function mstats_hist_value_at
+
+/// @fn int mstats_hist_pctl(mstats_hist_t *self, mstats_pctl_t *dest)
+/// @brief compute p50, p90, p99, p99.9 in one pass
+/// @param[in] self histogram reference
+/// @param[out] dest percentile results
+/// @return 0 on success, -1 otherwise
+int mstats_hist_pctl(mstats_hist_t *self, mstats_pctl_t *dest)
+{
+    int retval=-1;
+    if (NULL!=self && NULL!=dest) {
+        static const double pct[4]={50.0, 90.0, 99.0, 99.9};
+        double *out[4]={&dest->p50, &dest->p90, &dest->p99, &dest->p999};
+        uint64_t counts[MSTATS_HIST_BUCKETS];
+        uint64_t n=0;
+        int i=0;
+
+        // snapshot counts so percentiles are consistent
+        for (i=0; i<MSTATS_HIST_BUCKETS; i++) {
+            counts[i] = __atomic_load_n(&self->bucket[i], __ATOMIC_RELAXED);
+            n += counts[i];
+        }
+        memset(dest,0,sizeof(mstats_pctl_t));
+        dest->n = n;
+
+        if (n>0) {
+            uint64_t cum=0;
+            int k=0;
+            for (i=0; i<MSTATS_HIST_BUCKETS && k<4; i++) {
+                cum += counts[i];
+                while (k<4) {
+                    uint64_t rank = (uint64_t)ceil(pct[k]/100.0*(double)n);
+                    if (rank<1) rank=1;
+                    if (cum<rank) {
+                        break;
+                    }
+                    *out[k] = s_hist_bucket_value(i)/MSTATS_HIST_UNITS;
+                    k++;
+                }
+            }
+        }
+        retval=0;
+    }
+    return retval;
+}
+// End function mstats_hist_pctl
+
 mstats_profile_t *mstats_profile_new(uint32_t ev_counters, uint32_t status_counters, uint32_t tm_channels, const char ***channel_labels, double pstart, double psec)
 {
     mstats_profile_t *self =(mstats_profile_t *)malloc(sizeof(mstats_profile_t));
@@ -594,12 +815,36 @@ int mstats_test()
         // periodic stats are only logged when the period timer expires.
         // A macro is used instead of calling the function directly, so that
         // it (and all mstats code) may be compiled out with a single macro definition
-        UPDATE_STATS(stats,MLOG_ID,(MSF_STATUS|MSF_EVENT|MSF_PSTAT|MSF_ASTAT));
+        UPDATE_STATS(stats,MLOG_ID,(MSF_STATUS|MSF_EVENT|MSF_PSTAT|MSF_ASTAT|MSF_PCTL));
         
     }
     
     if(g_mstat_test_quit==false)
         retval=0;
+
+    // check histogram percentiles against a known distribution
+    // (1..1000 usec, uniform); buckets are accurate to ~3%
+    {
+        mstats_hist_t *hist=(mstats_hist_t *)malloc(sizeof(mstats_hist_t));
+        mstats_pctl_t pctl={0};
+        int i=0;
+        mstats_hist_reset(hist);
+        for(i=1;i<=1000;i++){
+            mstats_hist_record(hist,(double)i*1.0e-6);
+        }
+        mstats_hist_pctl(hist,&pctl);
+        mlog_tprintf(MLOG_ID,"hist n[%"PRIu64"] p50[%.3g] p90[%.3g] p99[%.3g] p999[%.3g]\n",
+                     pctl.n,pctl.p50,pctl.p90,pctl.p99,pctl.p999);
+        if(pctl.n!=1000 ||
+           fabs(pctl.p50-500.0e-6)>(0.04*500.0e-6) ||
+           fabs(pctl.p90-900.0e-6)>(0.04*900.0e-6) ||
+           fabs(pctl.p99-990.0e-6)>(0.04*990.0e-6) ||
+           fabs(mstats_hist_value_at(hist,99.0)-pctl.p99)>1.0e-12){
+            fprintf(stderr,"mstats histogram check failed\n");
+            retval=-1;
+        }
+        free(hist);
+    }
     
     // close log
     mlog_close(MLOG_ID);
@@ -30,6 +30,8 @@
 /// - typically, an update function and macro wrapper (to allow it to be compiled out) are defined
 ///   to update periodic stats, and direct output
 /// - in application code, use the macros to gather statistics, and call the update function(s)
+/// - set MSF_PCTL (with MSF_PSTAT and/or MSF_ASTAT) to log latency percentiles (p50/p90/p99/p99.9)
+///   from the per-channel log-linear histograms
 
 /// @sa doxygen-examples.c for more examples of Doxygen markup
 /// @sa mlog, mfile, mthread, mtime, mdebug
@@ -176,6 +178,7 @@
 #define MST_METRIC_LAP(w,t)
 #define MST_METRIC_REC(w)
 #define MST_METRIC_DIV(w,n)
+#define MST_METRIC_SET(w,t)
 #define MST_METRIC_RESET(w)
 #define MST_METRIC_ELAPSED(w)          0.0
 
@@ -190,6 +193,28 @@
 #define MST_STATS_AVG(v)           0.0
 #endif //MST_STATS_EN
 
+/// @def MSTATS_HIST_SUB_BITS
+/// @brief latency histogram sub-bucket resolution (bits).
+/// Each power-of-two range is divided into 2^(SUB_BITS-1)
+/// linear sub-buckets, i.e. relative error <= 2^-(SUB_BITS-1) (~3%)
+#define MSTATS_HIST_SUB_BITS 5
+/// @def MSTATS_HIST_SUB_COUNT
+/// @brief number of linear buckets below the first log range
+#define MSTATS_HIST_SUB_COUNT (1<<MSTATS_HIST_SUB_BITS)
+/// @def MSTATS_HIST_SUB_HALF
+/// @brief sub-buckets per power-of-two range
+#define MSTATS_HIST_SUB_HALF (MSTATS_HIST_SUB_COUNT>>1)
+/// @def MSTATS_HIST_MSB_MAX
+/// @brief highest tracked value bit; larger values are clamped
+/// (2^48 ns ~ 78 hours)
+#define MSTATS_HIST_MSB_MAX 47
+/// @def MSTATS_HIST_BUCKETS
+/// @brief number of latency histogram buckets
+#define MSTATS_HIST_BUCKETS ((MSTATS_HIST_MSB_MAX-MSTATS_HIST_SUB_BITS+2)*MSTATS_HIST_SUB_HALF+MSTATS_HIST_SUB_HALF)
+/// @def MSTATS_HIST_UNITS
+/// @brief histogram value units per metric unit (metrics in s, histogram in ns)
+#define MSTATS_HIST_UNITS 1.0e9
+
 /////////////////////////
 // Type Definitions
 /////////////////////////
@@ -232,13 +257,45 @@ typedef struct mstats_metric_s
     double value;
 }mstats_metric_t;
 
+/// @typedef struct mstats_hist_s mstats_hist_t
+/// @brief log-linear (HDR-style) latency histogram.
+/// Buckets are updated using atomic increments, so values
+/// may be recorded concurrently without locking.
+typedef struct mstats_hist_s
+{
+    /// @var mstats_hist_s::bucket
+    /// @brief bucket counts
+    uint64_t bucket[MSTATS_HIST_BUCKETS];
+}mstats_hist_t;
+
+/// @typedef struct mstats_pctl_s mstats_pctl_t
+/// @brief latency percentiles
+typedef struct mstats_pctl_s
+{
+    /// @var mstats_pctl_s::n
+    /// @brief number of samples
+    uint64_t n;
+    /// @var mstats_pctl_s::p50
+    /// @brief 50th percentile (median)
+    double p50;
+    /// @var mstats_pctl_s::p90
+    /// @brief 90th percentile
+    double p90;
+    /// @var mstats_pctl_s::p99
+    /// @brief 99th percentile
+    double p99;
+    /// @var mstats_pctl_s::p999
+    /// @brief 99.9th percentile
+    double p999;
+}mstats_pctl_t;
+
 /// @typedef enum uint32_t mstats_counter_t
 /// @brief diagnostic integer status type
 typedef uint32_t mstats_counter_t;
 
 /// @typedef enum mstats_flags mstats_flags
 /// @brief diagnostic category types
-typedef enum {MSF_STATUS=0x1, MSF_EVENT=0x2, MSF_PSTAT=0x4, MSF_ASTAT=0x8, MSF_READER=0x10}mstats_flags;
+typedef enum {MSF_STATUS=0x1, MSF_EVENT=0x2, MSF_PSTAT=0x4, MSF_ASTAT=0x8, MSF_READER=0x10, MSF_PCTL=0x20}mstats_flags;
 
 /// @typedef enum mstats_label_id mstats_label_id
 /// @brief diagnostic label category types. Used to index label sets in mstats_t.labels
@@ -277,6 +334,12 @@ typedef struct mstats_s{
     /// @var mstats_s::agg_stats
     /// @brief aggregate (cumulative) stats
     mstats_metstats_t *agg_stats;
+    /// @var mstats_s::per_hist
+    /// @brief periodic latency histograms
+    mstats_hist_t *per_hist;
+    /// @var mstats_s::agg_hist
+    /// @brief aggregate (cumulative) latency histograms
+    mstats_hist_t *agg_hist;
     /// @var mstats_s::labels
     /// @brief metric channel labels
     const char ***labels;
@@ -308,6 +371,12 @@ extern "C" {
     int mstats_log_stats(mstats_t *stats, double now, mlog_id_t log_id, mstats_flags flags);
     int mstats_log_timing(mlog_id_t log_id, mstats_metstats_t *stats,  double timestamp, char *type_str, const char **labels, int channels);
     int mstats_log_counts(mlog_id_t log_id, uint32_t *counts, double timestamp, char *type_str, const char **labels, int channels);
+    int mstats_log_pctl(mlog_id_t log_id, mstats_hist_t *hist, double timestamp, char *type_str, const char **labels, int channels);
+    void mstats_hist_reset(mstats_hist_t *self);
+    void mstats_hist_record(mstats_hist_t *self, double value);
+    uint64_t mstats_hist_count(mstats_hist_t *self);
+    double mstats_hist_value_at(mstats_hist_t *self, double pct);
+    int mstats_hist_pctl(mstats_hist_t *self, mstats_pctl_t *dest);
     double mstats_dtime();
     mstats_profile_t *mstats_profile_new(uint32_t ev_counters, uint32_t status_counters, uint32_t tm_channels, const char ***channel_labels, double pstart, double psec);
 void mstats_profile_destroy(mstats_profile_t **pself);
@@ -67,6 +67,10 @@
   3) add points to the octree
   4) fill the octree cell(s) below the added points
   5) compress the octree
+
+  Steps 3-5 use the bulk Octree functions, which sort the points by Morton code and build
+  subtrees in parallel (--threads). The tree is identical to the one made by adding and
+  filling one point at a time; --benchmark builds it both ways and compares them.
 */
 
 /*! Reducing the area of the resulting octree:
@@ -114,11 +118,17 @@ std::cout << "X: " << numXValues << "\tY: " << numYValues << "\tXfirst: " << xIn
 */
 
 /*--------------------------------------------------------------------*/
+#include <chrono>
+#include <cstring>
 #include <iostream>
+#include <vector>
 #include <fcntl.h>
+#include <sys/resource.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
 #include <getopt.h>
+#include <unistd.h>
 #include "mapio.h"
 #include <netcdf.h>
 #include "OctreeSupport.hpp"
@@ -143,10 +153,10 @@ constexpr char usage_message[] =
     "\t--verbose\n"
     "\t--help\n\n"
     "\t--input=input_grid\n"
-    "\t--output=output_root\n\n"
-    "\t--tile-dimension=tile_dimension\n"
-    "\t--tile-mode=mode\n\n"
-    "\t--tile-spacing=tile_spacing\n\n";
+    "\t--output=output_octree\n"
+    "\t--bounds=west/east/south/north\n"
+    "\t--threads=threads\n"
+    "\t--benchmark\n\n";
 
 #define X_INDEX_FIRST 1
 
@@ -162,6 +172,99 @@ constexpr char usage_message[] =
 
 int setupXYZ(double** xValues, double** yValues, zGrid& zValues, char *inFile );
 
+/*--------------------------------------------------------------------*/
+/* Add the grid points to the octree, fill below them and compress, either
+   one point at a time or in bulk on num_threads threads */
+static void build_octree(Octree<bool> &octree, const std::vector<Vector> &points, bool bulk, int num_threads) {
+  // Points are filled below if shallower than 3000 m
+  const Vector TrueResolution = octree.GetTrueResolution();
+  std::vector<Vector> fill_points;
+  fill_points.reserve(FILL_NUMBER * points.size());
+  for (const Vector &point : points) {
+    if (point.z < 3000) {
+      double zToFill = point.z + TrueResolution.z;
+      for (int jj = 0; jj < FILL_NUMBER; jj++) {
+        fill_points.push_back(Vector(point.x, point.y, zToFill));
+        zToFill += TrueResolution.z;
+      }
+    }
+  }
+
+  if (bulk) {
+    octree.AddPoints(points.data(), points.size(), num_threads);
+    octree.FillSmallestResolutionLeavesAtPointsIfEmpty(fill_points.data(), fill_points.size(), true, num_threads);
+    octree.Collapse(num_threads);
+  } else {
+    for (const Vector &point : points)
+      octree.AddPoint(point);
+    for (const Vector &point : fill_points)
+      octree.FillSmallestResolutionLeafAtPointIfEmpty(point, true);
+    octree.Collapse();
+  }
+}
+
+/*--------------------------------------------------------------------*/
+/* Build the octree one point at a time and in bulk, each in a child process
+   so that the peak memory use of each is known, report the rate and peak
+   memory of each and check that the two trees are identical */
+static int benchmark_octree(const Vector &resolution, const Vector &LowerBounds, const Vector &UpperBounds,
+                            const std::vector<Vector> &points, int num_threads, const char *outFile) {
+  const char *mode_name[2] = {"serial", "bulk"};
+  std::string tree_file[2] = {std::string(outFile) + ".serial", std::string(outFile)};
+  for (int mode = 0; mode < 2; mode++) {
+    fflush(nullptr);
+    const pid_t pid = fork();
+    if (pid < 0) {
+      fprintf(stderr, "Unable to fork benchmark process\n");
+      return MB_FAILURE;
+    } else if (pid == 0) {
+      const auto start = std::chrono::steady_clock::now();
+      Octree<bool> octree(resolution, LowerBounds, UpperBounds, OctreeType::BinaryOccupancy);
+      build_octree(octree, points, mode == 1, num_threads);
+      const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      octree.SaveToFile(tree_file[mode].c_str());
+      struct rusage usage;
+      getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+      const double peak_mb = usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+      const double peak_mb = usage.ru_maxrss / 1024.0;
+#endif
+      fprintf(outfp, "Benchmark %-6s build: %10zu points in %8.3f s  %12.0f points/s  peak memory %10.1f MB\n",
+              mode_name[mode], points.size(), elapsed.count(), points.size() / elapsed.count(), peak_mb);
+      fflush(nullptr);
+      _exit(0);
+    }
+    int wait_status = 0;
+    waitpid(pid, &wait_status, 0);
+    if (!WIFEXITED(wait_status) || WEXITSTATUS(wait_status) != 0) {
+      fprintf(stderr, "Benchmark %s build failed\n", mode_name[mode]);
+      return MB_FAILURE;
+    }
+  }
+
+  // Compare the saved trees
+  bool identical = false;
+  FILE *fp[2] = {fopen(tree_file[0].c_str(), "rb"), fopen(tree_file[1].c_str(), "rb")};
+  if (fp[0] != nullptr && fp[1] != nullptr) {
+    char buffer[2][65536];
+    size_t n[2];
+    do {
+      n[0] = fread(buffer[0], 1, sizeof(buffer[0]), fp[0]);
+      n[1] = fread(buffer[1], 1, sizeof(buffer[1]), fp[1]);
+      identical = n[0] == n[1] && memcmp(buffer[0], buffer[1], n[0]) == 0;
+    } while (identical && n[0] > 0);
+  }
+  for (int mode = 0; mode < 2; mode++)
+    if (fp[mode] != nullptr)
+      fclose(fp[mode]);
+  remove(tree_file[0].c_str());
+  fprintf(outfp, "Benchmark serial and bulk octrees are %s\n", identical ? "identical" : "DIFFERENT");
+
+  return (identical ? MB_SUCCESS : MB_FAILURE);
+}
+/*--------------------------------------------------------------------*/
+
 int main( int argc, char **argv )
 {
   int verbose = 0;
@@ -170,12 +273,17 @@ int main( int argc, char **argv )
   mb_path outFile;
   double bounds[4];
   bool bounds_set = false;
+  int num_threads = 0;
+  bool benchmark = false;
 
   static struct option options[] = {{"verbose", no_argument, nullptr, 0},
                                     {"help", no_argument, nullptr, 0},
                                     {"bounds", required_argument, nullptr, 0},
                                     {"input", required_argument, nullptr, 0},
-                                    {"output", required_argument, nullptr, 0}};
+                                    {"output", required_argument, nullptr, 0},
+                                    {"threads", required_argument, nullptr, 0},
+                                    {"benchmark", no_argument, nullptr, 0},
+                                    {nullptr, 0, nullptr, 0}};
 
   int option_index;
   bool errflg = false;
@@ -229,6 +337,17 @@ int main( int argc, char **argv )
           bounds_set = true;
         }
       }
+      else if (strcmp("threads", options[option_index].name) == 0) {
+        const int n = sscanf(optarg, "%d", &num_threads);
+        if (n != 1 || num_threads < 0) {
+          fprintf(stderr, "Failed to parse argument: %s=%s\nProgram %s terminated\n",
+                  options[option_index].name, optarg, program_name);
+          exit(MB_ERROR_BAD_PARAMETER);
+        }
+      }
+      else if (strcmp("benchmark", options[option_index].name) == 0) {
+        benchmark = true;
+      }
       break;
     /*-------------------------------------------------------*/
     /* short options */
@@ -293,6 +412,8 @@ int main( int argc, char **argv )
       fprintf(outfp, "dbg2       bounds[2]:            %f\n", bounds[2]);
       fprintf(outfp, "dbg2       bounds[3]:            %f\n", bounds[3]);
     }
+    fprintf(outfp, "dbg2       num_threads:          %d\n", num_threads);
+    fprintf(outfp, "dbg2       benchmark:            %d\n", benchmark);
   }
 
   if (help) {
@@ -378,19 +499,12 @@ int main( int argc, char **argv )
   Vector LowerBounds = Lowermost - DesiredResolution * 0.5;
   Vector UpperBounds = LowerBounds + OctreeSize;
 
-  //initialize octree
-  //printf("about to build Octree\n");
-  Octree<bool> newOctreeMap(DesiredResolution + Vector(0.001,0.001,0.001),
-                            LowerBounds, UpperBounds, OctreeType::BinaryOccupancy);
-
-  // Add points
-  int countPointsAdded = 0;
+  // Get the points to add
+  std::vector<Vector> points;
   for(unsigned int xIndex = 0; xIndex < zValues.numXValues; xIndex++){
     for(unsigned int yIndex = 0; yIndex < zValues.numYValues; yIndex++){
       if(zValues.getZ(xIndex, yIndex) != 99999 && !isnan(zValues.getZ(xIndex, yIndex))){
         if(zValues.getZ(xIndex, yIndex) <= 4000){
-          point = Vector( xValues[xIndex], yValues[yIndex], zValues.getZ(xIndex, yIndex));
-
           //test bounds
           if((north_bound != -1) && (xValues[xIndex] > north_bound)){continue;}
           if((south_bound != -1) && (xValues[xIndex] < south_bound)){continue;}
@@ -399,41 +513,25 @@ int main( int argc, char **argv )
           if((MAX_ACCEPTED_DEPTH != -1) && (zValues.getZ(xIndex, yIndex) > MAX_ACCEPTED_DEPTH)){continue;}
           if((MIN_ACCEPTED_DEPTH != -1) && (zValues.getZ(xIndex, yIndex) < MIN_ACCEPTED_DEPTH)){continue;}
 
-          countPointsAdded ++;
-          newOctreeMap.AddPoint(point);
+          points.push_back(Vector( xValues[xIndex], yValues[yIndex], zValues.getZ(xIndex, yIndex)));
         }
       }
     }
   }
-  Vector TrueResolution = newOctreeMap.GetTrueResolution();
 
-  //fill below input points
-  for(unsigned int xIndex = 0; xIndex < zValues.numXValues; xIndex++){
-    for(unsigned int yIndex = 0; yIndex < zValues.numYValues; yIndex++){
-      if((zValues.getZ(xIndex, yIndex) != 99999) && (!isnan(zValues.getZ(xIndex, yIndex))) && (zValues.getZ(xIndex, yIndex) < 3000)) {
-        //test bounds
-        if((north_bound != -1) && (xValues[xIndex] > north_bound)){continue;}
-        if((south_bound != -1) && (xValues[xIndex] < south_bound)){continue;}
-        if((east_bound != -1) && (yValues[yIndex] > east_bound)){continue;}
-        if((west_bound != -1) && (yValues[yIndex] < west_bound)){continue;}
-        if((MAX_ACCEPTED_DEPTH != -1) && (zValues.getZ(xIndex, yIndex) > MAX_ACCEPTED_DEPTH)){continue;}
-        if((MIN_ACCEPTED_DEPTH != -1) && (zValues.getZ(xIndex, yIndex) < MIN_ACCEPTED_DEPTH)){continue;}
-
-        point = Vector( xValues[xIndex], yValues[yIndex], zValues.getZ(xIndex, yIndex));
-
-        //fill
-        double zToFill = point.z + TrueResolution.z;
-        for(int jj = 0; jj < FILL_NUMBER; jj++){
-           newOctreeMap.FillSmallestResolutionLeafAtPointIfEmpty(Vector(point.x, point.y, zToFill),true);
-
-           zToFill += TrueResolution.z;
-        }
-      }
-    }
+  if (benchmark) {
+    status = benchmark_octree(DesiredResolution + Vector(0.001,0.001,0.001), LowerBounds, UpperBounds,
+                              points, num_threads, outFile);
+    delete[] xValues;
+    delete[] yValues;
+    delete[] zValues.zValues;
+    return (status == MB_SUCCESS ? 0 : 1);
   }
 
-  //compress
-  newOctreeMap.Collapse();
+  //initialize octree, add points, fill below them and compress
+  Octree<bool> newOctreeMap(DesiredResolution + Vector(0.001,0.001,0.001),
+                            LowerBounds, UpperBounds, OctreeType::BinaryOccupancy);
+  build_octree(newOctreeMap, points, true, num_threads);
 
   newOctreeMap.SaveToFile(outFile);
 
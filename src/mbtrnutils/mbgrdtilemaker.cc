@@ -25,13 +25,16 @@
   @file
  * MBgrdtilemaker creates a set of overlapping square grids from an original
  * topography grid. The grid tiles will have 50% overlap in all directions with
- * neighboring grids.
+ * neighboring grids. The input grid is read once, in bands of rows, and the
+ * tiles of each band are cut concurrently. Optional pyramid levels hold the
+ * same tiling of the grid decimated by 2, 4, 8, ... in subdirectories.
  *
  * Author:  D. W. Caress
  * Date:  June 11, 2022
  */
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
@@ -39,9 +42,12 @@
 #include <ctime>
 #include <getopt.h>
 #include <limits>
+#include <mutex>
+#include <string>
 #include <sys/stat.h>
 #include <thread>
 #include <unistd.h>
+#include <vector>
 
 #include "mb_aux.h"
 #include "mb_define.h"
@@ -65,9 +71,257 @@ constexpr char usage_message[] =
     "\t--output=output_root\n\n"
     "\t--tile-dimension=tile_dimension\n"
     "\t--tile-mode=mode\n\n"
-    "\t--tile-spacing=tile_spacing\n\n";
+    "\t--tile-spacing=tile_spacing\n\n"
+    "\t--pyramid-levels=levels\n"
+    "\t--threads=threads\n\n";
 
 /*--------------------------------------------------------------------*/
+/* A tileset cut from the input grid, or from the input grid decimated by
+ * 2^level for the pyramid levels */
+struct tileset {
+  int level;
+  int decimation;
+  int n_columns;
+  int n_rows;
+  float nodatavalue;
+  double xmin;
+  double xmax;
+  double ymin;
+  double ymax;
+  double dx;
+  double dy;
+  int tile_dimension;
+  double tile_width_x;
+  double tile_width_y;
+  double tile_spacing_x;
+  double tile_spacing_y;
+  int num_tiles_x;
+  int num_tiles_y;
+  mb_path directory;
+  mb_path tile_root;
+  mb_path projection_id;
+};
+
+/* Rows row0 to row0 + n_rows - 1 of a tileset grid held in memory, stored
+ * by column like the grid (k = i * n_rows + j - row0) */
+struct tileset_band {
+  int row0 = 0;
+  int n_rows = 0;
+  std::vector<float> data;
+};
+
+/*--------------------------------------------------------------------*/
+/* Load rows row0 to row1 of the tileset grid into the band, reading only
+ * the rows not already held from the previous band */
+static int load_band(int verbose, char *input_grid, const struct tileset &ts, int row0, int row1,
+                     struct tileset_band *band, int *error) {
+  int read0 = row0;
+  if (band->n_rows > 0 && row0 >= band->row0 && row0 < band->row0 + band->n_rows)
+    read0 = band->row0 + band->n_rows;
+
+  float *data = nullptr;
+  int n_rows = 0;
+  int status = MB_SUCCESS;
+  if (read0 <= row1) {
+    double wesn[4] = {ts.xmin, ts.xmax, ts.ymin + read0 * ts.dy, ts.ymin + row1 * ts.dy};
+    int projection_mode;
+    mb_path projection_id;
+    float nodatavalue;
+    int nxy, n_columns;
+    double min, max, xmin, xmax, ymin, ymax, dx, dy;
+    status = mb_read_gmt_grd_window(verbose, input_grid, wesn, ts.decimation, &projection_mode, projection_id,
+                                    &nodatavalue, &nxy, &n_columns, &n_rows, &min, &max, &xmin, &xmax, &ymin, &ymax,
+                                    &dx, &dy, &data, nullptr, nullptr, error);
+    if (status == MB_SUCCESS && (n_columns != ts.n_columns || n_rows != row1 - read0 + 1)) {
+      fprintf(stderr, "Read %d x %d nodes of grid %s rows %d to %d, expected %d x %d\n",
+              n_columns, n_rows, input_grid, read0, row1, ts.n_columns, row1 - read0 + 1);
+      mb_freed(verbose, __FILE__, __LINE__, (void **)&data, error);
+      *error = MB_ERROR_BAD_FORMAT;
+      return (MB_FAILURE);
+    }
+    if (status == MB_SUCCESS && nodatavalue != ts.nodatavalue) {
+      for (int k = 0; k < nxy; k++)
+        if (data[k] == nodatavalue)
+          data[k] = ts.nodatavalue;
+    }
+  }
+  if (status == MB_FAILURE)
+    return (status);
+
+  // Assemble the new band from the rows kept and the rows read
+  std::vector<float> band_data((size_t)ts.n_columns * (row1 - row0 + 1));
+  const int nkeep = read0 - row0;
+  const int nband = row1 - row0 + 1;
+  for (int i = 0; i < ts.n_columns; i++) {
+    if (nkeep > 0)
+      std::copy_n(&band->data[(size_t)i * band->n_rows + row0 - band->row0], nkeep, &band_data[(size_t)i * nband]);
+    if (n_rows > 0)
+      std::copy_n(&data[(size_t)i * n_rows], n_rows, &band_data[(size_t)i * nband + nkeep]);
+  }
+  band->row0 = row0;
+  band->n_rows = nband;
+  band->data.swap(band_data);
+  mb_freed(verbose, __FILE__, __LINE__, (void **)&data, error);
+
+  return (MB_SUCCESS);
+}
+/*--------------------------------------------------------------------*/
+/* Cut the tiles of a tileset, one row of tiles at a time from a band of
+ * the grid, cutting the tiles of a row concurrently. The grid writes go
+ * through GMT and netCDF, which are not thread safe, so only one tile is
+ * written at a time. */
+static int make_tileset(int verbose, char *input_grid, const struct tileset &ts, int num_threads, int argc,
+                        char **argv, std::vector<std::string> *octree_commands, int *error) {
+  mb_pathplus csv_file;
+  snprintf(csv_file, sizeof(csv_file), "%s/tiles.csv", ts.directory);
+  FILE *csv_fp = fopen(csv_file, "w");
+  if (csv_fp == nullptr) {
+    fprintf(stderr, "Unable to open tile list %s\n", csv_file);
+    *error = MB_ERROR_OPEN_FAIL;
+    return (MB_FAILURE);
+  }
+  fprintf(csv_fp, "TileName , Easting , Northing , %d\n", ts.num_tiles_x * ts.num_tiles_y);
+
+  const int tile_dimension = ts.tile_dimension;
+  struct tileset_band band;
+  std::mutex write_mutex;
+  int status = MB_SUCCESS;
+  for (int j = 0; j < ts.num_tiles_y && status == MB_SUCCESS; j++) {
+    const double tile_ymin = ts.ymin + j * ts.tile_spacing_y - 0.5 * ts.tile_spacing_y;
+    const int jj0 = (int)round((tile_ymin - ts.ymin) / ts.dy);
+    const int row0 = std::max(0, jj0);
+    const int row1 = std::min(ts.n_rows - 1, jj0 + tile_dimension - 1);
+    if (row0 <= row1)
+      status = load_band(verbose, input_grid, ts, row0, row1, &band, error);
+    if (status == MB_FAILURE)
+      break;
+
+    // Cut and write the tiles in this row
+    std::vector<std::string> csv_lines(ts.num_tiles_x);
+    std::vector<int> tile_status(ts.num_tiles_x, MB_SUCCESS);
+    std::atomic<int> next_tile(0);
+    auto cut_tiles = [&]() {
+      std::vector<float> tile_data((size_t)tile_dimension * tile_dimension);
+      for (int i = next_tile++; i < ts.num_tiles_x; i = next_tile++) {
+        const int itile = j * ts.num_tiles_x + i;
+        mb_pathplus tile_name;
+        mb_pathplusplus tile_grid;
+        mb_pathplusplus tile_bo;
+        mb_pathplusplus tile_title;
+        mb_path tile_xlabel;
+        mb_path tile_ylabel;
+        mb_path tile_zlabel;
+        mb_path tile_projection_id;
+        snprintf(tile_name, sizeof(tile_name), "%s_%4.4d", ts.tile_root, itile);
+        snprintf(tile_grid, sizeof(tile_grid), "%s/%s.grd", ts.directory, tile_name);
+        snprintf(tile_bo, sizeof(tile_bo), "%s.bo", tile_name);
+        snprintf(tile_title, sizeof(tile_title), "Tile %s", tile_name);
+        strcpy(tile_xlabel, "Easting (meters)");
+        strcpy(tile_ylabel, "Northing (meters)");
+        strcpy(tile_zlabel, "Topography (meters)");
+        strcpy(tile_projection_id, ts.projection_id);
+        const double tile_xmin = ts.xmin + i * ts.tile_spacing_x - 0.5 * ts.tile_spacing_x;
+        const double tile_xcen = tile_xmin + 0.5 * ts.tile_width_x;
+        const double tile_xmax = tile_xmin + ts.tile_width_x;
+        const double tile_ycen = tile_ymin + 0.5 * ts.tile_width_y;
+        const double tile_ymax = tile_ymin + ts.tile_width_y;
+
+        // Fill in tile data from the band
+        std::fill(tile_data.begin(), tile_data.end(), ts.nodatavalue);
+        const int ii0 = (int)round((tile_xmin - ts.xmin) / ts.dx);
+        double tile_min = 0.0;
+        double tile_max = 0.0;
+        bool first = true;
+        for (int ii = std::max(0, -ii0); ii < tile_dimension && ii0 + ii < ts.n_columns; ii++) {
+          const float *column = &band.data[(size_t)(ii0 + ii) * band.n_rows];
+          for (int jj = std::max(0, band.row0 - jj0); jj < tile_dimension && jj0 + jj < band.row0 + band.n_rows; jj++) {
+            const float value = column[jj0 + jj - band.row0];
+            tile_data[(size_t)ii * tile_dimension + jj] = value;
+            if (value != ts.nodatavalue) {
+              if (first) {
+                tile_min = value;
+                tile_max = value;
+                first = false;
+              } else {
+                tile_min = MIN(tile_min, value);
+                tile_max = MAX(tile_max, value);
+              }
+            }
+          }
+        }
+
+        std::lock_guard<std::mutex> lock(write_mutex);
+        int tile_error = MB_ERROR_NO_ERROR;
+        fprintf(outfp, "\nTile %d %d: %s\n", i, j, tile_name);
+        tile_status[i] = mb_write_gmt_grd(verbose, tile_grid, tile_data.data(), ts.nodatavalue,
+                                          tile_dimension, tile_dimension,
+                                          tile_xmin, tile_xmax, tile_ymin, tile_ymax,
+                                          tile_min, tile_max, ts.dx, ts.dy,
+                                          tile_xlabel, tile_ylabel, tile_zlabel, tile_title,
+                                          tile_projection_id, argc, argv, &tile_error);
+        char line[2 * MB_PATH_MAXLINE];
+        snprintf(line, sizeof(line), "%s , %.2f , %.2f\n", tile_bo, tile_xcen, tile_ycen);
+        csv_lines[i] = line;
+      }
+    };
+    std::vector<std::thread> threads;
+    for (int n = 1; n < std::min(num_threads, ts.num_tiles_x); n++)
+      threads.emplace_back(cut_tiles);
+    cut_tiles();
+    for (auto &thread : threads)
+      thread.join();
+
+    for (int i = 0; i < ts.num_tiles_x; i++) {
+      fputs(csv_lines[i].c_str(), csv_fp);
+      if (tile_status[i] == MB_FAILURE) {
+        status = MB_FAILURE;
+        *error = MB_ERROR_WRITE_FAIL;
+      }
+    }
+  }
+  fclose(csv_fp);
+
+  // Octree files are generated from the grids once all the tiles are written,
+  // by up to num_threads mbgrd2octree processes at a time (see run_commands)
+  // that share the threads between them
+  const int num_tiles = ts.num_tiles_x * ts.num_tiles_y;
+  const int octree_threads = std::max(1, num_threads / std::max(1, std::min(num_threads, num_tiles)));
+  for (int itile = 0; itile < num_tiles; itile++) {
+    mb_pathplus tile_name;
+    mb_pathplusplus tile_pathlet;
+    mb_command command;
+    snprintf(tile_name, sizeof(tile_name), "%s_%4.4d", ts.tile_root, itile);
+    snprintf(tile_pathlet, sizeof(tile_pathlet), "%s/%s", ts.directory, tile_name);
+    snprintf(command, sizeof(command), "mbgrd2octree --input=%s.grd --output=%s.bo --threads=%d",
+                      tile_pathlet, tile_pathlet, octree_threads);
+    octree_commands->push_back(command);
+  }
+
+  return (status);
+}
+/*--------------------------------------------------------------------*/
+/* Run shell commands, up to num_threads at a time */
+static void run_commands(const std::vector<std::string> &commands, int num_threads) {
+  std::atomic<size_t> next_command(0);
+  std::mutex print_mutex;
+  auto run = [&]() {
+    for (size_t n = next_command++; n < commands.size(); n = next_command++) {
+      {
+        std::lock_guard<std::mutex> lock(print_mutex);
+        fprintf(outfp, "\n-----------------------------------------------------------\nExecuting: %s\n",
+                commands[n].c_str());
+      }
+      system(commands[n].c_str());
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int n = 1; n < std::min(num_threads, (int)commands.size()); n++)
+    threads.emplace_back(run);
+  run();
+  for (auto &thread : threads)
+    thread.join();
+}
+/*--------------------------------------------------------------------*/
 
 int main( int argc, char **argv )
 {
@@ -76,10 +330,10 @@ int main( int argc, char **argv )
   mb_path input_grid = "";
   mb_path output_root = "";
   int tile_dimension = 2001;
-  int tile_dimension_spacing = ((tile_dimension - 1) / 2) + 1;
-  double tile_width = 0.0;
   double tile_spacing = 0.0;
   int tile_mode = 0;
+  int pyramid_levels = 0;
+  int num_threads = 0;
 
   static struct option options[] = {{"verbose", no_argument, nullptr, 0},
                                     {"help", no_argument, nullptr, 0},
@@ -87,7 +341,11 @@ int main( int argc, char **argv )
                                     {"mode", required_argument, nullptr, 0},
                                     {"output", required_argument, nullptr, 0},
                                     {"tile-dimension", required_argument, nullptr, 0},
-                                    {"tile-spacing", required_argument, nullptr, 0}};
+                                    {"tile-mode", required_argument, nullptr, 0},
+                                    {"tile-spacing", required_argument, nullptr, 0},
+                                    {"pyramid-levels", required_argument, nullptr, 0},
+                                    {"threads", required_argument, nullptr, 0},
+                                    {nullptr, 0, nullptr, 0}};
 
   int option_index;
   bool errflg = false;
@@ -146,6 +404,22 @@ int main( int argc, char **argv )
           exit(MB_ERROR_BAD_PARAMETER);
         }
       }
+      else if (strcmp("pyramid-levels", options[option_index].name) == 0) {
+        const int n = sscanf(optarg, "%d", &pyramid_levels);
+        if (n != 1 || pyramid_levels < 0 || pyramid_levels > 16) {
+          fprintf(stderr, "Failed to parse argument: %s=%s\nProgram %s terminated\n",
+                  options[option_index].name, optarg, program_name);
+          exit(MB_ERROR_BAD_PARAMETER);
+        }
+      }
+      else if (strcmp("threads", options[option_index].name) == 0) {
+        const int n = sscanf(optarg, "%d", &num_threads);
+        if (n != 1 || num_threads <= 0) {
+          fprintf(stderr, "Failed to parse argument: %s=%s\nProgram %s terminated\n",
+                  options[option_index].name, optarg, program_name);
+          exit(MB_ERROR_BAD_PARAMETER);
+        }
+      }
       break;
     /*-------------------------------------------------------*/
     /* short options */
@@ -206,6 +480,8 @@ int main( int argc, char **argv )
     fprintf(outfp, "dbg2       tile_mode:            %d\n", tile_mode);
     fprintf(outfp, "dbg2       tile_dimension:       %d\n", tile_dimension);
     fprintf(outfp, "dbg2       tile_spacing:         %f\n", tile_spacing);
+    fprintf(outfp, "dbg2       pyramid_levels:       %d\n", pyramid_levels);
+    fprintf(outfp, "dbg2       num_threads:          %d\n", num_threads);
   }
 
   if (help) {
@@ -219,7 +495,6 @@ int main( int argc, char **argv )
     tile_dimension = 2001;
 
   int error = MB_ERROR_NO_ERROR;
-  int memclear_error = MB_ERROR_NO_ERROR;
 
   int grid_projection_mode;
   mb_path grid_projection_id;
@@ -235,13 +510,13 @@ int main( int argc, char **argv )
   double grid_ymax;
   double grid_dx;
   double grid_dy;
-  float *grid_data;
 
-  // Read the input grid file
-  status = mb_read_gmt_grd(verbose, input_grid, &grid_projection_mode, grid_projection_id,
+  // Read the input grid header - the grid itself is read in bands of rows
+  // as the tiles are cut
+  status = mb_check_gmt_grd(verbose, input_grid, &grid_projection_mode, grid_projection_id,
                            &grid_nodatavalue, &grid_nxy, &grid_n_columns, &grid_n_rows,
                            &grid_min, &grid_max, &grid_xmin, &grid_xmax, &grid_ymin,
-                           &grid_ymax, &grid_dx, &grid_dy, &grid_data, NULL, NULL, &error);
+                           &grid_ymax, &grid_dx, &grid_dy, &error);
   if (status == MB_FAILURE) {
     fprintf(stderr, "Unable to read input grid %s\n", input_grid);
     fprintf(stderr, "Program %s terminated\n", program_name);
@@ -269,149 +544,73 @@ int main( int argc, char **argv )
   // Tiles are either defined in terms of the desired dimensions of the grids
   // or the tile spacing in meters. The tileset will be constructed with the
   // using the southwest corner of the input grid as the origin.
-  double tile_width_x;
-  double tile_width_y;
-  double tile_spacing_x;
-  double tile_spacing_y;
-  double tileset_origin_x = grid_xmin;
-  double tileset_origin_y = grid_ymin;
   if (tile_spacing > 0.0) {
     tile_dimension = 2.0 * tile_spacing / grid_dx + 1;
-    tile_width_x = (tile_dimension - 1) * grid_dx;
-    tile_width_y = (tile_dimension - 1) * grid_dy;
-    tile_spacing_x = tile_width_x / 2.0;
-    tile_spacing_y = tile_width_x / 2.0;
-  } else if (tile_dimension > 0) {
-    tile_width_x = (tile_dimension - 1) * grid_dx;
-    tile_width_y = (tile_dimension - 1) * grid_dy;
-    tile_spacing_x = tile_width_x / 2.0;
-    tile_spacing_y = tile_width_x / 2.0;
-  } else {
+  } else if (tile_dimension <= 0) {
     fprintf(stderr, "Neither tile dimension nor spacing have been defined "
             "(--tile-dimension=dimension or --tile-spacing=spacing)\n"
             "Program %s terminated\n", program_name);
     exit(MB_ERROR_BAD_PARAMETER);
   }
-  int num_tiles_x = (int)ceil((grid_xmax - tileset_origin_x) / tile_spacing_x);
-  int num_tiles_y = (int)ceil((grid_ymax - tileset_origin_y) / tile_spacing_y);
-  int num_tiles = num_tiles_x * num_tiles_y;
-  double tileset_max_x = tileset_origin_x + num_tiles_x * tile_spacing_x;
-  double tileset_max_y = tileset_origin_y + num_tiles_y * tile_spacing_y;
-  mb_path tile_xlabel;
-  mb_path tile_ylabel;
-  mb_path tile_zlabel;
-  mb_pathplusplus tile_title;
-  strcpy(tile_xlabel, "Easting (meters)");
-  strcpy(tile_ylabel, "Northing (meters)");
-  strcpy(tile_zlabel, "Topography (meters)");
-
-  fprintf(stdout, "\nOutput tileset:       %s\n", output_root);
-  fprintf(stdout, "  tile_width_x:       %f\n", tile_width_x);
-  fprintf(stdout, "  tile_width_y:       %f\n", tile_width_y);
-  fprintf(stdout, "  tileset_origin_x:   %f\n", tileset_origin_x);
-  fprintf(stdout, "  tileset_origin_y:   %f\n", tileset_origin_x);
-  fprintf(stdout, "  tileset_max_x:      %f\n", tileset_max_x);
-  fprintf(stdout, "  tileset_max_y:      %f\n", tileset_max_y);
-  fprintf(stdout, "  num_tiles_x:        %d\n", num_tiles_x);
-  fprintf(stdout, "  num_tiles_y:        %d\n", num_tiles_y);
-  fprintf(stdout, "  num_tiles:          %d\n", num_tiles);
-  fprintf(stdout, "  tile_xlabel:        %s\n", tile_xlabel);
-  fprintf(stdout, "  tile_ylabel:        %s\n", tile_ylabel);
-  fprintf(stdout, "  tile_zlabel:        %s\n", tile_zlabel);
-  fprintf(stdout, "  tile_title:         %s\n", tile_title);
+  if (num_threads <= 0)
+    num_threads = std::max(1U, std::thread::hardware_concurrency());
 
   mkdir(output_root, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
-  mb_pathplus csv_file;
-  snprintf(csv_file, sizeof(csv_file), "%s/tiles.csv", output_root);
-  FILE *csv_fp = fopen(csv_file, "w");
-  fprintf(csv_fp, "TileName , Easting , Northing , %d\n", num_tiles);
-
-  // Loop over all tiles
-  int itile = 0;
-  for (int j=0; j<num_tiles_y; j++) {
-    for (int i=0; i<num_tiles_x; i++) {
-      int k = i * num_tiles_y + j;
-      mb_pathplus tile_name;
-      mb_pathplusplus tile_grid;
-      mb_pathplusplus tile_bo;
-      snprintf(tile_name, sizeof(tile_name), "%s_%4.4d", output_root, itile);
-      snprintf(tile_grid, sizeof(tile_grid), "%s/%s.grd", output_root, tile_name);
-      snprintf(tile_bo, sizeof(tile_bo), "%s.bo", tile_name);
-      snprintf(tile_title, sizeof(tile_title), "Tile %s", tile_name);
-      int tile_projection_mode = grid_projection_mode;
-      mb_path tile_projection_id;
-      strncpy(tile_projection_id, grid_projection_id, MB_PATH_MAXLINE-1);
-      float tile_nodatavalue = grid_nodatavalue;
-      int tile_nxy = tile_dimension * tile_dimension;
-      int tile_n_columns = tile_dimension;
-      int tile_n_rows = tile_dimension;
-      double tile_min = 0.0;
-      double tile_max = 0.0;
-      double tile_xmin = tileset_origin_x + i * tile_spacing_x - 0.5 * tile_spacing_x;
-      double tile_xcen = tile_xmin + 0.5 * tile_width_x;
-      double tile_xmax = tile_xmin + tile_width_x;
-      double tile_ymin = tileset_origin_y + j * tile_spacing_y - 0.5 * tile_spacing_y;
-      double tile_ycen = tile_ymin + 0.5 * tile_width_y;;
-      double tile_ymax = tile_ymin + tile_width_y;;
-      double tile_dx = grid_dx;
-      double tile_dy = grid_dy;
-      float *tile_data = NULL;
-      status = mb_mallocd(verbose, __FILE__, __LINE__, tile_dimension * tile_dimension * sizeof(float), (void **)&tile_data, &error);
-      if (error != MB_ERROR_NO_ERROR) {
-        char *message = nullptr;
-        mb_error(verbose, MB_ERROR_MEMORY_FAIL, &message);
-        fprintf(outfp, "\nMBIO Error allocating tile array:\n%s\n", message);
-        fprintf(outfp, "\nProgram <%s> Terminated\n", program_name);
-        mb_memory_clear(verbose, &memclear_error);
-        exit(MB_ERROR_MEMORY_FAIL);
-      }
-      for (int kk=0; kk < tile_nxy; kk++)
-        tile_data[kk] = tile_nodatavalue;
-
-      // Get tile origin location in the input grid
-      int ii0 = (int)round((tile_xmin - grid_xmin) / grid_dx);
-      int jj0 = (int)round((tile_ymin - grid_ymin) / grid_dy);
-
-      // Fill in tile data from input_grid
-      bool first = true;
-      for (int jj=0;jj<tile_dimension;jj++) {
-        for (int ii=0;ii<tile_dimension;ii++) {
-          int kk = ii * tile_dimension + jj;
-          int iii = ii0 + ii;
-          int jjj = jj0 + jj;
-          int kkk = iii * grid_n_rows + jjj;
-          if (iii >= 0 && iii < grid_n_columns && jjj >= 0 && jjj < grid_n_rows) {
-            tile_data[kk] = grid_data[kkk];
-            if (tile_data[kk] != tile_nodatavalue) {
-              if (first) {
-                tile_min = tile_data[kk];
-                tile_max = tile_data[kk];
-                first = false;
-              } else {
-                tile_min = MIN(tile_min, tile_data[kk]);
-                tile_max = MAX(tile_max, tile_data[kk]);
-              }
-            }
-          }
-        }
-      }
 
-    fprintf(outfp, "\nTile %d %d: %s\n", i, j, tile_name);
-    status = mb_write_gmt_grd(verbose, tile_grid, tile_data, tile_nodatavalue,
-                              tile_dimension, tile_dimension,
-                              tile_xmin, tile_xmax, tile_ymin, tile_ymax,
-                              tile_min, tile_max, tile_dx, tile_dy,
-                              tile_xlabel, tile_ylabel, tile_zlabel, tile_title,
-                              tile_projection_id, argc, argv, &error);
-    fprintf(csv_fp, "%s , %.2f , %.2f\n", tile_bo, tile_xcen, tile_ycen);
-
-    status = mb_freed(verbose, __FILE__, __LINE__, (void **)&tile_data, &error);
-    itile++;
+  // Make the full resolution tileset and any pyramid levels, each level
+  // decimating the input grid by a further factor of two
+  std::vector<std::string> octree_commands;
+  for (int level = 0; level <= pyramid_levels && status == MB_SUCCESS; level++) {
+    struct tileset ts;
+    ts.level = level;
+    ts.decimation = 1 << level;
+    ts.n_columns = (grid_n_columns - 1) / ts.decimation + 1;
+    ts.n_rows = (grid_n_rows - 1) / ts.decimation + 1;
+    ts.nodatavalue = grid_nodatavalue;
+    ts.xmin = grid_xmin;
+    ts.xmax = grid_xmax - ((grid_n_columns - 1) % ts.decimation) * grid_dx;
+    ts.ymin = grid_ymin;
+    ts.ymax = grid_ymax - ((grid_n_rows - 1) % ts.decimation) * grid_dy;
+    ts.dx = grid_dx * ts.decimation;
+    ts.dy = grid_dy * ts.decimation;
+    ts.tile_dimension = tile_dimension;
+    ts.tile_width_x = (tile_dimension - 1) * ts.dx;
+    ts.tile_width_y = (tile_dimension - 1) * ts.dy;
+    ts.tile_spacing_x = ts.tile_width_x / 2.0;
+    ts.tile_spacing_y = ts.tile_width_x / 2.0;
+    ts.num_tiles_x = std::max(1, (int)ceil((ts.xmax - ts.xmin) / ts.tile_spacing_x));
+    ts.num_tiles_y = std::max(1, (int)ceil((ts.ymax - ts.ymin) / ts.tile_spacing_y));
+    if (level == 0) {
+      snprintf(ts.directory, sizeof(ts.directory), "%s", output_root);
+      snprintf(ts.tile_root, sizeof(ts.tile_root), "%s", output_root);
+    } else {
+      snprintf(ts.directory, sizeof(ts.directory), "%s/level_%d", output_root, level);
+      snprintf(ts.tile_root, sizeof(ts.tile_root), "%s_L%d", output_root, level);
+      mkdir(ts.directory, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
     }
-  }
+    strncpy(ts.projection_id, grid_projection_id, MB_PATH_MAXLINE - 1);
 
-  status = mb_freed(verbose, __FILE__, __LINE__, (void **)&grid_data, &error);
-  fclose(csv_fp);
+    fprintf(stdout, "\nOutput tileset:       %s\n", ts.directory);
+    fprintf(stdout, "  level:              %d\n", ts.level);
+    fprintf(stdout, "  decimation:         %d\n", ts.decimation);
+    fprintf(stdout, "  tile_width_x:       %f\n", ts.tile_width_x);
+    fprintf(stdout, "  tile_width_y:       %f\n", ts.tile_width_y);
+    fprintf(stdout, "  tileset_origin_x:   %f\n", ts.xmin);
+    fprintf(stdout, "  tileset_origin_y:   %f\n", ts.ymin);
+    fprintf(stdout, "  tileset_max_x:      %f\n", ts.xmin + ts.num_tiles_x * ts.tile_spacing_x);
+    fprintf(stdout, "  tileset_max_y:      %f\n", ts.ymin + ts.num_tiles_y * ts.tile_spacing_y);
+    fprintf(stdout, "  num_tiles_x:        %d\n", ts.num_tiles_x);
+    fprintf(stdout, "  num_tiles_y:        %d\n", ts.num_tiles_y);
+    fprintf(stdout, "  num_tiles:          %d\n", ts.num_tiles_x * ts.num_tiles_y);
+    fprintf(stdout, "  num_threads:        %d\n", num_threads);
+
+    status = make_tileset(verbose, input_grid, ts, num_threads, argc, argv, &octree_commands, &error);
+  }
+  if (status == MB_FAILURE) {
+    fprintf(stderr, "Unable to make tileset from input grid %s\n", input_grid);
+    fprintf(stderr, "Program %s terminated\n", program_name);
+    exit(error);
+  }
 
   // Copy source grid to tiles directory
   mb_command command;
@@ -419,17 +618,8 @@ int main( int argc, char **argv )
   fprintf(outfp, "\n-----------------------------------------------------------\nExecuting: %s\n", command);
   system(command);
 
-  // Generate octree files from the grids
-  for (int itile=0; itile<num_tiles; itile++) {
-    mb_pathplus tile_name;
-    mb_pathplusplus tile_pathlet;
-    snprintf(tile_name, sizeof(tile_name), "%s_%4.4d", output_root, itile);
-    snprintf(tile_pathlet, sizeof(tile_pathlet), "%s/%s", output_root, tile_name);
-    snprintf(command, sizeof(command), "mbgrd2octree --input=%s.grd --output=%s.bo",
-                      tile_pathlet, tile_pathlet);
-    fprintf(outfp, "\n-----------------------------------------------------------\nExecuting: %s\n", command);
-    system(command);
-  }
+  // Generate octree files from the grids, running one mbgrd2octree per thread
+  run_commands(octree_commands, num_threads);
 
   /* check memory */
   if ((status = mb_memory_list(verbose, &error)) == MB_FAILURE) {
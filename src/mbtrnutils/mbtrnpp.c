@@ -67,6 +67,7 @@
 #include "mlog.h"
 #include "mbbuf.h"
 #include "mstats.h"
+#include "mthread.h"
 #include "mkvconf.h"
 #include "mxdebug.h"
 #include "mxd_app.h"
@@ -131,6 +132,15 @@ typedef enum{
     OUTPUT_ALL         =0x7FFF
 }output_mode_t;
 
+// pipeline backpressure policy (when the TRN stage queue is full;
+// the publish stage queue always blocks)
+// MBTRNPP_BP_BLOCK       : upstream stage waits for space
+// MBTRNPP_BP_DROP_OLDEST : oldest queued ping is discarded
+typedef enum{
+    MBTRNPP_BP_BLOCK=0,
+    MBTRNPP_BP_DROP_OLDEST
+}mbtrnpp_bp_policy_t;
+
 
 // mbtrnpp_opts_s only encapsulates options.
 // Options representing numeric primatives and booleans are parsed.
@@ -189,6 +199,12 @@ typedef struct mbtrnpp_opts_s{
     // opt "delay"
     int64_t delay;
 
+    // opt "pipeline"
+    char *pipeline;
+
+    // opt "input-lease"
+    bool input_lease;
+
     // opt "statsec"
     double statsec;
 
@@ -417,6 +433,15 @@ typedef struct mbtrnpp_cfg_s{
     // TRN processing loop delay (msec)
     int64_t mbtrnpp_loop_delay_msec;
 
+    // pipeline queue depth (0: disabled, process synchronously)
+    int pipeline_depth;
+
+    // pipeline backpressure policy
+    mbtrnpp_bp_policy_t pipeline_policy;
+
+    // decode socket input frames in place (zero-copy)
+    bool input_lease;
+
     // profiling interval (s)
     double trn_status_interval_sec;
 
@@ -600,7 +625,7 @@ s=NULL;\
 #define OPT_DELAY_DFL                     0
 #define OPT_STATSEC_DFL                   MBTRNPP_STAT_PERIOD_SEC
 #define OPT_STATFLAGS_DFL                 MBTRNPP_STAT_FLAGS_DFL
-#define OPT_STATFLAG_STR_DFL              "MSF_STATUS|MSF_EVENT|MSF_ASTAT|MSF_PSTAT"
+#define OPT_STATFLAG_STR_DFL              "MSF_STATUS|MSF_EVENT|MSF_ASTAT|MSF_PSTAT|MSF_PCTL"
 #define OPT_TRN_EN_DFL                    true
 #define OPT_TRN_CRS_DFL                   TRN_CRS_DFL
 #define OPT_TRN_UTM_DFL                   TRN_UTM_DFL
@@ -627,6 +652,7 @@ s=NULL;\
 #define OPT_REINIT_SEARCH_XY              60.0
 #define OPT_REINIT_SEARCH_Z               5.0
 #define OPT_REINIT_GAIN_ENABLE_DFL        false
+#define OPT_INPUT_LEASE_DFL               true
 #define OPT_REINIT_FILE_ENABLE_DFL        false
 #define OPT_REINIT_XYOFFSET_ENABLE_DFL    false
 #define OPT_REINIT_XYOFFSET_MAX_DFL       0.0
@@ -727,7 +753,8 @@ s=NULL;\
 // MSF_ASTAT  : aggregate stats
 // MSF_PSTAT  : periodic stats
 // MSF_READER : r7kr reader stats
-#define MBTRNPP_STAT_FLAGS_DFL (MSF_STATUS | MSF_EVENT | MSF_ASTAT | MSF_PSTAT)
+// MSF_PCTL   : latency percentiles (p50/p90/p99/p99.9)
+#define MBTRNPP_STAT_FLAGS_DFL (MSF_STATUS | MSF_EVENT | MSF_ASTAT | MSF_PSTAT | MSF_PCTL)
 /// @def MBTRNPP_STAT_PERIOD_SEC
 #define MBTRNPP_STAT_PERIOD_SEC ((double)20.0)
 
@@ -864,6 +891,8 @@ typedef enum {
     MBTPP_EV_EMBSOCKET,
     MBTPP_EV_EMBCON,
     MBTPP_EV_EMBPUB,
+    MBTPP_EV_PIPE_TRN_DROP,
+    MBTPP_EV_PIPE_PUB_DROP,
 #ifdef WITH_MBTNAV
     MBTPP_EV_TRN_PROCN,
 
@@ -879,6 +908,13 @@ typedef enum {
 typedef enum {
     MBTPP_STA_MB_FWRITE_BYTES=0,
     MBTPP_STA_MB_SYNC_BYTES,
+    MBTPP_STA_PIPE_TRN_QDEPTH,
+    MBTPP_STA_PIPE_TRN_QHWM,
+    MBTPP_STA_PIPE_PUB_QDEPTH,
+    MBTPP_STA_PIPE_PUB_QHWM,
+    MBTPP_STA_MB_ZC_FRAMES,
+    MBTPP_STA_MB_ZC_BYTES,
+    MBTPP_STA_MB_RX_BATCH,
     MBTPP_STA_COUNT
 } mbtrnpp_ststatus_id;
 
@@ -894,6 +930,9 @@ typedef enum {
   MBTPP_CH_MB_CYCLE_XT,
   MBTPP_CH_MB_FWRITE_XT,
   MBTPP_CH_MB_PROC_MB1_XT,
+  MBTPP_CH_PIPE_TRN_QLAT_XT,
+  MBTPP_CH_PIPE_PUB_QLAT_XT,
+  MBTPP_CH_PIPE_E2E_XT,
 #ifdef WITH_MBTNAV
     MBTPP_CH_TRN_UPDATE_XT,
     MBTPP_CH_TRN_BIASEST_XT,
@@ -915,7 +954,8 @@ typedef enum {
 const char *mbtrnpp_stevent_labels[] = {
     "mb_cycles", "mb_con", "mb_dis", "mb_pub_n", "mb_reinit", "mb_gain_lo", "mb_file",
     "mb_xyoffset", "mb_offset_z", "mb_trnucli_reset", "mb_eof", "mb_nonsurvey", "e_mbgetall", "e_mbfailure",
-    "e_mb_frame_rd", "e_mb_log_wr", "e_mbsocket", "e_mbcon", "e_mbpub"
+    "e_mb_frame_rd", "e_mb_log_wr", "e_mbsocket", "e_mbcon", "e_mbpub",
+    "pipe_trn_drop", "pipe_pub_drop"
 #ifdef WITH_MBTNAV
     ,"trn_proc_n","trnu_pub_n","trnu_pubempty_n","e_trnu_pub","e_trnu_pubempty"
 #endif
@@ -924,14 +964,21 @@ const char *mbtrnpp_stevent_labels[] = {
 // profiling - status channel labels
 const char *mbtrnpp_ststatus_labels[] = {
     "mb_fwrite_bytes",
-    "mb_sync_bytes"
+    "mb_sync_bytes",
+    "pipe_trn_qdepth",
+    "pipe_trn_qhwm",
+    "pipe_pub_qdepth",
+    "pipe_pub_qhwm",
+    "mb_zc_frames",
+    "mb_zc_bytes",
+    "mb_rx_batch"
 };
 
 // profiling - measurement channel labels
 const char *mbtrnpp_stchan_labels[] = {
     "mb_getall_xt",  "mb_ping_xt", "mb_log_xt", "mb_dtime_xt",
     "mb_getfail_xt", "mb_post_xt", "mb_stats_xt", "mb_cycle_xt", "mb_fwrite_xt",
-    "mb_proc_mb1_xt"
+    "mb_proc_mb1_xt", "pipe_trn_qlat_xt", "pipe_pub_qlat_xt", "pipe_e2e_xt"
 #ifdef WITH_MBTNAV
     , "trn_update_xt", "trn_biasest_xt", "trn_nreinits_xt",
     "trn_trnu_pub_xt", "trn_trnums_pub_xt", "trn_trnu_log_xt", "trn_trnu_blog_xt", "trn_proc_xt",
@@ -940,8 +987,88 @@ const char *mbtrnpp_stchan_labels[] = {
 };
 
 const char **mbtrnpp_stats_labels[MSLABEL_COUNT] = {mbtrnpp_stevent_labels, mbtrnpp_ststatus_labels, mbtrnpp_stchan_labels};
-mstats_profile_t *app_stats = NULL;
+// stats profile of the calling thread: the main profile on the input
+// thread, a private profile on each pipeline stage thread (see
+// mbtrnpp_stage_stats_t), so stage threads never write the main profile
+_Thread_local mstats_profile_t *app_stats = NULL;
 mstats_t *reader_stats = NULL;
+
+// pipeline work item (one MB1 record and the ping
+// fields needed downstream of preprocessing)
+typedef struct mbtrnpp_ping_s{
+    // MB1 record
+    char *mb1;
+    // MB1 record size (bytes)
+    size_t mb1_size;
+    // MB1 buffer allocation (bytes)
+    size_t mb1_alloc;
+    // transmit gain
+    double transmit_gain;
+    // ping time (epoch s)
+    double time_d;
+    // ping position
+    double navlat;
+    double navlon;
+    double sensordepth;
+    // time ping entered the pipeline
+    double t_input;
+    // time ping was queued for its current stage
+    double t_queue;
+    // input file closed before this ping: request TRN reinit
+    // (TRN state is only changed by the TRN stage)
+    bool reinit_eof;
+}mbtrnpp_ping_t;
+
+// bounded stage queue
+// (mutex/condition: drop-oldest requires the producer to evict,
+// and ping rates are low enough that locking cost is negligible)
+typedef struct mbtrnpp_stage_q_s{
+    pthread_mutex_t mutex;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    mbtrnpp_ping_t **slot;
+    int capacity;
+    int head;
+    int count;
+    int hwm;
+    mbtrnpp_bp_policy_t policy;
+    bool closed;
+}mbtrnpp_stage_q_t;
+
+// pipeline stage stats
+// The stage thread records into work (its thread local app_stats) and
+// folds work into pending after each item. The input thread merges
+// pending into the main app_stats before each stats update, so the
+// update/log/reset of the main profile stays on the input thread.
+// Stage threads also own the stats of the netifs they publish to.
+typedef struct mbtrnpp_stage_stats_s{
+    pthread_mutex_t mutex;
+    // written by the stage thread only
+    mstats_profile_t *work;
+    // guarded by mutex
+    mstats_profile_t *pending;
+    // netif stats period start (stage thread only)
+    double netif_period_start;
+}mbtrnpp_stage_stats_t;
+
+// ping pipeline:
+// input/preprocess (main) -> trn_q -> TRN update -> pub_q -> publish
+// items cycle through free_q, so there is no allocation per ping
+typedef struct mbtrnpp_pipeline_s{
+    bool enabled;
+    mbtrnpp_stage_q_t free_q;
+    mbtrnpp_stage_q_t trn_q;
+    mbtrnpp_stage_q_t pub_q;
+    mbtrnpp_ping_t *pool;
+    int pool_n;
+    mthread_thread_t *trn_thread;
+    mthread_thread_t *pub_thread;
+    double transmit_gain_threshold;
+    mbtrnpp_stage_stats_t trn_stats;
+    mbtrnpp_stage_stats_t pub_stats;
+}mbtrnpp_pipeline_t;
+
+static mbtrnpp_pipeline_t mbtrnpp_pipeline = {0};
 // stats interval end
 static double stats_prev_end = 0.0;
 // stats interval start
@@ -972,9 +1099,11 @@ int mbtrnpp_init_debug(int verbose);
 
 int mbtrnpp_reson7kr_input_open(int verbose, void *mbio_ptr, char *definition, int *error);
 int mbtrnpp_reson7kr_input_read(int verbose, void *mbio_ptr, size_t *size, char *buffer, int *error);
+int mbtrnpp_reson7kr_input_lease(int verbose, void *mbio_ptr, char **frame, size_t *size, int *error);
 int mbtrnpp_reson7kr_input_close(int verbose, void *mbio_ptr, int *error);
 int mbtrnpp_kemkmall_input_open(int verbose, void *mbio_ptr, char *definition, int *error);
 int mbtrnpp_kemkmall_input_read(int verbose, void *mbio_ptr, size_t *size, char *buffer, int *error);
+int mbtrnpp_kemkmall_input_lease(int verbose, void *mbio_ptr, char **frame, size_t *size, int *error);
 int mbtrnpp_kemkmall_input_close(int verbose, void *mbio_ptr, int *error);
 int mbtrnpp_em710raw_input_open(int verbose, void *mbio_ptr, char *definition, int *error);
 int mbtrnpp_em710raw_input_read(int verbose, void *mbio_ptr, size_t *size, char *buffer, int *error);
@@ -985,6 +1114,7 @@ int mbtrnpp_em710raw_input_close_ser(int verbose, void *mbio_ptr, int *error);
 #ifdef WITH_MB1_READER
 int mbtrnpp_mb1r_input_open(int verbose, void *mbio_ptr, char *definition, int *error);
 int mbtrnpp_mb1r_input_read(int verbose, void *mbio_ptr, size_t *size, char *buffer, int *error);
+int mbtrnpp_mb1r_input_lease(int verbose, void *mbio_ptr, char **frame, size_t *size, int *error);
 int mbtrnpp_mb1r_input_close(int verbose, void *mbio_ptr, int *error);
 #endif // WITH_MB1_READER
 
@@ -1052,6 +1182,14 @@ static int s_mbtrnpp_configure(mbtrnpp_cfg_t *cfg, mbtrnpp_opts_t *opts);
 static int s_mbtrnpp_validate_config(mbtrnpp_cfg_t *cfg);
 
 int mbtrnpp_update_stats(mstats_profile_t *stats, mlog_id_t log_id, mstats_flags flags);
+static void s_mbtrnpp_trn_stage(mbtrnpp_ping_t *ping, double transmit_gain_threshold);
+static void s_mbtrnpp_pub_stage(mbtrnpp_ping_t *ping);
+static void s_mbtrnpp_write_mb1(mbtrnpp_ping_t *ping, FILE *output_mb1_fp);
+static int s_mbtrnpp_pipeline_start(mbtrnpp_pipeline_t *self, int depth, mbtrnpp_bp_policy_t policy,
+                                    double transmit_gain_threshold);
+static int s_mbtrnpp_pipeline_submit(mbtrnpp_pipeline_t *self, char *mb1, size_t mb1_size, mbtrnpp_ping_t *ping);
+static void s_mbtrnpp_pipeline_stop(mbtrnpp_pipeline_t *self);
+static void s_mbtrnpp_pipeline_merge_stats(mbtrnpp_pipeline_t *self);
 int mbtrnpp_process_mb1(char *mb1, size_t len, trn_config_t *cfg);
 
 #ifdef WITH_MBTNAV
@@ -1093,6 +1231,8 @@ GeoToTMCallback mbtrnpp_geo_to_tm = mbtrnpp_geo_to_tm_proj;
 
 // TRN reinit flag - forces reinitializing the TRN filter
 bool reinit_flag=true;
+// input file closed - request reinit with the next ping (input thread only)
+static bool reinit_eof = false;
 
 /* counting convergence or lack of it */
 int n_converged_streak = 0;
@@ -1112,6 +1252,41 @@ double use_offset_z = 0.0;
 double use_covariance[4] = {0.0, 0.0, 0.0, 0.0};
 
 char mRecordBuf[MBSYS_KMBES_MAX_NUM_MRZ_DGMS][64*1024];
+
+// kmall UDP datagrams received per system call (recvmmsg)
+#define MBTRNPP_KMALL_RX_BATCH 16
+
+// kmall UDP receive batch; datagrams are leased to
+// the format reader in place (see mbtrnpp_kemkmall_input_lease)
+typedef struct mbtrnpp_rxbatch_s{
+    // datagram slots (MBTRNPP_KMALL_RX_BATCH x MB_UDP_SIZE_MAX bytes)
+    char *buf;
+    // reassembled partitioned MRZ/MWC record
+    char *record;
+    // datagram lengths
+    size_t len[MBTRNPP_KMALL_RX_BATCH];
+    // datagrams in batch
+    int count;
+    // next datagram to lease
+    int next;
+}mbtrnpp_rxbatch_t;
+
+// socket input context for the r7kr, mb1r and kmall inputs,
+// held in mb_io_ptr->mbsp: created by input_open, released by input_close
+typedef struct mbtrnpp_input_s{
+    // r7kr_reader_t or mb1r_reader_t (NULL for kmall)
+    void *reader;
+    // kmall UDP socket
+    int sd;
+    // frame buffer for input_lease (r7kr, mb1r; allocated on first lease)
+    byte *lease_buf;
+    // kmall UDP receive batch
+    mbtrnpp_rxbatch_t rx;
+}mbtrnpp_input_t;
+
+static mbtrnpp_input_t *s_mbtrnpp_input_new(void *reader, int sd);
+static void s_mbtrnpp_input_destroy(mbtrnpp_input_t **pself);
+
 /*--------------------------------------------------------------------*/
 
 static char *s_mbtrnpp_trnsession_str(char **pdest, size_t len, mb_resource_flag_t flags)
@@ -1533,6 +1708,9 @@ static int s_mbtrnpp_init_cfg(mbtrnpp_cfg_t *cfg)
         cfg->trnusvr_hbto=TRNUSVR_HBTO_DFL;
         cfg->trnumsvr_ttl=TRNUMSVR_TTL_DFL;
         cfg->mbtrnpp_loop_delay_msec=0;
+        cfg->pipeline_depth=0;
+        cfg->pipeline_policy=MBTRNPP_BP_BLOCK;
+        cfg->input_lease=OPT_INPUT_LEASE_DFL;
         cfg->trn_status_interval_sec=MBTRNPP_STAT_PERIOD_SEC;
         cfg->mbtrnpp_stat_flags=MBTRNPP_STAT_FLAGS_DFL;
         cfg->trn_enable=false;
@@ -1594,6 +1772,8 @@ static int s_mbtrnpp_init_opts(mbtrnpp_opts_t *opts)
         opts->trnuhbt=OPT_TRNUHBT_DFL;
         opts->trnumttl=OPT_TRNUMTTL_DFL;
         opts->delay=OPT_DELAY_DFL;
+        opts->pipeline=NULL;
+        opts->input_lease=OPT_INPUT_LEASE_DFL;
         opts->statsec=OPT_STATSEC_DFL;
         opts->statflags_str=strdup(OPT_STATFLAG_STR_DFL);
         opts->statflags=OPT_STATFLAGS_DFL;
@@ -1650,6 +1830,7 @@ static void s_mbtrnpp_free_opts(mbtrnpp_opts_t **pself)
         MEM_CHKFREE(self->output);
         MEM_CHKFREE(self->median_filter);
         MEM_CHKFREE(self->statflags_str);
+        MEM_CHKFREE(self->pipeline);
         MEM_CHKFREE(self->trn_map);
         MEM_CHKFREE(self->trn_cfg);
         MEM_CHKFREE(self->trn_par);
@@ -1706,6 +1887,9 @@ static int s_mbtrnpp_cfgstr(char **pdest, size_t olen, mbtrnpp_cfg_t *self, cons
     mbb_printf(optr, "%s%*s%*s%s%*c%s", pre, indent, (indent>0?" ":""), wkey, "median_filter_en", sep, wval, BOOL2YNC(self->median_filter_en), del);
     mbb_printf(optr, "%s%*s%*s%s%*d%s", pre, indent, (indent>0?" ":""), wkey, "n_buffer_max", sep, wval, self->n_buffer_max, del);
     mbb_printf(optr, "%s%*s%*s%s%*"PRId64"%s", pre, indent, (indent>0?" ":""), wkey, "mbtrnpp_loop_delay_msec", sep, wval, self->mbtrnpp_loop_delay_msec, del);
+    mbb_printf(optr, "%s%*s%*s%s%*d%s", pre, indent, (indent>0?" ":""), wkey, "pipeline_depth", sep, wval, self->pipeline_depth, del);
+    mbb_printf(optr, "%s%*s%*s%s%*s%s", pre, indent, (indent>0?" ":""), wkey, "pipeline_policy", sep, wval, (self->pipeline_policy==MBTRNPP_BP_BLOCK ? "block" : "drop"), del);
+    mbb_printf(optr, "%s%*s%*s%s%*c%s", pre, indent, (indent>0?" ":""), wkey, "input_lease", sep, wval, BOOL2YNC(self->input_lease), del);
     mbb_printf(optr, "%s%*s%*s%s%*.2lf%s", pre, indent, (indent>0?" ":""), wkey, "trn_status_interval_sec", sep, wval, self->trn_status_interval_sec, del);
     mbb_printf(optr, "%s%*s%*s%s%*X%s", pre, indent, (indent>0?" ":""), wkey, "mbtrnpp_stat_flags", sep, wval, self->mbtrnpp_stat_flags, del);
 
@@ -1810,6 +1994,8 @@ static int s_mbtrnpp_optstr(char **pdest, size_t olen, mbtrnpp_opts_t *self, con
     mbb_printf(optr, "%s%*s%*s%s%*s%s", pre, indent, (indent>0?" ":""), wkey, "median-filter", sep, wval, self->median_filter, del);
 
     mbb_printf(optr, "%s%*s%*s%s%*"PRId64"%s", pre, indent, (indent>0?" ":""), wkey, "delay", sep, wval, self->delay, del);
+    mbb_printf(optr, "%s%*s%*s%s%*s%s", pre, indent, (indent>0?" ":""), wkey, "pipeline", sep, wval, self->pipeline, del);
+    mbb_printf(optr, "%s%*s%*s%s%*c%s", pre, indent, (indent>0?" ":""), wkey, "input_lease", sep, wval, BOOL2YNC(self->input_lease), del);
     mbb_printf(optr, "%s%*s%*s%s%*.2lf%s", pre, indent, (indent>0?" ":""), wkey, "statsec", sep, wval, self->statsec, del);
     mbb_printf(optr, "%s%*s%*s%s%*X/%s%s", pre, indent, (indent>0?" ":""), wkey, "statflags", sep, wval, self->statflags, self->statflags_str, del);
 
@@ -2443,6 +2629,18 @@ static int s_mbtrnpp_kvparse_fn(char *key, char *val, void *cfg)
                 if(sscanf(val,"%"PRId64"",&opts->delay)==1){
                     retval=0;
                 }
+            } else if(strcmp(key,"pipeline")==0 ){
+                MEM_CHKFREE(opts->pipeline);
+                if( (opts->pipeline=CHK_STRDUP(val)) != NULL){
+                    retval=0;
+                }
+            } else if(strcmp(key,"input-lease")==0 ){
+                if( mkvc_parse_bool(val,&opts->input_lease)==0){
+                    retval=0;
+                } else {
+                    opts->input_lease=true;
+                    retval=0;
+                }
             } else if(strcmp(key,"statsec")==0 ){
                 if(sscanf(val,"%lf",&opts->statsec)==1){
                     retval=0;
@@ -2476,6 +2674,10 @@ static int s_mbtrnpp_kvparse_fn(char *key, char *val, void *cfg)
                     opts->statflags |= MSF_READER;
                     retval=0;
                 }
+                if(NULL!=strstr(val,"MSF_PCTL") || NULL!=strstr(val,"msf_pctl")){
+                    opts->statflags |= MSF_PCTL;
+                    retval=0;
+                }
             }
             else if(strcmp(key,"use-proj")==0 ){
                 if( mkvc_parse_bool(val,&opts->use_proj)==0){
@@ -2655,6 +2857,9 @@ static int s_mbtrnpp_kvparse_fn(char *key, char *val, void *cfg)
             } else if(strcmp(key,"reinit-file")==0 ){
                 opts->reinit_file_enable=true;
                 retval=0;
+            } else if(strcmp(key,"input-lease")==0 ){
+                opts->input_lease=true;
+                retval=0;
             } else if(strcmp(key,"random-offset")==0 ){
                 opts->random_offset_enable = true;
                 retval=0;
@@ -2772,6 +2977,25 @@ static int s_mbtrnpp_configure(mbtrnpp_cfg_t *cfg, mbtrnpp_opts_t *opts)
         cfg->trnusvr_hbto = opts->trnuhbt;
         // delay
         cfg->mbtrnpp_loop_delay_msec = opts->delay;
+        // pipeline
+        if(NULL!=opts->pipeline){
+            char policy[16]={0};
+            int n = sscanf(opts->pipeline, "%d/%15s", &cfg->pipeline_depth, policy);
+            if (n < 1 || cfg->pipeline_depth < 0) {
+                cfg->pipeline_depth = 0;
+            }
+            if (n == 2) {
+                if (strcmp(policy,"block")==0) {
+                    cfg->pipeline_policy = MBTRNPP_BP_BLOCK;
+                } else if (strcmp(policy,"drop")==0) {
+                    cfg->pipeline_policy = MBTRNPP_BP_DROP_OLDEST;
+                } else {
+                    fprintf(stderr,"WARN - invalid pipeline policy [%s] (expected drop|block)\n",policy);
+                }
+            }
+        }
+        // input-lease
+        cfg->input_lease = opts->input_lease;
         // statsec
         cfg->trn_status_interval_sec = opts->statsec;
         // statflags
@@ -3131,8 +3355,10 @@ int main(int argc, char **argv) {
                          "\t--platform-target-sensor=sensor_id\n"
                          "\t--tide-model=file\n"
                          "\t--statsec=d.d\n"
-                         "\t--statflags=<MSF_STATUS:MSF_EVENT:MSF_ASTAT:MSF_PSTAT:MSF_READER>\n"
+                         "\t--statflags=<MSF_STATUS:MSF_EVENT:MSF_ASTAT:MSF_PSTAT:MSF_READER:MSF_PCTL>\n"
                          "\t--delay=n\n"
+                         "\t--pipeline=depth[/drop|block]\n"
+                         "\t--input-lease[=Y|N]\n"
                          "\t--trn-en\n"
                          "\t--trn-dev=s\n"
                          "\t--use-proj[=b]\n"
@@ -3284,6 +3510,7 @@ int main(int argc, char **argv) {
   int (*mbtrnpp_input_open)(int verbose, void *mbio_ptr, char *definition, int *error);
   int (*mbtrnpp_input_read)(int verbose, void *mbio_ptr, size_t *size, char *buffer, int *error);
   int (*mbtrnpp_input_close)(int verbose, void *mbio_ptr, int *error);
+  int (*mbtrnpp_input_lease)(int verbose, void *mbio_ptr, char **frame, size_t *size, int *error) = NULL;
 
   int i_ping_process;
   int beam_start, beam_end, beam_decimation;
@@ -3821,6 +4048,13 @@ int main(int argc, char **argv) {
   int n_ping_process = mbtrn_cfg->n_buffer_max / 2;
   int idataread = 0;
 
+  // optionally run TRN and MB1 publish in their own threads,
+  // decoupled from input by bounded queues
+  if (mbtrn_cfg->pipeline_depth > 0) {
+      s_mbtrnpp_pipeline_start(&mbtrnpp_pipeline, mbtrn_cfg->pipeline_depth, mbtrn_cfg->pipeline_policy,
+                               transmit_gain_threshold);
+  }
+
     /* loop over all files to be read */
   while (read_data == true && !g_interrupted) {
       char log_message[LOG_MSG_BUF_SZ];
@@ -3889,16 +4123,19 @@ int main(int argc, char **argv) {
         mbtrnpp_input_open = &mbtrnpp_reson7kr_input_open;
         mbtrnpp_input_read = &mbtrnpp_reson7kr_input_read;
         mbtrnpp_input_close = &mbtrnpp_reson7kr_input_close;
+        mbtrnpp_input_lease = &mbtrnpp_reson7kr_input_lease;
       } else if (mbtrn_cfg->format == MBF_KEMKMALL) {
         mbtrnpp_input_open = &mbtrnpp_kemkmall_input_open;
         mbtrnpp_input_read = &mbtrnpp_kemkmall_input_read;
         mbtrnpp_input_close = &mbtrnpp_kemkmall_input_close;
+        mbtrnpp_input_lease = &mbtrnpp_kemkmall_input_lease;
       }
 #ifdef WITH_MB1_READER
       else if (mbtrn_cfg->format == MBF_MBARIMB1) {
           mbtrnpp_input_open = &mbtrnpp_mb1r_input_open;
           mbtrnpp_input_read = &mbtrnpp_mb1r_input_read;
           mbtrnpp_input_close = &mbtrnpp_mb1r_input_close;
+          mbtrnpp_input_lease = &mbtrnpp_mb1r_input_lease;
       }
 #endif // WITH_MB1_READER
       else if (mbtrn_cfg->format == MBF_EM710RAW) {
@@ -3947,6 +4184,13 @@ int main(int argc, char **argv) {
           mlog_tprintf(mbtrnpp_mlog_id,"MBIO format id,%d\n", mbtrn_cfg->format);
         MST_COUNTER_INC(app_stats->stats->events[MBTPP_EV_MB_CONN]);
 
+        /* pass frames to the format reader in place where supported */
+        if (mbtrn_cfg->input_lease && NULL != mbtrnpp_input_lease) {
+          if (mb_input_lease_init(mbtrn_cfg->verbose, imbio_ptr, mbtrnpp_input_lease, &error) == MB_SUCCESS) {
+            mlog_tprintf(mbtrnpp_mlog_id,"i,sonar data frame lease enabled\n");
+          }
+        }
+
         if (logfp != NULL)
           mbtrnpp_postlog(mbtrn_cfg->verbose, logfp, log_message, &error);
         if (mbtrn_cfg->verbose > 0)
@@ -4474,134 +4718,34 @@ int main(int argc, char **argv) {
             MST_METRIC_LAP(app_stats->stats->metrics[MBTPP_CH_MB_PING_XT], mtime_dtime());
 
             /* output MB1, TRN data */
-            if ( !OUTPUT_FLAGS_ZERO() ) {
-
-                // begin: move after TRN update for sim sync
-//                MST_METRIC_START(app_stats->stats->metrics[MBTPP_CH_MB_PROC_MB1_XT], mtime_dtime());
-//
-//                // do MB1 processing/output
-//                mbtrnpp_process_mb1(output_buffer, mb1_size, trn_cfg);
-//
-//                MST_METRIC_LAP(app_stats->stats->metrics[MBTPP_CH_MB_PROC_MB1_XT], mtime_dtime());
-                // end: move after TRN update for sim sync
-
-#ifdef WITH_MBTNAV
-
-                bool update_trn = true;
-
-                // if gain thresholding applied and gain too low, do not process and set reinit flag
-                if (mbtrn_cfg->reinit_gain_enable && (transmit_gain < transmit_gain_threshold)) {
-                  update_trn = false;
-                  if (!reinit_flag) {
-                    fprintf(stderr, "--Reinit set due to transmit gain %f < threshold %f\n",
-                            transmit_gain, transmit_gain_threshold);
-                    mlog_tprintf(mbtrnpp_mlog_id,"i,set reinit due to transmit gain [%.2lf] lower than threshold [%.2lf]\n",
-                                  transmit_gain, transmit_gain_threshold);
-                    MST_COUNTER_INC(app_stats->stats->events[MBTPP_EV_MB_GAIN_LO]);
-                    reinit_flag = true;
-                  }
-                }
-                // if ok pass filtered ping to TRN for processing
-                if (update_trn) {
-
-                  // if reinit_flag set then reinit the TRN filter
-                  if (reinit_flag) {
-                    reinitialized = true;
-                    // TRN reinit function options are:
-                    //
-                    //   (1) reinit w/ zero offset and default standard deviations
-                    //       which correspond to the particle filter distribution widths
-                    //   wtnav_reinit_filter(trn_instance, true);
-                    //
-                    //   (2) Reinit w/ offset set to last good offset estimate and
-                    //       default standard deviations
-                    //   wtnav_reinit_filter_offset(trn_instance, true, use_offset_n, use_offset_e, use_offset_z);
-                    //
-                    //   (3) Reinit w/ offset set to last good offset estimate and
-                    //       specified standard deviations (here set to default values)
-                    //   d_triplet_t xyz_sdev={0., 0., 0.};
-                    //   wtnav_get_init_stddev_xyz(trn_instance, &xyz_sdev);
-                    //   wtnav_reinit_filter_box(trn_instance, true, use_offset_n, use_offset_e, use_offset_z,
-                    //                                              xyz_sdev.x, xyz_sdev.y, xyz_sdev.z);
-                    //
-                    d_triplet_t xyz_sdev={0., 0., 0.};
-                    xyz_sdev.x = MIN((n_reinit_since_use + 1), 10) * mbtrn_cfg->reinit_search_xy;
-                    xyz_sdev.y = xyz_sdev.x;
-                    xyz_sdev.z = mbtrn_cfg->reinit_search_z;
-                    //wtnav_get_init_stddev_xyz(trn_instance, &xyz_sdev);
-                    fprintf(stderr, "--reinit time_d:%.6f centered on offset: %f %f %f  sd: %f %f %f\n",
-                                  ping[i_ping_process].time_d, use_offset_e, use_offset_n, use_offset_z,
-                                  xyz_sdev.x, xyz_sdev.y, xyz_sdev.z);
-                    wtnav_reinit_filter_box(trn_instance, true, use_offset_n, use_offset_e, use_offset_z,
-                                              xyz_sdev.x, xyz_sdev.y, xyz_sdev.z);
-
-                    mlog_tprintf(mbtrnpp_mlog_id, "i,trn filter reinit time_d:%.6f centered on offset: %f %f %f\n",
-                                  ping[i_ping_process].time_d, use_offset_e, use_offset_n, use_offset_z);
-                    MST_COUNTER_INC(app_stats->stats->events[MBTPP_EV_MB_REINIT]);
-                    reinit_flag = false;
-                    n_reinit++;
-                    n_reinit_since_use++;
-                    reinit_time = ping[i_ping_process].time_d;
-                  }
-
-                  MST_METRIC_START(app_stats->stats->metrics[MBTPP_CH_TRN_PROC_TRN_XT], mtime_dtime());
-
-                  // do TRN processing, output, and tests for reinitializing TRN
-                  mbtrnpp_trn_process_mb1(trn_instance, (mb1_t *)output_buffer, trn_cfg);
-
-                  MST_METRIC_LAP(app_stats->stats->metrics[MBTPP_CH_TRN_PROC_TRN_XT], mtime_dtime());
-
-                }
-
-                else {
-                    int time_i[7];
-                    mb_get_date(0, ping[i_ping_process].time_d, time_i);
-                    fprintf(stderr, "%4.4d/%2.2d/%2.2d-%2.2d:%2.2d:%2.2d.%6.6d %.6f "
-                                    "| %11.6f %11.6f %8.3f | Ping not processed - low gain condition\n",
-                    time_i[0], time_i[1], time_i[2], time_i[3], time_i[4], time_i[5], time_i[6], ping[i_ping_process].time_d,
-                    ping[i_ping_process].navlon, ping[i_ping_process].navlat, ping[i_ping_process].sensordepth);
-                    mbtrnpp_trnu_pubempty_osocket(ping[i_ping_process].time_d, ping[i_ping_process].navlat,
-                      ping[i_ping_process].navlon, ping[i_ping_process].sensordepth,trnusvr);
-                }
-
-#endif // WITH_MBTNAV
-
-                // begin: move after TRN update for sim sync
-                MST_METRIC_START(app_stats->stats->metrics[MBTPP_CH_MB_PROC_MB1_XT], mtime_dtime());
-
-                // do MB1 processing/output
-                // after TRN processing/update to enable synchronization, e.g. with sim
-                // i.e. when MB1 record is published, TRN processing has completed
-                mbtrnpp_process_mb1(output_buffer, mb1_size, trn_cfg);
-
-                MST_METRIC_LAP(app_stats->stats->metrics[MBTPP_CH_MB_PROC_MB1_XT], mtime_dtime());
-                // end: move after TRN update for sim sync
-
-
-                MBTRNPP_UPDATE_STATS(app_stats, mbtrnpp_mlog_id, mbtrn_cfg->mbtrnpp_stat_flags);
-
-            } // end MBTRNPREPROCESS_OUTPUT_TRN
-
-            /* write the packet to a file */
-            if ( OUTPUT_FLAG_SET(OUTPUT_MB1_FILE_EN) ) {
-
-                if(NULL!=output_mb1_fp && NULL!=output_buffer){
-                    MST_METRIC_START(app_stats->stats->metrics[MBTPP_CH_MB_FWRITE_XT], mtime_dtime());
-
-                    size_t obytes=0;
-                    if( (obytes=fwrite(output_buffer, mb1_size, 1, output_mb1_fp))>0){
-                        MST_COUNTER_ADD(app_stats->stats->status[MBTPP_STA_MB_FWRITE_BYTES],mb1_size);
-                    } else {
-                        MST_COUNTER_INC(app_stats->stats->events[MBTPP_EV_EMBLOGWR]);
-                    }
-
-                    MST_METRIC_LAP(app_stats->stats->metrics[MBTPP_CH_MB_FWRITE_XT], mtime_dtime());
-
-                } else {
-                    fprintf(stderr,"%s:%d - ERR fwrite failed obuf[%p] fp[%p]\n",__FUNCTION__,__LINE__,output_buffer,output_mb1_fp);
-                }
-              // fprintf(stderr, "WRITE SIZE: %zu %zu %zu\n", mb1_size, index, index - mb1_size);
+            mbtrnpp_ping_t ping_out = {0};
+            ping_out.mb1 = output_buffer;
+            ping_out.mb1_size = mb1_size;
+            ping_out.transmit_gain = transmit_gain;
+            ping_out.time_d = ping[i_ping_process].time_d;
+            ping_out.navlat = ping[i_ping_process].navlat;
+            ping_out.navlon = ping[i_ping_process].navlon;
+            ping_out.sensordepth = ping[i_ping_process].sensordepth;
+            ping_out.t_input = mtime_dtime();
+            ping_out.reinit_eof = reinit_eof;
+            reinit_eof = false;
+
+            if (mbtrnpp_pipeline.enabled) {
+                // write MB1 file here, so that pings dropped
+                // by the TRN stage queue are still archived
+                s_mbtrnpp_write_mb1(&ping_out, output_mb1_fp);
+                // queue for TRN/publish threads; input resumes immediately
+                s_mbtrnpp_pipeline_submit(&mbtrnpp_pipeline, output_buffer, mb1_size, &ping_out);
+                // collect stats recorded by the stage threads
+                s_mbtrnpp_pipeline_merge_stats(&mbtrnpp_pipeline);
+            } else {
+                // TRN update, then MB1 publish/write (in order, this thread)
+                s_mbtrnpp_trn_stage(&ping_out, transmit_gain_threshold);
+                s_mbtrnpp_pub_stage(&ping_out);
+                s_mbtrnpp_write_mb1(&ping_out, output_mb1_fp);
             }
+
+            MBTRNPP_UPDATE_STATS(app_stats, mbtrnpp_mlog_id, mbtrn_cfg->mbtrnpp_stat_flags);
           } // else !stdout
         } // data read (ndata == mbtrn_cfg->n_buffer_max)
 
@@ -4710,11 +4854,9 @@ int main(int argc, char **argv) {
           fprintf(stderr, "%s\n", log_message);
 
           // force a reinit when data from the next file is opened
-          if (mbtrn_cfg->reinit_file_enable && !reinit_flag) {
-              fprintf(stderr, "--Reinit set due to closing input swath file\n");
-              mlog_tprintf(mbtrnpp_mlog_id,"i,mbtrnpp: set reinit due to closing input swath file [%s]\n", ifile);
-              MST_COUNTER_INC(app_stats->stats->events[MBTPP_EV_MB_EOF]);
-              reinit_flag = true;
+          // (requested with the next ping, set by the TRN stage)
+          if (mbtrn_cfg->reinit_file_enable) {
+              reinit_eof = true;
           }
 
           /* give the statistics */
@@ -4780,6 +4922,9 @@ int main(int argc, char **argv) {
     status = mbtrnpp_closelog(mbtrn_cfg->verbose, &logfp, &error);
   }
 
+  // flush queued pings and stop pipeline threads
+  s_mbtrnpp_pipeline_stop(&mbtrnpp_pipeline);
+
   /* close output */
   if ( OUTPUT_FLAG_SET(OUTPUT_MB1_FILE_EN) ) {
     fclose(output_mb1_fp);
@@ -5176,6 +5321,634 @@ int mbtrnpp_logstatistics(int verbose, FILE *logfp, int n_pings_read, int n_soun
 
 /*--------------------------------------------------------------------*/
 
+/// @fn void s_mbtrnpp_trn_stage(mbtrnpp_ping_t *ping, double transmit_gain_threshold)
+/// @brief TRN pipeline stage: gain check, filter reinit and TRN update for one MB1 record.
+/// @param[in] ping pipeline item
+/// @param[in] transmit_gain_threshold gain threshold
+/// @return none
+static void s_mbtrnpp_trn_stage(mbtrnpp_ping_t *ping, double transmit_gain_threshold)
+{
+#ifdef WITH_MBTNAV
+
+    bool update_trn = true;
+
+    // force a reinit when data from the next file is opened
+    if (ping->reinit_eof && !reinit_flag) {
+      fprintf(stderr, "--Reinit set due to closing input swath file\n");
+      mlog_tprintf(mbtrnpp_mlog_id,"i,mbtrnpp: set reinit due to closing input swath file\n");
+      MST_COUNTER_INC(app_stats->stats->events[MBTPP_EV_MB_EOF]);
+      reinit_flag = true;
+    }
+
+    // if gain thresholding applied and gain too low, do not process and set reinit flag
+    if (mbtrn_cfg->reinit_gain_enable && (ping->transmit_gain < transmit_gain_threshold)) {
+      update_trn = false;
+      if (!reinit_flag) {
+        fprintf(stderr, "--Reinit set due to transmit gain %f < threshold %f\n",
+                ping->transmit_gain, transmit_gain_threshold);
+        mlog_tprintf(mbtrnpp_mlog_id,"i,set reinit due to transmit gain [%.2lf] lower than threshold [%.2lf]\n",
+                      ping->transmit_gain, transmit_gain_threshold);
+        MST_COUNTER_INC(app_stats->stats->events[MBTPP_EV_MB_GAIN_LO]);
+        reinit_flag = true;
+      }
+    }
+    // if ok pass filtered ping to TRN for processing
+    if (update_trn) {
+
+      // if reinit_flag set then reinit the TRN filter
+      if (reinit_flag) {
+        reinitialized = true;
+        // TRN reinit function options are:
+        //
+        //   (1) reinit w/ zero offset and default standard deviations
+        //       which correspond to the particle filter distribution widths
+        //   wtnav_reinit_filter(trn_instance, true);
+        //
+        //   (2) Reinit w/ offset set to last good offset estimate and
+        //       default standard deviations
+        //   wtnav_reinit_filter_offset(trn_instance, true, use_offset_n, use_offset_e, use_offset_z);
+        //
+        //   (3) Reinit w/ offset set to last good offset estimate and
+        //       specified standard deviations (here set to default values)
+        //   d_triplet_t xyz_sdev={0., 0., 0.};
+        //   wtnav_get_init_stddev_xyz(trn_instance, &xyz_sdev);
+        //   wtnav_reinit_filter_box(trn_instance, true, use_offset_n, use_offset_e, use_offset_z,
+        //                                              xyz_sdev.x, xyz_sdev.y, xyz_sdev.z);
+        //
+        d_triplet_t xyz_sdev={0., 0., 0.};
+        xyz_sdev.x = MIN((n_reinit_since_use + 1), 10) * mbtrn_cfg->reinit_search_xy;
+        xyz_sdev.y = xyz_sdev.x;
+        xyz_sdev.z = mbtrn_cfg->reinit_search_z;
+        //wtnav_get_init_stddev_xyz(trn_instance, &xyz_sdev);
+        fprintf(stderr, "--reinit time_d:%.6f centered on offset: %f %f %f  sd: %f %f %f\n",
+                      ping->time_d, use_offset_e, use_offset_n, use_offset_z,
+                      xyz_sdev.x, xyz_sdev.y, xyz_sdev.z);
+        wtnav_reinit_filter_box(trn_instance, true, use_offset_n, use_offset_e, use_offset_z,
+                                  xyz_sdev.x, xyz_sdev.y, xyz_sdev.z);
+
+        mlog_tprintf(mbtrnpp_mlog_id, "i,trn filter reinit time_d:%.6f centered on offset: %f %f %f\n",
+                      ping->time_d, use_offset_e, use_offset_n, use_offset_z);
+        MST_COUNTER_INC(app_stats->stats->events[MBTPP_EV_MB_REINIT]);
+        reinit_flag = false;
+        n_reinit++;
+        n_reinit_since_use++;
+        reinit_time = ping->time_d;
+      }
+
+      MST_METRIC_START(app_stats->stats->metrics[MBTPP_CH_TRN_PROC_TRN_XT], mtime_dtime());
+
+      // do TRN processing, output, and tests for reinitializing TRN
+      mbtrnpp_trn_process_mb1(trn_instance, (mb1_t *)ping->mb1, trn_cfg);
+
+      MST_METRIC_LAP(app_stats->stats->metrics[MBTPP_CH_TRN_PROC_TRN_XT], mtime_dtime());
+
+    }
+
+    else {
+        int time_i[7];
+        mb_get_date(0, ping->time_d, time_i);
+        fprintf(stderr, "%4.4d/%2.2d/%2.2d-%2.2d:%2.2d:%2.2d.%6.6d %.6f "
+                        "| %11.6f %11.6f %8.3f | Ping not processed - low gain condition\n",
+        time_i[0], time_i[1], time_i[2], time_i[3], time_i[4], time_i[5], time_i[6], ping->time_d,
+        ping->navlon, ping->navlat, ping->sensordepth);
+        mbtrnpp_trnu_pubempty_osocket(ping->time_d, ping->navlat,
+          ping->navlon, ping->sensordepth,trnusvr);
+    }
+
+#else
+    (void)ping;
+    (void)transmit_gain_threshold;
+#endif // WITH_MBTNAV
+    return;
+}
+// End function s_mbtrnpp_trn_stage
+
+/// @fn void s_mbtrnpp_pub_stage(mbtrnpp_ping_t *ping)
+/// @brief publish pipeline stage: MB1 output (after TRN update, to
+/// enable synchronization, e.g. with sim).
+/// @param[in] ping pipeline item
+/// @return none
+static void s_mbtrnpp_pub_stage(mbtrnpp_ping_t *ping)
+{
+    MST_METRIC_START(app_stats->stats->metrics[MBTPP_CH_MB_PROC_MB1_XT], mtime_dtime());
+
+    // do MB1 processing/output
+    // after TRN processing/update to enable synchronization, e.g. with sim
+    // i.e. when MB1 record is published, TRN processing has completed
+    mbtrnpp_process_mb1(ping->mb1, ping->mb1_size, trn_cfg);
+
+    MST_METRIC_LAP(app_stats->stats->metrics[MBTPP_CH_MB_PROC_MB1_XT], mtime_dtime());
+
+    // end-to-end latency (preprocessed ping to published)
+    MST_METRIC_SET(app_stats->stats->metrics[MBTPP_CH_PIPE_E2E_XT], (mtime_dtime() - ping->t_input));
+    return;
+}
+// End function s_mbtrnpp_pub_stage
+
+/// @fn void s_mbtrnpp_write_mb1(mbtrnpp_ping_t *ping, FILE *output_mb1_fp)
+/// @brief (input thread) write MB1 record to file, if enabled.
+/// Not a pipeline stage, so that every ping is archived
+/// regardless of the pipeline backpressure policy.
+/// @param[in] ping ping (MB1 record)
+/// @param[in] output_mb1_fp MB1 output file (or NULL)
+/// @return none
+static void s_mbtrnpp_write_mb1(mbtrnpp_ping_t *ping, FILE *output_mb1_fp)
+{
+    /* write the packet to a file */
+    if ( OUTPUT_FLAG_SET(OUTPUT_MB1_FILE_EN) ) {
+
+        if(NULL!=output_mb1_fp && NULL!=ping->mb1){
+            MST_METRIC_START(app_stats->stats->metrics[MBTPP_CH_MB_FWRITE_XT], mtime_dtime());
+
+            size_t obytes=0;
+            if( (obytes=fwrite(ping->mb1, ping->mb1_size, 1, output_mb1_fp))>0){
+                MST_COUNTER_ADD(app_stats->stats->status[MBTPP_STA_MB_FWRITE_BYTES],ping->mb1_size);
+            } else {
+                MST_COUNTER_INC(app_stats->stats->events[MBTPP_EV_EMBLOGWR]);
+            }
+
+            MST_METRIC_LAP(app_stats->stats->metrics[MBTPP_CH_MB_FWRITE_XT], mtime_dtime());
+
+        } else {
+            fprintf(stderr,"%s:%d - ERR fwrite failed obuf[%p] fp[%p]\n",__FUNCTION__,__LINE__,ping->mb1,output_mb1_fp);
+        }
+    }
+    return;
+}
+// End function s_mbtrnpp_write_mb1
+
+/// @fn int s_stage_q_init(mbtrnpp_stage_q_t *self, int capacity, mbtrnpp_bp_policy_t policy)
+/// @brief initialize bounded stage queue
+/// @param[in] self queue reference
+/// @param[in] capacity queue capacity
+/// @param[in] policy backpressure policy
+/// @return 0 on success, -1 otherwise
+static int s_stage_q_init(mbtrnpp_stage_q_t *self, int capacity, mbtrnpp_bp_policy_t policy)
+{
+    int retval=-1;
+    if (NULL!=self && capacity>0) {
+        memset(self,0,sizeof(mbtrnpp_stage_q_t));
+        self->slot = (mbtrnpp_ping_t **)calloc(capacity, sizeof(mbtrnpp_ping_t *));
+        if (NULL!=self->slot) {
+            pthread_mutex_init(&self->mutex, NULL);
+            pthread_cond_init(&self->not_empty, NULL);
+            pthread_cond_init(&self->not_full, NULL);
+            self->capacity = capacity;
+            self->policy = policy;
+            retval=0;
+        }
+    }
+    return retval;
+}
+// End function s_stage_q_init
+
+/// @fn void s_stage_q_destroy(mbtrnpp_stage_q_t *self)
+/// @brief release stage queue resources (items are not released)
+/// @param[in] self queue reference
+/// @return none
+static void s_stage_q_destroy(mbtrnpp_stage_q_t *self)
+{
+    if (NULL!=self && NULL!=self->slot) {
+        pthread_cond_destroy(&self->not_full);
+        pthread_cond_destroy(&self->not_empty);
+        pthread_mutex_destroy(&self->mutex);
+        free(self->slot);
+        self->slot=NULL;
+    }
+}
+// End function s_stage_q_destroy
+
+/// @fn mbtrnpp_ping_t *s_stage_q_push(mbtrnpp_stage_q_t *self, mbtrnpp_ping_t *item, int *pdepth, int *phwm)
+/// @brief add item to stage queue, applying backpressure policy if full
+/// @param[in] self queue reference
+/// @param[in] item item to add
+/// @param[out] pdepth queue depth after push (optional)
+/// @param[out] phwm queue high water mark (optional)
+/// @return evicted (oldest) item if dropped, NULL otherwise
+static mbtrnpp_ping_t *s_stage_q_push(mbtrnpp_stage_q_t *self, mbtrnpp_ping_t *item, int *pdepth, int *phwm)
+{
+    mbtrnpp_ping_t *evicted=NULL;
+
+    pthread_mutex_lock(&self->mutex);
+    if (self->count == self->capacity) {
+        if (self->policy == MBTRNPP_BP_DROP_OLDEST) {
+            evicted = self->slot[self->head];
+            self->head = (self->head+1) % self->capacity;
+            self->count--;
+        } else {
+            while (self->count == self->capacity && !self->closed) {
+                pthread_cond_wait(&self->not_full, &self->mutex);
+            }
+            if (self->count == self->capacity) {
+                // closed while full: reject new item
+                pthread_mutex_unlock(&self->mutex);
+                return item;
+            }
+        }
+    }
+    self->slot[(self->head + self->count) % self->capacity] = item;
+    self->count++;
+    if (self->count > self->hwm) {
+        self->hwm = self->count;
+    }
+    if (NULL!=pdepth) {
+        *pdepth = self->count;
+    }
+    if (NULL!=phwm) {
+        *phwm = self->hwm;
+    }
+    pthread_cond_signal(&self->not_empty);
+    pthread_mutex_unlock(&self->mutex);
+
+    return evicted;
+}
+// End function s_stage_q_push
+
+/// @fn mbtrnpp_ping_t *s_stage_q_pop(mbtrnpp_stage_q_t *self)
+/// @brief remove item from stage queue, waiting until one is available
+/// @param[in] self queue reference
+/// @return item, or NULL if queue is closed and empty
+static mbtrnpp_ping_t *s_stage_q_pop(mbtrnpp_stage_q_t *self)
+{
+    mbtrnpp_ping_t *item=NULL;
+
+    pthread_mutex_lock(&self->mutex);
+    while (self->count == 0 && !self->closed) {
+        pthread_cond_wait(&self->not_empty, &self->mutex);
+    }
+    if (self->count > 0) {
+        item = self->slot[self->head];
+        self->head = (self->head+1) % self->capacity;
+        self->count--;
+        pthread_cond_signal(&self->not_full);
+    }
+    pthread_mutex_unlock(&self->mutex);
+
+    return item;
+}
+// End function s_stage_q_pop
+
+/// @fn void s_stage_q_close(mbtrnpp_stage_q_t *self)
+/// @brief close stage queue; consumers exit once queue is empty
+/// @param[in] self queue reference
+/// @return none
+static void s_stage_q_close(mbtrnpp_stage_q_t *self)
+{
+    pthread_mutex_lock(&self->mutex);
+    self->closed = true;
+    pthread_cond_broadcast(&self->not_empty);
+    pthread_cond_broadcast(&self->not_full);
+    pthread_mutex_unlock(&self->mutex);
+}
+// End function s_stage_q_close
+
+/// @fn void s_mbtrnpp_pipeline_forward(mbtrnpp_pipeline_t *self, mbtrnpp_stage_q_t *q, mbtrnpp_ping_t *item)
+/// @brief queue item for the next stage, counting and recycling dropped items
+/// @param[in] self pipeline reference
+/// @param[in] q destination stage queue
+/// @param[in] item pipeline item
+/// @return none
+static void s_mbtrnpp_pipeline_forward(mbtrnpp_pipeline_t *self, mbtrnpp_stage_q_t *q, mbtrnpp_ping_t *item)
+{
+    bool is_trn = (q == &self->trn_q);
+
+    // queue depth/hwm are sampled by the input thread (s_mbtrnpp_pipeline_merge_stats)
+    item->t_queue = mtime_dtime();
+    mbtrnpp_ping_t *evicted = s_stage_q_push(q, item, NULL, NULL);
+
+    if (NULL!=evicted) {
+        // keep the file reinit request of a dropped ping
+        if (evicted->reinit_eof) {
+            item->reinit_eof = true;
+        }
+        MST_COUNTER_INC(app_stats->stats->events[is_trn ? MBTPP_EV_PIPE_TRN_DROP : MBTPP_EV_PIPE_PUB_DROP]);
+        MX_LPRINT(MBTRNPP, 2, "pipeline %s queue full - dropped ping time_d[%.3lf]\n", (is_trn ? "trn" : "pub"), evicted->time_d);
+        s_stage_q_push(&self->free_q, evicted, NULL, NULL);
+    }
+}
+// End function s_mbtrnpp_pipeline_forward
+
+/// @fn void s_mbtrnpp_stats_merge(mstats_t *dest, mstats_t *src)
+/// @brief add src event/status counters and metric values to dest, and
+/// zero them in src. Latency channels (set once per ping) take the
+/// latest src value instead of the sum.
+/// @param[in] dest destination stats
+/// @param[in] src source stats
+/// @return none
+static void s_mbtrnpp_stats_merge(mstats_t *dest, mstats_t *src)
+{
+    if (NULL!=dest && NULL!=src) {
+        for (uint32_t i=0; i<src->event_n && i<dest->event_n; i++) {
+            dest->events[i] += src->events[i];
+            src->events[i] = 0;
+        }
+        for (uint32_t i=0; i<src->status_n && i<dest->status_n; i++) {
+            dest->status[i] += src->status[i];
+            src->status[i] = 0;
+        }
+        for (uint32_t i=0; i<src->metric_n && i<dest->metric_n; i++) {
+            bool is_latency = (i==MBTPP_CH_PIPE_TRN_QLAT_XT || i==MBTPP_CH_PIPE_PUB_QLAT_XT || i==MBTPP_CH_PIPE_E2E_XT);
+            if (is_latency) {
+                if (src->metrics[i].value != 0.0) {
+                    dest->metrics[i].value = src->metrics[i].value;
+                }
+            } else {
+                dest->metrics[i].value += src->metrics[i].value;
+            }
+            src->metrics[i].value = 0.0;
+        }
+    }
+}
+// End function s_mbtrnpp_stats_merge
+
+/// @fn int s_stage_stats_init(mbtrnpp_stage_stats_t *self)
+/// @brief initialize pipeline stage stats
+/// @param[in] self stage stats reference
+/// @return 0 on success, -1 otherwise
+static int s_stage_stats_init(mbtrnpp_stage_stats_t *self)
+{
+    int retval=-1;
+    if (NULL!=self) {
+        memset(self,0,sizeof(mbtrnpp_stage_stats_t));
+        pthread_mutex_init(&self->mutex, NULL);
+        self->work = mstats_profile_new(MBTPP_EV_COUNT, MBTPP_STA_COUNT, MBTPP_CH_COUNT, mbtrnpp_stats_labels,
+                                        mtime_dtime(), mbtrn_cfg->trn_status_interval_sec);
+        self->pending = mstats_profile_new(MBTPP_EV_COUNT, MBTPP_STA_COUNT, MBTPP_CH_COUNT, mbtrnpp_stats_labels,
+                                           mtime_dtime(), mbtrn_cfg->trn_status_interval_sec);
+        self->netif_period_start = mtime_etime();
+        if (NULL!=self->work && NULL!=self->work->stats &&
+            NULL!=self->pending && NULL!=self->pending->stats) {
+            retval=0;
+        }
+    }
+    return retval;
+}
+// End function s_stage_stats_init
+
+/// @fn void s_stage_stats_destroy(mbtrnpp_stage_stats_t *self)
+/// @brief release pipeline stage stats resources
+/// @param[in] self stage stats reference
+/// @return none
+static void s_stage_stats_destroy(mbtrnpp_stage_stats_t *self)
+{
+    if (NULL!=self) {
+        mstats_profile_destroy(&self->work);
+        mstats_profile_destroy(&self->pending);
+        pthread_mutex_destroy(&self->mutex);
+    }
+}
+// End function s_stage_stats_destroy
+
+/// @fn void s_stage_stats_fold(mbtrnpp_stage_stats_t *self)
+/// @brief (stage thread) move stats recorded while processing an item
+/// into the pending stats read by the input thread
+/// @param[in] self stage stats reference
+/// @return none
+static void s_stage_stats_fold(mbtrnpp_stage_stats_t *self)
+{
+    pthread_mutex_lock(&self->mutex);
+    s_mbtrnpp_stats_merge(self->pending->stats, self->work->stats);
+    pthread_mutex_unlock(&self->mutex);
+}
+// End function s_stage_stats_fold
+
+/// @fn void s_stage_stats_netif(mbtrnpp_stage_stats_t *self, netif_t **netifs, int n)
+/// @brief (stage thread) update, and periodically log and reset, the stats
+/// of the netifs used by the stage. When the pipeline is enabled these are
+/// only written by the stage thread, so they are updated there.
+/// @param[in] self stage stats reference
+/// @param[in] netifs netif list (entries may be NULL)
+/// @param[in] n number of netifs
+/// @return none
+static void s_stage_stats_netif(mbtrnpp_stage_stats_t *self, netif_t **netifs, int n)
+{
+    mstats_flags flags = mbtrn_cfg->mbtrnpp_stat_flags;
+    double stats_now = mtime_etime();
+    double period_sec = mbtrn_cfg->trn_status_interval_sec;
+    bool log_period = (period_sec > 0.0 && (stats_now - self->netif_period_start) > period_sec);
+
+    for (int i=0; i<n; i++) {
+        mstats_t *netif_stats_i = netif_stats(netifs[i]);
+        if (NULL!=netif_stats_i) {
+            mstats_update_stats(netif_stats_i, NETIF_CH_COUNT, flags);
+            if (log_period) {
+                mstats_log_stats(netif_stats_i, stats_now, netif_log(netifs[i]), flags);
+                mstats_reset_pstats(netif_stats_i, NETIF_CH_COUNT);
+            }
+        }
+    }
+    if (log_period) {
+        self->netif_period_start = stats_now;
+    }
+}
+// End function s_stage_stats_netif
+
+/// @fn void s_mbtrnpp_pipeline_merge_stats(mbtrnpp_pipeline_t *self)
+/// @brief (input thread) merge pending stage stats into the main app_stats
+/// and sample stage queue depth and high water marks
+/// @param[in] self pipeline reference
+/// @return none
+static void s_mbtrnpp_pipeline_merge_stats(mbtrnpp_pipeline_t *self)
+{
+    if (NULL!=self && self->enabled && NULL!=app_stats) {
+        mbtrnpp_stage_stats_t *stage[2] = {&self->trn_stats, &self->pub_stats};
+        for (int i=0; i<2; i++) {
+            pthread_mutex_lock(&stage[i]->mutex);
+            s_mbtrnpp_stats_merge(app_stats->stats, stage[i]->pending->stats);
+            pthread_mutex_unlock(&stage[i]->mutex);
+        }
+
+        pthread_mutex_lock(&self->trn_q.mutex);
+        MST_COUNTER_SET(app_stats->stats->status[MBTPP_STA_PIPE_TRN_QDEPTH], self->trn_q.count);
+        MST_COUNTER_SET(app_stats->stats->status[MBTPP_STA_PIPE_TRN_QHWM], self->trn_q.hwm);
+        pthread_mutex_unlock(&self->trn_q.mutex);
+        pthread_mutex_lock(&self->pub_q.mutex);
+        MST_COUNTER_SET(app_stats->stats->status[MBTPP_STA_PIPE_PUB_QDEPTH], self->pub_q.count);
+        MST_COUNTER_SET(app_stats->stats->status[MBTPP_STA_PIPE_PUB_QHWM], self->pub_q.hwm);
+        pthread_mutex_unlock(&self->pub_q.mutex);
+    }
+}
+// End function s_mbtrnpp_pipeline_merge_stats
+
+/// @fn void *s_mbtrnpp_trn_thread_fn(void *arg)
+/// @brief TRN stage thread: trn_q -> TRN update -> pub_q
+/// @param[in] arg pipeline reference
+/// @return NULL
+static void *s_mbtrnpp_trn_thread_fn(void *arg)
+{
+    mbtrnpp_pipeline_t *self = (mbtrnpp_pipeline_t *)arg;
+    mbtrnpp_ping_t *item = NULL;
+    netif_t *netifs[3] = {trnsvr, trnusvr, trnumsvr};
+
+    // record stats in this stage's own profile
+    app_stats = self->trn_stats.work;
+
+    while ( (item = s_stage_q_pop(&self->trn_q)) != NULL) {
+        MST_METRIC_SET(app_stats->stats->metrics[MBTPP_CH_PIPE_TRN_QLAT_XT], (mtime_dtime() - item->t_queue));
+        s_mbtrnpp_trn_stage(item, self->transmit_gain_threshold);
+        s_mbtrnpp_pipeline_forward(self, &self->pub_q, item);
+        s_stage_stats_netif(&self->trn_stats, netifs, 3);
+        s_stage_stats_fold(&self->trn_stats);
+    }
+    // no more input; let publisher finish
+    s_stage_q_close(&self->pub_q);
+    return NULL;
+}
+// End function s_mbtrnpp_trn_thread_fn
+
+/// @fn void *s_mbtrnpp_pub_thread_fn(void *arg)
+/// @brief publish stage thread: pub_q -> MB1 publish/write -> free_q
+/// @param[in] arg pipeline reference
+/// @return NULL
+static void *s_mbtrnpp_pub_thread_fn(void *arg)
+{
+    mbtrnpp_pipeline_t *self = (mbtrnpp_pipeline_t *)arg;
+    mbtrnpp_ping_t *item = NULL;
+    netif_t *netifs[1] = {mb1svr};
+
+    // record stats in this stage's own profile
+    app_stats = self->pub_stats.work;
+
+    while ( (item = s_stage_q_pop(&self->pub_q)) != NULL) {
+        MST_METRIC_SET(app_stats->stats->metrics[MBTPP_CH_PIPE_PUB_QLAT_XT], (mtime_dtime() - item->t_queue));
+        s_mbtrnpp_pub_stage(item);
+        s_stage_stats_netif(&self->pub_stats, netifs, 1);
+        s_stage_stats_fold(&self->pub_stats);
+        s_stage_q_push(&self->free_q, item, NULL, NULL);
+    }
+    return NULL;
+}
+// End function s_mbtrnpp_pub_thread_fn
+
+/// @fn int s_mbtrnpp_pipeline_start(mbtrnpp_pipeline_t *self, int depth, mbtrnpp_bp_policy_t policy, double transmit_gain_threshold)
+/// @brief allocate item pool and stage queues, start TRN and publish threads.
+/// @param[in] self pipeline reference
+/// @param[in] depth stage queue capacity
+/// @param[in] policy TRN stage queue backpressure policy
+/// (the publish stage queue always blocks)
+/// @param[in] transmit_gain_threshold gain threshold
+/// @return 0 on success, -1 otherwise
+static int s_mbtrnpp_pipeline_start(mbtrnpp_pipeline_t *self, int depth, mbtrnpp_bp_policy_t policy,
+                                    double transmit_gain_threshold)
+{
+    int retval=-1;
+
+    if (NULL!=self && depth>0) {
+        memset(self,0,sizeof(mbtrnpp_pipeline_t));
+        // items in both queues, plus one in each stage
+        self->pool_n = 2*depth + 3;
+        self->pool = (mbtrnpp_ping_t *)calloc(self->pool_n, sizeof(mbtrnpp_ping_t));
+        self->transmit_gain_threshold = transmit_gain_threshold;
+
+        if (NULL!=self->pool &&
+            s_stage_stats_init(&self->trn_stats)==0 &&
+            s_stage_stats_init(&self->pub_stats)==0 &&
+            s_stage_q_init(&self->free_q, self->pool_n, MBTRNPP_BP_BLOCK)==0 &&
+            s_stage_q_init(&self->trn_q, depth, policy)==0 &&
+            s_stage_q_init(&self->pub_q, depth, MBTRNPP_BP_BLOCK)==0) {
+
+            for (int i=0; i<self->pool_n; i++) {
+                s_stage_q_push(&self->free_q, &self->pool[i], NULL, NULL);
+            }
+            // hwm tracks in-flight items for stage queues only
+            self->free_q.hwm = 0;
+
+            self->trn_thread = mthread_thread_new();
+            self->pub_thread = mthread_thread_new();
+            if (mthread_thread_start(self->trn_thread, s_mbtrnpp_trn_thread_fn, self)==0 &&
+                mthread_thread_start(self->pub_thread, s_mbtrnpp_pub_thread_fn, self)==0) {
+                self->enabled = true;
+                retval=0;
+                mlog_tprintf(mbtrnpp_mlog_id,"i,pipeline started depth[%d] policy[%s]\n", depth,
+                             (policy==MBTRNPP_BP_BLOCK ? "block" : "drop"));
+            }
+        }
+        if (retval!=0) {
+            fprintf(stderr,"pipeline start failed - processing synchronously\n");
+            mlog_tprintf(mbtrnpp_mlog_id,"e,pipeline start failed\n");
+        }
+    }
+    return retval;
+}
+// End function s_mbtrnpp_pipeline_start
+
+/// @fn int s_mbtrnpp_pipeline_submit(mbtrnpp_pipeline_t *self, char *mb1, size_t mb1_size, mbtrnpp_ping_t *ping)
+/// @brief copy MB1 record and ping fields into a pool item and queue it for TRN.
+/// Waits for a free item if all are in use (only when policy is block).
+/// @param[in] self pipeline reference
+/// @param[in] mb1 MB1 record
+/// @param[in] mb1_size MB1 record size
+/// @param[in] ping ping fields (mb1 members ignored)
+/// @return 0 on success, -1 otherwise
+static int s_mbtrnpp_pipeline_submit(mbtrnpp_pipeline_t *self, char *mb1, size_t mb1_size, mbtrnpp_ping_t *ping)
+{
+    int retval=-1;
+    mbtrnpp_ping_t *item = s_stage_q_pop(&self->free_q);
+
+    if (NULL!=item) {
+        // item buffers are only (re)allocated by the input thread,
+        // using libc (mb_mem allocation list is not thread safe)
+        if (item->mb1_alloc < mb1_size) {
+            char *nbuf = (char *)realloc(item->mb1, mb1_size);
+            if (NULL!=nbuf) {
+                item->mb1 = nbuf;
+                item->mb1_alloc = mb1_size;
+            } else {
+                s_stage_q_push(&self->free_q, item, NULL, NULL);
+                mlog_tprintf(mbtrnpp_mlog_id,"e,pipeline item alloc failed size[%zu]\n", mb1_size);
+                return retval;
+            }
+        }
+        char *buf = item->mb1;
+        size_t alloc = item->mb1_alloc;
+        *item = *ping;
+        item->mb1 = buf;
+        item->mb1_alloc = alloc;
+        item->mb1_size = mb1_size;
+        memcpy(item->mb1, mb1, mb1_size);
+
+        s_mbtrnpp_pipeline_forward(self, &self->trn_q, item);
+        retval=0;
+    }
+    return retval;
+}
+// End function s_mbtrnpp_pipeline_submit
+
+/// @fn void s_mbtrnpp_pipeline_stop(mbtrnpp_pipeline_t *self)
+/// @brief flush queued pings, stop stage threads and release resources.
+/// @param[in] self pipeline reference
+/// @return none
+static void s_mbtrnpp_pipeline_stop(mbtrnpp_pipeline_t *self)
+{
+    if (NULL!=self && self->enabled) {
+        // TRN thread closes pub_q when trn_q is empty
+        s_stage_q_close(&self->trn_q);
+        mthread_thread_join(self->trn_thread);
+        mthread_thread_join(self->pub_thread);
+        mthread_thread_destroy(&self->trn_thread);
+        mthread_thread_destroy(&self->pub_thread);
+
+        // collect the last stage stats, then release them
+        s_mbtrnpp_pipeline_merge_stats(self);
+        s_stage_stats_destroy(&self->trn_stats);
+        s_stage_stats_destroy(&self->pub_stats);
+
+        mlog_tprintf(mbtrnpp_mlog_id,"i,pipeline stopped trn_hwm[%d] pub_hwm[%d]\n", self->trn_q.hwm, self->pub_q.hwm);
+
+        for (int i=0; i<self->pool_n; i++) {
+            free(self->pool[i].mb1);
+            self->pool[i].mb1 = NULL;
+        }
+        free(self->pool);
+        self->pool = NULL;
+        s_stage_q_destroy(&self->free_q);
+        s_stage_q_destroy(&self->trn_q);
+        s_stage_q_destroy(&self->pub_q);
+        self->enabled = false;
+    }
+}
+// End function s_mbtrnpp_pipeline_stop
+
 int mbtrnpp_update_stats(mstats_profile_t *stats, mlog_id_t log_id, mstats_flags flags) {
 
   if (NULL != stats) {
@@ -5220,13 +5993,16 @@ int mbtrnpp_update_stats(mstats_profile_t *stats, mlog_id_t log_id, mstats_flags
 
     // update stats
     mstats_update_stats(stats->stats, MBTPP_CH_COUNT, flags);
-    mstats_t *mb1svr_stats = netif_stats(mb1svr);
+    // netif stats are owned by the pipeline stage threads when enabled
+    // (NULL stats are skipped by mstats_update/log/reset)
+    bool netif_local = !mbtrnpp_pipeline.enabled;
+    mstats_t *mb1svr_stats = netif_local ? netif_stats(mb1svr) : NULL;
     mstats_update_stats(mb1svr_stats, NETIF_CH_COUNT, flags);
-    mstats_t *trnsvr_stats = netif_stats(trnsvr);
+    mstats_t *trnsvr_stats = netif_local ? netif_stats(trnsvr) : NULL;
     mstats_update_stats(trnsvr_stats, NETIF_CH_COUNT, flags);
-    mstats_t *trnusvr_stats = netif_stats(trnusvr);
+    mstats_t *trnusvr_stats = netif_local ? netif_stats(trnusvr) : NULL;
     mstats_update_stats(trnusvr_stats, NETIF_CH_COUNT, flags);
-    mstats_t *trnumsvr_stats = netif_stats(trnumsvr);
+    mstats_t *trnumsvr_stats = netif_local ? netif_stats(trnumsvr) : NULL;
     mstats_update_stats(trnumsvr_stats, NETIF_CH_COUNT, flags);
 
       MX_LPRINT(MBTRNPP, 4, "cycle_xt.p: N[%"PRId64"] sum[%.3lf] min[%.3lf] max[%.3lf] avg[%.3lf]\n",
@@ -6588,6 +7364,51 @@ int mbtrnpp_process_mb1(char *src, size_t len, trn_config_t *cfg)
 
 /*--------------------------------------------------------------------*/
 
+/// @fn mbtrnpp_input_t *s_mbtrnpp_input_new(void *reader, int sd)
+/// @brief create socket input context. The kmall receive batch
+/// is allocated for socket (sd>=0) inputs only.
+/// @param[in] reader r7kr/mb1r reader (or NULL)
+/// @param[in] sd kmall socket (or -1)
+/// @return new input context, or NULL on error
+static mbtrnpp_input_t *s_mbtrnpp_input_new(void *reader, int sd)
+{
+    mbtrnpp_input_t *self = (mbtrnpp_input_t *)calloc(1, sizeof(mbtrnpp_input_t));
+
+    if (NULL != self) {
+        self->reader = reader;
+        self->sd = sd;
+        if (sd >= 0) {
+            self->rx.buf = (char *)malloc((size_t)MBTRNPP_KMALL_RX_BATCH * MB_UDP_SIZE_MAX);
+            self->rx.record = (char *)malloc((size_t)MBSYS_KMBES_MAX_NUM_MRZ_DGMS * MB_UDP_SIZE_MAX);
+            if (NULL == self->rx.buf || NULL == self->rx.record) {
+                s_mbtrnpp_input_destroy(&self);
+            }
+        }
+    }
+    return self;
+}
+// End function s_mbtrnpp_input_new
+
+/// @fn void s_mbtrnpp_input_destroy(mbtrnpp_input_t **pself)
+/// @brief release socket input context buffers (the caller
+/// closes the reader/socket)
+/// @param[in] pself pointer to input context reference
+/// @return none
+static void s_mbtrnpp_input_destroy(mbtrnpp_input_t **pself)
+{
+    if (NULL != pself && NULL != *pself) {
+        mbtrnpp_input_t *self = *pself;
+        free(self->lease_buf);
+        free(self->rx.buf);
+        free(self->rx.record);
+        free(self);
+        *pself = NULL;
+    }
+}
+// End function s_mbtrnpp_input_destroy
+
+/*--------------------------------------------------------------------*/
+
 int mbtrnpp_reson7kr_input_open(int verbose, void *mbio_ptr, char *definition, int *error)
 {
 
@@ -6653,7 +7474,7 @@ int mbtrnpp_reson7kr_input_open(int verbose, void *mbio_ptr, char *definition, i
   if (NULL != mb_io_ptr && NULL != reader) {
 
     // set r7k_reader
-    mb_io_ptr->mbsp = (void *) reader;
+    mb_io_ptr->mbsp = (void *) s_mbtrnpp_input_new(reader, -1);
 
     if (reader->state == R7KR_CONNECTED || reader->state == R7KR_SUBSCRIBED) {
       // update application performance profile
@@ -6752,6 +7573,62 @@ int mbtrnpp_reson7kr_validate_drf(r7k_drf_t *pdrf)
     return retval;
 }
 
+/// @fn bool s_mbtrnpp_reson7kr_recover(r7kr_reader_t *reader, uint32_t sync_bytes, int *status, int *error)
+/// @brief update stats after a failed r7kr frame read and reconnect the
+/// reader if the socket was disconnected (clears status/error).
+/// @param[in] reader r7kr reader reference
+/// @param[in] sync_bytes bytes skipped by the failed read
+/// @param[in,out] status MBIO status
+/// @param[in,out] error MBIO error
+/// @return true if the reader was reconnected, false otherwise
+static bool s_mbtrnpp_reson7kr_recover(r7kr_reader_t *reader, uint32_t sync_bytes, int *status, int *error)
+{
+    bool retval = false;
+
+    MST_METRIC_START(app_stats->stats->metrics[MBTPP_CH_MB_GETFAIL_XT], mtime_dtime());
+    MX_LPRINT(MBTRNPP, 4, "r7kr read failed: sync_bytes[%d] status[%d] err[%d]\n",sync_bytes,*status, *error);
+
+    MST_COUNTER_INC(app_stats->stats->events[MBTPP_EV_EMBFRAMERD]);
+    MST_COUNTER_ADD(app_stats->stats->status[MBTPP_STA_MB_SYNC_BYTES],sync_bytes);
+
+    // check connection status (socket errors)
+    // only reconnect if disconnected
+    if ((NULL!=reader && reader->state==R7KR_INITIALIZED) || (me_errno==ME_ESOCK) || (me_errno==ME_EOF)  ) {
+
+        fprintf(stderr,"EOF (input socket) - clear status/error\n");
+        *status = MB_SUCCESS;
+        *error = MB_ERROR_NO_ERROR;
+
+        MST_COUNTER_INC(app_stats->stats->events[MBTPP_EV_EMBSOCKET]);
+
+        // empty the reader's record frame container
+        r7kr_reader_purge(reader);
+
+        mlog_tprintf(mbtrnpp_mlog_id,"mbtrnpp: input socket status[%s]\n",r7kr_strstate(reader->state));
+        MST_COUNTER_INC(app_stats->stats->events[MBTPP_EV_MB_DISN]);
+
+        // re-connect reader
+        if (r7kr_reader_connect(reader,true)==0) {
+            retval = true;
+            fprintf(stderr,"mbtrnpp: input socket connected status[%s]\n",r7kr_strstate(reader->state));
+            mlog_tprintf(mbtrnpp_mlog_id,"mbtrnpp: input socket connected status[%s]\n",r7kr_strstate(reader->state));
+            MST_COUNTER_INC(app_stats->stats->events[MBTPP_EV_MB_CONN]);
+        } else {
+            fprintf(stderr,"mbtrnpp: input socket reconnect failed status[%s]\n",r7kr_strstate(reader->state));
+            mlog_tprintf(mbtrnpp_mlog_id,"mbtrnpp: input socket reconnect failed status[%s]\n",r7kr_strstate(reader->state));
+            MST_COUNTER_INC(app_stats->stats->events[MBTPP_EV_EMBCON]);
+
+            struct timespec twait={0},trem={0};
+            twait.tv_sec=5;
+            nanosleep(&twait,&trem);
+        }
+    }
+
+    MST_METRIC_LAP(app_stats->stats->metrics[MBTPP_CH_MB_GETFAIL_XT], mtime_dtime());
+
+    return retval;
+}
+
 int mbtrnpp_reson7kr_input_read(int verbose, void *mbio_ptr, size_t *size, char *buffer, int *error)
 {
 
@@ -6784,7 +7661,8 @@ int mbtrnpp_reson7kr_input_read(int verbose, void *mbio_ptr, size_t *size, char
     // read and return single frame
     uint32_t sync_bytes=0;
     int64_t rbytes=-1;
-    r7kr_reader_t *reader = (r7kr_reader_t *)mb_io_ptr->mbsp;
+    mbtrnpp_input_t *input = (mbtrnpp_input_t *)mb_io_ptr->mbsp;
+    r7kr_reader_t *reader = (NULL != input ? (r7kr_reader_t *)input->reader : NULL);
 
     // frame buffer for byte-wise reads
     static byte *frame_buf = NULL;
@@ -6886,53 +7764,109 @@ int mbtrnpp_reson7kr_input_read(int verbose, void *mbio_ptr, size_t *size, char
         *error   = MB_ERROR_EOF;
         *size    = (size_t)rbytes;
 
-        MST_METRIC_START(app_stats->stats->metrics[MBTPP_CH_MB_GETFAIL_XT], mtime_dtime());
-        MX_LPRINT(MBTRNPP, 4, "r7kr_read_stripped_frame failed: sync_bytes[%d] status[%d] err[%d]\n",sync_bytes,status, *error);
+        if (s_mbtrnpp_reson7kr_recover(reader, sync_bytes, &status, error)) {
+            read_frame = true;
+            read_err = false;
+        }
+    }
 
-        MST_COUNTER_INC(app_stats->stats->events[MBTPP_EV_EMBFRAMERD]);
-        MST_COUNTER_ADD(app_stats->stats->status[MBTPP_STA_MB_SYNC_BYTES],sync_bytes);
+    // print output debug statements
+    if (verbose >= 2) {
+        fprintf(stderr, "\ndbg2  MBIO function <%s> completed\n", __func__);
+        fprintf(stderr, "dbg2  Return values:\n");
+        fprintf(stderr, "dbg2       error:              %d\n", *error);
+        fprintf(stderr, "dbg2  Return status:\n");
+        fprintf(stderr, "dbg2       status:             %d\n", status);
+    }
 
-        // check connection status (socket errors)
-        // only reconnect if disconnected
-        if ((NULL!=reader && reader->state==R7KR_INITIALIZED) || (me_errno==ME_ESOCK) || (me_errno==ME_EOF)  ) {
+    return (status);
+}
 
-            fprintf(stderr,"EOF (input socket) - clear status/error\n");
-            status = MB_SUCCESS;
-            *error = MB_ERROR_NO_ERROR;
+/*--------------------------------------------------------------------*/
+
+int mbtrnpp_reson7kr_input_lease(int verbose, void *mbio_ptr, char **frame, size_t *size, int *error)
+{
+    // local variables
+    int status = MB_SUCCESS;
+    struct mb_io_struct *mb_io_ptr;
+
+    // print input debug statements
+    if (verbose >= 2) {
+        fprintf(stderr, "\ndbg2  MBIO function <%s> called\n", __func__);
+        fprintf(stderr, "dbg2  Input arguments:\n");
+        fprintf(stderr, "dbg2       verbose:    %d\n", verbose);
+        fprintf(stderr, "dbg2       mbio_ptr:   %p\n", mbio_ptr);
+        fprintf(stderr, "dbg2       frame:      %p\n", frame);
+    }
 
-            MST_COUNTER_INC(app_stats->stats->events[MBTPP_EV_EMBSOCKET]);
+    // get pointer to mbio descriptor
+    mb_io_ptr = (struct mb_io_struct *)mbio_ptr;
 
-            // empty the reader's record frame container
-            r7kr_reader_purge(reader);
+    // set initial status
+    *error = MB_ERROR_NO_ERROR;
+    *frame = NULL;
+    *size = 0;
 
-            mlog_tprintf(mbtrnpp_mlog_id,"mbtrnpp: input socket status[%s]\n",r7kr_strstate(reader->state));
-            MST_COUNTER_INC(app_stats->stats->events[MBTPP_EV_MB_DISN]);
+    // Read one s7k network frame from the socket and return a pointer to
+    // its data record frame (DRF) in place. Unlike input_read, the frame is
+    // not stripped (memmove) or copied into the MBIO buffer; it remains
+    // valid until the next call.
+    uint32_t sync_bytes=0;
+    int64_t rbytes=-1;
+    mbtrnpp_input_t *input = (mbtrnpp_input_t *)mb_io_ptr->mbsp;
+    r7kr_reader_t *reader = (NULL != input ? (r7kr_reader_t *)input->reader : NULL);
 
-            // re-connect reader
-            if (r7kr_reader_connect(reader,true)==0) {
-                read_frame = true;
-                read_err = false;
-                fprintf(stderr,"mbtrnpp: input socket connected status[%s]\n",r7kr_strstate(reader->state));
-                mlog_tprintf(mbtrnpp_mlog_id,"mbtrnpp: input socket connected status[%s]\n",r7kr_strstate(reader->state));
-                MST_COUNTER_INC(app_stats->stats->events[MBTPP_EV_MB_CONN]);
-            } else {
-                fprintf(stderr,"mbtrnpp: input socket reconnect failed status[%s]\n",r7kr_strstate(reader->state));
-                mlog_tprintf(mbtrnpp_mlog_id,"mbtrnpp: input socket reconnect failed status[%s]\n",r7kr_strstate(reader->state));
-                MST_COUNTER_INC(app_stats->stats->events[MBTPP_EV_EMBCON]);
+    if(NULL != input && NULL == input->lease_buf)
+    {
+        input->lease_buf = (byte *)malloc(R7K_MAX_FRAME_BYTES);
+    }
+    byte *lease_buf = (NULL != input ? input->lease_buf : NULL);
+
+    if(NULL != reader && NULL != lease_buf)
+    {
+        // returns network frame (NF) + DRF
+        if ( (rbytes = r7kr_read_frame(reader, lease_buf, R7K_MAX_FRAME_BYTES,
+                                       R7KR_NET_STREAM, 0.0, R7KR_READ_TMOUT_MSEC,
+                                       &sync_bytes)) > R7K_NF_BYTES)
+        {
+            r7k_drf_t *pdrf = (r7k_drf_t *)(lease_buf + R7K_NF_BYTES);
 
-                struct timespec twait={0},trem={0};
-                twait.tv_sec=5;
-                nanosleep(&twait,&trem);
+            if(pdrf->size <= (uint32_t)(rbytes - R7K_NF_BYTES) &&
+               mbtrnpp_reson7kr_validate_drf(pdrf)==0)
+            {
+                *frame = (char *)pdrf;
+                *size = pdrf->size;
+                MST_COUNTER_INC(app_stats->stats->status[MBTPP_STA_MB_ZC_FRAMES]);
+                MST_COUNTER_ADD(app_stats->stats->status[MBTPP_STA_MB_ZC_BYTES], pdrf->size);
+                MX_LPRINT(MBTRNPP, 3, "lease frame len[%zu]:\n",(size_t)pdrf->size);
+            } else {
+                status = MB_FAILURE;
+                MX_LPRINT(MBTRNPP, 3, "invalid frame rbytes[%zu] size[%zu]\n",(size_t)rbytes, (size_t)pdrf->size);
             }
+        } else {
+            status = MB_FAILURE;
+            MX_LPRINT(MBTRNPP, 3, "r7kr_read_frame failed rbytes[%"PRId64"]\n",rbytes);
         }
+    } else {
+        status = MB_FAILURE;
+        fprintf(stderr, "%s : ERR - reader or frame buffer is NULL\n", __func__);
+    }
 
-        MST_METRIC_LAP(app_stats->stats->metrics[MBTPP_CH_MB_GETFAIL_XT], mtime_dtime());
+    if(status == MB_FAILURE)
+    {
+        // read error - invalid frame or socket error
+        *error = MB_ERROR_EOF;
+        if (NULL != reader) {
+            s_mbtrnpp_reson7kr_recover(reader, sync_bytes, &status, error);
+        }
     }
 
     // print output debug statements
     if (verbose >= 2) {
         fprintf(stderr, "\ndbg2  MBIO function <%s> completed\n", __func__);
         fprintf(stderr, "dbg2  Return values:\n");
+        fprintf(stderr, "dbg2       frame:              %p\n", *frame);
+        fprintf(stderr, "dbg2       size:               %zu\n", *size);
         fprintf(stderr, "dbg2       error:              %d\n", *error);
         fprintf(stderr, "dbg2  Return status:\n");
         fprintf(stderr, "dbg2       status:             %d\n", status);
@@ -6966,8 +7900,12 @@ int mbtrnpp_reson7kr_input_close(int verbose, void *mbio_ptr, int *error) {
   /* Close the socket based input for reading using function
    * mbtrnpp_reson7kr_input_read(). Deallocate the internal, hidden buffer and any
    * other resources that were allocated by mbtrnpp_reson7kr_input_init(). */
-  r7kr_reader_t *reader = (r7kr_reader_t *)mb_io_ptr->mbsp;
-  r7kr_reader_destroy(&reader);
+  mbtrnpp_input_t *input = (mbtrnpp_input_t *)mb_io_ptr->mbsp;
+  if (NULL != input) {
+    r7kr_reader_t *reader = (r7kr_reader_t *)input->reader;
+    r7kr_reader_destroy(&reader);
+    s_mbtrnpp_input_destroy(&input);
+  }
   mb_io_ptr->mbsp = NULL;
 
   /* print output debug statements */
@@ -7094,11 +8032,16 @@ int mbtrnpp_kemkmall_input_open(int verbose, void *mbio_ptr, char *definition, i
 	return status;
   }
 
-  // save the socket within the mb_io structure
-  int *sd_ptr = NULL;
-  status &= mb_mallocd(verbose, __FILE__, __LINE__, sizeof(sd), (void **)&sd_ptr, error);
-  *sd_ptr = sd;
-  mb_io_ptr->mbsp = (void *) sd_ptr;
+  // save the socket and receive batch within the mb_io structure
+  mbtrnpp_input_t *input = s_mbtrnpp_input_new(NULL, sd);
+  if (NULL == input) {
+    close(sd);
+    mlog_tprintf(mbtrnpp_mlog_id,"e,kmall input alloc failed\n");
+    status=MB_FAILURE;
+    *error=MB_ERROR_MEMORY_FAIL;
+    return status;
+  }
+  mb_io_ptr->mbsp = (void *) input;
 
   /*initialize buffer for fragmented MWZ and MRC datagrams*/
   memset(mRecordBuf, 0, sizeof(mRecordBuf));
@@ -7239,6 +8182,149 @@ int mbtrnpp_kemkmall_rd_hdr(int verbose, char *buffer, void *header_ptr, void *e
 
 /*--------------------------------------------------------------------*/
 
+/// @fn bool s_mbtrnpp_kemkmall_reassemble(int verbose, char *dgm, char *dest, size_t *dest_size, int *error)
+/// @brief collect partitioned (multi-packet) MRZ/MWC datagrams and
+/// reassemble the complete record when the last partition arrives.
+/// @param[in] verbose verbose level
+/// @param[in] dgm MRZ or MWC datagram
+/// @param[out] dest reassembled record (may be the same as dgm)
+/// @param[out] dest_size reassembled record size (optional)
+/// @param[out] error MBIO error
+/// @return true if dgm was partitioned and completed a record in dest, false otherwise
+static bool s_mbtrnpp_kemkmall_reassemble(int verbose, char *dgm, char *dest, size_t *dest_size, int *error)
+{
+  static int dgmsReceived=0;
+  static unsigned int pingSecs, pingNanoSecs;
+  static int totalDgms;
+  bool retval = false;
+  struct mbsys_kmbes_header header;
+  mbsys_kmbes_emdgm_type emdgm_type=UNKNOWN;
+  unsigned short numOfDgms=0;
+  unsigned short dgmNum=0;
+
+  int status = mbtrnpp_kemkmall_rd_hdr(verbose, dgm, (void *)&header, (void *)&emdgm_type, error);
+  mb_get_binary_short(true, &dgm[MBSYS_KMBES_HEADER_SIZE], &numOfDgms);
+  mb_get_binary_short(true, &dgm[MBSYS_KMBES_HEADER_SIZE+2], &dgmNum);
+
+  if (status == MB_SUCCESS && numOfDgms > 1) {
+
+    /* if we get a M record of a multi-packet sequence, and its numOfDgms
+        or ping time don't match the ping we are looking for, flush the
+        current read and start over with this packet */
+    if (header.time_sec != pingSecs
+        || header.time_nanosec != pingNanoSecs
+        || numOfDgms != totalDgms) {
+      dgmsReceived = 0;
+    }
+
+    if (!dgmsReceived){
+      pingSecs = header.time_sec;
+      pingNanoSecs = header.time_nanosec;
+      totalDgms = numOfDgms;
+      dgmsReceived = 1;
+    }
+    else {
+      dgmsReceived++;
+    }
+    if(dgmNum>0 && dgmNum<=MBSYS_KMBES_MAX_NUM_MRZ_DGMS){
+      memcpy(mRecordBuf[dgmNum-1], dgm, header.numBytesDgm);
+    } else {
+      fprintf(stderr,"%s: ERR - invalid dgmNum[%u]\n",__func__,dgmNum);
+    }
+
+    if (dgmsReceived == totalDgms && totalDgms <= MBSYS_KMBES_MAX_NUM_MRZ_DGMS) {
+
+      int totalSize = sizeof(struct mbsys_kmbes_m_partition)
+                  + sizeof(struct mbsys_kmbes_header) + 4;
+      int rsize = 0;
+      for (int dgm = 0; dgm < totalDgms; dgm++) {
+        mb_get_binary_int(true, mRecordBuf[dgm], &rsize);
+        totalSize += rsize - sizeof(struct mbsys_kmbes_m_partition)
+                    - sizeof(struct mbsys_kmbes_header) - 4;
+      }
+
+      /*copy data into new buffer*/
+      int index = 0;
+      mbtrnpp_kemkmall_rd_hdr(verbose, mRecordBuf[0], (void *)&header, (void *)&emdgm_type, error);
+      memcpy(dest, mRecordBuf[0], header.numBytesDgm);
+      index = header.numBytesDgm - 4;
+
+      for (int dgm=1; dgm < totalDgms; dgm++) {
+        mbtrnpp_kemkmall_rd_hdr(verbose, mRecordBuf[dgm], (void *)&header, (void *)&emdgm_type, error);
+        int copy_len = header.numBytesDgm - sizeof(struct mbsys_kmbes_m_partition)
+                              - sizeof(struct mbsys_kmbes_header) - 4;
+        void *ptr = (void *)(mRecordBuf[dgm]+
+                 sizeof(struct mbsys_kmbes_m_partition)+
+                 sizeof(struct mbsys_kmbes_header));
+        memcpy(&dest[index], ptr, copy_len);
+        index += copy_len;
+      }
+      mb_put_binary_int(true, totalSize, &dest[0]);
+      mb_put_binary_short(true, 1, &dest[sizeof(struct mbsys_kmbes_header)]);
+      mb_put_binary_short(true, 1, &dest[sizeof(struct mbsys_kmbes_header)+2]);
+      mb_put_binary_int(true, totalSize, &dest[index]);
+      dgmsReceived = 0; /*reset received counter back to 0*/
+
+      if (NULL != dest_size) {
+        *dest_size = totalSize;
+      }
+      retval = true;
+    }
+  }
+
+  return retval;
+}
+
+/*--------------------------------------------------------------------*/
+
+/// @fn int s_mbtrnpp_kemkmall_recv_batch(int sd, mbtrnpp_rxbatch_t *rx)
+/// @brief receive a batch of UDP datagrams into rx, waiting
+/// for the first and taking any others already queued (one system call).
+/// @param[in] sd socket descriptor
+/// @param[in] rx receive batch
+/// @return number of datagrams received, or -1 on error
+static int s_mbtrnpp_kemkmall_recv_batch(int sd, mbtrnpp_rxbatch_t *rx)
+{
+  int n = -1;
+
+  rx->count = 0;
+  rx->next = 0;
+
+#if defined(__linux__) && defined(_GNU_SOURCE)
+  struct mmsghdr msgs[MBTRNPP_KMALL_RX_BATCH];
+  struct iovec iovs[MBTRNPP_KMALL_RX_BATCH];
+
+  memset(msgs, 0, sizeof(msgs));
+  for (int i = 0; i < MBTRNPP_KMALL_RX_BATCH; i++) {
+    iovs[i].iov_base = rx->buf + (size_t)i * MB_UDP_SIZE_MAX;
+    iovs[i].iov_len = MB_UDP_SIZE_MAX;
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  n = recvmmsg(sd, msgs, MBTRNPP_KMALL_RX_BATCH, MSG_WAITFORONE, NULL);
+  for (int i = 0; i < n; i++) {
+    rx->len[i] = msgs[i].msg_len;
+  }
+#else
+  // no recvmmsg: one datagram per call
+  ssize_t rlen = recv(sd, rx->buf, MB_UDP_SIZE_MAX, 0);
+  if (rlen > 0) {
+    rx->len[0] = (size_t)rlen;
+    n = 1;
+  }
+#endif
+
+  if (n > 0) {
+    rx->count = n;
+    MST_COUNTER_SET(app_stats->stats->status[MBTPP_STA_MB_RX_BATCH], n);
+  }
+
+  return n;
+}
+
+/*--------------------------------------------------------------------*/
+
 int mbtrnpp_kemkmall_input_read(int verbose, void *mbio_ptr, size_t *size,
                                 char *buffer, int *error) {
 
@@ -7262,12 +8348,12 @@ int mbtrnpp_kemkmall_input_read(int verbose, void *mbio_ptr, size_t *size,
   status = MB_SUCCESS;
 
   // Read from the socket.
-  int *sd_ptr = (int *)mb_io_ptr->mbsp;
+  mbtrnpp_input_t *input = (mbtrnpp_input_t *)mb_io_ptr->mbsp;
   struct mbsys_kmbes_header header;
   unsigned int num_bytes_dgm_end=0;
   mbsys_kmbes_emdgm_type emdgm_type=UNKNOWN;
   memset(buffer, 0, *size);
-  int readlen = read(*sd_ptr, buffer, *size);
+  int readlen = read(input->sd, buffer, *size);
   if (readlen <= 0) {
     status = MB_FAILURE;
     *error = MB_ERROR_EOF;
@@ -7296,76 +8382,109 @@ int mbtrnpp_kemkmall_input_read(int verbose, void *mbio_ptr, size_t *size,
   }
 
   /*handle multi-packet MRZ and MWC records*/
-  if (emdgm_type == MRZ || emdgm_type == MWC) {
-      unsigned short numOfDgms=0;
-      unsigned short dgmNum=0;
+  if (status == MB_SUCCESS && (emdgm_type == MRZ || emdgm_type == MWC)) {
+    s_mbtrnpp_kemkmall_reassemble(verbose, buffer, buffer, size, error);
+  }
+  /* print output debug statements */
+  if (verbose >= 2) {
+    fprintf(stderr, "\ndbg2  MBIO function <%s> completed\n", __func__);
+    fprintf(stderr, "dbg2  Return values:\n");
+    fprintf(stderr, "dbg2       error:              %d\n", *error);
+    fprintf(stderr, "dbg2  Return status:\n");
+    fprintf(stderr, "dbg2       status:             %d\n", status);
+  }
 
-    mb_get_binary_short(true, &buffer[MBSYS_KMBES_HEADER_SIZE], &numOfDgms);
-    mb_get_binary_short(true, &buffer[MBSYS_KMBES_HEADER_SIZE+2], &dgmNum);
-    if (numOfDgms > 1) {
-        static int dgmsReceived=0;
-        static unsigned int pingSecs, pingNanoSecs;
-        static int totalDgms;
-
-      /* if we get a M record of a multi-packet sequence, and its numOfDgms
-          or ping time don't match the ping we are looking for, flush the
-          current read and start over with this packet */
-      if (header.time_sec != pingSecs
-          || header.time_nanosec != pingNanoSecs
-          || numOfDgms != totalDgms) {
-        dgmsReceived = 0;
-      }
+  /* return */
+  return (status);
+}
+
+/*--------------------------------------------------------------------*/
 
-      if (!dgmsReceived){
-        pingSecs = header.time_sec;
-        pingNanoSecs = header.time_nanosec;
-        totalDgms = numOfDgms;
-        dgmsReceived = 1;
+int mbtrnpp_kemkmall_input_lease(int verbose, void *mbio_ptr, char **frame, size_t *size, int *error) {
+
+  /* local variables */
+  int status = MB_SUCCESS;
+
+  /* print input debug statements */
+  if (verbose >= 2) {
+    fprintf(stderr, "\ndbg2  MBIO function <%s> called\n", __func__);
+    fprintf(stderr, "dbg2  Input arguments:\n");
+    fprintf(stderr, "dbg2       verbose:    %d\n", verbose);
+    fprintf(stderr, "dbg2       mbio_ptr:   %p\n", mbio_ptr);
+    fprintf(stderr, "dbg2       frame:      %p\n", frame);
+  }
+
+  /* get pointer to mbio descriptor */
+  struct mb_io_struct *mb_io_ptr = (struct mb_io_struct *)mbio_ptr;
+
+  /* set initial status */
+  *error = MB_ERROR_NO_ERROR;
+  *frame = NULL;
+  *size = 0;
+
+  // Return the next datagram from the receive batch in place,
+  // receiving a new batch when it is used up. Partitioned MRZ and
+  // MWC datagrams are collected until the record is complete.
+  mbtrnpp_input_t *input = (mbtrnpp_input_t *)mb_io_ptr->mbsp;
+  if (NULL == input) {
+    status = MB_FAILURE;
+    *error = MB_ERROR_EOF;
+  }
+  mbtrnpp_rxbatch_t *rx = (NULL != input ? &input->rx : NULL);
+  while (status == MB_SUCCESS && NULL == *frame) {
+
+    if (rx->next >= rx->count) {
+      if (s_mbtrnpp_kemkmall_recv_batch(input->sd, rx) <= 0) {
+        status = MB_FAILURE;
+        *error = MB_ERROR_EOF;
+        break;
       }
-      else {
-        dgmsReceived++;
+    }
+
+    char *dgm = rx->buf + (size_t)rx->next * MB_UDP_SIZE_MAX;
+    size_t dgm_len = rx->len[rx->next];
+    rx->next++;
+
+    struct mbsys_kmbes_header header;
+    unsigned int num_bytes_dgm_end=0;
+    mbsys_kmbes_emdgm_type emdgm_type=UNKNOWN;
+
+    if (dgm_len >= MBSYS_KMBES_HEADER_SIZE + 4) {
+      status = mbtrnpp_kemkmall_rd_hdr(verbose, dgm, (void *)&header, (void *)&emdgm_type, error);
+    } else {
+      status = MB_FAILURE;
+    }
+
+    if (status == MB_SUCCESS && emdgm_type != UNKNOWN &&
+        header.numBytesDgm <= dgm_len && header.numBytesDgm >= MBSYS_KMBES_HEADER_SIZE + 4) {
+      mb_get_binary_int(true, &dgm[header.numBytesDgm-4], &num_bytes_dgm_end);
+      if (num_bytes_dgm_end != header.numBytesDgm) {
+        status = MB_FAILURE;
       }
-        if(dgmNum>0){
-            memcpy(mRecordBuf[dgmNum-1], buffer, header.numBytesDgm);
-        } else {
-            fprintf(stderr,"%s: ERR - dgNum<0\n",__func__);
-        }
+    } else {
+      status = MB_FAILURE;
+    }
 
-      if (dgmsReceived == totalDgms) {
+    if (status != MB_SUCCESS) {
+      *error = MB_ERROR_UNINTELLIGIBLE;
+      break;
+    }
 
-        int totalSize = sizeof(struct mbsys_kmbes_m_partition)
-                    + sizeof(struct mbsys_kmbes_header) + 4;
-        int rsize = 0;
-        for (int dgm = 0; dgm < totalDgms; dgm++) {
-          mb_get_binary_int(true, mRecordBuf[dgm], &rsize);
-          totalSize += rsize - sizeof(struct mbsys_kmbes_m_partition)
-                      - sizeof(struct mbsys_kmbes_header) - 4;
-        }
+    unsigned short numOfDgms=1;
+    if (emdgm_type == MRZ || emdgm_type == MWC) {
+      mb_get_binary_short(true, &dgm[MBSYS_KMBES_HEADER_SIZE], &numOfDgms);
+    }
 
-        /*copy data into new buffer*/
-        if (status == MB_SUCCESS) {
-          int index = 0;
-          status = mbtrnpp_kemkmall_rd_hdr(verbose, mRecordBuf[0], (void *)&header, (void *)&emdgm_type, error);
-          memcpy(buffer, mRecordBuf[0], header.numBytesDgm);
-          index = header.numBytesDgm - 4;
-
-          for (int dgm=1; dgm < totalDgms; dgm++) {
-            status = mbtrnpp_kemkmall_rd_hdr(verbose, mRecordBuf[dgm], (void *)&header, (void *)&emdgm_type, error);
-            int copy_len = header.numBytesDgm - sizeof(struct mbsys_kmbes_m_partition)
-                                  - sizeof(struct mbsys_kmbes_header) - 4;
-            void *ptr = (void *)(mRecordBuf[dgm]+
-                     sizeof(struct mbsys_kmbes_m_partition)+
-                     sizeof(struct mbsys_kmbes_header));
-            memcpy(&buffer[index], ptr, copy_len);
-            index += copy_len;
-          }
-          mb_put_binary_int(true, totalSize, &buffer[0]);
-          mb_put_binary_short(true, 1, &buffer[sizeof(struct mbsys_kmbes_header)]);
-          mb_put_binary_short(true, 1, &buffer[sizeof(struct mbsys_kmbes_header)+2]);
-          mb_put_binary_int(true, totalSize, &buffer[index]);
-            dgmsReceived = 0; /*reset received counter back to 0*/
-        }
+    if (numOfDgms > 1) {
+      // partition: copied for reassembly; return record when complete
+      if (s_mbtrnpp_kemkmall_reassemble(verbose, dgm, rx->record, size, error)) {
+        *frame = rx->record;
       }
+    } else {
+      *frame = dgm;
+      *size = header.numBytesDgm;
+      MST_COUNTER_INC(app_stats->stats->status[MBTPP_STA_MB_ZC_FRAMES]);
+      MST_COUNTER_ADD(app_stats->stats->status[MBTPP_STA_MB_ZC_BYTES], header.numBytesDgm);
     }
   }
 
@@ -7373,6 +8492,8 @@ int mbtrnpp_kemkmall_input_read(int verbose, void *mbio_ptr, size_t *size,
   if (verbose >= 2) {
     fprintf(stderr, "\ndbg2  MBIO function <%s> completed\n", __func__);
     fprintf(stderr, "dbg2  Return values:\n");
+    fprintf(stderr, "dbg2       frame:              %p\n", *frame);
+    fprintf(stderr, "dbg2       size:               %zu\n", *size);
     fprintf(stderr, "dbg2       error:              %d\n", *error);
     fprintf(stderr, "dbg2  Return status:\n");
     fprintf(stderr, "dbg2       status:             %d\n", status);
@@ -7404,10 +8525,13 @@ int mbtrnpp_kemkmall_input_close(int verbose, void *mbio_ptr, int *error) {
   /* set initial status */
   status = MB_SUCCESS;
 
-  // Close the socket based input
-  int *sd_ptr = (int *)mb_io_ptr->mbsp;
-  close(*sd_ptr);
-  status &= mb_freed(verbose, __FILE__, __LINE__, (void **)&sd_ptr, error);
+  // Close the socket based input and release the receive batch
+  mbtrnpp_input_t *input = (mbtrnpp_input_t *)mb_io_ptr->mbsp;
+  if (NULL != input) {
+    close(input->sd);
+    s_mbtrnpp_input_destroy(&input);
+  }
+  mb_io_ptr->mbsp = NULL;
 
   /* print output debug statements */
   if (verbose >= 2) {
@@ -8929,7 +10053,7 @@ int mbtrnpp_mb1r_input_open(int verbose, void *mbio_ptr, char *definition, int *
     if (NULL != mb_io_ptr && NULL != reader) {
 
         // set mb1_reader
-        mb_io_ptr->mbsp = (void *) reader;
+        mb_io_ptr->mbsp = (void *) s_mbtrnpp_input_new(reader, -1);
 
         if (reader->state == MB1R_CONNECTED || reader->state == MB1R_SUBSCRIBED) {
             // update application performance profile
@@ -8975,6 +10099,62 @@ int mbtrnpp_mb1r_input_open(int verbose, void *mbio_ptr, char *definition, int *
 
     return (status);
 }
+/// @fn bool s_mbtrnpp_mb1r_recover(mb1r_reader_t *reader, uint32_t sync_bytes, int *status, int *error)
+/// @brief update stats after a failed mb1r frame read and reconnect the
+/// reader if the socket was disconnected (clears status/error).
+/// @param[in] reader mb1r reader reference
+/// @param[in] sync_bytes bytes skipped by the failed read
+/// @param[in,out] status MBIO status
+/// @param[in,out] error MBIO error
+/// @return true if the reader was reconnected, false otherwise
+static bool s_mbtrnpp_mb1r_recover(mb1r_reader_t *reader, uint32_t sync_bytes, int *status, int *error)
+{
+    bool retval = false;
+
+    MST_METRIC_START(app_stats->stats->metrics[MBTPP_CH_MB_GETFAIL_XT], mtime_dtime());
+    MX_LPRINT(MBTRNPP, 4, "mb1r_read_frame failed: sync_bytes[%d] status[%d] err[%d]\n",sync_bytes,*status, *error);
+
+    MST_COUNTER_INC(app_stats->stats->events[MBTPP_EV_EMBFRAMERD]);
+    MST_COUNTER_ADD(app_stats->stats->status[MBTPP_STA_MB_SYNC_BYTES],sync_bytes);
+
+    // check connection status
+    // only reconnect if disconnected
+    if ((NULL!=reader && reader->state==MB1R_INITIALIZED) || (me_errno==ME_ESOCK) || (me_errno==ME_EOF)  ) {
+
+        fprintf(stderr,"EOF (input socket) - clear status/error\n");
+        *status = MB_SUCCESS;
+        *error = MB_ERROR_NO_ERROR;
+
+        MST_COUNTER_INC(app_stats->stats->events[MBTPP_EV_EMBSOCKET]);
+
+        // empty the reader's record frame container
+        mb1r_reader_purge(reader);
+
+        mlog_tprintf(mbtrnpp_mlog_id,"mbtrnpp: input socket status[%s]\n",mb1r_strstate(reader->state));
+        MST_COUNTER_INC(app_stats->stats->events[MBTPP_EV_MB_DISN]);
+
+        // re-connect reader
+        if (mb1r_reader_connect(reader,true)==0) {
+            retval = true;
+            fprintf(stderr,"mbtrnpp: input socket re-connected status[%s]\n",mb1r_strstate(reader->state));
+            mlog_tprintf(mbtrnpp_mlog_id,"mbtrnpp: input socket connected status[%s]\n",mb1r_strstate(reader->state));
+            MST_COUNTER_INC(app_stats->stats->events[MBTPP_EV_MB_CONN]);
+        } else {
+            fprintf(stderr,"mbtrnpp: input socket reconnect failed status[%s]\n",mb1r_strstate(reader->state));
+            mlog_tprintf(mbtrnpp_mlog_id,"mbtrnpp: input socket reconnect failed status[%s]\n",mb1r_strstate(reader->state));
+            MST_COUNTER_INC(app_stats->stats->events[MBTPP_EV_EMBCON]);
+
+            struct timespec twait={0},trem={0};
+            twait.tv_sec=5;
+            nanosleep(&twait,&trem);
+        }
+    }
+
+    MST_METRIC_LAP(app_stats->stats->metrics[MBTPP_CH_MB_GETFAIL_XT], mtime_dtime());
+
+    return retval;
+}
+
 int mbtrnpp_mb1r_input_read(int verbose, void *mbio_ptr, size_t *size, char *buffer, int *error)
 {
 
@@ -9007,7 +10187,8 @@ int mbtrnpp_mb1r_input_read(int verbose, void *mbio_ptr, size_t *size, char *buf
     // read and return single frame
     uint32_t sync_bytes=0;
     int64_t rbytes=-1;
-    mb1r_reader_t *reader = (mb1r_reader_t *)mb_io_ptr->mbsp;
+    mbtrnpp_input_t *input = (mbtrnpp_input_t *)mb_io_ptr->mbsp;
+    mb1r_reader_t *reader = (NULL != input ? (mb1r_reader_t *)input->reader : NULL);
 
     // frame buffer for byte-wise reads
     static byte *frame_buf = NULL;
@@ -9109,55 +10290,108 @@ int mbtrnpp_mb1r_input_read(int verbose, void *mbio_ptr, size_t *size, char *buf
         *error   = MB_ERROR_EOF;
         *size    = (size_t)0;
 
-        MST_METRIC_START(app_stats->stats->metrics[MBTPP_CH_MB_GETFAIL_XT], mtime_dtime());
-        MX_LPRINT(MBTRNPP, 4, "mb1r_read_frame failed: sync_bytes[%d] status[%d] err[%d]\n",sync_bytes,status, *error);
+        if (s_mbtrnpp_mb1r_recover(reader, sync_bytes, &status, error)) {
+            read_frame = true;
+            read_err = false;
+        }
+    }
 
-        MST_COUNTER_INC(app_stats->stats->events[MBTPP_EV_EMBFRAMERD]);
-        MST_COUNTER_ADD(app_stats->stats->status[MBTPP_STA_MB_SYNC_BYTES],sync_bytes);
+    // print output debug statements
+    if (verbose >= 2) {
+        fprintf(stderr, "\ndbg2  MBIO function <%s> completed\n", __func__);
+        fprintf(stderr, "dbg2  Return values:\n");
+        fprintf(stderr, "dbg2       size:       %zu\n", *size);
+        fprintf(stderr, "dbg2       buffer:     %p\n", buffer);
+        fprintf(stderr, "dbg2       error:              %d\n", *error);
+        fprintf(stderr, "dbg2  Return status:\n");
+        fprintf(stderr, "dbg2       status:             %d\n", status);
+    }
 
-        // check connection status
-        // only reconnect if disconnected
-        if ((NULL!=reader && reader->state==MB1R_INITIALIZED) || (me_errno==ME_ESOCK) || (me_errno==ME_EOF)  ) {
+    return (status);
+}
 
-            fprintf(stderr,"EOF (input socket) - clear status/error\n");
-            status = MB_SUCCESS;
-            *error = MB_ERROR_NO_ERROR;
+int mbtrnpp_mb1r_input_lease(int verbose, void *mbio_ptr, char **frame, size_t *size, int *error)
+{
+    // local variables
+    int status = MB_SUCCESS;
+    struct mb_io_struct *mb_io_ptr;
+
+    // print input debug statements
+    if (verbose >= 2) {
+        fprintf(stderr, "\ndbg2  MBIO function <%s> called\n", __func__);
+        fprintf(stderr, "dbg2  Input arguments:\n");
+        fprintf(stderr, "dbg2       verbose:    %d\n", verbose);
+        fprintf(stderr, "dbg2       mbio_ptr:   %p\n", mbio_ptr);
+        fprintf(stderr, "dbg2       frame:      %p\n", frame);
+    }
 
-            MST_COUNTER_INC(app_stats->stats->events[MBTPP_EV_EMBSOCKET]);
+    // get pointer to mbio descriptor
+    mb_io_ptr = (struct mb_io_struct *)mbio_ptr;
 
-            // empty the reader's record frame container
-            mb1r_reader_purge(reader);
+    // set initial status
+    *error = MB_ERROR_NO_ERROR;
+    *frame = NULL;
+    *size = 0;
 
-            mlog_tprintf(mbtrnpp_mlog_id,"mbtrnpp: input socket status[%s]\n",mb1r_strstate(reader->state));
-            MST_COUNTER_INC(app_stats->stats->events[MBTPP_EV_MB_DISN]);
+    // Read one MB1 record from the socket and return a pointer to it
+    // in place; it remains valid until the next call.
+    uint32_t sync_bytes=0;
+    int64_t rbytes=-1;
+    mbtrnpp_input_t *input = (mbtrnpp_input_t *)mb_io_ptr->mbsp;
+    mb1r_reader_t *reader = (NULL != input ? (mb1r_reader_t *)input->reader : NULL);
 
-            // re-connect reader
-            if (mb1r_reader_connect(reader,true)==0) {
-                read_frame = true;
-                read_err = false;
-                fprintf(stderr,"mbtrnpp: input socket re-connected status[%s]\n",mb1r_strstate(reader->state));
-                mlog_tprintf(mbtrnpp_mlog_id,"mbtrnpp: input socket connected status[%s]\n",mb1r_strstate(reader->state));
-                MST_COUNTER_INC(app_stats->stats->events[MBTPP_EV_MB_CONN]);
-            } else {
-                fprintf(stderr,"mbtrnpp: input socket reconnect failed status[%s]\n",mb1r_strstate(reader->state));
-                mlog_tprintf(mbtrnpp_mlog_id,"mbtrnpp: input socket reconnect failed status[%s]\n",mb1r_strstate(reader->state));
-                MST_COUNTER_INC(app_stats->stats->events[MBTPP_EV_EMBCON]);
+    if(NULL != input && NULL == input->lease_buf)
+    {
+        input->lease_buf = (byte *)malloc(MB1_MAX_SOUNDING_BYTES);
+    }
+    byte *lease_buf = (NULL != input ? input->lease_buf : NULL);
+
+    if(NULL != reader && NULL != lease_buf)
+    {
+        mb1_t *pmb1 = (mb1_t *)lease_buf;
 
-                struct timespec twait={0},trem={0};
-                twait.tv_sec=5;
-                nanosleep(&twait,&trem);
+        if ( (rbytes = mb1r_read_frame(reader, lease_buf,
+                                       MB1_MAX_SOUNDING_BYTES, MB1R_NET_STREAM,
+                                       0.0, MB1R_READ_TMOUT_MSEC,
+                                       &sync_bytes)) >= 0)
+        {
+            if(rbytes<=MB1_MAX_SOUNDING_BYTES &&
+               pmb1->size == rbytes &&
+               pmb1->nbeams<=MB1_MAX_BEAMS &&
+               mb1_validate_checksum(pmb1)==0)
+            {
+                *frame = (char *)lease_buf;
+                *size = (size_t)rbytes;
+                MST_COUNTER_INC(app_stats->stats->status[MBTPP_STA_MB_ZC_FRAMES]);
+                MST_COUNTER_ADD(app_stats->stats->status[MBTPP_STA_MB_ZC_BYTES], rbytes);
+                MX_LPRINT(MBTRNPP, 3, "lease frame len[%zu]:\n",(size_t)rbytes);
+            } else {
+                status = MB_FAILURE;
+                MX_LPRINT(MBTRNPP, 3, "invalid frame rbytes[%zu] size[%zu]\n",(size_t)rbytes, (size_t)pmb1->size);
             }
+        } else {
+            status = MB_FAILURE;
+            MX_LPRINT(MBTRNPP, 3, "mb1r_read_frame failed rbytes[%zu]\n",(size_t)rbytes);
         }
+    } else {
+        status = MB_FAILURE;
+        fprintf(stderr, "%s : ERR - reader or frame buffer is NULL\n", __func__);
+    }
 
-        MST_METRIC_LAP(app_stats->stats->metrics[MBTPP_CH_MB_GETFAIL_XT], mtime_dtime());
+    if(status == MB_FAILURE)
+    {
+        *error = MB_ERROR_EOF;
+        if (NULL != reader) {
+            s_mbtrnpp_mb1r_recover(reader, sync_bytes, &status, error);
+        }
     }
 
     // print output debug statements
     if (verbose >= 2) {
         fprintf(stderr, "\ndbg2  MBIO function <%s> completed\n", __func__);
         fprintf(stderr, "dbg2  Return values:\n");
+        fprintf(stderr, "dbg2       frame:      %p\n", *frame);
         fprintf(stderr, "dbg2       size:       %zu\n", *size);
-        fprintf(stderr, "dbg2       buffer:     %p\n", buffer);
         fprintf(stderr, "dbg2       error:              %d\n", *error);
         fprintf(stderr, "dbg2  Return status:\n");
         fprintf(stderr, "dbg2       status:             %d\n", status);
@@ -9189,8 +10423,12 @@ int mbtrnpp_mb1r_input_close(int verbose, void *mbio_ptr, int *error)
     /* Close the socket based input for reading using function
      * mbtrnpp_mb1r_input_read(). Deallocate the internal, hidden buffer and any
      * other resources that were allocated by mbtrnpp_reson7kr_input_init(). */
-    mb1r_reader_t *reader = (mb1r_reader_t *)mb_io_ptr->mbsp;
-    mb1r_reader_destroy(&reader);
+    mbtrnpp_input_t *input = (mbtrnpp_input_t *)mb_io_ptr->mbsp;
+    if (NULL != input) {
+        mb1r_reader_t *reader = (mb1r_reader_t *)input->reader;
+        mb1r_reader_destroy(&reader);
+        s_mbtrnpp_input_destroy(&input);
+    }
     mb_io_ptr->mbsp = NULL;
 
     /* print output debug statements */
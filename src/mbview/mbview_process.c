@@ -35,6 +35,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "mb_aux.h"
 #include "mb_define.h"
 #include "mb_status.h"
 
@@ -339,14 +340,20 @@ __FILE__, __LINE__, __FUNCTION__, xlonmin, xlonmax, ylatmin, ylatmax);
 			i = data->primary_n_columns;
 	}
 
-	/* calculate derivatives of primary data */
-	for (i = 0; i < data->primary_n_columns; i++) {
-		for (j = 0; j < data->primary_n_rows; j++) {
-			mbview_derivative(instance, i, j);
-		}
+	/* calculate derivatives of primary data in blocks of columns using
+	   the threaded mb_shade kernel, checking for events between blocks */
+	struct mb_shade_struct shade;
+	memset(&shade, 0, sizeof(shade));
+	shade.nthreads = 0;
+	shade.scale = view->scale;
+	for (i = 0; i < data->primary_n_columns; i += MBV_EVENTCHECKCOARSENESS * MBV_DERIVATIVE_COLUMNS) {
+		mb_shade_derivative(mbv_verbose, &shade, data->primary_n_columns, data->primary_n_rows, i,
+		                    i + MBV_EVENTCHECKCOARSENESS * MBV_DERIVATIVE_COLUMNS, data->primary_nodatavalue,
+		                    data->primary_data, data->primary_x, data->primary_y, 0.0, 0.0, data->primary_dzdx,
+		                    data->primary_dzdy, &error);
 
 		/* check for pending event */
-		if (!view->plot_done && view->plot_interrupt_allowed && i % MBV_EVENTCHECKCOARSENESS == 0)
+		if (!view->plot_done && view->plot_interrupt_allowed)
 			do_mbview_xevents();
 
 		/* dump out of loop if plotting already done at a higher recursion */
@@ -2347,14 +2354,9 @@ int mbview_setcolorparms(size_t instance) {
 }
 /*------------------------------------------------------------------------------*/
 int mbview_make_histogram(struct mbview_world_struct *view, struct mbview_struct *data, int which_data) {
-	int binned_counts[MBV_RAW_HISTOGRAM_DIM];
-	int nbinned, nbinnedneg, nbinnedpos;
-	int bindimminusone;
-	float min, max, dhist;
-	float slope;
+	int error = MB_ERROR_NO_ERROR;
 	float *histogram;
-	int binnedsum, target, jbinzero;
-	int i, jbin, khist;
+	int status = MB_SUCCESS;
 
 	if (mbv_verbose >= 2) {
 		fprintf(stderr, "\ndbg2  MBIO function <%s> called\n", __func__);
@@ -2365,146 +2367,41 @@ int mbview_make_histogram(struct mbview_world_struct *view, struct mbview_struct
 		fprintf(stderr, "dbg2       which_data:       %d\n", which_data);
 	}
 
-	/* get ranges for histogram */
+	/* get ranges for histogram and construct the histogram equalization */
 	if (which_data == MBV_DATA_PRIMARY) {
 		histogram = view->primary_histogram;
-		min = data->primary_colortable_min;
-		max = data->primary_colortable_max;
 		view->primary_histogram_set = true;
+		status = mb_shade_histogram(mbv_verbose, 0, data->primary_n_columns, data->primary_n_rows, data->primary_nodatavalue,
+		                            data->primary_data, NULL, NULL, false, data->primary_colortable_min,
+		                            data->primary_colortable_max, histogram, &error);
 	}
 	else if (which_data == MBV_DATA_PRIMARYSLOPE) {
 		histogram = view->primaryslope_histogram;
-		min = data->slope_colortable_min;
-		max = data->slope_colortable_max;
 		view->primaryslope_histogram_set = true;
+		status = mb_shade_histogram(mbv_verbose, 0, data->primary_n_columns, data->primary_n_rows, data->primary_nodatavalue,
+		                            data->primary_data, data->primary_dzdx, data->primary_dzdy, true,
+		                            data->slope_colortable_min, data->slope_colortable_max, histogram, &error);
 	}
 	else /* if (which_data == MBV_DATA_SECONDARY) */
 	{
 		histogram = view->secondary_histogram;
-		min = data->secondary_colortable_min;
-		max = data->secondary_colortable_max;
 		view->secondary_histogram_set = true;
-	}
-	dhist = (max - min) / (MBV_RAW_HISTOGRAM_DIM - 1);
-
-	/* initialize histograms */
-	for (i = 0; i < 3 * MBV_NUM_COLORS; i++)
-		histogram[i] = 0.0;
-
-	/* initialize bins */
-	for (i = 0; i < MBV_RAW_HISTOGRAM_DIM; i++)
-		binned_counts[i] = 0;
-
-	/* loop over all values binning quantities */
-	bindimminusone = MBV_RAW_HISTOGRAM_DIM - 1;
-	nbinned = 0;
-	nbinnedneg = 0;
-	nbinnedpos = 0;
-	if (which_data == MBV_DATA_PRIMARY) {
-		for (i = 0; i < data->primary_nxy; i++) {
-			if (data->primary_data[i] != data->primary_nodatavalue) {
-				jbin = (data->primary_data[i] - min) / dhist;
-				if (jbin >= 0 && jbin <= bindimminusone) {
-					binned_counts[jbin]++;
-					nbinned++;
-					if (data->primary_data[i] < 0.0)
-						nbinnedneg++;
-					else
-						nbinnedpos++;
-				}
-			}
-		}
-	}
-	else if (which_data == MBV_DATA_PRIMARYSLOPE) {
-		for (i = 0; i < data->primary_nxy; i++) {
-			if (data->primary_data[i] != data->primary_nodatavalue) {
-				slope = sqrt(data->primary_dzdx[i] * data->primary_dzdx[i] + data->primary_dzdy[i] * data->primary_dzdy[i]);
-				jbin = (slope - min) / dhist;
-				if (jbin >= 0 && jbin <= bindimminusone) {
-					binned_counts[jbin]++;
-					nbinned++;
-					nbinnedpos++;
-				}
-			}
-		}
-	}
-	else if (which_data == MBV_DATA_SECONDARY) {
-		for (i = 0; i < data->secondary_nxy; i++) {
-			if (data->secondary_data[i] != data->secondary_nodatavalue) {
-				jbin = (data->secondary_data[i] - min) / dhist;
-				if (jbin >= 0 && jbin <= bindimminusone) {
-					binned_counts[jbin]++;
-					nbinned++;
-					if (data->secondary_data[i] < 0.0)
-						nbinnedneg++;
-					else
-						nbinnedpos++;
-				}
-			}
-		}
-	}
-
-	/* construct histogram equalization for full data range */
-	histogram[0] = min;
-	histogram[MBV_NUM_COLORS - 1] = max;
-	binnedsum = 0;
-	khist = 1;
-	for (jbin = 0; jbin < MBV_RAW_HISTOGRAM_DIM; jbin++) {
-		target = (khist * nbinned) / (MBV_NUM_COLORS - 1);
-		binnedsum += binned_counts[jbin];
-		if (binnedsum >= target && khist < MBV_NUM_COLORS - 1) {
-			histogram[khist] = min + jbin * dhist;
-			khist++;
-		}
-	}
-
-	/* construct histogram equalization for data < 0.0 */
-	if (nbinnedneg > MBV_NUM_COLORS) {
-		jbinzero = MIN(-min / dhist, MBV_RAW_HISTOGRAM_DIM - 1);
-		histogram[MBV_NUM_COLORS] = MIN(0.0, min);
-		histogram[2 * MBV_NUM_COLORS - 1] = MIN(0.0, max);
-		binnedsum = 0;
-		khist = 1;
-		for (jbin = 0; jbin < jbinzero; jbin++) {
-			target = (khist * nbinnedneg) / (MBV_NUM_COLORS - 1);
-			binnedsum += binned_counts[jbin];
-			if (binnedsum >= target && khist < MBV_NUM_COLORS - 1) {
-				histogram[MBV_NUM_COLORS + khist] = min + jbin * dhist;
-				khist++;
-			}
-		}
-	}
-
-	/* construct histogram equalization for data >= 0.0 */
-	if (nbinnedpos > MBV_NUM_COLORS) {
-		jbinzero = -min / dhist;
-		histogram[2 * MBV_NUM_COLORS] = MAX(0.0, min);
-		histogram[3 * MBV_NUM_COLORS - 1] = MAX(0.0, max);
-		binnedsum = 0;
-		khist = 1;
-		for (jbin = jbinzero; jbin < MBV_RAW_HISTOGRAM_DIM; jbin++) {
-			target = (khist * nbinnedpos) / (MBV_NUM_COLORS - 1);
-			binnedsum += binned_counts[jbin];
-			if (binnedsum >= target && khist < MBV_NUM_COLORS - 1) {
-				histogram[2 * MBV_NUM_COLORS + khist] = min + jbin * dhist;
-				khist++;
-			}
-		}
+		status = mb_shade_histogram(mbv_verbose, 0, data->secondary_n_columns, data->secondary_n_rows,
+		                            data->secondary_nodatavalue, data->secondary_data, NULL, NULL, false,
+		                            data->secondary_colortable_min, data->secondary_colortable_max, histogram, &error);
 	}
 
-	int status = MB_SUCCESS;
-
 	if (mbv_verbose >= 2) {
 		fprintf(stderr, "\ndbg2  MBIO function <%s> completed\n", __func__);
 		fprintf(stderr, "dbg2  Return values:\n");
 		fprintf(stderr, "dbg2       Primary histogram:\n");
-		for (i = 0; i < MBV_NUM_COLORS; i++)
+		for (int i = 0; i < MBV_NUM_COLORS; i++)
 			fprintf(stderr, "dbg2       value[%d]:   %f\n", i, histogram[i]);
 		fprintf(stderr, "dbg2       Negative histogram for sea level colortable:\n");
-		for (i = 0; i < MBV_NUM_COLORS; i++)
+		for (int i = 0; i < MBV_NUM_COLORS; i++)
 			fprintf(stderr, "dbg2       value[%d]:   %f\n", i, histogram[MBV_NUM_COLORS + i]);
 		fprintf(stderr, "dbg2       Positive histogram for sea level colortable:\n");
-		for (i = 0; i < MBV_NUM_COLORS; i++)
+		for (int i = 0; i < MBV_NUM_COLORS; i++)
 			fprintf(stderr, "dbg2       value[%d]:   %f\n", i, histogram[2 * MBV_NUM_COLORS + i]);
 		fprintf(stderr, "dbg2  Return status:\n");
 		fprintf(stderr, "dbg2       status:  %d\n", status);
@@ -2846,7 +2743,6 @@ int mbview_getcolor(double value, double min, double max, int colortablemode, fl
                     float below_blue, float above_red, float above_green, float above_blue, float *colortable_red,
                     float *colortable_green, float *colortable_blue, float *red, float *green, float *blue) {
 	int i;
-	double ff, factor;
 
 	if (mbv_verbose >= 2) {
 		fprintf(stderr, "\ndbg2  MBIO function <%s> called\n", __func__);
@@ -2871,29 +2767,8 @@ int mbview_getcolor(double value, double min, double max, int colortablemode, fl
 	}
 
 	/* get color */
-  if (max <= min)
-    factor = 0.5;
-  else if (colortablemode == MBV_COLORTABLE_NORMAL)
-		factor = (max - value) / (max - min);
-	else
-		factor = (value - min) / (max - min);
-	if (factor >= 1.0) {
-		*red = above_red;
-		*green = above_green;
-		*blue = above_blue;
-	}
-	else if (factor <= 0.0) {
-		*red = below_red;
-		*green = below_green;
-		*blue = below_blue;
-	}
-	else {
-		i = (int)(factor * (MBV_NUM_COLORS - 1));
-		ff = factor * (MBV_NUM_COLORS - 1) - i;
-		*red = colortable_red[i] + ff * (colortable_red[i + 1] - colortable_red[i]);
-		*green = colortable_green[i] + ff * (colortable_green[i + 1] - colortable_green[i]);
-		*blue = colortable_blue[i] + ff * (colortable_blue[i + 1] - colortable_blue[i]);
-	}
+	mb_shade_getcolor(value, min, max, colortablemode, below_red, below_green, below_blue, above_red, above_green,
+	                  above_blue, colortable_red, colortable_green, colortable_blue, red, green, blue);
 
 	const int status = MB_SUCCESS;
 
@@ -2915,9 +2790,7 @@ int mbview_getcolor_histogram(double value, double min, double max, int colortab
                               float below_blue, float above_red, float above_green, float above_blue, float *colortable_red,
                               float *colortable_green, float *colortable_blue, float *histogram, float *red, float *green,
                               float *blue) {
-	double ff, factor;
-	bool found;
-	int i, ii;
+	int i;
 
 	if (mbv_verbose >= 2) {
 		fprintf(stderr, "\ndbg2  MBIO function <%s> called\n", __func__);
@@ -2940,44 +2813,8 @@ int mbview_getcolor_histogram(double value, double min, double max, int colortab
 	}
 
 	/* get color */
-	if (colortablemode == MBV_COLORTABLE_NORMAL)
-		factor = (max - value) / (max - min);
-	else
-		factor = (value - min) / (max - min);
-	/* factor = MAX(factor, 0.000001);
-	factor = MIN(factor, 0.999999);*/
-	if (factor <= 0.0) {
-		*red = below_red;
-		*green = below_green;
-		*blue = below_blue;
-	}
-	else if (factor >= 1.0) {
-		*red = above_red;
-		*green = above_green;
-		*blue = above_blue;
-	}
-	else {
-		/* find place in histogram */
-		found = false;
-		for (i = 0; i < MBV_NUM_COLORS - 1 && !found; i++) {
-			if (value >= histogram[i] && value <= histogram[i + 1]) {
-				ii = i;
-				found = true;
-			}
-		}
-
-		/* get color */
-		if (colortablemode == MBV_COLORTABLE_NORMAL) {
-			ff = (histogram[ii + 1] - value) / (histogram[ii + 1] - histogram[ii]);
-			ii = MBV_NUM_COLORS - 2 - ii;
-		}
-		else {
-			ff = (value - histogram[ii]) / (histogram[ii + 1] - histogram[ii]);
-		}
-		*red = colortable_red[ii] + ff * (colortable_red[ii + 1] - colortable_red[ii]);
-		*green = colortable_green[ii] + ff * (colortable_green[ii + 1] - colortable_green[ii]);
-		*blue = colortable_blue[ii] + ff * (colortable_blue[ii + 1] - colortable_blue[ii]);
-	}
+	mb_shade_getcolor_histogram(value, min, max, colortablemode, below_red, below_green, below_blue, above_red, above_green,
+	                            above_blue, colortable_red, colortable_green, colortable_blue, histogram, red, green, blue);
 
 	const int status = MB_SUCCESS;
 
@@ -2996,13 +2833,8 @@ int mbview_getcolor_histogram(double value, double min, double max, int colortab
 
 /*------------------------------------------------------------------------------*/
 int mbview_applyshade(double intensity, float *r, float *g, float *b) {
-	/* note - this correction algorithm is taken from the GMT Technical
-	   Reference and Cookbook by Wessel and Smith - you can find it in
-	   Appendix I: Color Space - The final frontier */
-	double h, s, v;
-	double vmax, vmin, dv, idv;
-	double rmod, gmod, bmod;
-	double f, p, q, t;
+	/* note - the shading algorithm in mb_shade_applyshade() is taken from
+	   the GMT Technical Reference and Cookbook by Wessel and Smith */
 
 	if (mbv_verbose >= 2) {
 		fprintf(stderr, "\ndbg2  MBIO function <%s> called\n", __func__);
@@ -3011,99 +2843,8 @@ int mbview_applyshade(double intensity, float *r, float *g, float *b) {
 		fprintf(stderr, "dbg2       intensity:           %f\n", intensity);
 	}
 
-	/* change the initial rgb into hsv space */
-	vmax = MAX(MAX(*r, *g), *b);
-	vmin = MIN(MIN(*r, *g), *b);
-	dv = vmax - vmin;
-	v = vmax;
-	if (vmax == 0.0)
-		s = 0.0;
-	else
-		s = dv / vmax;
-	h = 0.0;
-	if (s > 0.0) {
-		idv = 1.0 / dv;
-		rmod = (vmax - *r) * idv;
-		gmod = (vmax - *g) * idv;
-		bmod = (vmax - *b) * idv;
-		if (*r == vmax)
-			h = bmod - gmod;
-		else if (*g == vmax)
-			h = 2.0 + rmod - bmod;
-		else
-			h = 4.0 + gmod - rmod;
-		h *= 60.0;
-		if (h < 0.0)
-			h += 360.0;
-	}
-
 	/* apply the shade to the color */
-	if (intensity > 0) {
-		if (s != 0.0)
-			s = (1.0 - intensity) * s + intensity * 0.1;
-		v = (1.0 - intensity) * v + intensity;
-	}
-	else {
-		if (s != 0.0)
-			s = (1.0 + intensity) * s - intensity;
-		v = (1.0 + intensity) * v - intensity * 0.3;
-	}
-	if (v < 0.0)
-		v = 0.0;
-	if (s < 0.0)
-		s = 0.0;
-	if (v > 1.0)
-		v = 1.0;
-	if (s > 1.0)
-		s = 1.0;
-
-	/* change the corrected hsv values back into rgb */
-	if (s == 0.0) {
-		*r = v;
-		*g = v;
-		*b = v;
-	}
-	else {
-		while (h >= 360.0)
-			h -= 360.0;
-		h /= 60.0;
-		f = h - ((int)h);
-		p = v * (1.0 - s);
-		q = v * (1.0 - (s * f));
-		t = v * (1.0 - (s * (1.0 - f)));
-		switch (((int)h)) {
-		case 0:
-			*r = v;
-			*g = t;
-			*b = p;
-			break;
-		case 1:
-			*r = q;
-			*g = v;
-			*b = p;
-			break;
-		case 2:
-			*r = p;
-			*g = v;
-			*b = t;
-			break;
-		case 3:
-			*r = p;
-			*g = q;
-			*b = v;
-			break;
-		case 4:
-			*r = t;
-			*g = p;
-			*b = v;
-			break;
-		case 5:
-			*r = v;
-			*g = p;
-			*b = q;
-			break;
-		}
-	}
+	mb_shade_applyshade(intensity, r, g, b);
 
 	const int status = MB_SUCCESS;
 
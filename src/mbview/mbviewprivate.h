@@ -59,6 +59,7 @@
 #define MBV_REZ_FULL 3
 #define MBV_BOUNDSFREQUENCY 25
 #define MBV_EVENTCHECKCOARSENESS 5
+#define MBV_DERIVATIVE_COLUMNS 16
 
 #define MBV_NUMBACKGROUNDCALC 500
 #define MBV_BACKGROUND_NONE 0
@@ -34,14 +34,17 @@
 
 /* standard include files */
 #include <algorithm>
+#include <condition_variable>
 #include <ctime>
 #include <ctype.h>
 #include <fstream>
 #include <getopt.h>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <stdio.h>
 #include <string>
+#include <deque>
 #include <thread>
 #include <unistd.h>
 #include <vector>
@@ -149,12 +152,38 @@ struct mbpg_process_struct {
     double image_right_roll;
     double image_right_pitch;
     double speed;
-    
+
+    // Stereo pair images as read by the I/O threads
+    Mat imageLeft;
+    Mat imageRight;
+    bool processed;
+
     // Output formt 251 data structure
     struct mbsys_stereopair_struct store;
 
 };
 
+/* Stereo pairs flow through a bounded pipeline: the main thread parses the
+    imagelist and queues pairs, I/O threads read both images, and compute
+    threads take whichever pair has been read next. Results are held in a ring
+    of processing structures until the main thread writes them out in imagelist
+    order. */
+#define MBPG_PIPELINE_MAX (2 * MB_THREAD_MAX)
+struct mbpg_pipeline_struct {
+    std::mutex mutex;
+    std::condition_variable read_ready;
+    std::condition_variable process_ready;
+    std::condition_variable result_ready;
+    std::deque<struct mbpg_process_struct *> read_queue;
+    std::deque<struct mbpg_process_struct *> process_queue;
+    struct mbpg_process_struct *slots[MBPG_PIPELINE_MAX];
+    int capacity;
+    int num_pending;
+    int next_sequence;
+    int next_output;
+    bool shutdown;
+};
+
 enum { STEREO_BM=0, STEREO_SGBM=1, STEREO_HH=2 };
 struct mbpg_control_struct {
 
@@ -616,9 +645,15 @@ void process_stereopair(int verbose, struct mbpg_process_struct *process,
 
     bool use_this_pair = true;
 
-    /* Read the stereo pair */
-    Mat img1 = imread(process->imageLeftFile, -1);
-    Mat img2 = imread(process->imageRightFile, -1);
+    /* Read the stereo pair unless the I/O threads already have */
+    Mat img1 = process->imageLeft;
+    Mat img2 = process->imageRight;
+    process->imageLeft.release();
+    process->imageRight.release();
+    if (img1.empty())
+        img1 = imread(process->imageLeftFile, -1);
+    if (img2.empty())
+        img2 = imread(process->imageRightFile, -1);
     if (img1.empty()) {
         fprintf(stderr,"Unable to read left file %s\n", process->imageLeftFile);
         use_this_pair = false;
@@ -1012,6 +1047,99 @@ void process_stereopair(int verbose, struct mbpg_process_struct *process,
 
 }
 /*--------------------------------------------------------------------*/
+struct mbpg_process_struct *pipeline_slot(int verbose, struct mbpg_pipeline_struct *pipeline)
+{
+    /* the caller has written out results until the pipeline has a free slot,
+        and the slot of the next pair to be queued is always the oldest */
+    return pipeline->slots[pipeline->next_sequence % pipeline->capacity];
+}
+/*--------------------------------------------------------------------*/
+void pipeline_submit(int verbose, struct mbpg_pipeline_struct *pipeline,
+                  struct mbpg_process_struct *process)
+{
+    std::unique_lock<std::mutex> lock(pipeline->mutex);
+    process->processed = false;
+    pipeline->next_sequence++;
+    pipeline->num_pending++;
+    pipeline->read_queue.push_back(process);
+    pipeline->read_ready.notify_one();
+}
+/*--------------------------------------------------------------------*/
+struct mbpg_process_struct *pipeline_next_result(int verbose, struct mbpg_pipeline_struct *pipeline,
+                  bool wait_all)
+{
+    /* return the oldest pair in the pipeline once it has been processed - wait
+        for it if the pipeline is full or if wait_all is set, otherwise return
+        NULL if it is not yet available */
+    std::unique_lock<std::mutex> lock(pipeline->mutex);
+    if (pipeline->num_pending == 0)
+        return NULL;
+    struct mbpg_process_struct *process = pipeline->slots[pipeline->next_output % pipeline->capacity];
+    if (!process->processed) {
+        if (!wait_all && pipeline->num_pending < pipeline->capacity)
+            return NULL;
+        pipeline->result_ready.wait(lock, [process] { return process->processed; });
+    }
+    pipeline->next_output++;
+    pipeline->num_pending--;
+    return process;
+}
+/*--------------------------------------------------------------------*/
+void pipeline_shutdown(int verbose, struct mbpg_pipeline_struct *pipeline)
+{
+    std::unique_lock<std::mutex> lock(pipeline->mutex);
+    pipeline->shutdown = true;
+    pipeline->read_ready.notify_all();
+    pipeline->process_ready.notify_all();
+}
+/*--------------------------------------------------------------------*/
+void read_stereopairs(int verbose, struct mbpg_pipeline_struct *pipeline)
+{
+    while (true) {
+        struct mbpg_process_struct *process;
+        {
+            std::unique_lock<std::mutex> lock(pipeline->mutex);
+            pipeline->read_ready.wait(lock, [pipeline] { return pipeline->shutdown || !pipeline->read_queue.empty(); });
+            if (pipeline->read_queue.empty())
+                return;
+            process = pipeline->read_queue.front();
+            pipeline->read_queue.pop_front();
+        }
+
+        /* read and decode the images outside the lock - process_stereopair()
+            reports images that cannot be read */
+        process->imageLeft = imread(process->imageLeftFile, -1);
+        process->imageRight = imread(process->imageRightFile, -1);
+
+        std::unique_lock<std::mutex> lock(pipeline->mutex);
+        pipeline->process_queue.push_back(process);
+        pipeline->process_ready.notify_one();
+    }
+}
+/*--------------------------------------------------------------------*/
+void process_stereopairs(int verbose, struct mbpg_pipeline_struct *pipeline, unsigned int thread,
+                  struct mbpg_control_struct *control, int *status, int *error)
+{
+    while (true) {
+        struct mbpg_process_struct *process;
+        {
+            std::unique_lock<std::mutex> lock(pipeline->mutex);
+            pipeline->process_ready.wait(lock, [pipeline] { return pipeline->shutdown || !pipeline->process_queue.empty(); });
+            if (pipeline->process_queue.empty())
+                return;
+            process = pipeline->process_queue.front();
+            pipeline->process_queue.pop_front();
+        }
+
+        process->thread = thread;
+        process_stereopair(verbose, process, control, status, error);
+
+        std::unique_lock<std::mutex> lock(pipeline->mutex);
+        process->processed = true;
+        pipeline->result_ready.notify_all();
+    }
+}
+/*--------------------------------------------------------------------*/
 
 int main(int argc, char** argv)
 {
@@ -1028,9 +1156,9 @@ int main(int argc, char** argv)
     mb_path ImageListFile;
 
     /* parameter controls */
-    struct mbpg_process_struct processData[MB_THREAD_MAX];
-    for (int ithread=0; ithread<MB_THREAD_MAX; ithread++)
-        memset((void *)&processData[ithread].store, 0, sizeof(struct mbsys_stereopair_struct));
+    struct mbpg_process_struct processData[MBPG_PIPELINE_MAX];
+    for (int islot=0; islot<MBPG_PIPELINE_MAX; islot++)
+        memset((void *)&processData[islot].store, 0, sizeof(struct mbsys_stereopair_struct));
     struct mbpg_control_struct control;
     control.show_images = false;
     control.algorithm = STEREO_SGBM;
@@ -1255,6 +1383,9 @@ int main(int argc, char** argv)
     unsigned int numThreads = 1;
     unsigned int numConcurrency = std::thread::hardware_concurrency();
     std::thread mbphotogrammetryThreads[MB_THREAD_MAX];
+    std::thread mbphotogrammetryReadThreads[MB_THREAD_MAX];
+    unsigned int numReadThreads = 0;
+    struct mbpg_pipeline_struct pipeline;
     int thread_status[MB_THREAD_MAX];
     int thread_error[MB_THREAD_MAX];
 
@@ -1676,7 +1807,6 @@ int main(int argc, char** argv)
     int npairs_output_tot = 0;
     int imageStatus = MB_IMAGESTATUS_NONE;
     mb_path dpath;
-    unsigned int numThreadsSet = 0;
     mb_path imageLeftFile;
     double image_left_time_d;
     double image_left_gain;
@@ -1691,6 +1821,26 @@ int main(int argc, char** argv)
 
     fprintf(stream,"\nAbout to read ImageListFile: %s\n\n", ImageListFile);
 
+    /* start the image reading and stereo processing threads, keeping up to
+        two pairs per processing thread in flight, read by one I/O thread for
+        every four processing threads */
+    pipeline.capacity = 2 * numThreads;
+    pipeline.num_pending = 0;
+    pipeline.next_sequence = 0;
+    pipeline.next_output = 0;
+    pipeline.shutdown = false;
+    for (int islot = 0; islot < pipeline.capacity; islot++)
+        pipeline.slots[islot] = &processData[islot];
+    numReadThreads = (numThreads + 3) / 4;
+    for (unsigned int ithread = 0; ithread < numReadThreads; ithread++) {
+        mbphotogrammetryReadThreads[ithread] = std::thread(read_stereopairs, verbose, &pipeline);
+    }
+    for (unsigned int ithread = 0; ithread < numThreads; ithread++) {
+        mbphotogrammetryThreads[ithread]
+            = std::thread(process_stereopairs, verbose, &pipeline, ithread, &control,
+                            &thread_status[ithread], &thread_error[ithread]);
+    }
+
     bool done = false;
     bool firstprocess = true;
     while (!done) {
@@ -1919,8 +2069,7 @@ int main(int argc, char** argv)
                 }
 
                /* set process structure to use */
-                struct mbpg_process_struct *process = &processData[numThreadsSet];
-                process->thread = numThreadsSet;
+                struct mbpg_process_struct *process = pipeline_slot(verbose, &pipeline);
                 process->pair_count = npairs_process;
                 strncpy(process->imageLeftFile, imageLeftFile, sizeof(mb_path));
                 process->image_left_time_d = image_left_time_d;
@@ -1953,101 +2102,102 @@ int main(int argc, char** argv)
                                   &process->image_right_heading, &process->image_right_roll, &process->image_right_pitch,
                                   &error);
 
-                mbphotogrammetryThreads[numThreadsSet]
-                        = std::thread(process_stereopair, verbose, process, &control,
-                                        &thread_status[numThreadsSet], &thread_error[numThreadsSet]);
-                numThreadsSet++;
+                pipeline_submit(verbose, &pipeline, process);
                 npairs_process++;
             }
         }
 
-        /* If done or a full set of threads has been started wait for all to finish using join() 
-            before writing output data and then continuing */
-        if (numThreadsSet > 0 && (done || firstprocess || numThreadsSet == numThreads || imageStatus == MB_IMAGESTATUS_PARAMETER)) {
-            for (unsigned int ithread = 0; ithread < numThreadsSet; ithread++) {
-                /* join the thread (wait until it completes) */
-                mbphotogrammetryThreads[ithread].join();
-            }
-
-            bool new_output_file = false;
-            for (int ithread=0; ithread < numThreadsSet; ithread++) {
-                struct mbpg_process_struct *process = &processData[ithread];
-
-               if (surveylines_initialized) {
-                    if ((process->image_left_time_d > routetime_d[waypoint] || waypoint == 0)
-                        && waypoint < ntimepoint - 1) {
-                        new_output_file = true;
-                        snprintf(OutputFile, sizeof(OutputFile), "%s_%3.3d.mb251", OutputFileRoot, waypoint);
-                        waypoint++;
-                    }
-                }
-                else if (output_number_pairs > 0) {
-                    if (mbio_ptr == NULL || npairs_output >= output_number_pairs) {
-                        new_output_file = true;
-                        snprintf(OutputFile, sizeof(OutputFile), "%s_%3.3d.mb251", OutputFileRoot, waypoint);
-                        waypoint++;
-                    }
+        /* Write out processed stereo pairs in imagelist order. If done, if this is
+            the first pair (which initializes the stereo algorithm), or if parameters
+            are about to change then wait for every pair in the pipeline, otherwise
+            wait only while the pipeline is full */
+        bool wait_all = done || firstprocess || imageStatus == MB_IMAGESTATUS_PARAMETER;
+        struct mbpg_process_struct *process;
+        bool new_output_file = false;
+        while ((process = pipeline_next_result(verbose, &pipeline, wait_all)) != NULL) {
+            if (surveylines_initialized) {
+                if ((process->image_left_time_d > routetime_d[waypoint] || waypoint == 0)
+                    && waypoint < ntimepoint - 1) {
+                    new_output_file = true;
+                    snprintf(OutputFile, sizeof(OutputFile), "%s_%3.3d.mb251", OutputFileRoot, waypoint);
+                    waypoint++;
                 }
-                else if (mbio_ptr == NULL) {
+            }
+            else if (output_number_pairs > 0) {
+                if (mbio_ptr == NULL || npairs_output >= output_number_pairs) {
                     new_output_file = true;
-                    snprintf(OutputFile, sizeof(OutputFile), "%s.mb251", OutputFileRoot);
-                }
-
-                /* open output format *.mb251 file */
-                if (new_output_file) {
-                    /* if needed close the previous output file */
-                    if (mbio_ptr != NULL)
-                        status = mb_close(verbose, &mbio_ptr, &error);
-
-                    /* open the new output file */
-                    int obeams_bath, obeams_amp, opixels_ss;
-                    if ((status = mb_write_init(
-                        verbose, OutputFile, MBF_PHOTGRAM, &mbio_ptr,
-                        &obeams_bath, &obeams_amp, &opixels_ss, &error)) != MB_SUCCESS) {
-                        mb_error(verbose,error,&message);
-                        fprintf(stderr,"\nMBIO Error returned from function <mb_write_init>:\n%s\n",message);
-                        fprintf(stderr,"\nOutput fbt file <%s> not initialized for writing\n",OutputFile);
-                        fprintf(stderr,"\nProgram <%s> Terminated\n", program_name);
-                        exit(error);
-                    }
-                    if (verbose > 0)
-                        fprintf(stderr,"      --> Opened output file: %s\n", OutputFile);
-                    mb_io_ptr = (struct mb_io_struct *) mbio_ptr;
-                    store_ptr = mb_io_ptr->store_data;
-                    store = (struct mbsys_stereopair_struct *) store_ptr;
-                    new_output_file = false;
-                    npairs_output = 0;
-                }
-
-                /* write the output structure */
-                int time_i[7];
-                mb_get_date(verbose, process->image_left_time_d, time_i);
-                fprintf(stderr,"%d %s %s %4.4d/%2.2d/%2.2d %2.2d:%2.2d:%2.2d.%6.6d LLZ: %.8f %.8f %8.3f HRP:%6.2f %5.2f %5.2f A:%.3f %3f Q:%.2f\n",
-                        process->pair_count, process->imageLeftFile, process->imageRightFile,
-                        time_i[0], time_i[1], time_i[2], time_i[3], time_i[4], time_i[5], time_i[6],
-                        process->image_left_navlon, process->image_left_navlat, process->image_left_sensordepth, 
-                        process->image_left_heading, process->image_left_roll, process->image_left_pitch,
-                        process->image_left_amplitude, process->image_right_amplitude,
-                        process->pair_quality);
-                mb_write_ping(verbose, mbio_ptr, (void *)&process->store, &error);
-                npairs_output++;
-                npairs_output_tot++;
-                if (error != MB_ERROR_NO_ERROR) {
+                    snprintf(OutputFile, sizeof(OutputFile), "%s_%3.3d.mb251", OutputFileRoot, waypoint);
+                    waypoint++;
+                }
+            }
+            else if (mbio_ptr == NULL) {
+                new_output_file = true;
+                snprintf(OutputFile, sizeof(OutputFile), "%s.mb251", OutputFileRoot);
+            }
+
+            /* open output format *.mb251 file */
+            if (new_output_file) {
+                /* if needed close the previous output file */
+                if (mbio_ptr != NULL)
+                    status = mb_close(verbose, &mbio_ptr, &error);
+
+                /* open the new output file */
+                int obeams_bath, obeams_amp, opixels_ss;
+                if ((status = mb_write_init(
+                    verbose, OutputFile, MBF_PHOTGRAM, &mbio_ptr,
+                    &obeams_bath, &obeams_amp, &opixels_ss, &error)) != MB_SUCCESS) {
                     mb_error(verbose,error,&message);
-                    fprintf(stderr,"\nMBIO Error returned from function <mb_write_ping>:\n%s\n",message);
-                    fprintf(stderr,"\nMapping Data Not Written To File <%s>\n",OutputFile);
-                    fprintf(stderr,"\nProgram <%s> Terminated\n",
-                        program_name);
+                    fprintf(stderr,"\nMBIO Error returned from function <mb_write_init>:\n%s\n",message);
+                    fprintf(stderr,"\nOutput fbt file <%s> not initialized for writing\n",OutputFile);
+                    fprintf(stderr,"\nProgram <%s> Terminated\n", program_name);
                     exit(error);
                 }
+                if (verbose > 0)
+                    fprintf(stderr,"      --> Opened output file: %s\n", OutputFile);
+                mb_io_ptr = (struct mb_io_struct *) mbio_ptr;
+                store_ptr = mb_io_ptr->store_data;
+                store = (struct mbsys_stereopair_struct *) store_ptr;
+                new_output_file = false;
+                npairs_output = 0;
+            }
 
+            /* write the output structure */
+            int time_i[7];
+            mb_get_date(verbose, process->image_left_time_d, time_i);
+            fprintf(stderr,"%d %s %s %4.4d/%2.2d/%2.2d %2.2d:%2.2d:%2.2d.%6.6d LLZ: %.8f %.8f %8.3f HRP:%6.2f %5.2f %5.2f A:%.3f %3f Q:%.2f\n",
+                    process->pair_count, process->imageLeftFile, process->imageRightFile,
+                    time_i[0], time_i[1], time_i[2], time_i[3], time_i[4], time_i[5], time_i[6],
+                    process->image_left_navlon, process->image_left_navlat, process->image_left_sensordepth, 
+                    process->image_left_heading, process->image_left_roll, process->image_left_pitch,
+                    process->image_left_amplitude, process->image_right_amplitude,
+                    process->pair_quality);
+            mb_write_ping(verbose, mbio_ptr, (void *)&process->store, &error);
+            npairs_output++;
+            npairs_output_tot++;
+            if (error != MB_ERROR_NO_ERROR) {
+                mb_error(verbose,error,&message);
+                fprintf(stderr,"\nMBIO Error returned from function <mb_write_ping>:\n%s\n",message);
+                fprintf(stderr,"\nMapping Data Not Written To File <%s>\n",OutputFile);
+                fprintf(stderr,"\nProgram <%s> Terminated\n",
+                    program_name);
+                exit(error);
             }
-            numThreadsSet = 0;
             firstprocess = false;
         }
         if (done && mbio_ptr != NULL)
              status = mb_close(verbose, &mbio_ptr, &error);
 
+        /* if done stop the reading and processing threads */
+        if (done) {
+            pipeline_shutdown(verbose, &pipeline);
+            for (unsigned int ithread = 0; ithread < numReadThreads; ithread++) {
+                mbphotogrammetryReadThreads[ithread].join();
+            }
+            for (unsigned int ithread = 0; ithread < numThreads; ithread++) {
+                mbphotogrammetryThreads[ithread].join();
+            }
+        }
+
         /* handle parameter statements embedded in the recursive imagelist structure */
         if (!done && imageStatus == MB_IMAGESTATUS_PARAMETER) {
 
@@ -44,6 +44,10 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
 #include <thread>
 
 /* MB-System include files */
@@ -173,7 +177,54 @@ struct mbpm_process_struct {
     double camera_roll;
     double camera_pitch;
 
-    // Output image and priority map
+    // position in the imagelist and the image as read by the I/O threads
+    int image_sequence;
+    Mat imageInput;
+
+    // Output image and priority map, and the bounds (xmin, xmax, ymin, ymax)
+    // of the pixels written while processing the current image
+    Mat OutputImage;
+    Mat OutputPriority;
+    int OutputTouched[4];
+#ifdef DEBUG
+    Mat OutputIntensityCorrection;
+    Mat OutputStandoff;
+#endif
+};
+
+/* The part of the mosaic produced by a single image */
+struct mbpm_contribution_struct {
+    Rect roi;
+    Mat OutputImage;
+    Mat OutputPriority;
+#ifdef DEBUG
+    Mat OutputIntensityCorrection;
+    Mat OutputStandoff;
+#endif
+};
+
+/* Images flow through a bounded pipeline: the main thread parses the imagelist
+    and queues images, I/O threads read and decode them, and compute threads
+    take whichever decoded image is available next. Each compute thread renders
+    into its own scratch mosaic, and the touched region is handed back as a
+    contribution. Contributions are merged into the output mosaic strictly in
+    imagelist order so the result does not depend on thread scheduling. */
+struct mbpm_pipeline_struct {
+    std::mutex mutex;
+    std::condition_variable read_ready;
+    std::condition_variable process_ready;
+    std::condition_variable slot_ready;
+    std::deque<struct mbpm_process_struct> read_queue;
+    std::deque<struct mbpm_process_struct> process_queue;
+    std::map<int, struct mbpm_contribution_struct> merge_queue;
+    int capacity;
+    int num_pending;
+    int next_sequence;
+    int next_merge;
+    bool merging;
+    bool shutdown;
+
+    // Output mosaic image and priority map
     Mat OutputImage;
     Mat OutputPriority;
 #ifdef DEBUG
@@ -222,6 +273,12 @@ struct mbpm_control_struct {
     Point2d principalPoint[2];
     double aspectRatio[2];
 
+    // Undistortion remap tables and pixel ray directions for each camera,
+    // calculated once when the camera model is applied
+    Mat undistortMap1[2];
+    Mat undistortMap2[2];
+    Mat pixelRays[2];
+
     // Dark image
     bool dark_ignore_set;
     double dark_ignore_threshold;
@@ -907,6 +964,110 @@ void load_correction(int verbose, mb_path ImageCorrectionFile, struct mbpm_contr
 
 }
 
+/*--------------------------------------------------------------------*/
+/* Calculate the unit vector of the ray through each pixel of an undistorted
+    image in the camera frame (x right, y up, z out of the lens), along with
+    the angular width of the pixel. The rays are stored as four floats per
+    pixel: the x, y, and z components and the angular width in degrees. */
+void calculate_pixel_rays(int verbose, struct mbpm_control_struct *control, int camera,
+                          Size size, Mat &pixelRays)
+{
+    /* get principal point and the reference "depth" used in calculating
+        ray angles for individual pixels */
+    double center_x = control->principalPoint[camera].x / control->SensorCellMm;
+    double center_y = control->principalPoint[camera].y / control->SensorCellMm;
+    double zzref = 0.5 * (0.5 * control->imageSize.width / tan(DTR * 0.5 * control->fovx[camera] * control->fov_fudgefactor)
+            + 0.5 * control->imageSize.height / tan(DTR * 0.5 * control->fovy[camera] * control->fov_fudgefactor));
+
+    pixelRays.create(size, CV_32FC4);
+    for (int j=0; j<size.height; j++) {
+        Vec4f *ray = pixelRays.ptr<Vec4f>(j);
+        for (int i=0; i<size.width; i++) {
+            double xx = i - center_x;
+            double yy = center_y - j;
+            double rrxy = sqrt(xx * xx + yy * yy);
+            double rr = sqrt(rrxy * rrxy + zzref * zzref);
+            double rr2 = sqrt((rrxy + 1.0) * (rrxy + 1.0) + zzref * zzref);
+            ray[i][0] = xx / rr;
+            ray[i][1] = yy / rr;
+            ray[i][2] = zzref / rr;
+            ray[i][3] = RTD * (acos(zzref / rr2) - acos(zzref / rr));
+        }
+    }
+}
+/*--------------------------------------------------------------------*/
+/* Calculate the undistortion remap tables and pixel ray directions for
+    both cameras. This is done once when the camera model is applied
+    rather than for each image. */
+void setup_camera_tables(int verbose, struct mbpm_control_struct *control, int *error)
+{
+    for (int camera = 0; camera < 2; camera++) {
+        initUndistortRectifyMap(control->cameraMatrix[camera], control->distCoeffs[camera], Mat(),
+                                control->cameraMatrix[camera], control->imageSize, CV_16SC2,
+                                control->undistortMap1[camera], control->undistortMap2[camera]);
+        calculate_pixel_rays(verbose, control, camera, control->imageSize, control->pixelRays[camera]);
+    }
+}
+/*--------------------------------------------------------------------*/
+/* Undistort an image using the remap tables of its camera, falling back
+    to a full undistortion if the image does not have the dimensions of
+    the camera model. */
+void undistort_image(int verbose, struct mbpm_control_struct *control, int camera,
+                     const Mat &image, Mat &imageUndistort)
+{
+    if (image.size() == control->imageSize && !control->undistortMap1[camera].empty())
+        remap(image, imageUndistort, control->undistortMap1[camera], control->undistortMap2[camera],
+              INTER_LINEAR, BORDER_CONSTANT);
+    else
+        undistort(image, imageUndistort, control->cameraMatrix[camera], control->distCoeffs[camera], noArray());
+}
+/*--------------------------------------------------------------------*/
+/* Get the rotation matrices taking pixel ray unit vectors from the camera
+    frame to the world frame for an image. The attitude matrix applies the
+    camera roll and pitch, giving vectors relative to the vertical without
+    heading applied. The rotation matrix additionally applies the rotation
+    of the camera relative to the rig and the rig heading. */
+void get_image_rotation(int verbose, struct mbpm_process_struct *process,
+                        struct mbpm_control_struct *control, double attitude[9],
+                        double rotation[9], int *error)
+{
+    /* the attitude rotation is linear, so its matrix columns are the
+        rotated unit vectors */
+    for (int k = 0; k < 3; k++) {
+        double xx, yy, zz;
+        mb_platform_math_attitude_rotate_beam(verbose,
+            (k == 0 ? 1.0 : 0.0), (k == 1 ? 1.0 : 0.0), (k == 2 ? 1.0 : 0.0),
+            process->camera_roll, process->camera_pitch, 0.0,
+            &xx, &yy, &zz,
+            error);
+        attitude[k] = xx;
+        attitude[3 + k] = yy;
+        attitude[6 + k] = zz;
+    }
+
+    /* apply rotation of each camera relative to the rig */
+    double camera[9];
+    for (int k = 0; k < 9; k++)
+        camera[k] = attitude[k];
+    if (process->image_camera == 1) {
+        for (int ii = 0; ii < 3; ii++) {
+            for (int k = 0; k < 3; k++) {
+                camera[3 * ii + k] = control->R.at<double>(ii,0) * attitude[k]
+                                    + control->R.at<double>(ii,1) * attitude[3 + k]
+                                    + control->R.at<double>(ii,2) * attitude[6 + k];
+            }
+        }
+    }
+
+    /* apply rotation by camera rig heading */
+    double headingx = sin(DTR * process->camera_heading);
+    double headingy = cos(DTR * process->camera_heading);
+    for (int k = 0; k < 3; k++) {
+        rotation[k] = camera[k] * headingy + camera[3 + k] * headingx;
+        rotation[3 + k] = -camera[k] * headingx + camera[3 + k] * headingy;
+        rotation[6 + k] = camera[6 + k];
+    }
+}
 /*--------------------------------------------------------------------*/
 void process_image(int verbose, struct mbpm_process_struct *process,
                   struct mbpm_control_struct *control, int *status, int *error)
@@ -927,11 +1088,17 @@ void process_image(int verbose, struct mbpm_process_struct *process,
     /* read the image */
     bool image_ignore = false;
     bool image_multiply = false;
-    imageProcess = imread(process->imageFile);
+    if (!process->imageInput.empty()) {
+        imageProcess = process->imageInput;
+        process->imageInput.release();
+    }
+    else {
+        imageProcess = imread(process->imageFile);
+    }
     if (!imageProcess.empty()) {
 
         /* undistort the image */
-        undistort(imageProcess, imageUndistort, control->cameraMatrix[process->image_camera], control->distCoeffs[process->image_camera], noArray());
+        undistort_image(verbose, control, process->image_camera, imageProcess, imageUndistort);
         cvtColor(imageUndistort, imageUndistortYCrCb, COLOR_BGR2YCrCb);
         imageProcess.release();
 
@@ -1189,26 +1356,38 @@ void process_image(int verbose, struct mbpm_process_struct *process,
                 image_center_standoff, imageIntensityCorrection, center_yCorrection,
                 image_priority, end_str);
 
+        /* Get the rotations of pixel rays from the camera frame to the world frame */
+        double attitude[9], rotation[9];
+        get_image_rotation(verbose, process, control, attitude, rotation, error);
+
+        /* Get the pixel rays for this camera - these are precalculated unless
+            this image does not have the dimensions of the camera model */
+        Mat pixelRaysLocal;
+        const Mat *pixelRays = &control->pixelRays[process->image_camera];
+        if (pixelRays->size() != imageUndistort.size()) {
+            calculate_pixel_rays(verbose, control, process->image_camera, imageUndistort.size(), pixelRaysLocal);
+            pixelRays = &pixelRaysLocal;
+        }
+
         /* Loop over the pixels in the undistorted image. If trim is nonzero then
             that number of pixels are ignored around the margins. This solves the
             problem of black pixels being incorporated into the photomosaic. If
             trim is not specified then code below will ignore both black pixels
-            and pixels that are adjacent to black pixels. */
+            and pixels that are adjacent to black pixels.
+            The pixels are processed a column at a time: the rays of the usable
+            pixels are rotated into the world frame, then intersected with the
+            topography together, and then mapped into the output image. */
+        int nblock = imageUndistort.rows;
+        vector<int> block_j(nblock);
+        vector<double> block_vx(nblock), block_vy(nblock), block_vz(nblock);
+        vector<double> block_theta(nblock), block_dtheta(nblock), block_priority(nblock);
+        vector<double> block_lon(nblock), block_lat(nblock), block_topo(nblock), block_range(nblock);
+        vector<int> block_status(nblock);
 
         for (int i=control->trimPixels; i<imageUndistort.cols-control->trimPixels; i++) {
+            int nray = 0;
             for (int j=control->trimPixels; j<imageUndistort.rows-control->trimPixels; j++) {
                 bool use_pixel = true;
-                double xx;
-                double yy;
-                double rrxysq;
-                double rrxy;
-                double rrxysq2;
-                double rr2;
-                double theta2;
-                double dtheta;
-                double pixel_priority;
-                double standoff = 0.0;
-                double lon, lat, topo;
 
                 /* Deal with problem of black pixels at the margins of the
                     undistorted images. If the user has not specified a trim
@@ -1234,131 +1413,72 @@ void process_image(int verbose, struct mbpm_process_struct *process,
                 }
 
                 if (use_pixel) {
-                    /* calculate the pixel priority based on the distance
-                        from the image center */
-                    xx = i - center_x;
-                    yy = center_y - j;
-    //int debugprint = MB_NO;
-    //int icenter_x = (int)center_x;
-    //int icenter_y = (int)center_y;
-    //if (i == icenter_x && j == icenter_y) {
-    //debugprint = MB_YES;
-    //}
-                    rrxysq = xx * xx + yy * yy;
-                    rrxy = sqrt(rrxysq);
-                    rr = sqrt(rrxysq + zzref * zzref);
-                    pixel_priority = image_priority * (rrxymax - rrxy) / rrxymax;
-    //if (debugprint == MB_YES) {
-    //fprintf(stream,"\nPRIORITY xx:%f yy:%f zzref:%f rr:%f rrxy:%f rrxymax:%f pixel_priority:%f\n",
-    //xx,yy,zzref,rr,rrxy,rrxymax,pixel_priority);
-    //}
-
-                    /* calculate the pixel takeoff angles relative to the camera rig */
-                    phi = RTD * atan2(yy, xx);
-                    theta = RTD * acos(zzref / rr);
-
-                    /* calculate the angular width of a single pixel */
-                    rrxysq2 = (rrxy + 1.0) * (rrxy + 1.0);
-                    rr2 = sqrt(rrxysq2 + zzref * zzref);
-                    theta2 = RTD * acos(zzref / rr2);
-                    dtheta = theta2 - theta;
-    //if (debugprint == MB_YES) {
-    //fprintf(stream,"Camera: roll:%.3f pitch:%.3f\n", process->camera_roll, process->camera_pitch);
-    //fprintf(stream,"Rows:%d Cols:%d | %5d %5d BGR:%3.3d|%3.3d|%3.3d",
-    //imageUndistort.rows, imageUndistort.cols, i, j,
-    //imageUndistort.at<Vec3b>(j,i)[0], imageUndistort.at<Vec3b>(j,i)[1], imageUndistort.at<Vec3b>(j,i)[2]);
-    //fprintf(stream," xyz:%f %f %f r:%f   phi:%f theta:%f\n", xx, yy, zzref, rr, phi, theta);
-    //}
-
-                    /* rotate pixel location using attitude and zzref */
-                    double zz;
-                    mb_platform_math_attitude_rotate_beam(verbose,
-                        xx, yy, zzref,
-                        process->camera_roll, process->camera_pitch, 0.0,
-                        &xx, &yy, &zz,
-                        error);
-
-                    /* recalculate the pixel takeoff angles relative to the camera rig */
-                    rrxysq = xx * xx + yy * yy;
-                    rrxy = sqrt(rrxysq);
-                    rr = sqrt(rrxysq + zz * zz);
-                    phi = RTD * atan2(yy, xx);
-                    theta = RTD * acos(zz / rr);
-    //if (debugprint == MB_YES) {
-    //fprintf(stream,"Rows:%d Cols:%d | %5d %5d BGR:%3.3d|%3.3d|%3.3d",
-    //imageUndistort.rows, imageUndistort.cols, i, j,
-    //imageUndistort.at<Vec3b>(j,i)[0], imageUndistort.at<Vec3b>(j,i)[1], imageUndistort.at<Vec3b>(j,i)[2]);
-    //fprintf(stream," xyz:%f %f %f r:%f   phi:%f theta:%f\n", xx, yy, zz, rr, phi, theta);
-    //}
-
-                    /* calculate unit vector relative to the camera rig */
-                    vz = cos(DTR * theta);
-                    vx = sin(DTR * theta) * cos(DTR * phi);
-                    vy = sin(DTR * theta) * sin(DTR * phi);
-    //if (debugprint == MB_YES) {
-    //fprintf(stream,"camera rig unit vector: %f %f %f\n",vx,vy,vz);
-    //}
+                    /* calculate the pixel takeoff angle relative to the vertical
+                        by applying the attitude to the pixel ray */
+                    const Vec4f &ray = pixelRays->at<Vec4f>(j,i);
+                    double wz = attitude[6] * ray[0] + attitude[7] * ray[1] + attitude[8] * ray[2];
+                    theta = RTD * acos(MIN(MAX(wz, -1.0), 1.0));
+
                     /* if takeoff angle is too vertical (this is a 2D photomosaic)
                         then do not use this pixel */
                     if (theta > 80.0)
                         use_pixel = false;
-                }
-
-                if (use_pixel) {
-
-                    /* apply rotation of each camera relative to the rig */
-                    if (process->image_camera == 1) {
-                        vxx = vx * (control->R.at<double>(0,0)) + vy * (control->R.at<double>(0,1)) + vz * (control->R.at<double>(0,2));
-                        vyy = vx * (control->R.at<double>(1,0)) + vy * (control->R.at<double>(1,1)) + vz * (control->R.at<double>(1,2));
-                        vzz = vx * (control->R.at<double>(2,0)) + vy * (control->R.at<double>(2,1)) + vz * (control->R.at<double>(2,2));
-//if (debugprint == MB_YES) {
-//fprintf(stream,"\nR:      %f %f %f\n",control->R.at<double>(0,0), control->R.at<double>(0,1), control->R.at<double>(0,2));
-//fprintf(stream,"R:      %f %f %f\n",control->R.at<double>(1,0), control->R.at<double>(1,1), control->R.at<double>(1,2));
-//fprintf(stream,"R:      %f %f %f\n",control->R.at<double>(2,0), control->R.at<double>(2,1), control->R.at<double>(2,2));
-//fprintf(stream,"Rotation: camera 1 unit vector: %f %f %f    camera 0 unit vector: %f %f %f\n",vx,vy,vz,vxx,vyy,vzz);
-//}
-                    }
-                    else {
-                        vxx = vx;
-                        vyy = vy;
-                        vzz = vz;
-                    }
-//if (debugprint == MB_YES) {
-//fprintf(stream,"camera unit vector:     %f %f %f\n",vx,vy,vz);
-//}
-
-                    /* rotate unit vector by camera rig heading */
-                    vx = vxx * cos(DTR * process->camera_heading) + vyy * sin(DTR * process->camera_heading);
-                    vy = -vxx * sin(DTR * process->camera_heading) + vyy * cos(DTR * process->camera_heading);
-                    vz = vzz;
-//if (debugprint == MB_YES) {
-//fprintf(stream,"camera unit vector rotated by heading %f:     %f %f %f\n",process->camera_heading,vx,vy,vz);
-//}
 
-                    /* find the location where this vector intersects the grid */
-                    if (control->use_topography) {
-                        *status = mb_topogrid_intersect(verbose, control->topogrid_ptr,
-                                    process->camera_navlon, process->camera_navlat, 0.0, process->camera_sensordepth,
-                                    control->mtodeglon, control->mtodeglat, vx, vy, vz,
-                                    &lon, &lat, &topo, &rr, error);
-                    }
+                    /* otherwise save the ray rotated into the world frame, the
+                        angular width of the pixel, and the pixel priority based
+                        on the distance from the image center */
                     else {
-                        rr = control->standoff_target / vz;
-                        lon = process->camera_navlon + control->mtodeglon * vx * rr;
-                        lat = process->camera_navlat + control->mtodeglon * vy * rr;
-                        topo = -process->camera_sensordepth -  control->standoff_target;
+                        xx = i - center_x;
+                        yy = center_y - j;
+                        block_j[nray] = j;
+                        block_vx[nray] = rotation[0] * ray[0] + rotation[1] * ray[1] + rotation[2] * ray[2];
+                        block_vy[nray] = rotation[3] * ray[0] + rotation[4] * ray[1] + rotation[5] * ray[2];
+                        block_vz[nray] = rotation[6] * ray[0] + rotation[7] * ray[1] + rotation[8] * ray[2];
+                        block_theta[nray] = theta;
+                        block_dtheta[nray] = ray[3];
+                        block_priority[nray] = image_priority * (rrxymax - sqrt(xx * xx + yy * yy)) / rrxymax;
+                        nray++;
                     }
-                    zz = -process->camera_sensordepth - topo;
+                }
+            }
 
-                    /* standoff is dot product of camera vector with projected pixel vector */
-                    standoff = (cx * rr * vx) + (cy * rr * vy) + (cz * rr * vz);
-//if (debugprint == MB_YES) {
-//fprintf(stream," llz: %.10f %.10f %.3f  range:%.3f  standoff:%.3f\n", lon, lat, topo, rr, standoff);
-//}
-                    /* Don't use pixel if too vertical or range too large */
-                    if (theta > 80.0 || rr > control->range_max)
-                        use_pixel = false;
+            /* find the locations where the pixel rays intersect the grid */
+            if (nray > 0 && control->use_topography) {
+                mb_topogrid_intersect_batch(verbose, control->topogrid_ptr,
+                            process->camera_navlon, process->camera_navlat, 0.0, process->camera_sensordepth,
+                            control->mtodeglon, control->mtodeglat, nray,
+                            block_vx.data(), block_vy.data(), block_vz.data(),
+                            block_lon.data(), block_lat.data(), block_topo.data(), block_range.data(),
+                            block_status.data(), error);
+                *status = block_status[nray-1];
+            }
+            else {
+                for (int iray = 0; iray < nray; iray++) {
+                    block_range[iray] = control->standoff_target / block_vz[iray];
+                    block_lon[iray] = process->camera_navlon + control->mtodeglon * block_vx[iray] * block_range[iray];
+                    block_lat[iray] = process->camera_navlat + control->mtodeglon * block_vy[iray] * block_range[iray];
+                    block_topo[iray] = -process->camera_sensordepth -  control->standoff_target;
                 }
+            }
+
+            /* map the pixels into the output image */
+            for (int iray = 0; iray < nray; iray++) {
+                int j = block_j[iray];
+                double pixel_priority = block_priority[iray];
+                double dtheta = block_dtheta[iray];
+                lon = block_lon[iray];
+                lat = block_lat[iray];
+                theta = block_theta[iray];
+                vx = block_vx[iray];
+                vy = block_vy[iray];
+                vz = block_vz[iray];
+                rr = block_range[iray];
+
+                /* standoff is dot product of camera vector with projected pixel vector */
+                double standoff = (cx * rr * vx) + (cy * rr * vy) + (cz * rr * vz);
+
+                /* Don't use pixel if range too large */
+                bool use_pixel = (rr <= control->range_max);
 
                 if (use_pixel) {
 
@@ -1639,6 +1759,10 @@ void process_image(int verbose, struct mbpm_process_struct *process,
                                 process->OutputImage.at<Vec3b>(jpix,ipix)[1] = g;
                                 process->OutputImage.at<Vec3b>(jpix,ipix)[2] = r;
                                 process->OutputPriority.at<float>(jpix,ipix) = pixel_priority_use;
+                                process->OutputTouched[0] = MIN(process->OutputTouched[0], (int)ipix);
+                                process->OutputTouched[1] = MAX(process->OutputTouched[1], (int)ipix);
+                                process->OutputTouched[2] = MIN(process->OutputTouched[2], (int)jpix);
+                                process->OutputTouched[3] = MAX(process->OutputTouched[3], (int)jpix);
 #ifdef DEBUG
                                 process->OutputIntensityCorrection.at<float>(jpix,ipix) = intensityCorrection;
                                 process->OutputStandoff.at<float>(jpix,ipix) = standoff;
@@ -1684,11 +1808,17 @@ void process_image_sectioned(int verbose, struct mbpm_process_struct *process,
     /* read the image */
     bool image_ignore = false;
     bool image_multiply = false;
-    imageProcess = imread(process->imageFile);
+    if (!process->imageInput.empty()) {
+        imageProcess = process->imageInput;
+        process->imageInput.release();
+    }
+    else {
+        imageProcess = imread(process->imageFile);
+    }
     if (!imageProcess.empty()) {
 
         /* undistort the image */
-        undistort(imageProcess, imageUndistort, control->cameraMatrix[process->image_camera], control->distCoeffs[process->image_camera], noArray());
+        undistort_image(verbose, control, process->image_camera, imageProcess, imageUndistort);
         cvtColor(imageUndistort, imageUndistortYCrCb, COLOR_BGR2YCrCb);
         imageProcess.release();
 
@@ -1928,6 +2058,10 @@ void process_image_sectioned(int verbose, struct mbpm_process_struct *process,
             image_priority *= heading_priority;
         }
 
+        /* Get the rotations of pixel rays from the camera frame to the world frame */
+        double attitude[9], rotation[9];
+        get_image_rotation(verbose, process, control, attitude, rotation, error);
+
         /* Loop over sections of the undistorted image, and map those onto the
            destination image as continuous quads. The priority determining if the
            section is mapped is calculated for the center pixel of the section. */
@@ -1974,18 +2108,17 @@ void process_image_sectioned(int verbose, struct mbpm_process_struct *process,
                     for (int icorner = 0; icorner < 5 && use_section; icorner++) {
 
                         /* rotate pixel location using attitude and zzref */
-                        mb_platform_math_attitude_rotate_beam(verbose,
-                            srcCorners[icorner].x, srcCorners[icorner].y, zzref,
-                            process->camera_roll, process->camera_pitch, 0.0,
-                            &xx, &yy, &zz,
-                            error);
+                        double px = srcCorners[icorner].x;
+                        double py = srcCorners[icorner].y;
+                        xx = attitude[0] * px + attitude[1] * py + attitude[2] * zzref;
+                        yy = attitude[3] * px + attitude[4] * py + attitude[5] * zzref;
+                        zz = attitude[6] * px + attitude[7] * py + attitude[8] * zzref;
 
                         /* calculate the pixel takeoff angles relative
                             to the world frame vertical (but heading not yet applied) */
                         double rrxysq = xx * xx + yy * yy;
                         rrxy = sqrt(rrxysq);
                         rr = sqrt(rrxysq + zz * zz);
-                        phi = RTD * atan2(yy, xx);
                         theta = RTD * acos(zz / rr);
 
                         /* continue only if takeoff angle is not too vertical
@@ -1994,27 +2127,13 @@ void process_image_sectioned(int verbose, struct mbpm_process_struct *process,
                             use_section = false;
                         if (use_section) {
 
-                            /* calculate unit direction vector of pixel */
-                            vz = cos(DTR * theta);
-                            vx = sin(DTR * theta) * cos(DTR * phi);
-                            vy = sin(DTR * theta) * sin(DTR * phi);
-
-                            /* apply rotation of each camera relative to the rig */
-                            if (process->image_camera == 1) {
-                                vxx = vx * (control->R.at<double>(0,0)) + vy * (control->R.at<double>(0,1)) + vz * (control->R.at<double>(0,2));
-                                vyy = vx * (control->R.at<double>(1,0)) + vy * (control->R.at<double>(1,1)) + vz * (control->R.at<double>(1,2));
-                                vzz = vx * (control->R.at<double>(2,0)) + vy * (control->R.at<double>(2,1)) + vz * (control->R.at<double>(2,2));
-                            }
-                            else {
-                                vxx = vx;
-                                vyy = vy;
-                                vzz = vz;
-                            }
-
-                            /* rotate unit vector by camera rig heading */
-                            vx = vxx * cos(DTR * process->camera_heading) + vyy * sin(DTR * process->camera_heading);
-                            vy = -vxx * sin(DTR * process->camera_heading) + vyy * cos(DTR * process->camera_heading);
-                            vz = vzz;
+                            /* calculate unit direction vector of pixel in the
+                                world frame, applying the rotation of each camera
+                                relative to the rig and the rig heading */
+                            double pr = sqrt(px * px + py * py + zzref * zzref);
+                            vx = (rotation[0] * px + rotation[1] * py + rotation[2] * zzref) / pr;
+                            vy = (rotation[3] * px + rotation[4] * py + rotation[5] * zzref) / pr;
+                            vz = (rotation[6] * px + rotation[7] * py + rotation[8] * zzref) / pr;
 
                             /* find the location where this vector intersects the grid */
                             if (control->use_topography) {
@@ -2439,6 +2558,10 @@ void process_image_sectioned(int verbose, struct mbpm_process_struct *process,
                                 process->OutputImage.at<Vec3b>(dj,di)[1] = g;
                                 process->OutputImage.at<Vec3b>(dj,di)[2] = r;
                                 process->OutputPriority.at<float>(dj,di) = section_priority;
+                                process->OutputTouched[0] = MIN(process->OutputTouched[0], di);
+                                process->OutputTouched[1] = MAX(process->OutputTouched[1], di);
+                                process->OutputTouched[2] = MIN(process->OutputTouched[2], dj);
+                                process->OutputTouched[3] = MAX(process->OutputTouched[3], dj);
                             }
                         }
                     }
@@ -2452,6 +2575,156 @@ void process_image_sectioned(int verbose, struct mbpm_process_struct *process,
         imageUndistortYCrCb.release();
 
 }
+/*--------------------------------------------------------------------*/
+void pipeline_submit(int verbose, struct mbpm_pipeline_struct *pipeline,
+                  struct mbpm_process_struct *process)
+{
+    std::unique_lock<std::mutex> lock(pipeline->mutex);
+
+    /* wait for a free slot so that only a bounded number of images are in memory */
+    pipeline->slot_ready.wait(lock, [pipeline] { return pipeline->num_pending < pipeline->capacity; });
+
+    process->image_sequence = pipeline->next_sequence++;
+    pipeline->num_pending++;
+    pipeline->read_queue.push_back(*process);
+    pipeline->read_ready.notify_one();
+
+    if (verbose > 1)
+        fprintf(stderr, "Queued image %d for processing: %s\n", process->image_sequence, process->imageFile);
+}
+/*--------------------------------------------------------------------*/
+void pipeline_wait(int verbose, struct mbpm_pipeline_struct *pipeline)
+{
+    /* wait until every queued image has been processed and merged */
+    std::unique_lock<std::mutex> lock(pipeline->mutex);
+    pipeline->slot_ready.wait(lock, [pipeline] { return pipeline->num_pending == 0; });
+}
+/*--------------------------------------------------------------------*/
+void pipeline_shutdown(int verbose, struct mbpm_pipeline_struct *pipeline)
+{
+    std::unique_lock<std::mutex> lock(pipeline->mutex);
+    pipeline->shutdown = true;
+    pipeline->read_ready.notify_all();
+    pipeline->process_ready.notify_all();
+}
+/*--------------------------------------------------------------------*/
+void read_images(int verbose, struct mbpm_pipeline_struct *pipeline)
+{
+    while (true) {
+        struct mbpm_process_struct job;
+        {
+            std::unique_lock<std::mutex> lock(pipeline->mutex);
+            pipeline->read_ready.wait(lock, [pipeline] { return pipeline->shutdown || !pipeline->read_queue.empty(); });
+            if (pipeline->read_queue.empty())
+                return;
+            job = pipeline->read_queue.front();
+            pipeline->read_queue.pop_front();
+        }
+
+        /* read and decode the image outside the lock - process_image()
+            reports images that cannot be read */
+        job.imageInput = imread(job.imageFile);
+
+        std::unique_lock<std::mutex> lock(pipeline->mutex);
+        pipeline->process_queue.push_back(job);
+        pipeline->process_ready.notify_one();
+    }
+}
+/*--------------------------------------------------------------------*/
+void merge_contributions(int verbose, struct mbpm_pipeline_struct *pipeline,
+                  int image_sequence, struct mbpm_contribution_struct *contribution)
+{
+    std::unique_lock<std::mutex> lock(pipeline->mutex);
+    pipeline->merge_queue[image_sequence] = *contribution;
+
+    /* only one thread merges at a time, taking contributions in imagelist order
+        for as long as the next one in sequence is available */
+    if (pipeline->merging)
+        return;
+    pipeline->merging = true;
+    while (!pipeline->merge_queue.empty()
+            && pipeline->merge_queue.begin()->first == pipeline->next_merge) {
+        struct mbpm_contribution_struct next = pipeline->merge_queue.begin()->second;
+        pipeline->merge_queue.erase(pipeline->merge_queue.begin());
+        lock.unlock();
+
+        /* copy pixels with a higher priority than the current mosaic; ties go to
+            the earlier image just as when the images are processed serially */
+        for (int j = 0; j < next.roi.height; j++) {
+            for (int i = 0; i < next.roi.width; i++) {
+                int ii = next.roi.x + i;
+                int jj = next.roi.y + j;
+                if (next.OutputPriority.at<float>(j,i) > pipeline->OutputPriority.at<float>(jj,ii)) {
+                    pipeline->OutputImage.at<Vec3b>(jj,ii) = next.OutputImage.at<Vec3b>(j,i);
+                    pipeline->OutputPriority.at<float>(jj,ii) = next.OutputPriority.at<float>(j,i);
+#ifdef DEBUG
+                    pipeline->OutputIntensityCorrection.at<float>(jj,ii) = next.OutputIntensityCorrection.at<float>(j,i);
+                    pipeline->OutputStandoff.at<float>(jj,ii) = next.OutputStandoff.at<float>(j,i);
+#endif
+                }
+            }
+        }
+
+        lock.lock();
+        pipeline->next_merge++;
+        pipeline->num_pending--;
+        pipeline->slot_ready.notify_all();
+    }
+    pipeline->merging = false;
+}
+/*--------------------------------------------------------------------*/
+void process_images(int verbose, struct mbpm_pipeline_struct *pipeline,
+                  struct mbpm_process_struct *process,
+                  struct mbpm_control_struct *control, int *status, int *error)
+{
+    while (true) {
+        struct mbpm_process_struct job;
+        {
+            std::unique_lock<std::mutex> lock(pipeline->mutex);
+            pipeline->process_ready.wait(lock, [pipeline] { return pipeline->shutdown || !pipeline->process_queue.empty(); });
+            if (pipeline->process_queue.empty())
+                return;
+            job = pipeline->process_queue.front();
+            pipeline->process_queue.pop_front();
+        }
+
+        /* render the image into this thread's scratch mosaic */
+        job.thread = process->thread;
+        job.OutputImage = process->OutputImage;
+        job.OutputPriority = process->OutputPriority;
+#ifdef DEBUG
+        job.OutputIntensityCorrection = process->OutputIntensityCorrection;
+        job.OutputStandoff = process->OutputStandoff;
+#endif
+        job.OutputTouched[0] = control->OutputDim[0];
+        job.OutputTouched[1] = -1;
+        job.OutputTouched[2] = control->OutputDim[1];
+        job.OutputTouched[3] = -1;
+        if (control->sectionPixels > 0)
+            process_image_sectioned(verbose, &job, control, status, error);
+        else
+            process_image(verbose, &job, control, status, error);
+
+        /* copy out the touched region and clear it for the next image */
+        struct mbpm_contribution_struct contribution;
+        if (job.OutputTouched[1] >= job.OutputTouched[0]) {
+            contribution.roi = Rect(job.OutputTouched[0], job.OutputTouched[2],
+                                    job.OutputTouched[1] - job.OutputTouched[0] + 1,
+                                    job.OutputTouched[3] - job.OutputTouched[2] + 1);
+            contribution.OutputImage = process->OutputImage(contribution.roi).clone();
+            contribution.OutputPriority = process->OutputPriority(contribution.roi).clone();
+            process->OutputImage(contribution.roi).setTo(Scalar::all(0));
+            process->OutputPriority(contribution.roi).setTo(Scalar::all(0));
+#ifdef DEBUG
+            contribution.OutputIntensityCorrection = process->OutputIntensityCorrection(contribution.roi).clone();
+            contribution.OutputStandoff = process->OutputStandoff(contribution.roi).clone();
+            process->OutputIntensityCorrection(contribution.roi).setTo(Scalar::all(0));
+            process->OutputStandoff(contribution.roi).setTo(Scalar::all(0));
+#endif
+        }
+        merge_contributions(verbose, pipeline, job.image_sequence, &contribution);
+    }
+}
 
 /*--------------------------------------------------------------------*/
 
@@ -2784,8 +3057,11 @@ int main(int argc, char** argv)
     unsigned int numThreads = 1;
     unsigned int numConcurrency = std::thread::hardware_concurrency();
     std::thread mbphotomosaicThreads[MB_THREAD_MAX];
+    std::thread mbphotomosaicReadThreads[MB_THREAD_MAX];
+    unsigned int numReadThreads = 0;
     int thread_status[MB_THREAD_MAX];
     int thread_error[MB_THREAD_MAX];
+    struct mbpm_pipeline_struct pipeline;
 
     /* process argument list */
     while ((c = getopt_long(argc, argv, "", options, &option_index)) != -1)
@@ -3663,11 +3939,23 @@ control.OutputBounds[0], control.OutputBounds[1], control.OutputBounds[2], contr
         fprintf(stream,"  pbounds[3]: north:                   %.9f\n",pbounds[3]);
         }
 
-    /* If output file specified then create an an output image and priority map
-        in the processing structure for each processing thread. The images will
-        be combined after all processing is complete. */
+    /* If output file specified then create the output image and priority map,
+        and a scratch image and priority map in the processing structure for
+        each processing thread. Then start the image reading and processing
+        threads, which wait for images to be queued from the imagelist. */
     if (outputimage_specified) {
+        pipeline.OutputImage.create(control.OutputDim[1], control.OutputDim[0], CV_8UC3);
+        pipeline.OutputImage = Scalar::all(0);
+        pipeline.OutputPriority.create(control.OutputDim[1], control.OutputDim[0], CV_32FC1);
+        pipeline.OutputPriority = Scalar::all(0);
+#ifdef DEBUG
+        pipeline.OutputIntensityCorrection.create(control.OutputDim[1], control.OutputDim[0], CV_32FC1);
+        pipeline.OutputIntensityCorrection = Scalar::all(0);
+        pipeline.OutputStandoff.create(control.OutputDim[1], control.OutputDim[0], CV_32FC1);
+        pipeline.OutputStandoff = Scalar::all(0);
+#endif
         for (int ithread = 0; ithread < numThreads; ithread++) {
+            processPars[ithread].thread = ithread;
             processPars[ithread].OutputImage.create(control.OutputDim[1], control.OutputDim[0], CV_8UC3);
             processPars[ithread].OutputImage = Scalar::all(0);
             processPars[ithread].OutputPriority.create(control.OutputDim[1], control.OutputDim[0], CV_32FC1);
@@ -3679,6 +3967,24 @@ control.OutputBounds[0], control.OutputBounds[1], control.OutputBounds[2], contr
             processPars[ithread].OutputStandoff = Scalar::all(0);
 #endif
         }
+
+        /* keep up to two images per processing thread in flight, read by
+            one I/O thread for every four processing threads */
+        pipeline.capacity = 2 * numThreads;
+        pipeline.num_pending = 0;
+        pipeline.next_sequence = 0;
+        pipeline.next_merge = 0;
+        pipeline.merging = false;
+        pipeline.shutdown = false;
+        numReadThreads = (numThreads + 3) / 4;
+        for (unsigned int ithread = 0; ithread < numReadThreads; ithread++) {
+            mbphotomosaicReadThreads[ithread] = std::thread(read_images, verbose, &pipeline);
+        }
+        for (unsigned int ithread = 0; ithread < numThreads; ithread++) {
+            mbphotomosaicThreads[ithread]
+                = std::thread(process_images, verbose, &pipeline, &processPars[ithread], &control,
+                                &thread_status[ithread], &thread_error[ithread]);
+        }
     }
 
     /* loop over the list of input images
@@ -3704,7 +4010,7 @@ control.OutputBounds[0], control.OutputBounds[1], control.OutputBounds[2], contr
     int imageStatus = MB_IMAGESTATUS_NONE;
     double image_quality = 0.0;
     mb_path dpath;
-    unsigned int numThreadsSet = 0;
+    unsigned int numImagesQueued = 0;
     fprintf(stream,"\nAbout to read ImageListFile: %s\n\n", ImageListFile);
 
     while ((status = mb_imagelist_read(verbose, imagelist_ptr, &imageStatus,
@@ -3719,16 +4025,12 @@ control.OutputBounds[0], control.OutputBounds[1], control.OutputBounds[2], contr
             mb_path tmp;
 
             /* A parameter change has been encountered while parsing the imagelist
-                structure. If any threads have been started, these must be completed
-                using the old parameters before parsing any changes. So, wait for
-                all current threads to finish using join() before parsing the
-                parameter change */
-            if (numThreadsSet > 0) {
-                for (unsigned int ithread = 0; ithread < numThreadsSet; ithread++) {
-                  /* join the thread (wait until it completes) */
-                  mbphotomosaicThreads[ithread].join();
-                }
-                numThreadsSet = 0;
+                structure. Any images already queued must be completed using the
+                old parameters before parsing any changes. So, wait for the
+                pipeline to drain before parsing the parameter change */
+            if (numImagesQueued > 0) {
+                pipeline_wait(verbose, &pipeline);
+                numImagesQueued = 0;
             }
 
             fprintf(stream, "  ->Processing parameter: %s\n",imageLeftFile);
@@ -4494,6 +4796,7 @@ control.OutputBounds[0], control.OutputBounds[1], control.OutputBounds[2], contr
                                     control.SensorWidthMm, control.SensorHeightMm,
                                     control.fovx[1], control.fovy[1], control.focalLength[1],
                                     control.principalPoint[1], control.aspectRatio[1]);
+                        setup_camera_tables(verbose, &control, &error);
                         if (verbose > 0) {
                             fprintf(stream,"\nLeft Camera Characteristics:\n");
                             fprintf(stream,"  Image width (pixels):         %d\n", control.imageSize.width);
@@ -4528,78 +4831,49 @@ control.OutputBounds[0], control.OutputBounds[1], control.OutputBounds[2], contr
                     }
                 }
 
-                /* copy parameters to current processing parameter structure */
-                processPars[numThreadsSet].thread = numThreadsSet;
-                strcpy(processPars[numThreadsSet].imageFile, imageFile);
-                processPars[numThreadsSet].image_count = nimages - currentimages + iimage;
-                processPars[numThreadsSet].image_camera = image_camera;
-                processPars[numThreadsSet].image_quality = image_quality;
-                processPars[numThreadsSet].image_gain = image_gain;
-                processPars[numThreadsSet].image_exposure = image_exposure;
-                processPars[numThreadsSet].time_d = time_d;
-                processPars[numThreadsSet].camera_navlon = camera_navlon;
-                processPars[numThreadsSet].camera_navlat = camera_navlat;
-                processPars[numThreadsSet].camera_sensordepth = camera_sensordepth;
-                processPars[numThreadsSet].camera_heading = camera_heading;
-                processPars[numThreadsSet].camera_roll = camera_roll;
-                processPars[numThreadsSet].camera_pitch = camera_pitch;
-
-                if (control.sectionPixels > 0)
-                    mbphotomosaicThreads[numThreadsSet]
-                        = std::thread(process_image_sectioned, verbose, &processPars[numThreadsSet], &control,
-                                        &thread_status[numThreadsSet], &thread_error[numThreadsSet]);
-                else
-                    mbphotomosaicThreads[numThreadsSet]
-                        = std::thread(process_image, verbose, &processPars[numThreadsSet], &control,
-                                        &thread_status[numThreadsSet], &thread_error[numThreadsSet]);
-                numThreadsSet++;
-            }
-
-            /* If full set of threads has been started wait for all to finish
-               using join() before continuing */
-            if (numThreadsSet == numThreads) {
-                for (unsigned int ithread = 0; ithread < numThreadsSet; ithread++) {
-                  /* join the thread (wait until it completes) */
-                  mbphotomosaicThreads[ithread].join();
-                }
-                numThreadsSet = 0;
+                /* copy parameters to a processing parameter structure and queue
+                    the image - this blocks while the pipeline is full */
+                struct mbpm_process_struct job;
+                job.thread = 0;
+                strcpy(job.imageFile, imageFile);
+                job.image_count = nimages - currentimages + iimage;
+                job.image_camera = image_camera;
+                job.image_quality = image_quality;
+                job.image_gain = image_gain;
+                job.image_exposure = image_exposure;
+                job.time_d = time_d;
+                job.camera_navlon = camera_navlon;
+                job.camera_navlat = camera_navlat;
+                job.camera_sensordepth = camera_sensordepth;
+                job.camera_heading = camera_heading;
+                job.camera_roll = camera_roll;
+                job.camera_pitch = camera_pitch;
+                pipeline_submit(verbose, &pipeline, &job);
+                numImagesQueued++;
             }
         }
     }
 
-    /* Done reading images - if any threads have been started but not joined,
-        wait for all to finish using join() before dealing with the results */
-    if (numThreadsSet > 0) {
-        for (unsigned int ithread = 0; ithread < numThreadsSet; ithread++) {
-          /* join the thread (wait until it completes) */
-          mbphotomosaicThreads[ithread].join();
+    /* Done reading images - wait for all queued images to be processed and
+        merged, then stop the reading and processing threads */
+    if (outputimage_specified) {
+        pipeline_wait(verbose, &pipeline);
+        pipeline_shutdown(verbose, &pipeline);
+        for (unsigned int ithread = 0; ithread < numReadThreads; ithread++) {
+            mbphotomosaicReadThreads[ithread].join();
+        }
+        for (unsigned int ithread = 0; ithread < numThreads; ithread++) {
+            mbphotomosaicThreads[ithread].join();
         }
-        numThreadsSet = 0;
+        numImagesQueued = 0;
     }
 
     /* close imagelist file */
     status = mb_imagelist_close(verbose, &imagelist_ptr, &error);
 
-    /* if more than one thread was used, combine the images into the image from
-        the first thread */
-    if (numThreads > 1) {
-        fprintf(stream, "\n");
-        for (int ithread = 1; ithread < numThreads; ithread++) {
-            fprintf(stream, "Merging mosaic from thread %d of %d\n", ithread, numThreads);
-            for (int i = 0; i < control.OutputDim[0]; i++) {
-                for (int j = 0; j < control.OutputDim[1]; j++) {
-                    if (processPars[ithread].OutputPriority.at<float>(j,i) > processPars[0].OutputPriority.at<float>(j,i)) {
-                        processPars[0].OutputImage.at<Vec3b>(j,i)[0] = processPars[ithread].OutputImage.at<Vec3b>(j,i)[0];
-                        processPars[0].OutputImage.at<Vec3b>(j,i)[1] = processPars[ithread].OutputImage.at<Vec3b>(j,i)[1];
-                        processPars[0].OutputImage.at<Vec3b>(j,i)[2] = processPars[ithread].OutputImage.at<Vec3b>(j,i)[2];
-                        processPars[0].OutputPriority.at<float>(j,i) = processPars[ithread].OutputPriority.at<float>(j,i);
-#ifdef DEBUG
-                        processPars[0].OutputIntensityCorrection.at<float>(j,i) = processPars[ithread].OutputIntensityCorrection.at<float>(j,i);
-                        processPars[0].OutputStandoff.at<float>(j,i) = processPars[ithread].OutputStandoff.at<float>(j,i);
-#endif
-                    }
-                }
-            }
+    /* the output mosaic replaces the scratch images of the processing threads */
+    if (outputimage_specified) {
+        for (int ithread = 0; ithread < numThreads; ithread++) {
             processPars[ithread].OutputImage.release();
             processPars[ithread].OutputPriority.release();
 #ifdef DEBUG
@@ -4607,6 +4881,16 @@ control.OutputBounds[0], control.OutputBounds[1], control.OutputBounds[2], contr
             processPars[ithread].OutputStandoff.release();
 #endif
         }
+        processPars[0].OutputImage = pipeline.OutputImage;
+        processPars[0].OutputPriority = pipeline.OutputPriority;
+        pipeline.OutputImage.release();
+        pipeline.OutputPriority.release();
+#ifdef DEBUG
+        processPars[0].OutputIntensityCorrection = pipeline.OutputIntensityCorrection;
+        processPars[0].OutputStandoff = pipeline.OutputStandoff;
+        pipeline.OutputIntensityCorrection.release();
+        pipeline.OutputStandoff.release();
+#endif
     }
 
     /* Write out the ouput image */
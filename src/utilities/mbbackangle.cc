@@ -42,6 +42,7 @@
 #include <ctime>
 #include <getopt.h>
 #include <sys/stat.h>
+#include <thread>
 #include <unistd.h>
 
 #include "mb_aux.h"
@@ -82,6 +83,80 @@ struct mbba_grid_struct {
 	float *data;
 };
 
+/* parameters shared by all files, read only while files are processed */
+struct mbba_param_struct {
+	int verbose;
+	int lonflip;
+	double bounds[4];
+	int btime_i[7];
+	int etime_i[7];
+	double speedmin;
+	double timegap;
+	bool dump;
+	bool symmetry;
+	bool amplitude_on;
+	bool sidescan_on;
+	beampattern_t beammode;
+	double ssbeamwidth;
+	double ssdepression;
+	bool gridamp;
+	double gridampangle;
+	double gridampmin;
+	int gridampn_columns;
+	int gridampn_rows;
+	double gridampdx;
+	double gridampdy;
+	bool gridss;
+	double gridssangle;
+	double gridssmin;
+	int gridssn_columns;
+	int gridssn_rows;
+	double gridssdx;
+	double gridssdy;
+	int nangles;
+	double angle_max;
+	double dangle;
+	double angle_start;
+	int pings_avg;
+	bool corr_slope;
+	double ref_angle;
+	bool corr_topogrid;
+	const struct mbba_grid_struct *grid;
+	double altitude_default;
+	int amp_corr_slope;
+	int ss_corr_slope;
+	const char *user;
+	const char *host;
+	const char *date;
+};
+
+/* per file results - each thread accumulates the angle sums of its file
+    here, and the sums are merged into the total tables in file order */
+struct mbba_file_struct {
+	mb_path swathfile;
+	int format;
+	mb_path amptablefile;
+	mb_path sstablefile;
+	int amp_corr_type;
+	int ss_corr_type;
+	int nrec;
+	int namp;
+	int nss;
+	int ntable;
+	int ntotavg;
+	double time_d_totavg;
+	double altitude_totavg;
+	int *nmeantotamp;
+	double *meantotamp;
+	double *sigmatotamp;
+	int *nmeantotss;
+	double *meantotss;
+	double *sigmatotss;
+	float *gridamphist;
+	float *gridsshist;
+	int error; /* set if the file could not be processed - the main thread then stops */
+};
+
 constexpr char program_name[] = "mbbackangle";
 constexpr char help_message[] =
     "MBbackangle reads a swath sonar data file and generates a set\n"
@@ -94,7 +169,7 @@ constexpr char help_message[] =
 constexpr char usage_message[] =
     "mbbackangle -Ifile "
     "[-Akind -Bmode[/beamwidth/depression] -Fformat -Ggridmode/angle/min/max/n_columns/n_rows "
-    "-Nnangles/angle_max -Ppings -Q -Rrefangle -Ttopogridfile -Zaltitude -V -H]";
+    "-Nnangles/angle_max -Ppings -Q -Rrefangle -Ttopogridfile -Zaltitude --threads=nthreads -V -H]";
 
 /*--------------------------------------------------------------------*/
 int output_table(int verbose, FILE *tfp, int ntable, int nping, double time_d, int nangles, double angle_max, double dangle,
@@ -262,6 +337,692 @@ int output_model(int verbose, FILE *tfp, double beamwidth, double depression, do
 	return (status);
 }
 /*--------------------------------------------------------------------*/
+/* get the grazing angle of a beam or pixel from the topography grid,
+    returning false if the grid does not cover the location so that the
+    caller falls back to a flat seafloor */
+bool topogrid_angle(const struct mbba_grid_struct *grid, bool corr_slope, double navlon, double navlat, double mtodeglon,
+                    double mtodeglat, double headingx, double headingy, double sensordepth, double acrosstrack,
+                    double alongtrack, int *kgrid, double *bathy, double *angle) {
+	/* get position in grid */
+	double r[3];
+	r[0] = headingy * acrosstrack + headingx * alongtrack;
+	r[1] = -headingx * acrosstrack + headingy * alongtrack;
+	const int ix = (navlon + r[0] * mtodeglon - grid->xmin + 0.5 * grid->dx) / grid->dx;
+	const int jy = (navlat + r[1] * mtodeglat - grid->ymin + 0.5 * grid->dy) / grid->dy;
+	*kgrid = ix * grid->n_rows + jy;
+	const int kgrid00 = (ix - 1) * grid->n_rows + jy - 1;
+	const int kgrid01 = (ix - 1) * grid->n_rows + jy + 1;
+	const int kgrid10 = (ix + 1) * grid->n_rows + jy - 1;
+	const int kgrid11 = (ix + 1) * grid->n_rows + jy + 1;
+	if (!(ix > 0 && ix < grid->n_columns - 1 && jy > 0 && jy < grid->n_rows - 1 &&
+	      grid->data[*kgrid] > grid->nodatavalue && grid->data[kgrid00] > grid->nodatavalue &&
+	      grid->data[kgrid01] > grid->nodatavalue && grid->data[kgrid10] > grid->nodatavalue &&
+	      grid->data[kgrid11] > grid->nodatavalue)) {
+		if (!(ix >= 0 && ix < grid->n_columns && jy >= 0 && jy < grid->n_rows))
+			*kgrid = -1;
+		return false;
+	}
+
+	/* get look vector for data */
+	*bathy = -grid->data[*kgrid];
+	r[2] = grid->data[*kgrid] + sensordepth;
+	const double rr = -sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]);
+	r[0] /= rr;
+	r[1] /= rr;
+	r[2] /= rr;
+
+	/* get normal vector to grid surface */
+	double v[3];
+	if (corr_slope) {
+		double v1[3];
+		double v2[3];
+		v1[0] = 2.0 * grid->dx / mtodeglon;
+		v1[1] = 2.0 * grid->dy / mtodeglat;
+		v1[2] = grid->data[kgrid11] - grid->data[kgrid00];
+		v2[0] = -2.0 * grid->dx / mtodeglon;
+		v2[1] = 2.0 * grid->dy / mtodeglat;
+		v2[2] = grid->data[kgrid01] - grid->data[kgrid10];
+		v[0] = v1[1] * v2[2] - v2[1] * v1[2];
+		v[1] = v2[0] * v1[2] - v1[0] * v2[2];
+		v[2] = v1[0] * v2[1] - v2[0] * v1[1];
+		const double vv = sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+		v[0] /= vv;
+		v[1] /= vv;
+		v[2] /= vv;
+	}
+	else {
+		v[0] = 0.0;
+		v[1] = 0.0;
+		v[2] = 1.0;
+	}
+
+	/* angle between look vector and surface normal
+	    is the acos(r dot v) */
+	*angle = RTD * acos(r[0] * v[0] + r[1] * v[1] + r[2] * v[2]);
+	if (acrosstrack < 0.0)
+		*angle = -*angle;
+
+	return true;
+}
+/*--------------------------------------------------------------------*/
+/* read one swath file, writing its correction tables and accumulating
+    its contribution to the total tables and histogram grids in file */
+void process_file(const struct mbba_param_struct *par, struct mbba_file_struct *file) {
+	const int verbose = par->verbose;
+	const bool amplitude_on = par->amplitude_on;
+	const bool sidescan_on = par->sidescan_on;
+	const int nangles = par->nangles;
+	const double angle_max = par->angle_max;
+	const double dangle = par->dangle;
+	const double angle_start = par->angle_start;
+	const bool symmetry = par->symmetry;
+	const bool corr_slope = par->corr_slope;
+	const bool corr_topogrid = par->corr_topogrid;
+	const struct mbba_grid_struct *grid = par->grid;
+	const double altitude_default = par->altitude_default;
+	char *swathfile = file->swathfile;
+	const int format = file->format;
+	file->error = MB_ERROR_NO_ERROR;
+
+	if (verbose >= 2) {
+		fprintf(stderr, "\ndbg2  MBBACKANGLE function <%s> called\n", __func__);
+		fprintf(stderr, "dbg2  Input arguments:\n");
+		fprintf(stderr, "dbg2       verbose:         %d\n", verbose);
+		fprintf(stderr, "dbg2       swathfile:       %s\n", swathfile);
+		fprintf(stderr, "dbg2       format:          %d\n", format);
+	}
+
+	/* output information */
+	if (verbose > 0) {
+		fprintf(stderr, "\nprocessing swath file: %s %d\n", swathfile, format);
+	}
+
+	/* initialize reading the swath sonar file */
+	void *mbio_ptr = nullptr;
+	double btime_d;
+	double etime_d;
+	int beams_bath;
+	int beams_amp;
+	int pixels_ss;
+	int error = MB_ERROR_NO_ERROR;
+	if (mb_read_init(verbose, swathfile, format, 1, par->lonflip, (double *)par->bounds, (int *)par->btime_i,
+	                 (int *)par->etime_i, par->speedmin, par->timegap, &mbio_ptr, &btime_d, &etime_d, &beams_bath,
+	                 &beams_amp, &pixels_ss, &error) != MB_SUCCESS) {
+		char *message;
+		mb_error(verbose, error, &message);
+		fprintf(stderr, "\nMBIO Error returned from function <mb_read_init>:\n%s\n", message);
+		fprintf(stderr, "\nMultibeam File <%s> not initialized for reading\n", swathfile);
+		file->error = error;
+		return;
+	}
+
+	/* set correction modes according to format */
+	if (format == MBF_SB2100RW || format == MBF_SB2100B1 || format == MBF_SB2100B2 || format == MBF_EDGJSTAR ||
+	    format == MBF_EDGJSTR2 || format == MBF_RESON7KR || format == MBF_RESON7K3)
+		file->ss_corr_type = MBP_SSCORR_DIVISION;
+	else if (format == MBF_MBLDEOIH)
+		file->ss_corr_type = MBP_SSCORR_UNKNOWN;
+	else
+		file->ss_corr_type = MBP_SSCORR_SUBTRACTION;
+	if (format == MBF_3DWISSLR || format == MBF_3DWISSLP || format == MBF_RESON7K3)
+		file->amp_corr_type = MBP_AMPCORR_DIVISION;
+	else
+		file->amp_corr_type = MBP_AMPCORR_SUBTRACTION;
+
+	/* allocate memory for data arrays */
+	char *beamflag = nullptr;
+	double *bath = nullptr;
+	double *bathacrosstrack = nullptr;
+	double *bathalongtrack = nullptr;
+	double *amp = nullptr;
+	double *ss = nullptr;
+	double *ssacrosstrack = nullptr;
+	double *ssalongtrack = nullptr;
+	const int nsmooth = 5;
+	int ndepths;
+	double *depths = nullptr;
+	double *depthsmooth = nullptr;
+	double *depthacrosstrack = nullptr;
+	int nslopes;
+	double *slopes = nullptr;
+	double *slopeacrosstrack = nullptr;
+	int status = MB_SUCCESS;
+	if (error == MB_ERROR_NO_ERROR)
+		status &= mb_mallocd(verbose, __FILE__, __LINE__, beams_bath * sizeof(char), (void **)&beamflag, &error);
+	if (error == MB_ERROR_NO_ERROR)
+		status &= mb_mallocd(verbose, __FILE__, __LINE__, beams_bath * sizeof(double), (void **)&bath, &error);
+	if (error == MB_ERROR_NO_ERROR)
+		status &= mb_mallocd(verbose, __FILE__, __LINE__, beams_amp * sizeof(double), (void **)&amp, &error);
+	if (error == MB_ERROR_NO_ERROR)
+		status &= mb_mallocd(verbose, __FILE__, __LINE__, beams_bath * sizeof(double), (void **)&bathacrosstrack, &error);
+	if (error == MB_ERROR_NO_ERROR)
+		status &= mb_mallocd(verbose, __FILE__, __LINE__, beams_bath * sizeof(double), (void **)&bathalongtrack, &error);
+	if (error == MB_ERROR_NO_ERROR)
+		status &= mb_mallocd(verbose, __FILE__, __LINE__, pixels_ss * sizeof(double), (void **)&ss, &error);
+	if (error == MB_ERROR_NO_ERROR)
+		status &= mb_mallocd(verbose, __FILE__, __LINE__, pixels_ss * sizeof(double), (void **)&ssacrosstrack, &error);
+	if (error == MB_ERROR_NO_ERROR)
+		status &= mb_mallocd(verbose, __FILE__, __LINE__, pixels_ss * sizeof(double), (void **)&ssalongtrack, &error);
+	if (error == MB_ERROR_NO_ERROR)
+		status &= mb_mallocd(verbose, __FILE__, __LINE__, beams_bath * sizeof(double), (void **)&depths, &error);
+	if (error == MB_ERROR_NO_ERROR)
+		status &= mb_mallocd(verbose, __FILE__, __LINE__, beams_bath * sizeof(double), (void **)&depthsmooth, &error);
+	if (error == MB_ERROR_NO_ERROR)
+		status &= mb_mallocd(verbose, __FILE__, __LINE__, beams_bath * sizeof(double), (void **)&depthacrosstrack, &error);
+	if (error == MB_ERROR_NO_ERROR)
+		status &= mb_mallocd(verbose, __FILE__, __LINE__, (beams_bath + 1) * sizeof(double), (void **)&slopes, &error);
+	if (error == MB_ERROR_NO_ERROR)
+		status &=
+		    mb_mallocd(verbose, __FILE__, __LINE__, (beams_bath + 1) * sizeof(double), (void **)&slopeacrosstrack, &error);
+	if (error == MB_ERROR_NO_ERROR)
+		status &= mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_BATHYMETRY, sizeof(char), (void **)&beamflag, &error);
+	if (error == MB_ERROR_NO_ERROR)
+		status &= mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_BATHYMETRY, sizeof(double), (void **)&bath, &error);
+	if (error == MB_ERROR_NO_ERROR)
+		status &= mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_AMPLITUDE, sizeof(double), (void **)&amp, &error);
+	if (error == MB_ERROR_NO_ERROR)
+		status &=
+		    mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_BATHYMETRY, sizeof(double), (void **)&bathacrosstrack, &error);
+	if (error == MB_ERROR_NO_ERROR)
+		status &=
+		    mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_BATHYMETRY, sizeof(double), (void **)&bathalongtrack, &error);
+	if (error == MB_ERROR_NO_ERROR)
+		status &= mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_SIDESCAN, sizeof(double), (void **)&ss, &error);
+	if (error == MB_ERROR_NO_ERROR)
+		status &= mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_SIDESCAN, sizeof(double), (void **)&ssacrosstrack, &error);
+	if (error == MB_ERROR_NO_ERROR)
+		status &= mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_SIDESCAN, sizeof(double), (void **)&ssalongtrack, &error);
+	if (error == MB_ERROR_NO_ERROR)
+		status &= mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_BATHYMETRY, sizeof(double), (void **)&depths, &error);
+	if (error == MB_ERROR_NO_ERROR)
+		status &= mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_BATHYMETRY, sizeof(double), (void **)&depthsmooth, &error);
+	if (error == MB_ERROR_NO_ERROR)
+		status &=
+		    mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_BATHYMETRY, sizeof(double), (void **)&depthacrosstrack, &error);
+	if (error == MB_ERROR_NO_ERROR)
+		status &= mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_BATHYMETRY, sizeof(double), (void **)&slopes, &error);
+	if (error == MB_ERROR_NO_ERROR)
+		status &= mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_BATHYMETRY, 2 * sizeof(double), (void **)&slopeacrosstrack,
+		                           &error);
+	if (error == MB_ERROR_NO_ERROR)
+		status &= mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_BATHYMETRY, 2 * sizeof(double), (void **)&bathalongtrack,
+		                           &error);
+
+	/* allocate memory for the tables of this file */
+	int *nmeanamp = nullptr;
+	double *meanamp = nullptr;
+	double *sigmaamp = nullptr;
+	int *nmeanss = nullptr;
+	double *meanss = nullptr;
+	double *sigmass = nullptr;
+	if (amplitude_on) {
+		if (error == MB_ERROR_NO_ERROR)
+			status &= mb_mallocd(verbose, __FILE__, __LINE__, nangles * sizeof(int), (void **)&nmeanamp, &error);
+		if (error == MB_ERROR_NO_ERROR)
+			status &= mb_mallocd(verbose, __FILE__, __LINE__, nangles * sizeof(double), (void **)&meanamp, &error);
+		if (error == MB_ERROR_NO_ERROR)
+			status &= mb_mallocd(verbose, __FILE__, __LINE__, nangles * sizeof(double), (void **)&sigmaamp, &error);
+	}
+	if (sidescan_on) {
+		if (error == MB_ERROR_NO_ERROR)
+			status &= mb_mallocd(verbose, __FILE__, __LINE__, nangles * sizeof(int), (void **)&nmeanss, &error);
+		if (error == MB_ERROR_NO_ERROR)
+			status &= mb_mallocd(verbose, __FILE__, __LINE__, nangles * sizeof(double), (void **)&meanss, &error);
+		if (error == MB_ERROR_NO_ERROR)
+			status &= mb_mallocd(verbose, __FILE__, __LINE__, nangles * sizeof(double), (void **)&sigmass, &error);
+	}
+
+	/* if error initializing memory then quit */
+	if (error != MB_ERROR_NO_ERROR) {
+		char *message;
+		mb_error(verbose, error, &message);
+		fprintf(stderr, "\nMBIO Error allocating data arrays:\n%s\n", message);
+		file->error = error;
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&nmeanamp, &error);
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&meanamp, &error);
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&sigmaamp, &error);
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&nmeanss, &error);
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&meanss, &error);
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&sigmass, &error);
+		mb_close(verbose, &mbio_ptr, &error);
+		return;
+	}
+
+	/* Deal with esf file if avialable */
+	struct mb_esf_struct esf;
+	memset(&esf, 0, sizeof(struct mb_esf_struct));
+	if (status == MB_SUCCESS) {
+		mb_path esffile;
+		mb_esf_load(verbose, program_name, swathfile, true, false, esffile, &esf, &error);
+		error = MB_ERROR_NO_ERROR;
+	}
+
+	/* initialize angle and grid arrays */
+	if (amplitude_on) {
+		for (int i = 0; i < nangles; i++) {
+			nmeanamp[i] = 0;
+			meanamp[i] = 0.0;
+			sigmaamp[i] = 0.0;
+			file->nmeantotamp[i] = 0;
+			file->meantotamp[i] = 0.0;
+			file->sigmatotamp[i] = 0.0;
+		}
+	}
+	if (sidescan_on) {
+		for (int i = 0; i < nangles; i++) {
+			nmeanss[i] = 0;
+			meanss[i] = 0.0;
+			sigmass[i] = 0.0;
+			file->nmeantotss[i] = 0;
+			file->meantotss[i] = 0.0;
+			file->sigmatotss[i] = 0.0;
+		}
+	}
+	if (par->gridamp) {
+		for (int i = 0; i < par->gridampn_columns * par->gridampn_rows; i++) {
+			file->gridamphist[i] = 0.0;
+		}
+	}
+	if (par->gridss) {
+		for (int i = 0; i < par->gridssn_columns * par->gridssn_rows; i++) {
+			file->gridsshist[i] = 0.0;
+		}
+	}
+
+	/* open output files */
+	FILE *atfp = nullptr;
+	FILE *stfp = nullptr;
+	if (par->dump) {
+		atfp = stdout;
+		stfp = stdout;
+	}
+	else {
+		if (amplitude_on) {
+			strcpy(file->amptablefile, swathfile);
+			strcat(file->amptablefile, ".aga");
+			if ((atfp = fopen(file->amptablefile, "w")) == nullptr) {
+				fprintf(stderr, "\nUnable to open output table file %s\n", file->amptablefile);
+				file->error = MB_ERROR_OPEN_FAIL;
+			}
+		}
+		if (sidescan_on && file->error == MB_ERROR_NO_ERROR) {
+			strcpy(file->sstablefile, swathfile);
+			strcat(file->sstablefile, ".sga");
+			if ((stfp = fopen(file->sstablefile, "w")) == nullptr) {
+				fprintf(stderr, "\nUnable to open output table file %s\n", file->sstablefile);
+				file->error = MB_ERROR_OPEN_FAIL;
+			}
+		}
+	}
+	if (file->error != MB_ERROR_NO_ERROR) {
+		if (atfp != nullptr)
+			fclose(atfp);
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&nmeanamp, &error);
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&meanamp, &error);
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&sigmaamp, &error);
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&nmeanss, &error);
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&meanss, &error);
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&sigmass, &error);
+		if (esf.edit != nullptr || esf.esffp != nullptr)
+			mb_esf_close(verbose, &esf, &error);
+		mb_close(verbose, &mbio_ptr, &error);
+		return;
+	}
+
+	/* set comments in table files */
+	if (amplitude_on) {
+		fprintf(atfp, "## Amplitude correction table files generated by program %s\n", program_name);
+		fprintf(atfp, "## MB-system Version %s\n", MB_VERSION);
+		fprintf(atfp, "## Table file format: 1.0.0\n");
+		fprintf(atfp, "## Run by user <%s> on cpu <%s> at <%s>\n", par->user, par->host, par->date);
+		fprintf(atfp, "## Input swath file:      %s\n", swathfile);
+		fprintf(atfp, "## Input swath format:    %d\n", format);
+		fprintf(atfp, "## Output table file:     %s\n", file->amptablefile);
+		fprintf(atfp, "## Pings to average:      %d\n", par->pings_avg);
+		fprintf(atfp, "## Number of angle bins:  %d\n", nangles);
+		fprintf(atfp, "## Maximum angle:         %f\n", angle_max);
+		fprintf(atfp, "## Default altitude:      %f\n", altitude_default);
+		fprintf(atfp, "## Slope correction:      %d\n", par->amp_corr_slope);
+		fprintf(atfp, "## Data type:             beam amplitude\n");
+	}
+	if (sidescan_on) {
+		fprintf(stfp, "## Sidescan correction table files generated by program %s\n", program_name);
+		fprintf(stfp, "## MB-system Version %s\n", MB_VERSION);
+		fprintf(stfp, "## Table file format: 1.0.0\n");
+		fprintf(stfp, "## Run by user <%s> on cpu <%s> at <%s>\n", par->user, par->host, par->date);
+		fprintf(stfp, "## Input swath file:      %s\n", swathfile);
+		fprintf(stfp, "## Input swath format:    %d\n", format);
+		fprintf(stfp, "## Output table file:     %s\n", file->sstablefile);
+		fprintf(stfp, "## Pings to average:      %d\n", par->pings_avg);
+		fprintf(stfp, "## Number of angle bins:  %d\n", nangles);
+		fprintf(stfp, "## Maximum angle:         %f\n", angle_max);
+		fprintf(stfp, "## Default altitude:      %f\n", altitude_default);
+		fprintf(stfp, "## Slope Correction:      %d\n", par->ss_corr_slope);
+		fprintf(stfp, "## Data type:             sidescan\n");
+	}
+
+	/* initialize counting variables */
+	int nrec = 0;
+	int namp = 0;
+	int nss = 0;
+	int navg = 0;
+	int ntable = 0;
+	double time_d_avg = 0.0;
+	double altitude_avg = 0.0;
+	file->ntotavg = 0;
+	file->time_d_totavg = 0.0;
+	file->altitude_totavg = 0.0;
+
+	/* read and process data */
+	while (error <= MB_ERROR_NO_ERROR) {
+
+		/* read a ping of data */
+		int kind;
+		int pings;
+		int time_i[7];
+		double time_d;
+		double navlon;
+		double navlat;
+		double speed;
+		double heading;
+		double distance;
+		double altitude;
+		double sensordepth;
+		char comment[MB_COMMENT_MAXLINE];
+		status = mb_get(verbose, mbio_ptr, &kind, &pings, time_i, &time_d, &navlon, &navlat, &speed, &heading, &distance,
+		                &altitude, &sensordepth, &beams_bath, &beams_amp, &pixels_ss, beamflag, bath, amp, bathacrosstrack,
+		                bathalongtrack, ss, ssacrosstrack, ssalongtrack, comment, &error);
+
+		/* Apply ESF Edits if available */
+		if (esf.nedit > 0 && error == MB_ERROR_NO_ERROR && kind == MB_DATA_DATA) {
+			status = mb_esf_apply(verbose, &esf, time_d, 0, beams_bath, beamflag, &error);
+		}
+
+		if ((navg > 0 && (error == MB_ERROR_TIME_GAP || error == MB_ERROR_EOF)) || (navg >= par->pings_avg) ||
+		    (navg == 0 && error == MB_ERROR_EOF)) {
+			/* write out tables */
+			time_d_avg /= navg;
+			altitude_avg /= navg;
+			if (par->beammode == MBBACKANGLE_BEAMPATTERN_EMPIRICAL) {
+				if (amplitude_on) {
+					output_table(verbose, atfp, ntable, navg, time_d_avg, nangles, angle_max, dangle, symmetry, nmeanamp,
+					             meanamp, sigmaamp, &error);
+				}
+				if (sidescan_on) {
+					output_table(verbose, stfp, ntable, navg, time_d_avg, nangles, angle_max, dangle, symmetry, nmeanss,
+					             meanss, sigmass, &error);
+				}
+			}
+			else if (par->beammode == MBBACKANGLE_BEAMPATTERN_SIDESCAN) {
+				if (amplitude_on) {
+					output_model(verbose, atfp, par->ssbeamwidth, par->ssdepression, par->ref_angle, ntable, navg, time_d_avg,
+					             altitude_avg, nangles, angle_max, dangle, symmetry, nmeanamp, meanamp, sigmaamp, &error);
+				}
+				if (sidescan_on) {
+					output_model(verbose, stfp, par->ssbeamwidth, par->ssdepression, par->ref_angle, ntable, navg, time_d_avg,
+					             altitude_avg, nangles, angle_max, dangle, symmetry, nmeanss, meanss, sigmass, &error);
+				}
+			}
+			ntable++;
+
+			/* reinitialize arrays */
+			navg = 0;
+			time_d_avg = 0.0;
+			altitude_avg = 0.0;
+			if (amplitude_on) {
+				for (int i = 0; i < nangles; i++) {
+					nmeanamp[i] = 0;
+					meanamp[i] = 0.0;
+					sigmaamp[i] = 0.0;
+				}
+			}
+			if (sidescan_on) {
+				for (int i = 0; i < nangles; i++) {
+					nmeanss[i] = 0;
+					meanss[i] = 0.0;
+					sigmass[i] = 0.0;
+				}
+			}
+		}
+
+		/* process the pings */
+		if (error == MB_ERROR_NO_ERROR || error == MB_ERROR_TIME_GAP) {
+			/* if needed, attempt to get sidescan correction type */
+			if (file->ss_corr_type == MBP_SSCORR_UNKNOWN) {
+				int ss_type;
+				status = mb_sidescantype(verbose, mbio_ptr, nullptr, &ss_type, &error);
+				if (status == MB_SUCCESS) {
+					if (ss_type == MB_SIDESCAN_LINEAR) {
+						file->ss_corr_type = MBP_SSCORR_DIVISION;
+					}
+					else {
+						file->ss_corr_type = MBP_SSCORR_SUBTRACTION;
+					}
+				}
+				else {
+					status = MB_SUCCESS;
+					error = MB_ERROR_NO_ERROR;
+					file->ss_corr_type = MBP_SSCORR_SUBTRACTION;
+				}
+			}
+
+			/* increment record counter */
+			nrec++;
+			navg++;
+			file->ntotavg++;
+
+			/* increment time */
+			time_d_avg += time_d;
+			altitude_avg += altitude;
+			file->time_d_totavg += time_d;
+			file->altitude_totavg += altitude;
+
+			/* get the seafloor slopes */
+			if (beams_bath > 0)
+				mb_pr_set_bathyslope(verbose, nsmooth, beams_bath, beamflag, bath, bathacrosstrack, &ndepths, depths,
+				                     depthacrosstrack, &nslopes, slopes, slopeacrosstrack, depthsmooth, &error);
+
+			/* get distance scaling and heading vector */
+			double mtodeglon;
+			double mtodeglat;
+			mb_coor_scale(verbose, navlat, &mtodeglon, &mtodeglat);
+			const double headingx = sin(heading * DTR);
+			const double headingy = cos(heading * DTR);
+
+			/* do the amplitude */
+			double altitude_use = 0.0;
+			double angle = 0.0;
+			double bathy = 0.0;
+			double slope = 0.0;
+			if (amplitude_on)
+				for (int i = 0; i < beams_amp; i++) {
+					if (mb_beam_ok(beamflag[i])) {
+						namp++;
+						if (corr_topogrid) {
+							int kgrid;
+							if (!topogrid_angle(grid, corr_slope, navlon, navlat, mtodeglon, mtodeglat, headingx, headingy,
+							                    sensordepth, bathacrosstrack[i], bathalongtrack[i], &kgrid, &bathy, &angle)) {
+								if (kgrid >= 0 && grid->data[kgrid] > grid->nodatavalue)
+									bathy = -grid->data[kgrid];
+								else if (altitude > 0.0)
+									bathy = altitude + sensordepth;
+								else
+									bathy = altitude_default + sensordepth;
+								angle = RTD * atan(bathacrosstrack[i] / (bathy - sensordepth));
+								slope = 0.0;
+							}
+						}
+						else if (beams_bath == beams_amp) {
+							status = mb_pr_get_bathyslope(verbose, ndepths, depths, depthacrosstrack, nslopes, slopes,
+							                              slopeacrosstrack, bathacrosstrack[i], &bathy, &slope, &error);
+							if (status != MB_SUCCESS) {
+								if (altitude > 0.0)
+									bathy = altitude + sensordepth;
+								else
+									bathy = altitude_default + sensordepth;
+								slope = 0.0;
+								status = MB_SUCCESS;
+								error = MB_ERROR_NO_ERROR;
+							}
+							altitude_use = bathy - sensordepth;
+							angle = RTD * atan(bathacrosstrack[i] / altitude_use);
+							if (corr_slope)
+								angle += RTD * atan(slope);
+						}
+						else {
+							if (altitude > 0.0)
+								bathy = altitude + sensordepth;
+							else
+								bathy = altitude_default + sensordepth;
+							slope = 0.0;
+							altitude_use = bathy - sensordepth;
+							angle = RTD * atan(bathacrosstrack[i] / altitude_use);
+						}
+						if (bathy > 0.0) {
+							/* load amplitude into table */
+							const int j = (angle - angle_start) / dangle;
+							if (j >= 0 && j < nangles) {
+								meanamp[j] += amp[i];
+								sigmaamp[j] += amp[i] * amp[i];
+								nmeanamp[j]++;
+								file->meantotamp[j] += amp[i];
+								file->sigmatotamp[j] += amp[i] * amp[i];
+								file->nmeantotamp[j]++;
+							}
+
+							/* load amplitude into grid */
+							if (par->gridamp) {
+								const int ix = (angle + par->gridampangle) / par->gridampdx;
+								const int jy = (amp[i] - par->gridampmin) / par->gridampdy;
+								if (ix >= 0 && ix < par->gridampn_columns && jy >= 0 && jy < par->gridampn_rows) {
+									const int k = ix * par->gridampn_rows + jy;
+									file->gridamphist[k] += 1.0;
+								}
+							}
+						}
+
+						if (verbose >= 5) {
+							fprintf(stderr, "dbg5       %d %d: slope:%f altitude:%f xtrack:%f ang:%f\n", nrec, i, slope,
+							        altitude_use, bathacrosstrack[i], angle);
+						}
+					}
+				}
+
+			/* do the sidescan */
+			if (sidescan_on)
+				for (int i = 0; i < pixels_ss; i++) {
+					if (ss[i] > MB_SIDESCAN_NULL) {
+						nss++;
+						if (corr_topogrid) {
+							int kgrid;
+							if (!topogrid_angle(grid, corr_slope, navlon, navlat, mtodeglon, mtodeglat, headingx, headingy,
+							                    sensordepth, ssacrosstrack[i], ssalongtrack[i], &kgrid, &bathy, &angle)) {
+								if (kgrid >= 0 && grid->data[kgrid] > grid->nodatavalue)
+									bathy = -grid->data[kgrid];
+								else if (altitude > 0.0)
+									bathy = altitude + sensordepth;
+								else
+									bathy = altitude_default + sensordepth;
+								angle = RTD * atan(ssacrosstrack[i] / (bathy - sensordepth));
+								slope = 0.0;
+							}
+						}
+						else if (beams_bath > 0) {
+							status = mb_pr_get_bathyslope(verbose, ndepths, depths, depthacrosstrack, nslopes, slopes,
+							                              slopeacrosstrack, ssacrosstrack[i], &bathy, &slope, &error);
+							if (status != MB_SUCCESS || bathy <= 0.0) {
+								if (altitude > 0.0)
+									bathy = altitude + sensordepth;
+								else
+									bathy = altitude_default;
+								slope = 0.0;
+								status = MB_SUCCESS;
+								error = MB_ERROR_NO_ERROR;
+							}
+							altitude_use = bathy - sensordepth;
+							angle = RTD * atan(ssacrosstrack[i] / altitude_use);
+							if (corr_slope)
+								angle += RTD * atan(slope);
+						}
+						else {
+							if (altitude > 0.0)
+								bathy = altitude + sensordepth;
+							else
+								bathy = altitude_default;
+							slope = 0.0;
+							altitude_use = bathy - sensordepth;
+							angle = RTD * atan(ssacrosstrack[i] / altitude_use);
+						}
+						if (bathy > 0.0) {
+							/* load amplitude into table */
+							const int j = (angle - angle_start) / dangle;
+							if (j >= 0 && j < nangles) {
+								meanss[j] += ss[i];
+								sigmass[j] += ss[i] * ss[i];
+								nmeanss[j]++;
+								file->meantotss[j] += ss[i];
+								file->sigmatotss[j] += ss[i] * ss[i];
+								file->nmeantotss[j]++;
+							}
+
+							/* load amplitude into grid */
+							if (par->gridss) {
+								const int ix = (angle + par->gridssangle) / par->gridssdx;
+								const int jy = (ss[i] - par->gridssmin) / par->gridssdy;
+								if (ix >= 0 && ix < par->gridssn_columns && jy >= 0 && jy < par->gridssn_rows) {
+									const int k = ix * par->gridssn_rows + jy;
+									file->gridsshist[k] += 1.0;
+								}
+							}
+						}
+
+						if (verbose >= 5) {
+							fprintf(stderr, "dbg5kkk       %d %d: slope:%f altitude:%f xtrack:%f ang:%f\n", nrec, i,
+							        slope, altitude_use, ssacrosstrack[i], angle);
+						}
+					}
+				}
+		}
+	}
+
+	/* close the swath sonar file */
+	error = MB_ERROR_NO_ERROR;
+	mb_close(verbose, &mbio_ptr, &error);
+
+	/* Close ESF file if avialable and open */
+	if (esf.edit != nullptr || esf.esffp != nullptr)
+		mb_esf_close(verbose, &esf, &error);
+
+	if (!par->dump && amplitude_on)
+		fclose(atfp);
+	if (!par->dump && sidescan_on)
+		fclose(stfp);
+
+	/* deallocate the tables of this file */
+	if (amplitude_on) {
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&nmeanamp, &error);
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&meanamp, &error);
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&sigmaamp, &error);
+	}
+	if (sidescan_on) {
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&nmeanss, &error);
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&meanss, &error);
+		mb_freed(verbose, __FILE__, __LINE__, (void **)&sigmass, &error);
+	}
+
+	file->nrec = nrec;
+	file->namp = namp;
+	file->nss = nss;
+	file->ntable = ntable;
+
+	if (verbose >= 2) {
+		fprintf(stderr, "\ndbg2  MBBACKANGLE function <%s> completed\n", __func__);
+		fprintf(stderr, "dbg2  Return values:\n");
+		fprintf(stderr, "dbg2       nrec:            %d\n", nrec);
+		fprintf(stderr, "dbg2       ntable:          %d\n", ntable);
+	}
+}
+/*--------------------------------------------------------------------*/
 
 int main(int argc, char **argv) {
 	int verbose = 0;
@@ -318,6 +1079,7 @@ int main(int argc, char **argv) {
 	memset(&grid, 0, sizeof(struct mbba_grid_struct));
 	bool corr_topogrid = false;
 	double altitude_default = 0.0;
+	int n_threads = 1;
 
 	int error = MB_ERROR_NO_ERROR;
   char user[256], host[256], date[32];
@@ -328,9 +1090,17 @@ int main(int argc, char **argv) {
 		int c;
 		bool help = false;
 
-		while ((c = getopt(argc, argv, "A:a:B:b:CcDdF:f:G:g:HhI:i:N:n:P:p:QqR:r:T:t:VvZ:z:")) != -1)
+		const struct option options[] = {{"threads", required_argument, nullptr, 0}, {nullptr, 0, nullptr, 0}};
+		int option_index;
+		while ((c = getopt_long(argc, argv, "A:a:B:b:CcDdF:f:G:g:HhI:i:N:n:P:p:QqR:r:T:t:VvZ:z:", options, &option_index)) != -1)
 		{
 			switch (c) {
+			/* long options */
+			case 0:
+				if (strcmp("threads", options[option_index].name) == 0)
+					sscanf(optarg, "%d", &n_threads);
+				break;
+
 			case 'A':
 			case 'a':
 			{
@@ -465,9 +1235,6 @@ int main(int argc, char **argv) {
 		}
 	} // end command line arg parsing
 
-	double btime_d;
-	double etime_d;
-
 	void *datalist;
 	double file_weight;
 	char swathfile[MB_PATH_MAXLINE];
@@ -476,55 +1243,11 @@ int main(int argc, char **argv) {
 	char sstablefile[MB_PATH_MAXLINE];
 	FILE *atfp = nullptr;
 	FILE *stfp = nullptr;
-	int beams_bath;
-	int beams_amp;
-	int pixels_ss;
-
-	/* ESF File read */
-	struct mb_esf_struct esf;
-
-	/* MBIO read values */
-	void *mbio_ptr = nullptr;
-	int kind;
-	int time_i[7];
-	double time_d;
-	double navlon;
-	double navlat;
-	double speed;
-	double heading;
-	double distance;
-	double altitude;
-	double sensordepth;
-	char *beamflag = nullptr;
-	double *bath = nullptr;
-	double *bathacrosstrack = nullptr;
-	double *bathalongtrack = nullptr;
-	double *amp = nullptr;
-	double *ss = nullptr;
-	double *ssacrosstrack = nullptr;
-	double *ssalongtrack = nullptr;
-	char comment[MB_COMMENT_MAXLINE];
-
-	/* slope calculation variables */
-	int nsmooth = 5;
-	int ndepths;
-	double *depths = nullptr;
-	double *depthsmooth = nullptr;
-	double *depthacrosstrack = nullptr;
-	int nslopes;
-	double *slopes = nullptr;
-	double *slopeacrosstrack = nullptr;
 
 	/* angle function variables */
 	double dangle;
 	double angle_start;
 	int ntotavg = 0;
-	int *nmeanamp = nullptr;
-	double *meanamp = nullptr;
-	double *sigmaamp = nullptr;
-	int *nmeanss = nullptr;
-	double *meanss = nullptr;
-	double *sigmass = nullptr;
 	int *nmeantotamp = nullptr;
 	double *meantotamp = nullptr;
 	double *sigmatotamp = nullptr;
@@ -533,15 +1256,10 @@ int main(int argc, char **argv) {
 	double *sigmatotss = nullptr;
 	double time_d_totavg;
 	double altitude_totavg;
-	int amp_corr_type;
 	int amp_corr_slope = MBP_AMPCORR_IGNORESLOPE;
 	int ss_corr_slope = MBP_SSCORR_IGNORESLOPE;
-	int ss_type;
-	int ss_corr_type;
 
 	/* amp vs angle grid variables */
-	float *gridamphist = nullptr;
-	float *gridsshist = nullptr;
 	mb_path gridfile;
 	const char *xlabel = "Grazing Angle (degrees)";
 	const char *ylabel = "Amplitude";
@@ -550,12 +1268,6 @@ int main(int argc, char **argv) {
 	mb_command plot_cmd;
 	const char *projection = "GenericLinear";
 
-	double mtodeglon, mtodeglat;
-	double headingx, headingy;
-	double r[3], rr;
-	double v1[3], v2[3], v[3], vv;
-	double slope;
-	double bathy;
 	double norm;
 	int nrectot = 0;
 	int namptot = 0;
@@ -563,8 +1275,7 @@ int main(int argc, char **argv) {
 	int ntabletot = 0;
 	int plot_status;
 
-	int ix, jy, kgrid;
-	int kgrid00, kgrid10, kgrid01, kgrid11;
+	int ix, jy;
 
 	/* set mode if necessary */
 	if (!amplitude_on && !sidescan_on) {
@@ -633,6 +1344,7 @@ int main(int argc, char **argv) {
 		fprintf(stderr, "dbg2       pings_avg:    %d\n", pings_avg);
 		fprintf(stderr, "dbg2       angle_max:    %f\n", angle_max);
 		fprintf(stderr, "dbg2       altitude:     %f\n", altitude_default);
+		fprintf(stderr, "dbg2       n_threads:    %d\n", n_threads);
 		fprintf(stderr, "dbg2       gridamp:      %d\n", gridamp);
 		fprintf(stderr, "dbg2       gridampangle: %f\n", gridampangle);
 		fprintf(stderr, "dbg2       gridampmin:   %f\n", gridampmin);
@@ -653,26 +1365,13 @@ int main(int argc, char **argv) {
 
 	/* allocate memory for angle arrays */
 	if (amplitude_on) {
-		// if (error == MB_ERROR_NO_ERROR)
-		/* status = */ mb_mallocd(verbose, __FILE__, __LINE__, nangles * sizeof(int), (void **)&nmeanamp, &error);
-		if (error == MB_ERROR_NO_ERROR)
-			/* status = */ mb_mallocd(verbose, __FILE__, __LINE__, nangles * sizeof(double), (void **)&meanamp, &error);
-		if (error == MB_ERROR_NO_ERROR)
-			/* status = */ mb_mallocd(verbose, __FILE__, __LINE__, nangles * sizeof(double), (void **)&sigmaamp, &error);
-		if (error == MB_ERROR_NO_ERROR)
-			/* status = */ mb_mallocd(verbose, __FILE__, __LINE__, nangles * sizeof(int), (void **)&nmeantotamp, &error);
+		/* status = */ mb_mallocd(verbose, __FILE__, __LINE__, nangles * sizeof(int), (void **)&nmeantotamp, &error);
 		if (error == MB_ERROR_NO_ERROR)
 			/* status = */ mb_mallocd(verbose, __FILE__, __LINE__, nangles * sizeof(double), (void **)&meantotamp, &error);
 		if (error == MB_ERROR_NO_ERROR)
 			/* status = */ mb_mallocd(verbose, __FILE__, __LINE__, nangles * sizeof(double), (void **)&sigmatotamp, &error);
 	}
 	if (sidescan_on) {
-		if (error == MB_ERROR_NO_ERROR)
-			/* status = */ mb_mallocd(verbose, __FILE__, __LINE__, nangles * sizeof(int), (void **)&nmeanss, &error);
-		if (error == MB_ERROR_NO_ERROR)
-			/* status = */ mb_mallocd(verbose, __FILE__, __LINE__, nangles * sizeof(double), (void **)&meanss, &error);
-		if (error == MB_ERROR_NO_ERROR)
-			/* status = */ mb_mallocd(verbose, __FILE__, __LINE__, nangles * sizeof(double), (void **)&sigmass, &error);
 		if (error == MB_ERROR_NO_ERROR)
 			/* status = */ mb_mallocd(verbose, __FILE__, __LINE__, nangles * sizeof(int), (void **)&nmeantotss, &error);
 		if (error == MB_ERROR_NO_ERROR)
@@ -727,18 +1426,12 @@ int main(int argc, char **argv) {
 	/* initialize histogram */
 	if (amplitude_on)
 		for (int i = 0; i < nangles; i++) {
-			nmeanamp[i] = 0;
-			meanamp[i] = 0.0;
-			sigmaamp[i] = 0.0;
 			nmeantotamp[i] = 0;
 			meantotamp[i] = 0.0;
 			sigmatotamp[i] = 0.0;
 		}
 	if (sidescan_on)
 		for (int i = 0; i < nangles; i++) {
-			nmeanss[i] = 0;
-			meanss[i] = 0.0;
-			sigmass[i] = 0.0;
 			nmeantotss[i] = 0;
 			meantotss[i] = 0.0;
 			sigmatotss[i] = 0.0;
@@ -795,34 +1488,101 @@ int main(int argc, char **argv) {
 	time_d_totavg = 0.0;
 	altitude_totavg = 0.0;
 
-	/* initialize grids */
-	if (gridamp) {
-		/* allocate memory for output grids */
-		status = mb_mallocd(verbose, __FILE__, __LINE__, gridampn_columns * gridampn_rows * sizeof(float), (void **)&gridamphist, &error);
-
-		/* if error initializing memory then quit */
-		if (error != MB_ERROR_NO_ERROR) {
-			char *message;
-			mb_error(verbose, error, &message);
-			fprintf(stderr, "\nMBIO Error allocating data arrays:\n%s\n", message);
-			fprintf(stderr, "\nProgram <%s> Terminated\n", program_name);
-			mb_memory_clear(verbose, &error);
-			exit(error);
+	/* get number of threads to use - dumped tables all go to stdout
+	    so they are generated one file at a time */
+	const int n_concurrency = std::max((int)std::thread::hardware_concurrency(), 1);
+	n_threads = std::max(std::min(n_threads, std::min(n_concurrency, MB_THREAD_MAX)), 1);
+	if (dump)
+		n_threads = 1;
+	if (verbose > 0)
+		fprintf(stderr, "Using %d threads\n", n_threads);
+
+	/* set the parameters shared by all files */
+	struct mbba_param_struct par;
+	par.verbose = verbose;
+	par.lonflip = lonflip;
+	for (int i = 0; i < 4; i++)
+		par.bounds[i] = bounds[i];
+	for (int i = 0; i < 7; i++) {
+		par.btime_i[i] = btime_i[i];
+		par.etime_i[i] = etime_i[i];
+	}
+	par.speedmin = speedmin;
+	par.timegap = timegap;
+	par.dump = dump;
+	par.symmetry = symmetry;
+	par.amplitude_on = amplitude_on;
+	par.sidescan_on = sidescan_on;
+	par.beammode = beammode;
+	par.ssbeamwidth = ssbeamwidth;
+	par.ssdepression = ssdepression;
+	par.gridamp = gridamp;
+	par.gridampangle = gridampangle;
+	par.gridampmin = gridampmin;
+	par.gridampn_columns = gridampn_columns;
+	par.gridampn_rows = gridampn_rows;
+	par.gridampdx = gridampdx;
+	par.gridampdy = gridampdy;
+	par.gridss = gridss;
+	par.gridssangle = gridssangle;
+	par.gridssmin = gridssmin;
+	par.gridssn_columns = gridssn_columns;
+	par.gridssn_rows = gridssn_rows;
+	par.gridssdx = gridssdx;
+	par.gridssdy = gridssdy;
+	par.nangles = nangles;
+	par.angle_max = angle_max;
+	par.dangle = dangle;
+	par.angle_start = angle_start;
+	par.pings_avg = pings_avg;
+	par.corr_slope = corr_slope;
+	par.ref_angle = ref_angle;
+	par.corr_topogrid = corr_topogrid;
+	par.grid = &grid;
+	par.altitude_default = altitude_default;
+	par.amp_corr_slope = amp_corr_slope;
+	par.ss_corr_slope = ss_corr_slope;
+	par.user = user;
+	par.host = host;
+	par.date = date;
+
+	/* allocate the per thread accumulators */
+	struct mbba_file_struct files[MB_THREAD_MAX];
+	memset(files, 0, sizeof(files));
+	for (int ithread = 0; ithread < n_threads; ithread++) {
+		struct mbba_file_struct *file = &files[ithread];
+		if (amplitude_on) {
+			if (error == MB_ERROR_NO_ERROR)
+				mb_mallocd(verbose, __FILE__, __LINE__, nangles * sizeof(int), (void **)&file->nmeantotamp, &error);
+			if (error == MB_ERROR_NO_ERROR)
+				mb_mallocd(verbose, __FILE__, __LINE__, nangles * sizeof(double), (void **)&file->meantotamp, &error);
+			if (error == MB_ERROR_NO_ERROR)
+				mb_mallocd(verbose, __FILE__, __LINE__, nangles * sizeof(double), (void **)&file->sigmatotamp, &error);
+		}
+		if (sidescan_on) {
+			if (error == MB_ERROR_NO_ERROR)
+				mb_mallocd(verbose, __FILE__, __LINE__, nangles * sizeof(int), (void **)&file->nmeantotss, &error);
+			if (error == MB_ERROR_NO_ERROR)
+				mb_mallocd(verbose, __FILE__, __LINE__, nangles * sizeof(double), (void **)&file->meantotss, &error);
+			if (error == MB_ERROR_NO_ERROR)
+				mb_mallocd(verbose, __FILE__, __LINE__, nangles * sizeof(double), (void **)&file->sigmatotss, &error);
 		}
+		if (gridamp && error == MB_ERROR_NO_ERROR)
+			mb_mallocd(verbose, __FILE__, __LINE__, gridampn_columns * gridampn_rows * sizeof(float),
+			           (void **)&file->gridamphist, &error);
+		if (gridss && error == MB_ERROR_NO_ERROR)
+			mb_mallocd(verbose, __FILE__, __LINE__, gridssn_columns * gridssn_rows * sizeof(float),
+			           (void **)&file->gridsshist, &error);
 	}
-	if (gridss) {
-		/* allocate memory for output grids */
-		status = mb_mallocd(verbose, __FILE__, __LINE__, gridssn_columns * gridssn_rows * sizeof(float), (void **)&gridsshist, &error);
 
-		/* if error initializing memory then quit */
-		if (error != MB_ERROR_NO_ERROR) {
-			char *message;
-			mb_error(verbose, error, &message);
-			fprintf(stderr, "\nMBIO Error allocating data arrays:\n%s\n", message);
-			fprintf(stderr, "\nProgram <%s> Terminated\n", program_name);
-			mb_memory_clear(verbose, &error);
-			exit(error);
-		}
+	/* if error initializing memory then quit */
+	if (error != MB_ERROR_NO_ERROR) {
+		char *message;
+		mb_error(verbose, error, &message);
+		fprintf(stderr, "\nMBIO Error allocating data arrays:\n%s\n", message);
+		fprintf(stderr, "\nProgram <%s> Terminated\n", program_name);
+		mb_memory_clear(verbose, &error);
+		exit(error);
 	}
 
 	/* get format if required */
@@ -848,17 +1608,20 @@ int main(int argc, char **argv) {
 		read_data = true;
 	}
 
-	/* loop over all files to be read */
-	while (read_data) {
+	/* loop over all files to be read, handing up to n_threads files
+	    at a time to the threads */
+	int nfiles = 0;
+	while (read_data || nfiles > 0) {
 
-		bool ok_to_process = true;
+		bool ok_to_process = read_data;
 
 		/* obtain format array location - format id will
 		    be aliased to current id if old format id given */
-		mb_format(verbose, &format, &error);
+		if (read_data)
+			mb_format(verbose, &format, &error);
 
 		/* check that the format supports amplitude or sidescan data */
-		{
+		if (read_data) {
 			int cformat = format;
 			int csystem = 0;
 			int cbeams_bath_max = 0;
@@ -895,579 +1658,80 @@ int main(int argc, char **argv) {
 			}
 		}
 
+		/* queue the file for the next thread */
 		if (ok_to_process) {
+			strcpy(files[nfiles].swathfile, swathfile);
+			files[nfiles].format = format;
+			nfiles++;
+		}
 
-			/* output information */
-			if (verbose > 0) {
-				fprintf(stderr, "\nprocessing swath file: %s %d\n", swathfile, format);
-			}
-
-			/* initialize reading the swath sonar file */
-			if (mb_read_init(verbose, swathfile, format, 1, lonflip, bounds, btime_i, etime_i, speedmin, timegap, &mbio_ptr,
-			                           &btime_d, &etime_d, &beams_bath, &beams_amp, &pixels_ss, &error) != MB_SUCCESS) {
-				char *message;
-				mb_error(verbose, error, &message);
-				fprintf(stderr, "\nMBIO Error returned from function <mb_read_init>:\n%s\n", message);
-				fprintf(stderr, "\nMultibeam File <%s> not initialized for reading\n", swathfile);
-				fprintf(stderr, "\nProgram <%s> Terminated\n", program_name);
-				exit(error);
-			}
-
-			/* set correction modes according to format */
-			if (format == MBF_SB2100RW || format == MBF_SB2100B1 || format == MBF_SB2100B2 || format == MBF_EDGJSTAR ||
-			    format == MBF_EDGJSTR2 || format == MBF_RESON7KR || format == MBF_RESON7K3)
-				ss_corr_type = MBP_SSCORR_DIVISION;
-			else if (format == MBF_MBLDEOIH)
-				ss_corr_type = MBP_SSCORR_UNKNOWN;
+		/* figure out whether and what to read next */
+		if (read_data && read_datalist) {
+			if ((status = mb_datalist_read(verbose, datalist, swathfile, dfile, &format, &file_weight, &error)) == MB_SUCCESS)
+				read_data = true;
 			else
-				ss_corr_type = MBP_SSCORR_SUBTRACTION;
-	    	if (format == MBF_3DWISSLR || format == MBF_3DWISSLP || format == MBF_RESON7K3)
-				amp_corr_type = MBP_AMPCORR_DIVISION;
-		  	else
-				amp_corr_type = MBP_AMPCORR_SUBTRACTION;
-
-			/* allocate memory for data arrays */
-			if (error == MB_ERROR_NO_ERROR)
-				status &= mb_mallocd(verbose, __FILE__, __LINE__, beams_bath * sizeof(char), (void **)&beamflag, &error);
-			if (error == MB_ERROR_NO_ERROR)
-				status &= mb_mallocd(verbose, __FILE__, __LINE__, beams_bath * sizeof(double), (void **)&bath, &error);
-			if (error == MB_ERROR_NO_ERROR)
-				status &= mb_mallocd(verbose, __FILE__, __LINE__, beams_amp * sizeof(double), (void **)&amp, &error);
-			if (error == MB_ERROR_NO_ERROR)
-				status &= mb_mallocd(verbose, __FILE__, __LINE__, beams_bath * sizeof(double), (void **)&bathacrosstrack, &error);
-			if (error == MB_ERROR_NO_ERROR)
-				status &= mb_mallocd(verbose, __FILE__, __LINE__, beams_bath * sizeof(double), (void **)&bathalongtrack, &error);
-			if (error == MB_ERROR_NO_ERROR)
-				status &= mb_mallocd(verbose, __FILE__, __LINE__, pixels_ss * sizeof(double), (void **)&ss, &error);
-			if (error == MB_ERROR_NO_ERROR)
-				status &= mb_mallocd(verbose, __FILE__, __LINE__, pixels_ss * sizeof(double), (void **)&ssacrosstrack, &error);
-			if (error == MB_ERROR_NO_ERROR)
-				status &= mb_mallocd(verbose, __FILE__, __LINE__, pixels_ss * sizeof(double), (void **)&ssalongtrack, &error);
-			if (error == MB_ERROR_NO_ERROR)
-				status &= mb_mallocd(verbose, __FILE__, __LINE__, beams_bath * sizeof(double), (void **)&depths, &error);
-			if (error == MB_ERROR_NO_ERROR)
-				status &= mb_mallocd(verbose, __FILE__, __LINE__, beams_bath * sizeof(double), (void **)&depthsmooth, &error);
-			if (error == MB_ERROR_NO_ERROR)
-				status &= mb_mallocd(verbose, __FILE__, __LINE__, beams_bath * sizeof(double), (void **)&depthacrosstrack, &error);
-			if (error == MB_ERROR_NO_ERROR)
-				status &= mb_mallocd(verbose, __FILE__, __LINE__, (beams_bath + 1) * sizeof(double), (void **)&slopes, &error);
-			if (error == MB_ERROR_NO_ERROR)
-				status &=
-				    mb_mallocd(verbose, __FILE__, __LINE__, (beams_bath + 1) * sizeof(double), (void **)&slopeacrosstrack, &error);
-			if (error == MB_ERROR_NO_ERROR)
-				status &= mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_BATHYMETRY, sizeof(char), (void **)&beamflag, &error);
-			if (error == MB_ERROR_NO_ERROR)
-				status &= mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_BATHYMETRY, sizeof(double), (void **)&bath, &error);
-			if (error == MB_ERROR_NO_ERROR)
-				status &= mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_AMPLITUDE, sizeof(double), (void **)&amp, &error);
-			if (error == MB_ERROR_NO_ERROR)
-				status &=
-				    mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_BATHYMETRY, sizeof(double), (void **)&bathacrosstrack, &error);
-			if (error == MB_ERROR_NO_ERROR)
-				status &=
-				    mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_BATHYMETRY, sizeof(double), (void **)&bathalongtrack, &error);
-			if (error == MB_ERROR_NO_ERROR)
-				status &= mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_SIDESCAN, sizeof(double), (void **)&ss, &error);
-			if (error == MB_ERROR_NO_ERROR)
-				status &= mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_SIDESCAN, sizeof(double), (void **)&ssacrosstrack, &error);
-			if (error == MB_ERROR_NO_ERROR)
-				status &= mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_SIDESCAN, sizeof(double), (void **)&ssalongtrack, &error);
-			if (error == MB_ERROR_NO_ERROR)
-				status &= mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_BATHYMETRY, sizeof(double), (void **)&depths, &error);
-			if (error == MB_ERROR_NO_ERROR)
-				status &= mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_BATHYMETRY, sizeof(double), (void **)&depthsmooth, &error);
-			if (error == MB_ERROR_NO_ERROR)
-				status &=
-				    mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_BATHYMETRY, sizeof(double), (void **)&depthacrosstrack, &error);
-			if (error == MB_ERROR_NO_ERROR)
-				status &= mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_BATHYMETRY, sizeof(double), (void **)&slopes, &error);
-			if (error == MB_ERROR_NO_ERROR)
-				status &= mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_BATHYMETRY, 2 * sizeof(double), (void **)&slopeacrosstrack,
-				                           &error);
-			if (error == MB_ERROR_NO_ERROR)
-				status &= mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_BATHYMETRY, 2 * sizeof(double), (void **)&bathalongtrack,
-				                           &error);
-
-			/* if error initializing memory then quit */
-			if (error != MB_ERROR_NO_ERROR) {
-				char *message;
-				mb_error(verbose, error, &message);
-				fprintf(stderr, "\nMBIO Error allocating data arrays:\n%s\n", message);
-				fprintf(stderr, "\nProgram <%s> Terminated\n", program_name);
-				exit(error);
-			}
+				read_data = false;
+		}
+		else {
+			read_data = false;
+		}
+    	status = MB_SUCCESS;
+    	error = MB_ERROR_NO_ERROR;
 
-	  		/* Deal with esf file if avialable */
-	  		if (status == MB_SUCCESS) {
-	  			mb_path esffile;
-	  			mb_esf_load(verbose, program_name, swathfile, true, false, esffile, &esf, &error);
-	      		error = MB_ERROR_NO_ERROR;
-	  		}
-
-			/* initialize grid arrays */
-			if (error == MB_ERROR_NO_ERROR) {
-				if (gridamp) {
-					/* initialize the memory */
-					for (int i = 0; i < gridampn_columns * gridampn_rows; i++) {
-						gridamphist[i] = 0.0;
-					}
-				}
-				if (gridss) {
-					/* initialize the memory */
-					for (int i = 0; i < gridssn_columns * gridssn_rows; i++) {
-						gridsshist[i] = 0.0;
-					}
-				}
-			}
+		/* once all threads have a file, or the list is done, process the files */
+		if (nfiles < n_threads && read_data)
+			continue;
+		if (nfiles == 1) {
+			process_file(&par, &files[0]);
+		}
+		else if (nfiles > 1) {
+			std::thread threads[MB_THREAD_MAX];
+			for (int ithread = 0; ithread < nfiles; ithread++)
+				threads[ithread] = std::thread(process_file, &par, &files[ithread]);
+			for (int ithread = 0; ithread < nfiles; ithread++)
+				threads[ithread].join();
+		}
 
-			/* open output files */
-			if (error == MB_ERROR_NO_ERROR && dump) {
-				atfp = stdout;
-				stfp = stdout;
-			}
-			else if (error == MB_ERROR_NO_ERROR) {
-				if (amplitude_on) {
-					strcpy(amptablefile, swathfile);
-					strcat(amptablefile, ".aga");
-					if ((atfp = fopen(amptablefile, "w")) == nullptr) {
-						char *message;
-						mb_error(verbose, error, &message);
-						fprintf(stderr, "\nUnable to open output table file %s\n", amptablefile);
-						fprintf(stderr, "Program %s aborted!\n", program_name);
-						exit(MB_ERROR_OPEN_FAIL);
-					}
-				}
-				if (sidescan_on) {
-					strcpy(sstablefile, swathfile);
-					strcat(sstablefile, ".sga");
-					if ((stfp = fopen(sstablefile, "w")) == nullptr) {
-						char *message;
-						mb_error(verbose, error, &message);
-						fprintf(stderr, "\nUnable to open output table file %s\n", sstablefile);
-						fprintf(stderr, "Program %s aborted!\n", program_name);
-						exit(MB_ERROR_OPEN_FAIL);
-					}
-				}
+		/* a file that could not be read or whose tables could not be
+		    written stops the program once all threads are done */
+		for (int ifile = 0; ifile < nfiles; ifile++) {
+			if (files[ifile].error != MB_ERROR_NO_ERROR) {
+				fprintf(stderr, "\nProgram <%s> Terminated\n", program_name);
+				exit(files[ifile].error);
 			}
+		}
 
-			/* write to output file */
-			if (error == MB_ERROR_NO_ERROR) {
-	  		char user[256], host[256], date[32];
-	  		status = mb_user_host_date(verbose, user, host, date, &error);
-
-				/* set comments in table files */
-				if (amplitude_on) {
-					fprintf(atfp, "## Amplitude correction table files generated by program %s\n", program_name);
-					fprintf(atfp, "## MB-system Version %s\n", MB_VERSION);
-					fprintf(atfp, "## Table file format: 1.0.0\n");
-					fprintf(atfp, "## Run by user <%s> on cpu <%s> at <%s>\n", user, host, date);
-					fprintf(atfp, "## Input swath file:      %s\n", swathfile);
-					fprintf(atfp, "## Input swath format:    %d\n", format);
-					fprintf(atfp, "## Output table file:     %s\n", amptablefile);
-					fprintf(atfp, "## Pings to average:      %d\n", pings_avg);
-					fprintf(atfp, "## Number of angle bins:  %d\n", nangles);
-					fprintf(atfp, "## Maximum angle:         %f\n", angle_max);
-					fprintf(atfp, "## Default altitude:      %f\n", altitude_default);
-					fprintf(atfp, "## Slope correction:      %d\n", amp_corr_slope);
-					fprintf(atfp, "## Data type:             beam amplitude\n");
-				}
+		/* merge the results in file order */
+		for (int ifile = 0; ifile < nfiles; ifile++) {
+			struct mbba_file_struct *file = &files[ifile];
 
-				if (sidescan_on) {
-					fprintf(stfp, "## Sidescan correction table files generated by program %s\n", program_name);
-					fprintf(stfp, "## MB-system Version %s\n", MB_VERSION);
-					fprintf(stfp, "## Table file format: 1.0.0\n");
-					fprintf(stfp, "## Run by user <%s> on cpu <%s> at <%s>\n", user, host, date);
-					fprintf(stfp, "## Input swath file:      %s\n", swathfile);
-					fprintf(stfp, "## Input swath format:    %d\n", format);
-					fprintf(stfp, "## Output table file:     %s\n", sstablefile);
-					fprintf(stfp, "## Pings to average:      %d\n", pings_avg);
-					fprintf(stfp, "## Number of angle bins:  %d\n", nangles);
-					fprintf(stfp, "## Maximum angle:         %f\n", angle_max);
-					fprintf(stfp, "## Default altitude:      %f\n", altitude_default);
-					fprintf(stfp, "## Slope Correction:      %d\n", ss_corr_slope);
-					fprintf(stfp, "## Data type:             sidescan\n");
+			/* add the file to the total tables */
+			ntotavg += file->ntotavg;
+			time_d_totavg += file->time_d_totavg;
+			altitude_totavg += file->altitude_totavg;
+			if (amplitude_on) {
+				for (int i = 0; i < nangles; i++) {
+					nmeantotamp[i] += file->nmeantotamp[i];
+					meantotamp[i] += file->meantotamp[i];
+					sigmatotamp[i] += file->sigmatotamp[i];
 				}
 			}
-
-			/* initialize counting variables */
-			int nrec = 0;
-			int namp = 0;
-			int nss = 0;
-			int navg = 0;
-			int ntable = 0;
-			double time_d_avg = 0.0;
-			double altitude_avg = 0.0;
-
-			/* read and process data */
-			while (error <= MB_ERROR_NO_ERROR) {
-
-				/* read a ping of data */
-				status = mb_get(verbose, mbio_ptr, &kind, &pings, time_i, &time_d, &navlon, &navlat, &speed, &heading, &distance,
-				                &altitude, &sensordepth, &beams_bath, &beams_amp, &pixels_ss, beamflag, bath, amp, bathacrosstrack,
-				                bathalongtrack, ss, ssacrosstrack, ssalongtrack, comment, &error);
-
-				/* Apply ESF Edits if available */
-				if (esf.nedit > 0 && error == MB_ERROR_NO_ERROR && kind == MB_DATA_DATA) {
-					status = mb_esf_apply(verbose, &esf, time_d, 0, beams_bath, beamflag, &error);
-				}
-
-				if ((navg > 0 && (error == MB_ERROR_TIME_GAP || error == MB_ERROR_EOF)) || (navg >= pings_avg) ||
-				    (navg == 0 && error == MB_ERROR_EOF)) {
-					/* write out tables */
-					time_d_avg /= navg;
-					altitude_avg /= navg;
-					if (beammode == MBBACKANGLE_BEAMPATTERN_EMPIRICAL) {
-						if (amplitude_on) {
-							output_table(verbose, atfp, ntable, navg, time_d_avg, nangles, angle_max, dangle, symmetry, nmeanamp,
-							             meanamp, sigmaamp, &error);
-					  }
-						if (sidescan_on) {
-							output_table(verbose, stfp, ntable, navg, time_d_avg, nangles, angle_max, dangle, symmetry, nmeanss,
-							             meanss, sigmass, &error);
-					  }
-					}
-					else if (beammode == MBBACKANGLE_BEAMPATTERN_SIDESCAN) {
-						if (amplitude_on) {
-							output_model(verbose, atfp, ssbeamwidth, ssdepression, ref_angle, ntable, navg, time_d_avg, altitude_avg,
-							             nangles, angle_max, dangle, symmetry, nmeanamp, meanamp, sigmaamp, &error);
-					  }
-						if (sidescan_on) {
-							output_model(verbose, stfp, ssbeamwidth, ssdepression, ref_angle, ntable, navg, time_d_avg, altitude_avg,
-							             nangles, angle_max, dangle, symmetry, nmeanss, meanss, sigmass, &error);
-					  }
-					}
-					ntable++;
-
-					/* reinitialize arrays */
-					navg = 0;
-					time_d_avg = 0.0;
-					altitude_avg = 0.0;
-					if (amplitude_on) {
-						for (int i = 0; i < nangles; i++) {
-							nmeanamp[i] = 0;
-							meanamp[i] = 0.0;
-							sigmaamp[i] = 0.0;
-						}
-	        		}
-					if (sidescan_on) {
-						for (int i = 0; i < nangles; i++) {
-							nmeanss[i] = 0;
-							meanss[i] = 0.0;
-							sigmass[i] = 0.0;
-						}
-	        		}
-				}
-
-				/* process the pings */
-				if (error == MB_ERROR_NO_ERROR || error == MB_ERROR_TIME_GAP) {
-					/* if needed, attempt to get sidescan correction type */
-					if (ss_corr_type == MBP_SSCORR_UNKNOWN) {
-						status = mb_sidescantype(verbose, mbio_ptr, nullptr, &ss_type, &error);
-						if (status == MB_SUCCESS) {
-							if (ss_type == MB_SIDESCAN_LINEAR) {
-								ss_corr_type = MBP_SSCORR_DIVISION;
-	            			}
-							else {
-								ss_corr_type = MBP_SSCORR_SUBTRACTION;
-	            			}
-						}
-						else {
-							status = MB_SUCCESS;
-							error = MB_ERROR_NO_ERROR;
-							ss_corr_type = MBP_SSCORR_SUBTRACTION;
-						}
-					}
-
-					/* increment record counter */
-					nrec++;
-					navg++;
-					ntotavg++;
-
-					/* increment time */
-					time_d_avg += time_d;
-					altitude_avg += altitude;
-					time_d_totavg += time_d;
-					altitude_totavg += altitude;
-
-					/* get the seafloor slopes */
-					if (beams_bath > 0)
-						mb_pr_set_bathyslope(verbose, nsmooth, beams_bath, beamflag, bath, bathacrosstrack, &ndepths, depths,
-						                     depthacrosstrack, &nslopes, slopes, slopeacrosstrack, depthsmooth, &error);
-
-					/* get distance scaling and heading vector */
-					mb_coor_scale(verbose, navlat, &mtodeglon, &mtodeglat);
-					headingx = sin(heading * DTR);
-					headingy = cos(heading * DTR);
-
-					/* do the amplitude */
-					double altitude_use = 0.0;
-					if (amplitude_on)
-						for (int i = 0; i < beams_amp; i++) {
-							if (mb_beam_ok(beamflag[i])) {
-								namp++;
-								if (corr_topogrid) {
-									/* get position in grid */
-									r[0] = headingy * bathacrosstrack[i] + headingx * bathalongtrack[i];
-									r[1] = -headingx * bathacrosstrack[i] + headingy * bathalongtrack[i];
-									ix = (navlon + r[0] * mtodeglon - grid.xmin + 0.5 * grid.dx) / grid.dx;
-									jy = (navlat + r[1] * mtodeglat - grid.ymin + 0.5 * grid.dy) / grid.dy;
-									kgrid = ix * grid.n_rows + jy;
-									kgrid00 = (ix - 1) * grid.n_rows + jy - 1;
-									kgrid01 = (ix - 1) * grid.n_rows + jy + 1;
-									kgrid10 = (ix + 1) * grid.n_rows + jy - 1;
-									kgrid11 = (ix + 1) * grid.n_rows + jy + 1;
-									if (ix > 0 && ix < grid.n_columns - 1 && jy > 0 && jy < grid.n_rows - 1 &&
-									    grid.data[kgrid] > grid.nodatavalue && grid.data[kgrid00] > grid.nodatavalue &&
-									    grid.data[kgrid01] > grid.nodatavalue && grid.data[kgrid10] > grid.nodatavalue &&
-									    grid.data[kgrid11] > grid.nodatavalue) {
-										/* get look vector for data */
-										bathy = -grid.data[kgrid];
-										r[2] = grid.data[kgrid] + sensordepth;
-										rr = -sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]);
-										r[0] /= rr;
-										r[1] /= rr;
-										r[2] /= rr;
-
-										/* get normal vector to grid surface */
-										if (corr_slope) {
-											v1[0] = 2.0 * grid.dx / mtodeglon;
-											v1[1] = 2.0 * grid.dy / mtodeglat;
-											v1[2] = grid.data[kgrid11] - grid.data[kgrid00];
-											v2[0] = -2.0 * grid.dx / mtodeglon;
-											v2[1] = 2.0 * grid.dy / mtodeglat;
-											v2[2] = grid.data[kgrid01] - grid.data[kgrid10];
-											v[0] = v1[1] * v2[2] - v2[1] * v1[2];
-											v[1] = v2[0] * v1[2] - v1[0] * v2[2];
-											v[2] = v1[0] * v2[1] - v2[0] * v1[1];
-											vv = sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
-											v[0] /= vv;
-											v[1] /= vv;
-											v[2] /= vv;
-										}
-										else {
-											v[0] = 0.0;
-											v[1] = 0.0;
-											v[2] = 1.0;
-										}
-
-										/* angle between look vector and surface normal
-										    is the acos(r dot v) */
-										angle = RTD * acos(r[0] * v[0] + r[1] * v[1] + r[2] * v[2]);
-										if (bathacrosstrack[i] < 0.0)
-											angle = -angle;
-									}
-									else {
-										if (ix >= 0 && ix < grid.n_columns && jy >= 0 && jy < grid.n_rows && grid.data[kgrid] > grid.nodatavalue)
-											bathy = -grid.data[kgrid];
-										else if (altitude > 0.0)
-											bathy = altitude + sensordepth;
-										else
-											bathy = altitude_default + sensordepth;
-										angle = RTD * atan(bathacrosstrack[i] / (bathy - sensordepth));
-										slope = 0.0;
-									}
-								}
-								else if (beams_bath == beams_amp) {
-									status = mb_pr_get_bathyslope(verbose, ndepths, depths, depthacrosstrack, nslopes, slopes,
-									                              slopeacrosstrack, bathacrosstrack[i], &bathy, &slope, &error);
-									if (status != MB_SUCCESS) {
-										if (altitude > 0.0)
-											bathy = altitude + sensordepth;
-										else
-											bathy = altitude_default + sensordepth;
-										slope = 0.0;
-										status = MB_SUCCESS;
-										error = MB_ERROR_NO_ERROR;
-									}
-									altitude_use = bathy - sensordepth;
-									angle = RTD * atan(bathacrosstrack[i] / altitude_use);
-									if (corr_slope)
-										angle += RTD * atan(slope);
-								}
-								else {
-									if (altitude > 0.0)
-										bathy = altitude + sensordepth;
-									else
-										bathy = altitude_default + sensordepth;
-									slope = 0.0;
-									altitude_use = bathy - sensordepth;
-									angle = RTD * atan(bathacrosstrack[i] / altitude_use);
-								}
-								if (bathy > 0.0) {
-									/* load amplitude into table */
-									const int j = (angle - angle_start) / dangle;
-									if (j >= 0 && j < nangles) {
-										meanamp[j] += amp[i];
-										sigmaamp[j] += amp[i] * amp[i];
-										nmeanamp[j]++;
-										meantotamp[j] += amp[i];
-										sigmatotamp[j] += amp[i] * amp[i];
-										nmeantotamp[j]++;
-									}
-
-									/* load amplitude into grid */
-									if (gridamp) {
-										ix = (angle + gridampangle) / gridampdx;
-										jy = (amp[i] - gridampmin) / gridampdy;
-										if (ix >= 0 && ix < gridampn_columns && jy >= 0 && jy < gridampn_rows) {
-											const int k = ix * gridampn_rows + jy;
-											gridamphist[k] += 1.0;
-										}
-									}
-								}
-
-								if (verbose >= 5) {
-									fprintf(stderr, "dbg5       %d %d: slope:%f altitude:%f xtrack:%f ang:%f\n", nrec, i, slope,
-									        altitude_use, bathacrosstrack[i], angle);
-								}
-							}
-						}
-
-					/* do the sidescan */
-					if (sidescan_on)
-						for (int i = 0; i < pixels_ss; i++) {
-							if (ss[i] > MB_SIDESCAN_NULL) {
-								nss++;
-								if (corr_topogrid) {
-									/* get position in grid */
-									r[0] = headingy * ssacrosstrack[i] + headingx * ssalongtrack[i];
-									r[1] = -headingx * ssacrosstrack[i] + headingy * ssalongtrack[i];
-									ix = (navlon + r[0] * mtodeglon - grid.xmin + 0.5 * grid.dx) / grid.dx;
-									jy = (navlat + r[1] * mtodeglat - grid.ymin + 0.5 * grid.dy) / grid.dy;
-									kgrid = ix * grid.n_rows + jy;
-									kgrid00 = (ix - 1) * grid.n_rows + jy - 1;
-									kgrid01 = (ix - 1) * grid.n_rows + jy + 1;
-									kgrid10 = (ix + 1) * grid.n_rows + jy - 1;
-									kgrid11 = (ix + 1) * grid.n_rows + jy + 1;
-									if (ix > 0 && ix < grid.n_columns - 1 && jy > 0 && jy < grid.n_rows - 1 &&
-									    grid.data[kgrid] > grid.nodatavalue && grid.data[kgrid00] > grid.nodatavalue &&
-									    grid.data[kgrid01] > grid.nodatavalue && grid.data[kgrid10] > grid.nodatavalue &&
-									    grid.data[kgrid11] > grid.nodatavalue) {
-										/* get look vector for data */
-										bathy = -grid.data[kgrid];
-										r[2] = grid.data[kgrid] + sensordepth;
-										rr = -sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]);
-										r[0] /= rr;
-										r[1] /= rr;
-										r[2] /= rr;
-
-										/* get normal vector to grid surface */
-										if (corr_slope) {
-											v1[0] = 2.0 * grid.dx / mtodeglon;
-											v1[1] = 2.0 * grid.dy / mtodeglat;
-											v1[2] = grid.data[kgrid11] - grid.data[kgrid00];
-											v2[0] = -2.0 * grid.dx / mtodeglon;
-											v2[1] = 2.0 * grid.dy / mtodeglat;
-											v2[2] = grid.data[kgrid01] - grid.data[kgrid10];
-											v[0] = v1[1] * v2[2] - v2[1] * v1[2];
-											v[1] = v2[0] * v1[2] - v1[0] * v2[2];
-											v[2] = v1[0] * v2[1] - v2[0] * v1[1];
-											vv = sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
-											v[0] /= vv;
-											v[1] /= vv;
-											v[2] /= vv;
-										}
-										else {
-											v[0] = 0.0;
-											v[1] = 0.0;
-											v[2] = 1.0;
-										}
-
-										/* angle between look vector and surface normal
-										    is the acos(r dot v) */
-										angle = RTD * acos(r[0] * v[0] + r[1] * v[1] + r[2] * v[2]);
-										if (ssacrosstrack[i] < 0.0)
-											angle = -angle;
-									}
-									else {
-										if (ix >= 0 && ix < grid.n_columns && jy >= 0 && jy < grid.n_rows && grid.data[kgrid] > grid.nodatavalue)
-											bathy = -grid.data[kgrid];
-										else if (altitude > 0.0)
-											bathy = altitude + sensordepth;
-										else
-											bathy = altitude_default + sensordepth;
-										angle = RTD * atan(ssacrosstrack[i] / (bathy - sensordepth));
-										slope = 0.0;
-									}
-								}
-								else if (beams_bath > 0) {
-									status = mb_pr_get_bathyslope(verbose, ndepths, depths, depthacrosstrack, nslopes, slopes,
-									                              slopeacrosstrack, ssacrosstrack[i], &bathy, &slope, &error);
-									if (status != MB_SUCCESS || bathy <= 0.0) {
-										if (altitude > 0.0)
-											bathy = altitude + sensordepth;
-										else
-											bathy = altitude_default;
-										slope = 0.0;
-										status = MB_SUCCESS;
-										error = MB_ERROR_NO_ERROR;
-									}
-									altitude_use = bathy - sensordepth;
-									angle = RTD * atan(ssacrosstrack[i] / altitude_use);
-									if (corr_slope)
-										angle += RTD * atan(slope);
-								}
-								else {
-									if (altitude > 0.0)
-										bathy = altitude + sensordepth;
-									else
-										bathy = altitude_default;
-									slope = 0.0;
-									altitude_use = bathy - sensordepth;
-									angle = RTD * atan(ssacrosstrack[i] / altitude_use);
-								}
-								if (bathy > 0.0) {
-									/* load amplitude into table */
-									const int j = (angle - angle_start) / dangle;
-									if (j >= 0 && j < nangles) {
-										meanss[j] += ss[i];
-										sigmass[j] += ss[i] * ss[i];
-										nmeanss[j]++;
-										meantotss[j] += ss[i];
-										sigmatotss[j] += ss[i] * ss[i];
-										nmeantotss[j]++;
-									}
-
-									/* load amplitude into grid */
-									if (gridss) {
-										ix = (angle + gridssangle) / gridssdx;
-										jy = (ss[i] - gridssmin) / gridssdy;
-										if (ix >= 0 && ix < gridssn_columns && jy >= 0 && jy < gridssn_rows) {
-											const int k = ix * gridssn_rows + jy;
-											gridsshist[k] += 1.0;
-										}
-									}
-								}
-
-								if (verbose >= 5) {
-									fprintf(stderr, "dbg5kkk       %d %d: slope:%f altitude:%f xtrack:%f ang:%f\n", nrec, i,
-									        slope, altitude_use, ssacrosstrack[i], angle);
-								}
-							}
-						}
+			if (sidescan_on) {
+				for (int i = 0; i < nangles; i++) {
+					nmeantotss[i] += file->nmeantotss[i];
+					meantotss[i] += file->meantotss[i];
+					sigmatotss[i] += file->sigmatotss[i];
 				}
 			}
-
-			/* close the swath sonar file */
-	    	status = MB_SUCCESS;
-	    	error = MB_ERROR_NO_ERROR;
-			status = mb_close(verbose, &mbio_ptr, &error);
-
-			/* Close ESF file if avialable and open */
-			if (esf.edit != nullptr || esf.esffp != nullptr)
-				mb_esf_close(verbose, &esf, &error);
-
-			if (!dump && amplitude_on)
-				fclose(atfp);
-			if (!dump && sidescan_on)
-				fclose(stfp);
-			ntabletot += ntable;
-			nrectot += nrec;
-			namptot += namp;
-			nsstot += nss;
+			ntabletot += file->ntable;
+			nrectot += file->nrec;
+			namptot += file->namp;
+			nsstot += file->nss;
 
 			/* output grids */
 			if (gridamp) {
+				float *gridamphist = file->gridamphist;
+
 				/* normalize the grid */
 				ampmax = 0.0;
 				for (ix = 0; ix < gridampn_columns; ix++) {
@@ -1487,7 +1751,7 @@ int main(int argc, char **argv) {
 				}
 
 				/* set the strings */
-				strcpy(gridfile, swathfile);
+				strcpy(gridfile, file->swathfile);
 				strcat(gridfile, "_aga.grd");
 				strcpy(zlabel, "Beam Amplitude PDF (X1000)");
 				strcpy(title, "Beam Amplitude vs. Grazing Angle PDF");
@@ -1499,8 +1763,8 @@ int main(int argc, char **argv) {
 
 				/* run mbm_grdplot */
 	      		memset(plot_cmd, 0, sizeof(plot_cmd));
-				snprintf(plot_cmd, sizeof(plot_cmd), "mbm_grdplot -I%s -JX9/5 -G1 -MGQ100 -MXI%s -L\"File %s - %s:%s\"", gridfile, amptablefile,
-				        gridfile, title, zlabel);
+				snprintf(plot_cmd, sizeof(plot_cmd), "mbm_grdplot -I%s -JX9/5 -G1 -MGQ100 -MXI%s -L\"File %s - %s:%s\"", gridfile,
+				        file->amptablefile, gridfile, title, zlabel);
 				if (verbose) {
 					fprintf(stderr, "\nexecuting mbm_grdplot...\n%s\n", plot_cmd);
 				}
@@ -1510,6 +1774,8 @@ int main(int argc, char **argv) {
 				}
 			}
 			if (gridss) {
+				float *gridsshist = file->gridsshist;
+
 				/* normalize the grid */
 				ampmax = 0.0;
 				for (ix = 0; ix < gridssn_columns; ix++) {
@@ -1529,7 +1795,7 @@ int main(int argc, char **argv) {
 				}
 
 				/* set the strings */
-				strcpy(gridfile, swathfile);
+				strcpy(gridfile, file->swathfile);
 				strcat(gridfile, "_sga.grd");
 				strcpy(zlabel, "Sidescan Amplitude PDF (X1000)");
 				strcpy(title, "Sidescan Amplitude vs. Grazing Angle PDF");
@@ -1541,8 +1807,8 @@ int main(int argc, char **argv) {
 
 				/* run mbm_grdplot */
 	      		memset(plot_cmd, 0, sizeof(plot_cmd));
-				snprintf(plot_cmd, sizeof(plot_cmd), "mbm_grdplot -I%s -JX9/5 -G1 -MGQ100 -MXI%s -L\"File %s - %s:%s\"", gridfile, sstablefile,
-				        gridfile, title, zlabel);
+				snprintf(plot_cmd, sizeof(plot_cmd), "mbm_grdplot -I%s -JX9/5 -G1 -MGQ100 -MXI%s -L\"File %s - %s:%s\"", gridfile,
+				        file->sstablefile, gridfile, title, zlabel);
 				if (verbose) {
 					fprintf(stderr, "\nexecuting mbm_grdplot...\n%s\n", plot_cmd);
 				}
@@ -1554,43 +1820,32 @@ int main(int argc, char **argv) {
 
 			/* set amplitude correction in parameter file */
 			if (amplitude_on) {
-				status &= mb_pr_update_ampcorr(verbose, swathfile, true, amptablefile, amp_corr_type, corr_symmetry, ref_angle,
-				                              amp_corr_slope, grid.file, &error);
+				status &= mb_pr_update_ampcorr(verbose, file->swathfile, true, file->amptablefile, file->amp_corr_type,
+				                              corr_symmetry, ref_angle, amp_corr_slope, grid.file, &error);
 	    	}
 
 			/* set sidescan correction in parameter file */
 			if (sidescan_on) {
-				status &= mb_pr_update_sscorr(verbose, swathfile, true, sstablefile, ss_corr_type, corr_symmetry, ref_angle,
-				                             ss_corr_slope, grid.file, &error);
+				status &= mb_pr_update_sscorr(verbose, file->swathfile, true, file->sstablefile, file->ss_corr_type,
+				                             corr_symmetry, ref_angle, ss_corr_slope, grid.file, &error);
 	    	}
 
 			/* output information */
 			if (error == MB_ERROR_NO_ERROR && verbose > 0) {
-				fprintf(stderr, "%d records processed\n", nrec);
+				fprintf(stderr, "\n%s: %d records processed\n", file->swathfile, file->nrec);
 				if (amplitude_on) {
-					fprintf(stderr, "%d amplitude data processed\n", namp);
-					fprintf(stderr, "%d tables written to %s\n", ntable, amptablefile);
+					fprintf(stderr, "%d amplitude data processed\n", file->namp);
+					fprintf(stderr, "%d tables written to %s\n", file->ntable, file->amptablefile);
 				}
 				if (sidescan_on) {
-					fprintf(stderr, "%d sidescan data processed\n", nss);
-					fprintf(stderr, "%d tables written to %s\n", ntable, sstablefile);
+					fprintf(stderr, "%d sidescan data processed\n", file->nss);
+					fprintf(stderr, "%d tables written to %s\n", file->ntable, file->sstablefile);
 				}
 			}
-			
-		}
-
-		/* figure out whether and what to read next */
-		if (read_datalist) {
-			if ((status = mb_datalist_read(verbose, datalist, swathfile, dfile, &format, &file_weight, &error)) == MB_SUCCESS)
-				read_data = true;
-			else
-				read_data = false;
-		}
-		else {
-			read_data = false;
+	    	status = MB_SUCCESS;
+	    	error = MB_ERROR_NO_ERROR;
 		}
-    	status = MB_SUCCESS;
-    	error = MB_ERROR_NO_ERROR;
+		nfiles = 0;
 
 		/* end loop over files in list */
 	}
@@ -1682,26 +1937,31 @@ int main(int argc, char **argv) {
 
 	/* deallocate memory used for data arrays */
 	if (amplitude_on) {
-		mb_freed(verbose, __FILE__, __LINE__, (void **)&nmeanamp, &error);
-		mb_freed(verbose, __FILE__, __LINE__, (void **)&meanamp, &error);
-		mb_freed(verbose, __FILE__, __LINE__, (void **)&sigmaamp, &error);
 		mb_freed(verbose, __FILE__, __LINE__, (void **)&nmeantotamp, &error);
 		mb_freed(verbose, __FILE__, __LINE__, (void **)&meantotamp, &error);
 		mb_freed(verbose, __FILE__, __LINE__, (void **)&sigmatotamp, &error);
-		if (gridamp) {
-			mb_freed(verbose, __FILE__, __LINE__, (void **)&gridamphist, &error);
-		}
 	}
 	if (sidescan_on) {
-		mb_freed(verbose, __FILE__, __LINE__, (void **)&nmeanss, &error);
-		mb_freed(verbose, __FILE__, __LINE__, (void **)&meanss, &error);
-		mb_freed(verbose, __FILE__, __LINE__, (void **)&sigmass, &error);
 		mb_freed(verbose, __FILE__, __LINE__, (void **)&nmeantotss, &error);
 		mb_freed(verbose, __FILE__, __LINE__, (void **)&meantotss, &error);
 		mb_freed(verbose, __FILE__, __LINE__, (void **)&sigmatotss, &error);
-		if (gridss) {
-			mb_freed(verbose, __FILE__, __LINE__, (void **)&gridsshist, &error);
+	}
+	for (int ithread = 0; ithread < n_threads; ithread++) {
+		struct mbba_file_struct *file = &files[ithread];
+		if (amplitude_on) {
+			mb_freed(verbose, __FILE__, __LINE__, (void **)&file->nmeantotamp, &error);
+			mb_freed(verbose, __FILE__, __LINE__, (void **)&file->meantotamp, &error);
+			mb_freed(verbose, __FILE__, __LINE__, (void **)&file->sigmatotamp, &error);
+		}
+		if (sidescan_on) {
+			mb_freed(verbose, __FILE__, __LINE__, (void **)&file->nmeantotss, &error);
+			mb_freed(verbose, __FILE__, __LINE__, (void **)&file->meantotss, &error);
+			mb_freed(verbose, __FILE__, __LINE__, (void **)&file->sigmatotss, &error);
 		}
+		if (gridamp)
+			mb_freed(verbose, __FILE__, __LINE__, (void **)&file->gridamphist, &error);
+		if (gridss)
+			mb_freed(verbose, __FILE__, __LINE__, (void **)&file->gridsshist, &error);
 	}
 	if (grid.data != nullptr) {
 		mb_freed(verbose, __FILE__, __LINE__, (void **)&grid.data, &error);
@@ -31,6 +31,7 @@
  * Date:	January 23, 1993
  */
 
+#include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
@@ -70,8 +71,8 @@ constexpr char help_message[] =
     "arguments will be changed; if no ~/.mbio_defaults\n"
     "file exists one will be created.";
 constexpr char usage_message[] =
-    "mbdefaults [-Bfileiobuffer -Dpsdisplay -Ffbtversion -Iimagedisplay -Llonflip\n"
-    "    -Mmbviewsettings\n\t-Ttimegap -Wproject -V -H]";
+    "mbdefaults [-Bfileiobuffer -Cnavintcache -Dpsdisplay -Ffbtversion -Iimagedisplay -Llonflip\n"
+    "    -Mmbviewsettings -Nnetcdfdeflate\n\t-Ttimegap -Wproject -V -H]";
 
 /*--------------------------------------------------------------------*/
 
@@ -123,13 +124,19 @@ int main(int argc, char **argv) {
 	int fileiobuffer = 0;
 	status &= mb_fileiobuffer(verbose, &fileiobuffer);
 
+	int netcdfdeflate = -1;
+	status &= mb_netcdfdeflate(verbose, &netcdfdeflate);
+
+	bool navintcache = false;
+	status &= mb_navintcache(verbose, &navintcache);
+
 	bool flag = false;
 
 	{
 		bool errflg = false;
 		bool help = false;
 		int c;
-		while ((c = getopt(argc, argv, "B:b:D:d:F:f:HhI:i:L:l:M:m:T:t:U:u:VvW:w:")) != -1)
+		while ((c = getopt(argc, argv, "B:b:C:c:D:d:F:f:HhI:i:L:l:M:m:N:n:T:t:U:u:VvW:w:")) != -1)
 		{
 			switch (c) {
 			case 'B':
@@ -137,6 +144,18 @@ int main(int argc, char **argv) {
 				sscanf(optarg, "%d", &fileiobuffer);
 				flag = true;
 				break;
+			case 'C':
+			case 'c':
+			{
+				char argstring[MB_PATH_MAXLINE];
+				sscanf(optarg, "%1023s", argstring);
+				if (strncmp(argstring, "yes", 3) == 0 || strncmp(argstring, "YES", 3) == 0 || strncmp(argstring, "1", 1) == 0)
+					navintcache = true;
+				else if (strncmp(argstring, "no", 2) == 0 || strncmp(argstring, "NO", 2) == 0 || strncmp(argstring, "0", 1) == 0)
+					navintcache = false;
+				flag = true;
+				break;
+			}
 			case 'D':
 			case 'd':
 				sscanf(optarg, "%1023s", psdisplay);
@@ -199,6 +218,12 @@ int main(int argc, char **argv) {
 				flag = true;
 				break;
 			}
+			case 'N':
+			case 'n':
+				sscanf(optarg, "%d", &netcdfdeflate);
+				netcdfdeflate = std::max(-1, std::min(9, netcdfdeflate));
+				flag = true;
+				break;
 			case 'T':
 			case 't':
 				sscanf(optarg, "%lf", &timegap);
@@ -279,6 +304,8 @@ int main(int argc, char **argv) {
 			fprintf(stderr, "dbg2       fbtversion:                 %d\n", fbtversion);
 			fprintf(stderr, "dbg2       uselockfiles:               %d\n", uselockfiles);
 			fprintf(stderr, "dbg2       fileiobuffer:               %d\n", fileiobuffer);
+			fprintf(stderr, "dbg2       netcdfdeflate:              %d\n", netcdfdeflate);
+			fprintf(stderr, "dbg2       navintcache:                %d\n", navintcache);
 			fprintf(stderr, "dbg2       primary_colortable:         %d\n", primary_colortable);
 			fprintf(stderr, "dbg2       primary_colortable_mode:    %d\n", primary_colortable_mode);
 			fprintf(stderr, "dbg2       primary_shade_mode:         %d\n", primary_shade_mode);
@@ -318,6 +345,8 @@ int main(int argc, char **argv) {
 		fprintf(fp, "fbtversion: %d\n", fbtversion);
 		fprintf(fp, "uselockfiles:%d\n", uselockfiles);
 		fprintf(fp, "fileiobuffer:%d\n", fileiobuffer);
+		fprintf(fp, "netcdfdeflate:%d\n", netcdfdeflate);
+		fprintf(fp, "navintcache:%d\n", navintcache);
 		fprintf(fp, "mbview_primary_colortable:        %d\n", primary_colortable);
 		fprintf(fp, "mbview_primary_colortable_mode:   %d\n", primary_colortable_mode);
 		fprintf(fp, "mbview_primary_shade_mode:        %d\n", primary_shade_mode);
@@ -350,6 +379,14 @@ int main(int argc, char **argv) {
 			printf("fileiobuffer: %d (use %d kB buffer for fread() & fwrite())\n", fileiobuffer, fileiobuffer);
 		else
 			printf("fileiobuffer: %d (use mmap for file i/o)\n", fileiobuffer);
+		if (netcdfdeflate < 0)
+			printf("netcdfdeflate: %d (write classic netCDF files)\n", netcdfdeflate);
+		else
+			printf("netcdfdeflate: %d (write NetCDF-4 files, deflate level %d)\n", netcdfdeflate, netcdfdeflate);
+		if (navintcache)
+			printf("navintcache: %d (cache parsed ancillary files)\n", navintcache);
+		else
+			printf("navintcache: %d (do not cache parsed ancillary files)\n", navintcache);
 		if (primary_colortable == MBV_COLORTABLE_HAXBY)
 			printf("mbview primary colortable:    %d  (Haxby)\n", primary_colortable);
 		else if (primary_colortable == MBV_COLORTABLE_BRIGHT)
@@ -440,6 +477,14 @@ int main(int argc, char **argv) {
 			printf("fileiobuffer: %d (use %d kB buffer for fread() & fwrite())\n", fileiobuffer, fileiobuffer);
 		else
 			printf("fileiobuffer: %d (use mmap for file i/o)\n", fileiobuffer);
+		if (netcdfdeflate < 0)
+			printf("netcdfdeflate: %d (write classic netCDF files)\n", netcdfdeflate);
+		else
+			printf("netcdfdeflate: %d (write NetCDF-4 files, deflate level %d)\n", netcdfdeflate, netcdfdeflate);
+		if (navintcache)
+			printf("navintcache: %d (cache parsed ancillary files)\n", navintcache);
+		else
+			printf("navintcache: %d (do not cache parsed ancillary files)\n", navintcache);
 		if (primary_colortable == MBV_COLORTABLE_HAXBY)
 			printf("mbview primary colortable:         %d  (Haxby)\n", primary_colortable);
 		else if (primary_colortable == MBV_COLORTABLE_BRIGHT)
@@ -0,0 +1,334 @@
+/*--------------------------------------------------------------------
+ *    The MB-system:	mbgrdshade.cc	10/19/2026
+ *
+ *    Copyright (c) 2026 by the MB-System Team
+ *
+ *    MB-System was created by Caress and Chayes in 1992 at the
+ *      Lamont-Doherty Earth Observatory
+ *      Columbia University
+ *      Palisades, NY 10964
+ *
+ *    See README.md file for copying and redistribution conditions.
+ *--------------------------------------------------------------------*/
+/*
+ * mbgrdshade renders a color shaded relief image of a GMT grid without
+ * an X display using the same colortables, histogram equalization and
+ * shading as mbview/mbgrdviz. The image is written as a binary PPM file
+ * with an accompanying world file so that it can be georeferenced. The
+ * time spent in each stage of the calculation is reported so that the
+ * program can also be used to benchmark the mb_shade kernels.
+ *
+ * Author:	MB-System Team
+ * Date:	October 19, 2026
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <getopt.h>
+#include <unistd.h>
+
+#include "mb_aux.h"
+#include "mb_define.h"
+#include "mb_status.h"
+
+constexpr char program_name[] = "mbgrdshade";
+constexpr char help_message[] =
+    "mbgrdshade renders a color shaded relief image of a GMT grid using the\n"
+    "\tmbview colortables and shading without requiring an X display. The\n"
+    "\timage is written as a binary PPM file with a world file (.wld).";
+constexpr char usage_message[] =
+    "mbgrdshade -Igrid [-Ooutput -Ccolortable[/mode] -E -Gshade_mode[/magnitude/azimuth/elevation]\n"
+    "\t-Nthreads -Rrepeat -S -Xexaggeration -Zmin/max -V -H]";
+
+/*--------------------------------------------------------------------*/
+
+int main(int argc, char **argv) {
+	int verbose = 0;
+	mb_path gridfile = "";
+	mb_path outputroot = "";
+	bool use_zrange = false;
+	double zmin = 0.0;
+	double zmax = 0.0;
+	int nrepeat = 1;
+	double exaggeration = 1.0;
+	struct mb_shade_struct shade;
+	memset(&shade, 0, sizeof(shade));
+	shade.nthreads = 0;
+	shade.colortable = MB_SHADE_COLORTABLE_HAXBY;
+	shade.colortable_mode = MB_SHADE_COLORTABLE_NORMAL;
+	shade.shade_mode = MB_SHADE_ILLUMINATION;
+	shade.illuminate_magnitude = 1.0;
+	shade.illuminate_azimuth = 315.0;
+	shade.illuminate_elevation = 30.0;
+	shade.slope_magnitude = 1.0;
+	shade.nodata_red = 1.0;
+	shade.nodata_green = 1.0;
+	shade.nodata_blue = 1.0;
+
+	/* process argument list */
+	{
+		bool errflg = false;
+		int c;
+		bool help = false;
+		while ((c = getopt(argc, argv, "C:c:EeG:g:HhI:i:N:n:O:o:R:r:SsVvX:x:Z:z:")) != -1)
+			switch (c) {
+			case 'C':
+			case 'c':
+				sscanf(optarg, "%d/%d", &shade.colortable, &shade.colortable_mode);
+				break;
+			case 'E':
+			case 'e':
+				shade.use_histogram = true;
+				break;
+			case 'G':
+			case 'g':
+				sscanf(optarg, "%d/%lf/%lf/%lf", &shade.shade_mode, &shade.illuminate_magnitude,
+				       &shade.illuminate_azimuth, &shade.illuminate_elevation);
+				shade.slope_magnitude = shade.illuminate_magnitude;
+				break;
+			case 'H':
+			case 'h':
+				help = true;
+				break;
+			case 'I':
+			case 'i':
+				sscanf(optarg, "%1023s", gridfile);
+				break;
+			case 'N':
+			case 'n':
+				sscanf(optarg, "%d", &shade.nthreads);
+				break;
+			case 'O':
+			case 'o':
+				sscanf(optarg, "%1023s", outputroot);
+				break;
+			case 'R':
+			case 'r':
+				sscanf(optarg, "%d", &nrepeat);
+				nrepeat = MAX(nrepeat, 1);
+				break;
+			case 'S':
+			case 's':
+				shade.color_slope = true;
+				break;
+			case 'V':
+			case 'v':
+				verbose++;
+				break;
+			case 'X':
+			case 'x':
+				sscanf(optarg, "%lf", &exaggeration);
+				break;
+			case 'Z':
+			case 'z':
+				if (sscanf(optarg, "%lf/%lf", &zmin, &zmax) == 2)
+					use_zrange = true;
+				break;
+			case '?':
+				errflg = true;
+			}
+
+		if (strlen(gridfile) == 0 && !help)
+			errflg = true;
+
+		if (errflg) {
+			fprintf(stderr, "usage: %s\n", usage_message);
+			fprintf(stderr, "\nProgram <%s> Terminated\n", program_name);
+			exit(MB_ERROR_BAD_USAGE);
+		}
+
+		if (verbose == 1 || help) {
+			fprintf(stderr, "\nProgram %s\n", program_name);
+			fprintf(stderr, "MB-system Version %s\n", MB_VERSION);
+		}
+
+		if (verbose >= 2) {
+			fprintf(stderr, "\ndbg2  Program <%s>\n", program_name);
+			fprintf(stderr, "dbg2  MB-system Version %s\n", MB_VERSION);
+			fprintf(stderr, "dbg2  Control Parameters:\n");
+			fprintf(stderr, "dbg2       verbose:              %d\n", verbose);
+			fprintf(stderr, "dbg2       help:                 %d\n", help);
+			fprintf(stderr, "dbg2       gridfile:             %s\n", gridfile);
+			fprintf(stderr, "dbg2       outputroot:           %s\n", outputroot);
+			fprintf(stderr, "dbg2       nthreads:             %d\n", shade.nthreads);
+			fprintf(stderr, "dbg2       nrepeat:              %d\n", nrepeat);
+			fprintf(stderr, "dbg2       colortable:           %d\n", shade.colortable);
+			fprintf(stderr, "dbg2       colortable_mode:      %d\n", shade.colortable_mode);
+			fprintf(stderr, "dbg2       use_histogram:        %d\n", shade.use_histogram);
+			fprintf(stderr, "dbg2       color_slope:          %d\n", shade.color_slope);
+			fprintf(stderr, "dbg2       shade_mode:           %d\n", shade.shade_mode);
+			fprintf(stderr, "dbg2       illuminate_magnitude: %f\n", shade.illuminate_magnitude);
+			fprintf(stderr, "dbg2       illuminate_azimuth:   %f\n", shade.illuminate_azimuth);
+			fprintf(stderr, "dbg2       illuminate_elevation: %f\n", shade.illuminate_elevation);
+			fprintf(stderr, "dbg2       exaggeration:         %f\n", exaggeration);
+			fprintf(stderr, "dbg2       use_zrange:           %d\n", use_zrange);
+			fprintf(stderr, "dbg2       zmin:                 %f\n", zmin);
+			fprintf(stderr, "dbg2       zmax:                 %f\n", zmax);
+		}
+
+		if (help) {
+			fprintf(stderr, "\n%s\n", help_message);
+			fprintf(stderr, "\nusage: %s\n", usage_message);
+			exit(MB_ERROR_NO_ERROR);
+		}
+	}
+
+	int error = MB_ERROR_NO_ERROR;
+
+	/* read the grid */
+	int grid_projection_mode;
+	mb_path grid_projection_id;
+	float nodatavalue;
+	int nxy, n_columns, n_rows;
+	double min, max, xmin, xmax, ymin, ymax, dx, dy;
+	float *data = nullptr;
+	int status = mb_read_gmt_grd(verbose, gridfile, &grid_projection_mode, grid_projection_id, &nodatavalue, &nxy, &n_columns,
+	                             &n_rows, &min, &max, &xmin, &xmax, &ymin, &ymax, &dx, &dy, &data, nullptr, nullptr, &error);
+	if (status != MB_SUCCESS) {
+		char *message = nullptr;
+		mb_error(verbose, error, &message);
+		fprintf(stderr, "\nUnable to read grid file %s:\n%s\n", gridfile, message);
+		fprintf(stderr, "\nProgram <%s> Terminated\n", program_name);
+		exit(error);
+	}
+
+	/* derivatives are calculated in meters */
+	double dxm = dx;
+	double dym = dy;
+	if (grid_projection_mode == MB_PROJECTION_GEOGRAPHIC) {
+		double mtodeglon, mtodeglat;
+		mb_coor_scale(verbose, 0.5 * (ymin + ymax), &mtodeglon, &mtodeglat);
+		dxm = dx / mtodeglon;
+		dym = dy / mtodeglat;
+	}
+
+	/* allocate the derivative and color arrays */
+	float *dzdx = nullptr;
+	float *dzdy = nullptr;
+	float *red = nullptr;
+	float *green = nullptr;
+	float *blue = nullptr;
+	status = mb_mallocd(verbose, __FILE__, __LINE__, nxy * sizeof(float), (void **)&dzdx, &error);
+	if (status == MB_SUCCESS)
+		status = mb_mallocd(verbose, __FILE__, __LINE__, nxy * sizeof(float), (void **)&dzdy, &error);
+	if (status == MB_SUCCESS)
+		status = mb_mallocd(verbose, __FILE__, __LINE__, nxy * sizeof(float), (void **)&red, &error);
+	if (status == MB_SUCCESS)
+		status = mb_mallocd(verbose, __FILE__, __LINE__, nxy * sizeof(float), (void **)&green, &error);
+	if (status == MB_SUCCESS)
+		status = mb_mallocd(verbose, __FILE__, __LINE__, nxy * sizeof(float), (void **)&blue, &error);
+	if (status != MB_SUCCESS) {
+		char *message = nullptr;
+		mb_error(verbose, error, &message);
+		fprintf(stderr, "\nMBIO Error allocating data arrays:\n%s\n", message);
+		fprintf(stderr, "\nProgram <%s> Terminated\n", program_name);
+		exit(error);
+	}
+
+	/* set up the coloring and shading */
+	shade.scale = exaggeration;
+	shade.min = use_zrange ? zmin : min;
+	shade.max = use_zrange ? zmax : max;
+	mb_shade_setup(verbose, &shade, &error);
+
+	/* render, repeating as requested for benchmarking */
+	double time_derivative = 0.0;
+	double time_histogram = 0.0;
+	double time_shade = 0.0;
+	for (int irepeat = 0; irepeat < nrepeat; irepeat++) {
+		auto t0 = std::chrono::steady_clock::now();
+		mb_shade_derivative(verbose, &shade, n_columns, n_rows, 0, n_columns, nodatavalue, data, nullptr, nullptr, dxm,
+		                    dym, dzdx, dzdy, &error);
+		auto t1 = std::chrono::steady_clock::now();
+
+		/* slope coloring defaults to the range of the slopes */
+		if (shade.color_slope && !use_zrange) {
+			shade.min = 0.0;
+			shade.max = 0.0;
+			for (int k = 0; k < nxy; k++)
+				if (data[k] != nodatavalue)
+					shade.max = MAX(shade.max, sqrt(dzdx[k] * dzdx[k] + dzdy[k] * dzdy[k]));
+		}
+		if (shade.use_histogram)
+			mb_shade_histogram(verbose, shade.nthreads, n_columns, n_rows, nodatavalue, data, dzdx, dzdy, shade.color_slope,
+			                   shade.min, shade.max, shade.histogram, &error);
+		auto t2 = std::chrono::steady_clock::now();
+		mb_shade_grid(verbose, &shade, n_columns, n_rows, nodatavalue, data, dzdx, dzdy, red, green, blue, &error);
+		auto t3 = std::chrono::steady_clock::now();
+
+		time_derivative += std::chrono::duration<double>(t1 - t0).count();
+		time_histogram += std::chrono::duration<double>(t2 - t1).count();
+		time_shade += std::chrono::duration<double>(t3 - t2).count();
+	}
+
+	/* write the image as a binary ppm file with the northern row first */
+	if (strlen(outputroot) > 0) {
+		mb_pathplus imagefile;
+		mb_pathplus worldfile;
+		snprintf(imagefile, sizeof(imagefile), "%s.ppm", outputroot);
+		snprintf(worldfile, sizeof(worldfile), "%s.wld", outputroot);
+		FILE *fp = fopen(imagefile, "wb");
+		if (fp == nullptr) {
+			fprintf(stderr, "\nUnable to open output image file %s\n", imagefile);
+			fprintf(stderr, "\nProgram <%s> Terminated\n", program_name);
+			exit(MB_ERROR_OPEN_FAIL);
+		}
+		fprintf(fp, "P6\n%d %d\n255\n", n_columns, n_rows);
+		unsigned char *row = (unsigned char *)malloc(3 * n_columns);
+		for (int j = n_rows - 1; j >= 0; j--) {
+			for (int i = 0; i < n_columns; i++) {
+				const int k = i * n_rows + j;
+				row[3 * i] = (unsigned char)(255.0 * MAX(0.0, MIN(red[k], 1.0)) + 0.5);
+				row[3 * i + 1] = (unsigned char)(255.0 * MAX(0.0, MIN(green[k], 1.0)) + 0.5);
+				row[3 * i + 2] = (unsigned char)(255.0 * MAX(0.0, MIN(blue[k], 1.0)) + 0.5);
+			}
+			fwrite(row, 3, n_columns, fp);
+		}
+		free(row);
+		fclose(fp);
+
+		/* world file references the center of the upper left pixel */
+		if ((fp = fopen(worldfile, "w")) != nullptr) {
+			fprintf(fp, "%.12f\n0.0\n0.0\n%.12f\n%.12f\n%.12f\n", dx, -dy, xmin, ymax);
+			fclose(fp);
+		}
+		if (verbose > 0)
+			fprintf(stderr, "\nOutput image: %s  world file: %s\n", imagefile, worldfile);
+	}
+
+	/* report timing */
+	const double ncells = (double)nxy * nrepeat;
+	fprintf(stderr, "\n%s: %d x %d grid, %d threads, %d repetitions\n", program_name, n_columns, n_rows,
+	        mb_nthreads(shade.nthreads), nrepeat);
+	fprintf(stderr, "  derivatives:  %10.6f s  %10.2f Mcells/s\n", time_derivative,
+	        time_derivative > 0.0 ? 1.0e-6 * ncells / time_derivative : 0.0);
+	if (shade.use_histogram)
+		fprintf(stderr, "  histogram:    %10.6f s  %10.2f Mcells/s\n", time_histogram,
+		        time_histogram > 0.0 ? 1.0e-6 * ncells / time_histogram : 0.0);
+	fprintf(stderr, "  color+shade:  %10.6f s  %10.2f Mcells/s\n", time_shade,
+	        time_shade > 0.0 ? 1.0e-6 * ncells / time_shade : 0.0);
+
+	/* deallocate arrays */
+	mb_freed(verbose, __FILE__, __LINE__, (void **)&data, &error);
+	mb_freed(verbose, __FILE__, __LINE__, (void **)&dzdx, &error);
+	mb_freed(verbose, __FILE__, __LINE__, (void **)&dzdy, &error);
+	mb_freed(verbose, __FILE__, __LINE__, (void **)&red, &error);
+	mb_freed(verbose, __FILE__, __LINE__, (void **)&green, &error);
+	mb_freed(verbose, __FILE__, __LINE__, (void **)&blue, &error);
+
+	/* check memory */
+	if (verbose >= 4)
+		status &= mb_memory_list(verbose, &error);
+
+	if (verbose >= 2) {
+		fprintf(stderr, "\ndbg2  Program <%s> completed\n", program_name);
+		fprintf(stderr, "dbg2  Ending status:\n");
+		fprintf(stderr, "dbg2       status:  %d\n", status);
+	}
+
+	exit(error);
+}
+/*--------------------------------------------------------------------*/
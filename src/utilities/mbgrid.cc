@@ -127,7 +127,8 @@ constexpr double FOOT_THETA_MAX = 85.0;
     define is defined then
     the code will use the surface algorithm
     from GMT. If not, then the zgrid
-    algorithm will be used.
+    algorithm will be used, solved at full
+    resolution by mb_mgsurface().
     - The default is to use zgrid - to
     change this uncomment the define below. */
 /* #define USESURFACE */
@@ -874,9 +875,6 @@ int main(int argc, char **argv) {
 #else
   float *bdata = nullptr;
   float *sdata = nullptr;
-  float *work1 = nullptr;
-  int *work2 = nullptr;
-  bool *work3 = nullptr;
 #endif
   double bdata_origin_x, bdata_origin_y;
   float *output = nullptr;
@@ -2046,12 +2044,6 @@ int main(int argc, char **argv) {
     status = mb_mallocd(verbose, __FILE__, __LINE__, 3 * ndata * sizeof(float), (void **)&sdata, &error);
     if (status == MB_SUCCESS)
       status = mb_mallocd(verbose, __FILE__, __LINE__, sxdim * sydim * sizeof(float), (void **)&sgrid, &error);
-    if (status == MB_SUCCESS)
-      status = mb_mallocd(verbose, __FILE__, __LINE__, ndata * sizeof(float), (void **)&work1, &error);
-    if (status == MB_SUCCESS)
-      status = mb_mallocd(verbose, __FILE__, __LINE__, ndata * sizeof(int), (void **)&work2, &error);
-    if (status == MB_SUCCESS)
-      status = mb_mallocd(verbose, __FILE__, __LINE__, (sxdim + sydim) * sizeof(bool), (void **)&work3, &error);
     if (error != MB_ERROR_NO_ERROR) {
       char *message = nullptr;
       mb_error(verbose, MB_ERROR_MEMORY_FAIL, &message);
@@ -2062,9 +2054,6 @@ int main(int argc, char **argv) {
     }
     memset((char *)sgrid, 0, sxdim * sydim * sizeof(float));
     memset((char *)sdata, 0, 3 * ndata * sizeof(float));
-    memset((char *)work1, 0, ndata * sizeof(float));
-    memset((char *)work2, 0, ndata * sizeof(int));
-    memset((char *)work3, 0, (sxdim + sydim) * sizeof(bool));
 
     /* get points from grid */
     /* simultaneously find the depth values nearest to the grid corners and edge midpoints */
@@ -2081,13 +2070,24 @@ int main(int argc, char **argv) {
     ndata = ndata / 3;
 
     /* do the interpolation */
-    float cay = (float)tension;
-    float xmin = (float)(wbnd[0] - 0.5 * sdx - bdata_origin_x);
-    float ymin = (float)(wbnd[2] - 0.5 * sdy - bdata_origin_y);
-    float ddx = (float)sdx;
-    float ddy = (float)sdy;
+    const float xmin = (float)(wbnd[0] - 0.5 * sdx - bdata_origin_x);
+    const float ymin = (float)(wbnd[2] - 0.5 * sdy - bdata_origin_y);
+    const float ddx = (float)sdx;
+    const float ddy = (float)sdy;
+    struct mb_mgsurface_struct mgsurface;
+    memset(&mgsurface, 0, sizeof(struct mb_mgsurface_struct));
+    mgsurface.tension = tension;
+    mgsurface.clip = sclip;
     fprintf(outfp, "\nDoing Zgrid spline interpolation with %d data points...\n", ndata);
-    mb_zgrid2(sgrid, &sxdim, &sydim, &xmin, &ymin, &ddx, &ddy, sdata, &ndata, work1, work2, work3, &cay, &sclip);
+    status = mb_mgsurface(verbose, &mgsurface, sxdim, sydim, xmin, ymin, ddx, ddy, ndata, sdata, sgrid, &error);
+    if (status != MB_SUCCESS) {
+      char *message = nullptr;
+      mb_error(verbose, error, &message);
+      fprintf(outfp, "\nMBIO Error during low resolution spline interpolation:\n%s\n", message);
+      fprintf(outfp, "\nProgram <%s> Terminated\n", program_name);
+      mb_memory_clear(verbose, &memclear_error);
+      exit(error);
+    }
 #endif
 
     // float zflag = 5.0e34f;
@@ -2111,9 +2111,6 @@ int main(int argc, char **argv) {
     mb_freed(verbose, __FILE__, __LINE__, (void **)&szdata, &error);
 #else
     mb_freed(verbose, __FILE__, __LINE__, (void **)&sdata, &error);
-    mb_freed(verbose, __FILE__, __LINE__, (void **)&work1, &error);
-    mb_freed(verbose, __FILE__, __LINE__, (void **)&work2, &error);
-    mb_freed(verbose, __FILE__, __LINE__, (void **)&work3, &error);
 #endif
     mb_freed(verbose, __FILE__, __LINE__, (void **)&sgrid, &error);
 
@@ -5143,12 +5140,6 @@ int main(int argc, char **argv) {
     status = mb_mallocd(verbose, __FILE__, __LINE__, 3 * ndata * sizeof(float), (void **)&sdata, &error);
     if (status == MB_SUCCESS)
       status = mb_mallocd(verbose, __FILE__, __LINE__, gxdim * gydim * sizeof(float), (void **)&sgrid, &error);
-    if (status == MB_SUCCESS)
-      status = mb_mallocd(verbose, __FILE__, __LINE__, ndata * sizeof(float), (void **)&work1, &error);
-    if (status == MB_SUCCESS)
-      status = mb_mallocd(verbose, __FILE__, __LINE__, ndata * sizeof(int), (void **)&work2, &error);
-    if (status == MB_SUCCESS)
-      status = mb_mallocd(verbose, __FILE__, __LINE__, (gxdim + gydim) * sizeof(bool), (void **)&work3, &error);
     if (error != MB_ERROR_NO_ERROR) {
       char *message = nullptr;
       mb_error(verbose, MB_ERROR_MEMORY_FAIL, &message);
@@ -5159,9 +5150,6 @@ int main(int argc, char **argv) {
     }
     memset((char *)sgrid, 0, gxdim * gydim * sizeof(float));
     memset((char *)sdata, 0, 3 * ndata * sizeof(float));
-    memset((char *)work1, 0, ndata * sizeof(float));
-    memset((char *)work2, 0, ndata * sizeof(int));
-    memset((char *)work3, 0, (gxdim + gydim) * sizeof(bool));
 
     /* get points from grid */
     /* simultaneously find the depth values nearest to the grid corners and edge midpoints */
@@ -5214,20 +5202,28 @@ int main(int argc, char **argv) {
     ndata = ndata / 3;
 
     /* do the interpolation */
-    float cay = (float)tension;
-    float xmin = (float)(wbnd[0] - 0.5 * dx - bdata_origin_x);
-    float ymin = (float)(wbnd[2] - 0.5 * dy - bdata_origin_y);
-    float ddx = (float)dx;
-    float ddy = (float)dy;
     fprintf(outfp, "\nDoing Zgrid spline interpolation with %d data points...\n", ndata);
-    /*for (i=0;i<ndata/3;i++)
-    {
-    if (sdata[3*i+2]>2000.0)
-    fprintf(stderr,"%d %f\n",i,sdata[3*i+2]);
-    }*/
     if (clipmode == MBGRID_INTERP_ALL)
       clip = std::max(gxdim, gydim);
-    mb_zgrid(sgrid, &gxdim, &gydim, &xmin, &ymin, &ddx, &ddy, sdata, &ndata, work1, work2, work3, &cay, &clip);
+    const float xmin = (float)(wbnd[0] - 0.5 * dx - bdata_origin_x);
+    const float ymin = (float)(wbnd[2] - 0.5 * dy - bdata_origin_y);
+    const float ddx = (float)dx;
+    const float ddy = (float)dy;
+    struct mb_mgsurface_struct mgsurface;
+    memset(&mgsurface, 0, sizeof(struct mb_mgsurface_struct));
+    mgsurface.tension = tension;
+    mgsurface.clip = clip;
+    status = mb_mgsurface(verbose, &mgsurface, gxdim, gydim, xmin, ymin, ddx, ddy, ndata, sdata, sgrid, &error);
+    if (status != MB_SUCCESS) {
+      char *message = nullptr;
+      mb_error(verbose, error, &message);
+      fprintf(outfp, "\nMBIO Error during spline interpolation:\n%s\n", message);
+      fprintf(outfp, "\nProgram <%s> Terminated\n", program_name);
+      mb_memory_clear(verbose, &memclear_error);
+      exit(error);
+    }
+    if (verbose > 0)
+      fprintf(outfp, "Interpolation converged in %d cycles on %d grid levels\n", mgsurface.ncycles, mgsurface.nlevels);
 #endif
 
     if (clipmode == MBGRID_INTERP_GAP)
@@ -5441,9 +5437,6 @@ int main(int argc, char **argv) {
     mb_freed(verbose, __FILE__, __LINE__, (void **)&szdata, &error);
 #else
     mb_freed(verbose, __FILE__, __LINE__, (void **)&sdata, &error);
-    mb_freed(verbose, __FILE__, __LINE__, (void **)&work1, &error);
-    mb_freed(verbose, __FILE__, __LINE__, (void **)&work2, &error);
-    mb_freed(verbose, __FILE__, __LINE__, (void **)&work3, &error);
 #endif
     mb_freed(verbose, __FILE__, __LINE__, (void **)&smask, &error);
     mb_freed(verbose, __FILE__, __LINE__, (void **)&sgrid, &error);
@@ -5468,12 +5461,6 @@ int main(int argc, char **argv) {
     memset((char *)sgrid, 0, gxdim * gydim * sizeof(float));
 #else
     status = mb_mallocd(verbose, __FILE__, __LINE__, gxdim * gydim * sizeof(float), (void **)&sgrid, &error);
-    if (status == MB_SUCCESS)
-      status = mb_mallocd(verbose, __FILE__, __LINE__, nbackground * sizeof(float), (void **)&work1, &error);
-    if (status == MB_SUCCESS)
-      status = mb_mallocd(verbose, __FILE__, __LINE__, nbackground * sizeof(int), (void **)&work2, &error);
-    if (status == MB_SUCCESS)
-      status = mb_mallocd(verbose, __FILE__, __LINE__, (gxdim + gydim) * sizeof(int), (void **)&work3, &error);
     if (error != MB_ERROR_NO_ERROR) {
       char *message = nullptr;
       mb_error(verbose, MB_ERROR_MEMORY_FAIL, &message);
@@ -5483,9 +5470,6 @@ int main(int argc, char **argv) {
       exit(error);
     }
     memset((char *)sgrid, 0, gxdim * gydim * sizeof(float));
-    memset((char *)work1, 0, nbackground * sizeof(float));
-    memset((char *)work2, 0, nbackground * sizeof(int));
-    memset((char *)work3, 0, (gxdim + gydim) * sizeof(int));
 #endif
 
     /* do the interpolation */
@@ -5495,14 +5479,25 @@ int main(int argc, char **argv) {
                (float)(wbnd[1] - bdata_origin_x), (float)(wbnd[2] - bdata_origin_y), (float)(wbnd[3] - bdata_origin_y), dx,
                dy, tension, sgrid);
 #else
-    float cay = (float)tension;
-    float xmin = (float)(wbnd[0] - 0.5 * dx - bdata_origin_x);
-    float ymin = (float)(wbnd[2] - 0.5 * dy - bdata_origin_y);
-    float ddx = (float)dx;
-    float ddy = (float)dy;
     clip = std::max(gxdim, gydim);
     fprintf(outfp, "\nDoing Zgrid spline interpolation with %d background points...\n", nbackground);
-    mb_zgrid(sgrid, &gxdim, &gydim, &xmin, &ymin, &ddx, &ddy, bdata, &nbackground, work1, work2, work3, &cay, &clip);
+    const float xmin = (float)(wbnd[0] - 0.5 * dx - bdata_origin_x);
+    const float ymin = (float)(wbnd[2] - 0.5 * dy - bdata_origin_y);
+    const float ddx = (float)dx;
+    const float ddy = (float)dy;
+    struct mb_mgsurface_struct mgsurface;
+    memset(&mgsurface, 0, sizeof(struct mb_mgsurface_struct));
+    mgsurface.tension = tension;
+    mgsurface.clip = clip;
+    status = mb_mgsurface(verbose, &mgsurface, gxdim, gydim, xmin, ymin, ddx, ddy, nbackground, bdata, sgrid, &error);
+    if (status != MB_SUCCESS) {
+      char *message = nullptr;
+      mb_error(verbose, error, &message);
+      fprintf(outfp, "\nMBIO Error during background spline interpolation:\n%s\n", message);
+      fprintf(outfp, "\nProgram <%s> Terminated\n", program_name);
+      mb_memory_clear(verbose, &memclear_error);
+      exit(error);
+    }
 #endif
 
     /* translate the interpolation into the grid array
@@ -5527,9 +5522,6 @@ int main(int argc, char **argv) {
     mb_freed(verbose, __FILE__, __LINE__, (void **)&bzdata, &error);
 #else
     mb_freed(verbose, __FILE__, __LINE__, (void **)&bdata, &error);
-    mb_freed(verbose, __FILE__, __LINE__, (void **)&work1, &error);
-    mb_freed(verbose, __FILE__, __LINE__, (void **)&work2, &error);
-    mb_freed(verbose, __FILE__, __LINE__, (void **)&work3, &error);
 #endif
     mb_freed(verbose, __FILE__, __LINE__, (void **)&sgrid, &error);
   }
@@ -49,6 +49,10 @@
 #include <limits>
 
 #include <algorithm>
+#include <string>
+#include <vector>
+
+#include <netcdf.h>
 
 #include "mb_define.h"
 #include "mb_format.h"
@@ -94,6 +98,50 @@ int j_secondary_interp = 0;
 double *secondary_time_d = NULL;
 double *secondary_data = NULL;
 
+/* Binary output is collected per column for blocks of records and then
+ * written once per block: as interleaved doubles for plain binary output,
+ * as contiguous column arrays for columnar output, and as netCDF variables,
+ * chunked and deflated at the mbdefaults netcdfdeflate level in NetCDF-4
+ * files, for NetCDF output. */
+typedef enum {
+    MBLIST_BINARY_ROWS = 0,
+    MBLIST_BINARY_COLUMNS = 1,
+    MBLIST_BINARY_NETCDF = 2,
+} binary_mode_t;
+constexpr int MBLIST_BLOCK_RECORDS = 16384;
+constexpr char MBLIST_COLUMNAR_MAGIC[] = "MBLISTC1";
+constexpr int MBLIST_COLUMNAR_DOUBLE = 0;
+constexpr int MBLIST_COLUMNAR_CHAR = 1;
+
+struct mblist_column_struct {
+  std::string name;
+  std::string long_name;
+  std::string units;
+  nc_type type = NC_DOUBLE;
+  bool text = false;  /* fixed width character field */
+  int width = -1;     /* values (or characters) per record, set by the first record */
+  int count = 0;      /* values (or characters) in the current record */
+  std::vector<double> values;
+  std::vector<char> chars;
+  int varid = -1;
+  bool range_warned = false;  /* out of range NetCDF values reported */
+};
+
+struct mblist_binary_struct {
+  binary_mode_t mode = MBLIST_BINARY_ROWS;
+  FILE *fp = nullptr;
+  int ncid = -1;
+  int dimid = -1;
+  int deflate = -1;   /* mbdefaults netcdfdeflate, < 0 for classic netCDF */
+  int column = 0;     /* list entry currently being output */
+  int nrecords = 0;   /* records held in the column buffers */
+  size_t nwritten = 0;
+  bool defined = false;
+  std::vector<mblist_column_struct> columns;
+  std::vector<char> block;
+};
+mblist_binary_struct binary_output;
+
 constexpr char program_name[] = "MBLIST";
 constexpr char help_message[] =
     "MBLIST prints the specified contents of a swath data\n"
@@ -104,7 +152,8 @@ constexpr char usage_message[] =
     "mblist [-Byr/mo/da/hr/mn/sc -C -Ddump_mode -Eyr/mo/da/hr/mn/sc\n"
     "    -Fformat -Gdelimiter -H -Ifile -Jprojection -Kdecimate -Llonflip\n"
     "    -M[beam_start/beam_end | A | X%] -Npixel_start/pixel_end\n"
-    "    -Ooptions -Ppings -Rw/e/s/n -Sspeed -Ttimegap -Ucheck -V -W -Xoutfile -Zsegment]";
+    "    -Ooptions -Ppings -Rw/e/s/n -Sspeed -Ttimegap -Ucheck -V -W -Xoutfile -Zsegment\n"
+    "    --columnar]";
 
 /*--------------------------------------------------------------------*/
 int set_output(int verbose, int beams_bath, int beams_amp, int pixels_ss, bool use_bath, bool use_amp, bool use_ss, dump_mode_t dump_mode,
@@ -397,6 +446,394 @@ int get_bathyslope(int verbose, int ndepths, double *depths, double *depthacross
   return (status);
 }
 /*--------------------------------------------------------------------*/
+void mblist_binary_netcdf_check(int ncstatus, const char *what) {
+  if (ncstatus != NC_NOERR) {
+    fprintf(stderr, "\nNetCDF error %s:\n%s\n", what, nc_strerror(ncstatus));
+    fprintf(stderr, "\nProgram <%s> Terminated\n", program_name);
+    exit(MB_ERROR_WRITE_FAIL);
+  }
+}
+/*--------------------------------------------------------------------*/
+int mblist_binary_init(int verbose, binary_mode_t mode, int n_list, FILE *fp, const char *ncfile, int *error) {
+  if (verbose >= 2) {
+    fprintf(stderr, "\ndbg2  MBlist function <%s> called\n", __func__);
+    fprintf(stderr, "dbg2  Input arguments:\n");
+    fprintf(stderr, "dbg2       verbose:         %d\n", verbose);
+    fprintf(stderr, "dbg2       mode:            %d\n", mode);
+    fprintf(stderr, "dbg2       n_list:          %d\n", n_list);
+    fprintf(stderr, "dbg2       fp:              %p\n", (void *)fp);
+    fprintf(stderr, "dbg2       ncfile:          %s\n", ncfile != nullptr ? ncfile : "");
+  }
+
+  binary_output.mode = mode;
+  binary_output.fp = fp;
+  binary_output.column = 0;
+  binary_output.nrecords = 0;
+  binary_output.nwritten = 0;
+  binary_output.defined = false;
+  binary_output.columns.assign(n_list, mblist_column_struct());
+
+  /* the NetCDF file stays in define mode until the first block of records
+     fixes the number of values in each column */
+  if (mode == MBLIST_BINARY_NETCDF) {
+    mb_netcdfdeflate(verbose, &binary_output.deflate);
+    const int cmode = binary_output.deflate >= 0 ? NC_CLOBBER | NC_NETCDF4 : NC_CLOBBER;
+    mblist_binary_netcdf_check(nc_create(ncfile, cmode, &binary_output.ncid), "creating output file");
+    mblist_binary_netcdf_check(nc_def_dim(binary_output.ncid, "data", NC_UNLIMITED, &binary_output.dimid),
+                               "defining data dimension");
+  }
+
+  const int status = MB_SUCCESS;
+
+  if (verbose >= 2) {
+    fprintf(stderr, "\ndbg2  MBlist function <%s> completed\n", __func__);
+    fprintf(stderr, "dbg2  Return values:\n");
+    fprintf(stderr, "dbg2       error:           %d\n", *error);
+    fprintf(stderr, "dbg2  Return status:\n");
+    fprintf(stderr, "dbg2       status:          %d\n", status);
+  }
+
+  return (status);
+}
+/*--------------------------------------------------------------------*/
+/*
+Write a variable declaration to the CDL header and keep its name and type
+for NetCDF-4 and columnar output.
+*/
+void mblist_cdl_variable(FILE *cdl, int i, nc_type type, const char *variable, const std::string &dimensions) {
+  const char *type_name = "double";
+  if (type == NC_FLOAT)
+    type_name = "float";
+  else if (type == NC_INT)
+    type_name = "long";
+  else if (type == NC_SHORT)
+    type_name = "short";
+  else if (type == NC_CHAR)
+    type_name = "char";
+  fprintf(cdl, "\t%s %s(%s);\n", type_name, variable, dimensions.c_str());
+
+  if ((size_t)i < binary_output.columns.size()) {
+    binary_output.columns[i].name = variable;
+    binary_output.columns[i].type = type;
+  }
+}
+/*--------------------------------------------------------------------*/
+/*
+Write a variable attribute, or a global attribute if variable is null,
+to the CDL header. Long names and units are kept with the output column
+and global attributes go straight to NetCDF-4 output.
+*/
+void mblist_cdl_attribute(FILE *cdl, int i, const char *variable, const char *attribute, const std::string &value) {
+  if (variable == nullptr) {
+    fprintf(cdl, "\t:%s = \"%s\";\n", attribute, value.c_str());
+    if (binary_output.mode == MBLIST_BINARY_NETCDF)
+      mblist_binary_netcdf_check(
+          nc_put_att_text(binary_output.ncid, NC_GLOBAL, attribute, value.size(), value.c_str()),
+          "writing global attribute");
+    return;
+  }
+
+  fprintf(cdl, "\t\t%s:%s = \"%s\";\n", variable, attribute, value.c_str());
+  if ((size_t)i < binary_output.columns.size()) {
+    if (strcmp(attribute, "long_name") == 0)
+      binary_output.columns[i].long_name = value;
+    else if (strcmp(attribute, "units") == 0)
+      binary_output.columns[i].units = value;
+  }
+}
+/*--------------------------------------------------------------------*/
+void mblist_binary_value(double value) {
+  mblist_column_struct &column = binary_output.columns[binary_output.column];
+  column.values.push_back(value);
+  column.count++;
+}
+/*--------------------------------------------------------------------*/
+void mblist_binary_text(const char *text, int size) {
+  mblist_column_struct &column = binary_output.columns[binary_output.column];
+  const size_t length = std::min(strlen(text), (size_t)size);
+  column.chars.insert(column.chars.end(), text, text + length);
+  column.chars.insert(column.chars.end(), size - length, '\0');
+  column.text = true;
+  column.count += size;
+}
+/*--------------------------------------------------------------------*/
+/*
+Define the NetCDF variables or write the columnar file header once the
+first record has fixed the number of values in each column.
+*/
+int mblist_binary_define(int verbose, int *error) {
+  if (verbose >= 2) {
+    fprintf(stderr, "\ndbg2  MBlist function <%s> called\n", __func__);
+    fprintf(stderr, "dbg2  Input arguments:\n");
+    fprintf(stderr, "dbg2       verbose:         %d\n", verbose);
+  }
+
+  if (binary_output.mode == MBLIST_BINARY_NETCDF) {
+    const int ncid = binary_output.ncid;
+    for (size_t i = 0; i < binary_output.columns.size(); i++) {
+      mblist_column_struct &column = binary_output.columns[i];
+      if (column.width <= 0)
+        continue;
+
+      /* unnamed or repeated list entries get the list position appended */
+      std::string name = column.name.empty() ? std::string("column") : column.name;
+      int varid;
+      if (column.name.empty() || nc_inq_varid(ncid, name.c_str(), &varid) == NC_NOERR)
+        name += "_" + std::to_string(i);
+
+      int dimids[2] = {binary_output.dimid, -1};
+      int ndims = 1;
+      if (column.width > 1) {
+        mblist_binary_netcdf_check(nc_def_dim(ncid, (name + (column.text ? "_length" : "_fields")).c_str(),
+                                              column.width, &dimids[1]),
+                                   "defining variable dimension");
+        ndims = 2;
+      }
+      const nc_type type =
+          column.text ? NC_CHAR : (column.width > 1 || column.type == NC_CHAR ? NC_DOUBLE : column.type);
+      mblist_binary_netcdf_check(nc_def_var(ncid, name.c_str(), type, ndims, dimids, &column.varid), "defining variable");
+      if (binary_output.deflate >= 0) {
+        const size_t chunks[2] = {(size_t)MBLIST_BLOCK_RECORDS, (size_t)column.width};
+        mblist_binary_netcdf_check(nc_def_var_chunking(ncid, column.varid, NC_CHUNKED, chunks), "setting chunking");
+      }
+      if (binary_output.deflate > 0)
+        mblist_binary_netcdf_check(nc_def_var_deflate(ncid, column.varid, 1, 1, binary_output.deflate),
+                                   "setting compression");
+      if (!column.long_name.empty())
+        mblist_binary_netcdf_check(
+            nc_put_att_text(ncid, column.varid, "long_name", column.long_name.size(), column.long_name.c_str()),
+            "writing long_name attribute");
+      if (!column.units.empty())
+        mblist_binary_netcdf_check(nc_put_att_text(ncid, column.varid, "units", column.units.size(), column.units.c_str()),
+                                   "writing units attribute");
+    }
+    mblist_binary_netcdf_check(nc_enddef(ncid), "leaving define mode");
+  }
+
+  /* columnar file header: magic, byte order mark, number of columns, then
+     type, width and name of each column, all in native byte order */
+  else if (binary_output.mode == MBLIST_BINARY_COLUMNS) {
+    FILE *fp = binary_output.fp;
+    int ncolumns = 0;
+    for (const auto &column : binary_output.columns)
+      if (column.width > 0)
+        ncolumns++;
+    const int byte_order = 1;
+    fwrite(MBLIST_COLUMNAR_MAGIC, 1, strlen(MBLIST_COLUMNAR_MAGIC), fp);
+    fwrite(&byte_order, sizeof(int), 1, fp);
+    fwrite(&ncolumns, sizeof(int), 1, fp);
+    for (size_t i = 0; i < binary_output.columns.size(); i++) {
+      const mblist_column_struct &column = binary_output.columns[i];
+      if (column.width <= 0)
+        continue;
+      const std::string name = column.name.empty() ? "column_" + std::to_string(i) : column.name;
+      const int type = column.text ? MBLIST_COLUMNAR_CHAR : MBLIST_COLUMNAR_DOUBLE;
+      const int name_length = name.size();
+      fwrite(&type, sizeof(int), 1, fp);
+      fwrite(&column.width, sizeof(int), 1, fp);
+      fwrite(&name_length, sizeof(int), 1, fp);
+      fwrite(name.c_str(), 1, name_length, fp);
+    }
+  }
+
+  binary_output.defined = true;
+
+  const int status = MB_SUCCESS;
+
+  if (verbose >= 2) {
+    fprintf(stderr, "\ndbg2  MBlist function <%s> completed\n", __func__);
+    fprintf(stderr, "dbg2  Return values:\n");
+    fprintf(stderr, "dbg2       error:           %d\n", *error);
+    fprintf(stderr, "dbg2  Return status:\n");
+    fprintf(stderr, "dbg2       status:          %d\n", status);
+  }
+
+  return (status);
+}
+/*--------------------------------------------------------------------*/
+int mblist_binary_flush(int verbose, int *error) {
+  if (verbose >= 2) {
+    fprintf(stderr, "\ndbg2  MBlist function <%s> called\n", __func__);
+    fprintf(stderr, "dbg2  Input arguments:\n");
+    fprintf(stderr, "dbg2       verbose:         %d\n", verbose);
+    fprintf(stderr, "dbg2       nrecords:        %d\n", binary_output.nrecords);
+  }
+
+  int status = MB_SUCCESS;
+  const size_t nrecords = binary_output.nrecords;
+
+  if (!binary_output.defined)
+    status = mblist_binary_define(verbose, error);
+
+  if (nrecords > 0 && binary_output.mode == MBLIST_BINARY_ROWS) {
+    /* interleave the columns into one buffer and write it at once */
+    size_t record_size = 0;
+    for (const auto &column : binary_output.columns)
+      if (column.width > 0)
+        record_size += column.text ? column.width : column.width * sizeof(double);
+    binary_output.block.resize(nrecords * record_size);
+    char *ptr = binary_output.block.data();
+    for (size_t irec = 0; irec < nrecords; irec++) {
+      for (const auto &column : binary_output.columns) {
+        if (column.width <= 0)
+          continue;
+        if (column.text) {
+          memcpy(ptr, &column.chars[irec * column.width], column.width);
+          ptr += column.width;
+        }
+        else {
+          memcpy(ptr, &column.values[irec * column.width], column.width * sizeof(double));
+          ptr += column.width * sizeof(double);
+        }
+      }
+    }
+    if (fwrite(binary_output.block.data(), 1, binary_output.block.size(), binary_output.fp) != binary_output.block.size()) {
+      status = MB_FAILURE;
+      *error = MB_ERROR_WRITE_FAIL;
+    }
+  }
+  else if (nrecords > 0 && binary_output.mode == MBLIST_BINARY_COLUMNS) {
+    /* block of records: record count then each column contiguously */
+    const long long block_records = nrecords;
+    fwrite(&block_records, sizeof(long long), 1, binary_output.fp);
+    for (const auto &column : binary_output.columns) {
+      if (column.width <= 0)
+        continue;
+      const size_t n = nrecords * column.width;
+      const size_t nwrite = column.text ? fwrite(column.chars.data(), 1, n, binary_output.fp)
+                                        : fwrite(column.values.data(), sizeof(double), n, binary_output.fp);
+      if (nwrite != n) {
+        status = MB_FAILURE;
+        *error = MB_ERROR_WRITE_FAIL;
+      }
+    }
+  }
+  else if (nrecords > 0 && binary_output.mode == MBLIST_BINARY_NETCDF) {
+    for (auto &column : binary_output.columns) {
+      if (column.width <= 0)
+        continue;
+      const size_t start[2] = {binary_output.nwritten, 0};
+      const size_t count[2] = {nrecords, (size_t)column.width};
+      int ncstatus;
+      if (column.text) {
+        ncstatus = nc_put_vara_text(binary_output.ncid, column.varid, start, count, column.chars.data());
+      }
+      else {
+        /* missing values (NaN) of integer variables are written as the
+           default _FillValue */
+        nc_type type = NC_DOUBLE;
+        nc_inq_vartype(binary_output.ncid, column.varid, &type);
+        if (type == NC_INT || type == NC_SHORT) {
+          const double fill = type == NC_INT ? NC_FILL_INT : NC_FILL_SHORT;
+          for (auto &value : column.values)
+            if (std::isnan(value))
+              value = fill;
+        }
+        ncstatus = nc_put_vara_double(binary_output.ncid, column.varid, start, count, column.values.data());
+      }
+
+      /* other values outside the range of integer variables are reported
+         once per variable but the rest of the output is still written */
+      if (ncstatus == NC_ERANGE) {
+        if (!column.range_warned) {
+          char name[NC_MAX_NAME + 1] = "";
+          nc_inq_varname(binary_output.ncid, column.varid, name);
+          fprintf(stderr, "Values of variable %s are out of range for its type and were not written correctly\n", name);
+          column.range_warned = true;
+        }
+      }
+      else {
+        mblist_binary_netcdf_check(ncstatus, "writing variable");
+      }
+    }
+  }
+
+  for (auto &column : binary_output.columns) {
+    column.values.clear();
+    column.chars.clear();
+  }
+  binary_output.nwritten += nrecords;
+  binary_output.nrecords = 0;
+
+  if (verbose >= 2) {
+    fprintf(stderr, "\ndbg2  MBlist function <%s> completed\n", __func__);
+    fprintf(stderr, "dbg2  Return values:\n");
+    fprintf(stderr, "dbg2       nwritten:        %zu\n", binary_output.nwritten);
+    fprintf(stderr, "dbg2       error:           %d\n", *error);
+    fprintf(stderr, "dbg2  Return status:\n");
+    fprintf(stderr, "dbg2       status:          %d\n", status);
+  }
+
+  return (status);
+}
+/*--------------------------------------------------------------------*/
+int mblist_binary_record(int verbose, int *error) {
+  int status = MB_SUCCESS;
+
+  /* the first record fixes the number of values in each column; later
+     records that differ are padded with NaN or truncated so that the
+     columns stay aligned */
+  for (size_t i = 0; i < binary_output.columns.size(); i++) {
+    mblist_column_struct &column = binary_output.columns[i];
+    if (column.width < 0)
+      column.width = column.count;
+    if (column.count != column.width) {
+      if (verbose > 0)
+        fprintf(stderr, "Column %zu record %zu has %d values rather than %d\n", i,
+                binary_output.nwritten + binary_output.nrecords, column.count, column.width);
+      const size_t size = (size_t)(binary_output.nrecords + 1) * column.width;
+      if (column.text)
+        column.chars.resize(size, '\0');
+      else
+        column.values.resize(size, std::numeric_limits<double>::quiet_NaN());
+    }
+    column.count = 0;
+  }
+  binary_output.column = 0;
+  binary_output.nrecords++;
+
+  if (binary_output.nrecords >= MBLIST_BLOCK_RECORDS)
+    status = mblist_binary_flush(verbose, error);
+
+  return (status);
+}
+/*--------------------------------------------------------------------*/
+int mblist_binary_close(int verbose, int *error) {
+  if (verbose >= 2) {
+    fprintf(stderr, "\ndbg2  MBlist function <%s> called\n", __func__);
+    fprintf(stderr, "dbg2  Input arguments:\n");
+    fprintf(stderr, "dbg2       verbose:         %d\n", verbose);
+  }
+
+  /* columns that never received a record are left out */
+  for (auto &column : binary_output.columns)
+    if (column.width < 0)
+      column.width = 0;
+  int status = mblist_binary_flush(verbose, error);
+
+  if (binary_output.mode == MBLIST_BINARY_COLUMNS) {
+    const long long end_of_data = 0;
+    fwrite(&end_of_data, sizeof(long long), 1, binary_output.fp);
+    if (binary_output.fp != stdout)
+      fclose(binary_output.fp);
+  }
+  else if (binary_output.mode == MBLIST_BINARY_NETCDF) {
+    mblist_binary_netcdf_check(nc_close(binary_output.ncid), "closing output file");
+  }
+  binary_output.columns.clear();
+
+  if (verbose >= 2) {
+    fprintf(stderr, "\ndbg2  MBlist function <%s> completed\n", __func__);
+    fprintf(stderr, "dbg2  Return values:\n");
+    fprintf(stderr, "dbg2       nwritten:        %zu\n", binary_output.nwritten);
+    fprintf(stderr, "dbg2       error:           %d\n", *error);
+    fprintf(stderr, "dbg2  Return status:\n");
+    fprintf(stderr, "dbg2       status:          %d\n", status);
+  }
+
+  return (status);
+}
+/*--------------------------------------------------------------------*/
 int printsimplevalue(int verbose, FILE *output, double value, int width, int precision, bool ascii, bool *invert, bool *flipsign,
                      int *error) {
   if (verbose >= 2) {
@@ -438,7 +875,7 @@ int printsimplevalue(int verbose, FILE *output, double value, int width, int pre
   if (ascii)
     fprintf(output, format, value);
   else
-    fwrite(&value, sizeof(double), 1, output);
+    mblist_binary_value(value);
 
   const int status = MB_SUCCESS;
 
@@ -476,8 +913,7 @@ int printNaN(int verbose, FILE *output, bool ascii, bool *invert, bool *flipsign
   if (ascii) {
     fprintf(output, "NaN");
   } else {
-    const double NaN = std::numeric_limits<double>::quiet_NaN();
-    fwrite(&NaN, sizeof(double), 1, output);
+    mblist_binary_value(std::numeric_limits<double>::quiet_NaN());
   }
 
   const int status = MB_SUCCESS;
@@ -797,6 +1233,7 @@ int main(int argc, char **argv) {
   bool ascii = true;
   bool netcdf = false;
   bool netcdf_cdl = true;
+  bool columnar = false;
   dump_mode_t dump_mode = DUMP_MODE_LIST;
   beam_set_t beam_set = MBLIST_SET_OFF;
   int pixel_set = MBLIST_SET_OFF;  // TODO(schwehr): Is this really beam_set_t?
@@ -828,10 +1265,22 @@ int main(int argc, char **argv) {
     bool errflg = false;
     bool help = false;
     int c;
-    while ((c = getopt(argc, argv, "AaB:b:CcD:d:E:e:F:f:G:g:I:i:J:j:K:k:L:l:M:m:N:n:O:o:P:p:QqR:r:S:s:T:t:U:u:X:x:Y:y:Z:z:VvWwHh")) !=
-           -1)
+    const struct option options[] =
+        {{"columnar", no_argument, nullptr, 0},
+         {nullptr, 0, nullptr, 0}};
+    int option_index;
+    while ((c = getopt_long(argc, argv, "AaB:b:CcD:d:E:e:F:f:G:g:I:i:J:j:K:k:L:l:M:m:N:n:O:o:P:p:QqR:r:S:s:T:t:U:u:X:x:Y:y:Z:z:VvWwHh",
+                            options, &option_index)) != -1)
     {
       switch (c) {
+      /* long options */
+      case 0:
+        if (strcmp("columnar", options[option_index].name) == 0) {
+          columnar = true;
+          ascii = false;
+          netcdf_cdl = false;
+        }
+        break;
       case 'H':
       case 'h':
         help = true;
@@ -1049,6 +1498,7 @@ int main(int argc, char **argv) {
       fprintf(stderr, "dbg2       ascii:          %d\n", ascii);
       fprintf(stderr, "dbg2       netcdf:         %d\n", netcdf);
       fprintf(stderr, "dbg2       netcdf_cdl:     %d\n", netcdf_cdl);
+      fprintf(stderr, "dbg2       columnar:       %d\n", columnar);
       fprintf(stderr, "dbg2       segment:        %d\n", segment);
       fprintf(stderr, "dbg2       segment_mode:   %d\n", segment_mode);
       fprintf(stderr, "dbg2       segment_tag:    %s\n", segment_tag);
@@ -1344,7 +1794,6 @@ int main(int argc, char **argv) {
 
   int nbeams;
 
-  char output_file_temp[2*MB_PATH_MAXLINE+20] = "";
 
   /* netcdf variables */
   int lcount = 0;
@@ -1360,7 +1809,7 @@ int main(int argc, char **argv) {
   bool invert_next_value = false;
 
   FILE *outfile;
-  if (!netcdf) {
+  if (!netcdf && !columnar) {
     if (0 == strncmp("-", output_file, 2))
       outfile = stdout;
     else
@@ -1373,6 +1822,10 @@ int main(int argc, char **argv) {
     /* for non netcdf all output goes to the same file */
     for (int i = 0; i < n_list; i++)
       output[i] = outfile;
+
+    /* binary output is buffered by column and written a block at a time */
+    if (!ascii)
+      mblist_binary_init(verbose, MBLIST_BINARY_ROWS, n_list, outfile, nullptr, &error);
   }
   else {
     /* netcdf must be ascii and must not be segmented */
@@ -1380,20 +1833,40 @@ int main(int argc, char **argv) {
     segment = false;
 
     /* open CDL file */
-    if (0 == strncmp("-", output_file, 2) && !netcdf_cdl)
-      strcpy(output_file, "mblist.nc");
-    if (0 == strncmp("-", output_file, 2)) {
-      outfile = stdout;
+    if (netcdf_cdl) {
+      if (0 == strncmp("-", output_file, 2)) {
+        outfile = stdout;
+      }
+      else {
+        outfile = fopen(output_file, "w+");
+        if (outfile == nullptr) {
+          fprintf(stderr, "Unable to open file: %s\n", output_file);
+          exit(1);
+        }
+      }
     }
+
+    /* NetCDF-4 and columnar output are written directly from the column
+       buffers - the CDL header written here is discarded */
     else {
-      strncpy(output_file_temp, output_file, MB_PATH_MAXLINE - 5);
-      if (!netcdf_cdl)
-        strcat(output_file_temp, ".cdl");
-      outfile = fopen(output_file_temp, "w+");
+      outfile = tmpfile();
       if (outfile == nullptr) {
-        fprintf(stderr, "Unable to open file: %s\n", output_file_temp);
+        fprintf(stderr, "Unable to open temp files\n");
         exit(1);
       }
+      if (netcdf) {
+        if (0 == strncmp("-", output_file, 2))
+          strcpy(output_file, "mblist.nc");
+        mblist_binary_init(verbose, MBLIST_BINARY_NETCDF, n_list, nullptr, output_file, &error);
+      }
+      else {
+        FILE *fp = stdout;
+        if (0 != strncmp("-", output_file, 2) && (fp = fopen(output_file, "w")) == nullptr) {
+          fprintf(stderr, "Unable to open file: %s\n", output_file);
+          exit(1);
+        }
+        mblist_binary_init(verbose, MBLIST_BINARY_COLUMNS, n_list, fp, nullptr, &error);
+      }
     }
 
     /* output CDL headers */
@@ -1425,16 +1898,18 @@ int main(int argc, char **argv) {
       }
 
     fprintf(outfile, "\n\tdata = unlimited ;\n\n");
-    fprintf(outfile, "variables:\n\t");
-    fprintf(outfile, ":command_line = \"");
+    fprintf(outfile, "variables:\n");
+    std::string command_line;
     for (int i = 0; i < argc; i++)
-      fprintf(outfile, "%s ", argv[i]);
-    fprintf(outfile, "\";\n");
-    fprintf(outfile, "\t:mbsystem_version = \"%s\";\n", MB_VERSION);
+      command_line += std::string(argv[i]) + " ";
+    mblist_cdl_attribute(outfile, -1, nullptr, "command_line", command_line);
+    mblist_cdl_attribute(outfile, -1, nullptr, "mbsystem_version", MB_VERSION);
 
     char user[256], host[256], date[32];
     status = mb_user_host_date(verbose, user, host, date, &error);
-    fprintf(outfile, "\t:run = \"by <%s> on cpu <%s> at <%s>\";\n\n", user, host, date);
+    mblist_cdl_attribute(outfile, -1, nullptr, "run",
+                         std::string("by <") + user + "> on cpu <" + host + "> at <" + date + ">");
+    fprintf(outfile, "\n");
 
     /* get temporary output file for each variable */
     for (int i = 0; i < n_list; i++) {
@@ -1445,6 +1920,7 @@ int main(int argc, char **argv) {
       }
 
       char variable[MB_PATH_MAXLINE] = "";  // TODO(schwehr): Localize to all the use sites.
+      std::string units;
       if (!raw_next_value && !ttimes_next_value) {
         switch (list[i]) {
         case '/': /* Inverts next simple value */
@@ -1492,15 +1968,14 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Average seafloor crosstrack slope\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Average seafloor crosstrack slope");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "tangent of angle from seafloor to vertical\";\n");
+            units += "tangent of angle from seafloor to vertical";
           else
-            fprintf(outfile, "tangent of angle from seafloor to horizontal\";\n");
+            units += "tangent of angle from seafloor to horizontal";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -1515,15 +1990,14 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Per-beam seafloor crosstrack slope\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Per-beam seafloor crosstrack slope");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "tangent of angle from seafloor to vertical\";\n");
+            units += "tangent of angle from seafloor to vertical";
           else
-            fprintf(outfile, "tangent of angle from seafloor to horizontal\";\n");
+            units += "tangent of angle from seafloor to horizontal";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -1538,17 +2012,16 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Amplitude\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Amplitude");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
+            units += "1/";
           if (format == MBF_EM300RAW || format == MBF_EM300MBA)
-            fprintf(outfile, "dB + 64\";\n");
+            units += "dB + 64";
           else
-            fprintf(outfile, "backscatter\";\n");
+            units += "backscatter";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -1564,17 +2037,16 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"sidescan\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "sidescan");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
+            units += "1/";
           if (format == MBF_EM300RAW || format == MBF_EM300MBA)
-            fprintf(outfile, "dB + 64\";\n");
+            units += "dB + 64";
           else
-            fprintf(outfile, "backscatter\";\n");
+            units += "backscatter";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -1590,14 +2062,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Sonar altitude\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Sonar altitude");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "m\";\n");
+            units += "1/";
+          units += "m";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -1613,14 +2084,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Sonar transducer depth\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Sonar transducer depth");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "m\";\n");
+            units += "1/";
+          units += "m";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -1636,17 +2106,16 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Acrosstrack distance\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Acrosstrack distance");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
+            units += "1/";
           if (bathy_in_feet)
-            fprintf(outfile, "f\";\n");
+            units += "f";
           else
-            fprintf(outfile, "m\";\n");
+            units += "m";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -1662,17 +2131,16 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Alongtrack distance\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Alongtrack distance");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
+            units += "1/";
           if (bathy_in_feet)
-            fprintf(outfile, "f\";\n");
+            units += "f";
           else
-            fprintf(outfile, "m\";\n");
+            units += "m";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -1689,17 +2157,16 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Beamflag\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Beamflag");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
+            units += "1/";
           if (bathy_in_feet)
-            fprintf(outfile, "f\";\n");
+            units += "f";
           else
-            fprintf(outfile, "m\";\n");
+            units += "m";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -1715,15 +2182,14 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Flat bottom grazing angle\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Flat bottom grazing angle");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "tangent of angle from beam to vertical\";\n");
+            units += "tangent of angle from beam to vertical";
           else
-            fprintf(outfile, "tangent of angle from beam to horizontal\";\n");
+            units += "tangent of angle from beam to horizontal";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -1738,15 +2204,14 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Grazing angle using slope\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Grazing angle using slope");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "tangent of angle from beam to perpendicular to seafloor\";\n");
+            units += "tangent of angle from beam to perpendicular to seafloor";
           else
-            fprintf(outfile, "tangent of angle from beam to seafloor\";\n");
+            units += "tangent of angle from beam to seafloor";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -1761,14 +2226,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Heading\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Heading");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "degrees true\";\n");
+            units += "1/";
+          units += "degrees true";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -1783,14 +2247,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Course\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Course");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "degrees true\";\n");
+            units += "1/";
+          units += "degrees true";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -1801,11 +2264,10 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tlong %s(data,timefields_J);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Time - year julian_day hour minute seconds\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_INT, variable, "data,timefields_J");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Time - year julian_day hour minute seconds");
 
-          fprintf(outfile, "year, julian day, hour, minute, second, nanosecond\";\n");
+          units += "year, julian day, hour, minute, second, nanosecond";
           break;
 
         case 'j': /* time string */
@@ -1813,20 +2275,18 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tlong %s(data,timefields_j);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Time - year julian_day minute seconds\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_INT, variable, "data,timefields_j");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Time - year julian_day minute seconds");
 
-          fprintf(outfile, "year, julian day, minute, second, nanosecond\";\n");
+          units += "year, julian day, minute, second, nanosecond";
           break;
 
         case 'K': /* proportion of non-null beams that are unflagged */
           strcpy(variable, "goodbeamfraction");
           fprintf(output[i], "\t%s = ", variable);
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Good beam fraction of non-null beams\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
-          fprintf(outfile, "number of good beams divided by number of non-null beams\";\n");
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Good beam fraction of non-null beams");
+          units += "number of good beams divided by number of non-null beams";
           signflip_next_value = false;
           invert_next_value = false;
           break;
@@ -1834,10 +2294,9 @@ int main(int argc, char **argv) {
         case 'k': /* proportion of all possible beams that are unflagged */
           strcpy(variable, "goodbeamfractionall");
           fprintf(output[i], "\t%s = ", variable);
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Good beam fraction of all possible beams\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
-          fprintf(outfile, "number of good beams divided by number of possible beams\";\n");
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Good beam fraction of all possible beams");
+          units += "number of good beams divided by number of possible beams";
           signflip_next_value = false;
           invert_next_value = false;
           break;
@@ -1851,14 +2310,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Alongtrack distance\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Alongtrack distance");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "km\";\n");
+            units += "1/";
+          units += "km";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -1874,14 +2332,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Alongtrack distance\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Alongtrack distance");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "m\";\n");
+            units += "1/";
+          units += "m";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -1897,14 +2354,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tdouble %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Seconds since 1/1/70 00:00:00\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_DOUBLE, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Seconds since 1/1/70 00:00:00");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "s\";\n");
+            units += "1/";
+          units += "s";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -1921,14 +2377,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tdouble %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Seconds since first record\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_DOUBLE, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Seconds since first record");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "s\";\n");
+            units += "1/";
+          units += "s";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -1939,10 +2394,9 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tlong %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Ping counter\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
-          fprintf(outfile, "pings\";\n");
+          mblist_cdl_variable(outfile, i, NC_INT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Ping counter");
+          units += "pings";
           break;
 
         case 'P': /* pitch */
@@ -1954,14 +2408,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Pitch\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Pitch");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "degrees from horizontal\";\n");
+            units += "1/";
+          units += "degrees from horizontal";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -1976,14 +2429,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Draft\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Draft");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "m\";\n");
+            units += "1/";
+          units += "m";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -1995,10 +2447,9 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tlong %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Bottom detect type\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
-          fprintf(outfile, "0=unknown,1=amplitude,2=phase\";\n");
+          mblist_cdl_variable(outfile, i, NC_INT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Bottom detect type");
+          units += "0=unknown,1=amplitude,2=phase";
           break;
 
         case 'R': /* roll */
@@ -2010,14 +2461,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Roll\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Roll");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "degrees from horizontal\";\n");
+            units += "1/";
+          units += "degrees from horizontal";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2032,14 +2482,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Heave\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Heave");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "m\";\n");
+            units += "1/";
+          units += "m";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2054,14 +2503,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Speed\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Speed");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "km/hr\";\n");
+            units += "1/";
+          units += "km/hr";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2076,14 +2524,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Speed made good\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Speed made good");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "km/hr\";\n");
+            units += "1/";
+          units += "km/hr";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2094,11 +2541,10 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tchar %s(data,timestring);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Time string - year/month/day/hour/minute/seconds\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_CHAR, variable, "data,timestring");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Time string - year/month/day/hour/minute/seconds");
 
-          fprintf(outfile, "yyyy/MM/dd/hh/mm/ss.ssssss\";\n");
+          units += "yyyy/MM/dd/hh/mm/ss.ssssss";
           break;
 
         case 't': /* yyyy mm dd hh mm ss time string */
@@ -2106,11 +2552,10 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tlong %s(data,timefields_t);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Time - year month day hour minute seconds\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_INT, variable, "data,timefields_t");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Time - year month day hour minute seconds");
 
-          fprintf(outfile, "year, month, day, hour, minute, second, nanosecond\";\n");
+          units += "year, month, day, hour, minute, second, nanosecond";
           break;
 
         case 'U': /* unix time in seconds since 1/1/70 00:00:00 */
@@ -2118,10 +2563,9 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tlong %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Integer seconds since 1/1/70 00:00:00\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
-          fprintf(outfile, "s\";\n");
+          mblist_cdl_variable(outfile, i, NC_INT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Integer seconds since 1/1/70 00:00:00");
+          units += "s";
           break;
 
         case 'u': /* time in seconds since first record */
@@ -2129,10 +2573,9 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tlong %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Integer seconds since first record\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
-          fprintf(outfile, "s\";\n");
+          mblist_cdl_variable(outfile, i, NC_INT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Integer seconds since first record");
+          units += "s";
           break;
 
         case 'V': /* time in seconds since last ping */
@@ -2141,10 +2584,9 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Seconds since last ping\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
-          fprintf(outfile, "s\";\n");
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Seconds since last ping");
+          units += "s";
           break;
 
         case 'X': /* longitude decimal degrees */
@@ -2156,14 +2598,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tdouble %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Longitude\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_DOUBLE, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Longitude");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "degrees\";\n");
+            units += "1/";
+          units += "degrees";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2174,11 +2615,10 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tchar %s(data,latm);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Longitude - decimal minutes\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_CHAR, variable, "data,latm");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Longitude - decimal minutes");
 
-          fprintf(outfile, "ddd mm.mmmmmH\";\n");
+          units += "ddd mm.mmmmmH";
           break;
 
         case 'Y': /* latitude decimal degrees */
@@ -2190,14 +2630,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tdouble %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Latitude\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_DOUBLE, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Latitude");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "degrees\";\n");
+            units += "1/";
+          units += "degrees";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2208,11 +2647,10 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tchar %s(data,latm);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Latitude - decimal minutes\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_CHAR, variable, "data,latm");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Latitude - decimal minutes");
 
-          fprintf(outfile, "ddd mm.mmmmmH\";\n");
+          units += "ddd mm.mmmmmH";
           break;
 
         case 'Z': /* topography */
@@ -2224,17 +2662,16 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Topography\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Topography");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
+            units += "1/";
           if (bathy_in_feet)
-            fprintf(outfile, "f\";\n");
+            units += "f";
           else
-            fprintf(outfile, "m\";\n");
+            units += "m";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2249,17 +2686,16 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Depth\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Depth");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
+            units += "1/";
           if (bathy_in_feet)
-            fprintf(outfile, "f\";\n");
+            units += "f";
           else
-            fprintf(outfile, "m\";\n");
+            units += "m";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2270,10 +2706,9 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tlong %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Beam number\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
-          fprintf(outfile, "number\";\n");
+          mblist_cdl_variable(outfile, i, NC_INT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Beam number");
+          units += "number";
           break;
         }
       }
@@ -2340,14 +2775,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Beam Angle\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Beam Angle");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "degrees\";\n");
+            units += "1/";
+          units += "degrees";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2364,14 +2798,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Beam angle forward\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Beam angle forward");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "degrees\";\n");
+            units += "1/";
+          units += "degrees";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2388,14 +2821,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Beam sensor depth\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Beam sensor depth");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "meters\";\n");
+            units += "1/";
+          units += "meters";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2412,14 +2844,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Beam heave\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Beam heave");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "meters\";\n");
+            units += "1/";
+          units += "meters";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2436,14 +2867,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Beam angle null\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Beam angle null");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "degrees\";\n");
+            units += "1/";
+          units += "degrees";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2460,14 +2890,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Beam alongtrack offset\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Beam alongtrack offset");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "meters\";\n");
+            units += "1/";
+          units += "meters";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2484,14 +2913,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Beam range\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Beam range");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "meters\";\n");
+            units += "1/";
+          units += "meters";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2508,14 +2936,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Survey sound velocity\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Survey sound velocity");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "meters/second\";\n");
+            units += "1/";
+          units += "meters/second";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2532,14 +2959,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Beam travel time\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Beam travel time");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "seconds\";\n");
+            units += "1/";
+          units += "seconds";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2616,14 +3042,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Backscatter\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Backscatter");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "dB\";\n");
+            units += "1/";
+          units += "dB";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2640,14 +3065,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Mean absorption\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Mean absorption");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "dB/km\";\n");
+            units += "1/";
+          units += "dB/km";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2664,14 +3088,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Normal incidence backscatter\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Normal incidence backscatter");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "dB\";\n");
+            units += "1/";
+          units += "dB";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2688,14 +3111,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Oblique backscatter\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Oblique backscatter");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "dB\";\n");
+            units += "1/";
+          units += "dB";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2712,17 +3134,16 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Mean backscatter\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Mean backscatter");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
+            units += "1/";
           if (format == MBF_EM300RAW || format == MBF_EM300MBA)
-            fprintf(outfile, "dB + 64\";\n");
+            units += "dB + 64";
           else
-            fprintf(outfile, "backscatter\";\n");
+            units += "backscatter";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2739,14 +3160,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Beam depression angle\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Beam depression angle");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "degrees\";\n");
+            units += "1/";
+          units += "degrees";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2759,11 +3179,10 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tchar %s(data,pathsize);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Name of swath data file\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_CHAR, variable, "data,pathsize");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Name of swath data file");
 
-          fprintf(outfile, "file name\";\n");
+          units += "file name";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2776,11 +3195,10 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tshort %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"MBsystem file format number\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_SHORT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "MBsystem file format number");
 
-          fprintf(outfile, "see mbformat\";\n");
+          units += "see mbformat";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2797,14 +3215,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Start range of TVG ramp\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Start range of TVG ramp");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "samples\";\n");
+            units += "1/";
+          units += "samples";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2821,14 +3238,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Stop range of TVG ramp\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Stop range of TVG ramp");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "samples\";\n");
+            units += "1/";
+          units += "samples";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2841,10 +3257,9 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tlong %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Pulse Length\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
-          fprintf(outfile, "us");
+          mblist_cdl_variable(outfile, i, NC_INT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Pulse Length");
+          units += "us";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2861,14 +3276,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Pulse length\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Pulse length");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "seconds\";\n");
+            units += "1/";
+          units += "seconds";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2881,10 +3295,9 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tlong %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Sounder mode\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
-          fprintf(outfile, "0=very shallow,1=shallow,2=medium,3=deep,4=very deep,5=extra deep\";\n");
+          mblist_cdl_variable(outfile, i, NC_INT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Sounder mode");
+          units += "0=very shallow,1=shallow,2=medium,3=deep,4=very deep,5=extra deep";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2897,10 +3310,9 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tlong %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Sounder ping counter\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
-          fprintf(outfile, "pings\";\n");
+          mblist_cdl_variable(outfile, i, NC_INT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Sounder ping counter");
+          units += "pings";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2918,17 +3330,16 @@ int main(int argc, char **argv) {
           fprintf(output[i], "\t%s = ", variable);
 
           if (count == 0)
-            fprintf(outfile, "\tfloat %s(data);\n", variable);
+            mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
           else
-            fprintf(outfile, "\tfloat %s(data, %c);\n", variable, list[i]);
+            mblist_cdl_variable(outfile, i, NC_FLOAT, variable, std::string("data, ") + list[i]);
 
-          fprintf(outfile, "\t\t%s:long_name = \"Raw sidescan pixels\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Raw sidescan pixels");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "dB\";\n");
+            units += "1/";
+          units += "dB";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2945,14 +3356,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Range \";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Range ");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "samples\";\n");
+            units += "1/";
+          units += "samples";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2969,14 +3379,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Sample Rate\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Sample Rate");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "Hertz\";\n");
+            units += "1/";
+          units += "Hertz";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -2993,14 +3402,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Total sidescan pixels \";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Total sidescan pixels ");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "pixels\";\n");
+            units += "1/";
+          units += "pixels";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -3017,14 +3425,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Sidescan pixels per beam\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Sidescan pixels per beam");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "pixels\";\n");
+            units += "1/";
+          units += "pixels";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -3041,14 +3448,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Transmit gain\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Transmit gain");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "dB\";\n");
+            units += "1/";
+          units += "dB";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -3065,14 +3471,13 @@ int main(int argc, char **argv) {
 
           fprintf(output[i], "\t%s = ", variable);
 
-          fprintf(outfile, "\tfloat %s(data);\n", variable);
-          fprintf(outfile, "\t\t%s:long_name = \"Receive gain\";\n", variable);
-          fprintf(outfile, "\t\t%s:units = \"", variable);
+          mblist_cdl_variable(outfile, i, NC_FLOAT, variable, "data");
+          mblist_cdl_attribute(outfile, i, variable, "long_name", "Receive gain");
           if (signflip_next_value)
-            fprintf(outfile, "-");
+            units += "-";
           if (invert_next_value)
-            fprintf(outfile, "1/");
-          fprintf(outfile, "dB\";\n");
+            units += "1/";
+          units += "dB";
 
           signflip_next_value = false;
           invert_next_value = false;
@@ -3086,8 +3491,20 @@ int main(int argc, char **argv) {
           break;
         }
       }
+      if (!units.empty())
+        mblist_cdl_attribute(outfile, i, variable, "units", units);
     }
     fprintf(outfile, "\n\ndata:\n");
+
+    /* from here on NetCDF-4 and columnar output take the binary path */
+    if (!netcdf_cdl) {
+      for (int i = 0; i < n_list; i++) {
+        fclose(output[i]);
+        output[i] = outfile;
+      }
+      ascii = false;
+      netcdf = false;
+    }
   }
 
   bool use_course = false;
@@ -3602,6 +4019,7 @@ if (error == MB_ERROR_NO_ERROR)
             projectednav_next_value = false;
             special_character = false;
             for (int i = 0; i < n_list; i++) {
+              binary_output.column = i;
               if (netcdf && lcount > 0)
                 fprintf(output[i], ", ");
               int k;
@@ -3742,7 +4160,7 @@ if (error == MB_ERROR_NO_ERROR)
                   }
                   else {
                     b = beamflag[k];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   break;
                 case 'f': /* Beamflag character value (ascii only) */
@@ -3770,7 +4188,7 @@ if (error == MB_ERROR_NO_ERROR)
                   }
                   else {
                     b = beamflag[k];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   break;
                 case 'G': /* flat bottom grazing angle */
@@ -3824,17 +4242,17 @@ if (error == MB_ERROR_NO_ERROR)
                   }
                   else {
                     b = time_j[0];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_j[1];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_i[3];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_i[4];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_i[5];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_i[6];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   break;
                 case 'j': /* time string */
@@ -3849,15 +4267,15 @@ if (error == MB_ERROR_NO_ERROR)
                   }
                   else {
                     b = time_j[0];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_j[1];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_j[2];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_j[3];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_j[4];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   break;
                 case 'K': /* proportion of good beams over non-null beams */
@@ -3904,7 +4322,7 @@ if (error == MB_ERROR_NO_ERROR)
                     fprintf(output[i], "%6u", pingnumber);
                   else {
                     b = pingnumber;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   break;
                 case 'n': /* line number */
@@ -3912,7 +4330,7 @@ if (error == MB_ERROR_NO_ERROR)
                     fprintf(output[i], "%6u", linenumber);
                   else {
                     b = linenumber;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   break;
                 case 'P': /* pitch */
@@ -3934,7 +4352,7 @@ if (error == MB_ERROR_NO_ERROR)
                   }
                   else {
                     b = detect[k];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   break;
                 case 'Q': /* bottom detection type */
@@ -3955,7 +4373,7 @@ if (error == MB_ERROR_NO_ERROR)
                   }
                   else {
                     b = detect[k];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   break;
                 case 'R': /* roll */
@@ -3987,17 +4405,17 @@ if (error == MB_ERROR_NO_ERROR)
                   }
                   else {
                     b = time_i[0];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_i[1];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_i[2];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_i[3];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_i[4];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = seconds;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   break;
                 case 't': /* yyyy mm dd hh mm ss time string */
@@ -4012,17 +4430,17 @@ if (error == MB_ERROR_NO_ERROR)
                   }
                   else {
                     b = time_i[0];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_i[1];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_i[2];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_i[3];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_i[4];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = seconds;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   break;
                 case 'U': /* unix time in seconds since 1/1/70 00:00:00 */
@@ -4031,7 +4449,7 @@ if (error == MB_ERROR_NO_ERROR)
                     fprintf(output[i], "%ld", time_u);
                   else {
                     b = time_u;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   break;
                 case 'u': /* time in seconds since first record */
@@ -4044,7 +4462,7 @@ if (error == MB_ERROR_NO_ERROR)
                     fprintf(output[i], "%ld", time_u - time_u_ref);
                   else {
                     b = time_u - time_u_ref;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   break;
                 case 'V': /* time in seconds since last ping */
@@ -4056,7 +4474,7 @@ if (error == MB_ERROR_NO_ERROR)
                       fprintf(output[i], "%10.6f", time_interval);
                   }
                   else {
-                    fwrite(&time_interval, sizeof(double), 1, outfile);
+                    mblist_binary_value(time_interval);
                   }
                   break;
                 case 'X': /* longitude decimal degrees */
@@ -4109,9 +4527,9 @@ if (error == MB_ERROR_NO_ERROR)
                     b = degrees;
                     if (hemi == 'W')
                       b = -b;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = minutes;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   sensornav_next_value = false;
                   break;
@@ -4165,9 +4583,9 @@ if (error == MB_ERROR_NO_ERROR)
                     b = degrees;
                     if (hemi == 'S')
                       b = -b;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = minutes;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   sensornav_next_value = false;
                   break;
@@ -4212,7 +4630,7 @@ if (error == MB_ERROR_NO_ERROR)
                     fprintf(output[i], "%6d", k);
                   else {
                     b = k;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   break;
                 default:
@@ -4548,16 +4966,16 @@ if (error == MB_ERROR_NO_ERROR)
                   break;
 
                 case 'F': /* filename */
-                  if (netcdf)
-                    fprintf(output[i], "\"");
-                  fprintf(output[i], "%s", file);
-
-                  if (netcdf)
-                    fprintf(output[i], "\"");
-
-                  if (!ascii)
-                    for (k = strlen(file); k < MB_PATH_MAXLINE; k++)
-                      fwrite(&file[strlen(file)], sizeof(char), 1, outfile);
+                  if (ascii) {
+                    if (netcdf)
+                      fprintf(output[i], "\"");
+                    fprintf(output[i], "%s", file);
+                    if (netcdf)
+                      fprintf(output[i], "\"");
+                  }
+                  else {
+                    mblist_binary_text(file, MB_PATH_MAXLINE);
+                  }
 
                   raw_next_value = false;
                   break;
@@ -4567,7 +4985,7 @@ if (error == MB_ERROR_NO_ERROR)
                     fprintf(output[i], "%6d", format);
                   else {
                     b = format;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   raw_next_value = false;
                   break;
@@ -4577,7 +4995,7 @@ if (error == MB_ERROR_NO_ERROR)
                     fprintf(output[i], "%6d", tvg_start);
                   else {
                     b = tvg_start;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   raw_next_value = false;
                   break;
@@ -4587,7 +5005,7 @@ if (error == MB_ERROR_NO_ERROR)
                     fprintf(output[i], "%6d", tvg_stop);
                   else {
                     b = tvg_stop;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   raw_next_value = false;
                   break;
@@ -4597,7 +5015,7 @@ if (error == MB_ERROR_NO_ERROR)
                     fprintf(output[i], "%6d", ipulse_length);
                   else {
                     b = ipulse_length;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   raw_next_value = false;
                   break;
@@ -4613,7 +5031,7 @@ if (error == MB_ERROR_NO_ERROR)
                     fprintf(output[i], "%4d", mode);
                   else {
                     b = mode;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   raw_next_value = false;
                   break;
@@ -4623,7 +5041,7 @@ if (error == MB_ERROR_NO_ERROR)
                     fprintf(output[i], "%6d", png_count);
                   else {
                     b = png_count;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   raw_next_value = false;
                   break;
@@ -4662,7 +5080,7 @@ if (error == MB_ERROR_NO_ERROR)
                     fprintf(output[i], "%6d", range[k]);
                   else {
                     b = range[k];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   raw_next_value = false;
                   break;
@@ -4671,7 +5089,7 @@ if (error == MB_ERROR_NO_ERROR)
                     fprintf(output[i], "%6d", sample_rate);
                   else {
                     b = sample_rate;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   raw_next_value = false;
                   break;
@@ -4680,7 +5098,7 @@ if (error == MB_ERROR_NO_ERROR)
                     fprintf(output[i], "%6d", npixels);
                   else {
                     b = npixels;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   raw_next_value = false;
                   break;
@@ -4689,7 +5107,7 @@ if (error == MB_ERROR_NO_ERROR)
                     fprintf(output[i], "%6d", beam_samples[k]);
                   else {
                     b = beam_samples[k];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   raw_next_value = false;
                   break;
@@ -4724,6 +5142,8 @@ if (error == MB_ERROR_NO_ERROR)
                   fprintf(output[lcount++ % n_list], "\n");
               }
             }
+            if (!ascii)
+              mblist_binary_record(verbose, &error);
           }
         }
 
@@ -4765,6 +5185,7 @@ if (error == MB_ERROR_NO_ERROR)
             projectednav_next_value = false;
             special_character = false;
             for (int i = 0; i < n_list; i++) {
+              binary_output.column = i;
               if (netcdf && lcount > 0)
                 fprintf(output[i], ", ");
               int k;
@@ -4894,17 +5315,17 @@ if (error == MB_ERROR_NO_ERROR)
                   }
                   else {
                     b = time_j[0];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_j[1];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_i[3];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_i[4];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_i[5];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_i[6];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   break;
                 case 'j': /* time string */
@@ -4919,15 +5340,15 @@ if (error == MB_ERROR_NO_ERROR)
                   }
                   else {
                     b = time_j[0];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_j[1];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_j[2];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_j[3];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_j[4];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   break;
                 case 'K': /* proportion of non-null beams that are unflagged */
@@ -4974,7 +5395,7 @@ if (error == MB_ERROR_NO_ERROR)
                     fprintf(output[i], "%6u", pingnumber);
                   else {
                     b = pingnumber;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   break;
                 case 'n': /* line number */
@@ -4982,7 +5403,7 @@ if (error == MB_ERROR_NO_ERROR)
                     fprintf(output[i], "%6u", linenumber);
                   else {
                     b = linenumber;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   break;
                 case 'P': /* pitch */
@@ -5004,7 +5425,7 @@ if (error == MB_ERROR_NO_ERROR)
                   }
                   else {
                     b = MB_DETECT_UNKNOWN;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   break;
                 case 'R': /* roll */
@@ -5035,17 +5456,17 @@ if (error == MB_ERROR_NO_ERROR)
                   }
                   else {
                     b = time_i[0];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_i[1];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_i[2];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_i[3];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_i[4];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = seconds;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   break;
                 case 't': /* yyyy mm dd hh mm ss time string */
@@ -5060,17 +5481,17 @@ if (error == MB_ERROR_NO_ERROR)
                   }
                   else {
                     b = time_i[0];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_i[1];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_i[2];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_i[3];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = time_i[4];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = seconds;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   break;
                 case 'U': /* unix time in seconds since 1/1/70 00:00:00 */
@@ -5079,7 +5500,7 @@ if (error == MB_ERROR_NO_ERROR)
                     fprintf(output[i], "%ld", time_u);
                   else {
                     b = time_u;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   break;
                 case 'u': /* time in seconds since first record */
@@ -5092,7 +5513,7 @@ if (error == MB_ERROR_NO_ERROR)
                     fprintf(output[i], "%ld", time_u - time_u_ref);
                   else {
                     b = time_u - time_u_ref;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   break;
                 case 'V': /* time in seconds since last ping */
@@ -5104,7 +5525,7 @@ if (error == MB_ERROR_NO_ERROR)
                       fprintf(output[i], "%10.6f", time_interval);
                   }
                   else {
-                    fwrite(&time_interval, sizeof(double), 1, outfile);
+                    mblist_binary_value(time_interval);
                   }
                   break;
                 case 'X': /* longitude decimal degrees */
@@ -5156,9 +5577,9 @@ if (error == MB_ERROR_NO_ERROR)
                     b = degrees;
                     if (hemi == 'W')
                       b = -b;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = minutes;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   sensornav_next_value = false;
                   break;
@@ -5211,9 +5632,9 @@ if (error == MB_ERROR_NO_ERROR)
                     b = degrees;
                     if (hemi == 'S')
                       b = -b;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                     b = minutes;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   sensornav_next_value = false;
                   break;
@@ -5258,12 +5679,13 @@ if (error == MB_ERROR_NO_ERROR)
                     fprintf(output[i], "%6d", k);
                   else {
                     b = k;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   break;
 
                 default:
-                  fprintf(output[i], "<Invalid Option: %c>", list[i]);
+                  if (ascii)
+                    fprintf(output[i], "<Invalid Option: %c>", list[i]);
                   break;
                 }
               }
@@ -5472,15 +5894,16 @@ if (error == MB_ERROR_NO_ERROR)
                   break;
 
                 case 'F': /* filename */
-                  if (netcdf)
-                    fprintf(output[i], "\"");
-                  fprintf(output[i], "%s", file);
-                  if (netcdf)
-                    fprintf(output[i], "\"");
-
-                  if (!ascii)
-                    for (k = strlen(file); k < MB_PATH_MAXLINE; k++)
-                      fwrite(&file[strlen(file)], sizeof(char), 1, outfile);
+                  if (ascii) {
+                    if (netcdf)
+                      fprintf(output[i], "\"");
+                    fprintf(output[i], "%s", file);
+                    if (netcdf)
+                      fprintf(output[i], "\"");
+                  }
+                  else {
+                    mblist_binary_text(file, MB_PATH_MAXLINE);
+                  }
 
                   raw_next_value = false;
                   break;
@@ -5490,7 +5913,7 @@ if (error == MB_ERROR_NO_ERROR)
                     fprintf(output[i], "%6d", format);
                   else {
                     b = format;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   raw_next_value = false;
                   break;
@@ -5500,7 +5923,7 @@ if (error == MB_ERROR_NO_ERROR)
                     fprintf(output[i], "%6d", tvg_start);
                   else {
                     b = tvg_start;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   raw_next_value = false;
                   break;
@@ -5510,7 +5933,7 @@ if (error == MB_ERROR_NO_ERROR)
                     fprintf(output[i], "%6d", tvg_stop);
                   else {
                     b = tvg_stop;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   raw_next_value = false;
                   break;
@@ -5520,7 +5943,7 @@ if (error == MB_ERROR_NO_ERROR)
                     fprintf(output[i], "%6d", ipulse_length);
                   else {
                     b = ipulse_length;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   raw_next_value = false;
                   break;
@@ -5536,7 +5959,7 @@ if (error == MB_ERROR_NO_ERROR)
                     fprintf(output[i], "%4d", mode);
                   else {
                     b = mode;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   raw_next_value = false;
                   break;
@@ -5546,7 +5969,7 @@ if (error == MB_ERROR_NO_ERROR)
                     fprintf(output[i], "%6d", png_count);
                   else {
                     b = png_count;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   raw_next_value = false;
                   break;
@@ -5586,7 +6009,7 @@ if (error == MB_ERROR_NO_ERROR)
                     fprintf(output[i], "%6d", range[beam_vertical]);
                   else {
                     b = range[beam_vertical];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   raw_next_value = false;
                   break;
@@ -5596,7 +6019,7 @@ if (error == MB_ERROR_NO_ERROR)
                     fprintf(output[i], "%6d", sample_rate);
                   else {
                     b = sample_rate;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   raw_next_value = false;
                   break;
@@ -5606,7 +6029,7 @@ if (error == MB_ERROR_NO_ERROR)
                     fprintf(output[i], "%6d", npixels);
                   else {
                     b = npixels;
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   raw_next_value = false;
                   break;
@@ -5615,7 +6038,7 @@ if (error == MB_ERROR_NO_ERROR)
                     fprintf(output[i], "%6d", beam_samples[beam_vertical]);
                   else {
                     b = beam_samples[beam_vertical];
-                    fwrite(&b, sizeof(double), 1, outfile);
+                    mblist_binary_value(b);
                   }
                   raw_next_value = false;
                   break;
@@ -5650,6 +6073,8 @@ if (error == MB_ERROR_NO_ERROR)
                   fprintf(output[lcount++ % n_list], "\n");
               }
             }
+            if (!ascii)
+              mblist_binary_record(verbose, &error);
           }
         }
 
@@ -5708,18 +6133,10 @@ if (error == MB_ERROR_NO_ERROR)
 
     fprintf(outfile, "}\n");
     fclose(outfile);
-
-    /* convert cdl to netcdf */
-    if (!netcdf_cdl) {
-      snprintf(output_file_temp, sizeof(output_file_temp), "ncgen -o %s %s.cdl", output_file, output_file);
-      const int shellstatus = system(output_file_temp);
-      if (shellstatus == 0) {
-        snprintf(output_file_temp, sizeof(output_file_temp), "rm %s.cdl", output_file);
-        // TODO(schwehr): Check return of system.
-        /* shellstatus = */ system(output_file_temp);
-      }
-    }
   } else {
+    /* write any records still held in the column buffers */
+    if (!ascii)
+      status &= mblist_binary_close(verbose, &error);
     fclose(outfile);
   }
 
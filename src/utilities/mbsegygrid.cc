@@ -695,9 +695,38 @@ int main(int argc, char **argv) {
 		double btimesave;
 		double dtimesave;
 
+		/* when gridding by trace number use the trace index to skip
+			directly to the first trace in range and stop after the last */
+		int nreadmax = -1;
+		if (plotmode == MBSEGYGRID_PLOTBYTRACENUMBER) {
+			int nindex = 0;
+			struct mb_segyindex_struct *index = nullptr;
+			if (mb_segy_read_index(verbose, mbsegyioptr, &nindex, &index, &error) == MB_SUCCESS) {
+				int ifirst = -1;
+				int ilast = -1;
+				for (int i = 0; i < nindex; i++) {
+					const int indexnum = tracemode == MBSEGYGRID_USECMP ? index[i].rp_num : index[i].shot_num;
+					if (indexnum >= tracestart && indexnum <= traceend) {
+						if (ifirst < 0)
+							ifirst = i;
+						ilast = i;
+					}
+				}
+				if (ifirst < 0) {
+					nreadmax = 0;
+				}
+				else if (mb_segy_seek_trace(verbose, mbsegyioptr, ifirst, &error) == MB_SUCCESS) {
+					nreadmax = ilast - ifirst + 1;
+				}
+			}
+			error = MB_ERROR_NO_ERROR;
+			if (verbose > 0 && nreadmax >= 0)
+				fprintf(outfp, "Trace index: reading %d of %d traces\n", nreadmax, nindex);
+		}
+
 		/* read and print data */
 		int nread = 0;
-		while (error <= MB_ERROR_NO_ERROR) {
+		while (error <= MB_ERROR_NO_ERROR && (nreadmax < 0 || nread < nreadmax)) {
 			struct mb_segytraceheader_struct traceheader;
 			float *trace = nullptr;
 
@@ -40,7 +40,9 @@
 #include <limits>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <thread>
 #include <unistd.h>
+#include <vector>
 
 #include "fftw3.h"
 #include "mb_aux.h"
@@ -61,6 +63,22 @@ typedef enum {
     MBSEGYPSD_WINDOW_DEPTH = 3,
 } windowmode_t;
 
+/* traces are read serially in blocks, their spectra are calculated in
+    parallel using batched real to complex transforms, and the results are
+    then added to the grid in the order read */
+constexpr int MBSEGYPSD_BLOCK_TRACES = 256;
+constexpr int MBSEGYPSD_FFT_BATCH = 16;
+constexpr char MBSEGYPSD_WISDOM_FILE[] = ".mbsegypsd_fftw_wisdom";
+
+struct mbsegypsd_trace_struct {
+	int ix;
+	int itstart;
+	int itend;
+	std::vector<float> samples;
+	std::vector<double> spsd;
+	std::vector<double> wpsd;
+};
+
 /* output stream for basic stuff (stdout if verbose <= 1,
     stderr if verbose > 1) */
 FILE *outfp = nullptr;
@@ -70,7 +88,7 @@ constexpr char help_message[] =
     "mbsegypsd calculates the power spectral density function of each trace in a segy data file,\n"
     "outputting the results as a GMT grid file.";
 constexpr char usage_message[] =
-    "mbsegypsd -Ifile -Oroot [-Ashotscale\n"
+    "mbsegypsd -Ifile -Oroot [-Ashotscale -Cthreads\n"
     "          -Ddecimatex -R\n"
     "          -Smode[/start/end[/schan/echan]] -Tsweep[/delay]\n"
     "          -Wmode/start/end -H -V]";
@@ -203,6 +221,106 @@ int get_segy_limits(int verbose, char *segyfile, tracemode_t *tracemode,
 	return (status);
 }
 
+/*--------------------------------------------------------------------*/
+/*
+ * function accumulate_spectra transforms a batch of tapered trace sections
+ * and adds their normalized power spectra to the traces they came from
+ */
+void accumulate_spectra(int nfft, fftw_plan plan, double *fftw_in, fftw_complex *fftw_out, int nbatch,
+                        mbsegypsd_trace_struct **batchtrace, const double *batchnormraw) {
+	/* execute the batched fft - new array execution is thread safe */
+	fftw_execute_dft_r2c(plan, fftw_in, fftw_out);
+
+	const int nfreq = nfft / 2 + 1;
+	for (int ibatch = 0; ibatch < nbatch; ibatch++) {
+		const fftw_complex *out = &fftw_out[ibatch * nfreq];
+		double *spsd = batchtrace[ibatch]->spsd.data();
+		double *wpsd = batchtrace[ibatch]->wpsd.data();
+
+		/* get normalization factor - require variance of transform to equal variance of input,
+		    the r2c transform holds only the nonnegative frequencies of the hermitian spectrum */
+		double normfft = 0.0;
+		for (int i = 1; i < (nfft + 1) / 2; i++)
+			normfft += 2.0 * (out[i][0] * out[i][0] + out[i][1] * out[i][1]);
+		if (nfft % 2 == 0)
+			normfft += out[nfft / 2][0] * out[nfft / 2][0] + out[nfft / 2][1] * out[nfft / 2][1];
+		const double norm = batchnormraw[ibatch] / normfft;
+		const double norm2 = norm * norm;
+
+		/* calculate psd from result of transform */
+		spsd[0] += out[0][0] * out[0][0] + out[0][1] * out[0][1];
+		wpsd[0] += 1.0;
+		int i = 1;  // Used after for.
+		for (; i < nfft / 2; i++) {
+			spsd[i] += 2.0 * norm2 * (out[i][0] * out[i][0] + out[i][1] * out[i][1]);
+			wpsd[i] += 1.0;
+		}
+		if (nfft % 2 == 0) {
+			spsd[i] += norm2 * (out[nfft / 2][0] * out[nfft / 2][0] + out[nfft / 2][1] * out[nfft / 2][1]);
+			wpsd[i] += 1.0;
+		}
+	}
+}
+
+/*--------------------------------------------------------------------*/
+/*
+ * function calculate_spectra calculates the power spectral density of a set
+ * of traces in nfft long tapered sections, transforming up to
+ * MBSEGYPSD_FFT_BATCH sections at a time. Each thread calls this with its
+ * own input and output arrays and its own set of traces.
+ */
+void calculate_spectra(int nfft, fftw_plan plan, const double *taper, double *fftw_in, fftw_complex *fftw_out,
+                       mbsegypsd_trace_struct *traces, int ntraces) {
+	mbsegypsd_trace_struct *batchtrace[MBSEGYPSD_FFT_BATCH];
+	double batchnormraw[MBSEGYPSD_FFT_BATCH];
+	int nbatch = 0;
+
+	for (int itrace = 0; itrace < ntraces; itrace++) {
+		mbsegypsd_trace_struct *trace = &traces[itrace];
+		const float *samples = trace->samples.data();
+		std::fill(trace->spsd.begin(), trace->spsd.end(), 0.0);
+		std::fill(trace->wpsd.begin(), trace->wpsd.end(), 0.0);
+
+		/* loop over the data in nfft long sections */
+		int nsection = (trace->itend - trace->itstart + 1) / nfft;
+		if (((trace->itend - trace->itstart + 1) % nfft) > 0)
+			nsection++;
+		for (int j = 0; j < nsection; j++) {
+			/* extract data section to be fft'd with taper */
+			double *in = &fftw_in[nbatch * nfft];
+			const int kstart = trace->itstart + j * nfft;
+			const int kend = std::min(kstart + nfft, trace->itend);
+			const int nuse = std::max(std::min(nfft, kend - kstart + 1), 0);
+			const float *section = &samples[kstart];
+			if (kend - kstart == nfft) {
+				for (int i = 0; i < nuse; i++)
+					in[i] = taper[i] * section[i];
+			}
+			else {
+				for (int i = 0; i < nuse; i++) {
+					const double sint = sin(M_PI * ((double)i) / ((double)(kend - kstart)));
+					in[i] = sint * sint * section[i];
+				}
+			}
+			for (int i = nuse; i < nfft; i++)
+				in[i] = 0.0;
+			double normraw = 0.0;
+			for (int i = 0; i < nuse; i++)
+				normraw += section[i] * section[i];
+
+			batchtrace[nbatch] = trace;
+			batchnormraw[nbatch] = normraw;
+			nbatch++;
+			if (nbatch == MBSEGYPSD_FFT_BATCH) {
+				accumulate_spectra(nfft, plan, fftw_in, fftw_out, nbatch, batchtrace, batchnormraw);
+				nbatch = 0;
+			}
+		}
+	}
+	if (nbatch > 0)
+		accumulate_spectra(nfft, plan, fftw_in, fftw_out, nbatch, batchtrace, batchnormraw);
+}
+
 /*--------------------------------------------------------------------*/
 
 int main(int argc, char **argv) {
@@ -211,6 +329,7 @@ int main(int argc, char **argv) {
 	double frequencyscale = 1.0;
 	bool scale2distance = false;
 	int decimatex = 1;
+	int n_threads = 1;
 	char segyfile[MB_PATH_MAXLINE] = "";
 	bool logscale = false;
 	int nfft = 1024;
@@ -233,7 +352,7 @@ int main(int argc, char **argv) {
 		bool errflg = false;
 		int c;
 		bool help = false;
-		while ((c = getopt(argc, argv, "A:a:D:d:I:i:LlN:n:O:o:PpS:s:T:t:VvW:w:Hh")) != -1)
+		while ((c = getopt(argc, argv, "A:a:C:c:D:d:I:i:LlN:n:O:o:PpS:s:T:t:VvW:w:Hh")) != -1)
 			switch (c) {
 			case 'H':
 			case 'h':
@@ -251,6 +370,11 @@ int main(int argc, char **argv) {
 					scale2distance = true;
 				break;
 			}
+			case 'C':
+			case 'c':
+				sscanf(optarg, "%d", &n_threads);
+				n_threads = std::max(n_threads, 1);
+				break;
 			case 'D':
 			case 'd':
 				sscanf(optarg, "%d", &decimatex);
@@ -337,6 +461,7 @@ int main(int argc, char **argv) {
 			fprintf(outfp, "dbg2       fileroot:       %s\n", fileroot);
 			fprintf(outfp, "dbg2       nfft:           %d\n", nfft);
 			fprintf(outfp, "dbg2       decimatex:      %d\n", decimatex);
+			fprintf(outfp, "dbg2       n_threads:      %d\n", n_threads);
 			fprintf(outfp, "dbg2       tracemode:      %d\n", tracemode);
 			fprintf(outfp, "dbg2       tracestart:     %d\n", tracestart);
 			fprintf(outfp, "dbg2       traceend:       %d\n", traceend);
@@ -456,10 +581,6 @@ int main(int argc, char **argv) {
 	/* allocate memory for grid array */
 	float *grid = nullptr;
 	int status = mb_mallocd(verbose, __FILE__, __LINE__, 2 * ngridxy * sizeof(float), (void **)&grid, &error);
-	double *spsd = nullptr;
-	status &= mb_mallocd(verbose, __FILE__, __LINE__, ngridy * sizeof(double), (void **)&spsd, &error);
-	double *wpsd = nullptr;
-	status &= mb_mallocd(verbose, __FILE__, __LINE__, ngridy * sizeof(double), (void **)&wpsd, &error);
 	double *spsdtot = nullptr;
 	status &= mb_mallocd(verbose, __FILE__, __LINE__, ngridy * sizeof(double), (void **)&spsdtot, &error);
 	double *wpsdtot = nullptr;
@@ -482,6 +603,7 @@ int main(int argc, char **argv) {
 		fprintf(outfp, "     channel start:      %d\n", chanstart);
 		fprintf(outfp, "     channel end:        %d\n", chanend);
 		fprintf(outfp, "     trace decimation:   %d\n", decimatex);
+		fprintf(outfp, "     number of threads:  %d\n", n_threads);
 		fprintf(outfp, "     time sweep:         %f seconds\n", timesweep);
 		fprintf(outfp, "     time delay:         %f seconds\n", timedelay);
 		fprintf(outfp, "     sample interval:    %f seconds\n", sampleinterval);
@@ -519,213 +641,213 @@ int main(int argc, char **argv) {
 		for (int i = 0; i < ngridxy; i++)
 			grid[i] = std::numeric_limits<float>::quiet_NaN();
 
-		/* generate the fftw plan */
-		fftw_complex *fftw_in = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * nfft);
-		fftw_complex *fftw_out = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * nfft);
-		const fftw_plan plan = fftw_plan_dft_1d(nfft, fftw_in, fftw_out, FFTW_FORWARD, FFTW_MEASURE);
+		/* get number of threads to use */
+		const int n_concurrency = std::max((int)std::thread::hardware_concurrency(), 1);
+		n_threads = std::min(n_threads, std::min(n_concurrency, MB_THREAD_MAX));
+
+		/* generate the batched real to complex fftw plan, reusing any
+		    wisdom saved by previous runs */
+		const int nfreq = nfft / 2 + 1;
+		char wisdomfile[MB_PATH_MAXLINE] = "";
+		const char *home = getenv("HOME");
+		if (home != nullptr) {
+			snprintf(wisdomfile, sizeof(wisdomfile), "%s/%s", home, MBSEGYPSD_WISDOM_FILE);
+			fftw_import_wisdom_from_filename(wisdomfile);
+		}
+		double *fftw_in[MB_THREAD_MAX];
+		fftw_complex *fftw_out[MB_THREAD_MAX];
+		for (int ithread = 0; ithread < n_threads; ithread++) {
+			fftw_in[ithread] = fftw_alloc_real(MBSEGYPSD_FFT_BATCH * nfft);
+			fftw_out[ithread] = fftw_alloc_complex(MBSEGYPSD_FFT_BATCH * nfreq);
+		}
+		const fftw_plan plan = fftw_plan_many_dft_r2c(1, &nfft, MBSEGYPSD_FFT_BATCH, fftw_in[0], nullptr, 1, nfft,
+		                                              fftw_out[0], nullptr, 1, nfreq, FFTW_MEASURE);
+		if (home != nullptr)
+			fftw_export_wisdom_to_filename(wisdomfile);
+		for (int ithread = 0; ithread < n_threads; ithread++) {
+			std::fill(fftw_in[ithread], fftw_in[ithread] + MBSEGYPSD_FFT_BATCH * nfft, 0.0);
+		}
 
+		/* taper for complete nfft long sections */
+		std::vector<double> taper(nfft);
+		for (int i = 0; i < nfft; i++) {
+			const double sint = sin(M_PI * ((double)i) / ((double)nfft));
+			taper[i] = sint * sint;
+		}
+
+		/* block of traces of interest */
+		std::vector<mbsegypsd_trace_struct> traces(MBSEGYPSD_BLOCK_TRACES);
+		for (auto &trace : traces) {
+			trace.spsd.resize(ngridy);
+			trace.wpsd.resize(ngridy);
+		}
 
 		/* read and print data */
 		int nread = 0;
 		// double btime;
 		// double btimesave = 0.0;
 		while (error <= MB_ERROR_NO_ERROR) {
-			/* reset error */
-			error = MB_ERROR_NO_ERROR;
-
-			/* read a trace */
-			struct mb_segytraceheader_struct traceheader;
-			float *trace = nullptr;
-			status = mb_segy_read_trace(verbose, mbsegyioptr, &traceheader, &trace, &error);
-
-			/* now process the trace */
-			if (status == MB_SUCCESS) {
-				/* figure out where this trace is in the grid */
-				const int tracenum =
-					tracemode == MBSEGYPSD_USESHOT
-					? traceheader.shot_num : traceheader.rp_num;
-				const int channum =
-					tracemode == MBSEGYPSD_USESHOT
-					? traceheader.shot_tr : traceheader.rp_tr;
-				const int tracecount =
-					chanend >= chanstart
-					? (tracenum - tracestart) * (chanend - chanstart + 1) + (channum - chanstart)
-					: tracenum - tracestart;
-				const int ix = tracecount / decimatex;
-				// TODO(schwehr): Why are these casting through float?
-				const double factor =
-					traceheader.elev_scalar < 0
-					? 1.0 / (float)(-traceheader.elev_scalar)
-					: (float)traceheader.elev_scalar;
-				double dtime;
-				double dtimesave = 0.0;
-				if (traceheader.src_depth > 0) {
-					// btime = factor * traceheader.src_depth / 750.0 + 0.001 * traceheader.delay_mils;
-					dtime = factor * traceheader.src_depth / 750.0;
-					// btimesave = btime;
-					dtimesave = dtime;
-				}
-				else if (traceheader.src_elev > 0) {
-					// btime = -factor * traceheader.src_elev / 750.0 + 0.001 * traceheader.delay_mils;
-					dtime = -factor * traceheader.src_elev / 750.0;
-					// btimesave = btime;
-					dtimesave = dtime;
-				}
-				else {
-					// btime = btimesave;
-					dtime = dtimesave;
-				}
-				double stime;
-				double stimesave = 0.0;
-				if (traceheader.src_wbd > 0) {
-					stime = factor * traceheader.src_wbd / 750.0;
-					stimesave = stime;
-				}
-				else {
-					stime = stimesave;
-				}
-				// const int iys = (btime - timedelay) / sampleinterval;
-
-				/* now check if this is a trace of interest */
-				bool traceok = true;
-				if (tracenum < tracestart || tracenum > traceend)
-					traceok = false;
-				else if (chanend >= chanstart && (channum < chanstart || channum > chanend))
-					traceok = false;
-				else if (tracecount % decimatex != 0)
-					traceok = false;
-
-				/* get trace min and max */
-				double tracemin = trace[0];
-				double tracemax = trace[0];
-				for (int i = 0; i < traceheader.nsamps; i++) {
-					tracemin = std::min(tracemin, static_cast<double>(trace[i]));
-					tracemax = std::max(tracemin, static_cast<double>(trace[i]));
-				}
-
-				if ((verbose == 0 && nread % 250 == 0) || (nread % 25 == 0)) {
-					if (traceok)
-						fprintf(outfp, "PROCESS ");
-					else
-						fprintf(outfp, "IGNORE  ");
-					if (tracemode == MBSEGYPSD_USESHOT)
-						fprintf(outfp, "read:%d position:%d shot:%d channel:%d ", nread, tracecount, tracenum, channum);
-					else
-						fprintf(outfp, "read:%d position:%d rp:%d channel:%d ", nread, tracecount, tracenum, channum);
-					fprintf(outfp, "%4.4d/%3.3d %2.2d:%2.2d:%2.2d.%3.3d samples:%d interval:%d usec minmax: %f %f\n",
-					        traceheader.year, traceheader.day_of_yr, traceheader.hour, traceheader.min, traceheader.sec,
-					        traceheader.mils, traceheader.nsamps, traceheader.si_micros, tracemin, tracemax);
-				}
-
-				/* now actually process traces of interest */
-				if (traceok) {
-					/* zero working psd array */
-					for (int iy = 0; iy < ngridy; iy++) {
-						spsd[iy] = 0.0;
-						wpsd[iy] = 0.0;
+			int ntraces = 0;
+			while (error <= MB_ERROR_NO_ERROR && ntraces < MBSEGYPSD_BLOCK_TRACES) {
+				/* reset error */
+				error = MB_ERROR_NO_ERROR;
+
+				/* read a trace */
+				struct mb_segytraceheader_struct traceheader;
+				float *trace = nullptr;
+				status = mb_segy_read_trace(verbose, mbsegyioptr, &traceheader, &trace, &error);
+
+				/* now process the trace */
+				if (status == MB_SUCCESS) {
+					/* figure out where this trace is in the grid */
+					const int tracenum =
+						tracemode == MBSEGYPSD_USESHOT
+						? traceheader.shot_num : traceheader.rp_num;
+					const int channum =
+						tracemode == MBSEGYPSD_USESHOT
+						? traceheader.shot_tr : traceheader.rp_tr;
+					const int tracecount =
+						chanend >= chanstart
+						? (tracenum - tracestart) * (chanend - chanstart + 1) + (channum - chanstart)
+						: tracenum - tracestart;
+					const int ix = tracecount / decimatex;
+					// TODO(schwehr): Why are these casting through float?
+					const double factor =
+						traceheader.elev_scalar < 0
+						? 1.0 / (float)(-traceheader.elev_scalar)
+						: (float)traceheader.elev_scalar;
+					double dtime;
+					double dtimesave = 0.0;
+					if (traceheader.src_depth > 0) {
+						// btime = factor * traceheader.src_depth / 750.0 + 0.001 * traceheader.delay_mils;
+						dtime = factor * traceheader.src_depth / 750.0;
+						// btimesave = btime;
+						dtimesave = dtime;
 					}
-
-					/* get bounds of trace in depth window mode */
-					if (windowmode == MBSEGYPSD_WINDOW_DEPTH) {
-						itstart = (int)((dtime + windowstart - timedelay) / sampleinterval);
-						itstart = std::max(itstart, 0);
-						itend = (int)((dtime + windowend - timedelay) / sampleinterval);
-						itend = std::min(itend, ngridy - 1);
+					else if (traceheader.src_elev > 0) {
+						// btime = -factor * traceheader.src_elev / 750.0 + 0.001 * traceheader.delay_mils;
+						dtime = -factor * traceheader.src_elev / 750.0;
+						// btimesave = btime;
+						dtimesave = dtime;
 					}
-					else if (windowmode == MBSEGYPSD_WINDOW_SEAFLOOR) {
-						itstart = std::max((stime + windowstart - timedelay) / sampleinterval, 0.0);
-						itend = std::min((stime + windowend - timedelay) / sampleinterval, ngridy - 1.0);
+					else {
+						// btime = btimesave;
+						dtime = dtimesave;
+					}
+					double stime;
+					double stimesave = 0.0;
+					if (traceheader.src_wbd > 0) {
+						stime = factor * traceheader.src_wbd / 750.0;
+						stimesave = stime;
+					}
+					else {
+						stime = stimesave;
+					}
+					// const int iys = (btime - timedelay) / sampleinterval;
+
+					/* now check if this is a trace of interest */
+					bool traceok = true;
+					if (tracenum < tracestart || tracenum > traceend)
+						traceok = false;
+					else if (chanend >= chanstart && (channum < chanstart || channum > chanend))
+						traceok = false;
+					else if (tracecount % decimatex != 0)
+						traceok = false;
+
+					/* get trace min and max */
+					double tracemin = trace[0];
+					double tracemax = trace[0];
+					for (int i = 0; i < traceheader.nsamps; i++) {
+						tracemin = std::min(tracemin, static_cast<double>(trace[i]));
+						tracemax = std::max(tracemin, static_cast<double>(trace[i]));
 					}
 
-					/* loop over the data calculating fft in nfft long sections */
-					int nsection = (itend - itstart + 1) / nfft;
-					if (((itend - itstart + 1) % nfft) > 0)
-						nsection++;
-					for (int j = 0; j < nsection; j++) {
-						/* initialize normalization factors */
-						double normraw = 0.0;
-						// double normtaper = 0.0;
-						double normfft = 0.0;
-
-						/* extract data section to be fft'd with taper */
-						const int kstart = itstart + j * nfft;
-						const int kend = std::min(kstart + nfft, itend);
-						for (int i = 0; i < nfft; i++) {
-							const int k = itstart + j * nfft + i;
-							if (k <= kend) {
-								const double sint = sin(M_PI * ((double)(k - kstart)) / ((double)(kend - kstart)));
-								const double taper = sint * sint;
-								fftw_in[i][0] = taper * trace[k];
-								normraw += trace[k] * trace[k];
-								// normtaper += fftw_in[i][0] * fftw_in[i][0];
-							}
-							else
-								fftw_in[i][0] = 0.0;
-							/*if (ix < 500)
-							fftw_in[i][0] = sin(2.0 * M_PI * 1000.0 * i * sampleinterval)
-							            + sin(2.0 * M_PI * 3000.0 * i * sampleinterval)
-							            + sin(2.0 * M_PI * 6000.0 * i * sampleinterval);*/
-							fftw_in[i][1] = 0.0;
-						}
-						// const double soundpressurelevel = 20.0 * log10(normraw / nfft);
-
-						/* execute the fft */
-						fftw_execute(plan);
+					if ((verbose == 0 && nread % 250 == 0) || (nread % 25 == 0)) {
+						if (traceok)
+							fprintf(outfp, "PROCESS ");
+						else
+							fprintf(outfp, "IGNORE  ");
+						if (tracemode == MBSEGYPSD_USESHOT)
+							fprintf(outfp, "read:%d position:%d shot:%d channel:%d ", nread, tracecount, tracenum, channum);
+						else
+							fprintf(outfp, "read:%d position:%d rp:%d channel:%d ", nread, tracecount, tracenum, channum);
+						fprintf(outfp, "%4.4d/%3.3d %2.2d:%2.2d:%2.2d.%3.3d samples:%d interval:%d usec minmax: %f %f\n",
+						        traceheader.year, traceheader.day_of_yr, traceheader.hour, traceheader.min, traceheader.sec,
+						        traceheader.mils, traceheader.nsamps, traceheader.si_micros, tracemin, tracemax);
+					}
 
-						/* get normalization factor - require variance of transform to equal variance of input */
-						for (int i = 1; i < nfft; i++) {
-							normfft += fftw_out[i][0] * fftw_out[i][0] + fftw_out[i][1] * fftw_out[i][1];
+					/* copy traces of interest into the block */
+					if (traceok) {
+						/* get bounds of trace in depth window mode */
+						if (windowmode == MBSEGYPSD_WINDOW_DEPTH) {
+							itstart = (int)((dtime + windowstart - timedelay) / sampleinterval);
+							itstart = std::max(itstart, 0);
+							itend = (int)((dtime + windowend - timedelay) / sampleinterval);
+							itend = std::min(itend, ngridy - 1);
 						}
-						const double norm = normraw / normfft;
-
-						/* apply normalization factor */
-						for (int i = 1; i < nfft; i++) {
-							fftw_out[i][0] = norm * fftw_out[i][0];
-							fftw_out[i][1] = norm * fftw_out[i][1];
+						else if (windowmode == MBSEGYPSD_WINDOW_SEAFLOOR) {
+							itstart = std::max((stime + windowstart - timedelay) / sampleinterval, 0.0);
+							itend = std::min((stime + windowend - timedelay) / sampleinterval, ngridy - 1.0);
 						}
 
-						/* calculate psd from result of transform */
-						spsd[0] += fftw_out[0][0] * fftw_out[0][0] + fftw_out[0][1] * fftw_out[0][1];
-						wpsd[0] += 1.0;
-
-						int i = 1;  // Used after for.
-						for (; i < nfft / 2; i++) {
-							spsd[i] += 2.0 * (fftw_out[i][0] * fftw_out[i][0] + fftw_out[i][1] * fftw_out[i][1]);
-							wpsd[i] += 1.0;
-						}
-						if (nfft % 2 == 0) {
-							spsd[i] +=
-							    fftw_out[nfft / 2][0] * fftw_out[nfft / 2][0] + fftw_out[nfft / 2][1] * fftw_out[nfft / 2][1];
-							wpsd[i] += 1.0;
-						}
+						mbsegypsd_trace_struct *blocktrace = &traces[ntraces];
+						blocktrace->ix = ix;
+						blocktrace->itstart = itstart;
+						blocktrace->itend = itend;
+						const int nsamples = std::max(itend + 1, 0);
+						const int ncopy = std::min(nsamples, (int)traceheader.nsamps);
+						blocktrace->samples.assign(trace, trace + ncopy);
+						blocktrace->samples.resize(nsamples, 0.0);
+						ntraces++;
 					}
+				}
 
-					/* output psd for this trace to the grid */
-					for (int iy = 0; iy < ngridy; iy++) {
-						const int k = (ngridy - 1 - iy) * ngridx + ix;
-						if (wpsd[iy] > 0.0) {
-							if (!logscale)
-								grid[k] = spsd[iy] / wpsd[iy];
-							else
-								grid[k] = 20.0 * log10(spsd[iy] / wpsd[iy]);
-							spsdtot[iy] += grid[k];
-							wpsdtot[iy] += 1.0;
-							gridmintot = std::min(static_cast<double>(grid[k]), gridmintot);
-							gridmaxtot = std::max(static_cast<double>(grid[k]), gridmaxtot);
-						}
-					}
+				/* now process the trace */
+				if (status == MB_SUCCESS)
+					nread++;
+			}
+
+			/* calculate the spectra of the block with each thread taking a contiguous set of traces */
+			if (ntraces > 0) {
+				const int nthreaduse = std::min(n_threads, ntraces);
+				std::thread threads[MB_THREAD_MAX];
+				for (int ithread = 0; ithread < nthreaduse; ithread++) {
+					const int itrace0 = ithread * ntraces / nthreaduse;
+					const int itrace1 = (ithread + 1) * ntraces / nthreaduse;
+					threads[ithread] = std::thread(calculate_spectra, nfft, plan, taper.data(), fftw_in[ithread],
+					                               fftw_out[ithread], &traces[itrace0], itrace1 - itrace0);
 				}
+				for (int ithread = 0; ithread < nthreaduse; ithread++)
+					threads[ithread].join();
 			}
 
-			/* now process the trace */
-			if (status == MB_SUCCESS)
-				nread++;
+			/* output psd for these traces to the grid */
+			for (int itrace = 0; itrace < ntraces; itrace++) {
+				const double *spsd = traces[itrace].spsd.data();
+				const double *wpsd = traces[itrace].wpsd.data();
+				const int ix = traces[itrace].ix;
+				for (int iy = 0; iy < ngridy; iy++) {
+					const int k = (ngridy - 1 - iy) * ngridx + ix;
+					if (wpsd[iy] > 0.0) {
+						if (!logscale)
+							grid[k] = spsd[iy] / wpsd[iy];
+						else
+							grid[k] = 20.0 * log10(spsd[iy] / wpsd[iy]);
+						spsdtot[iy] += grid[k];
+						wpsdtot[iy] += 1.0;
+						gridmintot = std::min(static_cast<double>(grid[k]), gridmintot);
+						gridmaxtot = std::max(static_cast<double>(grid[k]), gridmaxtot);
+					}
+				}
+			}
 		}
 
 		/* deallocate fftw arrays and plan */
 		fftw_destroy_plan(plan);
-		fftw_free(fftw_in);
-		fftw_free(fftw_out);
+		for (int ithread = 0; ithread < n_threads; ithread++) {
+			fftw_free(fftw_in[ithread]);
+			fftw_free(fftw_out[ithread]);
+		}
 	}
 
 	/* write out the grid */
@@ -775,8 +897,6 @@ int main(int argc, char **argv) {
 	// float *worktrace = nullptr;
 	// status &= mb_freed(verbose, __FILE__, __LINE__, (void **)&worktrace, &error);
 	status &= mb_freed(verbose, __FILE__, __LINE__, (void **)&grid, &error);
-	status &= mb_freed(verbose, __FILE__, __LINE__, (void **)&spsd, &error);
-	status &= mb_freed(verbose, __FILE__, __LINE__, (void **)&wpsd, &error);
 	status &= mb_freed(verbose, __FILE__, __LINE__, (void **)&spsdtot, &error);
 	status &= mb_freed(verbose, __FILE__, __LINE__, (void **)&wpsdtot, &error);
 
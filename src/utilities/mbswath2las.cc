@@ -24,18 +24,40 @@
 /*
  * MBswath2las exports swath bathymetry data from swath files to LAS format files.
  *
+ * The output is LAS 1.4 using point data record format 6. Coordinates are
+ * stored as scaled integers, either longitude and latitude or projected
+ * eastings and northings, with elevation positive up. Each point carries
+ * the beam number, the ping number, and the beam amplitude as extra bytes,
+ * and the MB-System beamflag is mapped to the LAS classification and
+ * copied into the user data byte. Points are accumulated in a buffer and
+ * written in large blocks; the header is completed when the file is closed.
+ *
+ * Either all of the swath files are exported to a single LAS file, or each
+ * swath file is exported to its own LAS file, in which case several files
+ * may be exported in parallel.
+ *
  * Author:  D. W. Caress
  * Date:  November 26, 2020
  *
  */
 
+#include <atomic>
 #include <cmath>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
 #include <getopt.h>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <unistd.h>
+#include <vector>
+
+#ifndef USE_PROJ4_API
+#include <proj.h>
+#endif
 
 #include "mb_define.h"
 #include "mb_format.h"
@@ -44,53 +66,701 @@
 
 constexpr char program_name[] = "mbswath2las";
 constexpr char help_message[] =
-    "MBswath2las exports swath bathymetry data from swath files to LAS format files.";
+    "MBswath2las exports swath bathymetry data from swath files to LAS 1.4 format files.";
 constexpr char usage_message[] =
-    "mbswath2las [--input=input --output=outputfile --verbose --help]";
-
-/*--------------------------------------------------------------------*/
-
-int main(int argc, char **argv) {
-  int verbose = 0;
+    "mbswath2las [--input=datalist --output=file.las --format=format --projection=projection\n"
+    "\t--include-flagged --threads=nthreads --bounds=w/e/s/n --start-time=yr/mo/dy/hr/mn/sc\n"
+    "\t--end-time=yr/mo/dy/hr/mn/sc --lonflip=lonflip --speed-min=speed --time-gap=gap\n"
+    "\t--verbose --help]";
+
+/* LAS 1.4 header, variable length record, and point data record format 6
+   with three extra bytes fields: beam (uint16), ping (uint32), amplitude (float) */
+constexpr int MBLAS_HEADER_SIZE = 375;
+constexpr int MBLAS_VLR_HEADER_SIZE = 54;
+constexpr int MBLAS_EXTRA_BYTES_DESCRIPTOR_SIZE = 192;
+constexpr int MBLAS_NUM_EXTRA_BYTES = 3;
+constexpr int MBLAS_POINT_FORMAT = 6;
+constexpr int MBLAS_POINT_SIZE = 30 + 2 + 4 + 4;
+constexpr int MBLAS_BUFFER_POINTS = 65536;
+
+/* LAS classifications and classification flags */
+constexpr unsigned char MBLAS_CLASS_LOW_NOISE = 7;
+constexpr unsigned char MBLAS_CLASS_BATHYMETRY = 40;
+constexpr unsigned char MBLAS_FLAG_SYNTHETIC = 0x01;
+constexpr unsigned char MBLAS_FLAG_WITHHELD = 0x04;
+constexpr unsigned char MBLAS_FLAG_EDGE = 0x80;
+
+/* LAS global encoding: GPS time is adjusted standard GPS time, CRS is WKT */
+constexpr unsigned short MBLAS_GLOBAL_ENCODING = 0x0011;
+
+/* GPS time starts 1980/01/06 00:00:00 UTC and does not include the leap
+   seconds added to UTC since then, which start at the times listed here */
+constexpr double MBLAS_GPS_EPOCH = 315964800.0;
+constexpr double MBLAS_LEAP_SECONDS[] = {
+    362793600.0, 394329600.0, 425865600.0, 489024000.0, 567993600.0, 631152000.0,
+    662688000.0, 709948800.0, 741484800.0, 773020800.0, 820454400.0, 867715200.0,
+    915148800.0, 1136073600.0, 1230768000.0, 1341100800.0, 1435708800.0, 1483228800.0};
+
+constexpr char MBLAS_WKT_GEOGRAPHIC[] =
+    "GEOGCS[\"WGS 84\",DATUM[\"WGS_1984\",SPHEROID[\"WGS 84\",6378137,298.257223563,"
+    "AUTHORITY[\"EPSG\",\"7030\"]],AUTHORITY[\"EPSG\",\"6326\"]],PRIMEM[\"Greenwich\",0,"
+    "AUTHORITY[\"EPSG\",\"8901\"]],UNIT[\"degree\",0.0174532925199433,AUTHORITY[\"EPSG\",\"9122\"]],"
+    "AXIS[\"Latitude\",NORTH],AXIS[\"Longitude\",EAST],AUTHORITY[\"EPSG\",\"4326\"]]";
+
+struct mblas_writer_struct {
+  FILE *fp;
+  mb_path path;
+  std::string wkt;
+  double scale[3];
+  double offset[3];
+  double min[3];
+  double max[3];
+  uint64_t num_points;
+  unsigned int offset_to_points;
+  std::vector<char> buffer;
+  size_t buffer_points;
+};
+
+struct mblas_projection_struct {
+  bool use_projection;
+  mb_path projection_pars;
+  mb_path projection_id;
+  void *pjptr;
+  void *pjctx;
+};
+
+struct mblas_control_struct {
   int format;
   int pings;
-  int pings_read;
   int lonflip;
   double bounds[4];
   int btime_i[7];
   int etime_i[7];
   double speedmin;
   double timegap;
-  int status = mb_defaults(verbose, &format, &pings, &lonflip, bounds, btime_i, etime_i, &speedmin, &timegap);
+  bool include_flagged;
+};
 
-  bool input_datalist = true;
-  char read_file[MB_PATH_MAXLINE] = "datalist.mb-1";
-  char projection_pars[MB_PATH_MAXLINE] = "";
-  bool use_projection = false;
+struct mblas_file_struct {
+  mb_path file;
+  int format;
+  unsigned short file_id;
+};
 
-  /* swathbounds variables */
-  int beam_port = 0;
-  int beam_stbd = 0;
-  int pixel_port = 0;
-  int pixel_stbd = 0;
+/* mb_proj_init() and the PROJ calls used to describe the projection share the
+   default PROJ context, so projections are set up one thread at a time. Each
+   projection is then moved to its own context for the forward projections
+   made by the thread exporting the file (with the PROJ 4 API the forward
+   projections also take the lock). */
+static std::mutex projection_mutex;
 
-  /* projected coordinate system */
-  char projection_id[MB_PATH_MAXLINE] = "";
-  int proj_status;
-  void *pjptr = nullptr;
-  double reference_lon, reference_lat;
+/*--------------------------------------------------------------------*/
+/* Convert an MB-System time (seconds since 1970/01/01 UTC) to adjusted
+   standard GPS time (GPS seconds less one billion). */
+double mblas_gps_time(double time_d) {
+  double leap_seconds = 0.0;
+  for (const double leap : MBLAS_LEAP_SECONDS) {
+    if (time_d >= leap)
+      leap_seconds += 1.0;
+  }
+  return time_d - MBLAS_GPS_EPOCH + leap_seconds - 1.0e9;
+}
+/*--------------------------------------------------------------------*/
+/* Set up the output projection using the first navigation encountered -
+   the default UTM projection uses the zone containing that position. */
+int mblas_projection_init(int verbose, struct mblas_projection_struct *projection,
+                          double navlon, double navlat, std::string *wkt, int *error) {
+  std::lock_guard<std::mutex> lock(projection_mutex);
+
+  /* Default projection is UTM */
+  if (strlen(projection->projection_pars) == 0)
+    strcpy(projection->projection_pars, "U");
+
+  /* check for UTM with undefined zone */
+  if (strcmp(projection->projection_pars, "UTM") == 0 || strcmp(projection->projection_pars, "U") == 0 ||
+      strcmp(projection->projection_pars, "utm") == 0 || strcmp(projection->projection_pars, "u") == 0) {
+    double reference_lon = navlon;
+    if (reference_lon < 180.0)
+      reference_lon += 360.0;
+    if (reference_lon >= 180.0)
+      reference_lon -= 360.0;
+    const int utm_zone = (int)(((reference_lon + 183.0) / 6.0) + 0.5);
+    if (navlat >= 0.0)
+      snprintf(projection->projection_id, sizeof(projection->projection_id), "UTM%2.2dN", utm_zone);
+    else
+      snprintf(projection->projection_id, sizeof(projection->projection_id), "UTM%2.2dS", utm_zone);
+  }
+  else
+    strcpy(projection->projection_id, projection->projection_pars);
+
+  /* if projection not successfully initialized then quit */
+  if (mb_proj_init(verbose, projection->projection_id, &projection->pjptr, error) != MB_SUCCESS) {
+    fprintf(stderr, "\nOutput projection %s not found in database\n", projection->projection_id);
+    fprintf(stderr, "\nProgram <%s> Terminated\n", program_name);
+    *error = MB_ERROR_BAD_PARAMETER;
+    mb_memory_clear(verbose, error);
+    exit(MB_ERROR_BAD_PARAMETER);
+  }
+#ifndef USE_PROJ4_API
+  projection->pjctx = proj_context_create();
+  if (projection->pjctx != nullptr)
+    proj_assign_context((PJ *)projection->pjptr, (PJ_CONTEXT *)projection->pjctx);
+#endif
+
+  /* get the WKT description of the projected coordinate system required by LAS 1.4 */
+  wkt->clear();
+#ifndef USE_PROJ4_API
+  mb_path crs;
   int utm_zone;
-  double naveasting, navnorthing, deasting, dnorthing;
-  double headingx, headingy, mtodeglon, mtodeglat;
+  char utm_ns;
+  if (sscanf(projection->projection_id, "UTM%d%c", &utm_zone, &utm_ns) == 2) {
+    snprintf(crs, sizeof(crs), "EPSG:%d", (utm_ns == 'S' || utm_ns == 's' ? 32700 : 32600) + utm_zone);
+  }
+  else if (strncmp(projection->projection_id, "epsg:", 5) == 0) {
+    snprintf(crs, sizeof(crs), "EPSG:%s", &projection->projection_id[5]);
+  }
+  else if (strncmp(projection->projection_id, "+proj", 5) == 0 && strstr(projection->projection_id, "+type=crs") == nullptr) {
+    snprintf(crs, sizeof(crs), "%s +type=crs", projection->projection_id);
+  }
+  else {
+    strcpy(crs, projection->projection_id);
+  }
+  PJ *pj_crs = proj_create(PJ_DEFAULT_CTX, crs);
+  if (pj_crs != nullptr) {
+    const char *pj_wkt = proj_as_wkt(PJ_DEFAULT_CTX, pj_crs, PJ_WKT1_GDAL, nullptr);
+    if (pj_wkt != nullptr)
+      *wkt = pj_wkt;
+    proj_destroy(pj_crs);
+  }
+#endif
+  if (wkt->empty())
+    fprintf(stderr, "\nUnable to describe projection %s as WKT - the LAS output will lack a coordinate system\n",
+            projection->projection_id);
+
+  if (verbose >= 2) {
+    fprintf(stderr, "\ndbg2  Function <%s> completed\n", __func__);
+    fprintf(stderr, "dbg2  Return values:\n");
+    fprintf(stderr, "dbg2       projection_id:  %s\n", projection->projection_id);
+    fprintf(stderr, "dbg2       pjptr:          %p\n", projection->pjptr);
+    fprintf(stderr, "dbg2       wkt:            %s\n", wkt->c_str());
+    fprintf(stderr, "dbg2       error:          %d\n", *error);
+  }
+
+  return (MB_SUCCESS);
+}
+/*--------------------------------------------------------------------*/
+/* Project a position on the thread exporting the file */
+int mblas_projection_forward(int verbose, struct mblas_projection_struct *projection, double lon, double lat,
+                             double *x, double *y, int *error) {
+#ifdef USE_PROJ4_API
+  std::lock_guard<std::mutex> lock(projection_mutex);
+#endif
+  return mb_proj_forward(verbose, projection->pjptr, lon, lat, x, y, error);
+}
+/*--------------------------------------------------------------------*/
+int mblas_projection_free(int verbose, struct mblas_projection_struct *projection, int *error) {
+  std::lock_guard<std::mutex> lock(projection_mutex);
+  const int status = mb_proj_free(verbose, &projection->pjptr, error);
+#ifndef USE_PROJ4_API
+  if (projection->pjctx != nullptr)
+    proj_context_destroy((PJ_CONTEXT *)projection->pjctx);
+#endif
+  projection->pjctx = nullptr;
+  return (status);
+}
+/*--------------------------------------------------------------------*/
+/* Write (or rewrite on closing) the public header block. */
+void mblas_write_header(int verbose, struct mblas_writer_struct *writer, int num_vlrs) {
+  char header[MBLAS_HEADER_SIZE];
+  memset(header, 0, MBLAS_HEADER_SIZE);
+
+  const time_t now = time(nullptr);
+  struct tm *gmt = gmtime(&now);
+
+  memcpy(&header[0], "LASF", 4);
+  mb_put_binary_short(true, (short)MBLAS_GLOBAL_ENCODING, &header[6]);
+  header[24] = 1;
+  header[25] = 4;
+  strncpy(&header[26], "MB-System", 32);
+  snprintf(&header[58], 32, "%s %s", program_name, MB_VERSION);
+  mb_put_binary_short(true, (short)(gmt->tm_yday + 1), &header[90]);
+  mb_put_binary_short(true, (short)(gmt->tm_year + 1900), &header[92]);
+  mb_put_binary_short(true, (short)MBLAS_HEADER_SIZE, &header[94]);
+  mb_put_binary_int(true, (int)writer->offset_to_points, &header[96]);
+  mb_put_binary_int(true, num_vlrs, &header[100]);
+  header[104] = MBLAS_POINT_FORMAT;
+  mb_put_binary_short(true, (short)MBLAS_POINT_SIZE, &header[105]);
+
+  /* the legacy point counts remain zero for point format 6 */
+  for (int i = 0; i < 3; i++) {
+    mb_put_binary_double(true, writer->scale[i], &header[131 + 8 * i]);
+    mb_put_binary_double(true, writer->offset[i], &header[155 + 8 * i]);
+  }
+  const bool empty = writer->num_points == 0;
+  for (int i = 0; i < 3; i++) {
+    mb_put_binary_double(true, empty ? 0.0 : writer->max[i], &header[179 + 16 * i]);
+    mb_put_binary_double(true, empty ? 0.0 : writer->min[i], &header[187 + 16 * i]);
+  }
+
+  /* every point is a single first return */
+  mb_put_binary_long(true, (mb_s_long)writer->num_points, &header[247]);
+  mb_put_binary_long(true, (mb_s_long)writer->num_points, &header[255]);
+
+  fwrite(header, 1, MBLAS_HEADER_SIZE, writer->fp);
+
+  if (verbose >= 2) {
+    fprintf(stderr, "\ndbg2  Function <%s> completed\n", __func__);
+    fprintf(stderr, "dbg2       path:           %s\n", writer->path);
+    fprintf(stderr, "dbg2       num_points:     %llu\n", (unsigned long long)writer->num_points);
+  }
+}
+/*--------------------------------------------------------------------*/
+void mblas_put_vlr_header(char *buffer, const char *user_id, unsigned short record_id,
+                          unsigned short length, const char *description) {
+  memset(buffer, 0, MBLAS_VLR_HEADER_SIZE);
+  strncpy(&buffer[2], user_id, 16);
+  mb_put_binary_short(true, (short)record_id, &buffer[18]);
+  mb_put_binary_short(true, (short)length, &buffer[20]);
+  strncpy(&buffer[22], description, 32);
+}
+/*--------------------------------------------------------------------*/
+void mblas_put_extra_bytes(char *buffer, unsigned char data_type, const char *name, const char *description) {
+  memset(buffer, 0, MBLAS_EXTRA_BYTES_DESCRIPTOR_SIZE);
+  buffer[2] = data_type;
+  strncpy(&buffer[4], name, 32);
+  strncpy(&buffer[160], description, 32);
+}
+/*--------------------------------------------------------------------*/
+/* Open a LAS file; the scaling and offsets are set from the first position so
+   that the 32 bit integer coordinates span the whole survey. */
+int mblas_open(int verbose, struct mblas_writer_struct *writer, const char *path,
+               bool geographic, const std::string &wkt, double x, double y, int *error) {
+  if (verbose >= 2) {
+    fprintf(stderr, "\ndbg2  Function <%s> called\n", __func__);
+    fprintf(stderr, "dbg2  Input arguments:\n");
+    fprintf(stderr, "dbg2       verbose:        %d\n", verbose);
+    fprintf(stderr, "dbg2       path:           %s\n", path);
+    fprintf(stderr, "dbg2       geographic:     %d\n", geographic);
+    fprintf(stderr, "dbg2       x:              %f\n", x);
+    fprintf(stderr, "dbg2       y:              %f\n", y);
+  }
+
+  strncpy(writer->path, path, sizeof(writer->path) - 1);
+  writer->path[sizeof(writer->path) - 1] = '\0';
+  writer->wkt = geographic ? MBLAS_WKT_GEOGRAPHIC : wkt;
+  if (geographic) {
+    writer->scale[0] = 1.0e-7;
+    writer->scale[1] = 1.0e-7;
+    writer->offset[0] = floor(x);
+    writer->offset[1] = floor(y);
+  }
+  else {
+    writer->scale[0] = 0.001;
+    writer->scale[1] = 0.001;
+    writer->offset[0] = 100000.0 * floor(x / 100000.0);
+    writer->offset[1] = 100000.0 * floor(y / 100000.0);
+  }
+  writer->scale[2] = 0.001;
+  writer->offset[2] = 0.0;
+  for (int i = 0; i < 3; i++) {
+    writer->min[i] = 0.0;
+    writer->max[i] = 0.0;
+  }
+  writer->num_points = 0;
+  writer->buffer.resize((size_t)MBLAS_BUFFER_POINTS * MBLAS_POINT_SIZE);
+  writer->buffer_points = 0;
+
+  if ((writer->fp = fopen(path, "wb")) == nullptr) {
+    *error = MB_ERROR_OPEN_FAIL;
+    return (MB_FAILURE);
+  }
+
+  /* the variable length records describe the coordinate system and the extra bytes */
+  const int num_vlrs = writer->wkt.empty() ? 1 : 2;
+  const size_t wkt_length = writer->wkt.empty() ? 0 : writer->wkt.length() + 1;
+  writer->offset_to_points = MBLAS_HEADER_SIZE
+                            + num_vlrs * MBLAS_VLR_HEADER_SIZE
+                            + MBLAS_NUM_EXTRA_BYTES * MBLAS_EXTRA_BYTES_DESCRIPTOR_SIZE
+                            + wkt_length;
+  mblas_write_header(verbose, writer, num_vlrs);
+
+  char vlr[MBLAS_VLR_HEADER_SIZE];
+  if (!writer->wkt.empty()) {
+    mblas_put_vlr_header(vlr, "LASF_Projection", 2112, (unsigned short)wkt_length, "OGC Coordinate System WKT");
+    fwrite(vlr, 1, MBLAS_VLR_HEADER_SIZE, writer->fp);
+    fwrite(writer->wkt.c_str(), 1, wkt_length, writer->fp);
+  }
+
+  char descriptors[MBLAS_NUM_EXTRA_BYTES * MBLAS_EXTRA_BYTES_DESCRIPTOR_SIZE];
+  mblas_put_extra_bytes(&descriptors[0], 3, "beam", "Swath beam number");
+  mblas_put_extra_bytes(&descriptors[MBLAS_EXTRA_BYTES_DESCRIPTOR_SIZE], 5, "ping", "Ping number within file");
+  mblas_put_extra_bytes(&descriptors[2 * MBLAS_EXTRA_BYTES_DESCRIPTOR_SIZE], 9, "amplitude", "Beam amplitude");
+  mblas_put_vlr_header(vlr, "LASF_Spec", 4, (unsigned short)sizeof(descriptors), "Extra bytes");
+  fwrite(vlr, 1, MBLAS_VLR_HEADER_SIZE, writer->fp);
+  fwrite(descriptors, 1, sizeof(descriptors), writer->fp);
+
+  *error = MB_ERROR_NO_ERROR;
+  return (MB_SUCCESS);
+}
+/*--------------------------------------------------------------------*/
+int mblas_flush(int verbose, struct mblas_writer_struct *writer, int *error) {
+  if (writer->buffer_points > 0) {
+    const size_t size = writer->buffer_points * MBLAS_POINT_SIZE;
+    if (fwrite(writer->buffer.data(), 1, size, writer->fp) != size) {
+      *error = MB_ERROR_WRITE_FAIL;
+      return (MB_FAILURE);
+    }
+    writer->buffer_points = 0;
+  }
+  return (MB_SUCCESS);
+}
+/*--------------------------------------------------------------------*/
+/* Add a point to the output buffer, writing the buffer when it is full. */
+int mblas_write_point(int verbose, struct mblas_writer_struct *writer,
+                      double x, double y, double z, double gps_time, double scan_angle,
+                      unsigned char classification, unsigned char flags, unsigned char user_data,
+                      unsigned short source_id, unsigned short beam, unsigned int ping, float amplitude,
+                      int *error) {
+  char *point = &writer->buffer[writer->buffer_points * MBLAS_POINT_SIZE];
+  const double xyz[3] = {x, y, z};
+  for (int i = 0; i < 3; i++) {
+    const int ixyz = (int)lround((xyz[i] - writer->offset[i]) / writer->scale[i]);
+    mb_put_binary_int(true, ixyz, &point[4 * i]);
+    const double value = writer->offset[i] + ixyz * writer->scale[i];
+    if (writer->num_points == 0 || value < writer->min[i])
+      writer->min[i] = value;
+    if (writer->num_points == 0 || value > writer->max[i])
+      writer->max[i] = value;
+  }
+  mb_put_binary_short(true, 0, &point[12]);
+  point[14] = 0x11;
+  point[15] = flags;
+  point[16] = classification;
+  point[17] = user_data;
+  mb_put_binary_short(true, (short)lround(scan_angle / 0.006), &point[18]);
+  mb_put_binary_short(true, (short)source_id, &point[20]);
+  mb_put_binary_double(true, gps_time, &point[22]);
+  mb_put_binary_short(true, (short)beam, &point[30]);
+  mb_put_binary_int(true, (int)ping, &point[32]);
+  mb_put_binary_float(true, amplitude, &point[36]);
+  writer->num_points++;
+  writer->buffer_points++;
+
+  if (writer->buffer_points == MBLAS_BUFFER_POINTS)
+    return (mblas_flush(verbose, writer, error));
+  return (MB_SUCCESS);
+}
+/*--------------------------------------------------------------------*/
+/* Write any buffered points, then complete the header with the point count
+   and bounds. */
+int mblas_close(int verbose, struct mblas_writer_struct *writer, int *error) {
+  int status = mblas_flush(verbose, writer, error);
+  if (status == MB_SUCCESS) {
+    fseek(writer->fp, 0, SEEK_SET);
+    mblas_write_header(verbose, writer, writer->wkt.empty() ? 1 : 2);
+  }
+  if (fclose(writer->fp) != 0 && status == MB_SUCCESS) {
+    *error = MB_ERROR_WRITE_FAIL;
+    status = MB_FAILURE;
+  }
+  writer->fp = nullptr;
+  writer->buffer.clear();
+  writer->buffer.shrink_to_fit();
+
+  if (verbose >= 1)
+    fprintf(stderr, "%llu points written to %s\n", (unsigned long long)writer->num_points, writer->path);
+
+  return (status);
+}
+/*--------------------------------------------------------------------*/
+/* Export the soundings of one swath file. If writer is not open yet it is
+   opened to path using the first navigation read. */
+void export_file(int verbose, struct mblas_control_struct *control, struct mblas_file_struct *input,
+                 struct mblas_projection_struct *projection, struct mblas_writer_struct *writer,
+                 const char *path, int *status, int *error) {
+  double btime_d;
+  double etime_d;
+  int beams_bath;
+  int beams_amp;
+  int pixels_ss;
+
+  /* MBIO read values */
+  void *mbio_ptr = nullptr;
+  void *store_ptr = nullptr;
+  int kind;
+  int time_i[7];
+  double time_d;
+  double navlon;
+  double navlat;
+  double speed;
+  double heading;
+  double distance;
+  double altitude;
+  double sensordepth;
+  char *beamflag = nullptr;
+  double *bath = nullptr;
+  double *bathacrosstrack = nullptr;
+  double *bathalongtrack = nullptr;
+  double *amp = nullptr;
+  double *ss = nullptr;
+  double *ssacrosstrack = nullptr;
+  double *ssalongtrack = nullptr;
+  char comment[MB_COMMENT_MAXLINE];
+
+  *error = MB_ERROR_NO_ERROR;
+
+  /* initialize reading the swath file */
+  if (mb_read_init(verbose, input->file, input->format, control->pings, control->lonflip, control->bounds,
+                   control->btime_i, control->etime_i, control->speedmin, control->timegap, &mbio_ptr,
+                   &btime_d, &etime_d, &beams_bath, &beams_amp, &pixels_ss, error) != MB_SUCCESS) {
+    char *message;
+    mb_error(verbose, *error, &message);
+    fprintf(stderr, "\nMBIO Error returned from function <mb_read_init>:\n%s\n", message);
+    fprintf(stderr, "\nMultibeam File <%s> not initialized for reading\n", input->file);
+    fprintf(stderr, "\nProgram <%s> Terminated\n", program_name);
+    exit(*error);
+  }
+
+  /* allocate memory for data arrays */
+  if (*error == MB_ERROR_NO_ERROR)
+    mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_BATHYMETRY, sizeof(char), (void **)&beamflag, error);
+  if (*error == MB_ERROR_NO_ERROR)
+    mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_BATHYMETRY, sizeof(double), (void **)&bath, error);
+  if (*error == MB_ERROR_NO_ERROR)
+    mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_AMPLITUDE, sizeof(double), (void **)&amp, error);
+  if (*error == MB_ERROR_NO_ERROR)
+    mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_BATHYMETRY, sizeof(double), (void **)&bathacrosstrack, error);
+  if (*error == MB_ERROR_NO_ERROR)
+    mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_BATHYMETRY, sizeof(double), (void **)&bathalongtrack, error);
+  if (*error == MB_ERROR_NO_ERROR)
+    mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_SIDESCAN, sizeof(double), (void **)&ss, error);
+  if (*error == MB_ERROR_NO_ERROR)
+    mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_SIDESCAN, sizeof(double), (void **)&ssacrosstrack, error);
+  if (*error == MB_ERROR_NO_ERROR)
+    mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_SIDESCAN, sizeof(double), (void **)&ssalongtrack, error);
+
+  /* if error initializing memory then quit */
+  if (*error != MB_ERROR_NO_ERROR) {
+    char *message;
+    mb_error(verbose, *error, &message);
+    fprintf(stderr, "\nMBIO Error allocating data arrays:\n%s\n", message);
+    fprintf(stderr, "\nProgram <%s> Terminated\n", program_name);
+    exit(*error);
+  }
+
+  /* read and export data */
+  unsigned int nping = 0;
+  uint64_t nflagged = 0;
+  const uint64_t npoints_start = writer->fp != nullptr ? writer->num_points : 0;
+  std::string wkt;
+  while (*error <= MB_ERROR_NO_ERROR) {
+    /* reset error */
+    *error = MB_ERROR_NO_ERROR;
+
+    /* read next data record */
+    *status = mb_get_all(verbose, mbio_ptr, &store_ptr, &kind, time_i, &time_d, &navlon, &navlat, &speed, &heading,
+                         &distance, &altitude, &sensordepth, &beams_bath, &beams_amp, &pixels_ss, beamflag, bath, amp,
+                         bathacrosstrack, bathalongtrack, ss, ssacrosstrack, ssalongtrack, comment, error);
+
+    /* time gaps are not a problem here */
+    if (*error == MB_ERROR_TIME_GAP) {
+      *error = MB_ERROR_NO_ERROR;
+      *status = MB_SUCCESS;
+    }
+
+    /* make sure non survey data records are ignored */
+    if (*error == MB_ERROR_NO_ERROR && kind != MB_DATA_DATA)
+      *error = MB_ERROR_OTHER;
+
+    if (verbose >= 2) {
+      fprintf(stderr, "\ndbg2  Ping read in program <%s>\n", program_name);
+      fprintf(stderr, "dbg2       kind:           %d\n", kind);
+      fprintf(stderr, "dbg2       error:          %d\n", *error);
+      fprintf(stderr, "dbg2       status:         %d\n", *status);
+    }
+
+    if (*error != MB_ERROR_NO_ERROR)
+      continue;
+
+    /* set up the projection and open the output file with the first navigation */
+    if (projection->use_projection && projection->pjptr == nullptr)
+      mblas_projection_init(verbose, projection, navlon, navlat, &wkt, error);
+    if (writer->fp == nullptr) {
+      double x = navlon;
+      double y = navlat;
+      if (projection->use_projection)
+        mblas_projection_forward(verbose, projection, navlon, navlat, &x, &y, error);
+      if (mblas_open(verbose, writer, path, !projection->use_projection, wkt, x, y, error) != MB_SUCCESS) {
+        fprintf(stderr, "\nUnable to open output LAS file %s\n", path);
+        fprintf(stderr, "\nProgram <%s> Terminated\n", program_name);
+        exit(*error);
+      }
+    }
+
+    /* get factors for lon lat calculations */
+    double mtodeglon;
+    double mtodeglat;
+    mb_coor_scale(verbose, navlat, &mtodeglon, &mtodeglat);
+    const double headingx = sin(DTR * heading);
+    const double headingy = cos(DTR * heading);
+    const double gps_time = mblas_gps_time(time_d);
+
+    /* now loop over beams */
+    for (int j = 0; j < beams_bath; j++) {
+      if (mb_beam_check_flag_null(beamflag[j]))
+        continue;
+      unsigned char classification = MBLAS_CLASS_BATHYMETRY;
+      unsigned char flags = 0;
+      if (!mb_beam_ok(beamflag[j])) {
+        nflagged++;
+        if (!control->include_flagged)
+          continue;
+        classification = MBLAS_CLASS_LOW_NOISE;
+        flags |= MBLAS_FLAG_WITHHELD;
+        if (mb_beam_check_flag_interpolate(beamflag[j]))
+          flags |= MBLAS_FLAG_SYNTHETIC;
+      }
+      if (j == 0 || j == beams_bath - 1)
+        flags |= MBLAS_FLAG_EDGE;
+
+      double x = navlon + headingy * mtodeglon * bathacrosstrack[j] + headingx * mtodeglon * bathalongtrack[j];
+      double y = navlat - headingx * mtodeglat * bathacrosstrack[j] + headingy * mtodeglat * bathalongtrack[j];
+      if (projection->use_projection)
+        mblas_projection_forward(verbose, projection, x, y, &x, &y, error);
+      const double scan_angle = RTD * atan2(bathacrosstrack[j], bath[j] - sensordepth);
+      const float amplitude = beams_amp == beams_bath ? (float)amp[j] : 0.0f;
+
+      if (mblas_write_point(verbose, writer, x, y, -bath[j], gps_time, scan_angle, classification, flags,
+                            (unsigned char)beamflag[j], input->file_id, (unsigned short)j, nping,
+                            amplitude, error) != MB_SUCCESS) {
+        fprintf(stderr, "\nUnable to write to output LAS file %s\n", writer->path);
+        fprintf(stderr, "\nProgram <%s> Terminated\n", program_name);
+        exit(*error);
+      }
+    }
+    nping++;
+  }
+
+  /* close the swath file */
+  *status = mb_close(verbose, &mbio_ptr, error);
+
+  if (verbose >= 1)
+    fprintf(stderr, "%s: %u pings, %llu soundings exported, %llu flagged soundings %s\n", input->file, nping,
+            (unsigned long long)(writer->num_points - npoints_start), (unsigned long long)nflagged,
+            control->include_flagged ? "exported as withheld" : "skipped");
+}
+/*--------------------------------------------------------------------*/
+/* Export files from the list, each to its own LAS file, taking the next
+   unclaimed file until the list is exhausted. */
+void export_files(int verbose, struct mblas_control_struct *control, std::vector<struct mblas_file_struct> *files,
+                  std::atomic<size_t> *next_file, struct mblas_projection_struct *projection_template,
+                  int *status, int *error) {
+  size_t ifile;
+  while ((ifile = (*next_file)++) < files->size()) {
+    struct mblas_file_struct *input = &(*files)[ifile];
+
+    /* each file gets its own projection, so the default UTM zone follows the data */
+    struct mblas_projection_struct projection = *projection_template;
+    projection.pjptr = nullptr;
+    projection.pjctx = nullptr;
+
+    mb_path fileroot;
+    mb_path path;
+    int format;
+    if (mb_get_format(verbose, input->file, fileroot, &format, error) != MB_SUCCESS)
+      strcpy(fileroot, input->file);
+    snprintf(path, sizeof(path), "%s.las", fileroot);
+
+    struct mblas_writer_struct writer;
+    writer.fp = nullptr;
+    writer.num_points = 0;
+    export_file(verbose, control, input, &projection, &writer, path, status, error);
+    if (writer.fp != nullptr)
+      *status = mblas_close(verbose, &writer, error);
+    if (projection.pjptr != nullptr)
+      mblas_projection_free(verbose, &projection, error);
+  }
+}
+/*--------------------------------------------------------------------*/
+
+int main(int argc, char **argv) {
+  int verbose = 0;
+  struct mblas_control_struct control;
+  int status = mb_defaults(verbose, &control.format, &control.pings, &control.lonflip, control.bounds,
+                           control.btime_i, control.etime_i, &control.speedmin, &control.timegap);
+  control.include_flagged = false;
+
+  char read_file[MB_PATH_MAXLINE] = "datalist.mb-1";
+  char output_file[MB_PATH_MAXLINE] = "";
+  bool output_specified = false;
+  unsigned int num_threads = 1;
+
+  /* projected coordinate system */
+  struct mblas_projection_struct projection;
+  projection.use_projection = false;
+  projection.projection_pars[0] = '\0';
+  projection.projection_id[0] = '\0';
+  projection.pjptr = nullptr;
+  projection.pjctx = nullptr;
 
   /* process argument list */
   {
     bool errflg = false;
     bool help = false;
     int c;
-    while ((c = getopt(argc, argv, "B:b:E:e:F:f:I:i:J:j:L:l:R:r:S:s:T:t:VvHh")) !=
+    const struct option options[] =
+        {{"verbose", no_argument, nullptr, 0},
+         {"help", no_argument, nullptr, 0},
+         {"input", required_argument, nullptr, 0},
+         {"output", required_argument, nullptr, 0},
+         {"format", required_argument, nullptr, 0},
+         {"projection", required_argument, nullptr, 0},
+         {"include-flagged", no_argument, nullptr, 0},
+         {"threads", required_argument, nullptr, 0},
+         {"bounds", required_argument, nullptr, 0},
+         {"start-time", required_argument, nullptr, 0},
+         {"end-time", required_argument, nullptr, 0},
+         {"lonflip", required_argument, nullptr, 0},
+         {"speed-min", required_argument, nullptr, 0},
+         {"time-gap", required_argument, nullptr, 0},
+         {nullptr, 0, nullptr, 0}};
+    int option_index;
+    while ((c = getopt_long(argc, argv, "AaB:b:C:c:E:e:F:f:I:i:J:j:L:l:O:o:R:r:S:s:T:t:VvHh", options, &option_index)) !=
            -1)
     {
+      /* map long options onto the equivalent short options */
+      if (c == 0) {
+        const char *name = options[option_index].name;
+        if (strcmp("verbose", name) == 0)
+          c = 'V';
+        else if (strcmp("help", name) == 0)
+          c = 'H';
+        else if (strcmp("input", name) == 0)
+          c = 'I';
+        else if (strcmp("output", name) == 0)
+          c = 'O';
+        else if (strcmp("format", name) == 0)
+          c = 'F';
+        else if (strcmp("projection", name) == 0)
+          c = 'J';
+        else if (strcmp("include-flagged", name) == 0)
+          c = 'A';
+        else if (strcmp("threads", name) == 0)
+          c = 'C';
+        else if (strcmp("bounds", name) == 0)
+          c = 'R';
+        else if (strcmp("start-time", name) == 0)
+          c = 'B';
+        else if (strcmp("end-time", name) == 0)
+          c = 'E';
+        else if (strcmp("lonflip", name) == 0)
+          c = 'L';
+        else if (strcmp("speed-min", name) == 0)
+          c = 'S';
+        else if (strcmp("time-gap", name) == 0)
+          c = 'T';
+      }
+
       switch (c) {
       case 'H':
       case 'h':
@@ -100,19 +770,29 @@ int main(int argc, char **argv) {
       case 'v':
         verbose++;
         break;
+      case 'A':
+      case 'a':
+        control.include_flagged = true;
+        break;
       case 'B':
       case 'b':
-        sscanf(optarg, "%d/%d/%d/%d/%d/%d", &btime_i[0], &btime_i[1], &btime_i[2], &btime_i[3], &btime_i[4], &btime_i[5]);
-        btime_i[6] = 0;
+        sscanf(optarg, "%d/%d/%d/%d/%d/%d", &control.btime_i[0], &control.btime_i[1], &control.btime_i[2],
+               &control.btime_i[3], &control.btime_i[4], &control.btime_i[5]);
+        control.btime_i[6] = 0;
+        break;
+      case 'C':
+      case 'c':
+        sscanf(optarg, "%u", &num_threads);
         break;
       case 'E':
       case 'e':
-        sscanf(optarg, "%d/%d/%d/%d/%d/%d", &etime_i[0], &etime_i[1], &etime_i[2], &etime_i[3], &etime_i[4], &etime_i[5]);
-        etime_i[6] = 0;
+        sscanf(optarg, "%d/%d/%d/%d/%d/%d", &control.etime_i[0], &control.etime_i[1], &control.etime_i[2],
+               &control.etime_i[3], &control.etime_i[4], &control.etime_i[5]);
+        control.etime_i[6] = 0;
         break;
       case 'F':
       case 'f':
-        sscanf(optarg, "%d", &format);
+        sscanf(optarg, "%d", &control.format);
         break;
       case 'I':
       case 'i':
@@ -120,24 +800,29 @@ int main(int argc, char **argv) {
         break;
       case 'J':
       case 'j':
-        sscanf(optarg, "%1023s", projection_pars);
-        use_projection = true;
+        sscanf(optarg, "%1023s", projection.projection_pars);
+        projection.use_projection = true;
         break;
       case 'L':
       case 'l':
-        sscanf(optarg, "%d", &lonflip);
+        sscanf(optarg, "%d", &control.lonflip);
+        break;
+      case 'O':
+      case 'o':
+        sscanf(optarg, "%1023s", output_file);
+        output_specified = true;
         break;
       case 'R':
       case 'r':
-        mb_get_bounds(optarg, bounds);
+        mb_get_bounds(optarg, control.bounds);
         break;
       case 'S':
       case 's':
-        sscanf(optarg, "%lf", &speedmin);
+        sscanf(optarg, "%lf", &control.speedmin);
         break;
       case 'T':
       case 't':
-        sscanf(optarg, "%lf", &timegap);
+        sscanf(optarg, "%lf", &control.timegap);
         break;
       case '?':
         errflg = true;
@@ -155,34 +840,44 @@ int main(int argc, char **argv) {
       fprintf(stderr, "MB-system Version %s\n", MB_VERSION);
     }
 
+    /* get number of threads to use */
+    const unsigned int num_concurrency = std::thread::hardware_concurrency();
+    num_threads = MAX(1, MIN(num_threads, MIN(MAX(num_concurrency, 1), MB_THREAD_MAX)));
+
     if (verbose >= 2) {
       fprintf(stderr, "\ndbg2  Program <%s>\n", program_name);
       fprintf(stderr, "dbg2  MB-system Version %s\n", MB_VERSION);
       fprintf(stderr, "dbg2  Control Parameters:\n");
-      fprintf(stderr, "dbg2       verbose:        %d\n", verbose);
-      fprintf(stderr, "dbg2       help:           %d\n", help);
-      fprintf(stderr, "dbg2       format:         %d\n", format);
-      fprintf(stderr, "dbg2       lonflip:        %d\n", lonflip);
-      fprintf(stderr, "dbg2       bounds[0]:      %f\n", bounds[0]);
-      fprintf(stderr, "dbg2       bounds[1]:      %f\n", bounds[1]);
-      fprintf(stderr, "dbg2       bounds[2]:      %f\n", bounds[2]);
-      fprintf(stderr, "dbg2       bounds[3]:      %f\n", bounds[3]);
-      fprintf(stderr, "dbg2       btime_i[0]:     %d\n", btime_i[0]);
-      fprintf(stderr, "dbg2       btime_i[1]:     %d\n", btime_i[1]);
-      fprintf(stderr, "dbg2       btime_i[2]:     %d\n", btime_i[2]);
-      fprintf(stderr, "dbg2       btime_i[3]:     %d\n", btime_i[3]);
-      fprintf(stderr, "dbg2       btime_i[4]:     %d\n", btime_i[4]);
-      fprintf(stderr, "dbg2       btime_i[5]:     %d\n", btime_i[5]);
-      fprintf(stderr, "dbg2       btime_i[6]:     %d\n", btime_i[6]);
-      fprintf(stderr, "dbg2       etime_i[0]:     %d\n", etime_i[0]);
-      fprintf(stderr, "dbg2       etime_i[1]:     %d\n", etime_i[1]);
-      fprintf(stderr, "dbg2       etime_i[2]:     %d\n", etime_i[2]);
-      fprintf(stderr, "dbg2       etime_i[3]:     %d\n", etime_i[3]);
-      fprintf(stderr, "dbg2       etime_i[4]:     %d\n", etime_i[4]);
-      fprintf(stderr, "dbg2       etime_i[5]:     %d\n", etime_i[5]);
-      fprintf(stderr, "dbg2       etime_i[6]:     %d\n", etime_i[6]);
-      fprintf(stderr, "dbg2       speedmin:       %f\n", speedmin);
-      fprintf(stderr, "dbg2       timegap:        %f\n", timegap);
+      fprintf(stderr, "dbg2       verbose:         %d\n", verbose);
+      fprintf(stderr, "dbg2       help:            %d\n", help);
+      fprintf(stderr, "dbg2       format:          %d\n", control.format);
+      fprintf(stderr, "dbg2       lonflip:         %d\n", control.lonflip);
+      fprintf(stderr, "dbg2       bounds[0]:       %f\n", control.bounds[0]);
+      fprintf(stderr, "dbg2       bounds[1]:       %f\n", control.bounds[1]);
+      fprintf(stderr, "dbg2       bounds[2]:       %f\n", control.bounds[2]);
+      fprintf(stderr, "dbg2       bounds[3]:       %f\n", control.bounds[3]);
+      fprintf(stderr, "dbg2       btime_i[0]:      %d\n", control.btime_i[0]);
+      fprintf(stderr, "dbg2       btime_i[1]:      %d\n", control.btime_i[1]);
+      fprintf(stderr, "dbg2       btime_i[2]:      %d\n", control.btime_i[2]);
+      fprintf(stderr, "dbg2       btime_i[3]:      %d\n", control.btime_i[3]);
+      fprintf(stderr, "dbg2       btime_i[4]:      %d\n", control.btime_i[4]);
+      fprintf(stderr, "dbg2       btime_i[5]:      %d\n", control.btime_i[5]);
+      fprintf(stderr, "dbg2       btime_i[6]:      %d\n", control.btime_i[6]);
+      fprintf(stderr, "dbg2       etime_i[0]:      %d\n", control.etime_i[0]);
+      fprintf(stderr, "dbg2       etime_i[1]:      %d\n", control.etime_i[1]);
+      fprintf(stderr, "dbg2       etime_i[2]:      %d\n", control.etime_i[2]);
+      fprintf(stderr, "dbg2       etime_i[3]:      %d\n", control.etime_i[3]);
+      fprintf(stderr, "dbg2       etime_i[4]:      %d\n", control.etime_i[4]);
+      fprintf(stderr, "dbg2       etime_i[5]:      %d\n", control.etime_i[5]);
+      fprintf(stderr, "dbg2       etime_i[6]:      %d\n", control.etime_i[6]);
+      fprintf(stderr, "dbg2       speedmin:        %f\n", control.speedmin);
+      fprintf(stderr, "dbg2       timegap:         %f\n", control.timegap);
+      fprintf(stderr, "dbg2       read_file:       %s\n", read_file);
+      fprintf(stderr, "dbg2       output_file:     %s\n", output_file);
+      fprintf(stderr, "dbg2       include_flagged: %d\n", control.include_flagged);
+      fprintf(stderr, "dbg2       use_projection:  %d\n", projection.use_projection);
+      fprintf(stderr, "dbg2       projection_pars: %s\n", projection.projection_pars);
+      fprintf(stderr, "dbg2       num_threads:     %u\n", num_threads);
     }
 
     if (help) {
@@ -194,222 +889,69 @@ int main(int argc, char **argv) {
 
   int error = MB_ERROR_NO_ERROR;
 
-  if (format == 0)
-    mb_get_format(verbose, read_file, nullptr, &format, &error);
-
-  /* determine whether to read one file or a list of files */
-  const bool read_datalist = format < 0;
-  bool read_data;
-  void *datalist;
-  char file[MB_PATH_MAXLINE] = "";
-  char dfile[MB_PATH_MAXLINE] = "";
-  double file_weight;
+  if (control.format == 0)
+    mb_get_format(verbose, read_file, nullptr, &control.format, &error);
 
-  /* open file list */
-  if (read_datalist) {
+  /* get the list of files to be read */
+  std::vector<struct mblas_file_struct> files;
+  struct mblas_file_struct input;
+  if (control.format < 0) {
+    void *datalist;
+    char dfile[MB_PATH_MAXLINE] = "";
+    double file_weight;
     const int look_processed = MB_DATALIST_LOOK_UNSET;
     if (mb_datalist_open(verbose, &datalist, read_file, look_processed, &error) != MB_SUCCESS) {
       fprintf(stderr, "\nUnable to open data list file: %s\n", read_file);
       fprintf(stderr, "\nProgram <%s> Terminated\n", program_name);
       exit(MB_ERROR_OPEN_FAIL);
     }
-    read_data = mb_datalist_read(verbose, datalist, file, dfile, &format, &file_weight, &error) == MB_SUCCESS;
+    while (mb_datalist_read(verbose, datalist, input.file, dfile, &input.format, &file_weight, &error) == MB_SUCCESS) {
+      input.file_id = (unsigned short)(files.size() + 1);
+      files.push_back(input);
+    }
+    mb_datalist_close(verbose, &datalist, &error);
   } else {
     // else copy single filename to be read
-    strcpy(file, read_file);
-    read_data = true;
+    strcpy(input.file, read_file);
+    input.format = control.format;
+    input.file_id = 1;
+    files.push_back(input);
   }
 
-  double btime_d;
-  double etime_d;
-  int beams_bath;
-  int beams_amp;
-  int pixels_ss;
-
-  /* MBIO read values */
-  void *mbio_ptr = nullptr;
-  void *store_ptr = nullptr;
-  int kind;
-  int time_i[7];
-  double time_d;
-  double navlon;
-  double navlat;
-  double speed;
-  double heading;
-  double distance;
-  double altitude;
-  double sensordepth;
-  double draft;
-  double roll;
-  double pitch;
-  double heave;
-  char *beamflag = nullptr;
-  double *bath = nullptr;
-  double *bathacrosstrack = nullptr;
-  double *bathalongtrack = nullptr;
-  int *detect = nullptr;
-  double *amp = nullptr;
-  double *ss = nullptr;
-  double *ssacrosstrack = nullptr;
-  double *ssalongtrack = nullptr;
-  char comment[MB_COMMENT_MAXLINE];
-  int icomment = 0;
-
-  /* loop over all files to be read */
-  while (read_data) {
-
-    /* initialize reading the swath file */
-    if (mb_read_init(verbose, file, format, pings, lonflip, bounds, btime_i, etime_i, speedmin, timegap, &mbio_ptr,
-                               &btime_d, &etime_d, &beams_bath, &beams_amp, &pixels_ss, &error) != MB_SUCCESS) {
-      char *message;
-      mb_error(verbose, error, &message);
-      fprintf(stderr, "\nMBIO Error returned from function <mb_read_init>:\n%s\n", message);
-      fprintf(stderr, "\nMultibeam File <%s> not initialized for reading\n", file);
-      fprintf(stderr, "\nProgram <%s> Terminated\n", program_name);
-      exit(error);
-    }
-
-    /* allocate memory for data arrays */
-    if (error == MB_ERROR_NO_ERROR)
-      /* status &= */ mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_BATHYMETRY, sizeof(char), (void **)&beamflag, &error);
-    if (error == MB_ERROR_NO_ERROR)
-      /* status &= */ mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_BATHYMETRY, sizeof(double), (void **)&bath, &error);
-    if (error == MB_ERROR_NO_ERROR)
-      /* status &= */ mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_AMPLITUDE, sizeof(double), (void **)&amp, &error);
-    if (error == MB_ERROR_NO_ERROR)
-      /* status &= */
-          mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_BATHYMETRY, sizeof(double), (void **)&bathacrosstrack, &error);
-    if (error == MB_ERROR_NO_ERROR)
-      /* status &= */
-          mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_BATHYMETRY, sizeof(double), (void **)&bathalongtrack, &error);
-    if (error == MB_ERROR_NO_ERROR)
-      /* status &= */ mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_SIDESCAN, sizeof(double), (void **)&ss, &error);
-    if (error == MB_ERROR_NO_ERROR)
-      /* status &= */ mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_SIDESCAN, sizeof(double), (void **)&ssacrosstrack, &error);
-    if (error == MB_ERROR_NO_ERROR)
-      /* status &= */ mb_register_array(verbose, mbio_ptr, MB_MEM_TYPE_SIDESCAN, sizeof(double), (void **)&ssalongtrack, &error);
-
-    /* if error initializing memory then quit */
-    if (error != MB_ERROR_NO_ERROR) {
-      char *message;
-      mb_error(verbose, error, &message);
-      fprintf(stderr, "\nMBIO Error allocating data arrays:\n%s\n", message);
-      fprintf(stderr, "\nProgram <%s> Terminated\n", program_name);
-      exit(error);
+  /* export everything into a single LAS file, one swath file after another */
+  if (output_specified) {
+    struct mblas_writer_struct writer;
+    writer.fp = nullptr;
+    writer.num_points = 0;
+    for (size_t ifile = 0; ifile < files.size(); ifile++) {
+      export_file(verbose, &control, &files[ifile], &projection, &writer, output_file, &status, &error);
     }
+    if (writer.fp != nullptr)
+      status = mblas_close(verbose, &writer, &error);
+    else
+      fprintf(stderr, "\nNo survey data found - output LAS file %s not written\n", output_file);
+    if (projection.pjptr != nullptr)
+      mblas_projection_free(verbose, &projection, &error);
+  }
 
-    /* read and print data */
-    int nread = 0;
-    bool first = true;
-    while (error <= MB_ERROR_NO_ERROR) {
-      /* reset error */
-      error = MB_ERROR_NO_ERROR;
-
-      /* read next data record */
-      status = mb_get_all(verbose, mbio_ptr, &store_ptr, &kind, time_i, &time_d, &navlon, &navlat, &speed, &heading,
-                          &distance, &altitude, &sensordepth, &beams_bath, &beams_amp, &pixels_ss, beamflag, bath, amp,
-                          bathacrosstrack, bathalongtrack, ss, ssacrosstrack, ssalongtrack, comment, &error);
-
-      /* time gaps are not a problem here */
-      if (error == MB_ERROR_TIME_GAP) {
-        error = MB_ERROR_NO_ERROR;
-        status = MB_SUCCESS;
-      }
-
-      /* if survey data extract nav */
-      if (error == MB_ERROR_NO_ERROR && kind == MB_DATA_DATA)
-        status = mb_extract_nav(verbose, mbio_ptr, store_ptr, &kind, time_i, &time_d, &navlon, &navlat, &speed,
-                                &heading, &draft, &roll, &pitch, &heave, &error);
-
-      /* make sure non survey data records are ignored */
-      if (error == MB_ERROR_NO_ERROR && kind != MB_DATA_DATA)
-        error = MB_ERROR_OTHER;
-
-      /* get projected navigation if needed */
-      if (error <= MB_ERROR_NO_ERROR && kind == MB_DATA_DATA && use_projection) {
-        /* set up projection if this is the first data */
-        if (pjptr == nullptr) {
-          /* Default projection is UTM */
-          if (strlen(projection_pars) == 0)
-            strcpy(projection_pars, "U");
-
-          /* check for UTM with undefined zone */
-          if (strcmp(projection_pars, "UTM") == 0 || strcmp(projection_pars, "U") == 0 ||
-              strcmp(projection_pars, "utm") == 0 || strcmp(projection_pars, "u") == 0) {
-            reference_lon = navlon;
-            if (reference_lon < 180.0)
-              reference_lon += 360.0;
-            if (reference_lon >= 180.0)
-              reference_lon -= 360.0;
-            utm_zone = (int)(((reference_lon + 183.0) / 6.0) + 0.5);
-            reference_lat = navlat;
-            if (reference_lat >= 0.0)
-              snprintf(projection_id, sizeof(projection_id), "UTM%2.2dN", utm_zone);
-            else
-              snprintf(projection_id, sizeof(projection_id), "UTM%2.2dS", utm_zone);
-          }
-          else
-            strcpy(projection_id, projection_pars);
-
-          /* set projection flag */
-          proj_status = mb_proj_init(verbose, projection_id, &(pjptr), &error);
-
-          /* if projection not successfully initialized then quit */
-          if (proj_status != MB_SUCCESS) {
-            fprintf(stderr, "\nOutput projection %s not found in database\n", projection_id);
-            fprintf(stderr, "\nProgram <%s> Terminated\n", program_name);
-            error = MB_ERROR_BAD_PARAMETER;
-            mb_memory_clear(verbose, &error);
-            exit(MB_ERROR_BAD_PARAMETER);
-          }
-        }
-
-        /* get projected navigation */
-        mb_proj_forward(verbose, pjptr, navlon, navlat, &naveasting, &navnorthing, &error);
-      }
-
-      if (verbose >= 2) {
-        fprintf(stderr, "\ndbg2  Ping read in program <%s>\n", program_name);
-        fprintf(stderr, "dbg2       kind:           %d\n", kind);
-        fprintf(stderr, "dbg2       error:          %d\n", error);
-        fprintf(stderr, "dbg2       status:         %d\n", status);
-      }
-
-      if (verbose >= 1 && kind == MB_DATA_COMMENT) {
-        if (icomment == 0) {
-          fprintf(stderr, "\nComments:\n");
-          icomment++;
-        }
-        fprintf(stderr, "%s\n", comment);
-      }
-
-      /* get factors for lon lat calculations */
-      if (error == MB_ERROR_NO_ERROR) {
-        mb_coor_scale(verbose, navlat, &mtodeglon, &mtodeglat);
-        headingx = sin(DTR * heading);
-        headingy = cos(DTR * heading);
-      }
-
-      /* now loop over beams */
-      if (error == MB_ERROR_NO_ERROR)
-        for (int j = 0; j <= beams_bath; j++) {
-        }
+  /* otherwise export each swath file to its own LAS file using as many threads as requested */
+  else {
+    std::atomic<size_t> next_file(0);
+    std::thread exportThreads[MB_THREAD_MAX];
+    int thread_status[MB_THREAD_MAX];
+    int thread_error[MB_THREAD_MAX];
+    const unsigned int num_threads_use = MIN(num_threads, MAX(files.size(), 1));
+    for (unsigned int ithread = 0; ithread < num_threads_use; ithread++) {
+      thread_status[ithread] = MB_SUCCESS;
+      thread_error[ithread] = MB_ERROR_NO_ERROR;
+      exportThreads[ithread] = std::thread(export_files, verbose, &control, &files, &next_file, &projection,
+                                           &thread_status[ithread], &thread_error[ithread]);
     }
-
-    /* close the swath file */
-    status &= mb_close(verbose, &mbio_ptr, &error);
-
-    /* figure out whether and what to read next */
-    if (read_datalist) {
-      read_data = mb_datalist_read(verbose, datalist, file, dfile, &format, &file_weight, &error) == MB_SUCCESS;
-    } else {
-      read_data = false;
+    for (unsigned int ithread = 0; ithread < num_threads_use; ithread++) {
+      exportThreads[ithread].join();
     }
-
-    /* end loop over files in list */
   }
-  if (read_datalist)
-    mb_datalist_close(verbose, &datalist, &error);
+  error = MB_ERROR_NO_ERROR;
 
   if (verbose >= 4)
     status &= mb_memory_list(verbose, &error);
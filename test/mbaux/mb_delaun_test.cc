@@ -0,0 +1,249 @@
+// Copyright 2026 the MB-System Team.
+//
+// See README file for copying and redistribution conditions.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "mb_aux.h"
+#include "mb_define.h"
+#include "mb_status.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace {
+
+// Holds the points and the work arrays in the sizes used by mb_truecont.c.
+struct Triangulation {
+  explicit Triangulation(const std::vector<double> &x, const std::vector<double> &y)
+      : npts(static_cast<int>(x.size())), p1(x), p2(y), ed(npts + 3, 0),
+        iv1(3 * npts + 1), iv2(3 * npts + 1), iv3(3 * npts + 1),
+        ct1(3 * npts + 1), ct2(3 * npts + 1), ct3(3 * npts + 1),
+        cs1(3 * npts + 1), cs2(3 * npts + 1), cs3(3 * npts + 1),
+        istack(3 * npts + 1), kv1(9 * npts + 3), kv2(9 * npts + 3) {
+    p1.resize(npts + 3);
+    p2.resize(npts + 3);
+  }
+
+  int Run() {
+    int error = MB_ERROR_NO_ERROR;
+    const int status = mb_delaun(0, npts, p1.data(), p2.data(), ed.data(), &ntri,
+                                 iv1.data(), iv2.data(), iv3.data(),
+                                 ct1.data(), ct2.data(), ct3.data(),
+                                 cs1.data(), cs2.data(), cs3.data(),
+                                 nullptr, nullptr, nullptr, istack.data(),
+                                 kv1.data(), kv2.data(), &error);
+    EXPECT_EQ(MB_ERROR_NO_ERROR, error);
+    return status;
+  }
+
+  // Twice the signed area, positive for counterclockwise triangles.
+  double Area2(int i) const {
+    return (p1[iv2[i]] - p1[iv1[i]]) * (p2[iv3[i]] - p2[iv1[i]]) -
+           (p2[iv2[i]] - p2[iv1[i]]) * (p1[iv3[i]] - p1[iv1[i]]);
+  }
+
+  int npts;
+  int ntri = 0;
+  std::vector<double> p1, p2;
+  std::vector<int> ed;
+  std::vector<int> iv1, iv2, iv3, ct1, ct2, ct3, cs1, cs2, cs3;
+  std::vector<int> istack, kv1, kv2;
+};
+
+// Checks the orientation, vertex indices and the connection arrays.
+void CheckTopology(const Triangulation &t) {
+  const int *iv[3] = {t.iv1.data(), t.iv2.data(), t.iv3.data()};
+  const int *ct[3] = {t.ct1.data(), t.ct2.data(), t.ct3.data()};
+  const int *cs[3] = {t.cs1.data(), t.cs2.data(), t.cs3.data()};
+  for (int i = 0; i < t.ntri; i++) {
+    for (int k = 0; k < 3; k++) {
+      ASSERT_GE(iv[k][i], 0);
+      ASSERT_LT(iv[k][i], t.npts);
+    }
+    ASSERT_LT(t.Area2(i), 0.0) << "triangle " << i << " is not clockwise";
+    for (int s = 0; s < 3; s++) {
+      const int j = ct[s][i];
+      if (j < 0)
+        continue;
+      ASSERT_LT(j, t.ntri);
+      const int sj = cs[s][i];
+      ASSERT_GE(sj, 0);
+      ASSERT_LT(sj, 3);
+      ASSERT_EQ(i, ct[sj][j]);
+      ASSERT_EQ(s, cs[sj][j]);
+      // the shared side runs the opposite way in the neighbour
+      EXPECT_EQ(iv[s][i], iv[(sj + 1) % 3][j]);
+      EXPECT_EQ(iv[(s + 1) % 3][i], iv[sj][j]);
+    }
+  }
+}
+
+// Brute force check that no point lies strictly inside any circumcircle.
+int CountNonDelaunay(const Triangulation &t) {
+  int count = 0;
+  for (int i = 0; i < t.ntri; i++) {
+    const double ax = t.p1[t.iv1[i]], ay = t.p2[t.iv1[i]];
+    const double bx = t.p1[t.iv2[i]], by = t.p2[t.iv2[i]];
+    const double cx = t.p1[t.iv3[i]], cy = t.p2[t.iv3[i]];
+    const double d = 2.0 * (ax * (by - cy) + bx * (cy - ay) + cx * (ay - by));
+    const double ux = ((ax * ax + ay * ay) * (by - cy) + (bx * bx + by * by) * (cy - ay) +
+                       (cx * cx + cy * cy) * (ay - by)) / d;
+    const double uy = ((ax * ax + ay * ay) * (cx - bx) + (bx * bx + by * by) * (ax - cx) +
+                       (cx * cx + cy * cy) * (bx - ax)) / d;
+    const double r2 = (ax - ux) * (ax - ux) + (ay - uy) * (ay - uy);
+    for (int k = 0; k < t.npts; k++) {
+      const double dd = (t.p1[k] - ux) * (t.p1[k] - ux) + (t.p2[k] - uy) * (t.p2[k] - uy);
+      if (dd < r2 * (1.0 - 1.0e-9))
+        count++;
+    }
+  }
+  return count;
+}
+
+std::vector<std::pair<double, double>> RandomPoints(int n, unsigned seed) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  std::vector<std::pair<double, double>> points(n);
+  for (auto &p : points)
+    p = {uniform(gen), uniform(gen)};
+  return points;
+}
+
+Triangulation MakeTriangulation(const std::vector<std::pair<double, double>> &points) {
+  std::vector<double> x, y;
+  for (const auto &p : points) {
+    x.push_back(p.first);
+    y.push_back(p.second);
+  }
+  return Triangulation(x, y);
+}
+
+TEST(MbDelaunTest, TooFewPoints) {
+  Triangulation t({0.0, 1.0}, {0.0, 1.0});
+  EXPECT_EQ(MB_SUCCESS, t.Run());
+  EXPECT_EQ(0, t.ntri);
+}
+
+TEST(MbDelaunTest, Collinear) {
+  Triangulation t({0.0, 1.0, 2.0, 3.0}, {0.0, 1.0, 2.0, 3.0});
+  EXPECT_EQ(MB_SUCCESS, t.Run());
+  EXPECT_EQ(0, t.ntri);
+}
+
+TEST(MbDelaunTest, Square) {
+  Triangulation t({0.0, 1.0, 1.0, 0.0}, {0.0, 0.0, 1.0, 1.0});
+  EXPECT_EQ(MB_SUCCESS, t.Run());
+  ASSERT_EQ(2, t.ntri);
+  CheckTopology(t);
+}
+
+TEST(MbDelaunTest, RandomIsDelaunay) {
+  Triangulation t = MakeTriangulation(RandomPoints(2000, 42));
+  EXPECT_EQ(MB_SUCCESS, t.Run());
+  // points in general position give 2n - 2 - h triangles for h hull points
+  EXPECT_GT(t.ntri, 2 * t.npts - 2 - 100);
+  EXPECT_LE(t.ntri, 2 * t.npts - 5);
+  CheckTopology(t);
+  EXPECT_EQ(0, CountNonDelaunay(t));
+}
+
+TEST(MbDelaunTest, LatticeIsCocircular) {
+  // regularly spaced points are all cocircular in groups of four, which
+  // requires the exact predicates to triangulate consistently
+  const int n = 30;
+  std::vector<double> x, y;
+  for (int j = 0; j < n; j++) {
+    for (int i = 0; i < n; i++) {
+      x.push_back(0.1 * i);
+      y.push_back(0.1 * j);
+    }
+  }
+  Triangulation t(x, y);
+  EXPECT_EQ(MB_SUCCESS, t.Run());
+  EXPECT_EQ(2 * (n - 1) * (n - 1), t.ntri);
+  CheckTopology(t);
+  double area = 0.0;
+  for (int i = 0; i < t.ntri; i++)
+    area -= 0.5 * t.Area2(i);
+  EXPECT_NEAR(0.1 * (n - 1) * 0.1 * (n - 1), area, 1.0e-9);
+}
+
+TEST(MbDelaunTest, Duplicates) {
+  std::vector<std::pair<double, double>> points = RandomPoints(500, 7);
+  const std::vector<std::pair<double, double>> copy(points.begin(), points.begin() + 100);
+  points.insert(points.end(), copy.begin(), copy.end());
+  Triangulation t = MakeTriangulation(points);
+  Triangulation u = MakeTriangulation(RandomPoints(500, 7));
+  EXPECT_EQ(MB_SUCCESS, t.Run());
+  EXPECT_EQ(MB_SUCCESS, u.Run());
+  EXPECT_EQ(u.ntri, t.ntri);
+  CheckTopology(t);
+}
+
+TEST(MbDelaunTest, EdgeTrianglesRemoved) {
+  // a ring of flagged edge points around a single interior point
+  const int n = 12;
+  std::vector<double> x, y;
+  for (int i = 0; i < n; i++) {
+    x.push_back(cos(2.0 * M_PI * i / n));
+    y.push_back(sin(2.0 * M_PI * i / n));
+  }
+  x.push_back(0.05);
+  y.push_back(0.02);
+  Triangulation t(x, y);
+  for (int i = 0; i < n; i++)
+    t.ed[i] = 1;
+  EXPECT_EQ(MB_SUCCESS, t.Run());
+  EXPECT_EQ(n, t.ntri);
+  CheckTopology(t);
+  for (int i = 0; i < t.ntri; i++)
+    EXPECT_TRUE(t.iv1[i] == n || t.iv2[i] == n || t.iv3[i] == n);
+}
+
+TEST(MbDelaunTest, Swath) {
+  // a swath of soundings along a curving track, spaced more closely
+  // across track than along track, as mb_truecont.c sees them
+  const int npings = 200;
+  const int nbeams = 101;
+  std::vector<double> x, y;
+  for (int j = 0; j < npings; j++) {
+    const double heading = 0.002 * j;
+    for (int i = 0; i < nbeams; i++) {
+      const double across = 0.01 * (i - nbeams / 2);
+      x.push_back(0.05 * j * cos(heading) + across * sin(heading));
+      y.push_back(0.05 * j * sin(heading) - across * cos(heading));
+    }
+  }
+  Triangulation t(x, y);
+  EXPECT_EQ(MB_SUCCESS, t.Run());
+  EXPECT_GE(t.ntri, 2 * (npings - 1) * (nbeams - 1));
+  CheckTopology(t);
+}
+
+// Reports the triangulation time for random points from 1000 up to the
+// number given by the MB_DELAUN_BENCHMARK_MAX environment variable, which
+// defaults to 100000 and may be set as high as 10000000.
+TEST(MbDelaunTest, ScalingBenchmark) {
+  int nmax = 100000;
+  if (const char *env = getenv("MB_DELAUN_BENCHMARK_MAX"))
+    nmax = std::min(std::max(atoi(env), 1000), 10000000);
+  for (int n = 1000; n <= nmax; n *= 10) {
+    Triangulation t = MakeTriangulation(RandomPoints(n, 1));
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(MB_SUCCESS, t.Run());
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    fprintf(stderr, "mb_delaun: %8d points %8d triangles %8.3f seconds %6.3f microseconds/point\n",
+            n, t.ntri, elapsed.count(), 1.0e6 * elapsed.count() / n);
+    EXPECT_GT(t.ntri, 2 * n - 2 - static_cast<int>(20 * cbrt(n)));
+  }
+}
+
+}  // namespace
@@ -0,0 +1,117 @@
+// Copyright 2026 the MB-System Team.
+//
+// See README file for copying and redistribution conditions.
+
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "mb_aux.h"
+#include "mb_define.h"
+#include "mb_status.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace {
+
+constexpr int kColumns = 120;
+constexpr int kRows = 90;
+constexpr double kDx = 10.0;
+constexpr double kDy = 10.0;
+
+// mb_zgrid() leaves nodes it does not interpolate at or above this value.
+constexpr float kZgridUnset = 9.0e29f;
+
+// Soundings at grid node positions relative to the grid center, with
+// gaps, laid out as mbgrid passes them to the spline interpolation.
+std::vector<float> MakeData() {
+  std::mt19937 rng(41);
+  std::uniform_int_distribution<int> keep(0, 2);
+  const double origin_x = 0.5 * (kColumns - 1) * kDx;
+  const double origin_y = 0.5 * (kRows - 1) * kDy;
+  std::vector<float> xyz;
+  for (int i = 0; i < kColumns; i++) {
+    for (int j = 0; j < kRows; j++) {
+      if (keep(rng) != 0 || ((i / 15) + (j / 15)) % 3 == 0)
+        continue;
+      xyz.push_back(static_cast<float>(kDx * i - origin_x));
+      xyz.push_back(static_cast<float>(kDy * j - origin_y));
+      xyz.push_back(static_cast<float>(-1000.0 + 50.0 * std::sin(0.05 * i) + 30.0 * std::cos(0.07 * j)));
+    }
+  }
+  return xyz;
+}
+
+std::vector<float> RunMgsurface(const std::vector<float> &xyz, int nthreads, int clip, double tension) {
+  const float xmin = static_cast<float>(-0.5 * kDx - 0.5 * (kColumns - 1) * kDx);
+  const float ymin = static_cast<float>(-0.5 * kDy - 0.5 * (kRows - 1) * kDy);
+  struct mb_mgsurface_struct surface;
+  memset(&surface, 0, sizeof(struct mb_mgsurface_struct));
+  surface.nthreads = nthreads;
+  surface.tension = tension;
+  surface.clip = clip;
+  std::vector<float> z(kColumns * kRows, 0.0f);
+  int error = MB_ERROR_NO_ERROR;
+  const int status = mb_mgsurface(0, &surface, kColumns, kRows, xmin, ymin, kDx, kDy,
+                                  static_cast<int>(xyz.size() / 3), xyz.data(), z.data(), &error);
+  EXPECT_EQ(MB_SUCCESS, status);
+  EXPECT_EQ(MB_ERROR_NO_ERROR, error);
+  return z;
+}
+
+// mbgrid passes the grid origin offset by half a cell, as it did for
+// mb_zgrid(); the interpolated (unclipped) nodes must not change.
+TEST(MbMgsurfaceTest, ClipMaskMatchesZgrid) {
+  const std::vector<float> xyz = MakeData();
+  const int clip = 5;
+  const std::vector<float> z = RunMgsurface(xyz, 1, clip, 5.0);
+
+  int n_columns = kColumns;
+  int n_rows = kRows;
+  float xmin = static_cast<float>(-0.5 * kDx - 0.5 * (kColumns - 1) * kDx);
+  float ymin = static_cast<float>(-0.5 * kDy - 0.5 * (kRows - 1) * kDy);
+  float dx = kDx;
+  float dy = kDy;
+  float cay = 5.0f;
+  int nrng = clip;
+  int ndata = static_cast<int>(xyz.size() / 3);
+  std::vector<float> xyz_zgrid(xyz);
+  std::vector<float> zgrid(kColumns * kRows, 0.0f);
+  std::vector<float> work1(ndata);
+  std::vector<int> work2(ndata);
+  std::unique_ptr<bool[]> work3(new bool[kColumns + kRows]);
+  mb_zgrid(zgrid.data(), &n_columns, &n_rows, &xmin, &ymin, &dx, &dy, xyz_zgrid.data(), &ndata, work1.data(),
+           work2.data(), work3.get(), &cay, &nrng);
+
+  int n_interpolated = 0;
+  for (int k = 0; k < kColumns * kRows; k++) {
+    const bool defined = z[k] < MB_MGSURFACE_NODATA;
+    EXPECT_EQ(zgrid[k] < kZgridUnset, defined) << "node " << k;
+    if (defined)
+      n_interpolated++;
+  }
+  EXPECT_GT(n_interpolated, 0);
+  EXPECT_LT(n_interpolated, kColumns * kRows);
+}
+
+TEST(MbMgsurfaceTest, OutputDoesNotDependOnThreads) {
+  const std::vector<float> xyz = MakeData();
+  const std::vector<float> z1 = RunMgsurface(xyz, 1, kColumns, 5.0);
+  const std::vector<float> z3 = RunMgsurface(xyz, 3, kColumns, 5.0);
+  EXPECT_EQ(0, memcmp(z1.data(), z3.data(), z1.size() * sizeof(float)));
+}
+
+TEST(MbMgsurfaceTest, BadParameter) {
+  struct mb_mgsurface_struct surface;
+  memset(&surface, 0, sizeof(struct mb_mgsurface_struct));
+  std::vector<float> z(4, 0.0f);
+  const float xyz[3] = {0.0f, 0.0f, 1.0f};
+  int error = MB_ERROR_NO_ERROR;
+  EXPECT_EQ(MB_FAILURE, mb_mgsurface(0, &surface, 2, 2, 0.0, 0.0, 0.0, 1.0, 1, xyz, z.data(), &error));
+  EXPECT_EQ(MB_ERROR_BAD_PARAMETER, error);
+}
+
+}  // namespace
@@ -0,0 +1,244 @@
+// Copyright 2026 the MB-System Team.
+//
+// See README file for copying and redistribution conditions.
+//
+// GSF beam array kernels: every instruction set level must give the same
+// results as the portable code, plus a decode throughput benchmark.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "gsf/gsf.h"
+#include "gsf/gsf_array.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace {
+
+typedef void (*DecodeFn)(double *, const unsigned char *, int, double, double);
+typedef void (*EncodeFn)(unsigned char *, const double *, int, double, double);
+
+struct DecodeKernel {
+  const char *name;
+  DecodeFn fn;
+  int width;
+};
+
+struct EncodeKernel {
+  const char *name;
+  EncodeFn fn;
+  int width;
+  double lo;  // range of stored values that the field can hold
+  double hi;
+};
+
+const DecodeKernel kDecodeKernels[] = {
+    {"U8", gsfArrayDecodeU8, 1},   {"S8", gsfArrayDecodeS8, 1},   {"U16", gsfArrayDecodeU16, 2},
+    {"S16", gsfArrayDecodeS16, 2}, {"U32", gsfArrayDecodeU32, 4}, {"S32", gsfArrayDecodeS32, 4},
+};
+
+const EncodeKernel kEncodeKernels[] = {
+    {"U8", gsfArrayEncodeU8, 1, 0.0, 255.0},
+    {"U16", gsfArrayEncodeU16, 2, 0.0, 65535.0},
+    {"S16", gsfArrayEncodeS16, 2, -32768.0, 32767.0},
+    {"U32", gsfArrayEncodeU32, 4, 0.0, 4294967295.0},
+    {"S32", gsfArrayEncodeS32, 4, -2147483648.0, 2147483647.0},
+};
+
+const double kMultipliers[] = {1.0, 100.0, 3.7};
+const double kOffsets[] = {0.0, -12.5};
+
+// Lengths around the vector widths, so that every tail path runs.
+const int kLengths[] = {0, 1, 3, 4, 7, 8, 9, 15, 16, 17, 31, 33, 512};
+
+class GsfArrayTest : public ::testing::Test {
+ protected:
+  void SetUp() override { best_ = gsfArraySimdLevel(); }
+  void TearDown() override { gsfArraySetSimdLevel(best_); }
+
+  int best_ = GSF_ARRAY_SIMD_NONE;
+};
+
+TEST_F(GsfArrayTest, SetLevelIsLimitedToProcessor) {
+  EXPECT_EQ(GSF_ARRAY_SIMD_NONE, gsfArraySetSimdLevel(GSF_ARRAY_SIMD_NONE));
+  EXPECT_EQ(GSF_ARRAY_SIMD_NONE, gsfArraySimdLevel());
+  EXPECT_EQ(best_, gsfArraySetSimdLevel(GSF_ARRAY_SIMD_AVX2 + 1));
+}
+
+TEST_F(GsfArrayTest, DecodeMatchesPortable) {
+  std::mt19937 gen(33);
+  std::uniform_int_distribution<int> byte(0, 255);
+  std::vector<unsigned char> stream(4 * 512 + 1);
+  for (auto &c : stream)
+    c = byte(gen);
+
+  for (const auto &k : kDecodeKernels)
+    for (double multiplier : kMultipliers)
+      for (double offset : kOffsets)
+        for (int n : kLengths) {
+          // Start one byte in, the stream is not aligned in a record.
+          std::vector<double> expected(n + 1, -1.0);
+          gsfArraySetSimdLevel(GSF_ARRAY_SIMD_NONE);
+          k.fn(expected.data(), stream.data() + 1, n, multiplier, offset);
+          for (int level = GSF_ARRAY_SIMD_SSE2; level <= best_; level++) {
+            std::vector<double> got(n + 1, -1.0);
+            gsfArraySetSimdLevel(level);
+            k.fn(got.data(), stream.data() + 1, n, multiplier, offset);
+            EXPECT_EQ(0, memcmp(expected.data(), got.data(), (n + 1) * sizeof(double)))
+                << k.name << " level " << level << " beams " << n;
+          }
+        }
+}
+
+TEST_F(GsfArrayTest, DecodeValues) {
+  const unsigned char stream[] = {0x80, 0x00, 0x00, 0x01, 0xff, 0xff, 0xff, 0xfe};
+  double value[2];
+  for (int level = GSF_ARRAY_SIMD_NONE; level <= best_; level++) {
+    gsfArraySetSimdLevel(level);
+    gsfArrayDecodeS16(value, stream + 4, 2, 1.0, 0.0);
+    EXPECT_EQ(-1.0, value[0]);
+    EXPECT_EQ(-2.0, value[1]);
+    gsfArrayDecodeU16(value, stream + 4, 2, 1.0, 0.0);
+    EXPECT_EQ(65535.0, value[0]);
+    gsfArrayDecodeU32(value, stream, 2, 1.0, 0.0);
+    EXPECT_EQ(2147483649.0, value[0]);
+    EXPECT_EQ(4294967294.0, value[1]);
+    gsfArrayDecodeS32(value, stream, 2, 100.0, 1.0);
+    EXPECT_EQ(-2147483647.0 / 100.0 - 1.0, value[0]);
+    gsfArrayDecodeS8(value, stream, 1, 1.0, 0.0);
+    EXPECT_EQ(-128.0, value[0]);
+  }
+}
+
+TEST_F(GsfArrayTest, EncodeMatchesPortable) {
+  std::mt19937 gen(34);
+  for (const auto &k : kEncodeKernels)
+    for (double multiplier : kMultipliers)
+      for (double offset : kOffsets) {
+        // Values that scale into the range of the field, including the
+        // rounding boundaries and zero.
+        std::uniform_real_distribution<double> stored(k.lo + 1.0, k.hi - 1.0);
+        std::vector<double> values(512 + 1);
+        for (auto &v : values)
+          v = stored(gen) / multiplier - offset;
+        values[0] = -offset;
+        values[1] = 0.499 / multiplier - offset;
+        values[2] = -0.499 / multiplier - offset;
+        values[3] = k.lo / multiplier - offset;
+
+        for (int n : kLengths) {
+          std::vector<unsigned char> expected(k.width * n + 1, 0xa5);
+          gsfArraySetSimdLevel(GSF_ARRAY_SIMD_NONE);
+          k.fn(expected.data(), values.data() + 1, n, multiplier, offset);
+          for (int level = GSF_ARRAY_SIMD_SSE2; level <= best_; level++) {
+            std::vector<unsigned char> got(k.width * n + 1, 0xa5);
+            gsfArraySetSimdLevel(level);
+            k.fn(got.data(), values.data() + 1, n, multiplier, offset);
+            EXPECT_EQ(expected, got) << k.name << " level " << level << " beams " << n;
+          }
+        }
+      }
+}
+
+TEST_F(GsfArrayTest, EncodeDecodeRoundTrip) {
+  const double depth[] = {0.0, 12.34, 1234.56, 655.35, 0.005, 0.004};
+  unsigned char stream[sizeof(depth) / sizeof(depth[0]) * 2];
+  double decoded[sizeof(depth) / sizeof(depth[0])];
+  const int n = sizeof(depth) / sizeof(depth[0]);
+  for (int level = GSF_ARRAY_SIMD_NONE; level <= best_; level++) {
+    gsfArraySetSimdLevel(level);
+    gsfArrayEncodeU16(stream, depth, n, 50.0, 0.0);
+    gsfArrayDecodeU16(decoded, stream, n, 50.0, 0.0);
+    for (int i = 0; i < n; i++)
+      EXPECT_NEAR(depth[i], decoded[i], 0.5 / 50.0 + 1e-9) << "level " << level;
+  }
+}
+
+// Write a synthetic stream of 512 beam pings and time reading it back at
+// each instruction set level.
+TEST_F(GsfArrayTest, DecodeThroughput) {
+  constexpr int kNumPings = 2000;
+  constexpr int kNumBeams = 512;
+
+  char name[] = "/tmp/gsf_array_test_XXXXXX";
+  const int fd = mkstemp(name);
+  ASSERT_NE(-1, fd);
+  close(fd);
+
+  int handle = 0;
+  ASSERT_EQ(0, gsfOpen(name, GSF_CREATE, &handle));
+  gsfRecords rec;
+  memset(&rec, 0, sizeof(rec));
+  gsfDataID id;
+  memset(&id, 0, sizeof(id));
+  id.recordID = GSF_RECORD_SWATH_BATHYMETRY_PING;
+
+  std::vector<double> depth(kNumBeams), across(kNumBeams), along(kNumBeams);
+  std::vector<double> travel(kNumBeams), angle(kNumBeams), amplitude(kNumBeams);
+  gsfSwathBathyPing *ping = &rec.mb_ping;
+  ping->number_beams = kNumBeams;
+  ping->center_beam = kNumBeams / 2;
+  ping->depth = depth.data();
+  ping->across_track = across.data();
+  ping->along_track = along.data();
+  ping->travel_time = travel.data();
+  ping->beam_angle = angle.data();
+  ping->mr_amplitude = amplitude.data();
+  gsfLoadScaleFactor(&ping->scaleFactors, GSF_SWATH_BATHY_SUBRECORD_DEPTH_ARRAY, GSF_FIELD_SIZE_DEFAULT, 0.01, 0);
+  gsfLoadScaleFactor(&ping->scaleFactors, GSF_SWATH_BATHY_SUBRECORD_ACROSS_TRACK_ARRAY, GSF_FIELD_SIZE_DEFAULT, 0.01, 0);
+  gsfLoadScaleFactor(&ping->scaleFactors, GSF_SWATH_BATHY_SUBRECORD_ALONG_TRACK_ARRAY, GSF_FIELD_SIZE_DEFAULT, 0.01, 0);
+  gsfLoadScaleFactor(&ping->scaleFactors, GSF_SWATH_BATHY_SUBRECORD_TRAVEL_TIME_ARRAY, GSF_FIELD_SIZE_DEFAULT, 1.0e-7, 0);
+  gsfLoadScaleFactor(&ping->scaleFactors, GSF_SWATH_BATHY_SUBRECORD_BEAM_ANGLE_ARRAY, GSF_FIELD_SIZE_DEFAULT, 0.01, 0);
+  gsfLoadScaleFactor(&ping->scaleFactors, GSF_SWATH_BATHY_SUBRECORD_MEAN_REL_AMPLITUDE_ARRAY, GSF_FIELD_SIZE_DEFAULT, 0.5, 0);
+  for (int i = 0; i < kNumPings; i++) {
+    ping->ping_time.tv_sec = 1000000 + i;
+    for (int j = 0; j < kNumBeams; j++) {
+      const double a = (j - kNumBeams / 2) * 0.25;
+      depth[j] = 100.0 + 0.01 * i + 0.5 * std::cos(a);
+      across[j] = depth[j] * std::tan(a * M_PI / 180.0);
+      along[j] = 0.01 * (j % 7) - 0.03;
+      travel[j] = 2.0 * depth[j] / 1500.0;
+      angle[j] = a;
+      amplitude[j] = 40.0 + (j % 50) * 0.5;
+    }
+    ASSERT_GT(gsfWrite(handle, &id, &rec), 0);
+  }
+  gsfClose(handle);
+
+  std::vector<double> checksum;
+  for (int level = GSF_ARRAY_SIMD_NONE; level <= best_; level++) {
+    gsfArraySetSimdLevel(level);
+    ASSERT_EQ(0, gsfOpen(name, GSF_READONLY, &handle));
+    memset(&rec, 0, sizeof(rec));
+    int npings = 0;
+    double sum = 0.0;
+    const auto start = std::chrono::steady_clock::now();
+    while (gsfRead(handle, GSF_NEXT_RECORD, &id, &rec, nullptr, 0) >= 0) {
+      if (id.recordID == GSF_RECORD_SWATH_BATHYMETRY_PING) {
+        sum += rec.mb_ping.depth[npings % kNumBeams] + rec.mb_ping.across_track[kNumBeams - 1];
+        npings++;
+      }
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    gsfClose(handle);
+
+    EXPECT_EQ(kNumPings, npings);
+    checksum.push_back(sum);
+    printf("gsf_array_test: level %d decoded %d pings of %d beams at %.0f pings/s\n", level, npings,
+           kNumBeams, npings / elapsed.count());
+  }
+  for (size_t k = 1; k < checksum.size(); k++)
+    EXPECT_EQ(checksum[0], checksum[k]);
+
+  remove(name);
+}
+
+}  // namespace
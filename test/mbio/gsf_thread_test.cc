@@ -0,0 +1,172 @@
+// Copyright 2026 the MB-System Team.
+//
+// See README file for copying and redistribution conditions.
+//
+// Concurrent reads of separate GSF files, each thread with its own handles.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "gsf/gsf.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace {
+
+constexpr int kNumFiles = 24;
+constexpr int kNumPings = 40;
+constexpr int kNumBeams = 101;
+constexpr int kNumThreads = 8;
+constexpr int kPasses = 3;
+
+std::string FileName(const std::string &dir, int file) {
+  return dir + "/gsf_thread_test_" + std::to_string(file) + ".gsf";
+}
+
+// Depth of a beam, unique for each file so that mixed up buffers show.
+double Depth(int file, int ping, int beam) {
+  return 100.0 + file * 10.0 + ping * 0.1 + beam * 0.01;
+}
+
+bool WriteFile(const std::string &name, int file) {
+  int handle = 0;
+  if (gsfOpen(name.c_str(), GSF_CREATE, &handle) != 0)
+    return false;
+
+  gsfRecords rec;
+  memset(&rec, 0, sizeof(rec));
+  gsfDataID id;
+  memset(&id, 0, sizeof(id));
+
+  std::string comment = "file " + std::to_string(file);
+  rec.comment.comment_time.tv_sec = 1000000 + file;
+  rec.comment.comment_length = comment.size();
+  rec.comment.comment = const_cast<char *>(comment.c_str());
+  id.recordID = GSF_RECORD_COMMENT;
+  bool ok = gsfWrite(handle, &id, &rec) > 0;
+
+  std::vector<double> depth(kNumBeams);
+  std::vector<double> across(kNumBeams);
+  memset(&rec, 0, sizeof(rec));
+  gsfSwathBathyPing *ping = &rec.mb_ping;
+  ping->number_beams = kNumBeams;
+  ping->center_beam = kNumBeams / 2;
+  ping->depth = depth.data();
+  ping->across_track = across.data();
+  gsfLoadScaleFactor(&ping->scaleFactors, GSF_SWATH_BATHY_SUBRECORD_DEPTH_ARRAY, GSF_FIELD_SIZE_DEFAULT, 0.01, 0);
+  gsfLoadScaleFactor(&ping->scaleFactors, GSF_SWATH_BATHY_SUBRECORD_ACROSS_TRACK_ARRAY, GSF_FIELD_SIZE_DEFAULT, 0.01, 0);
+  id.recordID = GSF_RECORD_SWATH_BATHYMETRY_PING;
+  for (int i = 0; i < kNumPings && ok; i++) {
+    ping->ping_time.tv_sec = 1000000 + file * 1000 + i;
+    for (int j = 0; j < kNumBeams; j++) {
+      depth[j] = Depth(file, i, j);
+      across[j] = (j - kNumBeams / 2) * 2.0;
+    }
+    ok = gsfWrite(handle, &id, &rec) > 0;
+  }
+
+  gsfClose(handle);
+  return ok;
+}
+
+// Read a file to the end, returning the number of pings that decoded to
+// the values written, or -1 on any error other than end of file.
+int ReadFile(const std::string &name, int file) {
+  int handle = 0;
+  if (gsfOpen(name.c_str(), GSF_READONLY, &handle) != 0)
+    return -1;
+
+  gsfRecords rec;
+  memset(&rec, 0, sizeof(rec));
+  gsfDataID id;
+  int npings = 0;
+  int ncomments = 0;
+  bool ok = true;
+  while (gsfRead(handle, GSF_NEXT_RECORD, &id, &rec, nullptr, 0) >= 0) {
+    if (id.recordID == GSF_RECORD_COMMENT) {
+      const std::string comment = "file " + std::to_string(file);
+      ok = ok && rec.comment.comment != nullptr &&
+           comment == std::string(rec.comment.comment, rec.comment.comment_length);
+      ncomments++;
+    } else if (id.recordID == GSF_RECORD_SWATH_BATHYMETRY_PING) {
+      const int i = rec.mb_ping.ping_time.tv_sec - 1000000 - file * 1000;
+      ok = ok && i == npings && rec.mb_ping.number_beams == kNumBeams;
+      for (int j = 0; ok && j < kNumBeams; j++)
+        ok = std::abs(rec.mb_ping.depth[j] - Depth(file, i, j)) < 0.006;
+      npings++;
+    }
+  }
+
+  // gsfError belongs to this thread, whatever the others are doing.
+  const int error = gsfError;
+  if (error != GSF_READ_TO_END_OF_FILE && error != GSF_PARTIAL_RECORD_AT_END_OF_FILE)
+    ok = false;
+
+  gsfClose(handle);
+  return ok && ncomments == 1 ? npings : -1;
+}
+
+class GsfThreadTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    char dir[] = "/tmp/gsf_thread_test_XXXXXX";
+    ASSERT_NE(nullptr, mkdtemp(dir));
+    dir_ = dir;
+    for (int file = 0; file < kNumFiles; file++)
+      ASSERT_TRUE(WriteFile(FileName(dir_, file), file));
+  }
+
+  void TearDown() override {
+    for (int file = 0; file < kNumFiles; file++)
+      remove(FileName(dir_, file).c_str());
+    rmdir(dir_.c_str());
+  }
+
+  std::string dir_;
+};
+
+TEST_F(GsfThreadTest, SequentialRead) {
+  for (int file = 0; file < kNumFiles; file++)
+    EXPECT_EQ(kNumPings, ReadFile(FileName(dir_, file), file));
+}
+
+TEST_F(GsfThreadTest, ConcurrentRead) {
+  std::vector<int> npings(kNumThreads * kPasses * kNumFiles, 0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([this, t, &npings]() {
+      for (int pass = 0; pass < kPasses; pass++)
+        for (int n = 0; n < kNumFiles; n++) {
+          // Start each thread at a different file.
+          const int file = (n + t * 3) % kNumFiles;
+          npings[(t * kPasses + pass) * kNumFiles + file] = ReadFile(FileName(dir_, file), file);
+        }
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  for (int k = 0; k < kNumThreads * kPasses * kNumFiles; k++)
+    EXPECT_EQ(kNumPings, npings[k]) << "thread " << k / (kPasses * kNumFiles) << " file " << k % kNumFiles;
+}
+
+TEST_F(GsfThreadTest, ErrorIsPerThread) {
+  int handle = 0;
+  EXPECT_EQ(-1, gsfOpen((dir_ + "/missing.gsf").c_str(), GSF_READONLY, &handle));
+  EXPECT_EQ(GSF_FOPEN_ERROR, gsfError);
+
+  int other_error = -1;
+  std::thread other([&other_error]() { other_error = gsfError; });
+  other.join();
+  EXPECT_EQ(0, other_error);
+  EXPECT_EQ(GSF_FOPEN_ERROR, gsfError);
+}
+
+}  // namespace
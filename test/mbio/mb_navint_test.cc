@@ -0,0 +1,229 @@
+// Copyright 2026 the MB-System Team.
+//
+// See README file for copying and redistribution conditions.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "mb_define.h"
+#include "mb_process.h"
+#include "mb_status.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace {
+
+std::string TempFile(const char *name) {
+  const char *tmpdir = getenv("TMPDIR");
+  return std::string(tmpdir != nullptr ? tmpdir : "/tmp") + "/" + name;
+}
+
+// Direct summation of the Gaussian weights within four filter lengths.
+std::vector<double> DirectFilter(const std::vector<double> &time_d, const std::vector<double> &value,
+                                 double filter_length) {
+  std::vector<double> filtered(value.size());
+  for (size_t i = 0; i < value.size(); i++) {
+    double sum = 0.0;
+    double weight_sum = 0.0;
+    for (size_t j = 0; j < value.size(); j++) {
+      const double dtol = (time_d[j] - time_d[i]) / filter_length;
+      if (std::fabs(dtol) <= 4.0) {
+        const double weight = std::exp(-dtol * dtol);
+        sum += weight * value[j];
+        weight_sum += weight;
+      }
+    }
+    filtered[i] = sum / weight_sum;
+  }
+  return filtered;
+}
+
+double Signal(double t) {
+  return 10.0 * std::sin(2.0 * M_PI * t / 30.0) + std::sin(2.0 * M_PI * t / 0.7) + 1500.0;
+}
+
+TEST(MbNavintTest, TimeFilterUniform) {
+  // 200 Hz for 60 s with a 1 s filter uses the box filter cascade.
+  const int n = 12000;
+  std::vector<double> time_d(n);
+  std::vector<double> value(n);
+  for (int i = 0; i < n; i++) {
+    time_d[i] = 1.6e9 + 0.005 * i;
+    value[i] = Signal(0.005 * i);
+  }
+  const std::vector<double> expected = DirectFilter(time_d, value, 1.0);
+
+  int error = MB_ERROR_NO_ERROR;
+  ASSERT_EQ(MB_SUCCESS, mb_apply_time_filter(0, n, time_d.data(), value.data(), 1.0, &error));
+  EXPECT_EQ(MB_ERROR_NO_ERROR, error);
+  for (int i = 0; i < n; i++)
+    ASSERT_NEAR(expected[i], value[i], 0.01) << "sample " << i;
+}
+
+TEST(MbNavintTest, TimeFilterIrregular) {
+  // Irregular sampling with a gap uses direct summation.
+  std::vector<double> time_d;
+  std::vector<double> value;
+  double t = 0.0;
+  for (int i = 0; i < 500; i++) {
+    t += (i % 3 == 0) ? 0.9 : 0.2;
+    if (i == 250)
+      t += 100.0;
+    time_d.push_back(t);
+    value.push_back(Signal(t));
+  }
+  const std::vector<double> expected = DirectFilter(time_d, value, 2.0);
+
+  int error = MB_ERROR_NO_ERROR;
+  ASSERT_EQ(MB_SUCCESS, mb_apply_time_filter(0, value.size(), time_d.data(), value.data(), 2.0, &error));
+  for (size_t i = 0; i < value.size(); i++)
+    ASSERT_NEAR(expected[i], value[i], 1e-9) << "sample " << i;
+}
+
+TEST(MbNavintTest, TimeFilterConstant) {
+  const int n = 5000;
+  std::vector<double> time_d(n);
+  std::vector<double> value(n, -122.5);
+  for (int i = 0; i < n; i++)
+    time_d[i] = 0.01 * i;
+
+  int error = MB_ERROR_NO_ERROR;
+  ASSERT_EQ(MB_SUCCESS, mb_apply_time_filter(0, n, time_d.data(), value.data(), 3.0, &error));
+  for (int i = 0; i < n; i++)
+    ASSERT_NEAR(-122.5, value[i], 1e-9);
+}
+
+void WriteSensorDepth(const std::string &path, int n, double offset) {
+  FILE *fp = fopen(path.c_str(), "w");
+  ASSERT_NE(nullptr, fp);
+  fprintf(fp, "# time_d sensordepth\n");
+  for (int i = 0; i < n; i++) {
+    fprintf(fp, "%.3f %.3f\n", 1000.0 + i, offset + 0.5 * i);
+    if (i == 10)
+      fprintf(fp, "%.3f %.3f\n", 1000.0 + i, -1.0);  // repeated time
+  }
+  fclose(fp);
+}
+
+bool FileExists(const std::string &path) {
+  FILE *fp = fopen(path.c_str(), "rb");
+  if (fp == nullptr)
+    return false;
+  fclose(fp);
+  return true;
+}
+
+void LoadSensorDepth(const std::string &path, int *num, int *alloc, double **time_d, double **depth) {
+  int error = MB_ERROR_NO_ERROR;
+  ASSERT_EQ(MB_SUCCESS, mb_loadsensordepthdata(0, const_cast<char *>(path.c_str()), MB_PR_SENSORDEPTH_FORMAT_TD, num,
+                                               alloc, time_d, depth, &error));
+}
+
+TEST(MbNavintTest, LoadSensorDepthCached) {
+  const std::string path = TempFile("mb_navint_test_depth.txt");
+  const std::string cache = path + ".mbcache";
+  remove(cache.c_str());
+  const int n = 20000;
+  WriteSensorDepth(path, n, 100.0);
+
+  // The cache is only used when enabled in ~/.mbio_defaults.
+  const char *home = getenv("HOME");
+  const std::string home_saved = home != nullptr ? home : "";
+  std::string home_tmp = TempFile("mb_navint_test_XXXXXX");
+  ASSERT_NE(nullptr, mkdtemp(&home_tmp[0]));
+  setenv("HOME", home_tmp.c_str(), 1);
+  const std::string defaults = home_tmp + "/.mbio_defaults";
+
+  int num = 0;
+  int alloc = 0;
+  double *time_d = nullptr;
+  double *depth = nullptr;
+  LoadSensorDepth(path, &num, &alloc, &time_d, &depth);
+  ASSERT_EQ(n, num);
+  EXPECT_FALSE(FileExists(cache));
+
+  FILE *fp = fopen(defaults.c_str(), "w");
+  ASSERT_NE(nullptr, fp);
+  fprintf(fp, "navintcache:1\n");
+  fclose(fp);
+  for (int pass = 0; pass < 2; pass++) {
+    LoadSensorDepth(path, &num, &alloc, &time_d, &depth);
+    ASSERT_EQ(n, num);
+    for (int i = 0; i < n; i++) {
+      ASSERT_DOUBLE_EQ(1000.0 + i, time_d[i]);
+      ASSERT_DOUBLE_EQ(100.0 + 0.5 * i, depth[i]);
+    }
+    EXPECT_TRUE(FileExists(cache));
+  }
+
+  // A source file replaced by one of the same size is parsed again.
+  const std::string replacement = path + ".new";
+  WriteSensorDepth(replacement, n, 300.0);
+  ASSERT_EQ(0, rename(replacement.c_str(), path.c_str()));
+  LoadSensorDepth(path, &num, &alloc, &time_d, &depth);
+  ASSERT_EQ(n, num);
+  EXPECT_DOUBLE_EQ(300.0, depth[0]);
+
+  // So is a changed source file.
+  WriteSensorDepth(path, n + 1, 200.0);
+  LoadSensorDepth(path, &num, &alloc, &time_d, &depth);
+  ASSERT_EQ(n + 1, num);
+  EXPECT_DOUBLE_EQ(200.0, depth[0]);
+
+  int error = MB_ERROR_NO_ERROR;
+  mb_freed(0, __FILE__, __LINE__, (void **)&time_d, &error);
+  mb_freed(0, __FILE__, __LINE__, (void **)&depth, &error);
+  if (home != nullptr)
+    setenv("HOME", home_saved.c_str(), 1);
+  else
+    unsetenv("HOME");
+  remove(defaults.c_str());
+  rmdir(home_tmp.c_str());
+  remove(cache.c_str());
+  remove(path.c_str());
+}
+
+TEST(MbNavintTest, LoadNavLonflip) {
+  const std::string path = TempFile("mb_navint_test_nav.txt");
+  FILE *fp = fopen(path.c_str(), "w");
+  ASSERT_NE(nullptr, fp);
+  fprintf(fp, "10.0 -122.5 36.5 2.5\n");
+  fprintf(fp, "bad line\n");
+  fprintf(fp, "11.0 237.0 36.6\n");
+  fprintf(fp, "9.0 -122.4 36.7 1.0\n");
+  fprintf(fp, "12.0\t-122.3\t36.8\t3.0");
+  fclose(fp);
+
+  int verbose = 0;
+  int error = MB_ERROR_NO_ERROR;
+  int num = 0;
+  int alloc = 0;
+  double *time_d = nullptr;
+  double *lon = nullptr;
+  double *lat = nullptr;
+  double *speed = nullptr;
+  ASSERT_EQ(MB_SUCCESS, mb_loadnavdata(verbose, const_cast<char *>(path.c_str()), MB_PR_NAV_FORMAT_TLLS, 1, &num, &alloc,
+                                       &time_d, &lon, &lat, &speed, &error));
+  ASSERT_EQ(3, num);
+  EXPECT_DOUBLE_EQ(10.0, time_d[0]);
+  EXPECT_DOUBLE_EQ(237.5, lon[0]);
+  EXPECT_DOUBLE_EQ(2.5, speed[0]);
+  EXPECT_DOUBLE_EQ(11.0, time_d[1]);
+  EXPECT_DOUBLE_EQ(237.0, lon[1]);
+  EXPECT_DOUBLE_EQ(0.0, speed[1]);
+  EXPECT_DOUBLE_EQ(12.0, time_d[2]);
+  EXPECT_DOUBLE_EQ(36.8, lat[2]);
+
+  mb_freed(verbose, __FILE__, __LINE__, (void **)&time_d, &error);
+  mb_freed(verbose, __FILE__, __LINE__, (void **)&lon, &error);
+  mb_freed(verbose, __FILE__, __LINE__, (void **)&lat, &error);
+  mb_freed(verbose, __FILE__, __LINE__, (void **)&speed, &error);
+  remove(path.c_str());
+}
+
+}  // namespace
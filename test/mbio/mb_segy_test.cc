@@ -0,0 +1,214 @@
+// Copyright 2026 the MB-System Team.
+//
+// See README file for copying and redistribution conditions.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "mb_define.h"
+#include "mb_segy.h"
+#include "mb_status.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace {
+
+std::string TempFile(const char *name) {
+  const char *tmpdir = getenv("TMPDIR");
+  return std::string(tmpdir != nullptr ? tmpdir : "/tmp") + "/" + name;
+}
+
+// Writes ntraces traces of format 5 samples with shot numbers i / 4
+// and cdp numbers i, and nsamps growing with the trace number.
+void WriteSegy(const std::string &path, int ntraces) {
+  int verbose = 0;
+  int error = MB_ERROR_NO_ERROR;
+  struct mb_segyasciiheader_struct asciiheader;
+  struct mb_segyfileheader_struct fileheader;
+  memset(&asciiheader, 0, sizeof(asciiheader));
+  memset(&fileheader, 0, sizeof(fileheader));
+  fileheader.format = 5;
+  fileheader.sample_interval = 100;
+
+  void *mbsegyioptr = nullptr;
+  ASSERT_EQ(MB_SUCCESS, mb_segy_write_init(verbose, const_cast<char *>(path.c_str()), &asciiheader, &fileheader,
+                                           &mbsegyioptr, &error));
+  float trace[200];
+  for (int i = 0; i < ntraces; i++) {
+    struct mb_segytraceheader_struct traceheader;
+    memset(&traceheader, 0, sizeof(traceheader));
+    traceheader.seq_num = i + 1;
+    traceheader.shot_num = i / 4;
+    traceheader.shot_tr = i % 4;
+    traceheader.rp_num = i;
+    traceheader.rp_tr = 1;
+    traceheader.nsamps = 100 + i % 100;
+    traceheader.si_micros = 100;
+    traceheader.delay_mils = -7;
+    traceheader.heading = 123.5;
+    for (int j = 0; j < traceheader.nsamps; j++)
+      trace[j] = i + 0.25f * j;
+    ASSERT_EQ(MB_SUCCESS, mb_segy_write_trace(verbose, mbsegyioptr, &traceheader, trace, &error));
+  }
+  ASSERT_EQ(MB_SUCCESS, mb_segy_close(verbose, &mbsegyioptr, &error));
+}
+
+TEST(MbSegy, ReadTraces) {
+  const std::string path = TempFile("mb_segy_test_read.segy");
+  const int ntraces = 5000;
+  WriteSegy(path, ntraces);
+
+  int verbose = 0;
+  int error = MB_ERROR_NO_ERROR;
+  struct mb_segyasciiheader_struct asciiheader;
+  struct mb_segyfileheader_struct fileheader;
+  void *mbsegyioptr = nullptr;
+  ASSERT_EQ(MB_SUCCESS, mb_segy_read_init(verbose, const_cast<char *>(path.c_str()), &mbsegyioptr, &asciiheader,
+                                          &fileheader, &error));
+  EXPECT_EQ(5, fileheader.format);
+
+  // Reads span many blocks, so traces straddle block boundaries.
+  int nread = 0;
+  struct mb_segytraceheader_struct traceheader;
+  float *trace = nullptr;
+  while (mb_segy_read_trace(verbose, mbsegyioptr, &traceheader, &trace, &error) == MB_SUCCESS) {
+    ASSERT_EQ(nread + 1, traceheader.seq_num);
+    ASSERT_EQ(nread, traceheader.rp_num);
+    ASSERT_EQ(100 + nread % 100, traceheader.nsamps);
+    ASSERT_EQ(-7, traceheader.delay_mils);
+    ASSERT_FLOAT_EQ(123.5, traceheader.heading);
+    for (int j = 0; j < traceheader.nsamps; j++)
+      ASSERT_FLOAT_EQ(nread + 0.25f * j, trace[j]);
+    nread++;
+  }
+  EXPECT_EQ(MB_ERROR_EOF, error);
+  EXPECT_EQ(ntraces, nread);
+
+  EXPECT_EQ(MB_SUCCESS, mb_segy_close(verbose, &mbsegyioptr, &error));
+  remove(path.c_str());
+}
+
+TEST(MbSegy, IndexAndSeek) {
+  const std::string path = TempFile("mb_segy_test_index.segy");
+  const int ntraces = 1000;
+  WriteSegy(path, ntraces);
+
+  int verbose = 0;
+  int error = MB_ERROR_NO_ERROR;
+  struct mb_segyasciiheader_struct asciiheader;
+  struct mb_segyfileheader_struct fileheader;
+  void *mbsegyioptr = nullptr;
+  ASSERT_EQ(MB_SUCCESS, mb_segy_read_init(verbose, const_cast<char *>(path.c_str()), &mbsegyioptr, &asciiheader,
+                                          &fileheader, &error));
+
+  // Building the index leaves the read position alone.
+  struct mb_segytraceheader_struct traceheader;
+  float *trace = nullptr;
+  ASSERT_EQ(MB_SUCCESS, mb_segy_read_trace(verbose, mbsegyioptr, &traceheader, &trace, &error));
+  int nindex = 0;
+  struct mb_segyindex_struct *index = nullptr;
+  ASSERT_EQ(MB_SUCCESS, mb_segy_read_index(verbose, mbsegyioptr, &nindex, &index, &error));
+  ASSERT_EQ(ntraces, nindex);
+  ASSERT_EQ(MB_SUCCESS, mb_segy_read_trace(verbose, mbsegyioptr, &traceheader, &trace, &error));
+  EXPECT_EQ(1, traceheader.rp_num);
+
+  EXPECT_EQ(MB_SEGY_ASCIIHEADER_LENGTH + MB_SEGY_FILEHEADER_LENGTH, index[0].offset);
+  for (int i = 0; i < nindex; i++) {
+    EXPECT_EQ(i / 4, index[i].shot_num);
+    EXPECT_EQ(i % 4, index[i].shot_tr);
+    EXPECT_EQ(i, index[i].rp_num);
+    EXPECT_EQ(100 + i % 100, index[i].nsamps);
+  }
+
+  for (const int itrace : {777, 3, 999, 0}) {
+    ASSERT_EQ(MB_SUCCESS, mb_segy_seek_trace(verbose, mbsegyioptr, itrace, &error));
+    ASSERT_EQ(MB_SUCCESS, mb_segy_read_trace(verbose, mbsegyioptr, &traceheader, &trace, &error));
+    EXPECT_EQ(itrace, traceheader.rp_num);
+    EXPECT_FLOAT_EQ(itrace + 0.25f, trace[1]);
+  }
+
+  EXPECT_EQ(MB_FAILURE, mb_segy_seek_trace(verbose, mbsegyioptr, ntraces, &error));
+  EXPECT_EQ(MB_ERROR_EOF, error);
+
+  EXPECT_EQ(MB_SUCCESS, mb_segy_close(verbose, &mbsegyioptr, &error));
+  remove(path.c_str());
+}
+
+TEST(MbSegy, IndexNoTraces) {
+  const std::string path = TempFile("mb_segy_test_empty.segy");
+  WriteSegy(path, 0);
+
+  int verbose = 0;
+  int error = MB_ERROR_NO_ERROR;
+  struct mb_segyasciiheader_struct asciiheader;
+  struct mb_segyfileheader_struct fileheader;
+  void *mbsegyioptr = nullptr;
+  ASSERT_EQ(MB_SUCCESS, mb_segy_read_init(verbose, const_cast<char *>(path.c_str()), &mbsegyioptr, &asciiheader,
+                                          &fileheader, &error));
+  int nindex = -1;
+  struct mb_segyindex_struct *index = nullptr;
+  ASSERT_EQ(MB_SUCCESS, mb_segy_read_index(verbose, mbsegyioptr, &nindex, &index, &error));
+  EXPECT_EQ(0, nindex);
+
+  // An empty index is kept rather than rebuilt: a trace appended to the
+  // file afterwards does not show up.
+  FILE *fp = fopen(path.c_str(), "a");
+  ASSERT_NE(nullptr, fp);
+  const char trace[MB_SEGY_TRACEHEADER_LENGTH] = {0};
+  fwrite(trace, 1, sizeof(trace), fp);
+  fclose(fp);
+  ASSERT_EQ(MB_SUCCESS, mb_segy_read_index(verbose, mbsegyioptr, &nindex, &index, &error));
+  EXPECT_EQ(0, nindex);
+  EXPECT_EQ(MB_FAILURE, mb_segy_seek_trace(verbose, mbsegyioptr, 0, &error));
+
+  EXPECT_EQ(MB_SUCCESS, mb_segy_close(verbose, &mbsegyioptr, &error));
+  remove(path.c_str());
+}
+
+TEST(MbSegy, IbmFloatSamples) {
+  const std::string path = TempFile("mb_segy_test_ibm.segy");
+
+  // Hand build a file with one trace of IBM floating point samples.
+  unsigned char header[MB_SEGY_ASCIIHEADER_LENGTH + MB_SEGY_FILEHEADER_LENGTH + MB_SEGY_TRACEHEADER_LENGTH];
+  memset(header, 0, sizeof(header));
+  header[MB_SEGY_ASCIIHEADER_LENGTH + 25] = 1;  // format
+  const int nsamps = 4;
+  header[MB_SEGY_ASCIIHEADER_LENGTH + MB_SEGY_FILEHEADER_LENGTH + 115] = nsamps;
+  const unsigned char samples[] = {
+      0x42, 0x64, 0x00, 0x00,  // 100.0
+      0xc2, 0x76, 0xa0, 0x00,  // -118.625
+      0x3f, 0x80, 0x00, 0x00,  // 0.03125
+      0x00, 0x00, 0x00, 0x00,  // 0.0
+  };
+  FILE *fp = fopen(path.c_str(), "w");
+  ASSERT_NE(nullptr, fp);
+  fwrite(header, 1, sizeof(header), fp);
+  fwrite(samples, 1, sizeof(samples), fp);
+  fclose(fp);
+
+  int verbose = 0;
+  int error = MB_ERROR_NO_ERROR;
+  struct mb_segyasciiheader_struct asciiheader;
+  struct mb_segyfileheader_struct fileheader;
+  void *mbsegyioptr = nullptr;
+  ASSERT_EQ(MB_SUCCESS, mb_segy_read_init(verbose, const_cast<char *>(path.c_str()), &mbsegyioptr, &asciiheader,
+                                          &fileheader, &error));
+  EXPECT_EQ(1, fileheader.format);
+
+  struct mb_segytraceheader_struct traceheader;
+  float *trace = nullptr;
+  ASSERT_EQ(MB_SUCCESS, mb_segy_read_trace(verbose, mbsegyioptr, &traceheader, &trace, &error));
+  ASSERT_EQ(nsamps, traceheader.nsamps);
+  EXPECT_FLOAT_EQ(100.0, trace[0]);
+  EXPECT_FLOAT_EQ(-118.625, trace[1]);
+  EXPECT_FLOAT_EQ(0.03125, trace[2]);
+  EXPECT_FLOAT_EQ(0.0, trace[3]);
+
+  EXPECT_EQ(MB_SUCCESS, mb_segy_close(verbose, &mbsegyioptr, &error));
+  remove(path.c_str());
+}
+
+}  // namespace